@@ -66,7 +66,7 @@
 #ifndef ONLY_CURRENT_RETURN
 #    define ONLY_CURRENT_RETURN 255
 #endif
-/* NTC precomputed table configuration. */
+/* NTC precomputed table configuration, the table is generated at compile time in bcc_monitoring.c. */
 /*! @brief Minimal temperature in NTC table.
  *
  * It directly influences size of the NTC table (number of precomputed values).
@@ -112,37 +112,6 @@ typedef struct
  */
 int bcc_monitoring_initialize(void);
 
-/*!
- * @brief This function fills the NTC look up table.
- *
- * NTC look up table is intended for resistance to temperature conversion.
- * An array item contains raw value from a register. Index of the item is
- * temperature value.
- *
- * ArrayItem = (Vcom * Rntc) / (0.00015258789 * (NTC + Rntc))
- * Where:
- *  - ArrayItem is an item value of the table,
- *  - Vcom is maximal voltage (5V),
- *  - NTC is the resistance of NTC thermistor (Ohm),
- *  - 0.00015258789 is resolution of measured voltage in Volts
- *    (V = 152.58789 uV * Register_value),
- *  - Rntc is value of a resistor connected to Vcom (see MC3377x datasheet,
- *    section MC3377x PCB components).
- *
- * Beta formula used to calculate temperature based on NTC resistance:
- *   1 / T = 1 / T0 + (1 / Beta) * ln(Rt / R0)
- * Where:
- *  - R0 is the resistance (Ohm) at temperature T0 (Kelvin),
- *  - Beta is material constant (Kelvin),
- *  - T is temperature corresponding to resistance of the NTC thermistor.
- *
- * Equation for NTC value is given from the Beta formula:
- *   NTC = R0 * exp(Beta * (1/T - 1/T0))
- *
- * @param ntcConfig Pointer to NTC components configuration.
- */
-void bcc_monitoring_fillNtcTable(const ntc_config_t* const ntcConfig);
-
 /*
  * @brief   This function reads values measured and provided via SPI
  *          by BCC device (ISENSE, cell voltages, temperatures). \n
@@ -248,6 +217,19 @@ bcc_status_t bcc_monitoring_getCellVoltages(bcc_drv_config_t* const drvConfig);
 bcc_status_t bcc_monitoring_getBattCurrent(
     bcc_drv_config_t* const drvConfig, uint32_t rShunt, float* currentA);
 
+/*
+ * @brief   This function is used to measure only the current, for the current monitor task
+ *          it will start a conversion and read the current in one short BCC SPI critical section
+ * @note    It will not set the current in the data struct, that is up to the caller
+ *
+ * @param   drvConfig the address the BCC driver configuration
+ * @param   rShunt the value of the shunt resistor in uOhm
+ * @param   currentA The address of the variable that will become the current in A
+ *
+ * @return  bcc_status_t Error code
+ */
+bcc_status_t bcc_monitoring_measureCurrent(bcc_drv_config_t* const drvConfig, uint32_t rShunt, float* currentA);
+
 /*
  * @brief   This function is used to get the value for the ISense pins open load detected
  * @note    This function will not contain much imformation/comments
@@ -306,6 +288,19 @@ int bcc_monitoring_calcDCharge(
  */
 int bcc_monitoring_calibrateSoC(bool calibrateARem, bool currentCheck);
 
+/*
+ * @brief   This function can be used to get the state of charge (SoC) of an open cell voltage
+ *          with the OCV(SoC, temperature) surface of the battery type
+ * @note    Can be called from mulitple threads
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   cellVoltage the open cell voltage in V
+ * @param   temperature the cell temperature in degC
+ *
+ * @return  the state of charge in % (0 - 100) with a resolution of 0.01%
+ */
+float bcc_monitoring_getOcvSoC(uint8_t batteryType, float cellVoltage, float temperature);
+
 /*******************************************************************************
  * EOF
  ******************************************************************************/
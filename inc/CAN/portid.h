@@ -65,8 +65,20 @@
 #    define CYPHAL_REGISTER_COUNT 5
 #endif
 
+// Prefix of the registers that map on the BMS parameters (s_parametersInfo)
+#define CYPHAL_PARAMETER_REGISTER_PREFIX "bms."
+
+// No of "bms.config.<page>" registers to read and write the exported parameters (data_exportParameters)
+#define CYPHAL_CONFIG_REGISTER_PAGES 2
+
+// No of slots in the register name hash table, power of 2 and > 2x the amount of registers
+#ifndef CYPHAL_REGISTER_HASH_SLOTS
+#    define CYPHAL_REGISTER_HASH_SLOTS 512
+#endif
+
 #define CYPHAL_REGISTER_ERROR_SERIALIZATION 1
 #define CYPHAL_REGISTER_ERROR_OUT_OF_MEMORY 2
+#define CYPHAL_REGISTER_ERROR_INVALID_VALUE 3
 
 typedef int32_t (*register_access_set_callback)(uavcan_register_Value_1_0* value);
 typedef uavcan_register_Value_1_0 (*register_access_get_callback)(void);
@@ -85,6 +97,10 @@ int32_t cyphal_register_interface_init(CanardInstance* ins, uavcan_node_GetInfo_
 int32_t cyphal_register_interface_add_entry(
     const char* name, register_access_set_callback cb_set, register_access_get_callback cb_get);
 
+// Add all BMS parameters as "bms.<parameter>" registers, with ".min", ".max" and ".default" for user writable ones
+// and the "bms.config.<page>" registers with the exported parameters, writing one imports it
+int32_t cyphal_register_interface_add_parameters(void);
+
 // Handler for all PortID registration related messages
 int32_t cyphal_register_interface_process(CanardInstance* ins, CanardTransfer* transfer);
 
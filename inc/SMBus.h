@@ -62,6 +62,24 @@
  * defines
  ******************************************************************************/
 
+//! the version of the measurement snapshot layout in the SMBus ManufacturerData block
+#define SMBUS_SNAPSHOT_VERSION          1
+//! the size of the snapshot in bytes, the maximum SMBus block size
+#define SMBUS_SNAPSHOT_SIZE             32
+//! the amount of cells in the snapshot
+#define SMBUS_SNAPSHOT_CELLS            6
+
+// the byte offsets of the snapshot fields, multi-byte fields are little endian
+#define SMBUS_SNAPSHOT_VERSION_OFFSET   0   //!< [-] uint8_t SMBUS_SNAPSHOT_VERSION
+#define SMBUS_SNAPSHOT_SEQUENCE_OFFSET  1   //!< [-] uint8_t incremented with each update
+#define SMBUS_SNAPSHOT_CELLS_OFFSET     2   //!< [mV] 6x uint16_t cell voltage, 0 if not used
+#define SMBUS_SNAPSHOT_CELL_MIN_OFFSET  14  //!< [mV] uint16_t lowest used cell voltage
+#define SMBUS_SNAPSHOT_CELL_MAX_OFFSET  16  //!< [mV] uint16_t highest used cell voltage
+#define SMBUS_SNAPSHOT_FAULT_OFFSET     18  //!< [-] uint8_t BMS fault bits, as data_getBmsFault()
+#define SMBUS_SNAPSHOT_S_FLAGS_OFFSET   19  //!< [-] uint8_t s_flags, as BMS_status_flags_t
+#define SMBUS_SNAPSHOT_E_USED_OFFSET    20  //!< [mWh] uint32_t energy used since boot
+#define SMBUS_SNAPSHOT_TEMPS_OFFSET     24  //!< [0.1 K] 4x uint16_t C_batt (0 if disabled), C_AFE, C_T, C_R
+
 /*******************************************************************************
  * types
  ******************************************************************************/
@@ -100,6 +118,19 @@ int SMBus_initialize(void);
 int SMBus_updateInformation(bool resetCurrent, commonBatteryVariables_t *pCommonBatteryVariables,
 calcBatteryVariables_t *pCalcBatteryVariables);
 
+/*!
+ * @brief   This function is used to indicate a parameter changed that is used in the static SMBus fields.
+ *          The static fields will be read again with the next SMBus_updateInformation()
+ *
+ * @warning This function may be called from the data.c parameter change handler, 
+ *          it will not use the data_getParameter() function.
+ *
+ * @param   parameter the parameter that changed, NONE if all parameters could have changed (load).
+ *
+ * @return  none
+ */
+void SMBus_changedParameter(parameterKind_t parameter);
+
 /*******************************************************************************
  * EOF
  ******************************************************************************/
@@ -100,6 +100,11 @@
 //! @brief  this is used to check the cell voltage is just below the CELL_OV voltage
 #define CHARGE_COMPLETE_MARGIN_DIV            10
 
+//! @brief  the amount of bins of the timing histograms, bin n counts the times below (256 << n) us
+#define BAT_MANAG_TIMING_BINS                 8
+//! @brief  the default wake-up jitter of the measurement loop that will trigger the alarm, 0 is off
+#define BAT_MANAG_JITTER_ALARM_US_DEFAULT     2000
+
 /*******************************************************************************
  * types
  ******************************************************************************/
@@ -164,6 +169,33 @@ typedef int (*checkForTransitionCurrentCallbackFunction)(float *currentA);
 /*! @brief this callback function is needed to report that new measured data is set */
 typedef void (*newMeasurementsCallbackFunction)(void);
 
+/*! @brief the timing statistics of the measurement loop of the battery management task */
+typedef struct
+{
+    uint32_t fullCycles;                              //!< the amount of cycles that measured everything
+    uint32_t currentCycles;                           //!< the amount of cycles that only measured the current
+    uint32_t deadlineMisses;                          //!< the amount of times the target time was passed
+    uint32_t jitterAlarms;                            //!< the amount of times the alarm was raised
+    uint32_t jitterAlarmUs;                           //!< the jitter alarm threshold, 0 if off
+    bool     jitterAlarm;                             //!< true if the last wake-up jitter exceeded the threshold
+    uint32_t periodMinUs;                             //!< the minimum period between full measurements
+    uint32_t periodMaxUs;                             //!< the maximum period between full measurements
+    uint32_t periodLastUs;                            //!< the last period between full measurements
+    uint32_t jitterMaxUs;                             //!< the maximum wake-up jitter (late on the wait time)
+    uint32_t spiMaxUs;                                //!< the maximum time of the AFE (SPI) measurement
+    uint32_t calcMaxUs;                               //!< the maximum time of the calculations and checks
+    uint32_t callbackMaxUs;                           //!< the maximum time of the callbacks to the main
+    uint32_t currentSamples;                          //!< the amount of samples of the current monitor task
+    uint32_t currentOverruns;                         //!< the amount of dropped samples of the current monitor
+    uint32_t currentSpiMaxUs;                         //!< the maximum conversion and read time of a sample
+    uint32_t currentIntervalMaxUs;                    //!< the maximum interval between current samples
+    uint32_t currentLatencyMaxUs;                     //!< the maximum time from a sample to its overcurrent check
+    uint32_t jitterHist[BAT_MANAG_TIMING_BINS];       //!< histogram of the wake-up jitter
+    uint32_t spiHist[BAT_MANAG_TIMING_BINS];          //!< histogram of the AFE (SPI) measurement time
+    uint32_t calcHist[BAT_MANAG_TIMING_BINS];         //!< histogram of the calculation time
+    uint32_t callbackHist[BAT_MANAG_TIMING_BINS];     //!< histogram of the callback time
+} batManagTiming_t;
+
 /*******************************************************************************
  * public functions
  ******************************************************************************/
@@ -528,6 +560,37 @@ int batManagement_setCSbFltEnable(bool enable);
  */
 int batManagement_checkSleepCurrentTh(bool *enabled);
 
+/*!
+ * @brief   This function is used to get a copy of the timing statistics of the measurement loop
+ *
+ * @param   pTiming address of the struct to copy the statistics to.
+ *
+ * @return  If successful, the function will return zero (OK). Otherwise, an error number will be returned to
+ *          indicate the error.
+ */
+int batManagement_getTiming(batManagTiming_t *pTiming);
+
+/*!
+ * @brief   This function is used to reset the timing statistics of the measurement loop
+ *          the jitter alarm threshold is kept.
+ */
+void batManagement_resetTiming(void);
+
+/*!
+ * @brief   This function is used to set the wake-up jitter that will trigger the jitter alarm
+ *
+ * @param   alarmUs the jitter in us, 0 to turn the alarm off.
+ */
+void batManagement_setJitterAlarm(uint32_t alarmUs);
+
+/*!
+ * @brief   This function is used to output the timing statistics of the measurement loop
+ *
+ * @return  If successful, the function will return zero (OK). Otherwise, an error number will be returned to
+ *          indicate the error.
+ */
+int batManagement_outputTiming(void);
+
 /*!
  * @brief This function will initialize the spi mutex for the BCC function
  *
@@ -79,6 +79,46 @@
 #define LOAD_INDEX       9
 #define DEFAULT_INDEX    10
 #define TIME_INDEX       11
+#define STREAM_INDEX     12
+#define EXPORT_INDEX     13
+#define IMPORT_INDEX     14
+#define TRACE_INDEX      15
+#define TIMING_INDEX     16
+#define POWER_INDEX      17
+#define WATCHDOG_INDEX   18
+#define MEM_INDEX        19
+
+/*! @brief the binary telemetry stream (bms stream <fields>).
+ *         Each frame is CLI_STREAM_FLAG, the escaped body with the CRC and CLI_STREAM_FLAG again.
+ *         The bytes CLI_STREAM_FLAG, CLI_STREAM_ESCAPE, '\n' and '\r' in the body are sent as
+ *         CLI_STREAM_ESCAPE followed by the byte XOR CLI_STREAM_ESCAPE_XOR.
+ *         The body (little endian) is: uint8_t CLI_STREAM_VERSION, uint8_t sequence, uint16_t fields,
+ *         uint32_t time [ms] and the selected fields in bit order, followed by a CRC-16/CCITT-FALSE
+ *         (polynomial 0x1021, init 0xFFFF) of the body before escaping.
+ *         The fields are sent after each measurement cycle (t-meas), CLI_STREAM_CURRENT_SAMPLES is sent
+ *         in frames of its own with each CLI_STREAM_MAX_SAMPLES current samples (every MEASURE_CURRENT_US).
+ *         sim/tools/bms_stream.c decodes the frames to CSV, sim/README.md has an example frame.
+ */
+#define CLI_STREAM_FLAG       0x7E
+#define CLI_STREAM_ESCAPE     0x7D
+#define CLI_STREAM_ESCAPE_XOR 0x20
+#define CLI_STREAM_VERSION    1
+
+#define CLI_STREAM_I_BATT      (1 << 0) //!< int32_t I_batt [mA]
+#define CLI_STREAM_CELLS       (1 << 1) //!< uint8_t N_cells, N_cells x uint16_t cell voltage [mV]
+#define CLI_STREAM_TEMPERATURE (1 << 2) //!< 4x int16_t C_batt, C_AFE, C_T, C_R [0.1 C]
+#define CLI_STREAM_SOC         (1 << 3) //!< uint8_t s_charge [%]
+#define CLI_STREAM_STATE       (1 << 4) //!< uint8_t main state, uint8_t charge state
+#define CLI_STREAM_FAULTS      (1 << 5) //!< uint8_t BMS fault bits
+//! for the 1s, 10s and 60s window: int32_t mean, int32_t min, int32_t max, uint32_t RMS current [mA]
+#define CLI_STREAM_CURRENT_STATS (1 << 6)
+//! uint8_t n, n x (uint16_t time after the frame time [10 us], int32_t current [mA]), the frame time is the
+//! time of the first sample
+#define CLI_STREAM_CURRENT_SAMPLES (1 << 7)
+#define CLI_STREAM_ALL         0xFF
+
+//! @brief the maximum amount of current samples in a stream frame
+#define CLI_STREAM_MAX_SAMPLES 16
 
 #define EXTRA_GET_AND_SET_PARS 2
 #define PARAMETER_ARRAY_SIZE   NONE + EXTRA_GET_AND_SET_PARS
@@ -101,11 +141,20 @@ typedef enum
     CLI_LOAD       = LOAD_INDEX,       //!< the user wants to load the parameters from flash
     CLI_DEFAULT    = DEFAULT_INDEX,    //!< the user wants to set the deafault parameters
     CLI_TIME       = TIME_INDEX,       //!< the user wants to get the time since boot
+    CLI_STREAM     = STREAM_INDEX,     //!< the user wants to start or stop the binary telemetry stream
+    CLI_EXPORT     = EXPORT_INDEX,     //!< the user wants to export the parameters
+    CLI_IMPORT     = IMPORT_INDEX,     //!< the user wants to import (a part of) exported parameters
+    CLI_TRACE      = TRACE_INDEX,      //!< the user wants to see the last state transitions
+    CLI_TIMING     = TIMING_INDEX,     //!< the user wants to see or configure the measurement loop timing
+    CLI_POWER      = POWER_INDEX,      //!< the user wants to see the wake-ups of each main state
+    CLI_WATCHDOG   = WATCHDOG_INDEX,   //!< the user wants to see the tasks the watchdog supervisor checks
+    CLI_MEM        = MEM_INDEX,        //!< the user wants to see the stack, heap and memory pool use
     CLI_WRONG                          //!< the user has a wrong input
 } commands_t;
 
-/*! @brief this callback function is needed to let the main handle coommands the CLI cannot do */
-typedef int (*userCommandCallbackBatFuntion)(commands_t command);
+/*! @brief this callback function is needed to let the main handle coommands the CLI cannot do
+ *         argument is the argument of the command, NULL if there is none */
+typedef int (*userCommandCallbackBatFuntion)(commands_t command, const char *argument);
 
 /*! @brief this callback function is needed to get the main state variables */
 typedef states_t (*getMainStateCallbackBatFuntion)(void);
@@ -259,6 +308,19 @@ int cli_printfTryLock(FAR const IPTR char *fmt, ...);
  */
 int cli_printLock(bool lock);
 
+/*!
+ * @brief   this function sends the current samples as CLI_STREAM_CURRENT_SAMPLES stream frames,
+ *          if that field is streamed. A frame is sent with each CLI_STREAM_MAX_SAMPLES samples.
+ * @note    Should be called from one task.
+ *
+ * @param   pCurrent the currents of the samples in A
+ * @param   pTimeUs the times of the samples in us, the lower 32 bits of timeBase_getUs()
+ * @param   samples the amount of samples
+ *
+ * @return  0 If successful (or not streamed), otherwise -1
+ */
+int cli_streamCurrentSamples(const float *pCurrent, const uint32_t *pTimeUs, uint8_t samples);
+
 /*!
  * @brief   this function is used to update the data on the CLI when needed.
  *
@@ -85,6 +85,18 @@
 #define BMS_MAJOR_VERSION_NUMBER 6
 #define BMS_MINOR_VERSION_NUMBER 1
 
+/*! @brief  The parameter blob of data_exportParameters() and data_importParameters() (little endian).
+ *          uint8_t PARAMETER_BLOB_MAGIC, uint8_t PARAMETER_BLOB_VERSION, uint16_t length of the entries,
+ *          the entries and a uint16_t CRC-16/CCITT-FALSE over everything before it.
+ *          An entry is the uint8_t parameterKind followed by the value with the size of its type,
+ *          a string value is a uint8_t length followed by the characters (without the null character).
+ */
+#define PARAMETER_BLOB_MAGIC       0xB7
+#define PARAMETER_BLOB_VERSION     1
+#define PARAMETER_BLOB_HEADER_SIZE 4
+#define PARAMETER_BLOB_CRC_SIZE    2
+#define PARAMETER_BLOB_MAX_SIZE    384 //!< enough for all the exported parameters
+
 /*******************************************************************************
  * types
  ******************************************************************************/
@@ -260,6 +272,48 @@ int data_getParameterDefault(parameterKind_t parameterKind, void* outDefaultData
  */
 int data_getParameterIfUserReadOnly(parameterKind_t parameterKind);
 
+/*!
+ * @brief       function to get if a certain parameter is saved in flash with data_saveParameters().
+ *              Measured and calculated parameters are not saved.
+ *
+ * @param       parameterKind the parameter value it wants the persistent state of,
+ *              from the parameterKind enum in BMS_data_types.h
+ *
+ * @retval      is -1 when something went wrong, 0 if the parameter is not saved, 1 if it is saved.
+ */
+int data_getParameterIfPersistent(parameterKind_t parameterKind);
+
+/*!
+ * @brief       function to export the user writable persistent parameters as a parameter blob
+ *              (see PARAMETER_BLOB_MAGIC), to be imported with data_importParameters().
+ *              The parameters are exported in parameterKind order, starting with *pNextParameter,
+ *              until the blob doesn't fit in bufferSize anymore.
+ * @note        Multi-thread protected
+ *
+ * @param       pBuffer the buffer to write the blob in
+ * @param       bufferSize the size of pBuffer, PARAMETER_BLOB_MAX_SIZE will always fit all parameters
+ * @param       pNextParameter address of the first parameter to export, will become the first parameter
+ *              that is not exported, NONE if all parameters are exported
+ *
+ * @retval      the length of the blob, -1 if something went wrong
+ */
+int data_exportParameters(uint8_t* pBuffer, uint16_t bufferSize, parameterKind_t* pNextParameter);
+
+/*!
+ * @brief       function to import a parameter blob from data_exportParameters().
+ *              Every value is checked against its limits before anything is set, after which all
+ *              values are set while holding the data lock. Only the parameters that changed are handled
+ *              (like with data_setParameter()) and it needs to be saved once with data_saveParameters().
+ * @note        Multi-thread protected
+ *
+ * @param       pBuffer the blob to import
+ * @param       length the length of the blob
+ *
+ * @retval      the amount of imported parameters, -1 if the blob is invalid and nothing is set,
+ *              -2 if setting (handling) one of the parameters went wrong.
+ */
+int data_importParameters(const uint8_t* pBuffer, uint16_t length);
+
 /*
  * @brief   Function to be called when the parameter change needs to be handled.
  *          Should be used with data_setCalcBatteryVariables()
@@ -395,6 +449,27 @@ int data_getCommonBatteryVariables(commonBatteryVariables_t* destination);
  */
 int data_setCommonBatteryVariables(commonBatteryVariables_t* source);
 
+/*!
+ * @brief   function to set the monotonic time of the last measurement
+ *          It will use the mutex for data protection
+ * @note    This is not a parameter, it is not saved in the EEPROM
+ *
+ * @param   timeUs the time of the measurement in us from timeBase_getUs()
+ *
+ * @return  0 if succeeded, -1 otherwise
+ */
+int data_setMeasurementTimeUs(uint64_t timeUs);
+
+/*!
+ * @brief   function to get the monotonic time of the last measurement
+ *          It will use the mutex for data protection
+ *
+ * @param   none
+ *
+ * @return  the time of the last measurement in us from timeBase_getUs(), 0 if unknown or if error
+ */
+uint64_t data_getMeasurementTimeUs(void);
+
 /*!
  * @brief   function that will copy the calcBatteryVariables_t struct
  *          From the struct saved in data to the destination struct
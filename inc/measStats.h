@@ -0,0 +1,142 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/inc/measStats.h
+ *
+ * BSD 3-Clause License
+ *
+ * Copyright 2022 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ** ###################################################################
+ **     Filename    : measStats.h
+ **     Project     : SmartBattery_RDDRONE_BMS772
+ **     Processor   : S32K144
+ **     Version     : 1.00
+ **     Date        : 2022-02-18
+ **     Abstract    :
+ **        measStats module.
+ **        This module keeps the streaming statistics of the measurements
+ **
+ ** ###################################################################*/
+/*!
+ ** @file measStats.h
+ **
+ ** @version 01.00
+ **
+ ** @brief
+ **        measStats module. this module keeps the mean, min, max, RMS and standard deviation of the
+ **        current and the lowest cell voltage over several sliding windows at once.
+ **        Each window is split in MEAS_STATS_BUCKETS buckets, a sample is added to the open bucket of each
+ **        window in constant time and the window is combined from its closed buckets when a bucket closes.
+ **        So a window is updated every 1/MEAS_STATS_BUCKETS of its length.
+ **        The samples are added by one task only (the batManagement task), the results are published
+ **        without a lock in a double buffer, so the measurement task never waits on a reader.
+ **
+ */
+#ifndef MEAS_STATS_H_
+#define MEAS_STATS_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * defines
+ ******************************************************************************/
+//! @brief  the amount of buckets of each window
+#define MEAS_STATS_BUCKETS 10
+
+/*******************************************************************************
+ * types
+ ******************************************************************************/
+/*! @brief the measurements that have statistics */
+typedef enum
+{
+    MEAS_STATS_CURRENT,     //!< the battery current samples of the current monitor in A
+    MEAS_STATS_LOWEST_CELL, //!< the lowest cell voltage of each full measurement in V
+    MEAS_STATS_CHANNELS
+} measStatsChannel_t;
+
+/*! @brief the windows of the statistics */
+typedef enum
+{
+    MEAS_STATS_1S,  //!< the last second
+    MEAS_STATS_10S, //!< the last 10 seconds
+    MEAS_STATS_60S, //!< the last minute
+    MEAS_STATS_WINDOWS
+} measStatsWindow_t;
+
+/*! @brief the statistics of a window */
+typedef struct
+{
+    uint32_t count;  //!< the amount of samples in the window, 0 if the other values are not valid
+    float    mean;   //!< the mean
+    float    min;    //!< the minimum
+    float    max;    //!< the maximum
+    float    rms;    //!< the root mean square
+    float    stdDev; //!< the (population) standard deviation
+} measStatsResult_t;
+
+/*******************************************************************************
+ * public functions
+ ******************************************************************************/
+/*!
+ * @brief   This function will add a sample to all windows of a channel
+ *          the open bucket of a window is closed when the sample is past its end
+ * @note    This may only be called from one task.
+ *
+ * @param   channel the channel of the sample
+ * @param   value the value of the sample
+ * @param   timeUs the time of the sample in us, this may wrap
+ */
+void measStats_addSample(measStatsChannel_t channel, float value, uint32_t timeUs);
+
+/*!
+ * @brief   This function will get the statistics of a window of a channel
+ *          this is combined from the closed buckets
+ * @note    This may be called from any task.
+ *
+ * @param   channel the channel
+ * @param   window the window
+ * @param   pResult address of the struct to become the statistics
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int measStats_getWindow(measStatsChannel_t channel, measStatsWindow_t window, measStatsResult_t *pResult);
+
+/*!
+ * @brief   This function will clear all the statistics
+ *          the statistics are cleared with the next sample of each channel
+ */
+void measStats_reset(void);
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
+
+#endif /* MEAS_STATS_H_ */
@@ -0,0 +1,144 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/inc/memMon.h
+ *
+ * BSD 3-Clause License
+ *
+ * Copyright 2022 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ** ###################################################################
+ **     Filename    : memMon.h
+ **     Project     : SmartBattery_RDDRONE_BMS772
+ **     Processor   : S32K144
+ **     Version     : 1.00
+ **     Date        : 2022-03-18
+ **     Abstract    :
+ **        memMon module.
+ **        This module keeps the stack, heap and memory pool high-water marks
+ **
+ ** ###################################################################*/
+/*!
+ ** @file memMon.h
+ **
+ ** @version 01.00
+ **
+ ** @brief
+ **        memMon module. this module keeps the high-water marks of the stacks of the tasks,
+ **        the heap and the memory pools of the CAN libraries.
+ **        The stack high-water mark is measured by NuttX, which paints each stack when the task is
+ **        created (CONFIG_STACK_COLORATION), it is read from /proc/<pid>/stack.
+ **        The heap is sampled, so its high-water mark is the highest sampled use.
+ **        After a soak run the report outputs the stack size defines with the used size plus a margin,
+ **        so these can be copied into the sources.
+ **
+ */
+#ifndef MEM_MON_H_
+#define MEM_MON_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*******************************************************************************
+ * defines
+ ******************************************************************************/
+//! @brief  the maximum amount of tasks that can be registered
+#define MEM_MON_MAX_TASKS 12
+
+/*******************************************************************************
+ * types
+ ******************************************************************************/
+/*! @brief the memory pools */
+typedef enum
+{
+    MEM_MON_POOL_CYPHAL,   //!< the o1heap of the Cyphal task
+    MEM_MON_POOL_DRONECAN, //!< the libcanard pool of the DroneCAN task
+    MEM_MON_POOLS
+} memMonPool_t;
+
+/*******************************************************************************
+ * public functions
+ ******************************************************************************/
+/*!
+ * @brief   This function will initialize the memMon part
+ * @note    This needs to be called before a task is registered.
+ *
+ * @return  0 if ok, otherwise it will indicate the error
+ */
+int memMon_initialize(void);
+
+/*!
+ * @brief   This function will register a task to monitor its stack
+ * @note    This may be called from any task.
+ *
+ * @param   pName the name of the task, this needs to be a constant string
+ * @param   pStackDefine the name of the define of the stack size for the report,
+ *          this needs to be a constant string
+ * @param   pid the pid of the task (the return value of task_create)
+ * @param   stackSize the stack size given to task_create
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int memMon_registerTask(const char *pName, const char *pStackDefine, pid_t pid, uint32_t stackSize);
+
+/*!
+ * @brief   This function will set the use of a memory pool
+ * @note    This should be called by the task that uses the pool, after it used the pool.
+ *
+ * @param   pool the memory pool
+ * @param   size the size of the pool in bytes
+ * @param   capacity the amount of bytes that can be allocated, the rest is used by the allocator
+ * @param   used the amount of bytes that are used
+ * @param   peak the highest amount of bytes that were used
+ * @param   failures the amount of allocations that failed
+ */
+void memMon_setPool(
+    memMonPool_t pool, uint32_t size, uint32_t capacity, uint32_t used, uint32_t peak, uint32_t failures);
+
+/*!
+ * @brief   This function will sample the stack high-water marks and the heap
+ * @note    This is called periodically by the supervisor task.
+ */
+void memMon_sample(void);
+
+/*!
+ * @brief   This function will output the stack, heap and pool use and high-water marks
+ *
+ * @param   report true to output the suggested stack size defines as well
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int memMon_output(bool report);
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
+
+#endif /* MEM_MON_H_ */
@@ -63,6 +63,47 @@
  * defines
  ******************************************************************************/
 
+//! the MIME type of the binary BMS record, placed after the text record in the NDEF message
+#define NFC_BMS_RECORD_MIME_TYPE            "application/x-bms"
+//! the length of NFC_BMS_RECORD_MIME_TYPE without the NULL character
+#define NFC_BMS_RECORD_MIME_TYPE_LENGHT     17
+//! the version of the binary BMS record payload layout
+#define NFC_BMS_RECORD_VERSION              1
+//! the size of the binary BMS record payload in bytes
+#define NFC_BMS_RECORD_SIZE                 61
+
+// the byte offsets of the binary BMS record payload fields, multi-byte fields are little endian
+#define NFC_BMS_RECORD_VERSION_OFFSET       0   //!< [-] uint8_t NFC_BMS_RECORD_VERSION
+#define NFC_BMS_RECORD_N_CELLS_OFFSET       1   //!< [-] uint8_t N_cells
+#define NFC_BMS_RECORD_FLAGS_OFFSET         2   //!< [-] uint8_t NFC_BMS_RECORD_FLAG_* bits
+#define NFC_BMS_RECORD_FAULT_OFFSET         3   //!< [-] uint8_t BMS fault bits, as data_getBmsFault()
+#define NFC_BMS_RECORD_STATE_OFFSET         4   //!< [-] uint8_t main state (states_t)
+#define NFC_BMS_RECORD_CHARGE_STATE_OFFSET  5   //!< [-] uint8_t charge state (charge_states_t)
+#define NFC_BMS_RECORD_S_CHARGE_OFFSET      6   //!< [%] uint8_t s_charge
+#define NFC_BMS_RECORD_S_HEALTH_OFFSET      7   //!< [%] uint8_t s_health
+#define NFC_BMS_RECORD_V_OUT_OFFSET         8   //!< [mV] uint16_t V_out
+#define NFC_BMS_RECORD_V_BATT_OFFSET        10  //!< [mV] uint16_t V_batt
+#define NFC_BMS_RECORD_V_CELLS_OFFSET       12  //!< [mV] 6x uint16_t cell voltage, 0 if not used
+#define NFC_BMS_RECORD_I_BATT_OFFSET        24  //!< [mA] int32_t I_batt
+#define NFC_BMS_RECORD_I_BATT_AVG_OFFSET    28  //!< [mA] int32_t I_batt_avg
+#define NFC_BMS_RECORD_I_BATT_10S_OFFSET    32  //!< [mA] int32_t I_batt_10s_avg
+#define NFC_BMS_RECORD_C_BATT_OFFSET        36  //!< [0.1 C] int16_t C_batt, 0 if the sensor is disabled
+#define NFC_BMS_RECORD_C_AFE_OFFSET         38  //!< [0.1 C] int16_t C_AFE
+#define NFC_BMS_RECORD_C_T_OFFSET           40  //!< [0.1 C] int16_t C_T
+#define NFC_BMS_RECORD_C_R_OFFSET           42  //!< [0.1 C] int16_t C_R
+#define NFC_BMS_RECORD_P_AVG_OFFSET         44  //!< [mW] int32_t P_avg
+#define NFC_BMS_RECORD_E_USED_OFFSET        48  //!< [mWh] uint32_t E_used
+#define NFC_BMS_RECORD_A_REM_OFFSET         52  //!< [10 mAh] uint16_t A_rem
+#define NFC_BMS_RECORD_A_FULL_OFFSET        54  //!< [10 mAh] uint16_t A_full
+#define NFC_BMS_RECORD_A_FACTORY_OFFSET     56  //!< [10 mAh] uint16_t A_factory
+#define NFC_BMS_RECORD_T_FULL_OFFSET        58  //!< [min] uint16_t t_full
+#define NFC_BMS_RECORD_BATT_ID_OFFSET       60  //!< [-] uint8_t batt_id
+
+// the bits of the NFC_BMS_RECORD_FLAGS_OFFSET byte
+#define NFC_BMS_RECORD_FLAG_SENSOR_ENABLE   (1 << 0) //!< sensor_enable
+#define NFC_BMS_RECORD_FLAG_S_OUT           (1 << 1) //!< s_out
+#define NFC_BMS_RECORD_FLAG_S_IN_FLIGHT     (1 << 2) //!< s_in_flight
+
 /*******************************************************************************
  * types
  ******************************************************************************/
@@ -145,6 +145,14 @@ int sbc_setCANFDMode(bool on);
  */
 int sbc_kickTheWatchdog(void);
 
+/*!
+ * @brief   this function is used to get the amount of SPI transfers done to kick the watchdog
+ * @note    Multi-thread protected
+ *
+ * @return  the amount of SPI transfers
+ */
+uint32_t sbc_getWatchdogKickTransfers(void);
+
 /*! 
  * @brief   this function is used to set a new watchdog mode in the SBC. 
  * @warning keep in mind that change the watchdog mode means disabling 5V (CAN tranceiver) briefly 
@@ -0,0 +1,117 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/inc/supervisor.h
+ *
+ * BSD 3-Clause License
+ *
+ * Copyright 2022 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ** ###################################################################
+ **     Filename    : supervisor.h
+ **     Project     : SmartBattery_RDDRONE_BMS772
+ **     Processor   : S32K144
+ **     Version     : 1.00
+ **     Date        : 2022-03-11
+ **     Abstract    :
+ **        supervisor module.
+ **        This module kicks the SBC watchdog if all supervised tasks are alive
+ **
+ ** ###################################################################*/
+/*!
+ ** @file supervisor.h
+ **
+ ** @version 01.00
+ **
+ ** @brief
+ **        supervisor module. this module has a task that kicks the SBC watchdog once per kick period,
+ **        but only if each supervised task checked in within its deadline.
+ **        A task checks in with the maximum time until its next check-in, or with SUPERVISOR_OFF
+ **        before a wait without a timeout (like waiting until it is enabled).
+ **        If a task misses its deadline the watchdog is not kicked and the SBC will reset the MCU.
+ **
+ */
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * defines
+ ******************************************************************************/
+//! @brief  use this as deadline to stop supervising a task until its next check-in
+#define SUPERVISOR_OFF 0
+
+/*******************************************************************************
+ * types
+ ******************************************************************************/
+/*! @brief the supervised tasks */
+typedef enum
+{
+    SUPERVISOR_MAIN,     //!< the main loop
+    SUPERVISOR_BATMANAG, //!< the batManagement task
+    SUPERVISOR_UPDATER,  //!< the updater task
+    SUPERVISOR_CAN,      //!< the DroneCAN or Cyphal task
+    SUPERVISOR_CLIENTS
+} supervisorClient_t;
+
+/*******************************************************************************
+ * public functions
+ ******************************************************************************/
+/*!
+ * @brief   This function will initialize the supervisor and start its task
+ *
+ * @return  0 if ok, otherwise it will indicate the error
+ */
+int supervisor_initialize(void);
+
+/*!
+ * @brief   This function is used by a supervised task to check in
+ * @note    This may be called from any task.
+ *
+ * @param   client the task
+ * @param   deadlineMs the maximum time in ms until the next check-in,
+ *          SUPERVISOR_OFF to not supervise it until the next check-in
+ */
+void supervisor_checkIn(supervisorClient_t client, uint32_t deadlineMs);
+
+/*!
+ * @brief   This function will output the deadline, slack and misses of each task
+ *          and the watchdog kicks and their SPI transfers
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int supervisor_output(void);
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
+
+#endif /* SUPERVISOR_H_ */
@@ -0,0 +1,142 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/inc/timeBase.h
+ *
+ * BSD 3-Clause License
+ *
+ * Copyright 2022 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ** ###################################################################
+ ** ###################################################################
+ **     Filename    : timeBase.h
+ **     Project     : SmartBattery_RDDRONE_BMS772
+ **     Processor   : S32K144
+ **     Version     : 1.00
+ **     Date        : 2022-03-25
+ **     Abstract    :
+ **        timeBase module.
+ **        This module is the monotonic time of the BMS in us
+ **
+ ** ###################################################################*/
+/*!
+ ** @file timeBase.h
+ **
+ ** @version 01.00
+ **
+ ** @brief
+ **        timeBase module. this module is the one time base of the timing of the BMS: a monotonic
+ **        64-bit time in us since the start of the MCU, with helpers for deadlines.
+ **        It doesn't step when the realtime clock is set (like with the "time" command of the CLI),
+ **        so the measurement schedule, the coulomb counting and the state machine timers keep working.
+ **        The timed waits of NuttX (sem_timedwait()) take a CLOCK_REALTIME deadline, a deadline is only
+ **        converted to it just before the wait.
+ **        The CAN timestamps and the timestamps of the measurements are in this time as well.
+ **
+ */
+#ifndef TIME_BASE_H_
+#define TIME_BASE_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*******************************************************************************
+ * defines
+ ******************************************************************************/
+//! @brief  the amount of us in a ms and in a s
+#define TIME_BASE_US_PER_MS 1000ULL
+#define TIME_BASE_US_PER_S  1000000ULL
+
+/*******************************************************************************
+ * public functions
+ ******************************************************************************/
+/*!
+ * @brief   This function will get the monotonic time
+ * @note    This may be called from any task.
+ *
+ * @return  the time since the start of the MCU in us
+ */
+uint64_t timeBase_getUs(void);
+
+/*!
+ * @brief   This function will get the time since an earlier time
+ *
+ * @param   sinceUs the earlier time in us (of timeBase_getUs())
+ *
+ * @return  the elapsed time in us, 0 if sinceUs is in the future
+ */
+uint64_t timeBase_getElapsedUs(uint64_t sinceUs);
+
+/*!
+ * @brief   This function will check if a deadline is reached
+ *
+ * @param   deadlineUs the deadline in us (of timeBase_getUs())
+ *
+ * @return  true if the time is at or past the deadline
+ */
+bool timeBase_isReached(uint64_t deadlineUs);
+
+/*!
+ * @brief   This function will move a periodic deadline to the next period
+ *          if the next period is already past as well, it continues from the current time
+ *          instead of catching up with the missed periods
+ *
+ * @param   pDeadlineUs address of the deadline in us, this becomes the next deadline
+ * @param   periodUs the period in us
+ * @param   nowUs the current time in us
+ *
+ * @return  true if the deadline was missed (nowUs was past it)
+ */
+bool timeBase_advanceDeadline(uint64_t *pDeadlineUs, uint32_t periodUs, uint64_t nowUs);
+
+/*!
+ * @brief   This function will convert a time to a timespec of CLOCK_MONOTONIC
+ *          like for clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, ...)
+ *
+ * @param   timeUs the time in us
+ * @param   pTime address of the timespec to become the time
+ */
+void timeBase_toTimespec(uint64_t timeUs, struct timespec *pTime);
+
+/*!
+ * @brief   This function will convert a deadline to the absolute CLOCK_REALTIME time of a timed wait
+ *          like sem_timedwait(), it is the realtime clock now plus the time until the deadline
+ * @note    Call this just before the wait, a step of the realtime clock after it moves the wait.
+ *
+ * @param   deadlineUs the deadline in us (of timeBase_getUs())
+ * @param   pWaitTime address of the timespec to become the absolute wait time
+ */
+void timeBase_toRealtime(uint64_t deadlineUs, struct timespec *pWaitTime);
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
+
+#endif /* TIME_BASE_H_ */
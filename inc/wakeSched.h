@@ -0,0 +1,170 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/inc/wakeSched.h
+ *
+ * BSD 3-Clause License
+ *
+ * Copyright 2022 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ** ###################################################################
+ **     Filename    : wakeSched.h
+ **     Project     : SmartBattery_RDDRONE_BMS772
+ **     Processor   : S32K144
+ **     Version     : 1.00
+ **     Date        : 2022-03-04
+ **     Abstract    :
+ **        wakeSched module.
+ **        This module aligns the timed wake-ups of the tasks
+ **
+ ** ###################################################################*/
+/*!
+ ** @file wakeSched.h
+ **
+ ** @version 01.00
+ **
+ ** @brief
+ **        wakeSched module. this module aligns the timed wake-ups of the tasks so the MCU wakes up
+ **        once for a batch of them instead of once for each task.
+ **        A task registers the absolute deadline of its next timed wait with the slack it allows,
+ **        the deadline is moved to the earliest deadline of another task in [deadline, deadline + slack].
+ **        A task with a hard deadline (slack 0) keeps its deadline and the others align to it.
+ **        It also counts the wake-ups (batches) and the time in RUN mode for each main state.
+ **
+ */
+#ifndef WAKE_SCHED_H_
+#define WAKE_SCHED_H_
+
+/*******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "BMS_data_types.h"
+
+/*******************************************************************************
+ * defines
+ ******************************************************************************/
+//! @brief  wake-ups within this time of the previous wake-up are counted as the same batch
+#define WAKE_SCHED_BATCH_US 2000
+
+/*******************************************************************************
+ * types
+ ******************************************************************************/
+/*! @brief the tasks with a timed wait */
+typedef enum
+{
+    WAKE_SCHED_MEAS,       //!< the measurement of the batManagement task, this has a hard deadline
+    WAKE_SCHED_MAIN,       //!< the main loop wait
+    WAKE_SCHED_LED,        //!< the LED blink timing
+    WAKE_SCHED_CAN,        //!< the DroneCAN receive timeout
+    WAKE_SCHED_SUPERVISOR, //!< the watchdog kick of the supervisor
+    WAKE_SCHED_CLIENTS
+} wakeSchedClient_t;
+
+/*! @brief the wake-up statistics of a main state */
+typedef struct
+{
+    uint32_t wakeUps;                           //!< the amount of wake-ups (batches)
+    uint32_t clientWakeUps[WAKE_SCHED_CLIENTS]; //!< the amount of wake-ups started by each task
+    uint32_t timeMs;                            //!< the time in the state in ms
+    uint32_t runTimeMs;                         //!< the time in the state with the MCU in RUN mode in ms
+} wakeSchedStats_t;
+
+/*******************************************************************************
+ * public functions
+ ******************************************************************************/
+/*!
+ * @brief   This function will initialize the wakeSched module
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int wakeSched_initialize(void);
+
+/*!
+ * @brief   This function will register the deadline of the next timed wait of a task
+ *          the deadline is aligned with the earliest deadline of another task in
+ *          [deadline, deadline + slack]
+ * @note    This may be called from any task.
+ *
+ * @param   client the task
+ * @param   pDeadlineUs address of the deadline in us (of timeBase_getUs()), this becomes the aligned deadline
+ * @param   slackMs the time in ms the wake-up may be later than the deadline
+ */
+void wakeSched_alignDeadline(wakeSchedClient_t client, uint64_t *pDeadlineUs, uint32_t slackMs);
+
+/*!
+ * @brief   This function will register the timeout of the next timed wait of a task
+ *          the same as wakeSched_alignDeadline() but with a relative timeout
+ *
+ * @param   client the task
+ * @param   timeoutMs the timeout in ms
+ * @param   slackMs the time in ms the wake-up may be later than the timeout
+ *
+ * @return  the aligned timeout in ms
+ */
+uint32_t wakeSched_alignTimeout(wakeSchedClient_t client, uint32_t timeoutMs, uint32_t slackMs);
+
+/*!
+ * @brief   This function should be called when a task returns from its timed wait
+ *          it is counted as a new wake-up if it is not in the batch of the last wake-up
+ *          the deadline of the task is removed until it registers a new one
+ *
+ * @param   client the task
+ */
+void wakeSched_wokeUp(wakeSchedClient_t client);
+
+/*!
+ * @brief   This function will set the main state and MCU power mode to count the statistics for
+ *          the time since the last call is added to the previous state
+ * @note    Should be called from the main loop each loop.
+ *
+ * @param   state the main state
+ * @param   runMode true if the MCU is in RUN mode
+ */
+void wakeSched_setState(states_t state, bool runMode);
+
+/*!
+ * @brief   This function will get the wake-up statistics of a main state
+ *
+ * @param   state the main state
+ * @param   pStats address of the struct to become the statistics
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int wakeSched_getStats(states_t state, wakeSchedStats_t *pStats);
+
+/*!
+ * @brief   This function will clear the wake-up statistics
+ */
+void wakeSched_resetStats(void);
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
+
+#endif /* WAKE_SCHED_H_ */
@@ -0,0 +1,76 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/arch/board/smbus_sbd.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The data of the SMBus smart battery data driver of the rddrone-bms772
+ * board. On the host /dev/smbus-sbd0 only keeps the last written data.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_ARCH_BOARD_SMBUS_SBD_H
+#define __SIM_INCLUDE_ARCH_BOARD_SMBUS_SBD_H
+
+#include <stdint.h>
+
+//! @brief the data that will be written to the driver in one write
+struct smbus_sbd_data_s
+{
+    uint16_t temperature;
+    uint16_t voltage;
+    int16_t  current;
+    int16_t  average_current;
+    uint16_t max_error;
+    uint16_t relative_state_of_charge;
+    uint16_t absolute_state_of_charge;
+    uint16_t remaining_capacity;
+    uint16_t full_charge_capacity;
+    uint16_t run_time_to_empty;
+    uint16_t average_time_to_empty;
+    uint16_t cycle_count;
+    uint16_t design_capacity;
+    uint16_t design_voltage;
+    uint16_t manufacture_date;
+    uint16_t serial_number;
+    const char *manufacturer_name;
+    const char *device_name;
+    const char *device_chemistry;
+    const uint8_t *manufacturer_data;
+    uint8_t manufacturer_data_length;
+    uint16_t cell1_voltage;
+    uint16_t cell2_voltage;
+    uint16_t cell3_voltage;
+    uint16_t cell4_voltage;
+    uint16_t cell5_voltage;
+    uint16_t cell6_voltage;
+};
+
+#endif /* __SIM_INCLUDE_ARCH_BOARD_SMBUS_SBD_H */
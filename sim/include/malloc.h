@@ -0,0 +1,60 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/malloc.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The host malloc.h with the NuttX mallinfo.
+ * The mallinfo of glibc has no largest free block (mxordblk), so the
+ * application gets the one of sim/src/sim_os.c instead.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_MALLOC_H
+#define __SIM_INCLUDE_MALLOC_H
+
+#include_next <malloc.h>
+
+//! @brief the heap information like NuttX reports it
+struct sim_mallinfo
+{
+    int arena;    //!< the size of the heap
+    int ordblks;  //!< the amount of free chunks
+    int aordblks; //!< the amount of allocated chunks
+    int mxordblk; //!< the largest free chunk
+    int uordblks; //!< the allocated space
+    int fordblks; //!< the free space
+};
+
+struct sim_mallinfo sim_mallinfo(void);
+
+#define mallinfo sim_mallinfo
+
+#endif /* __SIM_INCLUDE_MALLOC_H */
@@ -0,0 +1,57 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/board.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The board functions of the rddrone-bms772 board the application uses,
+ * implemented by sim/src/sim_os.c.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_BOARD_H
+#define __SIM_INCLUDE_NUTTX_BOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//! @brief initialize the user LEDs, returns the amount of LEDs
+uint32_t board_userled_initialize(void);
+
+//! @brief set the LED with index led on or off
+void board_userled(int led, bool ledon);
+
+//! @brief set all LEDs at once, each bit is a LED (red, green, blue)
+void board_userled_all(uint32_t ledset);
+
+//! @brief get the LEDs that are on
+void board_userled_getall(uint32_t *ledset);
+
+#endif /* __SIM_INCLUDE_NUTTX_BOARD_H */
@@ -0,0 +1,74 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/config.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The NuttX configuration of the simulation build.
+ * This file is included in every source file by the sim Makefile, like the
+ * NuttX build does with the generated config.h of the rddrone-bms772 board.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_CONFIG_H
+#define __SIM_INCLUDE_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <sys/types.h>
+
+// the NuttX headers include these indirectly, the application relies on that
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <time.h>
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+// the options of the rddrone-bms772 defconfig the application checks
+#define CONFIG_NXP_BMS                     1
+#define CONFIG_NXP_BMS_PROGNAME            "bms"
+#define CONFIG_NXP_BMS_PRIORITY            100
+#define CONFIG_NXP_BMS_STACKSIZE           2048
+#define CONFIG_LIBC_FLOATINGPOINT          1
+#define CONFIG_S32K1XX_RESETCAUSE_PROCFS   1
+#define CONFIG_VLPR_STANDBY                1
+#define CONFIG_VLPR_SLEEP                  1
+#define CONFIG_BOARDCTL_UNIQUEID_SIZE      16
+#define CONFIG_FS_PROCFS                   1
+#define CONFIG_STACK_COLORATION            1
+#define CONFIG_FB_UPDATE                   1
+
+#endif /* __SIM_INCLUDE_NUTTX_CONFIG_H */
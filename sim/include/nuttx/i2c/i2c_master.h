@@ -0,0 +1,70 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/i2c/i2c_master.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The I2C character driver interface of NuttX. On the host there is nothing
+ * on the bus, each I2CIOC_TRANSFER fails with ENXIO.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_I2C_I2C_MASTER_H
+#define __SIM_INCLUDE_NUTTX_I2C_I2C_MASTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define I2C_M_READ    0x0001
+#define I2C_M_TEN     0x0002
+#define I2C_M_NOSTOP  0x0040
+#define I2C_M_NOSTART 0x0080
+
+#define I2CIOC_TRANSFER 0x2101
+#define I2CIOC_RESET    0x2102
+
+//! @brief one message of a transfer
+struct i2c_msg_s
+{
+    uint32_t frequency;
+    uint16_t addr;
+    uint16_t flags;
+    uint8_t *buffer;
+    ssize_t length;
+};
+
+//! @brief the argument of I2CIOC_TRANSFER
+struct i2c_transfer_s
+{
+    struct i2c_msg_s *msgv;
+    size_t msgc;
+};
+
+#endif /* __SIM_INCLUDE_NUTTX_I2C_I2C_MASTER_H */
@@ -0,0 +1,66 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/ioexpander/gpio.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The GPIO character driver interface of NuttX. On the host the /dev/gpioN
+ * pins are simulated by sim/src/sim_gpio.c.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_IOEXPANDER_GPIO_H
+#define __SIM_INCLUDE_NUTTX_IOEXPANDER_GPIO_H
+
+#define GPIOC_WRITE       0x2901
+#define GPIOC_READ        0x2902
+#define GPIOC_PINTYPE     0x2903
+#define GPIOC_REGISTER    0x2904
+#define GPIOC_UNREGISTER  0x2905
+#define GPIOC_SETPINTYPE  0x2906
+
+//! @brief the types of a pin
+enum gpio_pintype_e
+{
+    GPIO_INPUT_PIN = 0,
+    GPIO_INPUT_PIN_PULLUP,
+    GPIO_INPUT_PIN_PULLDOWN,
+    GPIO_OUTPUT_PIN,
+    GPIO_OUTPUT_PIN_OPENDRAIN,
+    GPIO_INTERRUPT_PIN,
+    GPIO_INTERRUPT_HIGH_PIN,
+    GPIO_INTERRUPT_LOW_PIN,
+    GPIO_INTERRUPT_RISING_PIN,
+    GPIO_INTERRUPT_FALLING_PIN,
+    GPIO_INTERRUPT_BOTH_PIN,
+    GPIO_NPINTYPES
+};
+
+#endif /* __SIM_INCLUDE_NUTTX_IOEXPANDER_GPIO_H */
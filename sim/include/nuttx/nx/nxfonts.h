@@ -0,0 +1,103 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/nx/nxfonts.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The NX font interface the application uses. On the host the font is a
+ * stand-in in sim/src/sim_os.c: each glyph is 8x8 and has its character
+ * code in the first row, so the simulation can print the display as text.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_NX_NXFONTS_H
+#define __SIM_INCLUDE_NUTTX_NX_NXFONTS_H
+
+#include <stdint.h>
+
+#include <nuttx/nx/nx.h>
+
+#define NXFONT_DEFAULT 0
+
+//! @brief the information of a font set
+struct nx_font_s
+{
+    uint8_t mxheight;
+    uint8_t mxwidth;
+    uint8_t mxbits;
+    uint8_t spwidth;
+};
+
+//! @brief the size of a glyph
+struct nx_fontmetric_s
+{
+    uint8_t stride;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xoffset;
+    uint8_t yoffset;
+};
+
+//! @brief a glyph
+struct nx_fontbitmap_s
+{
+    struct nx_fontmetric_s metric;
+    const uint8_t *bitmap;
+};
+
+/*!
+ * @brief   This function will get the handle of a font
+ *
+ * @param   fontid the id of the font, only NXFONT_DEFAULT is there
+ *
+ * @return  the handle of the font
+ */
+NXHANDLE nxf_getfonthandle(int fontid);
+
+/*!
+ * @brief   This function will get the information of the font set
+ *
+ * @param   handle the handle of the font
+ *
+ * @return  the address of the font set information
+ */
+const struct nx_font_s *nxf_getfontset(NXHANDLE handle);
+
+/*!
+ * @brief   This function will get the glyph of a character
+ *
+ * @param   handle the handle of the font
+ * @param   ch the character
+ *
+ * @return  the address of the glyph, NULL if the character has no glyph (like ' ')
+ */
+const struct nx_fontbitmap_s *nxf_getbitmap(NXHANDLE handle, uint16_t ch);
+
+#endif /* __SIM_INCLUDE_NUTTX_NX_NXFONTS_H */
@@ -0,0 +1,71 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/spi/spi_transfer.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The SPI character driver interface of NuttX. On the host /dev/spi0 is
+ * the SBC and /dev/spi1 is the AFE of the simulated board.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_SPI_SPI_TRANSFER_H
+#define __SIM_INCLUDE_NUTTX_SPI_SPI_TRANSFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SPIDEVTYPE_USER 0
+#define SPIDEV_ID(type, index) ((((uint32_t)(type) & 0xffff) << 16) | ((uint32_t)(index) & 0xffff))
+
+#define SPIIOC_TRANSFER 0x2301
+
+//! @brief one transfer of a sequence
+struct spi_trans_s
+{
+    bool deselect;
+    uint16_t delay;
+    uint32_t nwords;
+    const void *txbuffer;
+    void *rxbuffer;
+};
+
+//! @brief the argument of SPIIOC_TRANSFER
+struct spi_sequence_s
+{
+    uint32_t dev;
+    uint8_t mode;
+    uint8_t nbits;
+    uint8_t ntrans;
+    uint32_t frequency;
+    struct spi_trans_s *trans;
+};
+
+#endif /* __SIM_INCLUDE_NUTTX_SPI_SPI_TRANSFER_H */
@@ -0,0 +1,82 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/nuttx/video/fb.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The framebuffer character driver interface of NuttX. On the host /dev/fb0
+ * is a 128x32 1 bpp framebuffer like the SSD1306 display of the board.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_NUTTX_VIDEO_FB_H
+#define __SIM_INCLUDE_NUTTX_VIDEO_FB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//! @brief the color format of a 1 bpp monochrome display
+#define FB_FMT_Y1 0
+
+#define FBIOGET_VIDEOINFO 0x2801
+#define FBIOGET_PLANEINFO 0x2802
+#define FBIO_UPDATE       0x2803
+#define FBIOSET_POWER     0x2804
+#define FBIOGET_POWER     0x2805
+
+//! @brief the information of the video
+struct fb_videoinfo_s
+{
+    uint8_t fmt;
+    uint16_t xres;
+    uint16_t yres;
+    uint8_t nplanes;
+};
+
+//! @brief the information of a plane
+struct fb_planeinfo_s
+{
+    void *fbmem;
+    size_t fblen;
+    uint16_t stride;
+    uint8_t display;
+    uint8_t bpp;
+};
+
+//! @brief an area of the framebuffer to update
+struct fb_area_s
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+};
+
+#endif /* __SIM_INCLUDE_NUTTX_VIDEO_FB_H */
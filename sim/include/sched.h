@@ -0,0 +1,70 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/sched.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The host sched.h with the NuttX task functions, these are implemented
+ * on pthreads in sim/src/sim_os.c.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_SCHED_H
+#define __SIM_INCLUDE_SCHED_H
+
+#include_next <sched.h>
+
+#include <sys/types.h>
+
+//! @brief the entry point of a NuttX task
+typedef int (*main_t)(int argc, char *argv[]);
+
+/*!
+ * @brief   This function will start a task, it runs on its own thread with its own pid.
+ *          The stack is larger than stackSize, since the host uses more stack than the MCU.
+ *
+ * @param   name the name of the task
+ * @param   priority the priority of the task, sched_getparam(0) will return it
+ * @param   stackSize the stack size the task would get on the MCU
+ * @param   entry the entry point of the task
+ * @param   argv the NULL terminated arguments for the task, may be NULL
+ *
+ * @return  the pid of the task, or -1 with errno set on an error
+ */
+int task_create(const char *name, int priority, int stackSize, main_t entry, char *const argv[]);
+
+/*!
+ * @brief   These functions would disable the pre-emption, the tasks run in parallel on the host
+ *          so these don't do anything. The application uses the mutexes it has around them.
+ */
+int sched_lock(void);
+int sched_unlock(void);
+
+#endif /* __SIM_INCLUDE_SCHED_H */
@@ -0,0 +1,94 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/include/sys/boardctl.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The boardctl() interface of NuttX the application uses, implemented by
+ * sim/src/sim_os.c.
+ ****************************************************************************/
+#ifndef __SIM_INCLUDE_SYS_BOARDCTL_H
+#define __SIM_INCLUDE_SYS_BOARDCTL_H
+
+#include <stdint.h>
+
+//! @brief the boardctl commands
+#define BOARDIOC_INIT       0x0001
+#define BOARDIOC_POWEROFF   0x0003
+#define BOARDIOC_RESET      0x0004
+#define BOARDIOC_PM_CONTROL 0x0005
+#define BOARDIOC_UNIQUEID   0x0007
+
+//! @brief the actions of BOARDIOC_PM_CONTROL
+enum boardioc_action_e
+{
+    BOARDIOC_PM_ACTIVITY = 0,
+    BOARDIOC_PM_STAY,
+    BOARDIOC_PM_RELAX,
+    BOARDIOC_PM_STAYCOUNT,
+    BOARDIOC_PM_CHECKSTATE,
+    BOARDIOC_PM_CHANGESTATE,
+    BOARDIOC_PM_QUERYSTATE
+};
+
+//! @brief the power management states
+enum pm_state_e
+{
+    PM_RESTORE = -1,
+    PM_NORMAL  = 0,
+    PM_IDLE,
+    PM_STANDBY,
+    PM_SLEEP,
+    PM_COUNT
+};
+
+//! @brief the argument of BOARDIOC_PM_CONTROL
+struct boardioc_pm_ctrl_s
+{
+    uint32_t action;
+    uint32_t domain;
+    uint32_t state;
+    uint32_t count;
+    uint32_t priority;
+};
+
+/*!
+ * @brief   This function will do a board specific command
+ *
+ * @param   cmd the command
+ * @param   arg the argument of the command
+ *
+ * @return  0 (OK) if succeeded, -1 (ERROR) with errno set if not
+ */
+int boardctl(unsigned int cmd, uintptr_t arg);
+
+#endif /* __SIM_INCLUDE_SYS_BOARDCTL_H */
@@ -0,0 +1,515 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim.h
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The interfaces between the parts of the simulation.
+ * sim_os.c runs the NuttX tasks on pthreads, sim_dev.c is the file system
+ * with the devices of the board, sim_gpio.c, sim_afe.c (MC33772),
+ * sim_sbc.c (UJA1169) and sim_nfc.c (NTAG 5) are the chips and sim_pack.c
+ * is the battery pack, the power switch and the load. sim_main.c starts the
+ * application and is the console, or sim_replay.c replays a current profile
+ * on the virtual clock of sim_clock.c and reports the timing sim_profile.c
+ * measured, or sim_bench.c times the hot paths of the application.
+ * All models share one recursive lock, the world tick thread of sim_main.c
+ * advances them every SIM_TICK_US.
+ ****************************************************************************/
+#ifndef __SIM_SRC_SIM_H
+#define __SIM_SRC_SIM_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <nuttx/i2c/i2c_master.h>
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the period of the world tick in us
+#define SIM_TICK_US         10000
+
+//! @brief the amount of GPIO pins of the board, see pinEnum_t in gpio.h
+#define SIM_GPIO_PINS       12
+
+//! @brief the maximum amount of cells of the MC33772
+#define SIM_MAX_CELLS       6
+
+//! @brief the reset causes of the S32K144 RCM_SRS register the simulation uses
+#define SIM_RESET_CAUSE_POR 0x82
+#define SIM_RESET_CAUSE_PIN 0x40
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the state of a cell of the pack */
+typedef struct
+{
+    float    soc;             //!< the state of charge in %
+    float    balancedAh;      //!< the charge that is discharged by the cell balancing in Ah
+    uint64_t balancingUs;     //!< the time the cell was balanced in us
+    uint64_t lastBalancingUs; //!< the time of the simulation it was balanced the last time in us, 0 if never
+} simPackCell_t;
+
+/*! @brief the configuration of the simulation, set with the command line options */
+typedef struct
+{
+    int         cells;        //!< the amount of cells of the pack (3 - 6)
+    float       soc;          //!< the initial state of charge of the cells in %
+    float       cellSoc[SIM_MAX_CELLS]; //!< the initial state of charge of each cell in %, 0 to use soc
+    float       capacity;     //!< the capacity of a cell in Ah
+    float       current;      //!< the initial load current in A, positive is charging
+    float       temperature;  //!< the initial temperature of the sensors in degrees C
+    const char *eepromPath;   //!< the host file of /dev/eeeprom0
+    unsigned    resetCause;   //!< the reset cause of /proc/resetcause
+    bool        watchdog;     //!< false to ignore the SBC watchdog
+    const char *replayPath;   //!< the CSV profile to replay on the virtual clock, NULL for the console
+    const char *reportPath;   //!< the file to write the replay report to as well, may be NULL
+    const char *baselinePath; //!< the replay report to compare the timing with, may be NULL
+    float       regression;   //!< the allowed increase of the mean time of a function in %
+    const char *benchPath;    //!< the JSON file of the benchmark ("-" for stdout), NULL for no benchmark
+} simConfig_t;
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+//! @brief the configuration of the simulation
+extern simConfig_t gSimConfig;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/* main.c of the application ************************************************/
+/*!
+ * @brief   The entry of the application, like "bms" on the shell of the board
+ */
+int bms_main(int argc, char *argv[]);
+
+/* sim_main.c ***************************************************************/
+/*!
+ * @brief   These functions lock and unlock the state of the models, the lock is recursive
+ */
+void sim_lock(void);
+void sim_unlock(void);
+
+/*!
+ * @brief   This function will get the time of the simulation
+ *
+ * @return  the monotonic time in us
+ */
+uint64_t sim_getTimeUs(void);
+
+/* sim_clock.c **************************************************************/
+/*!
+ * @brief   This function will start the clock, the calling thread is the main thread
+ *
+ * @param   virtualClock true to use the virtual clock, false for the host clock
+ */
+void sim_clock_initialize(bool virtualClock);
+
+/*!
+ * @brief   This function will check if the virtual clock is used
+ *
+ * @return  true if the virtual clock is used
+ */
+bool sim_clock_isVirtual(void);
+
+/*!
+ * @brief   These functions will count the threads for the virtual clock
+ *          a thread is added before it is created, so the time can't move before it runs.
+ *
+ * @param   pName the name of the thread, this needs to stay valid
+ * @param   pThread the thread from sim_clock_addThread()
+ *
+ * @return  the thread for the other functions, NULL if there are too many
+ */
+void *sim_clock_addThread(const char *pName);
+void  sim_clock_startThread(void *pThread);
+void  sim_clock_endThread(void *pThread);
+
+/*!
+ * @brief   This function will let the time pass that the calling task is busy, like with an SPI transfer
+ *          with the host clock this does nothing.
+ *
+ * @param   us the time in us
+ */
+void sim_clock_busyUs(uint32_t us);
+
+/*!
+ * @brief   These functions will get the CPU time of the calling thread and the wall time of the host
+ *
+ * @return  the time in ns
+ */
+uint64_t sim_clock_getCpuNs(void);
+uint64_t sim_clock_getWallNs(void);
+
+/* sim_profile.c ************************************************************/
+/*!
+ * @brief   the functions of the application that are timed
+ *          the sources with them are built with -finstrument-functions
+ */
+typedef enum
+{
+    SIM_PROFILE_CALCULATE_VARIABLES,  //!< bcc_monitoring_calculateVariables
+    SIM_PROFILE_CHECK_MEASUREMENTS,   //!< checkAllMeasurements
+    SIM_PROFILE_CHECK_TRANSITIONS,    //!< checkInputsAndStateTransitions
+    SIM_PROFILE_MAIN_STATE_MACHINE,   //!< mainStateMachine
+    SIM_PROFILE_CHARGE_STATE_MACHINE, //!< chargeStateMachine
+    SIM_PROFILE_HANDLE_FAULT,         //!< bmsHandleFault
+    SIM_PROFILE_BALANCING,            //!< balancing_handleCellBalancing
+    SIM_PROFILE_FUNCTIONS
+} simProfileFunction_t;
+
+/*! @brief the timing of a function */
+typedef struct
+{
+    const char *pName;   //!< the name of the function
+    bool        found;   //!< false if the function isn't in the program
+    uint64_t    calls;   //!< the amount of calls
+    uint64_t    totalNs; //!< the total host CPU time in ns, including the functions it calls
+    uint64_t    maxNs;   //!< the longest call in ns
+} simProfileTiming_t;
+
+/*!
+ * @brief   This function will find the timed functions in the program
+ *
+ * @param   pTransitionCallback the function to call after each state transition, may be NULL
+ *
+ * @return  0 if ok, -1 if the program can't be read
+ */
+int sim_profile_initialize(void (*pTransitionCallback)(void));
+
+/*!
+ * @brief   This function will clear the timing of all functions
+ */
+void sim_profile_reset(void);
+
+/*!
+ * @brief   This function will get the timing of a function
+ *
+ * @param   function the function
+ * @param   pTiming address of the struct to become the timing
+ */
+void sim_profile_get(simProfileFunction_t function, simProfileTiming_t *pTiming);
+
+/*!
+ * @brief   This function will find a function of the program by its name, static functions as well
+ *
+ * @param   pName the name of the function
+ *
+ * @return  the address of the function, NULL if it isn't in the program
+ */
+void *sim_profile_findFunction(const char *pName);
+
+/* sim_replay.c *************************************************************/
+/*!
+ * @brief   This function will read the profile of gSimConfig.replayPath
+ *
+ * @return  0 if ok, -1 if not
+ */
+int sim_replay_initialize(void);
+
+/*!
+ * @brief   This function will replay the profile after the application has started and report it
+ *
+ * @return  the exit code: 0 if ok, 2 if the timing regressed, 3 if the BMS didn't start
+ */
+int sim_replay_run(void);
+
+/* sim_bench.c **************************************************************/
+/*!
+ * @brief   This function will run the benchmark after the application has started and write
+ *          the results to gSimConfig.benchPath
+ *
+ * @return  the exit code: 0 if ok, 1 if it failed, 3 if the BMS didn't start
+ */
+int sim_bench_run(void);
+
+/* sim_os.c *****************************************************************/
+/*!
+ * @brief   This function will set up the main thread as the first task
+ */
+void sim_os_initialize(void);
+
+/*!
+ * @brief   This function will get the stack of a task for /proc/<pid>/stack
+ *
+ * @param   pid the pid of the task
+ * @param   pSize address of the variable to become the size of the host stack
+ * @param   pUsed address of the variable to become the high-water mark of the host stack
+ *
+ * @return  0 if ok, -1 if there is no such task
+ */
+int sim_os_getStack(pid_t pid, size_t *pSize, size_t *pUsed);
+
+/*!
+ * @brief   This function will change the priority of the calling task, like sched_setparam() on NuttX
+ *          The host doesn't schedule on it, only sched_getparam() returns it.
+ *
+ * @param   priority the new priority
+ *
+ * @return  the old priority, -1 if the calling thread isn't a task
+ */
+int sim_os_setPriority(int priority);
+
+/*!
+ * @brief   This function will restart the simulation like a reset of the MCU
+ *          the process is executed again with the new reset cause, the eeprom file stays.
+ *
+ * @param   resetCause the reset cause the restarted application will read
+ * @param   reason the reason to show to the user
+ */
+void sim_os_reset(unsigned resetCause, const char *reason);
+
+/*!
+ * @brief   This function will end the simulation like the board is switched off
+ *
+ * @param   reason the reason to show to the user
+ */
+void sim_os_powerOff(const char *reason);
+
+/*!
+ * @brief   This function will get the LEDs that are on
+ *
+ * @return  the LEDs, a bit per LED (red, green, blue)
+ */
+uint32_t sim_os_getLeds(void);
+
+/* sim_dev.c ****************************************************************/
+/*!
+ * @brief   This function will print the text on the display
+ *
+ * @param   pStream the stream to print it to
+ */
+void sim_dev_printDisplay(FILE *pStream);
+
+/*!
+ * @brief   This function will get the traffic with the BCC since the start, to measure the
+ *          frames and the SPI bus time of an action
+ *
+ * @param   pFrames address of the variable to become the amount of 40 bit frames
+ * @param   pBusUs address of the variable to become the bus time in us
+ */
+void sim_dev_getBccTraffic(uint32_t *pFrames, uint64_t *pBusUs);
+
+/* sim_gpio.c ***************************************************************/
+/*!
+ * @brief   This function will get the level of a pin
+ *          This doesn't lock, so it can be used in the signal handler of a pin.
+ *
+ * @param   pin the pin, see pinEnum_t
+ *
+ * @return  the level of the pin
+ */
+bool sim_gpio_get(int pin);
+
+/*!
+ * @brief   This function will set the level of an input pin from a model
+ *          the signal handler of the pin is called with the next sim_gpio_deliver()
+ *
+ * @param   pin the pin, see pinEnum_t
+ * @param   value the new level
+ */
+void sim_gpio_set(int pin, bool value);
+
+/*!
+ * @brief   This function will handle an ioctl of /dev/gpio<pin>
+ *
+ * @param   pin the pin of the device
+ * @param   cmd the command
+ * @param   arg the argument
+ *
+ * @return  0 if ok, -1 with errno set if not
+ */
+int sim_gpio_ioctl(int pin, int cmd, unsigned long arg);
+
+/*!
+ * @brief   This function will call the signal handlers of the pins that changed, like an interrupt
+ * @note    This needs to be called without the lock, the signal handler reads the pins.
+ */
+void sim_gpio_deliver(void);
+
+/* sim_afe.c ****************************************************************/
+/*!
+ * @brief   This function will put the MC33772 in its reset state
+ */
+void sim_afe_initialize(void);
+
+/*!
+ * @brief   This function will set the RESET pin of the MC33772, it is held in reset while high
+ *
+ * @param   value the level of the pin
+ */
+void sim_afe_setResetPin(bool value);
+
+/*!
+ * @brief   This function will do a 40 bit SPI frame with the MC33772
+ *          the reply is the answer to the previous frame, like the chip does.
+ *
+ * @param   pTx the 5 bytes that are sent, most significant byte first
+ * @param   pRx the 5 bytes that are received
+ */
+void sim_afe_transfer(const uint8_t *pTx, uint8_t *pRx);
+
+/*!
+ * @brief   This function will advance the MC33772, the cyclic measurements and the faults
+ *
+ * @param   nowUs the time of the simulation in us
+ */
+void sim_afe_tick(uint64_t nowUs);
+
+/*!
+ * @brief   This function will check if the cell balancing driver of a cell input is on
+ *
+ * @param   bccCell the cell input of the MC33772 (0 - 5)
+ *
+ * @return  true if it is on
+ */
+bool sim_afe_isBalancing(int bccCell);
+
+/* sim_sbc.c ****************************************************************/
+/*!
+ * @brief   This function will put the UJA1169 in its power-on state
+ */
+void sim_sbc_initialize(void);
+
+/*!
+ * @brief   This function will do a 16 bit SPI frame with the UJA1169
+ *
+ * @param   pTx the 2 bytes that are sent, the address byte first
+ * @param   pRx the 2 bytes that are received
+ */
+void sim_sbc_transfer(const uint8_t *pTx, uint8_t *pRx);
+
+/*!
+ * @brief   This function will advance the UJA1169 watchdog
+ *
+ * @param   nowUs the time of the simulation in us
+ */
+void sim_sbc_tick(uint64_t nowUs);
+
+/* sim_nfc.c ****************************************************************/
+/*!
+ * @brief   This function will reset the NFC chip, its memory is empty
+ */
+void sim_nfc_initialize(void);
+
+/*!
+ * @brief   This function will do an I2C transfer with the NFC chip
+ *          the other devices on the bus (the A1007) don't answer.
+ *
+ * @param   pMessages the messages of the transfer
+ * @param   count the amount of messages
+ *
+ * @return  0 if ok, -1 with errno set if there is no answer
+ */
+int sim_nfc_transfer(struct i2c_msg_s *pMessages, size_t count);
+
+/* sim_pack.c ***************************************************************/
+/*!
+ * @brief   This function will set up the pack from gSimConfig
+ */
+void sim_pack_initialize(void);
+
+/*!
+ * @brief   This function will advance the charge of the cells
+ *
+ * @param   nowUs the time of the simulation in us
+ */
+void sim_pack_tick(uint64_t nowUs);
+
+/*!
+ * @brief   This function will handle the gate driver pins, the gate latches D on a rising edge of CP
+ *
+ * @param   cp the level of GATE_CTRL_CP
+ * @param   d the level of GATE_CTRL_D, low is closed (on)
+ */
+void sim_pack_setGatePins(bool cp, bool d);
+
+/*!
+ * @brief   These functions will get the analog values the MC33772 measures
+ *
+ * @param   bccCell the cell input of the MC33772 (0 - 5), the cells are connected like on the board
+ * @param   anx the analog input (0 - 3 are temperatures)
+ */
+float sim_pack_getCellVoltage(int bccCell);
+float sim_pack_getStackVoltage(void);
+float sim_pack_getCurrent(void);
+float sim_pack_getOutputVoltage(void);
+float sim_pack_getTemperature(int anx);
+
+/*!
+ * @brief   These functions will change the pack from the console or the replay
+ */
+void sim_pack_setCurrent(float current);
+void sim_pack_setTemperature(float temperature);
+int  sim_pack_setCellVoltage(int cell, float voltage);
+
+/*!
+ * @brief   This function will set the constant voltage of the charger
+ *          with a positive current the pack is charged with that current until the stack voltage
+ *          reaches this voltage, then the current drops like with a CC/CV charger. The charger
+ *          keeps the output voltage while the power switch is open.
+ *
+ * @param   voltage the voltage in V, 0 for a current source without a charger
+ */
+void sim_pack_setChargerVoltage(float voltage);
+
+/*!
+ * @brief   This function will get the state of charge of the pack, this is the one of the lowest cell
+ *
+ * @return  the state of charge in %
+ */
+float sim_pack_getSoc(void);
+
+/*!
+ * @brief   This function will get the state of a cell
+ *
+ * @param   cell the cell (0 - cells - 1)
+ * @param   pCell address to become the state of the cell
+ *
+ * @return  0 if ok, -1 if the cell isn't there
+ */
+int sim_pack_getCell(int cell, simPackCell_t *pCell);
+
+/*!
+ * @brief   This function will print the state of the pack
+ *
+ * @param   pStream the stream to print it to
+ */
+void sim_pack_print(FILE *pStream);
+
+#endif /* __SIM_SRC_SIM_H */
@@ -0,0 +1,789 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_afe.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The MC33772 battery cell controller of the simulation.
+ * This is a register model of the chip in SPI mode: each 40 bit frame is
+ * answered with the next frame, the reply has the CRC, the rolling counter
+ * or the tag ID of the conversion like the driver in src/BCC checks them.
+ * A conversion latches the analog values of sim_pack.c in the measurement
+ * registers, adds the current to the coulomb counter and checks the cell
+ * and temperature thresholds. The fault pin is the OR of the faults that
+ * aren't masked. The cyclic timer does the conversions in normal and in
+ * sleep mode, the overcurrent of the sleep mode is checked in sleep only.
+ * A cell balancing driver is on from the write of its CBx_CFG with CB_EN
+ * until its timer ends, while SYS_CFG1 has CB_DRVEN set and CB_MANUAL_PAUSE
+ * cleared. Clearing CB_DRVEN turns all drivers off, sim_pack.c discharges
+ * the cells of the drivers that are on.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "bcc_mc3377x.h"
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the bytes of a frame, like the driver puts them on the bus
+#define SIM_AFE_FRAME_DATA_H    0
+#define SIM_AFE_FRAME_DATA_L    1
+#define SIM_AFE_FRAME_ADDR      2
+#define SIM_AFE_FRAME_CID_CMD   3
+#define SIM_AFE_FRAME_CRC       4
+#define SIM_AFE_FRAME_SIZE      5
+
+//! @brief the commands of a frame
+#define SIM_AFE_CMD_NOOP        0x0
+#define SIM_AFE_CMD_READ        0x1
+#define SIM_AFE_CMD_WRITE       0x2
+#define SIM_AFE_CMD_GLOB_WRITE  0x3
+#define SIM_AFE_CMD_MASK        0x3
+
+//! @brief the amount of registers
+#define SIM_AFE_REGISTERS       0x80
+
+//! @brief the time of an on-demand conversion in us
+#define SIM_AFE_CONVERSION_US   600
+
+//! @brief the resolution of the measurement registers
+#define SIM_AFE_VOLT_UV_LSB     152.59f
+#define SIM_AFE_STACK_UV_LSB    2441.4f
+#define SIM_AFE_ISENSE_UV_LSB   0.6f
+#define SIM_AFE_IC_TEMP_MK_LSB  32.0f
+
+//! @brief the resolution of the threshold registers
+#define SIM_AFE_TH_CT_MV_LSB    19.5f
+#define SIM_AFE_TH_AN_MV_LSB    4.88f
+#define SIM_AFE_TH_OC_UV_LSB    1.2f
+
+//! @brief the shunt resistor of the board in uOhm
+#define SIM_AFE_SHUNT_UOHM      500.0f
+
+//! @brief the NTC circuit of the temperature inputs, like bcc_configuration.h
+#define SIM_AFE_NTC_VCOM        5.0f
+#define SIM_AFE_NTC_PULL_UP     10000.0f
+#define SIM_AFE_NTC_REF_RES     10000.0f
+#define SIM_AFE_NTC_BETA        3900.0f
+#define SIM_AFE_NTC_REF_K       298.15f
+
+//! @brief the bandgap reference voltage of the diagnostic ADC in V
+#define SIM_AFE_VBG             1.17f
+
+//! @brief the free analog inputs (AN5 and AN6) are biased at half of VCOM
+#define SIM_AFE_AN_FREE_V       (SIM_AFE_NTC_VCOM / 2)
+
+//! @brief the bits of FAULT1_STATUS that can activate the fault pin
+#define SIM_AFE_FAULT1_PIN_MASK 0x1FFFU
+
+//! @brief the amount of fuse addresses (for the GUID)
+#define SIM_AFE_FUSES           0x20
+
+//! @brief the time of a minute of the cell balancing timers in us
+#define SIM_AFE_CB_MINUTE_US    60000000ULL
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the CRC table of the frames, polynomial 0x2F
+static const uint8_t gCrcTable[256] = {
+    0x00, 0x2f, 0x5e, 0x71, 0xbc, 0x93, 0xe2, 0xcd, 0x57, 0x78, 0x09, 0x26, 0xeb, 0xc4, 0xb5, 0x9a,
+    0xae, 0x81, 0xf0, 0xdf, 0x12, 0x3d, 0x4c, 0x63, 0xf9, 0xd6, 0xa7, 0x88, 0x45, 0x6a, 0x1b, 0x34,
+    0x73, 0x5c, 0x2d, 0x02, 0xcf, 0xe0, 0x91, 0xbe, 0x24, 0x0b, 0x7a, 0x55, 0x98, 0xb7, 0xc6, 0xe9,
+    0xdd, 0xf2, 0x83, 0xac, 0x61, 0x4e, 0x3f, 0x10, 0x8a, 0xa5, 0xd4, 0xfb, 0x36, 0x19, 0x68, 0x47,
+    0xe6, 0xc9, 0xb8, 0x97, 0x5a, 0x75, 0x04, 0x2b, 0xb1, 0x9e, 0xef, 0xc0, 0x0d, 0x22, 0x53, 0x7c,
+    0x48, 0x67, 0x16, 0x39, 0xf4, 0xdb, 0xaa, 0x85, 0x1f, 0x30, 0x41, 0x6e, 0xa3, 0x8c, 0xfd, 0xd2,
+    0x95, 0xba, 0xcb, 0xe4, 0x29, 0x06, 0x77, 0x58, 0xc2, 0xed, 0x9c, 0xb3, 0x7e, 0x51, 0x20, 0x0f,
+    0x3b, 0x14, 0x65, 0x4a, 0x87, 0xa8, 0xd9, 0xf6, 0x6c, 0x43, 0x32, 0x1d, 0xd0, 0xff, 0x8e, 0xa1,
+    0xe3, 0xcc, 0xbd, 0x92, 0x5f, 0x70, 0x01, 0x2e, 0xb4, 0x9b, 0xea, 0xc5, 0x08, 0x27, 0x56, 0x79,
+    0x4d, 0x62, 0x13, 0x3c, 0xf1, 0xde, 0xaf, 0x80, 0x1a, 0x35, 0x44, 0x6b, 0xa6, 0x89, 0xf8, 0xd7,
+    0x90, 0xbf, 0xce, 0xe1, 0x2c, 0x03, 0x72, 0x5d, 0xc7, 0xe8, 0x99, 0xb6, 0x7b, 0x54, 0x25, 0x0a,
+    0x3e, 0x11, 0x60, 0x4f, 0x82, 0xad, 0xdc, 0xf3, 0x69, 0x46, 0x37, 0x18, 0xd5, 0xfa, 0x8b, 0xa4,
+    0x05, 0x2a, 0x5b, 0x74, 0xb9, 0x96, 0xe7, 0xc8, 0x52, 0x7d, 0x0c, 0x23, 0xee, 0xc1, 0xb0, 0x9f,
+    0xab, 0x84, 0xf5, 0xda, 0x17, 0x38, 0x49, 0x66, 0xfc, 0xd3, 0xa2, 0x8d, 0x40, 0x6f, 0x1e, 0x31,
+    0x76, 0x59, 0x28, 0x07, 0xca, 0xe5, 0x94, 0xbb, 0x21, 0x0e, 0x7f, 0x50, 0x9d, 0xb2, 0xc3, 0xec,
+    0xd8, 0xf7, 0x86, 0xa9, 0x64, 0x4b, 0x3a, 0x15, 0x8f, 0xa0, 0xd1, 0xfe, 0x33, 0x1c, 0x6d, 0x42
+};
+
+//! the periods of the cyclic timer in us, 1 is continuous (each tick)
+static const uint32_t gCyclicPeriodUs[8] = {
+    0, SIM_TICK_US, 100000, 200000, 1000000, 2000000, 4000000, 8000000
+};
+
+//! the registers
+static uint16_t gRegs[SIM_AFE_REGISTERS];
+
+//! the fuses of the fuse mirror
+static uint16_t gFuses[SIM_AFE_FUSES];
+
+//! the reply to the last frame, it is sent with the next frame
+static uint8_t gReply[SIM_AFE_FRAME_SIZE];
+
+//! the state of the chip
+static bool gInReset   = false;
+static bool gSleeping  = false;
+static bool gFaultPin  = false;
+
+//! the coulomb counter
+static int32_t  gCcAccumulator = 0;
+static uint16_t gCcSamples     = 0;
+
+//! the time the on-demand conversion is done and the time of the last cyclic conversion in us
+static uint64_t gConversionDoneUs = 0;
+static uint64_t gLastCyclicUs     = 0;
+
+//! the time the timer of each cell balancing driver ends in us, 0 if the driver is off
+static uint64_t gCbEndUs[SIM_MAX_CELLS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to calculate the CRC of a frame
+ *
+ * @param   pFrame the frame
+ *
+ * @return  the CRC over the first 4 bytes
+ */
+static uint8_t calcCrc(const uint8_t *pFrame)
+{
+    uint8_t crc = 0x42;
+    int     i;
+
+    for(i = 0; i < SIM_AFE_FRAME_CRC; i++)
+    {
+        crc = gCrcTable[crc ^ pFrame[i]];
+    }
+
+    return crc;
+}
+
+/*!
+ * @brief   function to make the reply that is sent with the next frame
+ *
+ * @param   data the register value
+ * @param   addr the register address
+ * @param   cidCmd the CID and command field
+ */
+static void setReply(uint16_t data, uint8_t addr, uint8_t cidCmd)
+{
+    gReply[SIM_AFE_FRAME_DATA_H]  = (uint8_t)(data >> 8);
+    gReply[SIM_AFE_FRAME_DATA_L]  = (uint8_t)data;
+    gReply[SIM_AFE_FRAME_ADDR]    = addr;
+    gReply[SIM_AFE_FRAME_CID_CMD] = cidCmd;
+    gReply[SIM_AFE_FRAME_CRC]     = calcCrc(gReply);
+}
+
+/*!
+ * @brief   function to check if a register has the tag ID in its reply instead of the rolling counter
+ *
+ * @param   addr the register address
+ *
+ * @return  true if it has the tag ID
+ */
+static bool hasTagId(uint8_t addr)
+{
+    return (addr == BCC_REG_SYS_DIAG_ADDR) ||
+        (addr >= BCC_REG_FAULT1_STATUS_ADDR && addr <= BCC_REG_FAULT3_STATUS_ADDR) ||
+        (addr >= BCC_REG_CC_NB_SAMPLES_ADDR && addr <= BCC_REG_MEAS_STACK_ADDR) ||
+        (addr >= BCC_REG_MEAS_CELLX_ADDR_MC33772_START && addr <= BCC_REG_MEAS_VBG_DIAG_ADC1B_ADDR);
+}
+
+/*!
+ * @brief   function to put the registers in their reset state
+ *
+ * @param   faultBit the bit of FAULT1_STATUS with the cause of the reset
+ */
+static void resetRegisters(uint16_t faultBit)
+{
+    int i;
+
+    memset(gRegs, 0, sizeof(gRegs));
+
+    gRegs[BCC_REG_SYS_CFG1_ADDR]          = 0x9001;
+    gRegs[BCC_REG_SYS_CFG2_ADDR]          = 0x0334;
+    gRegs[BCC_REG_ADC_CFG_ADDR]           = 0x0417;
+    gRegs[BCC_REG_ADC2_OFFSET_COMP_ADDR]  = 0x4000;
+    gRegs[BCC_REG_OV_UV_EN_ADDR]          = 0x3FFF;
+    gRegs[BCC_REG_FAULT1_STATUS_ADDR]     = faultBit;
+    gRegs[BCC_REG_TH_ALL_CT_ADDR]         = 0xD780;
+    gRegs[BCC_REG_SILICON_REV_ADDR]       = 0x0021;
+
+    for(i = BCC_REG_TH_CT14_ADDR; i <= BCC_REG_TH_CT1_ADDR; i++)
+    {
+        gRegs[i] = 0xD780;
+    }
+    for(i = BCC_REG_TH_AN6_OT_ADDR; i <= BCC_REG_TH_AN0_OT_ADDR; i++)
+    {
+        gRegs[i] = 0x00ED;
+    }
+    for(i = BCC_REG_TH_AN6_UT_ADDR; i <= BCC_REG_TH_AN0_UT_ADDR; i++)
+    {
+        gRegs[i] = 0x030E;
+    }
+
+    // the cell balancing drivers are off
+    memset(gCbEndUs, 0, sizeof(gCbEndUs));
+
+    // the CID is 0 and the first frame after a reset gets a null response
+    gCcAccumulator    = 0;
+    gCcSamples        = 0;
+    gSleeping         = false;
+    gConversionDoneUs = 0;
+    setReply(0, 0, 0);
+}
+
+/*!
+ * @brief   function to get the summary of the faults in FAULT1_STATUS
+ *
+ * @return  FAULT1_STATUS with the read-only summary bits
+ */
+static uint16_t getFault1(void)
+{
+    uint16_t fault1 = gRegs[BCC_REG_FAULT1_STATUS_ADDR] &
+        ~(BCC_R_CT_UV_FLT_MASK | BCC_R_CT_OV_FLT_MASK | BCC_R_AN_UT_FLT_MASK | BCC_R_AN_OT_FLT_MASK);
+
+    // the cell and AN bits are the OR of their fault registers
+    fault1 |= gRegs[BCC_REG_CELL_UV_FLT_ADDR] ? BCC_R_CT_UV_FLT_MASK : 0;
+    fault1 |= gRegs[BCC_REG_CELL_OV_FLT_ADDR] ? BCC_R_CT_OV_FLT_MASK : 0;
+    fault1 |= (gRegs[BCC_REG_AN_OT_UT_FLT_ADDR] & BCC_RW_AN_UT_MASK) ? BCC_R_AN_UT_FLT_MASK : 0;
+    fault1 |= (gRegs[BCC_REG_AN_OT_UT_FLT_ADDR] & BCC_RW_AN_OT_MASK) ? BCC_R_AN_OT_FLT_MASK : 0;
+
+    return fault1;
+}
+
+/*!
+ * @brief   function to update the fault pin, a fault in sleep mode wakes the chip if it may
+ */
+static void updateFaultPin(void)
+{
+    uint16_t fault1 = getFault1() & SIM_AFE_FAULT1_PIN_MASK;
+    uint16_t fault2 = gRegs[BCC_REG_FAULT2_STATUS_ADDR];
+    uint16_t fault3 = gRegs[BCC_REG_FAULT3_STATUS_ADDR];
+
+    gFaultPin = (fault1 & ~gRegs[BCC_REG_FAULT_MASK1_ADDR]) || (fault2 & ~gRegs[BCC_REG_FAULT_MASK2_ADDR]) ||
+        (fault3 & ~gRegs[BCC_REG_FAULT_MASK3_ADDR]);
+
+    // check if it wakes up
+    if(gSleeping && ((fault1 & ~gRegs[BCC_REG_WAKEUP_MASK1_ADDR]) ||
+        (fault2 & ~gRegs[BCC_REG_WAKEUP_MASK2_ADDR]) || (fault3 & ~gRegs[BCC_REG_WAKEUP_MASK3_ADDR])))
+    {
+        gSleeping = false;
+    }
+
+    sim_gpio_set(BCC_FAULT, gFaultPin);
+}
+
+/*!
+ * @brief   function to make the value of a measurement register
+ *
+ * @param   value the value in the unit of the register
+ *
+ * @return  the register value with the data ready bit
+ */
+static uint16_t measRegister(float value)
+{
+    long raw = lroundf(value);
+
+    // clamp it to the 15 bits
+    if(raw < 0)
+    {
+        raw = 0;
+    }
+    if(raw > BCC_R_MEAS_MASK)
+    {
+        raw = BCC_R_MEAS_MASK;
+    }
+
+    return BCC_R_DATA_RDY_MASK | (uint16_t)raw;
+}
+
+/*!
+ * @brief   function to get the voltage of the NTC circuit of a temperature input
+ *
+ * @param   temperature the temperature in degrees C
+ *
+ * @return  the voltage in V
+ */
+static float getNtcVoltage(float temperature)
+{
+    float resistance = SIM_AFE_NTC_REF_RES *
+        expf(SIM_AFE_NTC_BETA * ((1.0f / (temperature + 273.15f)) - (1.0f / SIM_AFE_NTC_REF_K)));
+
+    return SIM_AFE_NTC_VCOM * resistance / (SIM_AFE_NTC_PULL_UP + resistance);
+}
+
+/*!
+ * @brief   function to get the voltage of an analog input
+ *
+ * @param   anx the analog input (0 - 6)
+ *
+ * @return  the voltage in V
+ */
+static float getAnVoltage(int anx)
+{
+    // AN0 - AN3 are NTCs, AN4 is the output voltage divided by 11
+    if(anx <= 3)
+    {
+        return getNtcVoltage(sim_pack_getTemperature(anx));
+    }
+    if(anx == 4)
+    {
+        return sim_pack_getOutputVoltage() / 11.0f;
+    }
+
+    return SIM_AFE_AN_FREE_V;
+}
+
+/*!
+ * @brief   function to check the thresholds of the cells and the temperature inputs
+ *
+ * @param   pCellV the cell voltages of the conversion in V
+ * @param   pAnV the analog input voltages of the conversion in V
+ * @param   isenseUv the ISENSE voltage of the conversion in uV
+ */
+static void checkThresholds(const float *pCellV, const float *pAnV, float isenseUv)
+{
+    uint16_t ovUvEn = gRegs[BCC_REG_OV_UV_EN_ADDR];
+    uint16_t thAll  = gRegs[BCC_REG_TH_ALL_CT_ADDR];
+    uint16_t thCt, gpioCfg;
+    float    ovMv, uvMv;
+    int      ct, anx;
+
+    for(ct = 1; ct <= SIM_MAX_CELLS; ct++)
+    {
+        // check if the cell terminal is checked
+        if(!(ovUvEn & BCC_RW_CTX_OVUV_EN_MASK(ct)))
+        {
+            continue;
+        }
+
+        // use the common threshold or the one of the cell
+        thCt = gRegs[BCC_REG_TH_CT1_ADDR - (ct - 1)];
+        ovMv = (((ovUvEn & BCC_RW_COMMON_OV_TH_MASK) ? thAll : thCt) >> 8) * SIM_AFE_TH_CT_MV_LSB;
+        uvMv = (((ovUvEn & BCC_RW_COMMON_UV_TH_MASK) ? thAll : thCt) & 0xFF) * SIM_AFE_TH_CT_MV_LSB;
+
+        if(pCellV[ct - 1] * 1000.0f > ovMv)
+        {
+            gRegs[BCC_REG_CELL_OV_FLT_ADDR] |= 1U << (ct - 1);
+        }
+        if(pCellV[ct - 1] * 1000.0f < uvMv)
+        {
+            gRegs[BCC_REG_CELL_UV_FLT_ADDR] |= 1U << (ct - 1);
+        }
+    }
+
+    // the temperatures are checked on the ratiometric inputs, a higher temperature is a lower voltage
+    gpioCfg = gRegs[BCC_REG_GPIO_CFG1_ADDR];
+    for(anx = 0; anx <= 6; anx++)
+    {
+        if(gpioCfg & BCC_RW_GPIOX_CFG_MASK(anx))
+        {
+            continue;
+        }
+
+        if(pAnV[anx] * 1000.0f < (gRegs[BCC_REG_TH_AN0_OT_ADDR - anx] & BCC_RW_ANX_OT_TH_MASK) *
+            SIM_AFE_TH_AN_MV_LSB)
+        {
+            gRegs[BCC_REG_AN_OT_UT_FLT_ADDR] |= BCC_RW_ANX_OT_MASK(anx);
+        }
+        if(pAnV[anx] * 1000.0f > (gRegs[BCC_REG_TH_AN0_UT_ADDR - anx] & BCC_RW_ANX_UT_TH_MASK) *
+            SIM_AFE_TH_AN_MV_LSB)
+        {
+            gRegs[BCC_REG_AN_OT_UT_FLT_ADDR] |= BCC_RW_ANX_UT_MASK(anx);
+        }
+    }
+
+    // the sleep overcurrent is only checked in sleep mode
+    if(gSleeping && fabsf(isenseUv) >
+        (gRegs[BCC_REG_TH_ISENSE_OC_ADDR] & BCC_RW_TH_ISENSE_OC_MASK) * SIM_AFE_TH_OC_UV_LSB)
+    {
+        gRegs[BCC_REG_FAULT1_STATUS_ADDR] |= BCC_RW_IS_OC_FLT_MASK;
+    }
+
+    updateFaultPin();
+}
+
+/*!
+ * @brief   function to check if the timer of a cell balancing driver runs
+ *
+ * @param   bccCell the cell input of the driver (0 - 5)
+ *
+ * @return  true if it runs
+ */
+static bool isCbTimerRunning(int bccCell)
+{
+    return (gCbEndUs[bccCell] != 0) && (sim_getTimeUs() < gCbEndUs[bccCell]);
+}
+
+/*!
+ * @brief   function to get the cell balancing drivers that are on
+ *
+ * @return  the bits of the drivers that are on, bit 0 is cell input 1
+ */
+static uint16_t getCbDrivers(void)
+{
+    uint16_t drivers = 0;
+    int      i;
+
+    // the drivers are only on with the general enable and without the pause
+    if(!(gRegs[BCC_REG_SYS_CFG1_ADDR] & BCC_RW_CB_DRVEN_MASK) ||
+        (gRegs[BCC_REG_SYS_CFG1_ADDR] & BCC_RW_CB_MANUAL_PAUSE_MASK))
+    {
+        return drivers;
+    }
+
+    for(i = 0; i < SIM_MAX_CELLS; i++)
+    {
+        drivers |= isCbTimerRunning(i) ? BCC_R_CBX_STS_MASK(i + 1) : 0;
+    }
+
+    return drivers;
+}
+
+/*!
+ * @brief   function to do a conversion, it latches the values in the measurement registers
+ */
+static void convert(void)
+{
+    float   cellV[SIM_MAX_CELLS];
+    float   anV[7];
+    float   isenseUv = 0.0f;
+    int32_t isenseRaw = 0;
+    int     i;
+
+    for(i = 0; i < SIM_MAX_CELLS; i++)
+    {
+        cellV[i] = sim_pack_getCellVoltage(i);
+
+        // cell 1 is the highest register address
+        gRegs[BCC_REG_MEAS_CELLX_ADDR_END - i] = measRegister(cellV[i] * 1000000.0f / SIM_AFE_VOLT_UV_LSB);
+    }
+
+    for(i = 0; i <= 6; i++)
+    {
+        anV[i] = getAnVoltage(i);
+
+        // AN0 is the highest register address
+        gRegs[BCC_REG_MEAS_IC_TEMP_ADDR - 1 - i] = measRegister(anV[i] * 1000000.0f / SIM_AFE_VOLT_UV_LSB);
+    }
+
+    gRegs[BCC_REG_MEAS_STACK_ADDR] =
+        measRegister(sim_pack_getStackVoltage() * 1000000.0f / SIM_AFE_STACK_UV_LSB);
+    gRegs[BCC_REG_MEAS_IC_TEMP_ADDR] =
+        measRegister((sim_pack_getTemperature(0) * 1000.0f + 273150.0f) / SIM_AFE_IC_TEMP_MK_LSB);
+    gRegs[BCC_REG_MEAS_VBG_DIAG_ADC1A_ADDR] = measRegister(SIM_AFE_VBG * 1000000.0f / SIM_AFE_VOLT_UV_LSB);
+    gRegs[BCC_REG_MEAS_VBG_DIAG_ADC1B_ADDR] = gRegs[BCC_REG_MEAS_VBG_DIAG_ADC1A_ADDR];
+
+    // the current is only measured if it is enabled, the coulomb counter adds each conversion
+    if(gRegs[BCC_REG_SYS_CFG1_ADDR] & BCC_RW_I_MEAS_EN_MASK)
+    {
+        isenseUv  = sim_pack_getCurrent() * SIM_AFE_SHUNT_UOHM;
+        isenseRaw = (int32_t)lroundf(isenseUv / SIM_AFE_ISENSE_UV_LSB);
+
+        gCcAccumulator += isenseRaw;
+        gCcSamples++;
+    }
+
+    // the current is a 19 bit two's complement value over 2 registers
+    gRegs[BCC_REG_MEAS_ISENSE1_ADDR] = BCC_R_DATA_RDY_MASK | (((uint32_t)isenseRaw >> 4) & BCC_R_MEAS1_I_MASK);
+    gRegs[BCC_REG_MEAS_ISENSE2_ADDR] = BCC_R_DATA_RDY_MASK | ((uint32_t)isenseRaw & BCC_R_MEAS2_I_MASK);
+
+    gRegs[BCC_REG_CC_NB_SAMPLES_ADDR] = gCcSamples;
+    gRegs[BCC_REG_COULOMB_CNT1_ADDR]  = (uint16_t)((uint32_t)gCcAccumulator >> 16);
+    gRegs[BCC_REG_COULOMB_CNT2_ADDR]  = (uint16_t)gCcAccumulator;
+
+    checkThresholds(cellV, anV, isenseUv);
+}
+
+/*!
+ * @brief   function to read a register
+ *
+ * @param   addr the register address
+ *
+ * @return  the value
+ */
+static uint16_t readRegister(uint8_t addr)
+{
+    uint16_t value = gRegs[addr];
+
+    switch(addr)
+    {
+        case BCC_REG_SYS_CFG_GLOBAL_ADDR:
+            // this is a command only
+            return 0;
+        case BCC_REG_ADC_CFG_ADDR:
+            // the SOC bit reads as the end of conversion (active low)
+            value &= ~BCC_R_EOC_N_MASK;
+            if(sim_getTimeUs() < gConversionDoneUs)
+            {
+                value |= BCC_R_EOC_N_MASK;
+            }
+            return value;
+        case BCC_REG_FAULT1_STATUS_ADDR:
+            return getFault1();
+        case BCC_REG_CB_DRV_STS_ADDR:
+            return getCbDrivers();
+        case BCC_REG_FUSE_MIRROR_DATA_ADDR:
+            return gFuses[(gRegs[BCC_REG_FUSE_MIRROR_CTRL_ADDR] & BCC_RW_FMR_ADDR_MASK) >> BCC_RW_FMR_ADDR_SHIFT];
+        default:
+            // the status of a cell balancing driver is the one of its timer
+            if(addr >= BCC_REG_CB1_CFG_ADDR && addr <= BCC_REG_CB6_CFG_ADDR)
+            {
+                value |= isCbTimerRunning(addr - BCC_REG_CB1_CFG_ADDR) ? BCC_R_CB_STS_MASK : 0;
+            }
+            return value;
+    }
+}
+
+/*!
+ * @brief   function to write a register
+ *
+ * @param   addr the register address
+ * @param   value the value
+ */
+static void writeRegister(uint8_t addr, uint16_t value)
+{
+    switch(addr)
+    {
+        case BCC_REG_INIT_ADDR:
+            gRegs[addr] = value & 0x003F;
+            break;
+        case BCC_REG_SYS_CFG_GLOBAL_ADDR:
+            if(value & BCC_W_GO2SLEEP_MASK)
+            {
+                gSleeping = true;
+            }
+            break;
+        case BCC_REG_SYS_CFG1_ADDR:
+            if(value & BCC_W_SOFT_RST_MASK)
+            {
+                resetRegisters(BCC_RW_RESET_FLT_MASK);
+                return;
+            }
+            gRegs[addr] = value & ~(BCC_W_SOFT_RST_MASK | BCC_W_GO2DIAG_MASK);
+
+            // the general disable turns all cell balancing drivers off
+            if(!(value & BCC_RW_CB_DRVEN_MASK))
+            {
+                memset(gCbEndUs, 0, sizeof(gCbEndUs));
+            }
+            break;
+        case BCC_REG_CB1_CFG_ADDR:
+        case BCC_REG_CB2_CFG_ADDR:
+        case BCC_REG_CB3_CFG_ADDR:
+        case BCC_REG_CB4_CFG_ADDR:
+        case BCC_REG_CB5_CFG_ADDR:
+        case BCC_REG_CB6_CFG_ADDR:
+            // a write with CB_EN (re)starts the timer of the driver, without it turns the driver off
+            gRegs[addr] = value & BCC_RW_CB_TIMER_MASK;
+            gCbEndUs[addr - BCC_REG_CB1_CFG_ADDR] = (value & BCC_W_CB_EN_MASK) ?
+                (sim_getTimeUs() + (value & BCC_RW_CB_TIMER_MASK) * SIM_AFE_CB_MINUTE_US) : 0;
+            break;
+        case BCC_REG_ADC_CFG_ADDR:
+            if(value & BCC_W_CC_RST_MASK)
+            {
+                gCcAccumulator = 0;
+                gCcSamples     = 0;
+                gRegs[BCC_REG_CC_NB_SAMPLES_ADDR] = 0;
+                gRegs[BCC_REG_COULOMB_CNT1_ADDR]  = 0;
+                gRegs[BCC_REG_COULOMB_CNT2_ADDR]  = 0;
+            }
+            gRegs[addr] = value & ~(BCC_W_CC_RST_MASK | BCC_W_SOC_MASK);
+
+            // start an on-demand conversion, the tag ID of the reply is the new one
+            if(value & BCC_W_SOC_MASK)
+            {
+                convert();
+                gConversionDoneUs = sim_getTimeUs() + SIM_AFE_CONVERSION_US;
+            }
+            break;
+        case BCC_REG_CELL_OV_FLT_ADDR:
+        case BCC_REG_CELL_UV_FLT_ADDR:
+        case BCC_REG_CB_OPEN_FLT_ADDR:
+        case BCC_REG_CB_SHORT_FLT_ADDR:
+        case BCC_REG_GPIO_STS_ADDR:
+        case BCC_REG_AN_OT_UT_FLT_ADDR:
+        case BCC_REG_GPIO_SHORT_ADDR:
+        case BCC_REG_FAULT1_STATUS_ADDR:
+        case BCC_REG_FAULT2_STATUS_ADDR:
+        case BCC_REG_FAULT3_STATUS_ADDR:
+            // the latched faults are cleared by writing a 0
+            gRegs[addr] &= value;
+            break;
+        case BCC_REG_CB_DRV_STS_ADDR:
+        case BCC_REG_I_STATUS_ADDR:
+        case BCC_REG_COM_STATUS_ADDR:
+        case BCC_REG_SILICON_REV_ADDR:
+            // read only
+            break;
+        case BCC_REG_FUSE_MIRROR_DATA_ADDR:
+            gFuses[(gRegs[BCC_REG_FUSE_MIRROR_CTRL_ADDR] & BCC_RW_FMR_ADDR_MASK) >> BCC_RW_FMR_ADDR_SHIFT] = value;
+            break;
+        default:
+            // the measurements are read only
+            if(addr >= BCC_REG_CC_NB_SAMPLES_ADDR && addr <= BCC_REG_MEAS_VBG_DIAG_ADC1B_ADDR)
+            {
+                break;
+            }
+            gRegs[addr] = value;
+            break;
+    }
+
+    updateFaultPin();
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_afe_initialize(void)
+{
+    int i;
+
+    // the fuses with the GUID, fixed values for the simulation
+    for(i = 0; i < SIM_AFE_FUSES; i++)
+    {
+        gFuses[i] = (uint16_t)(0x5A5A ^ (i * 0x1111));
+    }
+
+    resetRegisters(BCC_RW_POR_MASK);
+}
+
+void sim_afe_setResetPin(bool value)
+{
+    // the chip is held in reset while the pin is high
+    if(value && !gInReset)
+    {
+        gInReset = true;
+    }
+    else if(!value && gInReset)
+    {
+        gInReset = false;
+        resetRegisters(BCC_RW_RESET_FLT_MASK);
+        updateFaultPin();
+    }
+}
+
+void sim_afe_transfer(const uint8_t *pTx, uint8_t *pRx)
+{
+    uint8_t  cid  = pTx[SIM_AFE_FRAME_CID_CMD] >> 4;
+    uint8_t  cmd  = pTx[SIM_AFE_FRAME_CID_CMD] & SIM_AFE_CMD_MASK;
+    uint8_t  addr = pTx[SIM_AFE_FRAME_ADDR] & (SIM_AFE_REGISTERS - 1);
+    uint16_t data = ((uint16_t)pTx[SIM_AFE_FRAME_DATA_H] << 8) | pTx[SIM_AFE_FRAME_DATA_L];
+    uint8_t  myCid = gRegs[BCC_REG_INIT_ADDR] & BCC_RW_CID_MASK;
+
+    // a chip in reset doesn't drive the bus
+    if(gInReset)
+    {
+        memset(pRx, 0, SIM_AFE_FRAME_SIZE);
+        return;
+    }
+
+    // the frame shifts out the reply to the previous frame
+    memcpy(pRx, gReply, SIM_AFE_FRAME_SIZE);
+
+    // chip select wakes it up, the frame is still handled
+    if(gSleeping)
+    {
+        gSleeping = false;
+        gRegs[BCC_REG_FAULT1_STATUS_ADDR] |= BCC_RW_CSB_WUP_FLT_MASK;
+        updateFaultPin();
+    }
+
+    // a frame with a wrong CRC or for another chip gets no reply
+    setReply(0, 0, 0);
+    if(pTx[SIM_AFE_FRAME_CRC] != calcCrc(pTx))
+    {
+        return;
+    }
+
+    if(cmd == SIM_AFE_CMD_GLOB_WRITE && cid == 0)
+    {
+        writeRegister(addr, data);
+        return;
+    }
+
+    if(cid != myCid)
+    {
+        return;
+    }
+
+    switch(cmd)
+    {
+        case SIM_AFE_CMD_READ:
+            // the reply has the rolling counter of the request, or the tag ID of the conversion
+            setReply(readRegister(addr), addr, (uint8_t)((cid << 4) | (hasTagId(addr) ?
+                (gRegs[BCC_REG_ADC_CFG_ADDR] >> BCC_RW_TAG_ID_SHIFT) : (pTx[SIM_AFE_FRAME_CID_CMD] & 0x0F))));
+            break;
+        case SIM_AFE_CMD_WRITE:
+            // the reply is the echo of the frame
+            writeRegister(addr, data);
+            memcpy(gReply, pTx, SIM_AFE_FRAME_SIZE);
+            break;
+        default:
+            break;
+    }
+}
+
+bool sim_afe_isBalancing(int bccCell)
+{
+    return !gInReset && (getCbDrivers() & BCC_R_CBX_STS_MASK(bccCell + 1));
+}
+
+void sim_afe_tick(uint64_t nowUs)
+{
+    uint32_t periodUs;
+
+    if(gInReset)
+    {
+        return;
+    }
+
+    // the cyclic timer converts in normal and sleep mode
+    periodUs = gCyclicPeriodUs[(gRegs[BCC_REG_SYS_CFG1_ADDR] & BCC_RW_CYCLIC_TIMER_MASK) >>
+        BCC_RW_CYCLIC_TIMER_SHIFT];
+    if(periodUs != 0 && (nowUs - gLastCyclicUs) >= periodUs)
+    {
+        gLastCyclicUs = nowUs;
+        convert();
+    }
+}
@@ -0,0 +1,1141 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_bench.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The benchmark of the hot paths of the application.
+ * The measurement (bcc_monitoring), the parameter store (data), the Cyphal
+ * serialization and the NFC update are called in a loop on the host, after
+ * the BMS is in the NORMAL state. Each benchmark is timed warm, with R
+ * rounds of K calls, and cold, with single calls after the data caches are
+ * evicted. The time is the CPU time of the host thread, so the time of a
+ * modelled SPI or I2C transfer (on the virtual clock) isn't counted.
+ * The result is written as JSON, to be kept and compared per commit.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/utsname.h>
+
+#include "data.h"
+#include "cli.h"
+#include "nfc.h"
+#include "batManagement.h"
+#include "bcc_monitoring.h"
+#include "bcc_configuration.h"
+
+#include <reg/drone/physics/electricity/SourceTs_0_1.h>
+#include <reg/drone/service/battery/Status_0_2.h>
+#include <reg/drone/service/battery/Parameters_0_3.h>
+#include <legacy/equipment/power/BatteryInfo_1_0.h>
+#include <uavcan/diagnostic/Record_1_1.h>
+
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the amount of warm rounds and cold samples of each benchmark, odd for the median
+#define SIM_BENCH_ROUNDS            31
+#define SIM_BENCH_COLD_SAMPLES      15
+
+//! @brief the amount of warm-up calls before the rounds
+#define SIM_BENCH_WARM_UP           3
+
+//! @brief the size of the buffer that is written to evict the data caches before a cold call
+#define SIM_BENCH_EVICT_BYTES       (32 * 1024 * 1024)
+
+//! @brief the time the BMS may take to get to the normal state or to stop its measurements in us
+#define SIM_BENCH_START_US          120000000ULL
+#define SIM_BENCH_STOP_US           5000000ULL
+#define SIM_BENCH_POLL_US           100000
+
+//! @brief the time the measurements need to stay stopped in us, longer than a (long) wait of the main loop
+//!        the main loop turns them on when it handles the NORMAL state the first time
+#define SIM_BENCH_SETTLE_US         3000000ULL
+
+//! @brief the amount of times the measurements are stopped before the benchmark gives up
+#define SIM_BENCH_STOP_TRIES        3
+
+//! @brief the exit codes of the benchmark
+#define SIM_BENCH_EXIT_OK           0
+#define SIM_BENCH_EXIT_ERROR        1
+#define SIM_BENCH_EXIT_NO_START     3
+
+//! @brief the size of the serialization buffer, larger than any of the messages
+#define SIM_BENCH_BUFFER_BYTES      1024
+
+//! @brief the text of the diagnostic record, like the one of the application
+#define SIM_BENCH_RECORD_TEXT       "Cell undervoltage fault, check the cell voltages!"
+
+//! @brief the priority the log is timed with, the one of the main loop, higher than the cliLog task of cli.c
+#define SIM_BENCH_LOG_PRIORITY      130
+
+//! @brief the amount of messages of a log burst, twice the records of the log ring of cli.c
+#define SIM_BENCH_LOG_BURST         32
+
+//! @brief the time the cliLog task gets to print the deferred messages in us
+#define SIM_BENCH_LOG_DRAIN_US      100000
+
+//! @brief the amount of rounds of the provisioning benchmark, odd for the median
+#define SIM_BENCH_PROVISION_ROUNDS  9
+
+//! @brief the model name of the provisioned pack
+#define SIM_BENCH_PROVISION_NAME    "bench pack"
+
+//! @brief makes sure the compiler can't leave out or move a call with constant inputs
+#define SIM_BENCH_KEEP(pData)       __asm__ volatile("" : : "g"(pData) : "memory")
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a benchmark */
+typedef struct
+{
+    const char  *pName;         //!< the name of the benchmark
+    const char  *pGroup;        //!< the group of hot paths it is in
+    void       (*pCall)(void);  //!< one call of the function
+    int          calls;         //!< the amount of calls of a warm round
+    void *const *ppFunction;    //!< the static function it needs, NULL if none
+} simBenchEntry_t;
+
+/*! @brief the result of a benchmark */
+typedef struct
+{
+    bool   found;      //!< false if the function isn't in the program
+    double warmMin;    //!< the fastest warm round in ns per call
+    double warmMedian; //!< the median warm round in ns per call
+    double warmMean;   //!< the mean of the warm rounds in ns per call
+    double coldMedian; //!< the median cold call in ns
+    double coldMax;    //!< the slowest cold call in ns
+} simBenchResult_t;
+
+/*! @brief the result of the log benchmark, the times are in ns */
+typedef struct
+{
+    int    burst;          //!< the amount of messages of the burst
+    int    deferred;       //!< the amount of them that are put in the log ring
+    int    dropped;        //!< the amount of them that are dropped, the ring was full
+    double deferredMedian; //!< the median time of a deferred message
+    double deferredMax;    //!< the longest time of a deferred message
+    double droppedMedian;  //!< the median time of a dropped message
+    double droppedMax;     //!< the longest time of a dropped message
+    double directMedian;   //!< the median time of a message printed by a lower priority task
+    double directMax;      //!< the longest time of a message printed by a lower priority task
+} simBenchLog_t;
+
+/*! @brief the result of one way of provisioning */
+typedef struct
+{
+    double   medianNs;     //!< the median CPU time in ns
+    uint32_t medianFrames; //!< the median amount of SPI frames with the BCC
+    uint32_t medianBusUs;  //!< the median SPI bus time with the BCC in us
+} simBenchProvisioning_t;
+
+/*! @brief the result of the provisioning benchmark */
+typedef struct
+{
+    bool                   done;       //!< false if it couldn't be done
+    int                    parameters; //!< the amount of parameters of the blob
+    int                    blobBytes;  //!< the size of the blob
+    simBenchProvisioning_t commands;   //!< setting the changed parameters one by one, like "bms set"
+    simBenchProvisioning_t import;     //!< importing the blob, like "bms import"
+} simBenchProvision_t;
+
+/*! @brief the static functions of bcc_monitoring.c */
+typedef bcc_status_t (*simBenchNtc_t)(uint16_t regVal, int16_t *temp);
+typedef uint8_t (*simBenchOcv_t)(uint8_t batteryType, uint16_t lowestCellmV, int16_t temperature);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the driver configuration of the AFE, of batManagement.c
+extern bcc_drv_config_t gBccDrvConfig;
+
+//! the gate lock of the measurement calls, the power switch isn't changed here
+static pthread_mutex_t gGateLock = PTHREAD_MUTEX_INITIALIZER;
+
+//! the variables of the measurement and the NFC update
+static commonBatteryVariables_t gCommon;
+static calcBatteryVariables_t   gCalc;
+static float                    gLowestCellVoltage = 0.0f;
+
+//! the values of the parameters, the same value is set again so nothing changes
+static uint8_t  gBattId;
+static uint16_t gNCharges;
+static int32_t  gTOcvCyclic;
+static uint64_t gModelId;
+static float    gIBatt;
+static char     gModelName[STRING_MAX_CHARS];
+static uint8_t  gBatteryType;
+static float    gAFactory;
+
+//! the messages and the buffer of the serialization
+static reg_drone_physics_electricity_SourceTs_0_1 gSourceTs;
+static reg_drone_service_battery_Status_0_2       gStatus;
+static reg_drone_service_battery_Parameters_0_3   gParameters;
+static legacy_equipment_power_BatteryInfo_1_0     gBatteryInfo;
+static uavcan_diagnostic_Record_1_1               gRecord;
+static uint8_t                                    gBuffer[SIM_BENCH_BUFFER_BYTES];
+
+//! the static functions, NULL if they aren't in the program
+static void *gpGetNtcCelsius    = NULL;
+static void *gpGetSoCBasedOnOCV = NULL;
+
+//! the input of the static functions changes with each call
+static uint16_t gInput = 0;
+
+//! the buffer that evicts the data caches
+static uint8_t *gpEvict = NULL;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   the calls of the benchmarks
+ */
+static void benchUpdateMeasurements(void)
+{
+    bcc_monitoring_updateMeasurements(
+        &gBccDrvConfig, SHUNT_RESISTOR_UOHM, &gLowestCellVoltage, true, &gCommon);
+}
+
+static void benchCalculateVariables(void)
+{
+    bcc_monitoring_calculateVariables(&gBccDrvConfig, &gGateLock, gLowestCellVoltage, &gCommon);
+}
+
+static void benchGetNtcCelsius(void)
+{
+    int16_t temperature;
+
+    // go through the range of the NTC table
+    gInput = (uint16_t)((gInput + 97) & 0x7FFF);
+    ((simBenchNtc_t)gpGetNtcCelsius)(gInput, &temperature);
+    SIM_BENCH_KEEP(&temperature);
+}
+
+static void benchGetSoCBasedOnOCV(void)
+{
+    // go through the cell voltages from 3.0 V to 4.2 V
+    gInput = (uint16_t)((gInput + 37) % 1200);
+    SIM_BENCH_KEEP(((simBenchOcv_t)gpGetSoCBasedOnOCV)(gBatteryType, (uint16_t)(3000 + gInput), 250));
+}
+
+static void benchGetUint8(void)
+{
+    uint8_t value;
+    SIM_BENCH_KEEP(data_getParameter(BATT_ID, &value, NULL));
+}
+
+static void benchGetUint16(void)
+{
+    uint16_t value;
+    SIM_BENCH_KEEP(data_getParameter(N_CHARGES, &value, NULL));
+}
+
+static void benchGetInt32(void)
+{
+    int32_t value;
+    SIM_BENCH_KEEP(data_getParameter(T_OCV_CYCLIC0, &value, NULL));
+}
+
+static void benchGetUint64(void)
+{
+    uint64_t value;
+    SIM_BENCH_KEEP(data_getParameter(MODEL_ID, &value, NULL));
+}
+
+static void benchGetFloat(void)
+{
+    float value;
+    SIM_BENCH_KEEP(data_getParameter(I_BATT, &value, NULL));
+}
+
+static void benchGetString(void)
+{
+    char     value[STRING_MAX_CHARS];
+    uint16_t length;
+    SIM_BENCH_KEEP(data_getParameter(MODEL_NAME, value, &length));
+}
+
+static void benchSetUint8(void)
+{
+    data_setParameter(BATT_ID, &gBattId);
+}
+
+static void benchSetUint16(void)
+{
+    data_setParameter(N_CHARGES, &gNCharges);
+}
+
+static void benchSetInt32(void)
+{
+    data_setParameter(T_OCV_CYCLIC0, &gTOcvCyclic);
+}
+
+static void benchSetUint64(void)
+{
+    data_setParameter(MODEL_ID, &gModelId);
+}
+
+static void benchSetFloat(void)
+{
+    data_setParameter(I_BATT, &gIBatt);
+}
+
+static void benchSetString(void)
+{
+    data_setParameter(MODEL_NAME, gModelName);
+}
+
+static void benchSaveParameters(void)
+{
+    uint8_t changed = gBattId ^ 1;
+
+    // only changed parameters are saved, it is changed and set back to save the same value
+    data_setParameter(BATT_ID, &changed);
+    data_setParameter(BATT_ID, &gBattId);
+    data_saveParameters();
+}
+
+static void benchLoadParameters(void)
+{
+    data_loadParameters();
+}
+
+static void benchSourceTs(void)
+{
+    size_t size = sizeof(gBuffer);
+    reg_drone_physics_electricity_SourceTs_0_1_serialize_(&gSourceTs, gBuffer, &size);
+    SIM_BENCH_KEEP(gBuffer);
+}
+
+static void benchStatus(void)
+{
+    size_t size = sizeof(gBuffer);
+    reg_drone_service_battery_Status_0_2_serialize_(&gStatus, gBuffer, &size);
+    SIM_BENCH_KEEP(gBuffer);
+}
+
+static void benchParameters(void)
+{
+    size_t size = sizeof(gBuffer);
+    reg_drone_service_battery_Parameters_0_3_serialize_(&gParameters, gBuffer, &size);
+    SIM_BENCH_KEEP(gBuffer);
+}
+
+static void benchBatteryInfo(void)
+{
+    size_t size = sizeof(gBuffer);
+    legacy_equipment_power_BatteryInfo_1_0_serialize_(&gBatteryInfo, gBuffer, &size);
+    SIM_BENCH_KEEP(gBuffer);
+}
+
+static void benchRecord(void)
+{
+    size_t size = sizeof(gBuffer);
+    uavcan_diagnostic_Record_1_1_serialize_(&gRecord, gBuffer, &size);
+    SIM_BENCH_KEEP(gBuffer);
+}
+
+static void benchNfcUpdate(void)
+{
+    nfc_updateBMSStatus(false, false, &gCommon, &gCalc);
+}
+
+//! the benchmarks, the measurement ones first while the measurement task is stopped
+static const simBenchEntry_t gBenchmarks[] = {
+    { "bcc_monitoring_updateMeasurements", "measurement", benchUpdateMeasurements, 4, NULL },
+    { "bcc_monitoring_calculateVariables", "measurement", benchCalculateVariables, 16, NULL },
+    { "getNtcCelsius", "measurement", benchGetNtcCelsius, 1000, &gpGetNtcCelsius },
+    { "getSoCBasedOnOCV", "measurement", benchGetSoCBasedOnOCV, 1000, &gpGetSoCBasedOnOCV },
+    { "data_getParameter(uint8)", "data", benchGetUint8, 1000, NULL },
+    { "data_getParameter(uint16)", "data", benchGetUint16, 1000, NULL },
+    { "data_getParameter(int32)", "data", benchGetInt32, 1000, NULL },
+    { "data_getParameter(uint64)", "data", benchGetUint64, 1000, NULL },
+    { "data_getParameter(float)", "data", benchGetFloat, 1000, NULL },
+    { "data_getParameter(string)", "data", benchGetString, 1000, NULL },
+    { "data_setParameter(uint8)", "data", benchSetUint8, 1000, NULL },
+    { "data_setParameter(uint16)", "data", benchSetUint16, 1000, NULL },
+    { "data_setParameter(int32)", "data", benchSetInt32, 1000, NULL },
+    { "data_setParameter(uint64)", "data", benchSetUint64, 1000, NULL },
+    { "data_setParameter(float)", "data", benchSetFloat, 1000, NULL },
+    { "data_setParameter(string)", "data", benchSetString, 1000, NULL },
+    { "data_saveParameters", "data", benchSaveParameters, 1, NULL },
+    { "data_loadParameters", "data", benchLoadParameters, 1, NULL },
+    { "reg.drone.physics.electricity.SourceTs.0.1", "serialization", benchSourceTs, 1000, NULL },
+    { "reg.drone.service.battery.Status.0.2", "serialization", benchStatus, 1000, NULL },
+    { "reg.drone.service.battery.Parameters.0.3", "serialization", benchParameters, 1000, NULL },
+    { "legacy.equipment.power.BatteryInfo.1.0", "serialization", benchBatteryInfo, 1000, NULL },
+    { "uavcan.diagnostic.Record.1.1", "serialization", benchRecord, 1000, NULL },
+    { "nfc_updateBMSStatus", "nfc", benchNfcUpdate, 4, NULL },
+};
+
+//! the amount of measurement benchmarks at the start of gBenchmarks
+#define SIM_BENCH_MEASUREMENTS 4
+
+//! @brief the amount of benchmarks
+#define SIM_BENCH_COUNT (sizeof(gBenchmarks) / sizeof(gBenchmarks[0]))
+
+/*!
+ * @brief   function to compare two samples for qsort()
+ */
+static int compareSamples(const void *pA, const void *pB)
+{
+    double a = *(const double *)pA, b = *(const double *)pB;
+
+    return (a > b) - (a < b);
+}
+
+/*!
+ * @brief   function to evict the data caches by writing a buffer larger than them
+ */
+static void evictCaches(void)
+{
+    size_t i;
+
+    for(i = 0; i < SIM_BENCH_EVICT_BYTES; i += 64)
+    {
+        gpEvict[i] = (uint8_t)(gpEvict[i] + 1);
+    }
+    SIM_BENCH_KEEP(gpEvict);
+}
+
+/*!
+ * @brief   function to get the time of reading the CPU time itself
+ *
+ * @return  the median time between two readings in ns
+ */
+static double getTimerOverhead(void)
+{
+    double   samples[SIM_BENCH_ROUNDS];
+    uint64_t startNs;
+    int      i;
+
+    for(i = 0; i < SIM_BENCH_ROUNDS; i++)
+    {
+        startNs    = sim_clock_getCpuNs();
+        samples[i] = (double)(sim_clock_getCpuNs() - startNs);
+    }
+    qsort(samples, SIM_BENCH_ROUNDS, sizeof(double), compareSamples);
+
+    return samples[SIM_BENCH_ROUNDS / 2];
+}
+
+/*!
+ * @brief   function to run a benchmark
+ *
+ * @param   pEntry the benchmark
+ * @param   timerNs the time of reading the CPU time, it is subtracted from a cold call
+ * @param   pResult address of the struct to become the result
+ */
+static void runBenchmark(const simBenchEntry_t *pEntry, double timerNs, simBenchResult_t *pResult)
+{
+    double   warm[SIM_BENCH_ROUNDS];
+    double   cold[SIM_BENCH_COLD_SAMPLES];
+    double   sum = 0.0;
+    uint64_t startNs;
+    int      i, call;
+
+    memset(pResult, 0, sizeof(simBenchResult_t));
+
+    pResult->found = (pEntry->ppFunction == NULL || *pEntry->ppFunction != NULL);
+    if(!pResult->found)
+    {
+        return;
+    }
+
+    // the first calls fill the caches and the branch predictors
+    for(call = 0; call < SIM_BENCH_WARM_UP; call++)
+    {
+        pEntry->pCall();
+    }
+
+    for(i = 0; i < SIM_BENCH_ROUNDS; i++)
+    {
+        startNs = sim_clock_getCpuNs();
+        for(call = 0; call < pEntry->calls; call++)
+        {
+            pEntry->pCall();
+        }
+        warm[i] = (double)(sim_clock_getCpuNs() - startNs) / pEntry->calls;
+        sum += warm[i];
+    }
+
+    for(i = 0; i < SIM_BENCH_COLD_SAMPLES; i++)
+    {
+        evictCaches();
+
+        startNs = sim_clock_getCpuNs();
+        pEntry->pCall();
+        cold[i] = (double)(sim_clock_getCpuNs() - startNs) - timerNs;
+        cold[i] = (cold[i] > 0.0) ? cold[i] : 0.0;
+    }
+
+    qsort(warm, SIM_BENCH_ROUNDS, sizeof(double), compareSamples);
+    qsort(cold, SIM_BENCH_COLD_SAMPLES, sizeof(double), compareSamples);
+
+    pResult->warmMin    = warm[0];
+    pResult->warmMedian = warm[SIM_BENCH_ROUNDS / 2];
+    pResult->warmMean   = sum / SIM_BENCH_ROUNDS;
+    pResult->coldMedian = cold[SIM_BENCH_COLD_SAMPLES / 2];
+    pResult->coldMax    = cold[SIM_BENCH_COLD_SAMPLES - 1];
+}
+
+/*!
+ * @brief   function to print the message of the log benchmark, it is longer than a record of the
+ *          log ring, so it is formatted completely and truncated, the worst case of a deferred message
+ *
+ * @param   number the number of the message in the burst
+ *
+ * @return  the return value of cli_printfError(), negative if it is dropped
+ */
+static int printLogMessage(int number)
+{
+    return cli_printfError("sim ERROR: %s cell %d: %.3f V, current %.3f A, temperature %.1f C\n",
+        SIM_BENCH_RECORD_TEXT, number, 3.3, -10.0, 25.0);
+}
+
+/*!
+ * @brief   function to get the median and the maximum of samples
+ *
+ * @param   pSamples the samples, they are sorted
+ * @param   count the amount of samples
+ * @param   pMedian address of the variable to become the median, 0 if there are no samples
+ * @param   pMax address of the variable to become the maximum, 0 if there are no samples
+ */
+static void getMedianMax(double *pSamples, int count, double *pMedian, double *pMax)
+{
+    *pMedian = 0.0;
+    *pMax    = 0.0;
+
+    if(count > 0)
+    {
+        qsort(pSamples, count, sizeof(double), compareSamples);
+        *pMedian = pSamples[count / 2];
+        *pMax    = pSamples[count - 1];
+    }
+}
+
+/*!
+ * @brief   function to time the error messages of a high priority task, like the BMS tasks.
+ *          A burst of messages is printed while the console is locked, so the cliLog task can't
+ *          print them yet. The first ones are put in the log ring, the rest is dropped. After the
+ *          cliLog task printed them, the same messages are timed from a task with a lower priority
+ *          that prints them itself.
+ *
+ * @param   timerNs the time of reading the CPU time, it is subtracted
+ * @param   pLog address of the struct to become the result
+ */
+static void runLogBenchmark(double timerNs, simBenchLog_t *pLog)
+{
+    double   deferred[SIM_BENCH_LOG_BURST];
+    double   dropped[SIM_BENCH_LOG_BURST];
+    double   direct[SIM_BENCH_LOG_BURST];
+    double   sampleNs;
+    uint64_t startNs;
+    int      oldPriority, result, i;
+
+    memset(pLog, 0, sizeof(simBenchLog_t));
+    pLog->burst = SIM_BENCH_LOG_BURST;
+
+    // the console is locked, like while an other task prints, and the messages are printed as a BMS task
+    cli_printLock(true);
+    oldPriority = sim_os_setPriority(SIM_BENCH_LOG_PRIORITY);
+
+    for(i = 0; i < SIM_BENCH_LOG_BURST; i++)
+    {
+        startNs  = sim_clock_getCpuNs();
+        result   = printLogMessage(i);
+        sampleNs = (double)(sim_clock_getCpuNs() - startNs) - timerNs;
+        sampleNs = (sampleNs > 0.0) ? sampleNs : 0.0;
+
+        if(result < 0)
+        {
+            dropped[pLog->dropped++] = sampleNs;
+        }
+        else
+        {
+            deferred[pLog->deferred++] = sampleNs;
+        }
+    }
+
+    // the cliLog task prints them now
+    sim_os_setPriority(oldPriority);
+    cli_printLock(false);
+    usleep(SIM_BENCH_LOG_DRAIN_US);
+
+    for(i = 0; i < SIM_BENCH_LOG_BURST; i++)
+    {
+        startNs   = sim_clock_getCpuNs();
+        printLogMessage(i);
+        direct[i] = (double)(sim_clock_getCpuNs() - startNs) - timerNs;
+        direct[i] = (direct[i] > 0.0) ? direct[i] : 0.0;
+    }
+
+    getMedianMax(deferred, pLog->deferred, &pLog->deferredMedian, &pLog->deferredMax);
+    getMedianMax(dropped, pLog->dropped, &pLog->droppedMedian, &pLog->droppedMax);
+    getMedianMax(direct, SIM_BENCH_LOG_BURST, &pLog->directMedian, &pLog->directMax);
+}
+
+/*!
+ * @brief   function to provision another pack with data_setParameter(), like the "bms set" commands do.
+ *          The battery type is another LiPo type, it sets the cell thresholds that are set after it again.
+ *
+ * @return  0 if ok, -1 if a parameter can't be set
+ */
+static int setProvisioning(void)
+{
+    uint8_t  batteryType = (gBatteryType == 0) ? 3 : 0;
+    uint8_t  sleepCurrent = 40;
+    uint16_t tMeas        = 500;
+    float    aFactory     = gAFactory * 1.5f;
+    float    cellOv       = 4.25f;
+    float    cellUv       = 3.1f;
+    float    cellOt       = 50.0f;
+    float    pcbOt        = 50.0f;
+    int      error        = 0;
+
+    error |= data_setParameter(BATTERY_TYPE, &batteryType);
+    error |= data_setParameter(A_FACTORY, &aFactory);
+    error |= data_setParameter(V_CELL_OV, &cellOv);
+    error |= data_setParameter(V_CELL_UV, &cellUv);
+    error |= data_setParameter(C_CELL_OT, &cellOt);
+    error |= data_setParameter(C_PCB_OT, &pcbOt);
+    error |= data_setParameter(I_SLEEP_OC, &sleepCurrent);
+    error |= data_setParameter(T_MEAS, &tMeas);
+    error |= data_setParameter(MODEL_NAME, SIM_BENCH_PROVISION_NAME);
+
+    return error ? -1 : 0;
+}
+
+/*!
+ * @brief   function to get the median CPU time, SPI frames and bus time of the provisioning rounds
+ *
+ * @param   pNs the CPU time of each round, they are sorted
+ * @param   pFrames the frames of each round, they are sorted
+ * @param   pBusUs the bus time of each round, they are sorted
+ * @param   pResult address of the struct to become the result
+ */
+static void getProvisioningMedian(double *pNs, double *pFrames, double *pBusUs, simBenchProvisioning_t *pResult)
+{
+    double max;
+    double median;
+
+    getMedianMax(pNs, SIM_BENCH_PROVISION_ROUNDS, &pResult->medianNs, &max);
+    getMedianMax(pFrames, SIM_BENCH_PROVISION_ROUNDS, &median, &max);
+    pResult->medianFrames = (uint32_t)median;
+    getMedianMax(pBusUs, SIM_BENCH_PROVISION_ROUNDS, &median, &max);
+    pResult->medianBusUs = (uint32_t)median;
+}
+
+/*!
+ * @brief   function to time the provisioning of a pack with a parameter blob against setting the
+ *          parameters one by one. Each round starts from the parameters the BMS has, which are imported
+ *          again after it. The CPU time of the host thread, the SPI frames with the BCC and their bus
+ *          time are measured, the bus time is the one of the board and is most of the time on the MCU.
+ *
+ * @param   timerNs the time of reading the CPU time, it is subtracted
+ * @param   pProvision address of the struct to become the result
+ */
+static void runProvisioningBenchmark(double timerNs, simBenchProvision_t *pProvision)
+{
+    static uint8_t  original[PARAMETER_BLOB_MAX_SIZE];
+    static uint8_t  provisioned[PARAMETER_BLOB_MAX_SIZE];
+    double          commandsNs[SIM_BENCH_PROVISION_ROUNDS], importNs[SIM_BENCH_PROVISION_ROUNDS];
+    double          commandsFrames[SIM_BENCH_PROVISION_ROUNDS], importFrames[SIM_BENCH_PROVISION_ROUNDS];
+    double          commandsBusUs[SIM_BENCH_PROVISION_ROUNDS], importBusUs[SIM_BENCH_PROVISION_ROUNDS];
+    parameterKind_t next = (parameterKind_t)0;
+    int             originalLength, provisionedLength, round, result;
+    uint64_t        startNs, startBusUs, endBusUs;
+    uint32_t        startFrames, endFrames;
+
+    memset(pProvision, 0, sizeof(simBenchProvision_t));
+
+    // the blob of the parameters it has, to go back to
+    originalLength = data_exportParameters(original, sizeof(original), &next);
+    if(originalLength < 0 || next != NONE)
+    {
+        return;
+    }
+
+    // the blob of the provisioned pack
+    next              = (parameterKind_t)0;
+    result            = setProvisioning();
+    provisionedLength = data_exportParameters(provisioned, sizeof(provisioned), &next);
+    if(data_importParameters(original, originalLength) < 0 || result || provisionedLength < 0 || next != NONE)
+    {
+        return;
+    }
+
+    for(round = 0; round < SIM_BENCH_PROVISION_ROUNDS; round++)
+    {
+        // set them one by one
+        sim_dev_getBccTraffic(&startFrames, &startBusUs);
+        startNs = sim_clock_getCpuNs();
+        result  = setProvisioning();
+        commandsNs[round] = (double)(sim_clock_getCpuNs() - startNs) - timerNs;
+        sim_dev_getBccTraffic(&endFrames, &endBusUs);
+        commandsFrames[round] = endFrames - startFrames;
+        commandsBusUs[round]  = (double)(endBusUs - startBusUs);
+
+        if(result || data_importParameters(original, originalLength) < 0)
+        {
+            return;
+        }
+
+        // import the blob
+        sim_dev_getBccTraffic(&startFrames, &startBusUs);
+        startNs = sim_clock_getCpuNs();
+        result  = data_importParameters(provisioned, provisionedLength);
+        importNs[round] = (double)(sim_clock_getCpuNs() - startNs) - timerNs;
+        sim_dev_getBccTraffic(&endFrames, &endBusUs);
+        importFrames[round] = endFrames - startFrames;
+        importBusUs[round]  = (double)(endBusUs - startBusUs);
+
+        if(result < 0 || data_importParameters(original, originalLength) < 0)
+        {
+            return;
+        }
+
+        pProvision->parameters = result;
+    }
+
+    pProvision->blobBytes = provisionedLength;
+    getProvisioningMedian(commandsNs, commandsFrames, commandsBusUs, &pProvision->commands);
+    getProvisioningMedian(importNs, importFrames, importBusUs, &pProvision->import);
+    pProvision->done = true;
+}
+
+/*!
+ * @brief   function to fill the values of the parameters and the messages
+ *
+ * @return  0 if ok, -1 if a parameter can't be read
+ */
+static int prepareInputs(void)
+{
+    size_t size;
+    int8_t error = 0;
+    int    i;
+
+    // the parameters are set with the value they have
+    if(data_getParameter(BATT_ID, &gBattId, NULL) == NULL ||
+        data_getParameter(N_CHARGES, &gNCharges, NULL) == NULL ||
+        data_getParameter(T_OCV_CYCLIC0, &gTOcvCyclic, NULL) == NULL ||
+        data_getParameter(MODEL_ID, &gModelId, NULL) == NULL ||
+        data_getParameter(I_BATT, &gIBatt, NULL) == NULL ||
+        data_getParameter(MODEL_NAME, gModelName, NULL) == NULL ||
+        data_getParameter(BATTERY_TYPE, &gBatteryType, NULL) == NULL ||
+        data_getParameter(A_FACTORY, &gAFactory, NULL) == NULL ||
+        data_getCalcBatteryVariables(&gCalc, false))
+    {
+        return -1;
+    }
+
+    // the messages are filled like the application does
+    reg_drone_physics_electricity_SourceTs_0_1_initialize_(&gSourceTs);
+    gSourceTs.value.power.current.ampere = gIBatt;
+    gSourceTs.value.power.voltage.volt   = gCommon.V_out;
+    gSourceTs.value.energy.joule         = 61200.0f;
+    gSourceTs.value.full_energy.joule    = 183600.0f;
+
+    reg_drone_service_battery_Status_0_2_initialize_(&gStatus);
+    gStatus.temperature_min_max[0].kelvin = 273.15f + gCommon.C_batt;
+    gStatus.temperature_min_max[1].kelvin = 273.15f + gCommon.C_batt;
+    gStatus.available_charge.coulomb      = gCalc.A_rem * 3600.0f;
+    gStatus.cell_voltages.count           = SIM_MAX_CELLS;
+    for(i = 0; i < SIM_MAX_CELLS; i++)
+    {
+        gStatus.cell_voltages.elements[i] = gCommon.V_cellVoltages.V_cellArr[i];
+    }
+
+    reg_drone_service_battery_Parameters_0_3_initialize_(&gParameters);
+    gParameters.unique_id                           = gModelId;
+    gParameters.design_capacity.coulomb             = gCalc.A_full * 3600.0f;
+    gParameters.design_cell_voltage_min_max[0].volt = 3.0f;
+    gParameters.design_cell_voltage_min_max[1].volt = 4.2f;
+    gParameters.discharge_current.ampere            = 60.0f;
+    gParameters.cycle_count                         = gNCharges;
+    gParameters.state_of_health_pct                 = gCalc.s_health;
+
+    legacy_equipment_power_BatteryInfo_1_0_initialize_(&gBatteryInfo);
+    gBatteryInfo.temperature         = 273.15f + gCommon.C_batt;
+    gBatteryInfo.voltage             = gCommon.V_out;
+    gBatteryInfo.current             = gIBatt;
+    gBatteryInfo.state_of_charge_pct = gCalc.s_charge;
+    gBatteryInfo.battery_id          = gBattId;
+    gBatteryInfo.model_instance_id   = (uint32_t)gModelId;
+    gBatteryInfo.model_name.count    = strnlen(gModelName,
+        legacy_equipment_power_BatteryInfo_1_0_model_name_ARRAY_CAPACITY_);
+    memcpy(gBatteryInfo.model_name.elements, gModelName, gBatteryInfo.model_name.count);
+
+    uavcan_diagnostic_Record_1_1_initialize_(&gRecord);
+    gRecord.severity.value = uavcan_diagnostic_Severity_1_0_ERROR;
+    gRecord.text.count     = strlen(SIM_BENCH_RECORD_TEXT);
+    memcpy(gRecord.text.elements, SIM_BENCH_RECORD_TEXT, gRecord.text.count);
+
+    // a message that can't be serialized would only time the error
+    size = sizeof(gBuffer);
+    error |= reg_drone_physics_electricity_SourceTs_0_1_serialize_(&gSourceTs, gBuffer, &size);
+    size = sizeof(gBuffer);
+    error |= reg_drone_service_battery_Status_0_2_serialize_(&gStatus, gBuffer, &size);
+    size = sizeof(gBuffer);
+    error |= reg_drone_service_battery_Parameters_0_3_serialize_(&gParameters, gBuffer, &size);
+    size = sizeof(gBuffer);
+    error |= legacy_equipment_power_BatteryInfo_1_0_serialize_(&gBatteryInfo, gBuffer, &size);
+    size = sizeof(gBuffer);
+    error |= uavcan_diagnostic_Record_1_1_serialize_(&gRecord, gBuffer, &size);
+
+    return (error < 0) ? -1 : 0;
+}
+
+/*!
+ * @brief   function to wait until the measurement task of batManagement.c waits to be started again
+ *
+ * @param   waitUs the time to wait for it in us
+ *
+ * @return  true if it waits
+ */
+static bool waitForMeasurementsStopped(uint64_t waitUs)
+{
+    uint64_t waitedUs = 0;
+    bool     on       = true;
+
+    // the task finishes the measurement it is doing
+    while(!batManagement_getBatManagementStatus(&on) && on)
+    {
+        if(waitedUs >= waitUs)
+        {
+            return false;
+        }
+
+        usleep(SIM_BENCH_POLL_US);
+        waitedUs += SIM_BENCH_POLL_US;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief   function to stop or start the measurement task of batManagement.c
+ *          The main loop may start them again right after they are stopped, when it handles the
+ *          NORMAL state the first time. They are stopped until they stay stopped for a main loop period.
+ *
+ * @param   enable true to start it again
+ *
+ * @return  0 if ok, -1 if it doesn't stop
+ */
+static int enableMeasurements(bool enable)
+{
+    bool on = true;
+    int  tries;
+
+    if(enable)
+    {
+        batManagement_enableBatManagementTask(true);
+        return 0;
+    }
+
+    for(tries = 0; tries < SIM_BENCH_STOP_TRIES; tries++)
+    {
+        batManagement_enableBatManagementTask(false);
+
+        if(!waitForMeasurementsStopped(SIM_BENCH_STOP_US))
+        {
+            continue;
+        }
+
+        // check if the main loop didn't start them again
+        usleep(SIM_BENCH_SETTLE_US);
+        if(!batManagement_getBatManagementStatus(&on) && !on)
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * @brief   function to write a string to the JSON file, quotes and backslashes are escaped
+ *
+ * @param   pFile the file
+ * @param   pString the string
+ */
+static void writeString(FILE *pFile, const char *pString)
+{
+    fputc('"', pFile);
+    for(; *pString != '\0'; pString++)
+    {
+        if(*pString == '"' || *pString == '\\')
+        {
+            fputc('\\', pFile);
+        }
+        if((unsigned char)*pString >= ' ')
+        {
+            fputc(*pString, pFile);
+        }
+    }
+    fputc('"', pFile);
+}
+
+/*!
+ * @brief   function to get the CPU model of the host
+ *
+ * @param   pModel the buffer of the model
+ * @param   size the size of the buffer
+ */
+static void getCpuModel(char *pModel, size_t size)
+{
+    FILE *pFile = fopen("/proc/cpuinfo", "r");
+    char  line[256];
+    char *pValue;
+
+    snprintf(pModel, size, "unknown");
+
+    while(pFile != NULL && fgets(line, sizeof(line), pFile) != NULL)
+    {
+        pValue = strchr(line, ':');
+        if(!strncmp(line, "model name", strlen("model name")) && pValue != NULL)
+        {
+            pValue += strspn(pValue, ": \t");
+            pValue[strcspn(pValue, "\n")] = '\0';
+            snprintf(pModel, size, "%s", pValue);
+            break;
+        }
+    }
+
+    if(pFile != NULL)
+    {
+        fclose(pFile);
+    }
+}
+
+/*!
+ * @brief   function to write the results as JSON
+ *
+ * @param   pFile the file
+ * @param   pResults the results, in the order of gBenchmarks
+ * @param   pLog the result of the log benchmark
+ * @param   pProvision the result of the provisioning benchmark
+ * @param   timerNs the time of reading the CPU time
+ */
+static void writeResults(FILE *pFile, const simBenchResult_t *pResults, const simBenchLog_t *pLog,
+    const simBenchProvision_t *pProvision, double timerNs)
+{
+    struct utsname system;
+    char           version[32];
+    char           cpu[128];
+    size_t         i;
+
+    snprintf(version, sizeof(version), "BMS%d.%d", BMS_MAJOR_VERSION_NUMBER, BMS_MINOR_VERSION_NUMBER);
+    getCpuModel(cpu, sizeof(cpu));
+    if(uname(&system))
+    {
+        memset(&system, 0, sizeof(system));
+    }
+
+    fprintf(pFile, "{\n  \"version\": ");
+    writeString(pFile, version);
+    fprintf(pFile, ",\n  \"host\": { \"system\": ");
+    writeString(pFile, system.sysname);
+    fprintf(pFile, ", \"release\": ");
+    writeString(pFile, system.release);
+    fprintf(pFile, ", \"machine\": ");
+    writeString(pFile, system.machine);
+    fprintf(pFile, ", \"cpu\": ");
+    writeString(pFile, cpu);
+    fprintf(pFile, " },\n  \"unit\": \"ns\",\n  \"clock\": \"thread cpu time\",\n");
+    fprintf(pFile, "  \"timer_overhead_ns\": %.1f,\n  \"rounds\": %d,\n  \"cold_samples\": %d,\n", timerNs,
+        SIM_BENCH_ROUNDS, SIM_BENCH_COLD_SAMPLES);
+    fprintf(pFile, "  \"benchmarks\": [\n");
+
+    for(i = 0; i < SIM_BENCH_COUNT; i++)
+    {
+        fprintf(pFile, "    { \"name\": ");
+        writeString(pFile, gBenchmarks[i].pName);
+        fprintf(pFile, ", \"group\": ");
+        writeString(pFile, gBenchmarks[i].pGroup);
+        fprintf(pFile, ", \"found\": %s, \"calls_per_round\": %d", pResults[i].found ? "true" : "false",
+            gBenchmarks[i].calls);
+
+        if(pResults[i].found)
+        {
+            fprintf(pFile,
+                ",\n      \"warm_min_ns\": %.1f, \"warm_median_ns\": %.1f, \"warm_mean_ns\": %.1f,"
+                " \"cold_median_ns\": %.1f, \"cold_max_ns\": %.1f",
+                pResults[i].warmMin, pResults[i].warmMedian, pResults[i].warmMean, pResults[i].coldMedian,
+                pResults[i].coldMax);
+        }
+
+        fprintf(pFile, " }%s\n", (i + 1 < SIM_BENCH_COUNT) ? "," : "");
+    }
+
+    fprintf(pFile, "  ],\n  \"log\": { \"priority\": %d, \"burst\": %d, \"deferred\": %d, \"dropped\": %d,\n",
+        SIM_BENCH_LOG_PRIORITY, pLog->burst, pLog->deferred, pLog->dropped);
+    fprintf(pFile,
+        "    \"deferred_median_ns\": %.1f, \"deferred_max_ns\": %.1f,"
+        " \"dropped_median_ns\": %.1f, \"dropped_max_ns\": %.1f,\n",
+        pLog->deferredMedian, pLog->deferredMax, pLog->droppedMedian, pLog->droppedMax);
+    fprintf(pFile, "    \"direct_median_ns\": %.1f, \"direct_max_ns\": %.1f },\n", pLog->directMedian,
+        pLog->directMax);
+    fprintf(pFile, "  \"provisioning\": { \"done\": %s, \"rounds\": %d, \"parameters\": %d, \"blob_bytes\": %d,\n",
+        pProvision->done ? "true" : "false", SIM_BENCH_PROVISION_ROUNDS, pProvision->parameters,
+        pProvision->blobBytes);
+    fprintf(pFile,
+        "    \"commands_median_ns\": %.1f, \"commands_bcc_frames\": %u, \"commands_bcc_bus_us\": %u,\n",
+        pProvision->commands.medianNs, pProvision->commands.medianFrames, pProvision->commands.medianBusUs);
+    fprintf(pFile, "    \"import_median_ns\": %.1f, \"import_bcc_frames\": %u, \"import_bcc_bus_us\": %u }\n}\n",
+        pProvision->import.medianNs, pProvision->import.medianFrames, pProvision->import.medianBusUs);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+int sim_bench_run(void)
+{
+    simBenchResult_t    results[SIM_BENCH_COUNT];
+    simBenchLog_t       log;
+    simBenchProvision_t provision;
+    FILE               *pFile;
+    uint64_t            waitedUs = 0;
+    double              timerNs;
+    size_t              i;
+
+    // wait until the BMS has done its self test
+    while(data_getMainState() != NORMAL)
+    {
+        if(waitedUs >= SIM_BENCH_START_US)
+        {
+            fprintf(stderr, "sim: the BMS isn't in the normal state after %llu s, it is in %s\n",
+                SIM_BENCH_START_US / 1000000, cli_getStateString(true, (uint8_t)data_getMainState(), NULL));
+            return SIM_BENCH_EXIT_NO_START;
+        }
+
+        usleep(SIM_BENCH_POLL_US);
+        waitedUs += SIM_BENCH_POLL_US;
+    }
+
+    gpEvict            = calloc(1, SIM_BENCH_EVICT_BYTES);
+    gpGetNtcCelsius    = sim_profile_findFunction("getNtcCelsius");
+    gpGetSoCBasedOnOCV = sim_profile_findFunction("getSoCBasedOnOCV");
+
+    // the measurement task uses the AFE as well, it is stopped for the measurement benchmarks
+    if(gpEvict == NULL || enableMeasurements(false) ||
+        bcc_monitoring_doBlockingMeasurement(&gBccDrvConfig) != BCC_STATUS_SUCCESS ||
+        bcc_monitoring_updateMeasurements(
+            &gBccDrvConfig, SHUNT_RESISTOR_UOHM, &gLowestCellVoltage, true, &gCommon) != BCC_STATUS_SUCCESS ||
+        prepareInputs())
+    {
+        fprintf(stderr, "sim: can't prepare the benchmark!\n");
+        free(gpEvict);
+        return SIM_BENCH_EXIT_ERROR;
+    }
+
+    timerNs = getTimerOverhead();
+
+    for(i = 0; i < SIM_BENCH_COUNT; i++)
+    {
+        // the measurements are done, the measurement task may run again
+        if(i == SIM_BENCH_MEASUREMENTS)
+        {
+            enableMeasurements(true);
+        }
+
+        runBenchmark(&gBenchmarks[i], timerNs, &results[i]);
+
+        printf("bench: %-45s %12.1f ns (cold %.1f ns)\n", gBenchmarks[i].pName, results[i].warmMedian,
+            results[i].coldMedian);
+    }
+
+    free(gpEvict);
+
+    runLogBenchmark(timerNs, &log);
+
+    printf("bench: cli_printfError (deferred)  %d of %d, median %.1f ns, max %.1f ns\n", log.deferred, log.burst,
+        log.deferredMedian, log.deferredMax);
+    printf("bench: cli_printfError (dropped)   %d of %d, median %.1f ns, max %.1f ns\n", log.dropped, log.burst,
+        log.droppedMedian, log.droppedMax);
+    printf("bench: cli_printfError (direct)    %d of %d, median %.1f ns, max %.1f ns\n", log.burst, log.burst,
+        log.directMedian, log.directMax);
+
+    // the measurement task uses the AFE as well, it is stopped to count the frames of the provisioning
+    if(!enableMeasurements(false))
+    {
+        runProvisioningBenchmark(timerNs, &provision);
+        enableMeasurements(true);
+    }
+    else
+    {
+        memset(&provision, 0, sizeof(provision));
+    }
+
+    if(!provision.done)
+    {
+        fprintf(stderr, "sim: can't do the provisioning benchmark!\n");
+        return SIM_BENCH_EXIT_ERROR;
+    }
+
+    printf("bench: provisioning (commands)  %.1f ns, %u BCC frames, %u us SPI\n", provision.commands.medianNs,
+        provision.commands.medianFrames, provision.commands.medianBusUs);
+    printf("bench: provisioning (import)    %.1f ns, %u BCC frames, %u us SPI, %d parameters in %d bytes\n",
+        provision.import.medianNs, provision.import.medianFrames, provision.import.medianBusUs,
+        provision.parameters, provision.blobBytes);
+
+    // "-" is the standard output
+    pFile = strcmp(gSimConfig.benchPath, "-") ? fopen(gSimConfig.benchPath, "w") : stdout;
+    if(pFile == NULL)
+    {
+        perror("sim: can't write the benchmark file");
+        return SIM_BENCH_EXIT_ERROR;
+    }
+
+    writeResults(pFile, results, &log, &provision, timerNs);
+
+    if(pFile != stdout)
+    {
+        fclose(pFile);
+    }
+
+    return SIM_BENCH_EXIT_OK;
+}
@@ -0,0 +1,744 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_clock.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The clock of the simulation and the calls that wait on it.
+ * Normally this is the clock of the host. With the virtual clock (used by
+ * the replay) the time only moves when all tasks wait: then it jumps to the
+ * first deadline of a waiting task. So the application runs as fast as the
+ * host allows, while its tasks see the same timing as in real time.
+ * For this every call of the application that can wait is wrapped by the
+ * linker: the clocks, the sleeps, the semaphores and the mutexes.
+ * sem_getvalue() is negative with the amount of waiting tasks like on NuttX,
+ * the application posts some semaphores only if a task waits on it.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the maximum amount of threads that can wait on the virtual clock
+#define SIM_CLOCK_MAX_THREADS   48
+
+//! @brief the maximum amount of semaphores that have tasks waiting on them at once
+#define SIM_CLOCK_MAX_SEMS      64
+
+//! @brief the exit code when all tasks wait without a timeout
+#define SIM_CLOCK_EXIT_DEADLOCK 3
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a thread that waits on the virtual clock */
+typedef struct
+{
+    bool        used;       //!< true if this entry is a thread
+    bool        waiting;    //!< true if the thread waits and is counted in gWaitingThreads
+    bool        timed;      //!< true if the wait has a deadline
+    uint64_t    deadlineNs; //!< the deadline of the wait in virtual ns
+    const void *pObject;    //!< the semaphore or mutex it waits on, NULL if none
+    const char *pName;      //!< the name of the thread
+    const char *pWaitsOn;   //!< the call it waits in, for the deadlock report
+    pthread_cond_t cond;    //!< the condition the thread waits on, with gClockLock
+} simClockThread_t;
+
+/*! @brief the waiting tasks of a semaphore */
+typedef struct
+{
+    sem_t *pSem;    //!< the semaphore, NULL if this entry is free
+    int    waiters; //!< the amount of tasks waiting on it
+} simSemWaiters_t;
+
+/*! @brief the argument of the mutex condition */
+typedef struct
+{
+    pthread_mutex_t *pMutex; //!< the mutex to lock
+    int              result; //!< the result of the last try
+} simClockMutexTry_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! true if the virtual clock is used
+static bool gVirtual = false;
+
+//! the lock of the virtual clock, this uses the real (not wrapped) calls
+static pthread_mutex_t gClockLock = PTHREAD_MUTEX_INITIALIZER;
+
+//! the virtual time in ns since the start, written with gClockLock
+static uint64_t gNowNs = 0;
+
+//! the host clocks at the start, the virtual clocks start from there
+static uint64_t gRealtimeBaseNs  = 0;
+static uint64_t gMonotonicBaseNs = 0;
+
+//! the threads, the amount of them and the amount that waits
+static simClockThread_t gThreads[SIM_CLOCK_MAX_THREADS];
+static int              gThreadCount    = 0;
+static int              gWaitingThreads = 0;
+
+//! the thread entry of the calling thread
+static __thread simClockThread_t *gpThisThread = NULL;
+
+//! the amount of tasks that wait on a mutex, an unlock only needs to wake them if there are any
+static int gMutexWaiters = 0;
+
+//! the semaphores with waiting tasks, glibc doesn't count them
+static simSemWaiters_t gSemWaiters[SIM_CLOCK_MAX_SEMS];
+static pthread_mutex_t gSemWaitersLock = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+int __real_clock_gettime(clockid_t clockId, struct timespec *tp);
+int __real_sem_wait(sem_t *sem);
+int __real_sem_timedwait(sem_t *sem, const struct timespec *abstime);
+int __real_sem_getvalue(sem_t *sem, int *sval);
+int __real_sem_post(sem_t *sem);
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+int __real_pthread_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *abstime);
+int __real_pthread_mutex_unlock(pthread_mutex_t *mutex);
+int __real_clock_nanosleep(clockid_t clockId, int flags, const struct timespec *req, struct timespec *rem);
+int __real_nanosleep(const struct timespec *req, struct timespec *rem);
+int __real_usleep(useconds_t usec);
+
+/*!
+ * @brief   function to convert a timespec to ns
+ *
+ * @param   pTs the timespec
+ *
+ * @return  the time in ns
+ */
+static uint64_t tsToNs(const struct timespec *pTs)
+{
+    return (uint64_t)pTs->tv_sec * 1000000000ULL + (uint64_t)pTs->tv_nsec;
+}
+
+/*!
+ * @brief   function to convert an absolute time of a clock to virtual ns
+ *
+ * @param   clockId the clock of the time
+ * @param   pTs the time
+ *
+ * @return  the virtual time in ns
+ */
+static uint64_t absToVirtualNs(clockid_t clockId, const struct timespec *pTs)
+{
+    uint64_t timeNs = tsToNs(pTs);
+    uint64_t baseNs = (clockId == CLOCK_REALTIME) ? gRealtimeBaseNs : gMonotonicBaseNs;
+
+    return (timeNs > baseNs) ? (timeNs - baseNs) : 0;
+}
+
+/*!
+ * @brief   function to find a free thread entry and count it
+ * @note    gClockLock needs to be locked.
+ *
+ * @param   pName the name of the thread
+ *
+ * @return  the entry, NULL if there is none
+ */
+static simClockThread_t *addThreadLocked(const char *pName)
+{
+    int i;
+
+    for(i = 0; i < SIM_CLOCK_MAX_THREADS; i++)
+    {
+        if(!gThreads[i].used)
+        {
+            // the condition is kept when an entry is used again
+            if(gThreads[i].pName == NULL)
+            {
+                pthread_cond_init(&gThreads[i].cond, NULL);
+            }
+            gThreads[i].used    = true;
+            gThreads[i].waiting = false;
+            gThreads[i].timed   = false;
+            gThreads[i].pObject = NULL;
+            gThreads[i].pName   = pName;
+            gThreadCount++;
+            return &gThreads[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief   function to wake a waiting thread, it will check its wait again
+ * @note    gClockLock needs to be locked.
+ *
+ * @param   pThread the thread
+ */
+static void wakeLocked(simClockThread_t *pThread)
+{
+    // a woken thread is running until it waits again
+    pThread->waiting = false;
+    gWaitingThreads--;
+
+    pthread_cond_signal(&pThread->cond);
+}
+
+/*!
+ * @brief   function to move the virtual time to the first deadline if all threads wait
+ *          if all threads wait without a deadline, nothing can happen anymore and the simulation ends.
+ * @note    gClockLock needs to be locked.
+ */
+static void advanceIfIdleLocked(void)
+{
+    uint64_t firstNs = UINT64_MAX;
+    int      i;
+
+    if(gWaitingThreads < gThreadCount)
+    {
+        return;
+    }
+
+    // find the first deadline
+    for(i = 0; i < SIM_CLOCK_MAX_THREADS; i++)
+    {
+        if(gThreads[i].used && gThreads[i].timed && gThreads[i].deadlineNs < firstNs)
+        {
+            firstNs = gThreads[i].deadlineNs;
+        }
+    }
+
+    if(firstNs == UINT64_MAX)
+    {
+        fprintf(stderr, "sim: deadlock, all tasks wait without a timeout:\n");
+        for(i = 0; i < SIM_CLOCK_MAX_THREADS; i++)
+        {
+            if(gThreads[i].used)
+            {
+                fprintf(stderr, "  %s in %s\n", gThreads[i].pName, gThreads[i].pWaitsOn);
+            }
+        }
+        exit(SIM_CLOCK_EXIT_DEADLOCK);
+    }
+
+    // jump to it
+    if(firstNs > gNowNs)
+    {
+        __atomic_store_n(&gNowNs, firstNs, __ATOMIC_RELEASE);
+    }
+
+    // wake the threads of which the deadline has passed
+    for(i = 0; i < SIM_CLOCK_MAX_THREADS; i++)
+    {
+        if(gThreads[i].used && gThreads[i].waiting && gThreads[i].timed && gThreads[i].deadlineNs <= gNowNs)
+        {
+            wakeLocked(&gThreads[i]);
+        }
+    }
+}
+
+/*!
+ * @brief   function to wait on the virtual clock until a condition is true or the deadline has passed
+ *
+ * @param   pWaitsOn the name of the call that waits
+ * @param   pObject the semaphore or mutex of the condition, NULL if none
+ * @param   timed true if there is a deadline
+ * @param   deadlineNs the deadline in virtual ns
+ * @param   pCondition the condition, it returns true if the wait is done, may be NULL
+ * @param   pArg the argument of the condition
+ *
+ * @return  0 if the condition is true, ETIMEDOUT if the deadline has passed
+ */
+static int virtualWait(const char *pWaitsOn, const void *pObject, bool timed, uint64_t deadlineNs,
+    bool (*pCondition)(void *), void *pArg)
+{
+    simClockThread_t *pThis;
+    int               lvRetValue;
+
+    __real_pthread_mutex_lock(&gClockLock);
+
+    // a thread that isn't made by the simulation is counted from its first wait
+    if(gpThisThread == NULL)
+    {
+        gpThisThread = addThreadLocked("thread");
+    }
+    pThis = gpThisThread;
+
+    while(1)
+    {
+        if(pCondition != NULL && pCondition(pArg))
+        {
+            lvRetValue = 0;
+            break;
+        }
+        if(timed && gNowNs >= deadlineNs)
+        {
+            lvRetValue = ETIMEDOUT;
+            break;
+        }
+
+        // count it as waiting, the last thread to wait moves the time
+        if(!pThis->waiting)
+        {
+            pThis->waiting    = true;
+            pThis->timed      = timed;
+            pThis->deadlineNs = deadlineNs;
+            pThis->pObject    = pObject;
+            pThis->pWaitsOn   = pWaitsOn;
+            gWaitingThreads++;
+        }
+        advanceIfIdleLocked();
+
+        if(pThis->waiting)
+        {
+            pthread_cond_wait(&pThis->cond, &gClockLock);
+        }
+    }
+
+    if(pThis->waiting)
+    {
+        pThis->waiting = false;
+        gWaitingThreads--;
+    }
+
+    __real_pthread_mutex_unlock(&gClockLock);
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   function to wake the threads that wait on a semaphore or mutex, after it is released
+ *
+ * @param   pObject the semaphore or mutex
+ */
+static void wakeWaiters(const void *pObject)
+{
+    int i;
+
+    __real_pthread_mutex_lock(&gClockLock);
+
+    for(i = 0; i < SIM_CLOCK_MAX_THREADS; i++)
+    {
+        if(gThreads[i].used && gThreads[i].waiting && gThreads[i].pObject == pObject)
+        {
+            wakeLocked(&gThreads[i]);
+        }
+    }
+
+    __real_pthread_mutex_unlock(&gClockLock);
+}
+
+/*!
+ * @brief   the conditions of the waits
+ *
+ * @param   pArg the semaphore or the simClockMutexTry_t
+ *
+ * @return  true if the wait is done
+ */
+static bool semCondition(void *pArg)
+{
+    return sem_trywait((sem_t *)pArg) == 0;
+}
+
+static bool mutexCondition(void *pArg)
+{
+    simClockMutexTry_t *pTry = (simClockMutexTry_t *)pArg;
+
+    pTry->result = pthread_mutex_trylock(pTry->pMutex);
+
+    return pTry->result != EBUSY;
+}
+
+/*!
+ * @brief   function to count a task that starts or stops waiting on a semaphore
+ *
+ * @param   pSem the semaphore
+ * @param   change 1 if a task starts waiting, -1 if it stops
+ */
+static void countSemWaiter(sem_t *pSem, int change)
+{
+    simSemWaiters_t *pFree = NULL;
+    int              i;
+
+    __real_pthread_mutex_lock(&gSemWaitersLock);
+
+    for(i = 0; i < SIM_CLOCK_MAX_SEMS; i++)
+    {
+        if(gSemWaiters[i].pSem == pSem)
+        {
+            // free the entry when the last task stops waiting
+            gSemWaiters[i].waiters += change;
+            if(gSemWaiters[i].waiters <= 0)
+            {
+                gSemWaiters[i].pSem = NULL;
+            }
+            __real_pthread_mutex_unlock(&gSemWaitersLock);
+            return;
+        }
+
+        if(pFree == NULL && gSemWaiters[i].pSem == NULL)
+        {
+            pFree = &gSemWaiters[i];
+        }
+    }
+
+    // a new waiting semaphore, if the table is full the waiter isn't counted
+    if(change > 0 && pFree != NULL)
+    {
+        pFree->pSem    = pSem;
+        pFree->waiters = change;
+    }
+
+    __real_pthread_mutex_unlock(&gSemWaitersLock);
+}
+
+/*!
+ * @brief   function to wait on a semaphore
+ *
+ * @param   pSem the semaphore
+ * @param   pAbstime the CLOCK_REALTIME deadline, NULL to wait without one
+ *
+ * @return  0 if ok, -1 with errno set if not
+ */
+static int semWait(sem_t *pSem, const struct timespec *pAbstime)
+{
+    int lvRetValue;
+
+    countSemWaiter(pSem, 1);
+
+    if(!gVirtual)
+    {
+        lvRetValue = (pAbstime != NULL) ? __real_sem_timedwait(pSem, pAbstime) : __real_sem_wait(pSem);
+    }
+    else if(sem_trywait(pSem) == 0)
+    {
+        lvRetValue = 0;
+    }
+    else
+    {
+        lvRetValue = virtualWait((pAbstime != NULL) ? "sem_timedwait" : "sem_wait", pSem, pAbstime != NULL,
+            (pAbstime != NULL) ? absToVirtualNs(CLOCK_REALTIME, pAbstime) : 0, semCondition, pSem);
+        if(lvRetValue)
+        {
+            errno      = lvRetValue;
+            lvRetValue = -1;
+        }
+    }
+
+    countSemWaiter(pSem, -1);
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   function to lock a mutex on the virtual clock
+ *
+ * @param   pMutex the mutex
+ * @param   pAbstime the CLOCK_REALTIME deadline, NULL to wait without one
+ *
+ * @return  0 if ok, the error otherwise
+ */
+static int mutexLock(pthread_mutex_t *pMutex, const struct timespec *pAbstime)
+{
+    simClockMutexTry_t lvTry = { pMutex, EBUSY };
+    int                lvRetValue;
+
+    // most of the time it is free
+    lvTry.result = pthread_mutex_trylock(pMutex);
+    if(lvTry.result != EBUSY)
+    {
+        return lvTry.result;
+    }
+
+    // an unlock after this will wake the waiters
+    __atomic_add_fetch(&gMutexWaiters, 1, __ATOMIC_SEQ_CST);
+
+    lvRetValue = virtualWait((pAbstime != NULL) ? "pthread_mutex_timedlock" : "pthread_mutex_lock", pMutex,
+        pAbstime != NULL, (pAbstime != NULL) ? absToVirtualNs(CLOCK_REALTIME, pAbstime) : 0, mutexCondition,
+        &lvTry);
+
+    __atomic_sub_fetch(&gMutexWaiters, 1, __ATOMIC_SEQ_CST);
+
+    return lvRetValue ? lvRetValue : lvTry.result;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_clock_initialize(bool virtualClock)
+{
+    struct timespec now;
+
+    __real_clock_gettime(CLOCK_REALTIME, &now);
+    gRealtimeBaseNs = tsToNs(&now);
+    __real_clock_gettime(CLOCK_MONOTONIC, &now);
+    gMonotonicBaseNs = tsToNs(&now);
+
+    gVirtual = virtualClock;
+
+    // the calling thread is the main thread
+    sim_clock_startThread(sim_clock_addThread(CONFIG_NXP_BMS_PROGNAME));
+}
+
+bool sim_clock_isVirtual(void)
+{
+    return gVirtual;
+}
+
+void *sim_clock_addThread(const char *pName)
+{
+    simClockThread_t *pThread;
+
+    __real_pthread_mutex_lock(&gClockLock);
+    pThread = addThreadLocked(pName);
+    __real_pthread_mutex_unlock(&gClockLock);
+
+    if(pThread == NULL)
+    {
+        fprintf(stderr, "sim: too many threads for the clock!\n");
+    }
+
+    return pThread;
+}
+
+void sim_clock_startThread(void *pThread)
+{
+    gpThisThread = (simClockThread_t *)pThread;
+}
+
+void sim_clock_endThread(void *pThread)
+{
+    simClockThread_t *pEnd = (simClockThread_t *)pThread;
+
+    if(pEnd == NULL)
+    {
+        return;
+    }
+
+    __real_pthread_mutex_lock(&gClockLock);
+
+    if(pEnd->waiting)
+    {
+        gWaitingThreads--;
+    }
+    pEnd->used    = false;
+    pEnd->waiting = false;
+    pEnd->timed   = false;
+    gThreadCount--;
+
+    // the others may all wait already
+    if(gVirtual && gThreadCount > 0)
+    {
+        advanceIfIdleLocked();
+    }
+
+    __real_pthread_mutex_unlock(&gClockLock);
+}
+
+void sim_clock_busyUs(uint32_t us)
+{
+    // the host does it in no time, in real time this is ignored
+    if(gVirtual && us > 0)
+    {
+        virtualWait("a transfer", NULL, true, __atomic_load_n(&gNowNs, __ATOMIC_ACQUIRE) + (uint64_t)us * 1000,
+            NULL, NULL);
+    }
+}
+
+uint64_t sim_clock_getCpuNs(void)
+{
+    struct timespec now;
+
+    __real_clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return tsToNs(&now);
+}
+
+uint64_t sim_clock_getWallNs(void)
+{
+    struct timespec now;
+
+    __real_clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return tsToNs(&now);
+}
+
+int __wrap_clock_gettime(clockid_t clockId, struct timespec *tp)
+{
+    uint64_t timeNs;
+
+    // the CPU time clocks are always the ones of the host
+    if(!gVirtual || (clockId != CLOCK_REALTIME && clockId != CLOCK_MONOTONIC && clockId != CLOCK_BOOTTIME))
+    {
+        return __real_clock_gettime(clockId, tp);
+    }
+
+    timeNs = __atomic_load_n(&gNowNs, __ATOMIC_ACQUIRE);
+    timeNs += (clockId == CLOCK_REALTIME) ? gRealtimeBaseNs : gMonotonicBaseNs;
+
+    tp->tv_sec  = (time_t)(timeNs / 1000000000ULL);
+    tp->tv_nsec = (long)(timeNs % 1000000000ULL);
+
+    return 0;
+}
+
+int __wrap_clock_nanosleep(clockid_t clockId, int flags, const struct timespec *req, struct timespec *rem)
+{
+    uint64_t deadlineNs;
+
+    if(!gVirtual)
+    {
+        return __real_clock_nanosleep(clockId, flags, req, rem);
+    }
+
+    if(flags & TIMER_ABSTIME)
+    {
+        deadlineNs = absToVirtualNs(clockId, req);
+    }
+    else
+    {
+        deadlineNs = __atomic_load_n(&gNowNs, __ATOMIC_ACQUIRE) + tsToNs(req);
+    }
+
+    virtualWait("clock_nanosleep", NULL, true, deadlineNs, NULL, NULL);
+
+    return 0;
+}
+
+int __wrap_nanosleep(const struct timespec *req, struct timespec *rem)
+{
+    if(!gVirtual)
+    {
+        return __real_nanosleep(req, rem);
+    }
+
+    virtualWait("nanosleep", NULL, true, __atomic_load_n(&gNowNs, __ATOMIC_ACQUIRE) + tsToNs(req), NULL, NULL);
+
+    return 0;
+}
+
+int __wrap_usleep(useconds_t usec)
+{
+    if(!gVirtual)
+    {
+        return __real_usleep(usec);
+    }
+
+    virtualWait("usleep", NULL, true, __atomic_load_n(&gNowNs, __ATOMIC_ACQUIRE) + (uint64_t)usec * 1000, NULL,
+        NULL);
+
+    return 0;
+}
+
+int __wrap_sem_wait(sem_t *sem)
+{
+    return semWait(sem, NULL);
+}
+
+int __wrap_sem_timedwait(sem_t *sem, const struct timespec *abstime)
+{
+    return semWait(sem, abstime);
+}
+
+int __wrap_sem_post(sem_t *sem)
+{
+    int lvRetValue = __real_sem_post(sem);
+
+    if(gVirtual && lvRetValue == 0)
+    {
+        wakeWaiters(sem);
+    }
+
+    return lvRetValue;
+}
+
+int __wrap_sem_getvalue(sem_t *sem, int *sval)
+{
+    int i;
+
+    if(__real_sem_getvalue(sem, sval))
+    {
+        return -1;
+    }
+
+    // like NuttX, a semaphore that isn't available has minus the amount of waiting tasks
+    if(*sval == 0)
+    {
+        __real_pthread_mutex_lock(&gSemWaitersLock);
+        for(i = 0; i < SIM_CLOCK_MAX_SEMS; i++)
+        {
+            if(gSemWaiters[i].pSem == sem)
+            {
+                *sval = -gSemWaiters[i].waiters;
+                break;
+            }
+        }
+        __real_pthread_mutex_unlock(&gSemWaitersLock);
+    }
+
+    return 0;
+}
+
+int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    return gVirtual ? mutexLock(mutex, NULL) : __real_pthread_mutex_lock(mutex);
+}
+
+int __wrap_pthread_mutex_timedlock(pthread_mutex_t *mutex, const struct timespec *abstime)
+{
+    return gVirtual ? mutexLock(mutex, abstime) : __real_pthread_mutex_timedlock(mutex, abstime);
+}
+
+int __wrap_pthread_mutex_unlock(pthread_mutex_t *mutex)
+{
+    int lvRetValue = __real_pthread_mutex_unlock(mutex);
+
+    // wake the tasks that wait on a mutex
+    if(gVirtual && lvRetValue == 0 && __atomic_load_n(&gMutexWaiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        wakeWaiters(mutex);
+    }
+
+    return lvRetValue;
+}
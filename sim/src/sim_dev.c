@@ -0,0 +1,574 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_dev.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The devices of the board in the file system of the simulation.
+ * open(), close(), read(), write(), ioctl() and mmap() are wrapped by the
+ * linker, the paths of the board are handled here and all other paths and
+ * file descriptors go to the host.
+ * A device gets a real file descriptor of /dev/null, so the numbers are
+ * unique, and the kind of device is kept in a table indexed by it.
+ * The table is used without a lock, since the application opens and reads
+ * the GPIO pins in a signal handler as well.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <nuttx/spi/spi_transfer.h>
+#include <nuttx/i2c/i2c_master.h>
+#include <nuttx/video/fb.h>
+#include <arch/board/smbus_sbd.h>
+
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the amount of file descriptors in the table, higher ones are host files only
+#define SIM_DEV_MAX_FDS     1024
+
+//! @brief the size of the display
+#define SIM_DEV_FB_XRES     128
+#define SIM_DEV_FB_YRES     32
+#define SIM_DEV_FB_STRIDE   (SIM_DEV_FB_XRES / 8)
+#define SIM_DEV_FB_SIZE     (SIM_DEV_FB_STRIDE * SIM_DEV_FB_YRES)
+
+//! @brief the amount of bytes of a BCC and an SBC SPI frame
+#define SIM_DEV_BCC_FRAME   5
+#define SIM_DEV_SBC_FRAME   2
+
+//! @brief the time the chip select and the driver add to each SPI transfer in us
+#define SIM_DEV_SPI_GAP_US  5
+
+//! @brief the bits of each I2C byte, with the acknowledge, and the start and stop of a message
+#define SIM_DEV_I2C_BYTE_BITS   9
+#define SIM_DEV_I2C_MSG_BITS    20
+
+//! @brief the size of the text of a procfs file
+#define SIM_DEV_PROC_SIZE   96
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the kinds of devices */
+typedef enum
+{
+    DEV_NONE = 0, //!< a host file
+    DEV_SPI,      //!< /dev/spi<bus>
+    DEV_GPIO,     //!< /dev/gpio<pin>
+    DEV_FB,       //!< /dev/fb0
+    DEV_I2C,      //!< /dev/i2c0
+    DEV_SMBUS,    //!< /dev/smbus-sbd0
+    DEV_PROC      //!< a read only procfs file
+} simDevKind_t;
+
+/*! @brief an open device */
+typedef struct
+{
+    atomic_int kind;                    //!< the simDevKind_t, set last when opened
+    int        number;                  //!< the bus or pin of the device
+    size_t     position;                //!< the read position of a procfs file
+    size_t     length;                  //!< the length of the text of a procfs file
+    char       text[SIM_DEV_PROC_SIZE]; //!< the text of a procfs file
+} simDevFd_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the open devices, indexed by the file descriptor
+static simDevFd_t gFds[SIM_DEV_MAX_FDS];
+
+//! the framebuffer of the display
+static uint8_t gFbMem[SIM_DEV_FB_SIZE];
+static bool    gFbPower = false;
+
+//! the last data written to the SMBus driver
+static struct smbus_sbd_data_s gSmbusData;
+
+//! the frames and the bus time of the SPI transfers with the BCC, done under sim_lock()
+static uint32_t gBccFrames = 0;
+static uint64_t gBccBusUs  = 0;
+
+/****************************************************************************
+ * Host functions
+ ****************************************************************************/
+int     __real_open(const char *path, int oflag, ...);
+int     __real_close(int fd);
+ssize_t __real_read(int fd, void *buf, size_t nbytes);
+ssize_t __real_write(int fd, const void *buf, size_t nbytes);
+int     __real_ioctl(int fd, unsigned long request, ...);
+void   *__real_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get the device of a file descriptor
+ *
+ * @param   fd the file descriptor
+ *
+ * @return  the address of the device, NULL if it is a host file
+ */
+static simDevFd_t *getDevice(int fd)
+{
+    if(fd < 0 || fd >= SIM_DEV_MAX_FDS || atomic_load(&gFds[fd].kind) == DEV_NONE)
+    {
+        return NULL;
+    }
+
+    return &gFds[fd];
+}
+
+/*!
+ * @brief   function to find the device of a path and make the text of a procfs file
+ *
+ * @param   path the path that is opened
+ * @param   pDevice the address of the device to fill, the kind is set by the caller
+ *
+ * @return  the kind of the device, DEV_NONE if it isn't one of the board, -1 if it doesn't exist
+ */
+static int findDevice(const char *path, simDevFd_t *pDevice)
+{
+    int    number;
+    size_t stackSize, stackUsed;
+    char   end;
+
+    if(sscanf(path, "/dev/spi%d%c", &number, &end) == 1)
+    {
+        pDevice->number = number;
+        return (number == 0 || number == 1) ? DEV_SPI : -1;
+    }
+    if(sscanf(path, "/dev/gpio%d%c", &number, &end) == 1)
+    {
+        pDevice->number = number;
+        return (number >= 0 && number < SIM_GPIO_PINS) ? DEV_GPIO : -1;
+    }
+    if(!strcmp(path, "/dev/fb0"))
+    {
+        return DEV_FB;
+    }
+    if(!strcmp(path, "/dev/i2c0"))
+    {
+        return DEV_I2C;
+    }
+    if(!strcmp(path, "/dev/smbus-sbd0"))
+    {
+        return DEV_SMBUS;
+    }
+    if(!strcmp(path, "/proc/resetcause"))
+    {
+        pDevice->length = snprintf(pDevice->text, SIM_DEV_PROC_SIZE, "0x%x\n", gSimConfig.resetCause);
+        return DEV_PROC;
+    }
+    if(!strcmp(path, "/proc/nrstcheck"))
+    {
+        // the NRST pin of the MCU is connected to the SBC
+        pDevice->length = snprintf(pDevice->text, SIM_DEV_PROC_SIZE, "1\n");
+        return DEV_PROC;
+    }
+    if(sscanf(path, "/proc/%d/stack%c", &number, &end) == 1)
+    {
+        if(sim_os_getStack(number, &stackSize, &stackUsed))
+        {
+            return -1;
+        }
+        pDevice->length = snprintf(pDevice->text, SIM_DEV_PROC_SIZE, "StackSize: %zu\nStackUsed: %zu\n",
+            stackSize, stackUsed);
+        return DEV_PROC;
+    }
+
+    return DEV_NONE;
+}
+
+/*!
+ * @brief   function to do an SPI transfer with the chip on the bus
+ *
+ * @param   bus the SPI bus, 0 is the SBC and 1 is the BCC
+ * @param   pSeq the sequence of the transfer
+ *
+ * @return  0 if ok, -1 with errno set if not
+ */
+static int spiTransfer(int bus, struct spi_sequence_s *pSeq)
+{
+    struct spi_trans_s *pTrans;
+    const uint8_t      *pTx;
+    uint8_t            *pRx;
+    size_t              wordBytes = (pSeq->nbits + 7) / 8;
+    uint32_t            i, word;
+    uint64_t            bits = 0;
+    uint32_t            busUs;
+
+    sim_lock();
+
+    for(i = 0; i < pSeq->ntrans; i++)
+    {
+        pTrans = &pSeq->trans[i];
+        pTx    = (const uint8_t *)pTrans->txbuffer;
+        pRx    = (uint8_t *)pTrans->rxbuffer;
+
+        for(word = 0; word < pTrans->nwords; word++)
+        {
+            // the BCC has 40 bit frames and the SBC 16 bit frames, other words are not for them
+            if(bus == 1 && wordBytes == SIM_DEV_BCC_FRAME)
+            {
+                sim_afe_transfer(&pTx[word * wordBytes], &pRx[word * wordBytes]);
+            }
+            else if(bus == 0 && wordBytes == SIM_DEV_SBC_FRAME)
+            {
+                sim_sbc_transfer(&pTx[word * wordBytes], &pRx[word * wordBytes]);
+            }
+            else if(pRx != NULL)
+            {
+                memset(&pRx[word * wordBytes], 0, wordBytes);
+            }
+        }
+
+        bits += (uint64_t)pTrans->nwords * pSeq->nbits;
+    }
+
+    busUs = (uint32_t)(bits * 1000000 / ((pSeq->frequency != 0) ? pSeq->frequency : 1000000)) +
+        pSeq->ntrans * SIM_DEV_SPI_GAP_US;
+
+    // count the traffic with the BCC
+    if(bus == 1 && wordBytes == SIM_DEV_BCC_FRAME)
+    {
+        gBccFrames += (uint32_t)(bits / pSeq->nbits);
+        gBccBusUs  += busUs;
+    }
+
+    sim_unlock();
+
+    // the transfer takes the time of the bus, with the virtual clock a poll loop needs this to end
+    sim_clock_busyUs(busUs);
+
+    return 0;
+}
+
+/*!
+ * @brief   function to do an I2C transfer, only the NFC chip answers on the bus
+ *
+ * @param   pTransfer the messages of the transfer
+ *
+ * @return  0 if ok, -1 with errno set if not
+ */
+static int i2cTransfer(struct i2c_transfer_s *pTransfer)
+{
+    uint64_t bits = 0;
+    uint32_t frequency;
+    size_t   i;
+    int      lvRetValue;
+
+    lvRetValue = sim_nfc_transfer(pTransfer->msgv, pTransfer->msgc);
+
+    // the transfer takes the time of the bus, a message that isn't answered stops after the address
+    for(i = 0; i < pTransfer->msgc; i++)
+    {
+        bits += SIM_DEV_I2C_MSG_BITS;
+        bits += lvRetValue ? 0 : (uint64_t)pTransfer->msgv[i].length * SIM_DEV_I2C_BYTE_BITS;
+    }
+    frequency = (pTransfer->msgc != 0) ? pTransfer->msgv[0].frequency : 0;
+    frequency = (frequency != 0) ? frequency : 100000;
+    sim_clock_busyUs((uint32_t)(bits * 1000000 / frequency));
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   function to handle an ioctl of the display
+ *
+ * @param   cmd the command
+ * @param   arg the argument
+ *
+ * @return  0 if ok, -1 with errno set if not
+ */
+static int fbIoctl(unsigned long cmd, unsigned long arg)
+{
+    struct fb_videoinfo_s *pVideo = (struct fb_videoinfo_s *)arg;
+    struct fb_planeinfo_s *pPlane = (struct fb_planeinfo_s *)arg;
+
+    switch(cmd)
+    {
+        case FBIOGET_VIDEOINFO:
+            memset(pVideo, 0, sizeof(struct fb_videoinfo_s));
+            pVideo->fmt     = FB_FMT_Y1;
+            pVideo->xres    = SIM_DEV_FB_XRES;
+            pVideo->yres    = SIM_DEV_FB_YRES;
+            pVideo->nplanes = 1;
+            break;
+        case FBIOGET_PLANEINFO:
+            memset(pPlane, 0, sizeof(struct fb_planeinfo_s));
+            pPlane->fbmem  = gFbMem;
+            pPlane->fblen  = SIM_DEV_FB_SIZE;
+            pPlane->stride = SIM_DEV_FB_STRIDE;
+            pPlane->bpp    = 1;
+            break;
+        case FBIO_UPDATE:
+            // the framebuffer is the display
+            break;
+        case FBIOSET_POWER:
+            gFbPower = (arg != 0);
+            break;
+        case FBIOGET_POWER:
+            *(int *)arg = gFbPower;
+            break;
+        default:
+            errno = ENOTTY;
+            return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_dev_getBccTraffic(uint32_t *pFrames, uint64_t *pBusUs)
+{
+    sim_lock();
+    *pFrames = gBccFrames;
+    *pBusUs  = gBccBusUs;
+    sim_unlock();
+}
+
+void sim_dev_printDisplay(FILE *pStream)
+{
+    int  line, column;
+    char character;
+
+    // the font has the character in the first row of the glyph
+    fprintf(pStream, "+----------------+ %s\n", gFbPower ? "on" : "off");
+    for(line = 0; line < SIM_DEV_FB_YRES / 8; line++)
+    {
+        fputc('|', pStream);
+        for(column = 0; column < SIM_DEV_FB_STRIDE; column++)
+        {
+            character = (char)gFbMem[line * 8 * SIM_DEV_FB_STRIDE + column];
+            fputc((character > ' ' && character < 127) ? character : ' ', pStream);
+        }
+        fputs("|\n", pStream);
+    }
+    fputs("+----------------+\n", pStream);
+}
+
+int __wrap_open(const char *path, int oflag, ...)
+{
+    simDevFd_t device;
+    va_list    ap;
+    mode_t     mode = 0;
+    int        kind, fd;
+
+    if(oflag & O_CREAT)
+    {
+        va_start(ap, oflag);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+
+    // the eeprom is a host file that keeps the parameters between runs
+    if(!strcmp(path, "/dev/eeeprom0"))
+    {
+        return __real_open(gSimConfig.eepromPath, oflag | O_CREAT, 0644);
+    }
+
+    memset(&device, 0, sizeof(device));
+    kind = findDevice(path, &device);
+    if(kind == DEV_NONE)
+    {
+        return __real_open(path, oflag, mode);
+    }
+    if(kind < 0)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    // get a unique file descriptor for it
+    fd = __real_open("/dev/null", O_RDWR);
+    if(fd < 0)
+    {
+        return fd;
+    }
+    if(fd >= SIM_DEV_MAX_FDS)
+    {
+        __real_close(fd);
+        errno = EMFILE;
+        return -1;
+    }
+
+    // fill the entry, the kind last so it is complete when it is seen
+    gFds[fd].number   = device.number;
+    gFds[fd].position = 0;
+    gFds[fd].length   = device.length;
+    memcpy(gFds[fd].text, device.text, sizeof(device.text));
+    atomic_store(&gFds[fd].kind, kind);
+
+    return fd;
+}
+
+int __wrap_close(int fd)
+{
+    simDevFd_t *pDevice = getDevice(fd);
+
+    if(pDevice != NULL)
+    {
+        atomic_store(&pDevice->kind, DEV_NONE);
+    }
+
+    return __real_close(fd);
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t nbytes)
+{
+    simDevFd_t *pDevice = getDevice(fd);
+    size_t      length;
+
+    if(pDevice == NULL)
+    {
+        return __real_read(fd, buf, nbytes);
+    }
+    if(atomic_load(&pDevice->kind) != DEV_PROC)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // read the text of the procfs file
+    length = pDevice->length - pDevice->position;
+    if(length > nbytes)
+    {
+        length = nbytes;
+    }
+    memcpy(buf, &pDevice->text[pDevice->position], length);
+    pDevice->position += length;
+
+    return (ssize_t)length;
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t nbytes)
+{
+    simDevFd_t *pDevice = getDevice(fd);
+
+    if(pDevice == NULL)
+    {
+        return __real_write(fd, buf, nbytes);
+    }
+
+    // the SMBus driver takes the whole struct at once
+    if(atomic_load(&pDevice->kind) == DEV_SMBUS && nbytes == sizeof(struct smbus_sbd_data_s))
+    {
+        sim_lock();
+        memcpy(&gSmbusData, buf, nbytes);
+        sim_unlock();
+        return (ssize_t)nbytes;
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    simDevFd_t   *pDevice = getDevice(fd);
+    va_list       ap;
+    unsigned long arg;
+    int           lvRetValue;
+
+    va_start(ap, request);
+    arg = va_arg(ap, unsigned long);
+    va_end(ap);
+
+    if(pDevice == NULL)
+    {
+        return __real_ioctl(fd, request, arg);
+    }
+
+    switch(atomic_load(&pDevice->kind))
+    {
+        case DEV_SPI:
+            if(request != SPIIOC_TRANSFER)
+            {
+                errno = ENOTTY;
+                return -1;
+            }
+            return spiTransfer(pDevice->number, (struct spi_sequence_s *)arg);
+        case DEV_GPIO:
+            return sim_gpio_ioctl(pDevice->number, (int)request, arg);
+        case DEV_FB:
+            sim_lock();
+            lvRetValue = fbIoctl(request, arg);
+            sim_unlock();
+            return lvRetValue;
+        case DEV_I2C:
+            if(request != I2CIOC_TRANSFER)
+            {
+                errno = ENOTTY;
+                return -1;
+            }
+            return i2cTransfer((struct i2c_transfer_s *)arg);
+        default:
+            errno = ENOTTY;
+            return -1;
+    }
+}
+
+void *__wrap_mmap(void *addr, size_t len, int prot, int flags, int fd, off_t offset)
+{
+    simDevFd_t *pDevice = getDevice(fd);
+
+    if(pDevice == NULL)
+    {
+        return __real_mmap(addr, len, prot, flags, fd, offset);
+    }
+
+    // only the framebuffer can be mapped
+    if(atomic_load(&pDevice->kind) != DEV_FB || (offset + len) > SIM_DEV_FB_SIZE)
+    {
+        errno = ENODEV;
+        return MAP_FAILED;
+    }
+
+    return &gFbMem[offset];
+}
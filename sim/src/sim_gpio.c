@@ -0,0 +1,278 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_gpio.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The GPIO pins of the board.
+ * The outputs drive the models (the gate driver and the reset of the BCC),
+ * the inputs are set by the models and by the console. A change of an
+ * interrupt pin calls the signal handler of the sigevent given with
+ * GPIOC_REGISTER from the world tick thread, like an interrupt. It isn't
+ * sent as a host signal, that could interrupt a task that holds a lock of
+ * the simulation.
+ * The levels are read without the lock, since the application reads them in
+ * its signal handler.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <nuttx/ioexpander/gpio.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a pin */
+typedef struct
+{
+    atomic_bool         level;      //!< the level of the pin
+    enum gpio_pintype_e type;       //!< the type of the pin
+    bool                registered; //!< true if a task registered for the signal
+    int                 signo;      //!< the signal to send
+    union sigval        value;      //!< the value of the signal
+} simPin_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the pins, the interrupt pins change on both edges like the board configures them
+static simPin_t gPins[SIM_GPIO_PINS] = {
+    [GATE_CTRL_CP] = { .type = GPIO_OUTPUT_PIN },
+    [GATE_CTRL_D]  = { .type = GPIO_OUTPUT_PIN },
+    [BCC_RESET]    = { .type = GPIO_OUTPUT_PIN },
+    [NFC_HPD]      = { .type = GPIO_OUTPUT_PIN },
+    [AUTH_WAKE]    = { .type = GPIO_OUTPUT_PIN },
+    [PTE8]         = { .type = GPIO_INTERRUPT_BOTH_PIN },
+    [OVERCURRENT]  = { .type = GPIO_INTERRUPT_BOTH_PIN },
+    [SBC_WAKE]     = { .level = true, .type = GPIO_INTERRUPT_BOTH_PIN },
+    [GATE_RS]      = { .type = GPIO_INTERRUPT_BOTH_PIN },
+    [SBC_LIMP]     = { .level = true, .type = GPIO_INTERRUPT_BOTH_PIN },
+    [BCC_FAULT]    = { .type = GPIO_INTERRUPT_BOTH_PIN },
+    [NFC_ED]       = { .level = NFC_ED_PIN_INACTIVE, .type = GPIO_INTERRUPT_BOTH_PIN },
+};
+
+//! the pins of which the signal still needs to be sent, a bit per pin
+static atomic_uint gPendingPins = 0;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to check if an edge of a pin gives an interrupt
+ *
+ * @param   type the type of the pin
+ * @param   level the new level of the pin
+ *
+ * @return  true if it gives an interrupt
+ */
+static bool isInterruptEdge(enum gpio_pintype_e type, bool level)
+{
+    switch(type)
+    {
+        case GPIO_INTERRUPT_PIN:
+        case GPIO_INTERRUPT_BOTH_PIN:
+            return true;
+        case GPIO_INTERRUPT_HIGH_PIN:
+        case GPIO_INTERRUPT_RISING_PIN:
+            return level;
+        case GPIO_INTERRUPT_LOW_PIN:
+        case GPIO_INTERRUPT_FALLING_PIN:
+            return !level;
+        default:
+            return false;
+    }
+}
+
+/*!
+ * @brief   function to handle a write to an output pin
+ * @note    The lock needs to be locked.
+ *
+ * @param   pin the pin
+ * @param   value the new level
+ */
+static void writeOutput(int pin, bool value)
+{
+    atomic_store(&gPins[pin].level, value);
+
+    switch(pin)
+    {
+        case GATE_CTRL_CP:
+        case GATE_CTRL_D:
+            sim_pack_setGatePins(atomic_load(&gPins[GATE_CTRL_CP].level),
+                atomic_load(&gPins[GATE_CTRL_D].level));
+            break;
+        case BCC_RESET:
+            sim_afe_setResetPin(value);
+            break;
+        default:
+            break;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+bool sim_gpio_get(int pin)
+{
+    return atomic_load(&gPins[pin].level);
+}
+
+void sim_gpio_set(int pin, bool value)
+{
+    sim_lock();
+
+    // check if it changed
+    if(atomic_exchange(&gPins[pin].level, value) != value)
+    {
+        // signal it with the next sim_gpio_deliver
+        if(gPins[pin].registered && isInterruptEdge(gPins[pin].type, value))
+        {
+            atomic_fetch_or(&gPendingPins, 1U << pin);
+        }
+    }
+
+    sim_unlock();
+}
+
+int sim_gpio_ioctl(int pin, int cmd, unsigned long arg)
+{
+    struct sigevent *pNotify = (struct sigevent *)arg;
+    int              lvRetValue = 0;
+
+    switch(cmd)
+    {
+        case GPIOC_READ:
+            // no lock, this is used in the signal handler
+            *(bool *)arg = atomic_load(&gPins[pin].level);
+            return 0;
+        case GPIOC_PINTYPE:
+            *(enum gpio_pintype_e *)arg = gPins[pin].type;
+            return 0;
+        default:
+            break;
+    }
+
+    sim_lock();
+
+    switch(cmd)
+    {
+        case GPIOC_WRITE:
+            if(gPins[pin].type == GPIO_OUTPUT_PIN || gPins[pin].type == GPIO_OUTPUT_PIN_OPENDRAIN)
+            {
+                writeOutput(pin, arg != 0);
+            }
+            else
+            {
+                errno      = EACCES;
+                lvRetValue = -1;
+            }
+            break;
+        case GPIOC_SETPINTYPE:
+            // only the inputs can be changed on this board
+            if(arg < GPIO_NPINTYPES && gPins[pin].type != GPIO_OUTPUT_PIN &&
+                arg != GPIO_OUTPUT_PIN && arg != GPIO_OUTPUT_PIN_OPENDRAIN)
+            {
+                gPins[pin].type = (enum gpio_pintype_e)arg;
+            }
+            else
+            {
+                errno      = EINVAL;
+                lvRetValue = -1;
+            }
+            break;
+        case GPIOC_REGISTER:
+            if(gPins[pin].type >= GPIO_INTERRUPT_PIN && gPins[pin].type <= GPIO_INTERRUPT_BOTH_PIN)
+            {
+                // the handler of the signal is called when the pin changes
+                gPins[pin].registered = true;
+                gPins[pin].signo      = pNotify->sigev_signo;
+                gPins[pin].value      = pNotify->sigev_value;
+            }
+            else
+            {
+                errno      = EINVAL;
+                lvRetValue = -1;
+            }
+            break;
+        case GPIOC_UNREGISTER:
+            gPins[pin].registered = false;
+            break;
+        default:
+            errno      = ENOTTY;
+            lvRetValue = -1;
+            break;
+    }
+
+    sim_unlock();
+
+    return lvRetValue;
+}
+
+void sim_gpio_deliver(void)
+{
+    unsigned int     pending = atomic_exchange(&gPendingPins, 0);
+    struct sigaction act;
+    siginfo_t        info;
+    int              pin;
+
+    for(pin = 0; pending != 0; pin++, pending >>= 1)
+    {
+        // call the handler the application set for the signal
+        if((pending & 1) && sigaction(gPins[pin].signo, NULL, &act) == 0)
+        {
+            memset(&info, 0, sizeof(info));
+            info.si_signo = gPins[pin].signo;
+            info.si_code  = SI_QUEUE;
+            info.si_value = gPins[pin].value;
+
+            if((act.sa_flags & SA_SIGINFO) && act.sa_sigaction != NULL)
+            {
+                act.sa_sigaction(gPins[pin].signo, &info, NULL);
+            }
+            else if(act.sa_handler != SIG_DFL && act.sa_handler != SIG_IGN)
+            {
+                act.sa_handler(gPins[pin].signo);
+            }
+        }
+    }
+}
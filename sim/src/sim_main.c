@@ -0,0 +1,403 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_main.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The start of the simulation and its console.
+ * This parses the options, starts the world tick thread that advances the
+ * models and starts the application like the NuttX shell does with "bms".
+ * After that each line of the console is a command for the application,
+ * like on the shell of the board, or a "sim" command to change the pack.
+ * With a profile (-r) there is no console, the profile is replayed on the
+ * virtual clock instead and the program ends with the result of it.
+ * The benchmark (-B) runs on the virtual clock as well, without a console.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the maximum amount of words of a console line
+#define SIM_MAIN_MAX_ARGS       16
+
+//! @brief the length of a console line
+#define SIM_MAIN_LINE_LENGTH    256
+
+//! @brief the time the button is pushed with "sim button" in us
+#define SIM_MAIN_BUTTON_US      300000
+
+//! @brief the default allowed increase of the mean time of a function in the replay in %
+#define SIM_MAIN_REGRESSION     25.0f
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+simConfig_t gSimConfig = {
+    .cells       = 3,
+    .soc         = 70.0f,
+    .capacity    = 4.6f,
+    .current     = 0.0f,
+    .temperature = 25.0f,
+    .eepromPath  = "bms_sim_eeprom.bin",
+    .resetCause  = SIM_RESET_CAUSE_POR,
+    .watchdog    = true,
+    .regression  = SIM_MAIN_REGRESSION,
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the lock of the models
+static pthread_mutex_t gWorldLock;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to print the usage of the simulation
+ *
+ * @param   pName the name of the program
+ */
+static void printUsage(const char *pName)
+{
+    printf("usage: %s [options]\n", pName);
+    printf("  -c <cells>   the amount of cells (3 - 6), default %d\n", gSimConfig.cells);
+    printf("  -s <soc>     the state of charge of the cells in %%, default %.0f\n", gSimConfig.soc);
+    printf("  -a <Ah>      the capacity of the cells, default %.1f\n", gSimConfig.capacity);
+    printf("  -i <A>       the load current when the power switch is closed, default %.1f\n",
+        gSimConfig.current);
+    printf("  -t <C>       the temperature, default %.1f\n", gSimConfig.temperature);
+    printf("  -e <file>    the file of the eeprom, default %s\n", gSimConfig.eepromPath);
+    printf("  -W           ignore the watchdog of the SBC\n");
+    printf("  -r <csv>     replay a profile (time_s,current_a[,temperature_c]) on the virtual clock\n");
+    printf("  -o <file>    write the replay report to this file as well\n");
+    printf("  -b <file>    compare the timing with this replay report\n");
+    printf("  -T <%%>       the allowed increase of the mean time of a function, default %.0f\n",
+        gSimConfig.regression);
+    printf("  -B <json>    benchmark the hot paths on the virtual clock and write the results, - for stdout\n");
+}
+
+/*!
+ * @brief   function to print the help of the console
+ */
+static void printConsoleHelp(void)
+{
+    printf("sim current <A>        set the load (negative) or charge (positive) current\n");
+    printf("sim cell <n> <V>       force the voltage of cell n, 0 to follow the charge again\n");
+    printf("sim temp <C>           set the temperature of the sensors\n");
+    printf("sim charger <V>        set the constant voltage of the charger, 0 for a current source\n");
+    printf("sim button             push the button\n");
+    printf("sim display            show the text on the display\n");
+    printf("sim status             show the pack and the LEDs\n");
+    printf("sim quit               switch off the board\n");
+    printf("other lines are commands of the application, like \"bms help\"\n");
+}
+
+/*!
+ * @brief   function to handle a "sim" command of the console
+ *
+ * @param   argc the amount of words, the first is "sim"
+ * @param   argv the words
+ */
+static void simCommand(int argc, char *argv[])
+{
+    uint32_t leds;
+
+    if(argc >= 3 && !strcmp(argv[1], "current"))
+    {
+        sim_pack_setCurrent(strtof(argv[2], NULL));
+    }
+    else if(argc >= 4 && !strcmp(argv[1], "cell"))
+    {
+        if(sim_pack_setCellVoltage(atoi(argv[2]) - 1, strtof(argv[3], NULL)))
+        {
+            printf("sim: there is no cell %s\n", argv[2]);
+        }
+    }
+    else if(argc >= 3 && !strcmp(argv[1], "temp"))
+    {
+        sim_pack_setTemperature(strtof(argv[2], NULL));
+    }
+    else if(argc >= 3 && !strcmp(argv[1], "charger"))
+    {
+        sim_pack_setChargerVoltage(strtof(argv[2], NULL));
+    }
+    else if(argc >= 2 && !strcmp(argv[1], "button"))
+    {
+        // the button pulls the wake pin low
+        sim_gpio_set(SBC_WAKE, false);
+        usleep(SIM_MAIN_BUTTON_US);
+        sim_gpio_set(SBC_WAKE, true);
+    }
+    else if(argc >= 2 && !strcmp(argv[1], "display"))
+    {
+        sim_dev_printDisplay(stdout);
+    }
+    else if(argc >= 2 && !strcmp(argv[1], "status"))
+    {
+        sim_pack_print(stdout);
+        leds = sim_os_getLeds();
+        printf("LEDs:         %s%s%s\n", (leds & 1) ? "red " : "", (leds & 2) ? "green " : "",
+            (leds & 4) ? "blue" : "");
+    }
+    else if(argc >= 2 && !strcmp(argv[1], "quit"))
+    {
+        sim_os_powerOff("quit from the console");
+    }
+    else
+    {
+        printConsoleHelp();
+    }
+}
+
+/*!
+ * @brief   function to handle a line of the console
+ *
+ * @param   pLine the line, it is split in words
+ */
+static void consoleLine(char *pLine)
+{
+    char *argv[SIM_MAIN_MAX_ARGS + 2];
+    char *pSave;
+    int   argc = 1;
+
+    // the application gets its name as the first argument, like from the shell
+    argv[0] = CONFIG_NXP_BMS_PROGNAME;
+    argv[1] = strtok_r(pLine, " \t\r\n", &pSave);
+
+    if(argv[1] == NULL)
+    {
+        return;
+    }
+
+    // "bms help" and "help" are the same command
+    if(strcmp(argv[1], CONFIG_NXP_BMS_PROGNAME))
+    {
+        argc++;
+    }
+
+    while(argc <= SIM_MAIN_MAX_ARGS && (argv[argc] = strtok_r(NULL, " \t\r\n", &pSave)) != NULL)
+    {
+        argc++;
+    }
+    argv[argc] = NULL;
+
+    if(argc > 1 && !strcmp(argv[1], "sim"))
+    {
+        simCommand(argc - 1, &argv[1]);
+    }
+    else
+    {
+        bms_main(argc, argv);
+    }
+}
+
+/*!
+ * @brief   the world tick thread, it advances the models every SIM_TICK_US
+ *
+ * @param   pArg the thread of the clock
+ *
+ * @return  never
+ */
+static void *worldTickThread(void *pArg)
+{
+    struct timespec next;
+    uint64_t        nowUs;
+
+    sim_clock_startThread(pArg);
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while(1)
+    {
+        // sleep until the next tick, this doesn't drift
+        next.tv_nsec += SIM_TICK_US * 1000L;
+        if(next.tv_nsec >= 1000000000L)
+        {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        sim_lock();
+        nowUs = sim_getTimeUs();
+        sim_pack_tick(nowUs);
+        sim_afe_tick(nowUs);
+        sim_sbc_tick(nowUs);
+        sim_unlock();
+
+        // the signal handlers are called without the lock, they read the pins
+        sim_gpio_deliver();
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_lock(void)
+{
+    pthread_mutex_lock(&gWorldLock);
+}
+
+void sim_unlock(void)
+{
+    pthread_mutex_unlock(&gWorldLock);
+}
+
+uint64_t sim_getTimeUs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_mutexattr_t attr;
+    pthread_t           thread;
+    char                line[SIM_MAIN_LINE_LENGTH];
+    char               *pBmsArgv[] = { CONFIG_NXP_BMS_PROGNAME, NULL };
+    const char         *pResetCause;
+    void               *pTickThread;
+    int                 option;
+
+    // the console output is read by people and scripts
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while((option = getopt(argc, argv, "c:s:a:i:t:e:Wr:o:b:T:B:h")) != -1)
+    {
+        switch(option)
+        {
+            case 'c': gSimConfig.cells        = atoi(optarg);         break;
+            case 's': gSimConfig.soc          = strtof(optarg, NULL); break;
+            case 'a': gSimConfig.capacity     = strtof(optarg, NULL); break;
+            case 'i': gSimConfig.current      = strtof(optarg, NULL); break;
+            case 't': gSimConfig.temperature  = strtof(optarg, NULL); break;
+            case 'e': gSimConfig.eepromPath   = optarg;               break;
+            case 'W': gSimConfig.watchdog     = false;                break;
+            case 'r': gSimConfig.replayPath   = optarg;               break;
+            case 'o': gSimConfig.reportPath   = optarg;               break;
+            case 'b': gSimConfig.baselinePath = optarg;               break;
+            case 'T': gSimConfig.regression   = strtof(optarg, NULL); break;
+            case 'B': gSimConfig.benchPath    = optarg;               break;
+            default:
+                printUsage(argv[0]);
+                return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    if(gSimConfig.cells < 3 || gSimConfig.cells > SIM_MAX_CELLS || gSimConfig.capacity <= 0.0f)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // a reset of the simulation executes it again with the reset cause
+    pResetCause = getenv("SIM_RESET_CAUSE");
+    if(pResetCause != NULL)
+    {
+        gSimConfig.resetCause = (unsigned)strtoul(pResetCause, NULL, 0);
+        unsetenv("SIM_RESET_CAUSE");
+    }
+
+    // the models can be used again from within a model
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&gWorldLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    // a replay reads its profile before anything runs, the time is virtual then and with a benchmark
+    if(gSimConfig.replayPath != NULL && sim_replay_initialize())
+    {
+        return 1;
+    }
+    sim_clock_initialize(gSimConfig.replayPath != NULL || gSimConfig.benchPath != NULL);
+
+    sim_os_initialize();
+    sim_pack_initialize();
+    sim_afe_initialize();
+    sim_sbc_initialize();
+    sim_nfc_initialize();
+
+    pTickThread = sim_clock_addThread("worldTick");
+    if(pthread_create(&thread, NULL, worldTickThread, pTickThread))
+    {
+        perror("sim: failed to start the world tick thread");
+        return 1;
+    }
+
+    // start the application like "bms" on the shell
+    bms_main(1, pBmsArgv);
+
+    if(gSimConfig.replayPath != NULL)
+    {
+        return sim_replay_run();
+    }
+
+    if(gSimConfig.benchPath != NULL)
+    {
+        return sim_bench_run();
+    }
+
+    while(fgets(line, sizeof(line), stdin) != NULL)
+    {
+        consoleLine(line);
+    }
+
+    // without a console the application keeps running
+    while(1)
+    {
+        pause();
+    }
+
+    return 0;
+}
@@ -0,0 +1,276 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_nfc.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The NTAG 5 link (NTP5332) NFC chip of the simulation.
+ * This is a model of the I2C interface of the chip, as far as src/nfc.c
+ * uses it: the memory (EEPROM, configuration and SRAM) is written and read
+ * in blocks of 4 bytes, the session registers a byte at a time with a mask.
+ * The session registers get the configuration of the memory at a reset,
+ * that is done by the reset register (the chip doesn't answer that write)
+ * or by the hard power-down pin. There is never an NFC field, so the I2C
+ * side can always write.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <nuttx/i2c/i2c_master.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the I2C address of the chip
+#define SIM_NFC_ADDRESS         0x54
+
+//! @brief the blocks of the memory and the session registers, a block is 4 bytes
+#define SIM_NFC_BLOCK_SIZE      4
+#define SIM_NFC_MEMORY_BLOCKS   0x2040
+#define SIM_NFC_SESSION_START   0x10A0
+#define SIM_NFC_SESSION_BLOCKS  0x10
+
+//! @brief the configuration blocks that are loaded in the session registers
+#define SIM_NFC_CONFIG_CONF     0x1037
+#define SIM_NFC_CONFIG_WDT      0x103C
+#define SIM_NFC_CONFIG_EH       0x103D
+
+//! @brief the session registers
+#define SIM_NFC_SES_STATUS      0x10A0
+#define SIM_NFC_SES_CONF        0x10A1
+#define SIM_NFC_SES_WDT         0x10A6
+#define SIM_NFC_SES_ED_CONFIG   0x10A8
+#define SIM_NFC_SES_SLAVE_CONF  0x10A9
+#define SIM_NFC_SES_RESET_GEN   0x10AA
+
+//! @brief the value of the reset register that resets the chip
+#define SIM_NFC_RESET_VALUE     0xE7
+
+//! @brief the VCC supply ok bit of the status 0 byte
+#define SIM_NFC_VCC_SUPPLY_OK   (1 << 1)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the memory and the session registers
+static uint8_t gMemory[SIM_NFC_MEMORY_BLOCKS][SIM_NFC_BLOCK_SIZE];
+static uint8_t gSession[SIM_NFC_SESSION_BLOCKS][SIM_NFC_BLOCK_SIZE];
+
+//! the address of the next read, with the byte of a session register
+static uint16_t gReadBlock   = 0;
+static int      gSessionByte = -1;
+
+//! the level of the hard power-down pin at the last transfer
+static bool gPoweredDown = false;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get a session register
+ *
+ * @param   block the block of the session register
+ *
+ * @return  the 4 bytes of it
+ */
+static uint8_t *session(uint16_t block)
+{
+    return gSession[block - SIM_NFC_SESSION_START];
+}
+
+/*!
+ * @brief   function to reset the chip, the session registers get the configuration
+ */
+static void resetChip(void)
+{
+    memset(gSession, 0, sizeof(gSession));
+
+    session(SIM_NFC_SES_STATUS)[0]     = SIM_NFC_VCC_SUPPLY_OK;
+    session(SIM_NFC_SES_SLAVE_CONF)[0] = SIM_NFC_ADDRESS;
+
+    memcpy(session(SIM_NFC_SES_CONF), gMemory[SIM_NFC_CONFIG_CONF], SIM_NFC_BLOCK_SIZE);
+    memcpy(session(SIM_NFC_SES_WDT), gMemory[SIM_NFC_CONFIG_WDT], 3);
+    session(SIM_NFC_SES_ED_CONFIG)[0] = gMemory[SIM_NFC_CONFIG_EH][2];
+
+    gReadBlock   = 0;
+    gSessionByte = -1;
+}
+
+/*!
+ * @brief   function to handle a write message
+ *
+ * @param   pBuffer the bytes, the first 2 are the block
+ * @param   length the amount of bytes
+ *
+ * @return  0 if ok, -1 if the chip doesn't answer
+ */
+static int writeMessage(const uint8_t *pBuffer, ssize_t length)
+{
+    uint16_t block;
+    uint8_t *pByte;
+
+    if(length < 2)
+    {
+        return -1;
+    }
+
+    block        = (uint16_t)((pBuffer[0] << 8) | pBuffer[1]);
+    gReadBlock   = block;
+    gSessionByte = -1;
+
+    // a session register: the block, the byte, the mask and the data
+    if(block >= SIM_NFC_SESSION_START && block < SIM_NFC_SESSION_START + SIM_NFC_SESSION_BLOCKS)
+    {
+        if(length < 3 || pBuffer[2] >= SIM_NFC_BLOCK_SIZE)
+        {
+            return -1;
+        }
+
+        gSessionByte = pBuffer[2];
+
+        if(length >= 5)
+        {
+            pByte  = &session(block)[pBuffer[2]];
+            *pByte = (uint8_t)((*pByte & ~pBuffer[3]) | (pBuffer[4] & pBuffer[3]));
+
+            // the chip resets right away and doesn't acknowledge the write
+            if(block == SIM_NFC_SES_RESET_GEN && pBuffer[4] == SIM_NFC_RESET_VALUE)
+            {
+                resetChip();
+                return -1;
+            }
+        }
+
+        return 0;
+    }
+
+    // the memory is written in whole blocks
+    if((length - 2) % SIM_NFC_BLOCK_SIZE ||
+        block + (length - 2) / SIM_NFC_BLOCK_SIZE > SIM_NFC_MEMORY_BLOCKS)
+    {
+        return -1;
+    }
+
+    memcpy(gMemory[block], &pBuffer[2], (size_t)(length - 2));
+
+    return 0;
+}
+
+/*!
+ * @brief   function to handle a read message
+ *
+ * @param   pBuffer the bytes to read
+ * @param   length the amount of bytes
+ *
+ * @return  0 if ok, -1 if the chip doesn't answer
+ */
+static int readMessage(uint8_t *pBuffer, ssize_t length)
+{
+    // a byte of a session register
+    if(gSessionByte >= 0)
+    {
+        memset(pBuffer, 0, (size_t)length);
+        pBuffer[0] = session(gReadBlock)[gSessionByte];
+        return 0;
+    }
+
+    if(gReadBlock * SIM_NFC_BLOCK_SIZE + length > (ssize_t)sizeof(gMemory))
+    {
+        return -1;
+    }
+
+    memcpy(pBuffer, gMemory[gReadBlock], (size_t)length);
+
+    return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_nfc_initialize(void)
+{
+    resetChip();
+}
+
+int sim_nfc_transfer(struct i2c_msg_s *pMessages, size_t count)
+{
+    bool   poweredDown = sim_gpio_get(NFC_HPD);
+    size_t i;
+    int    lvRetValue = 0;
+
+    // the A1007 is not simulated
+    if(count == 0 || pMessages[0].addr != SIM_NFC_ADDRESS)
+    {
+        errno = ENXIO;
+        return -1;
+    }
+
+    sim_lock();
+
+    // the chip boots when it leaves the hard power-down mode
+    if(gPoweredDown && !poweredDown)
+    {
+        resetChip();
+    }
+    gPoweredDown = poweredDown;
+
+    for(i = 0; i < count && !lvRetValue && !poweredDown; i++)
+    {
+        if(pMessages[i].flags & I2C_M_READ)
+        {
+            lvRetValue = readMessage(pMessages[i].buffer, pMessages[i].length);
+        }
+        else
+        {
+            lvRetValue = writeMessage(pMessages[i].buffer, pMessages[i].length);
+        }
+    }
+
+    sim_unlock();
+
+    if(poweredDown || lvRetValue)
+    {
+        errno = ENXIO;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,545 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_os.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The operating system part of the simulation.
+ * The NuttX tasks run on pthreads, each with a pid and a priority of its own
+ * (getpid() and sched_getparam() are wrapped by the linker for that) and a
+ * colored stack, so /proc/<pid>/stack can report the high-water mark.
+ * This file has the board functions as well: the user LEDs, boardctl() and
+ * the font of the display.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <malloc.h>
+#include <sys/boardctl.h>
+#include <nuttx/board.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the maximum amount of tasks
+#define SIM_OS_MAX_TASKS        32
+
+//! @brief the pid of the main thread, this is the task that runs bms_main like the NSH would
+#define SIM_OS_MAIN_PID         1
+
+//! @brief the host uses more stack than the MCU, the stack of a task is this factor larger
+#define SIM_OS_STACK_FACTOR     16
+
+//! @brief the minimum stack of a task on the host
+#define SIM_OS_STACK_MIN        (128 * 1024)
+
+//! @brief the value the stack is filled with to find the high-water mark
+#define SIM_OS_STACK_COLOR      0xAA
+
+//! @brief the amount of LEDs of the board (red, green and blue)
+#define SIM_OS_LEDS             3
+
+//! @brief the size of a glyph of the font
+#define SIM_OS_GLYPH_SIZE       8
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a task */
+typedef struct
+{
+    pid_t     pid;       //!< the pid, 0 if this entry is free
+    pthread_t thread;    //!< the thread of the task
+    char      name[16];  //!< the name of the task
+    int       priority;  //!< the priority given to task_create
+    uint8_t  *pStack;    //!< the stack of the thread, NULL for the main thread
+    size_t    stackSize; //!< the size of pStack
+    main_t    entry;     //!< the entry point
+    char    **argv;      //!< the arguments, NULL terminated
+    void     *pClock;    //!< the thread of the clock, see sim_clock_addThread()
+} simTask_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the tasks, an entry is only filled while gTasksLock is locked
+static simTask_t gTasks[SIM_OS_MAX_TASKS];
+static pthread_mutex_t gTasksLock = PTHREAD_MUTEX_INITIALIZER;
+
+//! the next pid to give out
+static pid_t gNextPid = SIM_OS_MAIN_PID + 1;
+
+//! the task of the calling thread, NULL for threads that are not a task
+static __thread simTask_t *gpThisTask = NULL;
+
+//! the LEDs that are on, a bit per LED
+static uint32_t gLedSet = 0;
+
+//! the power management state of the MCU
+static uint32_t gPmState = PM_NORMAL;
+
+//! the font, the first row of a glyph is the character itself so the display can be read back
+static const struct nx_font_s gFontSet = { SIM_OS_GLYPH_SIZE, SIM_OS_GLYPH_SIZE, 8, SIM_OS_GLYPH_SIZE };
+static uint8_t                gGlyphBitmaps[128][SIM_OS_GLYPH_SIZE];
+static struct nx_fontbitmap_s gGlyphs[128];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to run a task on its thread
+ *
+ * @param   pArg the address of the simTask_t of the task
+ *
+ * @return  NULL
+ */
+static void *taskThread(void *pArg)
+{
+    simTask_t *pTask = (simTask_t *)pArg;
+    int        argc  = 0;
+
+    gpThisTask = pTask;
+    sim_clock_startThread(pTask->pClock);
+
+    // count the arguments, argv[0] is the name of the task
+    while(pTask->argv[argc] != NULL)
+    {
+        argc++;
+    }
+
+    pTask->entry(argc, pTask->argv);
+
+    // the clock doesn't wait on it anymore
+    sim_clock_endThread(pTask->pClock);
+
+    return NULL;
+}
+
+/*!
+ * @brief   function to find a task
+ * @note    gTasksLock needs to be locked.
+ *
+ * @param   pid the pid of the task
+ *
+ * @return  the address of the task, NULL if it isn't there
+ */
+static simTask_t *findTask(pid_t pid)
+{
+    int i;
+
+    for(i = 0; i < SIM_OS_MAX_TASKS; i++)
+    {
+        if(gTasks[i].pid == pid)
+        {
+            return &gTasks[i];
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_os_initialize(void)
+{
+    int i;
+
+    // the main thread is the first task
+    gTasks[0].pid      = SIM_OS_MAIN_PID;
+    gTasks[0].thread   = pthread_self();
+    gTasks[0].priority = CONFIG_NXP_BMS_PRIORITY;
+    strncpy(gTasks[0].name, CONFIG_NXP_BMS_PROGNAME, sizeof(gTasks[0].name) - 1);
+    gpThisTask = &gTasks[0];
+
+    // make the glyphs of the printable characters, ' ' has none like a real font
+    for(i = '!'; i < 127; i++)
+    {
+        gGlyphBitmaps[i][0]     = (uint8_t)i;
+        gGlyphs[i].metric.stride = 1;
+        gGlyphs[i].metric.width  = SIM_OS_GLYPH_SIZE;
+        gGlyphs[i].metric.height = SIM_OS_GLYPH_SIZE;
+        gGlyphs[i].bitmap        = gGlyphBitmaps[i];
+    }
+}
+
+int sim_os_getStack(pid_t pid, size_t *pSize, size_t *pUsed)
+{
+    simTask_t *pTask;
+    size_t     unused = 0;
+    int        lvRetValue = -1;
+
+    pthread_mutex_lock(&gTasksLock);
+
+    // the main thread has the stack of the process, that isn't colored
+    pTask = findTask(pid);
+    if(pTask != NULL && pTask->pStack != NULL)
+    {
+        // the stack grows down, so count the colored bytes from the bottom
+        while(unused < pTask->stackSize && pTask->pStack[unused] == SIM_OS_STACK_COLOR)
+        {
+            unused++;
+        }
+
+        *pSize     = pTask->stackSize;
+        *pUsed     = pTask->stackSize - unused;
+        lvRetValue = 0;
+    }
+
+    pthread_mutex_unlock(&gTasksLock);
+
+    return lvRetValue;
+}
+
+int sim_os_setPriority(int priority)
+{
+    int lvRetValue = -1;
+
+    pthread_mutex_lock(&gTasksLock);
+
+    if(gpThisTask != NULL)
+    {
+        lvRetValue           = gpThisTask->priority;
+        gpThisTask->priority = priority;
+    }
+
+    pthread_mutex_unlock(&gTasksLock);
+
+    return lvRetValue;
+}
+
+void sim_os_reset(unsigned resetCause, const char *reason)
+{
+    char  cause[16];
+    char  path[256];
+    char  cmdline[1024];
+    char *argv[64];
+    int   argc = 0;
+    FILE *pFile;
+    size_t length, i;
+
+    fprintf(stderr, "\nsim: reset: %s\n", reason);
+    fflush(stdout);
+    fflush(stderr);
+
+    // the restarted process reads the reset cause from the environment
+    snprintf(cause, sizeof(cause), "0x%x", resetCause);
+    setenv("SIM_RESET_CAUSE", cause, 1);
+
+    // get the arguments of this process
+    pFile = fopen("/proc/self/cmdline", "r");
+    if(pFile == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    length = fread(cmdline, 1, sizeof(cmdline) - 1, pFile);
+    fclose(pFile);
+    cmdline[length] = '\0';
+
+    for(i = 0; i < length && argc < 63; i += strlen(&cmdline[i]) + 1)
+    {
+        argv[argc++] = &cmdline[i];
+    }
+    argv[argc] = NULL;
+
+    // start this program again in this process, like the MCU restarts
+    length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if(length > 0 && length < sizeof(path))
+    {
+        path[length] = '\0';
+        execv(path, argv);
+    }
+
+    fprintf(stderr, "sim: couldn't restart: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+void sim_os_powerOff(const char *reason)
+{
+    fflush(stdout);
+    fprintf(stderr, "\nsim: power off: %s\n", reason);
+    exit(EXIT_SUCCESS);
+}
+
+/* NuttX ********************************************************************/
+int task_create(const char *name, int priority, int stackSize, main_t entry, char *const argv[])
+{
+    simTask_t     *pTask = NULL;
+    pthread_attr_t attr;
+    int            argc = 0, i;
+    int            error;
+
+    // count the arguments
+    while(argv != NULL && argv[argc] != NULL)
+    {
+        argc++;
+    }
+
+    pthread_mutex_lock(&gTasksLock);
+
+    // find a free entry
+    pTask = findTask(0);
+    if(pTask == NULL)
+    {
+        pthread_mutex_unlock(&gTasksLock);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // fill it, argv[0] is the name of the task like NuttX does
+    memset(pTask, 0, sizeof(simTask_t));
+    strncpy(pTask->name, name, sizeof(pTask->name) - 1);
+    pTask->priority  = priority;
+    pTask->entry     = entry;
+    pTask->stackSize = (size_t)stackSize * SIM_OS_STACK_FACTOR;
+    if(pTask->stackSize < SIM_OS_STACK_MIN)
+    {
+        pTask->stackSize = SIM_OS_STACK_MIN;
+    }
+    pTask->pStack = malloc(pTask->stackSize);
+    pTask->argv   = calloc(argc + 2, sizeof(char *));
+    if(pTask->pStack == NULL || pTask->argv == NULL)
+    {
+        free(pTask->pStack);
+        free(pTask->argv);
+        pTask->pid = 0;
+        pthread_mutex_unlock(&gTasksLock);
+        errno = ENOMEM;
+        return -1;
+    }
+    pTask->argv[0] = pTask->name;
+    for(i = 0; i < argc; i++)
+    {
+        pTask->argv[i + 1] = strdup(argv[i]);
+    }
+
+    // color the stack for the high-water mark
+    memset(pTask->pStack, SIM_OS_STACK_COLOR, pTask->stackSize);
+    pTask->pid = gNextPid++;
+
+    // count it for the clock before it runs
+    pTask->pClock = sim_clock_addThread(pTask->name);
+
+    // start it
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, pTask->pStack, pTask->stackSize);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    error = pthread_create(&pTask->thread, &attr, taskThread, pTask);
+    pthread_attr_destroy(&attr);
+
+    if(error)
+    {
+        sim_clock_endThread(pTask->pClock);
+        pTask->pid = 0;
+        pthread_mutex_unlock(&gTasksLock);
+        errno = error;
+        return -1;
+    }
+
+    pthread_mutex_unlock(&gTasksLock);
+
+    return pTask->pid;
+}
+
+int sched_lock(void)
+{
+    return 0;
+}
+
+int sched_unlock(void)
+{
+    return 0;
+}
+
+pid_t __wrap_getpid(void)
+{
+    // threads that are not a task (like the world tick) get the pid of the process
+    return (gpThisTask != NULL) ? gpThisTask->pid : SIM_OS_MAIN_PID;
+}
+
+int __wrap_sched_getparam(pid_t pid, struct sched_param *param)
+{
+    simTask_t *pTask;
+    int        lvRetValue = -1;
+
+    // 0 is the calling task
+    if(pid == 0)
+    {
+        pid = __wrap_getpid();
+    }
+
+    pthread_mutex_lock(&gTasksLock);
+
+    pTask = findTask(pid);
+    if(pTask != NULL)
+    {
+        param->sched_priority = pTask->priority;
+        lvRetValue            = 0;
+    }
+    else
+    {
+        errno = ESRCH;
+    }
+
+    pthread_mutex_unlock(&gTasksLock);
+
+    return lvRetValue;
+}
+
+struct sim_mallinfo sim_mallinfo(void)
+{
+    struct sim_mallinfo info;
+    struct mallinfo2    hostInfo = mallinfo2();
+
+    // glibc has no largest free chunk, the free space at the top of the heap is used for it
+    info.arena    = (int)hostInfo.arena;
+    info.ordblks  = (int)hostInfo.ordblks;
+    info.aordblks = 0;
+    info.mxordblk = (int)hostInfo.keepcost;
+    info.uordblks = (int)hostInfo.uordblks;
+    info.fordblks = (int)hostInfo.fordblks;
+
+    return info;
+}
+
+/* board ********************************************************************/
+uint32_t board_userled_initialize(void)
+{
+    return SIM_OS_LEDS;
+}
+
+void board_userled(int led, bool ledon)
+{
+    sim_lock();
+    gLedSet = ledon ? (gLedSet | (1 << led)) : (gLedSet & ~(1 << led));
+    sim_unlock();
+}
+
+void board_userled_all(uint32_t ledset)
+{
+    sim_lock();
+    gLedSet = ledset;
+    sim_unlock();
+}
+
+void board_userled_getall(uint32_t *ledset)
+{
+    sim_lock();
+    *ledset = gLedSet;
+    sim_unlock();
+}
+
+int boardctl(unsigned int cmd, uintptr_t arg)
+{
+    struct boardioc_pm_ctrl_s *pPm = (struct boardioc_pm_ctrl_s *)arg;
+    int                        lvRetValue = 0;
+
+    switch(cmd)
+    {
+        case BOARDIOC_PM_CONTROL:
+            sim_lock();
+            if(pPm->action == BOARDIOC_PM_QUERYSTATE)
+            {
+                pPm->state = gPmState;
+            }
+            else if(pPm->action == BOARDIOC_PM_CHANGESTATE)
+            {
+                gPmState = pPm->state;
+            }
+            sim_unlock();
+            break;
+        case BOARDIOC_UNIQUEID:
+            // the serial number of the simulated MCU
+            memset((void *)arg, 0, CONFIG_BOARDCTL_UNIQUEID_SIZE);
+            memcpy((void *)arg, "BMS772-SIM", 10);
+            break;
+        case BOARDIOC_RESET:
+            sim_os_reset(SIM_RESET_CAUSE_POR, "boardctl(BOARDIOC_RESET)");
+            break;
+        case BOARDIOC_POWEROFF:
+            sim_os_powerOff("boardctl(BOARDIOC_POWEROFF)");
+            break;
+        default:
+            errno      = ENOTTY;
+            lvRetValue = -1;
+            break;
+    }
+
+    return lvRetValue;
+}
+
+uint32_t sim_os_getLeds(void)
+{
+    uint32_t ledSet;
+
+    board_userled_getall(&ledSet);
+
+    return ledSet;
+}
+
+/* fonts ********************************************************************/
+NXHANDLE nxf_getfonthandle(int fontid)
+{
+    (void)fontid;
+    return (NXHANDLE)&gFontSet;
+}
+
+const struct nx_font_s *nxf_getfontset(NXHANDLE handle)
+{
+    return (const struct nx_font_s *)handle;
+}
+
+const struct nx_fontbitmap_s *nxf_getbitmap(NXHANDLE handle, uint16_t ch)
+{
+    (void)handle;
+
+    if(ch >= 128 || gGlyphs[ch].bitmap == NULL)
+    {
+        return NULL;
+    }
+
+    return &gGlyphs[ch];
+}
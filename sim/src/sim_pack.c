@@ -0,0 +1,426 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_pack.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The battery pack, the power switch and the load of the simulation.
+ * The cells are LiPo cells in series with an open circuit voltage curve and
+ * an internal resistance, the charge follows the current while the power
+ * switch is closed. The cells are connected to the MC33772 like on the
+ * board: cell 1 and 2 to the first 2 inputs, the others to the last ones.
+ * The power switch is the gate driver that latches GATE_CTRL_D on a rising
+ * edge of GATE_CTRL_CP. A cell of which the MC33772 turned the balancing
+ * driver on is discharged through the balancing resistor. A charger with a
+ * constant voltage limits the charge current to reach its voltage (CC/CV).
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the internal resistance of a cell in ohm
+#define SIM_PACK_R_CELL         0.008f
+
+//! @brief the current of the board itself in A, this flows even if the power switch is open
+#define SIM_PACK_I_BOARD        (-0.003f)
+
+//! @brief the current from which the hardware overcurrent detection of the board triggers in A
+#define SIM_PACK_I_HW_OVERCURRENT 200.0f
+
+//! @brief the balancing resistor of a cell in ohm, like RBAL of balancing.c
+#define SIM_PACK_R_BALANCE      82.0f
+
+//! @brief the amount of points of the open circuit voltage curve, a point each 10%
+#define SIM_PACK_OCV_POINTS     11
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the open circuit voltage of a LiPo cell from 0% to 100% in steps of 10%
+static const float gOcvCurve[SIM_PACK_OCV_POINTS] = {
+    3.30f, 3.69f, 3.74f, 3.77f, 3.79f, 3.82f, 3.87f, 3.92f, 3.98f, 4.06f, 4.20f
+};
+
+//! the state of charge of each cell from 0 to 1, a double as the charge of a tick is below the float resolution
+static double gSoc[SIM_MAX_CELLS];
+
+//! the forced voltage of each cell, 0 if the voltage follows the charge
+static float gForcedVoltage[SIM_MAX_CELLS];
+
+//! the charge that is discharged by the balancing and the time of the balancing of each cell
+static double   gBalancedAh[SIM_MAX_CELLS];
+static uint64_t gBalancingUs[SIM_MAX_CELLS];
+static uint64_t gLastBalancingUs[SIM_MAX_CELLS];
+
+//! the current of the load (negative) or the charger (positive) in A
+static float gLoadCurrent;
+
+//! the constant voltage of the charger in V, 0 if the current isn't limited
+static float gChargerVoltage = 0.0f;
+
+//! the temperature of the sensors in degrees C
+static float gTemperature;
+
+//! the state of the power switch and the last level of the CP pin
+static bool gGateClosed = false;
+static bool gLastCp     = false;
+
+//! the time of the last tick in us
+static uint64_t gLastTickUs = 0;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get the open circuit voltage of a cell
+ *
+ * @param   soc the state of charge from 0 to 1
+ *
+ * @return  the voltage in V
+ */
+static float getOcv(float soc)
+{
+    float position;
+    int   index;
+
+    // clamp it to the curve
+    if(soc <= 0.0f)
+    {
+        return gOcvCurve[0];
+    }
+    if(soc >= 1.0f)
+    {
+        return gOcvCurve[SIM_PACK_OCV_POINTS - 1];
+    }
+
+    // interpolate between the points
+    position = soc * (SIM_PACK_OCV_POINTS - 1);
+    index    = (int)position;
+
+    return gOcvCurve[index] + (gOcvCurve[index + 1] - gOcvCurve[index]) * (position - index);
+}
+
+/*!
+ * @brief   function to get the cell input of the MC33772 of a cell
+ *
+ * @param   cell the cell (0 - cells - 1)
+ *
+ * @return  the cell input (0 - 5)
+ */
+static int getBccCell(int cell)
+{
+    // the first 2 cells are on the first 2 inputs, the others on the last inputs
+    return (cell < 2) ? cell : (cell + SIM_MAX_CELLS - gSimConfig.cells);
+}
+
+/*!
+ * @brief   function to get the voltage of a cell of the pack
+ *
+ * @param   cell the cell (0 - cells - 1)
+ *
+ * @return  the voltage in V
+ */
+static float getCellVoltage(int cell)
+{
+    float current = sim_pack_getCurrent();
+    float ocv;
+
+    if(gForcedVoltage[cell] > 0.0f)
+    {
+        return gForcedVoltage[cell];
+    }
+
+    // the balancing current is a load of the cell itself
+    ocv = getOcv((float)gSoc[cell]);
+    if(sim_afe_isBalancing(getBccCell(cell)))
+    {
+        current -= ocv / SIM_PACK_R_BALANCE;
+    }
+
+    // the terminal voltage rises when charging and drops with a load
+    return ocv + current * SIM_PACK_R_CELL;
+}
+
+/*!
+ * @brief   function to get the charge current of the charger
+ *          with a constant voltage it is limited to get the stack voltage to that voltage
+ *
+ * @return  the current in A
+ */
+static float getChargerCurrent(void)
+{
+    float ocv = 0.0f;
+    int   i;
+
+    if(gChargerVoltage <= 0.0f)
+    {
+        return gLoadCurrent;
+    }
+
+    for(i = 0; i < gSimConfig.cells; i++)
+    {
+        ocv += getOcv((float)gSoc[i]);
+    }
+
+    // the current through the internal resistance of the cells is the voltage difference
+    return fminf(gLoadCurrent, fmaxf((gChargerVoltage - ocv) / (gSimConfig.cells * SIM_PACK_R_CELL), 0.0f));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_pack_initialize(void)
+{
+    int i;
+
+    for(i = 0; i < SIM_MAX_CELLS; i++)
+    {
+        gSoc[i]             = ((gSimConfig.cellSoc[i] > 0.0f) ? gSimConfig.cellSoc[i] : gSimConfig.soc) / 100.0;
+        gForcedVoltage[i]   = 0.0f;
+        gBalancedAh[i]      = 0.0;
+        gBalancingUs[i]     = 0;
+        gLastBalancingUs[i] = 0;
+    }
+
+    gLoadCurrent = gSimConfig.current;
+    gTemperature = gSimConfig.temperature;
+}
+
+void sim_pack_tick(uint64_t nowUs)
+{
+    float    current = sim_pack_getCurrent();
+    double   deltaAh, balanceAh;
+    uint64_t deltaUs;
+    int      i;
+
+    // check if this is the first tick
+    if(gLastTickUs == 0)
+    {
+        gLastTickUs = nowUs;
+        return;
+    }
+
+    // all cells are in series, so the same charge goes through each of them
+    deltaUs     = nowUs - gLastTickUs;
+    deltaAh     = (double)current * (double)deltaUs / (3600.0 * 1000000.0);
+    gLastTickUs = nowUs;
+
+    for(i = 0; i < gSimConfig.cells; i++)
+    {
+        // a balanced cell is discharged through the balancing resistor as well
+        balanceAh = 0.0;
+        if(sim_afe_isBalancing(getBccCell(i)))
+        {
+            balanceAh = (double)(getCellVoltage(i) / SIM_PACK_R_BALANCE) * (double)deltaUs / (3600.0 * 1000000.0);
+
+            gBalancedAh[i]      += balanceAh;
+            gBalancingUs[i]     += deltaUs;
+            gLastBalancingUs[i]  = nowUs;
+        }
+
+        gSoc[i] += (deltaAh - balanceAh) / gSimConfig.capacity;
+        gSoc[i] = fmin(fmax(gSoc[i], 0.0), 1.0);
+    }
+
+    // the overcurrent detection of the board is a comparator on the shunt voltage
+    sim_gpio_set(OVERCURRENT, fabsf(current) > SIM_PACK_I_HW_OVERCURRENT);
+}
+
+void sim_pack_setGatePins(bool cp, bool d)
+{
+    // the gate driver latches D on the rising edge of CP, a low D closes the switch
+    if(cp && !gLastCp)
+    {
+        gGateClosed = !d;
+    }
+
+    gLastCp = cp;
+}
+
+float sim_pack_getCellVoltage(int bccCell)
+{
+    // the first 2 inputs are cell 1 and 2, the other cells are on the last inputs
+    if(bccCell < 2)
+    {
+        return getCellVoltage(bccCell);
+    }
+    if(bccCell >= (SIM_MAX_CELLS - gSimConfig.cells + 2))
+    {
+        return getCellVoltage(bccCell - (SIM_MAX_CELLS - gSimConfig.cells));
+    }
+
+    // the input isn't connected (it is shorted to the previous one on the board)
+    return 0.0f;
+}
+
+float sim_pack_getStackVoltage(void)
+{
+    float voltage = 0.0f;
+    int   i;
+
+    for(i = 0; i < gSimConfig.cells; i++)
+    {
+        voltage += getCellVoltage(i);
+    }
+
+    return voltage;
+}
+
+float sim_pack_getCurrent(void)
+{
+    // the load or the charger only gets current through the power switch
+    return gGateClosed ? (getChargerCurrent() + SIM_PACK_I_BOARD) : SIM_PACK_I_BOARD;
+}
+
+float sim_pack_getOutputVoltage(void)
+{
+    // a connected charger keeps the output voltage while the power switch is open
+    if(!gGateClosed)
+    {
+        return (gChargerVoltage > 0.0f && gLoadCurrent > 0.0f) ? gChargerVoltage : 0.0f;
+    }
+
+    return sim_pack_getStackVoltage();
+}
+
+float sim_pack_getTemperature(int anx)
+{
+    (void)anx;
+    return gTemperature;
+}
+
+void sim_pack_setCurrent(float current)
+{
+    sim_lock();
+    gLoadCurrent = current;
+    sim_unlock();
+}
+
+void sim_pack_setTemperature(float temperature)
+{
+    sim_lock();
+    gTemperature = temperature;
+    sim_unlock();
+}
+
+void sim_pack_setChargerVoltage(float voltage)
+{
+    sim_lock();
+    gChargerVoltage = voltage;
+    sim_unlock();
+}
+
+int sim_pack_setCellVoltage(int cell, float voltage)
+{
+    if(cell < 0 || cell >= gSimConfig.cells)
+    {
+        return -1;
+    }
+
+    sim_lock();
+    gForcedVoltage[cell] = voltage;
+    sim_unlock();
+
+    return 0;
+}
+
+float sim_pack_getSoc(void)
+{
+    float soc = 1.0f;
+    int   i;
+
+    sim_lock();
+
+    // the pack is empty when its lowest cell is
+    for(i = 0; i < gSimConfig.cells; i++)
+    {
+        soc = fminf(soc, (float)gSoc[i]);
+    }
+
+    sim_unlock();
+
+    return soc * 100.0f;
+}
+
+int sim_pack_getCell(int cell, simPackCell_t *pCell)
+{
+    if(cell < 0 || cell >= gSimConfig.cells)
+    {
+        return -1;
+    }
+
+    sim_lock();
+    pCell->soc             = (float)(gSoc[cell] * 100.0);
+    pCell->balancedAh      = (float)gBalancedAh[cell];
+    pCell->balancingUs     = gBalancingUs[cell];
+    pCell->lastBalancingUs = gLastBalancingUs[cell];
+    sim_unlock();
+
+    return 0;
+}
+
+void sim_pack_print(FILE *pStream)
+{
+    int i;
+
+    sim_lock();
+
+    fprintf(pStream, "power switch: %s\n", gGateClosed ? "closed" : "open");
+    fprintf(pStream, "current:      %.3f A (load %.3f A)\n", sim_pack_getCurrent(), gLoadCurrent);
+    if(gChargerVoltage > 0.0f)
+    {
+        fprintf(pStream, "charger:      %.3f V\n", gChargerVoltage);
+    }
+    fprintf(pStream, "stack:        %.3f V\n", sim_pack_getStackVoltage());
+    fprintf(pStream, "output:       %.3f V\n", sim_pack_getOutputVoltage());
+    fprintf(pStream, "temperature:  %.1f C\n", gTemperature);
+    for(i = 0; i < gSimConfig.cells; i++)
+    {
+        fprintf(pStream, "cell %d:       %.3f V %5.1f%%%s%s\n", i + 1, getCellVoltage(i), gSoc[i] * 100.0,
+            (gForcedVoltage[i] > 0.0f) ? " (forced)" : "",
+            sim_afe_isBalancing(getBccCell(i)) ? " (balancing)" : "");
+    }
+
+    sim_unlock();
+}
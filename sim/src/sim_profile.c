@@ -0,0 +1,412 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_profile.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The timing of the BMS functions for the replay.
+ * The sources with the measurement, state machine and balancing functions
+ * are built with -finstrument-functions, so each function calls the hooks
+ * below when it starts and when it returns. The functions that are timed
+ * are found by their name in the symbol table of the program itself, that
+ * has the static functions as well. The host CPU time of the thread is used,
+ * so the time a task waits (on the virtual clock) isn't counted.
+ * The end of setMainState() and setChargeState() of main.c is used to see
+ * each state transition, the state lock is released there so the state can be
+ * read. The benchmark finds the static functions it calls the same way.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the maximum amount of timed functions that are running in each other in a thread
+#define SIM_PROFILE_DEPTH       8
+
+//! @brief the amount of functions of main.c that set a state
+#define SIM_PROFILE_TRANSITIONS 2
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a timed function that is running */
+typedef struct
+{
+    int      function; //!< the simProfileFunction_t
+    uint64_t startNs;  //!< the CPU time it started
+} simProfileCall_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the names of the functions, in the order of simProfileFunction_t
+static const char *const gNames[SIM_PROFILE_FUNCTIONS] = {
+    [SIM_PROFILE_CALCULATE_VARIABLES]   = "bcc_monitoring_calculateVariables",
+    [SIM_PROFILE_CHECK_MEASUREMENTS]    = "checkAllMeasurements",
+    [SIM_PROFILE_CHECK_TRANSITIONS]     = "checkInputsAndStateTransitions",
+    [SIM_PROFILE_MAIN_STATE_MACHINE]    = "mainStateMachine",
+    [SIM_PROFILE_CHARGE_STATE_MACHINE]  = "chargeStateMachine",
+    [SIM_PROFILE_HANDLE_FAULT]          = "bmsHandleFault",
+    [SIM_PROFILE_BALANCING]             = "balancing_handleCellBalancing",
+};
+
+//! the addresses of the functions, 0 if it isn't found
+static uintptr_t gAddresses[SIM_PROFILE_FUNCTIONS];
+static uintptr_t gTransitionAddresses[SIM_PROFILE_TRANSITIONS];
+
+//! the functions of main.c that set the main and the charge state
+static const char *gTransitionNames[SIM_PROFILE_TRANSITIONS] = { "setMainState", "setChargeState" };
+
+//! the function to call after a state transition
+static void (*gpTransitionCallback)(void) = NULL;
+
+//! the timing of each function, these are changed with atomics
+static uint64_t gCalls[SIM_PROFILE_FUNCTIONS];
+static uint64_t gTotalNs[SIM_PROFILE_FUNCTIONS];
+static uint64_t gMaxNs[SIM_PROFILE_FUNCTIONS];
+
+//! true when the addresses are found, the hooks do nothing before that
+static bool gReady = false;
+
+//! the timed functions that are running in this thread
+static __thread simProfileCall_t gCallStack[SIM_PROFILE_DEPTH];
+static __thread int              gCallDepth = 0;
+
+//! true while the transition callback runs in this thread, it calls functions of main.c as well
+static __thread bool gInCallback = false;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+void __cyg_profile_func_enter(void *pFunction, void *pCallSite) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void *pFunction, void *pCallSite) __attribute__((no_instrument_function));
+
+/*!
+ * @brief   function to check if a symbol is a function, a clone of it (like "name.isra.0") counts as well
+ *
+ * @param   pSymbol the name of the symbol
+ * @param   pName the name of the function
+ *
+ * @return  true if it is the function
+ */
+static bool isFunction(const char *pSymbol, const char *pName)
+{
+    size_t length = strlen(pName);
+
+    return !strncmp(pSymbol, pName, length) && (pSymbol[length] == '\0' || pSymbol[length] == '.');
+}
+
+/*!
+ * @brief   function to read a part of the program file
+ *
+ * @param   pFile the program file
+ * @param   offset the offset in the file
+ * @param   size the amount of bytes
+ *
+ * @return  the allocated bytes, NULL if it can't be read
+ */
+static void *readPart(FILE *pFile, uint64_t offset, uint64_t size)
+{
+    void *pPart = malloc(size);
+
+    if(pPart != NULL && (fseek(pFile, (long)offset, SEEK_SET) || fread(pPart, 1, size, pFile) != size))
+    {
+        free(pPart);
+        pPart = NULL;
+    }
+
+    return pPart;
+}
+
+/*!
+ * @brief   function to find the addresses of functions in the symbol table of the program
+ *
+ * @param   pNames the names of the functions
+ * @param   pAddresses the addresses to become the ones of the functions, 0 if it isn't found
+ * @param   count the amount of functions
+ * @param   clones true if a clone of a function (like "name.isra.0") may be used as well
+ *
+ * @return  0 if ok, -1 if the program can't be read
+ */
+static int findSymbols(const char *const pNames[], uintptr_t pAddresses[], int count, bool clones)
+{
+    FILE       *pFile;
+    Elf64_Ehdr  header;
+    Elf64_Shdr *pSections = NULL;
+    Elf64_Sym  *pSymbols  = NULL;
+    char       *pStrings  = NULL;
+    const char *pSymbol;
+    uintptr_t   ownAddress = 0, bias;
+    size_t      i, symbols;
+    int         function, section;
+    int         lvRetValue = -1;
+
+    memset(pAddresses, 0, (size_t)count * sizeof(uintptr_t));
+
+    pFile = fopen("/proc/self/exe", "rb");
+    if(pFile == NULL)
+    {
+        return lvRetValue;
+    }
+
+    if(fread(&header, sizeof(header), 1, pFile) != 1 || memcmp(header.e_ident, ELFMAG, SELFMAG) ||
+        header.e_ident[EI_CLASS] != ELFCLASS64)
+    {
+        fclose(pFile);
+        return lvRetValue;
+    }
+
+    pSections = readPart(pFile, header.e_shoff, (uint64_t)header.e_shnum * sizeof(Elf64_Shdr));
+
+    for(section = 0; pSections != NULL && section < header.e_shnum; section++)
+    {
+        if(pSections[section].sh_type != SHT_SYMTAB)
+        {
+            continue;
+        }
+
+        // the symbols and their names
+        pSymbols = readPart(pFile, pSections[section].sh_offset, pSections[section].sh_size);
+        pStrings = readPart(pFile, pSections[pSections[section].sh_link].sh_offset,
+            pSections[pSections[section].sh_link].sh_size);
+        symbols  = pSections[section].sh_size / sizeof(Elf64_Sym);
+
+        for(i = 0; pSymbols != NULL && pStrings != NULL && i < symbols; i++)
+        {
+            if(ELF64_ST_TYPE(pSymbols[i].st_info) != STT_FUNC || pSymbols[i].st_value == 0)
+            {
+                continue;
+            }
+
+            pSymbol = &pStrings[pSymbols[i].st_name];
+
+            for(function = 0; function < count; function++)
+            {
+                if(pAddresses[function] == 0 &&
+                    (clones ? isFunction(pSymbol, pNames[function]) : !strcmp(pSymbol, pNames[function])))
+                {
+                    pAddresses[function] = pSymbols[i].st_value;
+                }
+            }
+            if(!strcmp(pSymbol, "sim_profile_initialize"))
+            {
+                ownAddress = pSymbols[i].st_value;
+            }
+        }
+
+        free(pSymbols);
+        free(pStrings);
+        break;
+    }
+
+    free(pSections);
+    fclose(pFile);
+
+    // the program may be loaded on another address than it is linked on
+    if(ownAddress != 0)
+    {
+        bias = (uintptr_t)&sim_profile_initialize - ownAddress;
+
+        for(function = 0; function < count; function++)
+        {
+            pAddresses[function] += (pAddresses[function] != 0) ? bias : 0;
+        }
+
+        lvRetValue = 0;
+    }
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   function to find the addresses of the timed functions and the transition functions
+ *
+ * @return  0 if ok, -1 if the program can't be read
+ */
+static int findFunctions(void)
+{
+    const char *pNames[SIM_PROFILE_FUNCTIONS + SIM_PROFILE_TRANSITIONS];
+    uintptr_t   addresses[SIM_PROFILE_FUNCTIONS + SIM_PROFILE_TRANSITIONS];
+
+    // the transition functions are found with the timed ones
+    memcpy(pNames, gNames, sizeof(gNames));
+    memcpy(&pNames[SIM_PROFILE_FUNCTIONS], gTransitionNames, sizeof(gTransitionNames));
+
+    if(findSymbols(pNames, addresses, SIM_PROFILE_FUNCTIONS + SIM_PROFILE_TRANSITIONS, true))
+    {
+        return -1;
+    }
+
+    memcpy(gAddresses, addresses, sizeof(gAddresses));
+    memcpy(gTransitionAddresses, &addresses[SIM_PROFILE_FUNCTIONS], sizeof(gTransitionAddresses));
+
+    return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+int sim_profile_initialize(void (*pTransitionCallback)(void))
+{
+    if(findFunctions())
+    {
+        fprintf(stderr, "sim: can't read the symbols of the program, the functions aren't timed!\n");
+        return -1;
+    }
+
+    gpTransitionCallback = pTransitionCallback;
+    __atomic_store_n(&gReady, true, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void sim_profile_reset(void)
+{
+    int function;
+
+    for(function = 0; function < SIM_PROFILE_FUNCTIONS; function++)
+    {
+        __atomic_store_n(&gCalls[function], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&gTotalNs[function], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&gMaxNs[function], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void sim_profile_get(simProfileFunction_t function, simProfileTiming_t *pTiming)
+{
+    pTiming->pName   = gNames[function];
+    pTiming->found   = (gAddresses[function] != 0);
+    pTiming->calls   = __atomic_load_n(&gCalls[function], __ATOMIC_RELAXED);
+    pTiming->totalNs = __atomic_load_n(&gTotalNs[function], __ATOMIC_RELAXED);
+    pTiming->maxNs   = __atomic_load_n(&gMaxNs[function], __ATOMIC_RELAXED);
+}
+
+void *sim_profile_findFunction(const char *pName)
+{
+    uintptr_t address;
+
+    // a clone may have other arguments, so only the function itself is used
+    if(findSymbols(&pName, &address, 1, false))
+    {
+        return NULL;
+    }
+
+    return (void *)address;
+}
+
+void __cyg_profile_func_enter(void *pFunction, void *pCallSite)
+{
+    int function;
+
+    (void)pCallSite;
+
+    if(!__atomic_load_n(&gReady, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    for(function = 0; function < SIM_PROFILE_FUNCTIONS; function++)
+    {
+        if((uintptr_t)pFunction == gAddresses[function])
+        {
+            // a call that is too deep is counted, but not timed
+            if(gCallDepth < SIM_PROFILE_DEPTH)
+            {
+                gCallStack[gCallDepth].function = function;
+                gCallStack[gCallDepth].startNs  = sim_clock_getCpuNs();
+            }
+            gCallDepth++;
+            return;
+        }
+    }
+}
+
+void __cyg_profile_func_exit(void *pFunction, void *pCallSite)
+{
+    uint64_t timeNs, maxNs;
+    int      function;
+
+    (void)pCallSite;
+
+    if(!__atomic_load_n(&gReady, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    // a state may have been set, the callback checks if it changed
+    if(((uintptr_t)pFunction == gTransitionAddresses[0] || (uintptr_t)pFunction == gTransitionAddresses[1]) &&
+        gpTransitionCallback != NULL && !gInCallback)
+    {
+        gInCallback = true;
+        gpTransitionCallback();
+        gInCallback = false;
+        return;
+    }
+
+    for(function = 0; function < SIM_PROFILE_FUNCTIONS; function++)
+    {
+        if((uintptr_t)pFunction == gAddresses[function] && gCallDepth > 0)
+        {
+            gCallDepth--;
+            if(gCallDepth >= SIM_PROFILE_DEPTH || gCallStack[gCallDepth].function != function)
+            {
+                return;
+            }
+
+            timeNs = sim_clock_getCpuNs() - gCallStack[gCallDepth].startNs;
+
+            __atomic_add_fetch(&gCalls[function], 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&gTotalNs[function], timeNs, __ATOMIC_RELAXED);
+
+            // keep the longest call
+            maxNs = __atomic_load_n(&gMaxNs[function], __ATOMIC_RELAXED);
+            while(timeNs > maxNs &&
+                !__atomic_compare_exchange_n(&gMaxNs[function], &maxNs, timeNs, false, __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+            {
+            }
+            return;
+        }
+    }
+}
@@ -0,0 +1,660 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_replay.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The replay of a current profile, like a log of a flight.
+ * The profile is a CSV file with lines of
+ * time_s,current_a[,temperature_c[,charger_v]], a positive current charges
+ * the pack. A line "cell_soc,<%>,<%>,..." sets the state of charge each cell
+ * starts with. It is replayed on the virtual clock of sim_clock.c, so it
+ * runs as fast as the host can run the application.
+ * When the profile has ended a report is made of the state transitions,
+ * the faults, the state of charge error, the balancing of the cells, the
+ * end of the charge, the wake-ups in each state and the time the BMS
+ * functions took.
+ * The time is compared with the one of an earlier report (the baseline),
+ * a function that became slower than allowed is a regression.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "data.h"
+#include "cli.h"
+#include "wakeSched.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the time between the steps of the replay in us
+#define SIM_REPLAY_STEP_US          100000
+
+//! @brief the time the BMS may take to get to the normal state before the replay in us
+#define SIM_REPLAY_START_US         120000000ULL
+
+//! @brief the maximum amount of samples, transitions and faults
+#define SIM_REPLAY_MAX_SAMPLES      1000000
+#define SIM_REPLAY_MAX_EVENTS       256
+
+//! @brief the length of a line of the profile or the baseline
+#define SIM_REPLAY_LINE_LENGTH      256
+
+//! @brief the line of the profile with the state of charge of each cell
+#define SIM_REPLAY_CELL_SOC         "cell_soc"
+
+//! @brief a mean time that increased less than this is never a regression (host noise) in ns
+#define SIM_REPLAY_MIN_INCREASE_NS  1000
+
+//! @brief the MCU current for the quiescent estimate of the SLEEP state in mA, the MCU is in VLPR (2 MHz)
+//!        and waits (WFI) between the wake-ups, these are assumptions since the host can't measure them
+#define SIM_REPLAY_VLPR_WAIT_MA     0.5
+#define SIM_REPLAY_VLPR_RUN_MA      1.5
+//! @brief the assumed time the MCU is awake for each wake-up in VLPR in ms
+#define SIM_REPLAY_VLPR_WAKE_MS     2.0
+
+//! @brief the exit codes of the replay
+#define SIM_REPLAY_EXIT_OK          0
+#define SIM_REPLAY_EXIT_REGRESSION  2
+#define SIM_REPLAY_EXIT_NO_START    3
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief a sample of the profile */
+typedef struct
+{
+    uint64_t timeUs;      //!< the time from the start of the profile
+    float    current;     //!< the current in A, positive is charging
+    float    temperature; //!< the temperature in C, NAN to keep it
+    float    charger;     //!< the constant voltage of the charger in V, 0 for none, NAN to keep it
+} simReplaySample_t;
+
+/*! @brief a state transition or a change of the faults */
+typedef struct
+{
+    uint64_t timeUs;   //!< the time from the start of the replay, 0 before it
+    bool     charge;   //!< true for the charge state machine
+    uint8_t  from;     //!< the old state
+    uint8_t  to;       //!< the new state
+    int      faults;   //!< the BMS faults (faults only)
+} simReplayEvent_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the samples of the profile
+static simReplaySample_t *gpSamples    = NULL;
+static size_t             gSampleCount = 0;
+
+//! the time the replay started, 0 while the BMS starts
+static uint64_t gStartUs = 0;
+
+//! the state transitions, protected with sim_lock()
+static simReplayEvent_t gTransitions[SIM_REPLAY_MAX_EVENTS];
+static size_t           gTransitionCount = 0;
+static size_t           gTransitionsLost = 0;
+static states_t         gLastMainState   = SELF_TEST;
+static charge_states_t  gLastChargeState = CHARGE_START;
+
+//! the changes of the faults
+static simReplayEvent_t gFaults[SIM_REPLAY_MAX_EVENTS];
+static size_t           gFaultCount = 0;
+
+//! the cells at the start of the replay
+static simPackCell_t gCellStart[SIM_MAX_CELLS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get the time from the start of the replay
+ *
+ * @return  the time in us, 0 before the replay started
+ */
+static uint64_t replayTimeUs(void)
+{
+    uint64_t startUs = __atomic_load_n(&gStartUs, __ATOMIC_ACQUIRE);
+
+    return (startUs != 0) ? (sim_getTimeUs() - startUs) : 0;
+}
+
+/*!
+ * @brief   function that is called after each state transition of the application
+ *          the new states are compared with the last ones
+ */
+static void transitionCallback(void)
+{
+    states_t        mainState   = data_getMainState();
+    charge_states_t chargeState = data_getChargeState();
+
+    sim_lock();
+
+    if(mainState != gLastMainState || chargeState != gLastChargeState)
+    {
+        if(gTransitionCount < SIM_REPLAY_MAX_EVENTS)
+        {
+            gTransitions[gTransitionCount].timeUs = replayTimeUs();
+            gTransitions[gTransitionCount].charge = (mainState == gLastMainState);
+            gTransitions[gTransitionCount].from =
+                (uint8_t)((mainState == gLastMainState) ? gLastChargeState : gLastMainState);
+            gTransitions[gTransitionCount].to = (uint8_t)((mainState == gLastMainState) ? chargeState : mainState);
+            gTransitionCount++;
+        }
+        else
+        {
+            gTransitionsLost++;
+        }
+
+        gLastMainState   = mainState;
+        gLastChargeState = chargeState;
+    }
+
+    sim_unlock();
+}
+
+/*!
+ * @brief   function to print the BMS faults
+ *
+ * @param   pStream the stream to print to
+ * @param   faults the BMS faults
+ */
+static void printFaults(FILE *pStream, int faults)
+{
+    if(faults == 0)
+    {
+        fprintf(pStream, "none");
+    }
+
+    fprintf(pStream, "%s%s%s%s%s", (faults & BMS_OV_FAULT) ? "ov " : "", (faults & BMS_UV_FAULT) ? "uv " : "",
+        (faults & BMS_OT_FAULT) ? "ot " : "", (faults & BMS_UT_FAULT) ? "ut " : "",
+        (faults & BMS_OC_FAULT) ? "oc " : "");
+}
+
+/*!
+ * @brief   function to print the state of charge and the balancing of each cell
+ *
+ * @param   pStream the stream to print to
+ */
+static void printCells(FILE *pStream)
+{
+    simPackCell_t cell;
+    float         startMin = 100.0f, startMax = 0.0f, endMin = 100.0f, endMax = 0.0f;
+    int           i;
+
+    fprintf(pStream, "cells\n");
+    fprintf(pStream, "  %-4s %10s %10s %14s %14s %10s\n", "cell", "soc_start", "soc_end", "balanced_mah",
+        "balancing_min", "last_s");
+
+    for(i = 0; !sim_pack_getCell(i, &cell); i++)
+    {
+        // the balancing of the replay itself
+        fprintf(pStream, "  %-4d %8.1f %% %8.1f %% %14.1f %14.1f %10.1f\n", i + 1, (double)gCellStart[i].soc,
+            (double)cell.soc, (double)(cell.balancedAh - gCellStart[i].balancedAh) * 1000.0,
+            (double)(cell.balancingUs - gCellStart[i].balancingUs) / 60e6,
+            (cell.lastBalancingUs > gStartUs) ? ((double)(cell.lastBalancingUs - gStartUs) / 1e6) : 0.0);
+
+        startMin = fminf(startMin, gCellStart[i].soc);
+        startMax = fmaxf(startMax, gCellStart[i].soc);
+        endMin   = fminf(endMin, cell.soc);
+        endMax   = fmaxf(endMax, cell.soc);
+    }
+
+    fprintf(pStream, "  spread    %.1f %% at the start, %.1f %% at the end\n", (double)(startMax - startMin),
+        (double)(endMax - endMin));
+}
+
+/*!
+ * @brief   function to print the charge cycles and the time the charge was complete
+ *
+ * @param   pStream the stream to print to
+ */
+static void printCharge(FILE *pStream)
+{
+    uint64_t completeUs = 0;
+    size_t   i;
+    int      cycles = 0;
+
+    for(i = 0; i < gTransitionCount; i++)
+    {
+        if(gTransitions[i].charge && gTransitions[i].to == CHARGE_CB)
+        {
+            cycles++;
+        }
+        if(gTransitions[i].charge && gTransitions[i].to == CHARGE_COMPLETE && completeUs == 0)
+        {
+            completeUs = gTransitions[i].timeUs;
+        }
+    }
+
+    fprintf(pStream, "charge\n");
+    fprintf(pStream, "  cycles    %d with balancing\n", cycles);
+    if(completeUs != 0)
+    {
+        fprintf(pStream, "  complete  %.1f s\n", (double)completeUs / 1e6);
+    }
+    else
+    {
+        fprintf(pStream, "  complete  no\n");
+    }
+}
+
+/*!
+ * @brief   function to print the wake-ups of each main state and the quiescent estimate of the SLEEP state
+ *
+ * @param   pStream the stream to print to
+ */
+static void printWakeUps(FILE *pStream)
+{
+    wakeSchedStats_t stats;
+    states_t         state;
+    double           perHour, wakeUpsMa;
+
+    fprintf(pStream, "wake-ups (per hour)\n");
+    fprintf(pStream, "  %-14s %9s %9s %9s %7s %7s %7s %7s %7s\n", "state", "time_s", "run_s", "wake-ups", "meas",
+        "main", "led", "can", "sup");
+
+    for(state = SELF_TEST; state < NUMBER_OF_MAIN_STATES; state++)
+    {
+        if(wakeSched_getStats(state, &stats) || !stats.timeMs)
+        {
+            continue;
+        }
+
+        perHour = 3600000.0 / stats.timeMs;
+        fprintf(pStream, "  %-14s %9.1f %9.1f %9.0f %7.0f %7.0f %7.0f %7.0f %7.0f\n",
+            cli_getStateString(true, state, NULL), stats.timeMs / 1e3, stats.runTimeMs / 1e3,
+            stats.wakeUps * perHour, stats.clientWakeUps[WAKE_SCHED_MEAS] * perHour,
+            stats.clientWakeUps[WAKE_SCHED_MAIN] * perHour, stats.clientWakeUps[WAKE_SCHED_LED] * perHour,
+            stats.clientWakeUps[WAKE_SCHED_CAN] * perHour, stats.clientWakeUps[WAKE_SCHED_SUPERVISOR] * perHour);
+
+        // the MCU waits in VLPR between the wake-ups of the SLEEP state
+        if(state == SLEEP)
+        {
+            wakeUpsMa = (stats.wakeUps * perHour / 3600.0) * (SIM_REPLAY_VLPR_WAKE_MS / 1e3) *
+                (SIM_REPLAY_VLPR_RUN_MA - SIM_REPLAY_VLPR_WAIT_MA);
+            fprintf(pStream, "  SLEEP MCU estimate %.3f mA, %.2f uA of it for the wake-ups\n",
+                SIM_REPLAY_VLPR_WAIT_MA + wakeUpsMa, wakeUpsMa * 1e3);
+            fprintf(pStream, "  (assumed %.1f mA waiting, %.1f mA awake for %.1f ms a wake-up)\n",
+                SIM_REPLAY_VLPR_WAIT_MA, SIM_REPLAY_VLPR_RUN_MA, SIM_REPLAY_VLPR_WAKE_MS);
+        }
+    }
+}
+
+/*!
+ * @brief   function to find the mean time of a function in the baseline
+ *
+ * @param   pName the name of the function
+ * @param   pMeanNs address to become the mean time in ns
+ *
+ * @return  0 if found, -1 if not
+ */
+static int getBaseline(const char *pName, uint64_t *pMeanNs)
+{
+    FILE    *pFile;
+    char     line[SIM_REPLAY_LINE_LENGTH];
+    char     name[64];
+    uint64_t calls, meanNs, maxNs;
+    int      lvRetValue = -1;
+
+    pFile = fopen(gSimConfig.baselinePath, "r");
+    if(pFile == NULL)
+    {
+        return lvRetValue;
+    }
+
+    // the timing lines are "  <name> <calls> <mean> <max>"
+    while(lvRetValue && fgets(line, sizeof(line), pFile) != NULL)
+    {
+        if(sscanf(line, " %63s %" SCNu64 " %" SCNu64 " %" SCNu64, name, &calls, &meanNs, &maxNs) == 4 &&
+            !strcmp(name, pName))
+        {
+            *pMeanNs   = meanNs;
+            lvRetValue = 0;
+        }
+    }
+
+    fclose(pFile);
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   function to print the report of the replay
+ *
+ * @param   pStream the stream to print to
+ * @param   durationUs the virtual time of the replay
+ * @param   wallNs the host time of the replay
+ * @param   pSocError the state of charge error: the maximum, the RMS and the last one in %
+ * @param   compare true to compare the timing with the baseline
+ *
+ * @return  the amount of regressions
+ */
+static int printReport(FILE *pStream, uint64_t durationUs, uint64_t wallNs, const float *pSocError, bool compare)
+{
+    simProfileTiming_t timing;
+    uint64_t           meanNs, baseNs;
+    size_t             i;
+    int                function, regressions = 0;
+
+    fprintf(pStream, "replay\n");
+    fprintf(pStream, "  profile   %s\n", gSimConfig.replayPath);
+    fprintf(pStream, "  samples   %zu\n", gSampleCount);
+    fprintf(pStream, "  duration  %.1f s\n", (double)durationUs / 1e6);
+    fprintf(pStream, "  host      %.3f s (%.0fx)\n", (double)wallNs / 1e9,
+        (wallNs != 0) ? ((double)durationUs * 1e3 / (double)wallNs) : 0.0);
+
+    fprintf(pStream, "soc\n");
+    fprintf(pStream, "  pack      %.1f %% at the end\n", (double)sim_pack_getSoc());
+    fprintf(pStream, "  error     max %.1f %%, rms %.1f %%, end %.1f %%\n", (double)pSocError[0],
+        (double)pSocError[1], (double)pSocError[2]);
+
+    printCells(pStream);
+    printCharge(pStream);
+    printWakeUps(pStream);
+
+    // the transitions before the replay, like the ones of the self test, are at 0
+    fprintf(pStream, "transitions\n");
+    for(i = 0; i < gTransitionCount; i++)
+    {
+        fprintf(pStream, "  %10.3f s %-6s %s -> %s\n", (double)gTransitions[i].timeUs / 1e6,
+            gTransitions[i].charge ? "charge" : "main", cli_getStateString(!gTransitions[i].charge,
+            gTransitions[i].from, NULL), cli_getStateString(!gTransitions[i].charge, gTransitions[i].to, NULL));
+    }
+    if(gTransitionsLost)
+    {
+        fprintf(pStream, "  %zu more transitions\n", gTransitionsLost);
+    }
+
+    fprintf(pStream, "faults\n");
+    for(i = 0; i < gFaultCount; i++)
+    {
+        fprintf(pStream, "  %10.3f s ", (double)gFaults[i].timeUs / 1e6);
+        printFaults(pStream, gFaults[i].faults);
+        fprintf(pStream, "\n");
+    }
+
+    // the timing lines are read back as a baseline
+    fprintf(pStream, "timing (host CPU time)\n");
+    fprintf(pStream, "  %-34s %10s %10s %10s\n", "function", "calls", "mean_ns", "max_ns");
+
+    for(function = 0; function < SIM_PROFILE_FUNCTIONS; function++)
+    {
+        sim_profile_get((simProfileFunction_t)function, &timing);
+
+        if(!timing.found)
+        {
+            fprintf(pStream, "  %-34s not found\n", timing.pName);
+            continue;
+        }
+
+        meanNs = (timing.calls != 0) ? (timing.totalNs / timing.calls) : 0;
+        fprintf(pStream, "  %-34s %10" PRIu64 " %10" PRIu64 " %10" PRIu64, timing.pName, timing.calls, meanNs,
+            timing.maxNs);
+
+        // compare the mean time with the baseline
+        if(compare && !getBaseline(timing.pName, &baseNs))
+        {
+            fprintf(pStream, "  base %" PRIu64, baseNs);
+
+            if(meanNs > baseNs + SIM_REPLAY_MIN_INCREASE_NS &&
+                (double)meanNs > (double)baseNs * (1.0 + (double)gSimConfig.regression / 100.0))
+            {
+                fprintf(pStream, "  REGRESSION +%.0f %%", ((double)meanNs / (double)baseNs - 1.0) * 100.0);
+                regressions++;
+            }
+        }
+        fprintf(pStream, "\n");
+    }
+
+    if(compare)
+    {
+        fprintf(pStream, "result\n  %d regressions (allowed %.0f %%)\n", regressions,
+            (double)gSimConfig.regression);
+    }
+
+    return regressions;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+int sim_replay_initialize(void)
+{
+    FILE             *pFile;
+    char              line[SIM_REPLAY_LINE_LENGTH];
+    simReplaySample_t sample;
+    double            timeS;
+    char             *pField;
+    int               fields, cell, lineNumber = 0;
+
+    pFile = fopen(gSimConfig.replayPath, "r");
+    if(pFile == NULL)
+    {
+        perror("sim: can't open the profile");
+        return -1;
+    }
+
+    gpSamples = calloc(SIM_REPLAY_MAX_SAMPLES, sizeof(simReplaySample_t));
+    if(gpSamples == NULL)
+    {
+        fclose(pFile);
+        return -1;
+    }
+
+    while(fgets(line, sizeof(line), pFile) != NULL)
+    {
+        lineNumber++;
+
+        // the state of charge of each cell replaces the one of -s
+        if(!strncmp(line, SIM_REPLAY_CELL_SOC ",", strlen(SIM_REPLAY_CELL_SOC ",")))
+        {
+            pField = line + strlen(SIM_REPLAY_CELL_SOC);
+            for(cell = 0; cell < SIM_MAX_CELLS && *pField == ','; cell++)
+            {
+                gSimConfig.cellSoc[cell] = strtof(pField + 1, &pField);
+            }
+            continue;
+        }
+
+        // skip the comments, the header and empty lines
+        if(!isdigit((unsigned char)line[0]) && line[0] != '.')
+        {
+            continue;
+        }
+
+        sample.temperature = NAN;
+        sample.charger     = NAN;
+        fields = sscanf(line, "%lf ,%f ,%f ,%f", &timeS, &sample.current, &sample.temperature, &sample.charger);
+        sample.timeUs = (uint64_t)(timeS * 1e6 + 0.5);
+
+        if(fields < 2 || (gSampleCount > 0 && sample.timeUs < gpSamples[gSampleCount - 1].timeUs))
+        {
+            fprintf(stderr, "sim: %s:%d is not a valid sample\n", gSimConfig.replayPath, lineNumber);
+            fclose(pFile);
+            return -1;
+        }
+
+        if(gSampleCount >= SIM_REPLAY_MAX_SAMPLES)
+        {
+            fprintf(stderr, "sim: %s has more than %d samples\n", gSimConfig.replayPath, SIM_REPLAY_MAX_SAMPLES);
+            fclose(pFile);
+            return -1;
+        }
+
+        gpSamples[gSampleCount++] = sample;
+    }
+
+    fclose(pFile);
+
+    if(gSampleCount == 0)
+    {
+        fprintf(stderr, "sim: %s has no samples\n", gSimConfig.replayPath);
+        return -1;
+    }
+
+    // the transitions of the start are traced as well
+    if(sim_profile_initialize(transitionCallback))
+    {
+        return -1;
+    }
+
+    // the pack starts with the first sample
+    gSimConfig.current = gpSamples[0].current;
+    if(!isnan(gpSamples[0].temperature))
+    {
+        gSimConfig.temperature = gpSamples[0].temperature;
+    }
+    if(!isnan(gpSamples[0].charger))
+    {
+        sim_pack_setChargerVoltage(gpSamples[0].charger);
+    }
+
+    return 0;
+}
+
+int sim_replay_run(void)
+{
+    calcBatteryVariables_t calc;
+    FILE                  *pReport;
+    uint64_t               startUs, nowUs, wallNs, waitedUs = 0;
+    double                 socErrorSum = 0.0;
+    float                  socError[3] = { 0.0f, 0.0f, 0.0f };
+    size_t                 next = 0, steps = 0;
+    int                    faults, lastFaults = 0, regressions, cell;
+
+    // wait until the BMS has done its self test
+    while(data_getMainState() != NORMAL)
+    {
+        if(waitedUs >= SIM_REPLAY_START_US)
+        {
+            fprintf(stderr, "sim: the BMS isn't in the normal state after %llu s, it is in %s\n",
+                SIM_REPLAY_START_US / 1000000, cli_getStateString(true, (uint8_t)data_getMainState(), NULL));
+            return SIM_REPLAY_EXIT_NO_START;
+        }
+
+        usleep(SIM_REPLAY_STEP_US);
+        waitedUs += SIM_REPLAY_STEP_US;
+    }
+
+    // only the replay itself is timed
+    sim_profile_reset();
+    wakeSched_resetStats();
+    for(cell = 0; cell < SIM_MAX_CELLS; cell++)
+    {
+        sim_pack_getCell(cell, &gCellStart[cell]);
+    }
+    wallNs  = sim_clock_getWallNs();
+    startUs = sim_getTimeUs();
+    __atomic_store_n(&gStartUs, startUs, __ATOMIC_RELEASE);
+
+    do
+    {
+        nowUs = sim_getTimeUs() - startUs;
+
+        // apply the samples that are due
+        while(next < gSampleCount && gpSamples[next].timeUs <= nowUs)
+        {
+            sim_pack_setCurrent(gpSamples[next].current);
+            if(!isnan(gpSamples[next].temperature))
+            {
+                sim_pack_setTemperature(gpSamples[next].temperature);
+            }
+            if(!isnan(gpSamples[next].charger))
+            {
+                sim_pack_setChargerVoltage(gpSamples[next].charger);
+            }
+            next++;
+        }
+
+        // the state of charge of the BMS compared with the one of the pack
+        if(!data_getCalcBatteryVariables(&calc, false))
+        {
+            socError[2] = (float)calc.s_charge - sim_pack_getSoc();
+            socError[0] = fmaxf(socError[0], fabsf(socError[2]));
+            socErrorSum += (double)socError[2] * (double)socError[2];
+            steps++;
+        }
+
+        // the fault decisions
+        faults = data_getBmsFault();
+        if(faults >= 0 && faults != lastFaults)
+        {
+            if(gFaultCount < SIM_REPLAY_MAX_EVENTS)
+            {
+                gFaults[gFaultCount].timeUs = nowUs;
+                gFaults[gFaultCount].faults = faults;
+                gFaultCount++;
+            }
+            lastFaults = faults;
+        }
+
+        usleep(SIM_REPLAY_STEP_US);
+    } while(next < gSampleCount);
+
+    wallNs      = sim_clock_getWallNs() - wallNs;
+    socError[1] = (steps != 0) ? (float)sqrt(socErrorSum / (double)steps) : 0.0f;
+
+    // the report is printed and written to the file
+    sim_lock();
+    regressions = printReport(stdout, nowUs, wallNs, socError, gSimConfig.baselinePath != NULL);
+
+    if(gSimConfig.reportPath != NULL)
+    {
+        pReport = fopen(gSimConfig.reportPath, "w");
+        if(pReport == NULL)
+        {
+            perror("sim: can't write the report");
+        }
+        else
+        {
+            printReport(pReport, nowUs, wallNs, socError, gSimConfig.baselinePath != NULL);
+            fclose(pReport);
+        }
+    }
+    sim_unlock();
+
+    return (regressions != 0) ? SIM_REPLAY_EXIT_REGRESSION : SIM_REPLAY_EXIT_OK;
+}
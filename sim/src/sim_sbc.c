@@ -0,0 +1,286 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/src/sim_sbc.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The UJA1169 system basis chip of the simulation.
+ * This is a register model of the 16 bit SPI frames of the chip with the
+ * registers src/sbc.c uses. The watchdog runs in normal mode once the
+ * application configured it, a write to the watchdog control register
+ * kicks it and an expired watchdog resets the MCU (the simulation).
+ * The sleep mode switches off V1 and with it the MCU, so it ends the
+ * simulation. The wake pin (the button) gives the wake pin events.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "gpio.h"
+#include "sim.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the registers of the UJA1169 the application uses
+#define SIM_SBC_WD_CTRL         0x00
+#define SIM_SBC_MODE_CTRL       0x01
+#define SIM_SBC_MAIN_STATUS     0x03
+#define SIM_SBC_WD_STATUS       0x05
+#define SIM_SBC_REG_CTRL        0x10
+#define SIM_SBC_CAN_CTRL        0x20
+#define SIM_SBC_WAKE_STATUS     0x4B
+#define SIM_SBC_WAKE_EN         0x4C
+#define SIM_SBC_GLOBAL_EVENT    0x60
+#define SIM_SBC_SYS_EVENT       0x61
+#define SIM_SBC_WAKE_EVENT      0x64
+#define SIM_SBC_MTPNV_STATUS    0x70
+#define SIM_SBC_START_UP_CTRL   0x73
+#define SIM_SBC_SBC_CONF_CTRL   0x74
+#define SIM_SBC_IDENTIFICATION  0x7E
+#define SIM_SBC_REGISTERS       0x80
+
+//! @brief the bits of the registers
+#define SIM_SBC_WD_CTRL_MASK    0xEF
+#define SIM_SBC_WMC_SHIFT       5
+#define SIM_SBC_NWP_MASK        0x0F
+#define SIM_SBC_MODE_MASK       0x07
+#define SIM_SBC_MODE_SLEEP      0x1
+#define SIM_SBC_MODE_STANDBY    0x4
+#define SIM_SBC_MODE_NORMAL     0x7
+#define SIM_SBC_SDMC            0x04
+#define SIM_SBC_SYS_EVENT_PO    0x10
+#define SIM_SBC_WAKE_WPF        0x01
+#define SIM_SBC_WAKE_WPR        0x02
+
+//! @brief the identification of the UJA1169TK/F/3
+#define SIM_SBC_ID              0xE9
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+//! the registers
+static uint8_t gRegs[SIM_SBC_REGISTERS];
+
+//! true if the application configured the watchdog
+static bool gWatchdogArmed = false;
+
+//! the time of the last watchdog kick in us
+static uint64_t gLastKickUs = 0;
+
+//! the last level of the wake pin
+static bool gLastWakePin = true;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get the nominal watchdog period
+ *
+ * @param   nwp the NWP bits of the watchdog control register
+ *
+ * @return  the period in us
+ */
+static uint64_t getWatchdogPeriodUs(uint8_t nwp)
+{
+    switch(nwp)
+    {
+        case 0x8: return 8000;
+        case 0x1: return 16000;
+        case 0x2: return 32000;
+        case 0xB: return 64000;
+        case 0x4: return 128000;
+        case 0xD: return 256000;
+        case 0xE: return 1024000;
+        default:  return 4096000;
+    }
+}
+
+/*!
+ * @brief   function to check if the watchdog runs
+ *
+ * @return  true if it runs
+ */
+static bool watchdogRuns(void)
+{
+    return gWatchdogArmed && ((gRegs[SIM_SBC_MODE_CTRL] & SIM_SBC_MODE_MASK) == SIM_SBC_MODE_NORMAL) &&
+        ((gRegs[SIM_SBC_WD_CTRL] >> SIM_SBC_WMC_SHIFT) != 0);
+}
+
+/*!
+ * @brief   function to read a register
+ *
+ * @param   addr the register address
+ *
+ * @return  the value
+ */
+static uint8_t readRegister(uint8_t addr)
+{
+    uint64_t elapsedUs;
+    uint8_t  value = gRegs[addr];
+
+    switch(addr)
+    {
+        case SIM_SBC_WD_STATUS:
+            // SDMS and the half of the period the watchdog is in
+            value = (gRegs[SIM_SBC_SBC_CONF_CTRL] & SIM_SBC_SDMC);
+            if(watchdogRuns())
+            {
+                elapsedUs = sim_getTimeUs() - gLastKickUs;
+                value |= (elapsedUs < getWatchdogPeriodUs(gRegs[SIM_SBC_WD_CTRL] & SIM_SBC_NWP_MASK) / 2) ? 1 : 2;
+            }
+            return value;
+        case SIM_SBC_WAKE_STATUS:
+            // WPVS, the wake pin is high if the button isn't pushed
+            return sim_gpio_get(SBC_WAKE) ? 0x02 : 0x00;
+        case SIM_SBC_GLOBAL_EVENT:
+            // the summary of the event registers
+            return (gRegs[SIM_SBC_SYS_EVENT] ? 0x01 : 0) | (gRegs[SIM_SBC_SYS_EVENT + 1] ? 0x02 : 0) |
+                (gRegs[SIM_SBC_SYS_EVENT + 2] ? 0x04 : 0) | (gRegs[SIM_SBC_WAKE_EVENT] ? 0x08 : 0);
+        default:
+            return value;
+    }
+}
+
+/*!
+ * @brief   function to write a register
+ *
+ * @param   addr the register address
+ * @param   value the value
+ */
+static void writeRegister(uint8_t addr, uint8_t value)
+{
+    switch(addr)
+    {
+        case SIM_SBC_WD_CTRL:
+            // a write is a kick of the watchdog
+            gRegs[addr]    = value & SIM_SBC_WD_CTRL_MASK;
+            gWatchdogArmed = true;
+            gLastKickUs    = sim_getTimeUs();
+            break;
+        case SIM_SBC_MODE_CTRL:
+            gRegs[addr] = value & SIM_SBC_MODE_MASK;
+            gLastKickUs = sim_getTimeUs();
+            break;
+        case SIM_SBC_SYS_EVENT:
+        case SIM_SBC_SYS_EVENT + 1:
+        case SIM_SBC_SYS_EVENT + 2:
+        case SIM_SBC_WAKE_EVENT:
+            // the events are cleared by writing a 1
+            gRegs[addr] &= ~value;
+            break;
+        case SIM_SBC_MAIN_STATUS:
+        case SIM_SBC_WD_STATUS:
+        case SIM_SBC_WAKE_STATUS:
+        case SIM_SBC_GLOBAL_EVENT:
+        case SIM_SBC_MTPNV_STATUS:
+        case SIM_SBC_IDENTIFICATION:
+            // read only
+            break;
+        default:
+            gRegs[addr] = value;
+            break;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+void sim_sbc_initialize(void)
+{
+    memset(gRegs, 0, sizeof(gRegs));
+
+    // the state after power on, the non-volatile registers are programmed like the application wants them
+    gRegs[SIM_SBC_WD_CTRL]        = (0x1 << SIM_SBC_WMC_SHIFT) | 0x4;
+    gRegs[SIM_SBC_MODE_CTRL]      = SIM_SBC_MODE_NORMAL;
+    gRegs[SIM_SBC_SYS_EVENT]      = SIM_SBC_SYS_EVENT_PO;
+    gRegs[SIM_SBC_MTPNV_STATUS]   = 0x01;
+    gRegs[SIM_SBC_START_UP_CTRL]  = 0x00;
+    gRegs[SIM_SBC_SBC_CONF_CTRL]  = SIM_SBC_SDMC;
+    gRegs[SIM_SBC_IDENTIFICATION] = SIM_SBC_ID;
+
+    gWatchdogArmed = false;
+}
+
+void sim_sbc_transfer(const uint8_t *pTx, uint8_t *pRx)
+{
+    uint8_t addr = (pTx[0] >> 1) & (SIM_SBC_REGISTERS - 1);
+
+    // the first byte is the address with the read bit, the second the data
+    pRx[0] = 0;
+    if(pTx[0] & 1)
+    {
+        pRx[1] = readRegister(addr);
+    }
+    else
+    {
+        pRx[1] = gRegs[addr];
+        writeRegister(addr, pTx[1]);
+    }
+}
+
+void sim_sbc_tick(uint64_t nowUs)
+{
+    bool wakePin = sim_gpio_get(SBC_WAKE);
+
+    // the wake pin events of the enabled edges
+    if(wakePin != gLastWakePin)
+    {
+        if(!wakePin && (gRegs[SIM_SBC_WAKE_EN] & SIM_SBC_WAKE_WPF))
+        {
+            gRegs[SIM_SBC_WAKE_EVENT] |= SIM_SBC_WAKE_WPF;
+        }
+        if(wakePin && (gRegs[SIM_SBC_WAKE_EN] & SIM_SBC_WAKE_WPR))
+        {
+            gRegs[SIM_SBC_WAKE_EVENT] |= SIM_SBC_WAKE_WPR;
+        }
+        gLastWakePin = wakePin;
+    }
+
+    // the sleep mode turns off V1, which supplies the MCU
+    if((gRegs[SIM_SBC_MODE_CTRL] & SIM_SBC_MODE_MASK) == SIM_SBC_MODE_SLEEP)
+    {
+        sim_os_powerOff("the SBC went to sleep mode");
+    }
+
+    // an expired watchdog resets the MCU with the reset pin
+    if(gSimConfig.watchdog && watchdogRuns() &&
+        (nowUs - gLastKickUs) > getWatchdogPeriodUs(gRegs[SIM_SBC_WD_CTRL] & SIM_SBC_NWP_MASK))
+    {
+        sim_os_reset(SIM_RESET_CAUSE_PIN, "the SBC watchdog expired");
+    }
+}
@@ -0,0 +1,352 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/sim/tools/bms_stream.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * The decoder of the binary telemetry stream of "bms stream <fields>".
+ * It reads the console output of the BMS (a file or stdin), finds the
+ * frames between the text, checks their CRC and writes them as CSV: a
+ * line per frame with the fields of the measurement cycle and a line per
+ * current sample (type "sample"). Fields that aren't in a frame are empty.
+ * At the end the amount of frames, the CRC errors, the lost frames (a gap
+ * in the sequence numbers) and the rate of the current samples are written
+ * to stderr. The format is described in cli.h.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "cli.h"
+#include "measStats.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief the maximum length of a frame body, longer ones are skipped
+#define STREAM_MAX_BODY 256
+
+//! @brief the length of the header and the CRC of a frame body
+#define STREAM_HEADER   8
+#define STREAM_CRC      2
+
+//! @brief the amount of columns of the CSV
+#define STREAM_COLUMNS  31
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the counters of the decoded stream */
+typedef struct
+{
+    uint32_t frames;    //!< the frames with a valid CRC
+    uint32_t crcErrors; //!< the frames with a wrong CRC or length
+    uint32_t lost;      //!< the frames that are missing in the sequence numbers
+    uint32_t samples;   //!< the current samples
+    double   firstS;    //!< the time of the first current sample
+    double   lastS;     //!< the time of the last current sample
+} streamCounters_t;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to get a little endian value of a body
+ *
+ * @param   pBody the body
+ * @param   pIndex address of the index in the body, it is increased with the size
+ * @param   size the amount of bytes
+ *
+ * @return  the value
+ */
+static uint32_t streamGet(const uint8_t *pBody, int *pIndex, int size)
+{
+    uint32_t value = 0;
+    int      i;
+
+    for(i = 0; i < size; i++)
+    {
+        value |= (uint32_t)pBody[(*pIndex)++] << (8 * i);
+    }
+
+    return value;
+}
+
+/*!
+ * @brief   function to calculate the CRC-16/CCITT-FALSE, the same as the BMS
+ *
+ * @param   pBody the body
+ * @param   length the length of the body without the CRC
+ *
+ * @return  the CRC
+ */
+static uint16_t streamCrc(const uint8_t *pBody, int length)
+{
+    uint16_t crc = 0xFFFF;
+    int      i, j;
+
+    for(i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)pBody[i] << 8;
+
+        for(j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/*!
+ * @brief   function to check a frame body and write it as CSV
+ *
+ * @param   pBody the unescaped body with the CRC
+ * @param   length the length of the body
+ * @param   pCounters the counters of the stream
+ */
+static void decodeFrame(const uint8_t *pBody, int length, streamCounters_t *pCounters)
+{
+    static int lastSequence = -1;
+    int        index = 0, i, n, window, sequence;
+    uint16_t   fields;
+    double     timeS, sampleS;
+
+    // check the length, the CRC and the version
+    if(length < STREAM_HEADER + STREAM_CRC ||
+        streamCrc(pBody, length - STREAM_CRC) != (pBody[length - 2] | (pBody[length - 1] << 8)) ||
+        pBody[0] != CLI_STREAM_VERSION)
+    {
+        pCounters->crcErrors++;
+        return;
+    }
+    length -= STREAM_CRC;
+
+    // the header
+    index++;
+    sequence = (int)streamGet(pBody, &index, 1);
+    fields   = (uint16_t)streamGet(pBody, &index, 2);
+    timeS    = streamGet(pBody, &index, 4) / 1e3;
+
+    if(lastSequence >= 0)
+    {
+        pCounters->lost += (uint8_t)(sequence - lastSequence - 1);
+    }
+    lastSequence = sequence;
+    pCounters->frames++;
+
+    // the current samples have a line each
+    if(fields & CLI_STREAM_CURRENT_SAMPLES)
+    {
+        n = (int)streamGet(pBody, &index, 1);
+        for(i = 0; i < n && index + 6 <= length; i++)
+        {
+            sampleS = timeS + streamGet(pBody, &index, 2) * 10e-6;
+            printf("sample,%d,%.5f,%.3f%.*s\n", sequence, sampleS, (int32_t)streamGet(pBody, &index, 4) / 1e3,
+                STREAM_COLUMNS - 4, ",,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,");
+
+            if(!pCounters->samples)
+            {
+                pCounters->firstS = sampleS;
+            }
+            pCounters->lastS = sampleS;
+            pCounters->samples++;
+        }
+        return;
+    }
+
+    // the fields of the measurement cycle, in bit order
+    printf("meas,%d,%.3f,", sequence, timeS);
+    if(fields & CLI_STREAM_I_BATT)
+    {
+        printf("%.3f", (int32_t)streamGet(pBody, &index, 4) / 1e3);
+    }
+    printf(",");
+
+    n = (fields & CLI_STREAM_CELLS) ? (int)streamGet(pBody, &index, 1) : 0;
+    if(fields & CLI_STREAM_CELLS)
+    {
+        printf("%d", n);
+    }
+    for(i = 0; i < 6; i++)
+    {
+        if(i < n)
+        {
+            printf(",%.3f", streamGet(pBody, &index, 2) / 1e3);
+        }
+        else
+        {
+            printf(",");
+        }
+    }
+
+    for(i = 0; i < 4; i++)
+    {
+        if(fields & CLI_STREAM_TEMPERATURE)
+        {
+            printf(",%.1f", (int16_t)streamGet(pBody, &index, 2) / 10.0);
+        }
+        else
+        {
+            printf(",");
+        }
+    }
+
+    if(fields & CLI_STREAM_SOC)
+    {
+        printf(",%u", streamGet(pBody, &index, 1));
+    }
+    else
+    {
+        printf(",");
+    }
+
+    if(fields & CLI_STREAM_STATE)
+    {
+        printf(",%u", streamGet(pBody, &index, 1));
+        printf(",%u", streamGet(pBody, &index, 1));
+    }
+    else
+    {
+        printf(",,");
+    }
+
+    if(fields & CLI_STREAM_FAULTS)
+    {
+        printf(",0x%02x", streamGet(pBody, &index, 1));
+    }
+    else
+    {
+        printf(",");
+    }
+
+    // the mean, min, max and RMS current of each window
+    for(window = 0; window < MEAS_STATS_WINDOWS; window++)
+    {
+        for(i = 0; i < 4; i++)
+        {
+            if(fields & CLI_STREAM_CURRENT_STATS)
+            {
+                printf(",%.3f", ((i < 3) ? (double)(int32_t)streamGet(pBody, &index, 4) :
+                    (double)streamGet(pBody, &index, 4)) / 1e3);
+            }
+            else
+            {
+                printf(",");
+            }
+        }
+    }
+    printf("\n");
+
+    // a body that is shorter than its fields is a wrong frame
+    if(index > length)
+    {
+        pCounters->crcErrors++;
+    }
+}
+
+/****************************************************************************
+ * Main
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+    FILE            *pFile = stdin;
+    uint8_t          body[STREAM_MAX_BODY];
+    streamCounters_t counters = { 0 };
+    bool             inFrame = false, escaped = false;
+    int              length = 0, c;
+
+    if(argc > 2 || (argc == 2 && (pFile = fopen(argv[1], "rb")) == NULL))
+    {
+        fprintf(stderr, "usage: bms_stream [console output file] > stream.csv\n");
+        return 1;
+    }
+
+    printf("type,sequence,time_s,i_batt_a,n_cells,cell1_v,cell2_v,cell3_v,cell4_v,cell5_v,cell6_v,"
+           "c_batt,c_afe,c_t,c_r,soc,main_state,charge_state,faults,"
+           "i_1s_mean,i_1s_min,i_1s_max,i_1s_rms,i_10s_mean,i_10s_min,i_10s_max,i_10s_rms,"
+           "i_60s_mean,i_60s_min,i_60s_max,i_60s_rms\n");
+
+    while((c = fgetc(pFile)) != EOF)
+    {
+        if(c == CLI_STREAM_FLAG)
+        {
+            // the end of a frame, the flag starts the next one as well
+            if(inFrame && length > 0)
+            {
+                decodeFrame(body, length, &counters);
+            }
+            inFrame = true;
+            escaped = false;
+            length  = 0;
+        }
+        else if(!inFrame)
+        {
+            // text of the console
+        }
+        else if(c == '\n' || c == '\r' || length >= STREAM_MAX_BODY)
+        {
+            // these are escaped in a frame, so it was text with a flag character in it
+            inFrame = false;
+        }
+        else if(c == CLI_STREAM_ESCAPE)
+        {
+            escaped = true;
+        }
+        else
+        {
+            body[length++] = (uint8_t)(escaped ? (c ^ CLI_STREAM_ESCAPE_XOR) : c);
+            escaped        = false;
+        }
+    }
+
+    fprintf(stderr, "%u frames, %u CRC errors, %u lost, %u current samples", counters.frames,
+        counters.crcErrors, counters.lost, counters.samples);
+    if(counters.samples > 1 && counters.lastS > counters.firstS)
+    {
+        fprintf(stderr, " in %.3f s (%.1f Hz)", counters.lastS - counters.firstS,
+            (counters.samples - 1) / (counters.lastS - counters.firstS));
+    }
+    fprintf(stderr, "\n");
+
+    if(pFile != stdin)
+    {
+        fclose(pFile);
+    }
+
+    return 0;
+}
@@ -60,6 +60,7 @@
 #include "gpio.h"
 #include "cli.h"
 #include "spi.h"
+#include "timeBase.h"
 #include <errno.h>
 #include <assert.h>
 
@@ -112,6 +113,62 @@
  */
 #define NTC_COMP_TEMP(tblIdx, degTenths) ((((tblIdx) + NTC_MINTEMP) * 10) + (degTenths))
 
+/*! @brief the NTC table is generated with NTC_ROWS_160, change this when the NTC range is changed. */
+#if NTC_TABLE_SIZE != 161
+#error "NTC_MINTEMP or NTC_MAXTEMP changed, change the generation of g_ntcTable and g_ntcSlopeTable"
+#endif
+
+/*! @brief the amount of SoC points of the OCV temperature offset grid, every OCV_GRID_SOC_STEP from 0% */
+#define OCV_GRID_SOC_POINTS         11
+
+/*! @brief the SoC step of the OCV temperature offset grid in 0.01% */
+#define OCV_GRID_SOC_STEP           1000
+
+/*! @brief the amount of temperature points of the OCV temperature offset grid */
+#define OCV_GRID_TEMP_POINTS        4
+
+/*! @brief the amount of fractional bits of the g_ntcSlopeTable items */
+#define NTC_SLOPE_SHIFT             16
+
+/*!
+ * @brief Calculates the NTC resistance [Ohm] at a temperature [degC] with the Beta formula.
+ * @note  __builtin_exp() is used, since it is evaluated by the compiler, also with -fno-builtin.
+ *
+ * @param temp the temperature in degC.
+ */
+#define NTC_RESISTANCE(temp) \
+    (__builtin_exp(NTC_BETA * ((1.0 / (NTC_DEGC_0 + (temp))) - (1.0 / (NTC_DEGC_0 + NTC_REF_TEMP)))) * NTC_REF_RES)
+
+/*!
+ * @brief Calculates the register value of an item of g_ntcTable.
+ *
+ * @param tblIdx Index of the item, the temperature is (tblIdx + NTC_MINTEMP) degC.
+ */
+#define NTC_TABLE_ITEM(tblIdx) \
+    ((uint16_t)((((NTC_VCOM * NTC_RESISTANCE((tblIdx) + NTC_MINTEMP)) / \
+        (NTC_RESISTANCE((tblIdx) + NTC_MINTEMP) + NTC_PULL_UP)) / NTC_REGISTER_RES) + 0.5))
+
+/*!
+ * @brief Calculates the rounded 0.1 degC per LSB slope between item tblIdx and tblIdx + 1 of g_ntcTable.
+ *
+ * @param tblIdx Index of the item.
+ */
+#define NTC_SLOPE_ITEM(tblIdx) \
+    ((uint32_t)(((10UL << NTC_SLOPE_SHIFT) + ((NTC_TABLE_ITEM(tblIdx) - NTC_TABLE_ITEM((tblIdx) + 1)) / 2)) / \
+        (NTC_TABLE_ITEM(tblIdx) - NTC_TABLE_ITEM((tblIdx) + 1))))
+
+/*! @brief Generates 10 table items starting at tblIdx with the item macro. */
+#define NTC_ROWS_10(item, tblIdx) item((tblIdx) + 0), item((tblIdx) + 1), item((tblIdx) + 2), \
+    item((tblIdx) + 3), item((tblIdx) + 4), item((tblIdx) + 5), item((tblIdx) + 6), item((tblIdx) + 7), \
+    item((tblIdx) + 8), item((tblIdx) + 9),
+
+/*! @brief Generates the first 160 table items with the item macro. */
+#define NTC_ROWS_160(item) NTC_ROWS_10(item, 0) NTC_ROWS_10(item, 10) NTC_ROWS_10(item, 20) \
+    NTC_ROWS_10(item, 30) NTC_ROWS_10(item, 40) NTC_ROWS_10(item, 50) NTC_ROWS_10(item, 60) \
+    NTC_ROWS_10(item, 70) NTC_ROWS_10(item, 80) NTC_ROWS_10(item, 90) NTC_ROWS_10(item, 100) \
+    NTC_ROWS_10(item, 110) NTC_ROWS_10(item, 120) NTC_ROWS_10(item, 130) NTC_ROWS_10(item, 140) \
+    NTC_ROWS_10(item, 150)
+
 /*******************************************************************************
  * Global variables (constants)
  ******************************************************************************/
@@ -409,12 +466,88 @@ static const uint8_t cellmvVsSOCLookupTableAllSize[] = { sizeof(cellmvVsSOCLiPoL
     sizeof(cellmvVsSOCLiPoNMCLookupTable) /sizeof(mvSoC_t),
     sizeof(cellmvVsSOCNaIonLookupTable) / sizeof(mvSoC_t)};
 
-/**
- * NTC look up table intended for resistance to temperature conversion. After
- * table initialization, array item contains raw value from a register.
- * Index of the item is temperature value.
+/*!
+ *  @brief the temperatures of the columns of the OCV temperature offset grids in 0.1 degC
  */
-static uint16_t g_ntcTable[NTC_TABLE_SIZE];
+static const int16_t cellOcvGridTemperatures[OCV_GRID_TEMP_POINTS] = {-200, 0, 250, 450};
+
+/*!
+ *  @brief this is the OCV temperature offset grid for a LiPo battery
+ *         Together with the OCV/SoC table (at 25 degC) this makes the OCV(SoC, temperature) surface.
+ *         Each row is the offset in mV of the OCV to the 25 degC OCV for a SoC of row * 10%,
+ *         at the temperatures of cellOcvGridTemperatures. It is bilinearly interpolated.
+ *  @note The cells are not characterized over temperature yet, so all offsets are 0 and the
+ *        25 degC curve is used. Fill in this grid from a characterization of the used LiPo battery
+ *        (the OCV at each SoC row and temperature column minus the 25 degC OCV).
+ */
+static const int8_t cellOcvTempOffsetLiPoGrid[OCV_GRID_SOC_POINTS][OCV_GRID_TEMP_POINTS] = {{0}};
+
+/*!
+ *  @brief this is the OCV temperature offset grid for a LiFePO4 battery
+ *  @note The cells are not characterized over temperature yet, so all offsets are 0 and the
+ *        25 degC curve is used. Fill in this grid from a characterization of the used LiFePO4 battery
+ *        (the OCV at each SoC row and temperature column minus the 25 degC OCV).
+ */
+static const int8_t cellOcvTempOffsetLiFePO4Grid[OCV_GRID_SOC_POINTS][OCV_GRID_TEMP_POINTS] = {{0}};
+
+/*!
+ *  @brief this is the OCV temperature offset grid for a NMC LiPo (LiNiMnCoO2) battery
+ *  @note The cells are not characterized over temperature yet, so all offsets are 0 and the
+ *        25 degC curve is used. Fill in this grid from a characterization of the used NMC LiPo battery
+ *        (the OCV at each SoC row and temperature column minus the 25 degC OCV).
+ */
+static const int8_t cellOcvTempOffsetLiPoNMCGrid[OCV_GRID_SOC_POINTS][OCV_GRID_TEMP_POINTS] = {{0}};
+
+/*!
+ *  @brief this is the OCV temperature offset grid for a sodium-ion (Na-Ion) battery
+ *  @note There are no temperature measurements of the Na-ion cell yet, so the 25 degC curve is used.
+ *        Change this grid to the specification of the used sodium-ion (Na-ion) battery
+ */
+static const int8_t cellOcvTempOffsetNaIonGrid[OCV_GRID_SOC_POINTS][OCV_GRID_TEMP_POINTS] = {{0}};
+
+/*!
+ *  @brief this array contains the pointers to the OCV temperature offset grids
+ *  @note use with BATTERY_TYPE variable, LiFeYPO4 uses the LiFePO4 grid
+ *  @example cellOcvTempOffsetGridAll[batteryType][socIndex][tempIndex]
+ */
+static const int8_t (*cellOcvTempOffsetGridAll[])[OCV_GRID_TEMP_POINTS] = { cellOcvTempOffsetLiPoGrid,
+    cellOcvTempOffsetLiFePO4Grid, cellOcvTempOffsetLiFePO4Grid, cellOcvTempOffsetLiPoNMCGrid,
+    cellOcvTempOffsetNaIonGrid};
+
+/*!
+ * @brief NTC look up table intended for resistance to temperature conversion.
+ *        An array item contains raw value from a register. Index of the item is
+ *        temperature value (minus NTC_MINTEMP).
+ *        The table is calculated by the compiler from the NTC defines in bcc_configuration.h,
+ *        so it is placed in flash and doesn't need to be calculated at startup.
+ *
+ * ArrayItem = (Vcom * NTC) / (0.00015258789 * (NTC + Rntc))
+ * Where:
+ *  - ArrayItem is an item value of the table,
+ *  - Vcom is maximal voltage (5V),
+ *  - NTC is the resistance of NTC thermistor (Ohm),
+ *  - 0.00015258789 is resolution of measured voltage in Volts
+ *    (V = 152.58789 uV * Register_value),
+ *  - Rntc is value of a resistor connected to Vcom (see MC3377x datasheet,
+ *    section MC3377x PCB components).
+ *
+ * Beta formula used to calculate temperature based on NTC resistance:
+ *   1 / T = 1 / T0 + (1 / Beta) * ln(Rt / R0)
+ * Where:
+ *  - R0 is the resistance (Ohm) at temperature T0 (Kelvin),
+ *  - Beta is material constant (Kelvin),
+ *  - T is temperature corresponding to resistance of the NTC thermistor.
+ *
+ * Equation for NTC value is given from the Beta formula:
+ *   NTC = R0 * exp(Beta * (1/T - 1/T0))
+ */
+static const uint16_t g_ntcTable[NTC_TABLE_SIZE] = { NTC_ROWS_160(NTC_TABLE_ITEM) NTC_TABLE_ITEM(160) };
+
+/*!
+ * @brief NTC slope table with the amount of 0.1 degC per register LSB between item i and i + 1
+ *        of g_ntcTable as fixed point value (NTC_SLOPE_SHIFT fractional bits).
+ */
+static const uint32_t g_ntcSlopeTable[NTC_TABLE_SIZE - 1] = { NTC_ROWS_160(NTC_SLOPE_ITEM) };
 
 static uint8_t gMeasurementCounter         = 1;
 static uint8_t gMeasurementCounterEndValue = 100;
@@ -456,16 +589,64 @@ static int calculateSoCAndSoH(calcBatteryVariables_t* calcBatteryVariables);
 
 /*
  * @brief   This function can be used to get the state of charge (SoC) from the open cell voltage
- * @note    A predefined table and the lowest cell voltage will be used for this
+ * @note    The OCV(SoC, temperature) surface and the lowest cell voltage will be used for this
  * @warning The battery (voltage) needs to be relaxed before this is used!
  *
  * @param   batteryType The battery-type (BATTERY_TYPE)
- * @param   CurrentCheck if true the current check will be done,
- *          Keep this default on true, except for a power-up check
+ * @param   lowestCellmV the lowest cell voltage in mV
+ * @param   temperature the cell temperature in 0.1 degC
  *
- * @return  0 if succesfull, otherwise it will indicate the error
+ * @return  the state of charge in % (1 - 100)
+ */
+static uint8_t getSoCBasedOnOCV(uint8_t batteryType, uint16_t lowestCellmV, int16_t temperature);
+
+/*
+ * @brief   This function calculates the offset of the OCV to the 25 degC OCV with bilinear interpolation
+ *          of the OCV temperature offset grid
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   SoC the state of charge in 0.01%
+ * @param   temperature the cell temperature in 0.1 degC
+ *
+ * @return  the offset in uV
+ */
+static int32_t getOcvTempOffset(uint8_t batteryType, int32_t SoC, int16_t temperature);
+
+/*
+ * @brief   This function calculates the OCV of a row of the OCV/SoC table at a temperature
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   temperature the cell temperature in 0.1 degC
+ * @param   row the row of the OCV/SoC table
+ *
+ * @return  the OCV in uV
+ */
+static int32_t getOcvRowuV(uint8_t batteryType, int16_t temperature, int row);
+
+/*
+ * @brief   This function calculates the state of charge from the open cell voltage and the temperature
+ *          with the OCV(SoC, temperature) surface
+ * @warning The battery (voltage) needs to be relaxed before this is used!
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   cellmV the (lowest) cell voltage in mV
+ * @param   temperature the cell temperature in 0.1 degC
+ *
+ * @return  the state of charge in 0.01% (0 - 10000)
+ */
+static int32_t getSoCCentiBasedOnOCV(uint8_t batteryType, uint16_t cellmV, int16_t temperature);
+
+/*
+ * @brief   This function converts the ISENSE registers to the battery current
+ *          The system current is substracted while charging, since it is measured as well
+ *
+ * @param   rShunt the value of the shunt resistor in uOhm
+ * @param   isense1 the value of the MEAS_ISENSE1 register
+ * @param   isense2 the value of the MEAS_ISENSE2 register
+ *
+ * @return  the battery current in A
  */
-static uint8_t getSoCBasedOnOCV(uint8_t batteryType, uint16_t lowestCellmV);
+static float getIsenseCurrent(uint32_t rShunt, uint16_t isense1, uint16_t isense2);
 
 /*******************************************************************************
  * API
@@ -504,36 +685,6 @@ int bcc_monitoring_initialize(void)
     return retVal;
 }
 
-/*FUNCTION**********************************************************************
- *
- * Function Name : BCC_FillNtcTable
- * Description   : This function fills the NTC look up table.
- *
- *END**************************************************************************/
-void bcc_monitoring_fillNtcTable(const ntc_config_t* const ntcConfig)
-{
-    double   ntcVal, expArg;
-    uint16_t i = 0;
-    int32_t  temp;
-
-    for(temp = NTC_MINTEMP; temp <= NTC_MAXTEMP; temp++)
-    {
-        // calculate the new exponent arguement (beta*(1/temp(k) - 1/tempRef(k)))
-        expArg = ntcConfig->beta * ((1.0 / (NTC_DEGC_0 + temp)) - (1.0 / (NTC_DEGC_0 + ntcConfig->refTemp)));
-
-        // calculate the NTC value e^expArg * Rref voltage is ((NTC_VCOM * ntcVal) / (ntcVal +
-        // ntcConfig->rntc))
-        ntcVal = exp(expArg) * ntcConfig->refRes;
-
-        // calculate the registervalue for each temperature
-        g_ntcTable[i] =
-            (uint16_t)round(((NTC_VCOM * ntcVal) / (ntcVal + ntcConfig->rntc)) / NTC_REGISTER_RES);
-
-        // increase the index
-        i++;
-    }
-}
-
 /*
  * @brief   This function reads values measured and provided via SPI
  *          by BCC device (ISENSE, cell voltages, temperatures). \n
@@ -558,17 +709,11 @@ bcc_status_t bcc_monitoring_updateMeasurements(bcc_drv_config_t* const drvConfig
     variableTypes_u variable1;
     int             i = 0;
     float           lowestCellVoltage;
-    charge_states_t chargeState = data_getChargeState();
 
 #ifdef DEBUG_TIMING
-    struct timespec firstTime, currentTime;
-
-    if(clock_gettime(CLOCK_REALTIME, &firstTime) == -1)
-    {
-        cli_printfError("bcc_monitoring ERROR: failed to get newSampletime time!\n");
-    }
+    uint64_t firstUs = timeBase_getUs();
 
-    // cli_printf("time: %ds %dus\n", firstTime.tv_sec, firstTime.tv_nsec/1000);
+    // cli_printf("time: %dus\n", (int)firstUs);
 #endif
 
     // check for NULL pointer, but only in debug mode
@@ -616,36 +761,9 @@ bcc_status_t bcc_monitoring_updateMeasurements(bcc_drv_config_t* const drvConfig
         return error;
     }
 
-    /* Mask bits. */
-    /* Nothing to mask in CC_NB_SAMPLES, COULOMB_CNT1 and COULOMB_CNT2 registers. */
-    measurements[BCC_MSR_ISENSE1] &= BCC_R_MEAS1_I_MASK;
-    measurements[BCC_MSR_ISENSE2] &= BCC_R_MEAS2_I_MASK;
-
-    // convert the battery current to a float in mA
-    // Measured ISENSE in [mA]. Value of shunt resistor is used.
+    // convert the battery current to a float in A
     pCommonBatteryVariables->I_batt =
-        BCC_GET_ISENSE_AMP(rShunt, measurements[BCC_MSR_ISENSE1], measurements[BCC_MSR_ISENSE2]);
-
-    // Get the system current
-    if(data_getParameter(I_SYSTEM, &(variable1.uint8Var), NULL) == NULL)
-    {
-        cli_printfError("bcc_monitoring ERROR: Couldn't get i-system\n");
-    }
-
-    // Check if substracting own board current during charging is needed
-    // Check if the current is positive (charging) (including board current)
-    if(((int)pCommonBatteryVariables->I_batt) >= (variable1.uint8Var))
-    {
-        // Get the state and check if it is in the charging state (CHARGE_START or CHARGE_CB)
-        if(data_getMainState() == CHARGE && (chargeState == CHARGE_START || chargeState == CHARGE_CB))
-        {
-            // Substract the system current because that is measured as well
-            pCommonBatteryVariables->I_batt = pCommonBatteryVariables->I_batt - (float)(variable1.uint8Var);
-        }
-    }
-
-    // convert to A
-    pCommonBatteryVariables->I_batt = pCommonBatteryVariables->I_batt / MA_TO_A;
+        getIsenseCurrent(rShunt, measurements[BCC_MSR_ISENSE1], measurements[BCC_MSR_ISENSE2]);
 
 
 #ifdef OUTPUT_CURRENT_MEAS_DOT
@@ -981,9 +1099,10 @@ int bcc_monitoring_calculateVariables(bcc_drv_config_t* const drvConfig, pthread
         // get the battery type
         variable1.uint8Var = *(uint8_t*)data_getAdr(BATTERY_TYPE);
 
-        // get the state of charge based on the lowest cell voltage
+        // get the state of charge based on the lowest cell voltage and the battery temperature
         calcBatteryVariable.s_charge =
-            getSoCBasedOnOCV(variable1.uint8Var, (uint16_t)(lowestCellVoltage * 1000));
+            getSoCBasedOnOCV(variable1.uint8Var, (uint16_t)(lowestCellVoltage * 1000),
+                (int16_t)(pCommonBatteryVariables->C_batt * 10));
 
         // calculate the new remaining capacity
         calcBatteryVariable.A_rem = (calcBatteryVariable.A_full / 100) * calcBatteryVariable.s_charge;
@@ -1127,15 +1246,8 @@ int bcc_monitoring_calculateVariables(bcc_drv_config_t* const drvConfig, pthread
 
 #ifdef DEBUG_TIMING
 
-            // get the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("bcc_monitoring ERROR: failed to get newSampletime time!\n");
-            }
-
             // calculate the difference in time
-            variable2.int32Var = (currentTime.tv_sec * 1000000 + currentTime.tv_nsec / 1000) -
-                (firstTime.tv_sec * 1000000 + firstTime.tv_nsec / 1000);
+            variable2.int32Var = (int32_t)timeBase_getElapsedUs(firstUs);
 
             cli_printf("dtime: %dus\n", variable2.int32Var);
 #endif
@@ -1612,10 +1724,9 @@ bcc_status_t bcc_monitoring_getCellVoltages(bcc_drv_config_t* const drvConfig)
 bcc_status_t bcc_monitoring_getBattCurrent(
     bcc_drv_config_t* const drvConfig, uint32_t rShunt, float* currentA)
 {
-    bcc_status_t    lvRetValue = BCC_STATUS_PARAM_RANGE;
-    uint16_t        regVal[2];
-    float           current;
-    charge_states_t chargeState = data_getChargeState();
+    bcc_status_t lvRetValue = BCC_STATUS_PARAM_RANGE;
+    uint16_t     regVal[2];
+    float        current;
 
     // get the current measument
     lvRetValue = bcc_spiwrapper_BCC_Reg_Read(drvConfig, BCC_CID_DEV1, BCC_REG_MEAS_ISENSE1_ADDR, 2, regVal);
@@ -1627,38 +1738,8 @@ bcc_status_t bcc_monitoring_getBattCurrent(
         return lvRetValue;
     }
 
-    /* Mask bits. */
-    regVal[0] &= BCC_R_MEAS1_I_MASK;
-    regVal[1] &= BCC_R_MEAS2_I_MASK;
-
-    // convert the battery current to a float in mA
-    // Measured ISENSE in [mA]. Value of shunt resistor is used.
-    current = BCC_GET_ISENSE_AMP(rShunt, regVal[0], regVal[1]);
-
-    // Get the system current
-    if(data_getParameter(I_SYSTEM, &regVal[0], NULL) == NULL)
-    {
-        cli_printfError("bcc_monitoring ERROR: getting new data went wrong in the update! par %d val %d\n",
-            I_SYSTEM, regVal[0]);
-    }
-
-    // Limit the value
-    regVal[0] &= UINT8_MAX;
-
-    // Check if substracting own board current during charging is needed
-    // Check if the current is positive (charging) (including board current)
-    if((int)(current) >= (regVal[0]))
-    {
-        // Get the state and check if it is in the charging state (CHARGE_START or CHARGE_CB)
-        if(data_getMainState() == CHARGE && (chargeState == CHARGE_START || chargeState == CHARGE_CB))
-        {
-            // Substract the system current because that is measured as well
-            current = current - (float)(regVal[0]);
-        }
-    }
-
-    // Convert to A
-    current = current / MA_TO_A;
+    // convert the battery current to a float in A
+    current = getIsenseCurrent(rShunt, regVal[0], regVal[1]);
 
     // set the current
     if(data_setParameter(I_BATT, &current))
@@ -1684,6 +1765,60 @@ bcc_status_t bcc_monitoring_getBattCurrent(
     return lvRetValue;
 }
 
+/*
+ * @brief   This function is used to measure only the current, for the current monitor task
+ *          it will start a conversion and read the current in one short BCC SPI critical section
+ * @note    It will not set the current in the data struct, that is up to the caller
+ *
+ * @param   drvConfig the address the BCC driver configuration
+ * @param   rShunt the value of the shunt resistor in uOhm
+ * @param   currentA The address of the variable that will become the current in A
+ *
+ * @return  bcc_status_t Error code
+ */
+bcc_status_t bcc_monitoring_measureCurrent(bcc_drv_config_t* const drvConfig, uint32_t rShunt, float* currentA)
+{
+    bcc_status_t error;
+    uint16_t     regVal[2];
+
+    // check for NULL pointer, but only in debug mode
+    DEBUGASSERT(drvConfig != NULL);
+    DEBUGASSERT(currentA != NULL);
+
+    // lock the BCC SPI until the current is read
+    if(spi_lockNotUnlockBCCSpi(true))
+    {
+        cli_printfError("bcc_monitoring_measureCurrent ERROR: couldn't lock BCC SPI\n");
+    }
+
+    // start the conversion and wait until it is done
+    error = bcc_monitoring_doBlockingMeasurement(drvConfig);
+
+    // get the current measument
+    if(error == BCC_STATUS_SUCCESS)
+    {
+        error = bcc_spiwrapper_BCC_Reg_Read(drvConfig, BCC_CID_DEV1, BCC_REG_MEAS_ISENSE1_ADDR, 2, regVal);
+    }
+
+    // unlock the BCC SPI
+    if(spi_lockNotUnlockBCCSpi(false))
+    {
+        cli_printfError("bcc_monitoring_measureCurrent ERROR: couldn't unlock BCC SPI\n");
+    }
+
+    // check for an error
+    if(error != BCC_STATUS_SUCCESS)
+    {
+        cli_printfError("bcc_monitoring_measureCurrent ERROR: couldn't get current error: %d\n", error);
+        return error;
+    }
+
+    // convert the battery current to a float in A
+    *currentA = getIsenseCurrent(rShunt, regVal[0], regVal[1]);
+
+    return error;
+}
+
 /*
  * @brief   This function is used to get the value for the ISense pins open load detected
  * @note    This function will not contain much imformation/comments
@@ -1991,11 +2126,11 @@ int bcc_monitoring_calcDCharge(
     uint16_t        ccMeasurements[((BCC_REG_COULOMB_CNT2_ADDR - BCC_REG_CC_NB_SAMPLES_ADDR) + 1)];
     variableTypes_u variable;
 
-    // to get the sampletime, keep in mind that static struct timespec oldSampleTime is initialized later!
-    struct timespec newSampletime;
+    // to get the sampletime in us, keep in mind that static oldSampleUs is initialized later!
+    uint64_t newSampleUs;
 
     // make the variable for the oldtime and initialze once as the same as the sampletime
-    static struct timespec oldSampleTime = { .tv_nsec = 0, .tv_sec = 0 };
+    static uint64_t oldSampleUs = 0;
 
     // check for NULL pointers but only in debug mode
     DEBUGASSERT(drvConfig != NULL);
@@ -2023,28 +2158,14 @@ int bcc_monitoring_calcDCharge(
     error = bcc_spiwrapper_BCC_Reg_Read(drvConfig, BCC_CID_DEV1, BCC_REG_CC_NB_SAMPLES_ADDR,
         ((BCC_REG_COULOMB_CNT2_ADDR - BCC_REG_CC_NB_SAMPLES_ADDR) + 1), ccMeasurements);
 
-    // get the sample time
-    if(clock_gettime(CLOCK_REALTIME, &newSampletime) == -1)
-    {
-        // unlock the BCC SPI
-        if(spi_lockNotUnlockBCCSpi(false))
-        {
-            cli_printfError("bcc_monitoring ERROR: couldn't unlock BCC SPI\n");
-        }
-
-        // unlock the mutex
-        pthread_mutex_unlock(&gDChargeFuncMutex);
-
-        cli_printfError("bcc_monitoring ERROR: failed to get newSampletime time!\n");
-        return -1;
-    }
+    // get the sample time, this is monotonic so a change of the realtime clock doesn't change dt
+    newSampleUs = timeBase_getUs();
 
     // check if first time
-    if(oldSampleTime.tv_sec == 0 && oldSampleTime.tv_nsec == 0)
+    if(oldSampleUs == 0)
     {
         // make sure the difference is 0
-        oldSampleTime.tv_sec  = newSampletime.tv_sec;
-        oldSampleTime.tv_nsec = newSampletime.tv_nsec;
+        oldSampleUs = newSampleUs;
     }
 
     // check for an error
@@ -2096,15 +2217,7 @@ int bcc_monitoring_calcDCharge(
     *avgCurrentAdr = ((variable.floatVar) / (ccMeasurements[BCC_MSR_CC_NB_SAMPLES]));
 
     // get the difference in time in ms (could use T_meas)
-    variable.int32Var = ((newSampletime.tv_nsec / 1000000) + (newSampletime.tv_sec * 1000)) -
-        ((oldSampleTime.tv_nsec / 1000000) + (oldSampleTime.tv_sec * 1000));
-
-    // check for limits
-    if(variable.int32Var < 0)
-    {
-        // set it to 0
-        variable.int32Var = 0;
-    }
+    variable.int32Var = (int32_t)((newSampleUs - oldSampleUs) / TIME_BASE_US_PER_MS);
 
     // get the difference in charge in Ah
     *deltaChargeAdr = *avgCurrentAdr * (float)(variable.int32Var) / (3600000);
@@ -2114,8 +2227,7 @@ int bcc_monitoring_calcDCharge(
 #endif
 
     // save the old time
-    oldSampleTime.tv_nsec = newSampletime.tv_nsec;
-    oldSampleTime.tv_sec  = newSampletime.tv_sec;
+    oldSampleUs = newSampleUs;
 
     // unlock the BCC SPI
     if(spi_lockNotUnlockBCCSpi(false))
@@ -2231,8 +2343,16 @@ int bcc_monitoring_calibrateSoC(bool calibrateARem, bool currentCheck)
         batteryType = BATTERY_TYPE_DEFAULT;
     }
 
-    // get the state of charge based on the lowest cell voltage
-    StateOfCharge = getSoCBasedOnOCV(batteryType, (uint16_t)lowestCellVoltage);
+    // get the battery temperature
+    if(data_getParameter(C_BATT, &cellVoltageOrCapacity, NULL) == NULL)
+    {
+        cli_printfError("bcc_monitoring_calibrateSoC ERROR: getting battery temperature went wrong!\n");
+        cellVoltageOrCapacity = 25;
+    }
+
+    // get the state of charge based on the lowest cell voltage and the battery temperature
+    StateOfCharge =
+        getSoCBasedOnOCV(batteryType, (uint16_t)lowestCellVoltage, (int16_t)(cellVoltageOrCapacity * 10));
 
     // check if a-rem needs to be calibrated to calibrate the SoC
     if(calibrateARem)
@@ -2330,6 +2450,42 @@ int bcc_monitoring_calibrateSoC(bool calibrateARem, bool currentCheck)
     return lvRetValue;
 }
 
+/*
+ * @brief   This function can be used to get the state of charge (SoC) of an open cell voltage
+ *          with the OCV(SoC, temperature) surface of the battery type
+ * @note    Can be called from mulitple threads
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   cellVoltage the open cell voltage in V
+ * @param   temperature the cell temperature in degC
+ *
+ * @return  the state of charge in % (0 - 100) with a resolution of 0.01%
+ */
+float bcc_monitoring_getOcvSoC(uint8_t batteryType, float cellVoltage, float temperature)
+{
+    // limit the inputs to the fixed point ranges
+    if(cellVoltage < 0)
+    {
+        cellVoltage = 0;
+    }
+    else if(cellVoltage > (UINT16_MAX / 1000))
+    {
+        cellVoltage = UINT16_MAX / 1000;
+    }
+
+    if(temperature < (INT16_MIN / 10))
+    {
+        temperature = INT16_MIN / 10;
+    }
+    else if(temperature > (INT16_MAX / 10))
+    {
+        temperature = INT16_MAX / 10;
+    }
+
+    return (float)getSoCCentiBasedOnOCV(
+               batteryType, (uint16_t)(cellVoltage * 1000), (int16_t)(temperature * 10)) / 100;
+}
+
 /*******************************************************************************
  * Private functions
  ******************************************************************************/
@@ -2389,8 +2545,8 @@ static bcc_status_t getNtcCelsius(uint16_t regVal, int16_t* temp)
      * table (left + 1).
      * The last item cannot be found (algorithm property). */
 
-    /* Calculate fractional part of temperature. */
-    degTenths = (g_ntcTable[left] - regVal) / ((g_ntcTable[left] - g_ntcTable[left + 1]) / 10);
+    /* Calculate fractional part of temperature with the precalculated slope. */
+    degTenths = (int8_t)(((uint32_t)(g_ntcTable[left] - regVal) * g_ntcSlopeTable[left]) >> NTC_SLOPE_SHIFT);
 
     (*temp) = NTC_COMP_TEMP(left, degTenths);
 
@@ -2446,44 +2602,21 @@ static int calculateSoCAndSoH(calcBatteryVariables_t* calcBatteryVariables)
 
 /*
  * @brief   This function can be used to get the state of charge (SoC) from the open cell voltage
- * @note    A predefined table and the lowest cell voltage will be used for this
+ * @note    The OCV(SoC, temperature) surface and the lowest cell voltage will be used for this
  * @warning The battery (voltage) needs to be relaxed before this is used!
  *
  * @param   batteryType The battery-type (BATTERY_TYPE)
- * @param   CurrentCheck if true the current check will be done,
- *          Keep this default on true, except for a power-up check
+ * @param   lowestCellmV the lowest cell voltage in mV
+ * @param   temperature the cell temperature in 0.1 degC
  *
- * @return  0 if succesfull, otherwise it will indicate the error
+ * @return  the state of charge in % (1 - 100)
  */
-static uint8_t getSoCBasedOnOCV(uint8_t batteryType, uint16_t lowestCellmV)
+static uint8_t getSoCBasedOnOCV(uint8_t batteryType, uint16_t lowestCellmV, int16_t temperature)
 {
-    int     i;
-    uint8_t StateOfCharge;
+    int32_t StateOfCharge;
 
-    // find the initial state of charge
-    for(i = 0; i < ((cellmvVsSOCLookupTableAllSize[batteryType]) - 1); i++)
-    {
-        // check if the lowest cell voltage is higher than the next voltage
-        if((lowestCellmV) > cellmvVsSOCLookupTableAll[batteryType][i + 1].milliVolt)
-        {
-            // set the state of charge using linearly interpolation
-            StateOfCharge = (cellmvVsSOCLookupTableAll[batteryType][i + 1]).SoC +
-                (int)round((float)(lowestCellmV - (cellmvVsSOCLookupTableAll[batteryType][i + 1]).milliVolt) *
-                    (float)((float)((cellmvVsSOCLookupTableAll[batteryType][i]).SoC -
-                                (cellmvVsSOCLookupTableAll[batteryType][i + 1]).SoC) /
-                        ((cellmvVsSOCLookupTableAll[batteryType][i]).milliVolt -
-                            (cellmvVsSOCLookupTableAll[batteryType][i + 1]).milliVolt)));
-
-            // escape the for loop
-            break;
-        }
-        // check if it couldn't find it
-        else if(i == ((cellmvVsSOCLookupTableAllSize[batteryType]) - 2))
-        {
-            // set to 0
-            StateOfCharge = 0;
-        }
-    }
+    // get the rounded state of charge in %
+    StateOfCharge = (getSoCCentiBasedOnOCV(batteryType, lowestCellmV, temperature) + 50) / 100;
 
     // set a minimum and max
     if(StateOfCharge < 1)
@@ -2497,9 +2630,208 @@ static uint8_t getSoCBasedOnOCV(uint8_t batteryType, uint16_t lowestCellmV)
         StateOfCharge = 100;
     }
 
+    return (uint8_t)StateOfCharge;
+}
+
+/*
+ * @brief   This function calculates the offset of the OCV to the 25 degC OCV with bilinear interpolation
+ *          of the OCV temperature offset grid
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   SoC the state of charge in 0.01%
+ * @param   temperature the cell temperature in 0.1 degC
+ *
+ * @return  the offset in uV
+ */
+static int32_t getOcvTempOffset(uint8_t batteryType, int32_t SoC, int16_t temperature)
+{
+    const int8_t (*grid)[OCV_GRID_TEMP_POINTS] = cellOcvTempOffsetGridAll[batteryType];
+    int32_t socIndex, socFraction, tempIndex, tempFraction, tempStep;
+    int32_t lowTempOffset, highTempOffset;
+
+    // limit the SoC and get the row and the fraction (0 - OCV_GRID_SOC_STEP) to the next row
+    if(SoC < 0)
+    {
+        SoC = 0;
+    }
+    else if(SoC > ((OCV_GRID_SOC_POINTS - 1) * OCV_GRID_SOC_STEP))
+    {
+        SoC = (OCV_GRID_SOC_POINTS - 1) * OCV_GRID_SOC_STEP;
+    }
+
+    socIndex = SoC / OCV_GRID_SOC_STEP;
+
+    if(socIndex > (OCV_GRID_SOC_POINTS - 2))
+    {
+        socIndex = OCV_GRID_SOC_POINTS - 2;
+    }
+
+    socFraction = SoC - (socIndex * OCV_GRID_SOC_STEP);
+
+    // limit the temperature, outside the grid the first or last column is used
+    if(temperature < cellOcvGridTemperatures[0])
+    {
+        temperature = cellOcvGridTemperatures[0];
+    }
+    else if(temperature > cellOcvGridTemperatures[OCV_GRID_TEMP_POINTS - 1])
+    {
+        temperature = cellOcvGridTemperatures[OCV_GRID_TEMP_POINTS - 1];
+    }
+
+    // get the column
+    for(tempIndex = 0; (tempIndex < (OCV_GRID_TEMP_POINTS - 2)) &&
+        (temperature > cellOcvGridTemperatures[tempIndex + 1]); tempIndex++)
+    {
+    }
+
+    tempStep     = cellOcvGridTemperatures[tempIndex + 1] - cellOcvGridTemperatures[tempIndex];
+    tempFraction = temperature - cellOcvGridTemperatures[tempIndex];
+
+    // interpolate over the SoC in both columns, mV * OCV_GRID_SOC_STEP is uV
+    lowTempOffset = (grid[socIndex][tempIndex] * (OCV_GRID_SOC_STEP - socFraction)) +
+        (grid[socIndex + 1][tempIndex] * socFraction);
+    highTempOffset = (grid[socIndex][tempIndex + 1] * (OCV_GRID_SOC_STEP - socFraction)) +
+        (grid[socIndex + 1][tempIndex + 1] * socFraction);
+
+    // interpolate over the temperature
+    return ((lowTempOffset * (tempStep - tempFraction)) + (highTempOffset * tempFraction)) / tempStep;
+}
+
+/*
+ * @brief   This function calculates the OCV of a row of the OCV/SoC table at a temperature
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   temperature the cell temperature in 0.1 degC
+ * @param   row the row of the OCV/SoC table
+ *
+ * @return  the OCV in uV
+ */
+static int32_t getOcvRowuV(uint8_t batteryType, int16_t temperature, int row)
+{
+    return ((int32_t)cellmvVsSOCLookupTableAll[batteryType][row].milliVolt * 1000) +
+        getOcvTempOffset(batteryType, cellmvVsSOCLookupTableAll[batteryType][row].SoC * 100, temperature);
+}
+
+/*
+ * @brief   This function calculates the state of charge from the open cell voltage and the temperature
+ *          with the OCV(SoC, temperature) surface
+ * @warning The battery (voltage) needs to be relaxed before this is used!
+ *
+ * @param   batteryType The battery-type (BATTERY_TYPE)
+ * @param   cellmV the (lowest) cell voltage in mV
+ * @param   temperature the cell temperature in 0.1 degC
+ *
+ * @return  the state of charge in 0.01% (0 - 10000)
+ */
+static int32_t getSoCCentiBasedOnOCV(uint8_t batteryType, uint16_t cellmV, int16_t temperature)
+{
+    const mvSoC_t* table = cellmvVsSOCLookupTableAll[batteryType];
+    int            left  = 0;
+    int            right = cellmvVsSOCLookupTableAllSize[batteryType] - 1;
+    int            middle;
+    int32_t        celluV = (int32_t)cellmV * 1000;
+    int32_t        leftuV, rightuV;
+    int32_t        StateOfCharge;
+
+    // check if it is lower than the table, the rows are in descending order of the voltage
+    if(celluV <= getOcvRowuV(batteryType, temperature, right))
+    {
+        // set to 0
+        StateOfCharge = 0;
+    }
+    // check if it is higher than the table
+    else if(celluV >= getOcvRowuV(batteryType, temperature, 0))
+    {
+        // set to the SoC of the first row
+        StateOfCharge = table[0].SoC * 100;
+    }
+    else
+    {
+        // search for the first row with a lower voltage (right), the row before it is left
+        while((left + 1) < right)
+        {
+            // split the interval into halves
+            middle = (left + right) >> 1;
+
+            if(getOcvRowuV(batteryType, temperature, middle) < celluV)
+            {
+                right = middle;
+            }
+            else
+            {
+                left = middle;
+            }
+        }
+
+        // set the state of charge using linearly interpolation, truncated to 0.01%
+        // so rounding it to % is the same as rounding the exact value
+        leftuV        = getOcvRowuV(batteryType, temperature, left);
+        rightuV       = getOcvRowuV(batteryType, temperature, right);
+        StateOfCharge = table[right].SoC * 100;
+
+        if(leftuV > rightuV)
+        {
+            StateOfCharge += (int32_t)((((int64_t)(celluV - rightuV)) *
+                                           ((table[left].SoC - table[right].SoC) * 100)) /
+                (leftuV - rightuV));
+        }
+    }
+
+    // limit it
+    if(StateOfCharge > 10000)
+    {
+        StateOfCharge = 10000;
+    }
+
     return StateOfCharge;
 }
 
+/*
+ * @brief   This function converts the ISENSE registers to the battery current
+ *          The system current is substracted while charging, since it is measured as well
+ *
+ * @param   rShunt the value of the shunt resistor in uOhm
+ * @param   isense1 the value of the MEAS_ISENSE1 register
+ * @param   isense2 the value of the MEAS_ISENSE2 register
+ *
+ * @return  the battery current in A
+ */
+static float getIsenseCurrent(uint32_t rShunt, uint16_t isense1, uint16_t isense2)
+{
+    float           current;
+    uint8_t         systemCurrentmA = 0;
+    charge_states_t chargeState     = data_getChargeState();
+
+    /* Mask bits. */
+    isense1 &= BCC_R_MEAS1_I_MASK;
+    isense2 &= BCC_R_MEAS2_I_MASK;
+
+    // convert the battery current to a float in mA
+    // Measured ISENSE in [mA]. Value of shunt resistor is used.
+    current = BCC_GET_ISENSE_AMP(rShunt, isense1, isense2);
+
+    // Get the system current
+    if(data_getParameter(I_SYSTEM, &systemCurrentmA, NULL) == NULL)
+    {
+        cli_printfError("bcc_monitoring ERROR: Couldn't get i-system\n");
+    }
+
+    // Check if substracting own board current during charging is needed
+    // Check if the current is positive (charging) (including board current)
+    if(((int)current) >= (systemCurrentmA))
+    {
+        // Get the state and check if it is in the charging state (CHARGE_START or CHARGE_CB)
+        if(data_getMainState() == CHARGE && (chargeState == CHARGE_START || chargeState == CHARGE_CB))
+        {
+            // Substract the system current because that is measured as well
+            current = current - (float)(systemCurrentmA);
+        }
+    }
+
+    // convert to A
+    return current / MA_TO_A;
+}
+
 /*******************************************************************************
  * EOF
  ******************************************************************************/
@@ -34,6 +34,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
 
 #include "portid.h"
 
@@ -44,11 +46,85 @@
 #include "pnp.h"
 #include "BMS_data_types.h"
 #include "timestamp.h"
+#include "data.h"
+#include "cli.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+
+// the name of a port id register is "uavcan.pub.udral.<name>.0.id"
+#define PORT_ID_REGISTER_PREFIX "uavcan.pub.udral."
+#define PORT_ID_REGISTER_SUFFIX ".0.id"
+
+// a parameter register entry is packed as (parameterKind << 2) | attribute
+#define PARAMETER_REGISTER_KIND_SHIFT     2
+#define PARAMETER_REGISTER_ATTRIBUTE_MASK 0x3
+
+// the entry id of the first config register, after the port id and the parameter registers
+#define CONFIG_REGISTER_ENTRY_ID (CYPHAL_REGISTER_COUNT + NONE * PARAMETER_REGISTER_ATTRIBUTES)
+#define CONFIG_REGISTER_NAME     "config"
+
+// each page has its own header and CRC and a page may end with an unused part smaller than a string entry
+#define CONFIG_REGISTER_PAGE_ENTRIES_SIZE                                                                \
+    (uavcan_primitive_Unstructured_1_0_value_ARRAY_CAPACITY_ - PARAMETER_BLOB_HEADER_SIZE -             \
+        PARAMETER_BLOB_CRC_SIZE - (STRING_MAX_CHARS + 1))
+
+#if((CYPHAL_CONFIG_REGISTER_PAGES * CONFIG_REGISTER_PAGE_ENTRIES_SIZE) < PARAMETER_BLOB_MAX_SIZE)
+#    error CYPHAL_CONFIG_REGISTER_PAGES is too small for all the exported parameters
+#endif
+
+// the value of an empty slot in the register hash table
+#define REGISTER_HASH_EMPTY UINT16_MAX
+
+// 32-bit FNV-1a hash constants
+#define REGISTER_HASH_FNV_OFFSET 2166136261UL
+#define REGISTER_HASH_FNV_PRIME  16777619UL
+
+// a register name consists of a prefix, a name and a suffix
+#define REGISTER_NAME_PARTS 3
+
+#if((CYPHAL_REGISTER_HASH_SLOTS & (CYPHAL_REGISTER_HASH_SLOTS - 1)) != 0)
+#    error CYPHAL_REGISTER_HASH_SLOTS should be a power of 2
+#endif
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+
+//! @brief the attribute of the parameter that a parameter register represents
+typedef enum
+{
+    PARAMETER_REGISTER_VALUE   = 0,
+    PARAMETER_REGISTER_MIN     = 1,
+    PARAMETER_REGISTER_MAX     = 2,
+    PARAMETER_REGISTER_DEFAULT = 3,
+    PARAMETER_REGISTER_ATTRIBUTES
+} parameterRegisterAttribute_t;
+
+//! @brief union to get any parameter type from the data module
+typedef union
+{
+    float    floatVal;
+    uint8_t  u8Val;
+    uint16_t u16Val;
+    int32_t  i32Val;
+    uint64_t u64Val;
+    char     stringVal[STRING_MAX_CHARS + 1];
+} parameterRegisterValue_u;
 
 /****************************************************************************
  * private data
  ****************************************************************************/
 
+//! the suffix of the parameter register name per attribute
+static const char* const gParameterRegisterSuffix[PARAMETER_REGISTER_ATTRIBUTES] = {
+    "", ".min", ".max", ".default"
+};
+
+//! the suffix of the config register name per page
+static const char* const gConfigRegisterSuffix[CYPHAL_CONFIG_REGISTER_PAGES] = { ".0", ".1" };
+
 uavcan_node_GetInfo_Response_1_0* node_info;
 
 CanardRxSubscription getinfo_subscription;
@@ -59,6 +135,30 @@ CanardRxSubscription register_list_subscription;
 cyphal_register_interface_entry register_list[CYPHAL_REGISTER_COUNT];
 uint32_t                        register_list_size = 0;
 
+//! the precomputed list of parameter registers, packed as (parameterKind << 2) | attribute
+static uint16_t gParameterRegisters[NONE * PARAMETER_REGISTER_ATTRIBUTES];
+//! the amount of used entries in gParameterRegisters
+static uint16_t gParameterRegistersSize = 0;
+
+//! hash table (open addressing) of the register names to the register entry id
+//! entry id < CYPHAL_REGISTER_COUNT is a port id register, otherwise a parameter register
+static uint16_t gRegisterHashTable[CYPHAL_REGISTER_HASH_SLOTS];
+
+/****************************************************************************
+ * private Functions declerations
+ ****************************************************************************/
+
+static void    getRegisterNameParts(uint16_t entryId, const char* parts[REGISTER_NAME_PARTS], bool* lowerCase);
+static size_t  renderRegisterName(uint16_t entryId, uint8_t* name);
+static bool    matchRegisterName(uint16_t entryId, const uint8_t* name, size_t length);
+static uint32_t hashRegisterName(const uint8_t* name, size_t length);
+static int32_t addRegisterToHashTable(uint16_t entryId);
+static int32_t findRegister(const uint8_t* name, size_t length);
+static void    getParameterRegister(uint16_t parameterRegister, uavcan_register_Value_1_0* value);
+static int32_t setParameterRegister(uint16_t parameterRegister, uavcan_register_Value_1_0* value);
+static void    getConfigRegister(uint16_t page, uavcan_register_Value_1_0* value);
+static int32_t setConfigRegister(uavcan_register_Value_1_0* value);
+
 /****************************************************************************
  * public functions
  ****************************************************************************/
@@ -67,6 +167,9 @@ int32_t cyphal_register_interface_init(CanardInstance* ins, uavcan_node_GetInfo_
 {
     node_info = info; // TODO think about retention, copy isntead?
 
+    // clear the register name hash table
+    memset(gRegisterHashTable, 0xFF, sizeof(gRegisterHashTable));
+
     (void)canardRxSubscribe(ins, CanardTransferKindRequest, uavcan_node_GetInfo_1_0_FIXED_PORT_ID_,
         uavcan_node_GetInfo_Request_1_0_SERIALIZATION_BUFFER_SIZE_BYTES_,
         CANARD_DEFAULT_TRANSFER_ID_TIMEOUT_USEC, &getinfo_subscription);
@@ -91,7 +194,9 @@ int32_t cyphal_register_interface_add_entry(
         register_list[register_list_size].cb_set = cb_set;
         register_list[register_list_size].cb_get = cb_get;
         register_list_size++;
-        return 0;
+
+        // make it findable by name
+        return addRegisterToHashTable(register_list_size - 1);
     }
     else
     {
@@ -99,6 +204,69 @@ int32_t cyphal_register_interface_add_entry(
     }
 }
 
+int32_t cyphal_register_interface_add_parameters(void)
+{
+    parameterKind_t              parameterKind;
+    parameterRegisterAttribute_t attribute;
+    valueType_t                  type;
+    int32_t                      result;
+    uint16_t                     page;
+
+    // check if not already added
+    if(gParameterRegistersSize != 0)
+    {
+        return 0;
+    }
+
+    // loop through all the parameters
+    for(parameterKind = (parameterKind_t)0; parameterKind < NONE; parameterKind++)
+    {
+        type = data_getType(parameterKind);
+
+        // loop through the attributes
+        for(attribute = PARAMETER_REGISTER_VALUE; attribute < PARAMETER_REGISTER_ATTRIBUTES; attribute++)
+        {
+            // only the value is available for read only parameters
+            if((attribute != PARAMETER_REGISTER_VALUE) && (data_getParameterIfUserReadOnly(parameterKind) != 0))
+            {
+                break;
+            }
+
+            // strings and the uint64 model id don't have a min and max
+            if(((attribute == PARAMETER_REGISTER_MIN) || (attribute == PARAMETER_REGISTER_MAX)) &&
+                ((type == STRINGVAL) || (type == UINT64VAL)))
+            {
+                continue;
+            }
+
+            // add it to the list
+            gParameterRegisters[gParameterRegistersSize] =
+                (uint16_t)((parameterKind << PARAMETER_REGISTER_KIND_SHIFT) | attribute);
+
+            // make it findable by name
+            result = addRegisterToHashTable(CYPHAL_REGISTER_COUNT + gParameterRegistersSize);
+            if(result != 0)
+            {
+                return result;
+            }
+
+            gParameterRegistersSize++;
+        }
+    }
+
+    // add the config registers
+    for(page = 0; page < CYPHAL_CONFIG_REGISTER_PAGES; page++)
+    {
+        result = addRegisterToHashTable(CONFIG_REGISTER_ENTRY_ID + page);
+        if(result != 0)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
 // Handler for all PortID registration related messages
 int32_t cyphal_register_interface_process(CanardInstance* ins, CanardTransfer* transfer)
 {
@@ -173,7 +341,7 @@ int32_t cyphal_register_interface_get_info_response(CanardInstance* ins, CanardT
 int32_t cyphal_register_interface_access_response(CanardInstance* ins, CanardTransfer* request)
 {
 
-    int index;
+    int32_t entryId;
     {
         uavcan_register_Access_Request_1_0 msg;
 
@@ -184,25 +352,28 @@ int32_t cyphal_register_interface_access_response(CanardInstance* ins, CanardTra
             return -CYPHAL_REGISTER_ERROR_SERIALIZATION;
         }
 
-        {
-            char register_string[uavcan_primitive_String_1_0_value_ARRAY_CAPACITY_];
-            int  reg_str_len;
-            for(index = 0; index < register_list_size; index++)
+        // look up the register
+        entryId = findRegister(msg.name.name.elements, msg.name.name.count);
+
+        if((entryId >= 0) && (msg.value._tag_ != 0))
+        { // Value has been set thus we call set handler
+            if(entryId < CYPHAL_REGISTER_COUNT)
             {
-                reg_str_len = snprintf(register_string, sizeof(register_string), "uavcan.pub.udral.%s.0.id",
-                    register_list[index].name); // TODO more option then pub (sub rate etc)
-                if(strncmp((const char*)msg.name.name.elements, register_string, reg_str_len) == 0)
+                if(register_list[entryId].cb_set(&msg.value) != 0)
                 {
-                    if(msg.value._tag_ != 0)
-                    { // Value has been set thus we call set handler
-                        if(register_list[index].cb_set(&msg.value) != 0)
-                        {
-                            // TODO error ocurred check doc for correct response
-                        }
-                    }
-                    break; // We're done exit loop
+                    // TODO error ocurred check doc for correct response
                 }
             }
+            else if(entryId >= CONFIG_REGISTER_ENTRY_ID)
+            {
+                // nothing is imported if the blob is invalid
+                (void)setConfigRegister(&msg.value);
+            }
+            else
+            {
+                // if the type or value is wrong, the response will contain the unchanged value
+                (void)setParameterRegister(gParameterRegisters[entryId - CYPHAL_REGISTER_COUNT], &msg.value);
+            }
         }
     }
 
@@ -210,15 +381,38 @@ int32_t cyphal_register_interface_access_response(CanardInstance* ins, CanardTra
         uavcan_register_Access_Response_1_0 response_msg;
         uavcan_register_Access_Response_1_0_initialize_(&response_msg);
 
-        if(index < register_list_size)
-        { // Index is available
-            response_msg.value = register_list[index].cb_get();
-        }
-        else
-        {
+        if(entryId < 0)
+        { // Register is not available
             uavcan_register_Value_1_0_initialize_(&response_msg.value);
             uavcan_register_Value_1_0_select_empty_(&response_msg.value);
         }
+        else if(entryId < CYPHAL_REGISTER_COUNT)
+        { // Port id register
+            response_msg.value      = register_list[entryId].cb_get();
+            response_msg._mutable   = true;
+            response_msg.persistent = true;
+        }
+        else if(entryId >= CONFIG_REGISTER_ENTRY_ID)
+        { // Config register, the persistent parameters, kept after a save like the parameter registers
+            getConfigRegister(entryId - CONFIG_REGISTER_ENTRY_ID, &response_msg.value);
+            response_msg._mutable   = true;
+            response_msg.persistent = true;
+        }
+        else
+        { // Parameter register
+            uint16_t        parameterRegister = gParameterRegisters[entryId - CYPHAL_REGISTER_COUNT];
+            parameterKind_t parameterKind =
+                (parameterKind_t)(parameterRegister >> PARAMETER_REGISTER_KIND_SHIFT);
+
+            getParameterRegister(parameterRegister, &response_msg.value);
+
+            // only the value itself can be written
+            if((parameterRegister & PARAMETER_REGISTER_ATTRIBUTE_MASK) == PARAMETER_REGISTER_VALUE)
+            {
+                response_msg._mutable   = (data_getParameterIfUserReadOnly(parameterKind) == 0);
+                response_msg.persistent = (data_getParameterIfPersistent(parameterKind) == 1);
+            }
+        }
 
         uint8_t response_payload_buffer[uavcan_register_Access_Response_1_0_SERIALIZATION_BUFFER_SIZE_BYTES_];
 
@@ -278,14 +472,26 @@ int32_t cyphal_register_interface_list_response(CanardInstance* ins, CanardTrans
     CanardMicrosecond transmission_deadline = getMonotonicTimestampUSec() + 1000 * 10;
 
     uavcan_register_List_Response_1_0 response_msg;
+    uavcan_register_List_Response_1_0_initialize_(&response_msg);
 
     // Reponse magic start
 
+    // the port id registers are listed first, followed by the parameter registers
+    // an empty name is returned when the index is out of range
     if(msg.index < register_list_size)
     {
-        response_msg.name.name.count = snprintf((char*)response_msg.name.name.elements,
-            uavcan_primitive_String_1_0_value_ARRAY_CAPACITY_, "uavcan.pub.udral.%s.0.id",
-            register_list[msg.index].name);
+        response_msg.name.name.count = renderRegisterName(msg.index, response_msg.name.name.elements);
+    }
+    else if((msg.index - register_list_size) < gParameterRegistersSize)
+    {
+        response_msg.name.name.count = renderRegisterName(
+            CYPHAL_REGISTER_COUNT + (msg.index - register_list_size), response_msg.name.name.elements);
+    }
+    else if((msg.index - register_list_size - gParameterRegistersSize) < CYPHAL_CONFIG_REGISTER_PAGES)
+    {
+        response_msg.name.name.count = renderRegisterName(
+            CONFIG_REGISTER_ENTRY_ID + (msg.index - register_list_size - gParameterRegistersSize),
+            response_msg.name.name.elements);
     }
     // TODO more option then pub (sub rate
 
@@ -321,3 +527,436 @@ int32_t cyphal_register_interface_list_response(CanardInstance* ins, CanardTrans
     }
     return 1;
 }
+
+/****************************************************************************
+ * private functions
+ ****************************************************************************/
+
+/*!
+ * @brief   function to get the parts that make up the name of a register
+ *
+ * @param   entryId the id of the register, < CYPHAL_REGISTER_COUNT for a port id register
+ * @param   parts array to fill with the prefix, the name and the suffix
+ * @param   lowerCase will be true if the name part needs to be converted to lower case
+ *
+ * @return  none
+ */
+static void getRegisterNameParts(uint16_t entryId, const char* parts[REGISTER_NAME_PARTS], bool* lowerCase)
+{
+    uint16_t parameterRegister;
+
+    if(entryId >= CONFIG_REGISTER_ENTRY_ID)
+    {
+        parts[0]   = CYPHAL_PARAMETER_REGISTER_PREFIX;
+        parts[1]   = CONFIG_REGISTER_NAME;
+        parts[2]   = gConfigRegisterSuffix[entryId - CONFIG_REGISTER_ENTRY_ID];
+        *lowerCase = false;
+    }
+    else if(entryId < CYPHAL_REGISTER_COUNT)
+    {
+        parts[0]   = PORT_ID_REGISTER_PREFIX;
+        parts[1]   = register_list[entryId].name;
+        parts[2]   = PORT_ID_REGISTER_SUFFIX;
+        *lowerCase = false;
+    }
+    else
+    {
+        parameterRegister = gParameterRegisters[entryId - CYPHAL_REGISTER_COUNT];
+        parts[0]          = CYPHAL_PARAMETER_REGISTER_PREFIX;
+        parts[1]          = gGetSetParameters[parameterRegister >> PARAMETER_REGISTER_KIND_SHIFT];
+        parts[2]          = gParameterRegisterSuffix[parameterRegister & PARAMETER_REGISTER_ATTRIBUTE_MASK];
+        *lowerCase        = true;
+    }
+}
+
+/*!
+ * @brief   function to write the name of a register in a uavcan.register.Name.1.0 name array
+ *
+ * @param   entryId the id of the register
+ * @param   name the array to write to, with uavcan_register_Name_1_0_name_ARRAY_CAPACITY_ elements
+ *
+ * @return  the length of the name
+ */
+static size_t renderRegisterName(uint16_t entryId, uint8_t* name)
+{
+    const char* parts[REGISTER_NAME_PARTS];
+    const char* character;
+    bool        lowerCase;
+    size_t      length = 0;
+    int         i;
+
+    getRegisterNameParts(entryId, parts, &lowerCase);
+
+    // copy each part
+    for(i = 0; i < REGISTER_NAME_PARTS; i++)
+    {
+        for(character = parts[i];
+            (*character != '\0') && (length < uavcan_register_Name_1_0_name_ARRAY_CAPACITY_); character++)
+        {
+            name[length++] = (lowerCase && (i == 1)) ? (uint8_t)tolower((unsigned char)*character) :
+                                                       (uint8_t)*character;
+        }
+    }
+
+    return length;
+}
+
+/*!
+ * @brief   function to check if a received name is the name of a register
+ *
+ * @param   entryId the id of the register
+ * @param   name the received name
+ * @param   length the length of the received name
+ *
+ * @return  true if it matches
+ */
+static bool matchRegisterName(uint16_t entryId, const uint8_t* name, size_t length)
+{
+    const char* parts[REGISTER_NAME_PARTS];
+    const char* character;
+    bool        lowerCase;
+    size_t      offset = 0;
+    uint8_t     expected;
+    int         i;
+
+    getRegisterNameParts(entryId, parts, &lowerCase);
+
+    // compare each part
+    for(i = 0; i < REGISTER_NAME_PARTS; i++)
+    {
+        for(character = parts[i]; *character != '\0'; character++)
+        {
+            expected = (lowerCase && (i == 1)) ? (uint8_t)tolower((unsigned char)*character) :
+                                                 (uint8_t)*character;
+
+            if((offset >= length) || (name[offset] != expected))
+            {
+                return false;
+            }
+            offset++;
+        }
+    }
+
+    // it should have the same length
+    return (offset == length);
+}
+
+/*!
+ * @brief   function to calculate the 32-bit FNV-1a hash of a register name
+ *
+ * @param   name the name
+ * @param   length the length of the name
+ *
+ * @return  the hash
+ */
+static uint32_t hashRegisterName(const uint8_t* name, size_t length)
+{
+    uint32_t hash = REGISTER_HASH_FNV_OFFSET;
+    size_t   i;
+
+    for(i = 0; i < length; i++)
+    {
+        hash = (hash ^ name[i]) * REGISTER_HASH_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*!
+ * @brief   function to add a register to the name hash table
+ *
+ * @param   entryId the id of the register
+ *
+ * @return  0 if succeeded, -CYPHAL_REGISTER_ERROR_OUT_OF_MEMORY if the table is full
+ */
+static int32_t addRegisterToHashTable(uint16_t entryId)
+{
+    uint8_t  name[uavcan_register_Name_1_0_name_ARRAY_CAPACITY_];
+    uint32_t slot;
+    uint32_t probe;
+
+    // calculate the hash of the name
+    slot = hashRegisterName(name, renderRegisterName(entryId, name)) & (CYPHAL_REGISTER_HASH_SLOTS - 1);
+
+    // find the first empty slot (linear probing)
+    for(probe = 0; probe < CYPHAL_REGISTER_HASH_SLOTS; probe++)
+    {
+        if(gRegisterHashTable[slot] == REGISTER_HASH_EMPTY)
+        {
+            gRegisterHashTable[slot] = entryId;
+            return 0;
+        }
+
+        slot = (slot + 1) & (CYPHAL_REGISTER_HASH_SLOTS - 1);
+    }
+
+    cli_printfError("portid ERROR: register hash table full!\n");
+    return -CYPHAL_REGISTER_ERROR_OUT_OF_MEMORY;
+}
+
+/*!
+ * @brief   function to find a register by its name
+ *
+ * @param   name the received name
+ * @param   length the length of the received name
+ *
+ * @return  the entry id of the register, -1 if not found
+ */
+static int32_t findRegister(const uint8_t* name, size_t length)
+{
+    uint32_t slot;
+    uint32_t probe;
+    uint16_t entryId;
+
+    slot = hashRegisterName(name, length) & (CYPHAL_REGISTER_HASH_SLOTS - 1);
+
+    // check the slots until an empty one
+    for(probe = 0; probe < CYPHAL_REGISTER_HASH_SLOTS; probe++)
+    {
+        entryId = gRegisterHashTable[slot];
+
+        if(entryId == REGISTER_HASH_EMPTY)
+        {
+            break;
+        }
+
+        if(matchRegisterName(entryId, name, length))
+        {
+            return entryId;
+        }
+
+        slot = (slot + 1) & (CYPHAL_REGISTER_HASH_SLOTS - 1);
+    }
+
+    return -1;
+}
+
+/*!
+ * @brief   function to get the value of a parameter register as the register value type
+ *          that matches the parameter type
+ *
+ * @param   parameterRegister the packed parameter register from gParameterRegisters
+ * @param   value the register value to fill, will be empty if it failed
+ *
+ * @return  none
+ */
+static void getParameterRegister(uint16_t parameterRegister, uavcan_register_Value_1_0* value)
+{
+    parameterKind_t          parameterKind = (parameterKind_t)(parameterRegister >> PARAMETER_REGISTER_KIND_SHIFT);
+    parameterRegisterValue_u registerValue, otherValue;
+    int                      ret = -1;
+    size_t                   length;
+
+    memset(&registerValue, 0, sizeof(registerValue));
+
+    // get the wanted attribute
+    switch(parameterRegister & PARAMETER_REGISTER_ATTRIBUTE_MASK)
+    {
+        case PARAMETER_REGISTER_VALUE:
+            ret = (data_getParameter(parameterKind, &registerValue, NULL) == NULL) ? -1 : 0;
+            break;
+        case PARAMETER_REGISTER_MIN:
+            ret = data_getParameterMinMax(parameterKind, &registerValue, &otherValue);
+            break;
+        case PARAMETER_REGISTER_MAX:
+            ret = data_getParameterMinMax(parameterKind, &otherValue, &registerValue);
+            break;
+        case PARAMETER_REGISTER_DEFAULT:
+            ret = data_getParameterDefault(parameterKind, &registerValue, NULL);
+            break;
+        default:
+            break;
+    }
+
+    uavcan_register_Value_1_0_initialize_(value);
+
+    // check for error
+    if(ret != 0)
+    {
+        uavcan_register_Value_1_0_select_empty_(value);
+        return;
+    }
+
+    // set it in the register value with the matching type
+    switch(data_getType(parameterKind))
+    {
+        case FLOATVAL:
+            uavcan_register_Value_1_0_select_real32_(value);
+            value->real32.value.elements[0] = registerValue.floatVal;
+            value->real32.value.count       = 1;
+            break;
+        case UINT8VAL:
+            uavcan_register_Value_1_0_select_natural8_(value);
+            value->natural8.value.elements[0] = registerValue.u8Val;
+            value->natural8.value.count       = 1;
+            break;
+        case UINT16VAL:
+            uavcan_register_Value_1_0_select_natural16_(value);
+            value->natural16.value.elements[0] = registerValue.u16Val;
+            value->natural16.value.count       = 1;
+            break;
+        case INT32VAL:
+            uavcan_register_Value_1_0_select_integer32_(value);
+            value->integer32.value.elements[0] = registerValue.i32Val;
+            value->integer32.value.count       = 1;
+            break;
+        case UINT64VAL:
+            uavcan_register_Value_1_0_select_natural64_(value);
+            value->natural64.value.elements[0] = registerValue.u64Val;
+            value->natural64.value.count       = 1;
+            break;
+        case STRINGVAL:
+            length = strnlen(registerValue.stringVal, STRING_MAX_CHARS);
+            uavcan_register_Value_1_0_select_string_(value);
+            memcpy(value->_string.value.elements, registerValue.stringVal, length);
+            value->_string.value.count = length;
+            break;
+        default:
+            uavcan_register_Value_1_0_select_empty_(value);
+            break;
+    }
+}
+
+/*!
+ * @brief   function to set a parameter with a register value
+ *          the register value type should match the parameter type
+ *
+ * @param   parameterRegister the packed parameter register from gParameterRegisters
+ * @param   value the received register value
+ *
+ * @return  0 if succeeded, -CYPHAL_REGISTER_ERROR_INVALID_VALUE otherwise
+ */
+static int32_t setParameterRegister(uint16_t parameterRegister, uavcan_register_Value_1_0* value)
+{
+    parameterKind_t          parameterKind = (parameterKind_t)(parameterRegister >> PARAMETER_REGISTER_KIND_SHIFT);
+    parameterRegisterValue_u registerValue;
+    void*                    newValue = NULL;
+    size_t                   length;
+
+    // only the value of a user writable parameter can be set
+    if(((parameterRegister & PARAMETER_REGISTER_ATTRIBUTE_MASK) != PARAMETER_REGISTER_VALUE) ||
+        (data_getParameterIfUserReadOnly(parameterKind) != 0))
+    {
+        return -CYPHAL_REGISTER_ERROR_INVALID_VALUE;
+    }
+
+    // check if the type matches and get the new value
+    switch(data_getType(parameterKind))
+    {
+        case FLOATVAL:
+            if(uavcan_register_Value_1_0_is_real32_(value) && (value->real32.value.count == 1))
+            {
+                newValue = &value->real32.value.elements[0];
+            }
+            break;
+        case UINT8VAL:
+            if(uavcan_register_Value_1_0_is_natural8_(value) && (value->natural8.value.count == 1))
+            {
+                newValue = &value->natural8.value.elements[0];
+            }
+            break;
+        case UINT16VAL:
+            if(uavcan_register_Value_1_0_is_natural16_(value) && (value->natural16.value.count == 1))
+            {
+                newValue = &value->natural16.value.elements[0];
+            }
+            break;
+        case INT32VAL:
+            if(uavcan_register_Value_1_0_is_integer32_(value) && (value->integer32.value.count == 1))
+            {
+                newValue = &value->integer32.value.elements[0];
+            }
+            break;
+        case UINT64VAL:
+            if(uavcan_register_Value_1_0_is_natural64_(value) && (value->natural64.value.count == 1))
+            {
+                newValue = &value->natural64.value.elements[0];
+            }
+            break;
+        case STRINGVAL:
+            if(uavcan_register_Value_1_0_is_string_(value))
+            {
+                // limit the length and terminate the string
+                length = value->_string.value.count;
+                if(length > STRING_MAX_CHARS - 1)
+                {
+                    length = STRING_MAX_CHARS - 1;
+                }
+                memcpy(registerValue.stringVal, value->_string.value.elements, length);
+                registerValue.stringVal[length] = '\0';
+                newValue                        = registerValue.stringVal;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // check for a wrong type
+    if(newValue == NULL)
+    {
+        return -CYPHAL_REGISTER_ERROR_INVALID_VALUE;
+    }
+
+    // set the new value, this will check the limits
+    if(data_setParameter(parameterKind, newValue) != 0)
+    {
+        return -CYPHAL_REGISTER_ERROR_INVALID_VALUE;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief   function to get a page of the exported parameters as an unstructured register value
+ *          each page is a parameter blob that continues with the parameters after the previous page
+ *
+ * @param   page the page of the config register
+ * @param   value the register value to fill, will be empty if it failed
+ *
+ * @return  none
+ */
+static void getConfigRegister(uint16_t page, uavcan_register_Value_1_0* value)
+{
+    parameterKind_t nextParameter = (parameterKind_t)0;
+    int             length        = 0;
+    uint16_t        i;
+
+    uavcan_register_Value_1_0_initialize_(value);
+    uavcan_register_Value_1_0_select_unstructured_(value);
+
+    // export the pages until this page, a page after the last parameter is an empty blob
+    for(i = 0; (i <= page) && (length >= 0); i++)
+    {
+        length = data_exportParameters(value->unstructured.value.elements,
+            uavcan_primitive_Unstructured_1_0_value_ARRAY_CAPACITY_, &nextParameter);
+    }
+
+    // check for error
+    if(length < 0)
+    {
+        uavcan_register_Value_1_0_select_empty_(value);
+        return;
+    }
+
+    value->unstructured.value.count = length;
+}
+
+/*!
+ * @brief   function to import a parameter blob received in a config register
+ *          any page (or another blob with a part of the parameters) may be written to any config register
+ *
+ * @param   value the received register value
+ *
+ * @return  0 if succeeded, -CYPHAL_REGISTER_ERROR_INVALID_VALUE otherwise
+ */
+static int32_t setConfigRegister(uavcan_register_Value_1_0* value)
+{
+    // check the type and import it
+    if(!uavcan_register_Value_1_0_is_unstructured_(value) ||
+        (data_importParameters(value->unstructured.value.elements, value->unstructured.value.count) < 0))
+    {
+        return -CYPHAL_REGISTER_ERROR_INVALID_VALUE;
+    }
+
+    return 0;
+}
@@ -33,26 +33,16 @@
  ****************************************************************************/
 
 #include "timestamp.h"
-
-#include <stdio.h>
-#include <stdlib.h>
+#include "timeBase.h"
 
 /****************************************************************************
  * Name: getMonotonicTimestampUSec
  *
- * Description:
+ * Description: the monotonic time in us, this is the time base of the BMS
+ *              so the CAN timestamps match the timestamps of the measurements
  *
  ****************************************************************************/
 uint64_t getMonotonicTimestampUSec(void)
 {
-    struct timespec ts;
-
-    memset(&ts, 0, sizeof(ts));
-
-    if(clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
-    {
-        abort();
-    }
-
-    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000ULL;
+    return timeBase_getUs();
 }
@@ -46,6 +46,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include <arch/board/smbus_sbd.h>
 #include "SMBus.h"
@@ -65,7 +66,6 @@
 #define MANUFACT_MONTH                    05
 #define MANUFACT_DAY                      12
 
-#define MANUFACT_DATA_LENGHT              1
 
 /****************************************************************************
  * Private Variables
@@ -74,6 +74,15 @@
 static bool gDontDoSMBus                  = false;
 const char SMBus_path_sbd[]               = "/dev/smbus-sbd0";  
 
+/*! @brief  the file descriptor of the SMBus SBD driver, kept open after SMBus_initialize() */
+static int gSMBusFd                       = ERROR;
+
+/*! @brief  mutex to protect the cached SMBus data */
+static pthread_mutex_t gSMBusLock;
+
+/*! @brief  true if the static fields need to be read from the data module again */
+static volatile bool gStaticFieldsOutdated = true;
+
 /*! @brief  The manufactrure name*/
 static const char manufacture_name[]      = "NXP";
 
@@ -86,19 +95,82 @@ static const char *device_chemistry[]    =
     "LiP", 
     "LFP",
     "LFY",
-    "NMC"
+    "NMC",
     "NIB"
 };
 
-/*! @brief  The array that will be written in the manufacturer_data of the SMBus Smart Battery Data*/
-static const uint8_t manufacturer_data[MANUFACT_DATA_LENGHT]  =
+/*! @brief  The double buffered measurement snapshot that is used as manufacturer_data of the SMBus Smart 
+ *          Battery Data. The driver reads the active one directly, the other one is filled with the next update.
+ *          See SMBUS_SNAPSHOT_*_OFFSET in SMBus.h for the layout */
+static uint8_t gSnapshot[2][SMBUS_SNAPSHOT_SIZE];
+
+/*! @brief  The index of the snapshot buffer that the driver uses */
+static uint8_t gActiveSnapshot            = 0;
+
+/*! @brief  The sequence number of the snapshot, incremented with each update */
+static uint8_t gSnapshotSequence          = 0;
+
+/*! @brief  The structure that will be written in the SMBus SBD driver, this could be retreived with SMBus
+ *          The constant fields are set here, the static fields with updateStaticFields() and
+ *          the measured fields with each SMBus_updateInformation() */
+static struct smbus_sbd_data_s gSmbusSbdData =
 {
-    0x0,
+    .temperature              = 0,    /* 0.1  K */
+    .voltage                  = 0,    /* 1.0 mV */
+    .current                  = 0,    /* 1.0 mA */
+    .average_current          = 0,    /* 1.0 mA */
+    .max_error                = MAX_ERROR_VAL,    /* 1.0  % */
+    .relative_state_of_charge = 0,    /* 1.0  % */
+    .absolute_state_of_charge = 0,    /* 1.0  % */
+    .remaining_capacity       = 0,    /* 1.0 mAh (or 10 mWh?) */
+    .full_charge_capacity     = 0,    /* 1.0 mAh (or 10 mWh?) */
+    .run_time_to_empty        = 0,    /* 1.0  min */
+    .average_time_to_empty    = 0,    /* 1.0  min */
+
+    .cycle_count              = 0,    /* 1.0  cycle */
+    .design_capacity          = 0,    /* 1.0 mAh (or 10 mWh?) */
+    .design_voltage           = 0,    /* 1.0 mV */
+
+    .manufacture_date         = ((MANUFACT_YEAR - 1980) * 
+                                512 + MANUFACT_MONTH * 
+                                32 + MANUFACT_DAY),   /* (year - 1980) * 512 + month * 32 + day */
+    .serial_number            = 0,
+    .manufacturer_name        = manufacture_name,
+    .device_name              = device_name,
+    .device_chemistry         = NULL,
+    .manufacturer_data        = gSnapshot[0],
+    .manufacturer_data_length = SMBUS_SNAPSHOT_SIZE,
+
+    .cell1_voltage            = 0,    /* 1.0 mV */
+    .cell2_voltage            = 0,    /* 1.0 mV */
+    .cell3_voltage            = 0,    /* 1.0 mV */
+    .cell4_voltage            = 0,    /* 1.0 mV */
+    .cell5_voltage            = 0,    /* 1.0 mV */
+    .cell6_voltage            = 0,    /* 1.0 mV */
 };
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
+/*!
+ * @brief   This function will update the fields of the SMBus data that only change with a parameter change
+ *          like the chemistry, cycle count, design capacity, design voltage and serial number.
+ *
+ * @warning The gSMBusLock should be locked.
+ */
+static void updateStaticFields(void);
+
+/*!
+ * @brief   This function will fill the snapshot buffer that is not used by the driver with the measurements
+ *          and set it as manufacturer_data.
+ *
+ * @warning The gSMBusLock should be locked.
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ */
+static void updateSnapshot(commonBatteryVariables_t *pCommonBatteryVariables,
+    calcBatteryVariables_t *pCalcBatteryVariables);
 
 /****************************************************************************
  * Public Functions
@@ -116,6 +188,31 @@ static const uint8_t manufacturer_data[MANUFACT_DATA_LENGHT]  =
  */
 int SMBus_initialize(void)
 {
+    // check if already initialized
+    if(gSMBusFd != ERROR)
+    {
+        return OK;
+    }
+
+    // initialize the mutex
+    pthread_mutex_init(&gSMBusLock, NULL);
+
+    // open the device, it will stay open
+    gSMBusFd = open(SMBus_path_sbd, O_RDWR);
+
+    if(gSMBusFd == ERROR)
+    {
+        cli_printfError("SMBus ERROR: could not open FD: %d errno: %d\n", gSMBusFd, errno);
+
+        // don't do SMBus anymore
+        gDontDoSMBus = true;
+
+        return -1;
+    }
+
+    // make sure the static fields are read with the first update
+    gStaticFieldsOutdated = true;
+
     // return to the user
     return OK;
 }
@@ -138,275 +235,430 @@ int SMBus_initialize(void)
 int SMBus_updateInformation(bool resetCurrent, commonBatteryVariables_t *pCommonBatteryVariables,
 calcBatteryVariables_t *pCalcBatteryVariables)
 {
-    int fd;
     variableTypes_u variable1;
 
     // check if SMBus shouldn't be done
-    if(gDontDoSMBus)
+    if(gDontDoSMBus || (gSMBusFd == ERROR))
     {
         // just return without an error
         return 0;
     }
 
-    // check for error 
-    if(data_getParameter(BATTERY_TYPE, 
-        &variable1.uint8Var, NULL) == NULL)
-    {
-        // set the default value
-        variable1.uint8Var = BATTERY_TYPE_DEFAULT;
+    // lock the mutex
+    pthread_mutex_lock(&gSMBusLock);
 
-        // error output
-        cli_printfError("SMBus ERROR: could not get battery-type!\n");
+    // check if the static fields need to be updated
+    if(gStaticFieldsOutdated)
+    {
+        updateStaticFields();
     }
 
-    // make the struct with the default parameters
-    /*! @brief  The structure that will be written in the SMBus SBD driver, this could be retreived with SMBus*/
-    struct smbus_sbd_data_s smbus_sbd_data =
+    // check if the current should be updated
+    if(resetCurrent)
+    {
+        // set the current to 0, the rest of the cached data stays the same
+        gSmbusSbdData.current = 0;
+    }
+    else
     {
-        .temperature              = 0,    /* 0.1  K */
-        .voltage                  = 0,    /* 1.0 mV */
-        .current                  = 0,    /* 1.0 mA */
-        .average_current          = 0,    /* 1.0 mA */
-        .max_error                = MAX_ERROR_VAL,    /* 1.0  % */
-        .relative_state_of_charge = 0,    /* 1.0  % */
-        .absolute_state_of_charge = 0,    /* 1.0  % */
-        .remaining_capacity       = 0,    /* 1.0 mAh (or 10 mWh?) */
-        .full_charge_capacity     = 0,    /* 1.0 mAh (or 10 mWh?) */
-        .run_time_to_empty        = 0,    /* 1.0  min */
-        .average_time_to_empty    = 0,    /* 1.0  min */
-
-        .cycle_count              = 0,    /* 1.0  cycle */
-        .design_capacity          = 0,    /* 1.0 mAh (or 10 mWh?) */
-        .design_voltage           = 0,    /* 1.0 mV */
-
-        .manufacture_date         = ((MANUFACT_YEAR - 1980) * 
-                                    512 + MANUFACT_MONTH * 
-                                    32 + MANUFACT_DAY),   /* (year - 1980) * 512 + month * 32 + day */
-        .serial_number            = 0,
-        .manufacturer_name        = manufacture_name,
-        .device_name              = device_name,
-        .device_chemistry         = device_chemistry[variable1.uint8Var],
-        .manufacturer_data        = manufacturer_data,
-        .manufacturer_data_length = MANUFACT_DATA_LENGHT,
-
-        .cell1_voltage            = 0,    /* 1.0 mV */
-        .cell2_voltage            = 0,    /* 1.0 mV */
-        .cell3_voltage            = 0,    /* 1.0 mV */
-        .cell4_voltage            = 0,    /* 1.0 mV */
-        .cell5_voltage            = 0,    /* 1.0 mV */
-        .cell6_voltage            = 0,    /* 1.0 mV */
-    };
-
-    // open the device 
-    fd = open("/dev/smbus-sbd0", O_RDWR);
-
-    if(fd == ERROR)
+        // check for NULL pointers in debug mode
+        DEBUGASSERT(pCommonBatteryVariables != NULL);
+        DEBUGASSERT(pCalcBatteryVariables != NULL);
+
+        // update the measured fields of the struct
+
+        // only set temperature sensor if sensor is enabled
+        if(pCommonBatteryVariables->sensor_enable)
+        {
+            // set the temperature
+            gSmbusSbdData.temperature = 
+                (uint16_t)((pCommonBatteryVariables->C_batt + KELVIN_TO_CELCIUS) * 10);
+        }
+        else
+        {
+            gSmbusSbdData.temperature = 0;
+        }
+
+        // convert battery voltage to mv and place in struct
+        gSmbusSbdData.voltage = (uint16_t)(pCommonBatteryVariables->V_batt*1000);
+
+        // convert current to mA and place in struct
+        gSmbusSbdData.current = (uint16_t)((int32_t)(pCommonBatteryVariables->I_batt*1000));
+
+        // convert average_current to mA and place in struct
+        gSmbusSbdData.average_current = (uint16_t)((int32_t)(pCommonBatteryVariables->I_batt_avg*1000));
+
+        // set both state of charges in %
+        gSmbusSbdData.relative_state_of_charge = pCalcBatteryVariables->s_charge;
+        gSmbusSbdData.absolute_state_of_charge = pCalcBatteryVariables->s_charge;
+
+        // convert capacity to mAh and place in struct
+        gSmbusSbdData.remaining_capacity = (uint16_t)(pCalcBatteryVariables->A_rem*1000);
+
+        // convert to mAh and place in struct
+        gSmbusSbdData.full_charge_capacity = (uint16_t)(pCalcBatteryVariables->A_full*1000);
+
+        // calculate the time to empty ((Ah/A) * minutes per h)
+        variable1.int32Var = (int32_t)(pCalcBatteryVariables->A_rem / pCommonBatteryVariables->I_batt) * MINUTES_PER_HOUR;
+
+        // limit the value
+        if(variable1.int32Var < 0)
+        {
+            // set to 0
+            variable1.int32Var = 0;
+        }
+        // check if it is larger than the max
+        else if(variable1.int32Var > UINT16_MAX)
+        {
+            // set to the max value
+            variable1.int32Var = UINT16_MAX;
+        }
+
+        // set the time to empty
+        gSmbusSbdData.run_time_to_empty = (uint16_t)variable1.int32Var;
+
+        // calculate the time to empty ((Ah/A) * minutes per h)
+        variable1.int32Var = (int32_t)(pCalcBatteryVariables->A_rem / pCommonBatteryVariables->I_batt_avg) * MINUTES_PER_HOUR;
+
+        // limit the value
+        if(variable1.int32Var < 0)
+        {
+            // set to 0
+            variable1.int32Var = 0;
+        }
+        // check if it is larger than the max
+        else if(variable1.int32Var > UINT16_MAX)
+        {
+            // set to the max value
+            variable1.int32Var = UINT16_MAX;
+        }
+
+        // set the average run time to empty
+        gSmbusSbdData.average_time_to_empty = (uint16_t)variable1.int32Var;
+
+        // set the cell voltages in mV
+        // first set the minimum 3 cell voltages
+        gSmbusSbdData.cell1_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell1*1000;
+        gSmbusSbdData.cell2_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell2*1000;
+        gSmbusSbdData.cell3_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell3*1000;
+
+        // set the other cells to 0 if not used
+        gSmbusSbdData.cell4_voltage = 0;
+        gSmbusSbdData.cell5_voltage = 0;
+        gSmbusSbdData.cell6_voltage = 0;
+
+        // check what other values it should set and set them
+        switch(pCommonBatteryVariables->N_cells)
+        {
+            case 4:
+                gSmbusSbdData.cell4_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
+            break;
+            case 5:
+                gSmbusSbdData.cell4_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
+
+                gSmbusSbdData.cell5_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell5*1000;
+            break;
+            case 6:
+                gSmbusSbdData.cell4_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
+                
+                gSmbusSbdData.cell5_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell5*1000;
+                
+                gSmbusSbdData.cell6_voltage = 
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell6*1000;
+            break;
+            default:
+            break;
+        }
+
+        // fill the other snapshot buffer
+        updateSnapshot(pCommonBatteryVariables, pCalcBatteryVariables);
+    }
+
+    /* Write the cached smbus_sbd_data_s struct to the SMBus SBD driver in one write.  It needs to be
+     * converted to a constant character buffer and the buffer length has to be
+     * equal to the size of the smbus_sbd_data_s struct.
+     *
+     * Note that this write operation can be performed as often as you like.
+     * The SMBus SBD driver will always provide the most recent data that it received
+     * when it receives a request for battery data.
+     */
+
+    variable1.int32Var = write(gSMBusFd, (const char *)&gSmbusSbdData, sizeof(struct smbus_sbd_data_s));
+    if(variable1.int32Var != sizeof(struct smbus_sbd_data_s))
     {
         /* Something went wrong.  You could try to handle the error here, pass
          * it on to the calling function, or just ignore it.
          */
 
-        cli_printfError("SMBus ERROR: could not open FD: %d\n", fd);
-    
-        // don't do SMBus anymore
-        gDontDoSMBus = true;
+        cli_printfError("SMBus ERROR: could not write new data: %d errno: %d\n",
+            variable1.int32Var, errno);
 
-        // error on exit
         variable1.int32Var = -1;
+
+        // the driver still uses the old snapshot
+        gSmbusSbdData.manufacturer_data = gSnapshot[gActiveSnapshot];
     }
     else
     {
-        // check if the current should be updated
-        if(resetCurrent)
+        // the driver uses the new snapshot now
+        if(gSmbusSbdData.manufacturer_data != gSnapshot[gActiveSnapshot])
         {
-            variable1.int32Var = read(fd, (void *)&smbus_sbd_data, sizeof(smbus_sbd_data));
-            if(variable1.int32Var != sizeof(smbus_sbd_data))
-            {
-                cli_printfError("SMBus ERROR: could not read sbd data: %d errno: %d\n",
-                    variable1.int32Var, errno);
+            gActiveSnapshot ^= 1;
+        }
 
-                variable1.int32Var = -1;
-            }
+        variable1.int32Var = 0;
+    }
 
-            // set the current to 0
-            smbus_sbd_data.current = 0;
-        }
-        else
-        {
-            // check for NULL pointers in debug mode
-            DEBUGASSERT(pCommonBatteryVariables != NULL);
-            DEBUGASSERT(pCalcBatteryVariables != NULL);
+    // unlock the mutex
+    pthread_mutex_unlock(&gSMBusLock);
 
-            // update the struct
+    // return to user
+    return variable1.int32Var;
+}
 
-            // only set temperature sensor if sensor is enabled
-            if(pCommonBatteryVariables->sensor_enable)
-            {
-                // set the temperature
-                smbus_sbd_data.temperature = 
-                    (uint16_t)((pCommonBatteryVariables->C_batt + KELVIN_TO_CELCIUS) * 10);
-            }
+/*!
+ * @brief   This function is used to indicate a parameter changed that is used in the static SMBus fields.
+ *          The static fields will be read again with the next SMBus_updateInformation()
+ *
+ * @warning This function may be called from the data.c parameter change handler, 
+ *          it will not use the data_getParameter() function.
+ *
+ * @param   parameter the parameter that changed, NONE if all parameters could have changed (load).
+ *
+ * @return  none
+ */
+void SMBus_changedParameter(parameterKind_t parameter)
+{
+    // check if it is used in the static fields
+    switch(parameter)
+    {
+        case BATTERY_TYPE:
+        case N_CHARGES:
+        case V_CELL_OV:
+        case A_FACTORY:
+        case BATT_ID:
+        case NONE:
+            // read it the next update
+            gStaticFieldsOutdated = true;
+            break;
+        default:
+            break;
+    }
+}
 
-            // convert battery voltage to mv and place in struct
-            smbus_sbd_data.voltage = (uint16_t)(pCommonBatteryVariables->V_batt*1000);
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   This function will update the fields of the SMBus data that only change with a parameter change
+ *          like the chemistry, cycle count, design capacity, design voltage and serial number.
+ *
+ * @warning The gSMBusLock should be locked.
+ */
+static void updateStaticFields(void)
+{
+    variableTypes_u variable1;
 
-            // convert current to mA and place in struct
-            smbus_sbd_data.current = (uint16_t)((int32_t)(pCommonBatteryVariables->I_batt*1000));
+    // reset the variable first, to make sure a newer change is not missed
+    gStaticFieldsOutdated = false;
 
-            // convert average_current to mA and place in struct
-            smbus_sbd_data.average_current = (uint16_t)((int32_t)(pCommonBatteryVariables->I_batt_avg*1000));
+    // get the battery type
+    if(data_getParameter(BATTERY_TYPE, &variable1.uint8Var, NULL) == NULL)
+    {
+        // set the default value
+        variable1.uint8Var = BATTERY_TYPE_DEFAULT;
 
-            // set both state of charges in %
-            smbus_sbd_data.relative_state_of_charge = pCalcBatteryVariables->s_charge;
-            smbus_sbd_data.absolute_state_of_charge = pCalcBatteryVariables->s_charge;
+        // error output
+        cli_printfError("SMBus ERROR: could not get battery-type!\n");
+    }
 
-            // convert capacity to mAh and place in struct
-            smbus_sbd_data.remaining_capacity = (uint16_t)(pCalcBatteryVariables->A_rem*1000);
+    // limit it
+    if(variable1.uint8Var >= (sizeof(device_chemistry) / sizeof(device_chemistry[0])))
+    {
+        variable1.uint8Var = BATTERY_TYPE_DEFAULT;
+    }
 
-            // convert to mAh and place in struct
-            smbus_sbd_data.full_charge_capacity = (uint16_t)(pCalcBatteryVariables->A_full*1000);
+    // set the chemistry
+    gSmbusSbdData.device_chemistry = device_chemistry[variable1.uint8Var];
 
-            // calculate the time to empty ((Ah/A) * minutes per h)
-            variable1.int32Var = (int32_t)(pCalcBatteryVariables->A_rem / pCommonBatteryVariables->I_batt) * MINUTES_PER_HOUR;
+    // get the cycle count
+    if(data_getParameter(N_CHARGES, &variable1.uint16Var, NULL) == NULL)
+    {
+        // set the default value
+        variable1.uint16Var = N_CHARGES_DEFAULT;
 
-            // limit the value
-            if(variable1.int32Var < 0)
-            {
-                // set to 0
-                variable1.int32Var = 0;
-            }
-            // check if it is larger than the max
-            else if(variable1.int32Var > UINT16_MAX)
-            {
-                // set to the max value
-                variable1.int32Var = UINT16_MAX;
-            }
+        // error output
+        cli_printfError("SMBus ERROR: could not get n-charges!\n");
+    }
 
-            // set the time to empty
-            smbus_sbd_data.run_time_to_empty = (uint16_t)variable1.int32Var;
+    // set the cycle count
+    gSmbusSbdData.cycle_count = variable1.uint16Var;
 
-            // calculate the time to empty ((Ah/A) * minutes per h)
-            variable1.int32Var = (int32_t)(pCalcBatteryVariables->A_rem / pCommonBatteryVariables->I_batt_avg) * MINUTES_PER_HOUR;
+    // get the factory capacity
+    if(data_getParameter(A_FACTORY, &variable1.floatVar, NULL) == NULL)
+    {
+        // set the default value
+        variable1.floatVar = A_FACTORY_DEFAULT;
 
-            // limit the value
-            if(variable1.int32Var < 0)
-            {
-                // set to 0
-                variable1.int32Var = 0;
-            }
-            // check if it is larger than the max
-            else if(variable1.int32Var > UINT16_MAX)
-            {
-                // set to the max value
-                variable1.int32Var = UINT16_MAX;
-            }
+        // error output
+        cli_printfError("SMBus ERROR: could not get a-factory!\n");
+    }
 
-            // set the average run time to empty
-            smbus_sbd_data.average_time_to_empty = (uint16_t)variable1.int32Var;
-            
-            // get the cycle count
-            if(data_getParameter(N_CHARGES, &variable1.uint16Var, NULL) == NULL)
-            {
-                // set the default value
-                variable1.uint16Var = N_CHARGES_DEFAULT;
+    // convert to mAh and place in struct
+    gSmbusSbdData.design_capacity = (uint16_t)(variable1.floatVar*1000);
 
-                // error output
-                cli_printfError("SMBus ERROR: could not get n-charges!\n");
-            }
+    // get the cell ov as design voltage
+    if(data_getParameter(V_CELL_OV, &variable1.floatVar, NULL) == NULL)
+    {
+        // set the default value
+        variable1.floatVar = V_CELL_OV_DEFAULT;
 
-            // set the cycle count
-            smbus_sbd_data.cycle_count = variable1.uint16Var;
+        // error output
+        cli_printfError("SMBus ERROR: could not get v-cell-ov!\n");
+    }
 
-            // convert to mAh and place in struct
-            smbus_sbd_data.design_capacity = (uint16_t)(pCalcBatteryVariables->A_factory*1000);
+    // convert to mv and place in struct
+    gSmbusSbdData.design_voltage = (uint16_t)(variable1.floatVar*1000);
 
-            // get the cell ov as design voltage
-            if(data_getParameter(V_CELL_OV, &variable1.floatVar, NULL) == NULL)
-            {
-                // set the default value
-                variable1.floatVar = V_CELL_OV_DEFAULT;
+    // get the battery ID
+    if(data_getParameter(BATT_ID, &variable1.uint8Var, NULL) == NULL)
+    {
+        // set the default value
+        variable1.uint8Var = BATT_ID_DEFAULT;
 
-                // error output
-                cli_printfError("SMBus ERROR: could not get v-cell-ov!\n");
-            }
+        // error output
+        cli_printfError("SMBus ERROR: could not get batt-id!\n");
+    }
 
-            // convert to mv and place in struct
-            smbus_sbd_data.design_voltage = (uint16_t)(variable1.floatVar*1000);
+    // set the battery ID
+    gSmbusSbdData.serial_number = (uint16_t)variable1.uint8Var;
+}
 
-            // set the battery ID
-            smbus_sbd_data.serial_number = (uint16_t)pCalcBatteryVariables->batt_id;
+/*!
+ * @brief   This function will place a uint16_t in a buffer as little endian
+ *
+ * @param   pBuffer the address to place it
+ * @param   value the value to place
+ */
+static inline void putUint16(uint8_t *pBuffer, uint16_t value)
+{
+    pBuffer[0] = (uint8_t)(value & UINT8_MAX);
+    pBuffer[1] = (uint8_t)(value >> 8);
+}
+
+/*!
+ * @brief   This function will convert a temperature to 0.1 K as used in SMBus 
+ *
+ * @param   temperature the temperature in C
+ *
+ * @return  the temperature in 0.1 K, limited to the uint16_t range
+ */
+static uint16_t toDeciKelvin(float temperature)
+{
+    float deciKelvin = (temperature + KELVIN_TO_CELCIUS) * 10;
+
+    // limit the value
+    if(deciKelvin < 0)
+    {
+        deciKelvin = 0;
+    }
+    else if(deciKelvin > UINT16_MAX)
+    {
+        deciKelvin = UINT16_MAX;
+    }
 
-            // set the cell voltages in mV
-            // first set the minimum 3 cell voltages
-            smbus_sbd_data.cell1_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell1*1000;
-            smbus_sbd_data.cell2_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell2*1000;
-            smbus_sbd_data.cell3_voltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell3*1000;
+    return (uint16_t)deciKelvin;
+}
+
+/*!
+ * @brief   This function will fill the snapshot buffer that is not used by the driver with the measurements
+ *          and set it as manufacturer_data.
+ *
+ * @warning The gSMBusLock should be locked.
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ */
+static void updateSnapshot(commonBatteryVariables_t *pCommonBatteryVariables,
+    calcBatteryVariables_t *pCalcBatteryVariables)
+{
+    uint8_t *pSnapshot = gSnapshot[gActiveSnapshot ^ 1];
+    uint16_t cellVoltage, cellMin = UINT16_MAX, cellMax = 0;
+    uint8_t  sFlags;
+    uint32_t energyUsed;
+    int      bmsFault;
+    int      i;
+
+    // set the version and the sequence number
+    pSnapshot[SMBUS_SNAPSHOT_VERSION_OFFSET]  = SMBUS_SNAPSHOT_VERSION;
+    pSnapshot[SMBUS_SNAPSHOT_SEQUENCE_OFFSET] = ++gSnapshotSequence;
+
+    // set the cell voltages in mV and get the min and max
+    for(i = 0; i < SMBUS_SNAPSHOT_CELLS; i++)
+    {
+        cellVoltage = 0;
 
-            // check what other values it should set and set them
-            switch(pCommonBatteryVariables->N_cells)
+        // check if the cell is used
+        if(i < pCommonBatteryVariables->N_cells)
+        {
+            cellVoltage = (uint16_t)(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] * 1000);
+
+            // check for the min and max
+            if(cellVoltage < cellMin)
+            {
+                cellMin = cellVoltage;
+            }
+            if(cellVoltage > cellMax)
             {
-                case 4:
-                    smbus_sbd_data.cell4_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
-                break;
-                case 5:
-                    smbus_sbd_data.cell4_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
-
-                    smbus_sbd_data.cell5_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell5*1000;
-                break;
-                case 6:
-                    smbus_sbd_data.cell4_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell4*1000;
-                    
-                    smbus_sbd_data.cell5_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell5*1000;
-                    
-                    smbus_sbd_data.cell6_voltage = 
-                    (uint16_t)(pCommonBatteryVariables->V_cellVoltages).value.V_cell6*1000;
-                break;
-                default:
-                break;
+                cellMax = cellVoltage;
             }
         }
 
-        /* Write a prepared smbus_sbd_data_s struct to the SMBus SBD driver.  It needs to be
-         * converted to a constant character buffer and the buffer length has to be
-         * equal to the size of the smbus_sbd_data_s struct.
-         *
-         * Note that this write operation can be performed as often as you like.
-         * The SMBus SBD driver will always provide the most recent data that it received
-         * when it receives a request for battery data.
-         */
+        putUint16(&pSnapshot[SMBUS_SNAPSHOT_CELLS_OFFSET + (i * sizeof(uint16_t))], cellVoltage);
+    }
 
-        variable1.int32Var = write(fd, (const char *)&smbus_sbd_data, sizeof(struct smbus_sbd_data_s));
-        if(variable1.int32Var != sizeof(struct smbus_sbd_data_s))
-        {
-            /* Something went wrong.  You could try to handle the error here, pass
-             * it on to the calling function, or just ignore it.
-             */
+    // check if no cell was used
+    if(cellMin > cellMax)
+    {
+        cellMin = 0;
+    }
 
-            cli_printfError("SMBus ERROR: could not write new data: %d errno: %d\n",
-                variable1.int32Var, errno);
+    // set the min and max cell voltage
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_CELL_MIN_OFFSET], cellMin);
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_CELL_MAX_OFFSET], cellMax);
 
-            //return -1;
+    // get the BMS fault
+    bmsFault = data_getBmsFault();
+    pSnapshot[SMBUS_SNAPSHOT_FAULT_OFFSET] = (bmsFault < 0) ? 0 : (uint8_t)bmsFault;
 
-            variable1.int32Var = -1;
-        }
-        else
-        {
-            variable1.int32Var = 0;
-        }
+    // get the status flags
+    if(data_getParameter(S_FLAGS, &sFlags, NULL) == NULL)
+    {
+        // set the default value
+        sFlags = S_FLAGS_DEFAULT;
 
-        // close the file descriptor
-        close(fd);
+        // error output
+        cli_printfError("SMBus ERROR: could not get s-flags!\n");
     }
-
-    // return to user
-    return variable1.int32Var;
+    pSnapshot[SMBUS_SNAPSHOT_S_FLAGS_OFFSET] = sFlags;
+
+    // set the energy used in mWh
+    energyUsed = (pCalcBatteryVariables->E_used > 0) ? (uint32_t)(pCalcBatteryVariables->E_used * 1000) : 0;
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_E_USED_OFFSET], (uint16_t)(energyUsed & UINT16_MAX));
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_E_USED_OFFSET + sizeof(uint16_t)], (uint16_t)(energyUsed >> 16));
+
+    // set the temperatures in 0.1 K
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_TEMPS_OFFSET + 0], 
+        pCommonBatteryVariables->sensor_enable ? toDeciKelvin(pCommonBatteryVariables->C_batt) : 0);
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_TEMPS_OFFSET + 2], toDeciKelvin(pCommonBatteryVariables->C_AFE));
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_TEMPS_OFFSET + 4], toDeciKelvin(pCommonBatteryVariables->C_T));
+    putUint16(&pSnapshot[SMBUS_SNAPSHOT_TEMPS_OFFSET + 6], toDeciKelvin(pCommonBatteryVariables->C_R));
+
+    // let the driver use this one with the next write
+    gSmbusSbdData.manufacturer_data = pSnapshot;
 }
-
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
@@ -41,19 +41,41 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <time.h>
 
 #include "balancing.h"
 #include "data.h"
 #include "cli.h"
+#include "timeBase.h"
 
 #include "bcc_spiwrapper.h"
 #include "bcc_configuration.h"
+#include "bcc_monitoring.h"
 
 /****************************************************************************
  * Defines
  ****************************************************************************/
 #define RBAL 82 //!< [Ohm] balancing resistor (84 Ohm for the Drone BMS)
 #define MAX_BALANCING_MINUTES 511 //!< the maximum value to set in the balance driver
+#define BALANCE_REFINE_MIN 5 //!< [min] the interval to refine the balance time of a cell with its voltage drop
+#define BALANCE_REFINE_MIN_DROP 0.002 //!< [V] the minimum voltage drop to refine the balance time with
+#define BALANCE_MAX_PLAN_MIN (8 * MAX_BALANCING_MINUTES) //!< [min] the maximum balance time of a cell
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the balance plan of a cell */
+typedef struct
+{
+    uint16_t plannedMin;   //!< [min] the estimated balance time
+    uint16_t startMin;     //!< [min] the start time after the plan is made, to finish with the other cells
+    uint16_t armedMin;     //!< [min] the balance time the cell is armed with, after its start
+    uint16_t refineMin;    //!< [min] the time after its start the balance time was refined the last time
+    uint16_t refMin;       //!< [min] the time after its start the reference voltages are taken
+    bool     refValid;     //!< true if the battery stayed at rest since the reference voltages are taken
+    float    refV;         //!< [V] the cell voltage at the reference
+    float    refExcessV;   //!< [V] the cell voltage above the balance voltage at the reference
+} balancePlan_t;
 
 /****************************************************************************
  * Private Variables
@@ -79,6 +101,15 @@ static uint8_t gBalanceCellEnabled = 0;
 /*! @brief  variable to keep track of how much more minutes (times 511 min) it should run per cell */
 static uint8_t gCellBalanceTimes[6] = {0, 0, 0, 0, 0, 0};
 
+/*! @brief  variable to keep track of which cells wait for their planned start */
+static uint8_t gBalanceCellPending = 0;
+
+/*! @brief  the balance plan of each cell */
+static balancePlan_t gBalancePlan[6];
+
+/*! @brief  the time (timeBase) in us the balance plan was made */
+static uint64_t gBalancePlanUs = 0;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -120,17 +151,40 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
 static int checkBalancing(commonBatteryVariables_t *pCommonBatteryVariables,
     float balanceVoltage);
 
+/*!
+ * @brief   this function will turn on balancing of a cell for the balance minutes
+ *          it sets the first part in the balance timer and the rest in gCellBalanceTimes
+ *
+ * @param   cell the cell index (0 is cell1)
+ * @param   bccCellIndex the BCC index of the cell
+ * @param   balanceMin the minutes to balance
+ * 
+ * @return  the status of the balance timer write
+ */
+static bcc_status_t armCellBalancing(int cell, uint8_t bccCellIndex, uint16_t balanceMin);
+
+/*!
+ * @brief   this function will get the minutes since the balance plan was made
+ * 
+ * @return  the minutes since the balance plan
+ */
+static uint16_t getBalancePlanMinutes(void);
+
 /*
- * @brief   This function is used to check if balancing is done for the specific BCC index
+ * @brief   This function is used to check if balancing is done for the BCC indexes of a device
+ * @note    The CBx_CFG registers of all indexes are read in one burst if that needs less SPI frames
+ *          than reading them one by one (each read is 1 frame more than the amount of registers)
  *
  * @param   drvConfig the address the BCC driver configuration
- * @param   bccIndex index of the BCC cell (not 2 or 3 with a 3 cell battery): cells: 1, 2, 3, ... -> 0, 1, .. 5 
- * @param   done address of the variable to become true if balancing is done.
+ * @param   cid the cluster ID of the device
+ * @param   bccIndexMask the bits of the BCC indexes to check (not 2 or 3 with a 3 cell battery): 
+ *          cells: 1, 2, 3, ... -> bit 0, 1, .. 5 
+ * @param   doneMask address of the variable to become the bits of the indexes of which balancing is done.
  *
  * @return  0 if succesfull, otherwise it will indicate the error
  */
-static int checkBalancingCellDone(bcc_drv_config_t* const drvConfig, 
-    uint8_t bccIndex, bool *done);
+static int checkBalancingCellsDone(bcc_drv_config_t* const drvConfig, bcc_cid_t cid,
+    uint8_t bccIndexMask, uint8_t *doneMask);
 
 /****************************************************************************
  * Public Functions
@@ -416,8 +470,9 @@ static balanceState_t turnOffBalancing(void)
                 returnValue = BALANCE_ERROR;
             }
 
-            // clear the bit in the balancing variable 
+            // clear the bit in the balancing variables
             gBalanceCellEnabled &= ~(1<<i);
+            gBalanceCellPending &= ~(1<<i);
 
             // reset the amout of balance times
             gCellBalanceTimes[i] = 0;
@@ -445,9 +500,11 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
     float dischargeVoltage)
 {
     int i, bccCellIndex, returnValue = 0;
-    uint8_t cellMarginMv;
-    uint16_t balanceMin;
-    float ocvSlope;
+    uint8_t cellMarginMv, balanceCurrentmA;
+    uint8_t batteryType;
+    uint16_t planMin = 0;
+    float balanceMin, balanceCurrent;
+    float ocvSlope, aFull, targetSoC, cellSoC;
     bcc_status_t bccStatus;
 
     // calculate for which cells the cell balance needs to be on
@@ -470,6 +527,36 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
         returnValue |= -1;
     }
 
+    // get the battery type
+    if(data_getParameter(BATTERY_TYPE, &batteryType, NULL) == NULL)
+    {
+        cli_printfError("Balancing ERROR: getting battery type went wrong!\n");
+        batteryType = BATTERY_TYPE_DEFAULT;
+        // return error
+        returnValue |= -1;
+    }
+
+    // get the full charge capacity
+    if(data_getParameter(A_FULL, &aFull, NULL) == NULL)
+    {
+        cli_printfError("Balancing ERROR: getting a-full went wrong!\n");
+        aFull = 0;
+        // return error
+        returnValue |= -1;
+    }
+
+    // get the balance current
+    if(data_getParameter(I_BAL, &balanceCurrentmA, NULL) == NULL)
+    {
+        cli_printfError("Balancing ERROR: getting i-bal went wrong!\n");
+        balanceCurrentmA = I_BAL_DEFAULT;
+        // return error
+        returnValue |= -1;
+    }
+
+    // get the state of charge to balance to from the OCV surface at the battery temperature
+    targetSoC = bcc_monitoring_getOcvSoC(batteryType, dischargeVoltage, pCommonBatteryVariables->C_batt);
+
     // turn off the driver
     bccStatus = bcc_spiwrapper_BCC_CB_Enable(gPBccDrvConfig, BCC_CID_DEV1, false);
 
@@ -482,26 +569,16 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
         returnValue |= -1;
     }
 
-    // reset the variable
+    // reset the variables
     gBalanceCellEnabled = 0;
+    gBalanceCellPending = 0;
 
-    // check for which cell it needs to do this
+    // estimate the balance time of each cell
     for(i = 0; i < pCommonBatteryVariables->N_cells; i++)
     {
-        // reset the amout of balance times
+        // reset the amout of balance times and the plan
         gCellBalanceTimes[i] = 0;
-
-        // set the bcc index
-        if(i >= 2)
-        {
-            // calculate the BCC pin index
-            bccCellIndex = (6-pCommonBatteryVariables->N_cells) + i;
-        }
-        else
-        {
-            // it is the first 2 cells
-            bccCellIndex = i;
-        }
+        gBalancePlan[i].plannedMin = 0;
 
         // output equation to the user
         cli_printf("Balancing will be enabled for cell%d if %.3f > %.3f\n", i+1, 
@@ -512,26 +589,81 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
         if(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] > 
             (dischargeVoltage+((float)cellMarginMv/1000)))
         {
-            // calculate the CB timer
-            balanceMin = 
-                ((pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] - dischargeVoltage)*RBAL) / 
-                (pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] * ocvSlope / 1000);
+            // get the state of charge of the cell from the OCV surface at the battery temperature
+            cellSoC = bcc_monitoring_getOcvSoC(batteryType, 
+                pCommonBatteryVariables->V_cellVoltages.V_cellArr[i], pCommonBatteryVariables->C_batt);
 
-            cli_printf("Estimated cell%d balance minutes: %dmin\n", i+1, balanceMin);
+            // get the balance current, use the balance resistor if i-bal is not set
+            balanceCurrent = balanceCurrentmA ? ((float)balanceCurrentmA / 1000) : 
+                (pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] / RBAL);
 
-            // reduce the balance minutes while it is larger than the max that can be set
-            while(balanceMin > MAX_BALANCING_MINUTES)
+            // calculate the CB timer with the charge to discharge [A.min] and the balance current [A]
+            if((cellSoC > targetSoC) && (aFull > 0))
+            {
+                balanceMin = (((cellSoC - targetSoC) / 100) * aFull * 60) / balanceCurrent;
+            }
+            // use the OCV slope if there is no charge difference from the OCV surface
+            else
             {
-                // decrease balanceMin with MAX_BALANCING_MINUTES 
-                balanceMin -= MAX_BALANCING_MINUTES;
+                balanceMin = 
+                    ((pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] - dischargeVoltage) * 1000 / 
+                    ocvSlope) / balanceCurrent;
+            }
 
-                // increase the amount of times for this cell
-                gCellBalanceTimes[i]++;
+            // limit it and make sure it is at least 1 minute
+            if(balanceMin > BALANCE_MAX_PLAN_MIN)
+            {
+                balanceMin = BALANCE_MAX_PLAN_MIN;
             }
+            else if(balanceMin < 1)
+            {
+                balanceMin = 1;
+            }
+
+            gBalancePlan[i].plannedMin = (uint16_t)balanceMin;
+
+            cli_printf("Estimated cell%d balance minutes: %dmin\n", i+1, gBalancePlan[i].plannedMin);
 
+            // the longest balance time is the time of the plan
+            if(gBalancePlan[i].plannedMin > planMin)
+            {
+                planMin = gBalancePlan[i].plannedMin;
+            }
+        }
+    }
+
+    // save the start of the plan
+    gBalancePlanUs = timeBase_getUs();
+
+    // schedule the cells so they finish together, the cells with the longest time start now
+    for(i = 0; i < pCommonBatteryVariables->N_cells; i++)
+    {
+        // set the bcc index
+        if(i >= 2)
+        {
+            // calculate the BCC pin index
+            bccCellIndex = (6-pCommonBatteryVariables->N_cells) + i;
+        }
+        else
+        {
+            // it is the first 2 cells
+            bccCellIndex = i;
+        }
+
+        // check if this cell needs to be balanced
+        if(gBalancePlan[i].plannedMin)
+        {
+            gBalancePlan[i].startMin     = planMin - gBalancePlan[i].plannedMin;
+            gBalancePlan[i].armedMin     = gBalancePlan[i].plannedMin;
+            gBalancePlan[i].refineMin    = 0;
+            gBalancePlan[i].refValid     = false;
+        }
+
+        // check if the CB driver should be on for this cell now
+        if(gBalancePlan[i].plannedMin && !gBalancePlan[i].startMin)
+        {
             // write the balance cell register to turn balancing on for this cell
-            bccStatus = bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, BCC_CID_DEV1, 
-                bccCellIndex, true, balanceMin);
+            bccStatus = armCellBalancing(i, bccCellIndex, gBalancePlan[i].plannedMin);
             
             // check for errors
             if(bccStatus != BCC_STATUS_SUCCESS)
@@ -559,6 +691,14 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
                 // return error
                 returnValue |= -1;
             }
+
+            // check if it starts later
+            if(gBalancePlan[i].plannedMin)
+            {
+                cli_printf("Cell%d balancing starts in %dmin\n", i+1, gBalancePlan[i].startMin);
+
+                gBalanceCellPending |= (1<<i);
+            }
         }
     }
 
@@ -622,100 +762,258 @@ static int calculateAndEnableBalance(commonBatteryVariables_t *pCommonBatteryVar
 static int checkBalancing(commonBatteryVariables_t *pCommonBatteryVariables,
     float balanceVoltage)
 {
-    int i, bccCellIndex, returnValue = 0;
-    bool balancingDone;
+    int i, returnValue = 0;
+    uint8_t bccCellIndex[6], bccIndexMask = 0, doneMask = 0;
+    uint8_t rearmMask = 0, turnOffMask = 0, armMask = 0;
+    uint8_t sleepCurrentmA;
+    uint16_t armMin[6], planMinutes, cellMinutes;
+    float excessV, dropV, predictedMin;
+    bool atRest;
     bcc_status_t bccStatus;
 
-    // check if balancing is active
-    if(gBalanceCellEnabled)
+    // check if balancing is active or planned
+    if(gBalanceCellEnabled | gBalanceCellPending)
     {
-        // go through each ell
+        // get the sleep current to check if the battery is at rest
+        if(data_getParameter(I_SLEEP_OC, &sleepCurrentmA, NULL) == NULL)
+        {
+            cli_printfError("Balancing ERROR: getting sleep current went wrong!\n");
+            sleepCurrentmA = I_SLEEP_OC_DEFAULT;
+            // return error
+            returnValue |= -1;
+        }
+
+        // only at rest the voltage drop of a cell comes from its own balancing
+        // with a (charge) current all cells move, including the lowest cell it is balanced to
+        atRest = ((pCommonBatteryVariables->I_batt_10s_avg * 1000) < sleepCurrentmA) && 
+            ((pCommonBatteryVariables->I_batt_10s_avg * 1000) > -sleepCurrentmA);
+
+        // get the minutes since the plan was made
+        planMinutes = getBalancePlanMinutes();
+
+        // map the enabled cells (1, 2, 3, ...) to the BCC cells (1, 2, ..., 6) 
         for(i = 0; i < 6; i++)
         {
+            if(i >= 2)
+            {
+                // calculate the BCC pin index
+                bccCellIndex[i] = (6-pCommonBatteryVariables->N_cells) + i;
+            }
+            else
+            {
+                // it is the first 2 cells
+                bccCellIndex[i] = i;
+            }
+
             // check if balancing is enabled
             if(gBalanceCellEnabled & (1<<i))
             {
-                // map the cells (1, 2, 3, ...) to the BCC cells (1, 2, ..., 6) 
-                if(i >= 2)
+                bccIndexMask |= (1 << bccCellIndex[i]);
+            }
+        }
+
+        // check if the balance time has timed out for all the enabled cells at once
+        if(bccIndexMask && checkBalancingCellsDone(gPBccDrvConfig, BCC_CID_DEV1, bccIndexMask, &doneMask))
+        {
+            cli_printfError("Balancing ERROR: could not check if balancing is done\n");
+            cli_printf("Setting balancing to be done for the cells\n");
+            doneMask = bccIndexMask;
+            // return error
+            returnValue |= -1;
+        }
+
+        // go through each cell to evaluate it
+        for(i = 0; i < 6; i++)
+        {
+            // check if the planned start of the cell is reached
+            if((gBalanceCellPending & (1<<i)) && (planMinutes >= gBalancePlan[i].startMin))
+            {
+                // clear the bit in the variable
+                gBalanceCellPending &= ~(1<<i);
+
+                // calculate the voltage to discharge
+                excessV = pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] - balanceVoltage;
+
+                // check if it still needs to be balanced
+                if(excessV > 0)
                 {
-                    // calculate the BCC pin index
-                    bccCellIndex = (6-pCommonBatteryVariables->N_cells) + i;
+                    // output to the user
+                    cli_printf("Starting planned balancing for cell%d for %dmin\n", i+1, 
+                        gBalancePlan[i].plannedMin);
+
+                    // start the cell, the reference to refine its balance time with is taken at rest
+                    gBalancePlan[i].armedMin     = gBalancePlan[i].plannedMin;
+                    gBalancePlan[i].refineMin    = 0;
+                    gBalancePlan[i].refValid     = false;
+
+                    // turn it on after the evaluation
+                    armMask |= (1 << i);
+                    armMin[i] = gBalancePlan[i].plannedMin;
+
+                    // set the bit in the variable
+                    gBalanceCellEnabled |= (1<<i);
                 }
                 else
                 {
-                    // it is the first 2 cells
-                    bccCellIndex = i;
+                    // output to the user
+                    cli_printf("Planned balancing not needed anymore for cell%d\n", i+1);
                 }
 
-                // check if the balance time has timed out
-                if(checkBalancingCellDone(gPBccDrvConfig, bccCellIndex, &balancingDone))
+                continue;
+            }
+
+            // check if balancing is enabled
+            if(!(gBalanceCellEnabled & (1<<i)))
+            {
+                continue;
+            }
+
+            // check if balancing time is done
+            if(doneMask & (1 << bccCellIndex[i]))
+            {
+                // check if the balancing needs to be on for at least the maximum time again
+                if(gCellBalanceTimes[i])
                 {
-                    cli_printfError("Balancing ERROR: could not check if balancing is done\n");
-                    cli_printf("Setting balancing to be done for cell%d\n", i+1);
-                    balancingDone = true;
-                    // return error
-                    returnValue |= -1;
-                }
+                    // re-arm it after the evaluation
+                    rearmMask |= (1 << i);
 
-                // check if balancing time is done
-                if(balancingDone)
+                    // decrease the number of cell balance times
+                    gCellBalanceTimes[i]--;
+                }
+                else
                 {
-                    // check if the balancing needs to be on for at least the maximum time again
-                    if(gCellBalanceTimes[i])
-                    {
-                        // turn on cell balancing for MAX_BALANCING_MINUTES for that cell
-                        bccStatus = bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, 
-                            BCC_CID_DEV1, bccCellIndex, true, MAX_BALANCING_MINUTES);
+                    // output to the user
+                    cli_printf("Balancing done for cell%d\n", i+1);
 
-                        if(bccStatus != BCC_STATUS_SUCCESS)
-                        {
-                            cli_printfError("Balancing ERROR: couldnt turn on cell%d balance: %d\n", 
-                                i+1, bccStatus);
-                            // return error
-                            returnValue |= -1;
-                        }
+                    // clear the bit in the variable
+                    gBalanceCellEnabled = gBalanceCellEnabled & ~(1<<i);
+                }
+            }
+            // if the balance timer is not done
+            else
+            {
+                // check if the cell voltage is not higher than the to discharge to voltage
+                if(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] <= balanceVoltage)
+                {
+                    // output to the user
+                    cli_printf("Balancing done for cell%d due to voltage reached\n", i+1);
 
-                        // decrease the number of cell balance times
-                        gCellBalanceTimes[i]--;
-                    }
-                    else
-                    {
-                        // output to the user
-                        cli_printf("Balancing done for cell%d\n", i+1);
+                    // clear the bit in the variable
+                    gBalanceCellEnabled = gBalanceCellEnabled & ~(1<<i);
 
-                        // clear the bit in the variable
-                        gBalanceCellEnabled = gBalanceCellEnabled & ~(1<<i);
-                    }
+                    // turn it off after the evaluation
+                    turnOffMask |= (1 << i);
                 }
-                // if the balance timer is not done
                 else
                 {
-                    // check if the cell voltage is not higher than the to discharge to voltage
-                    if(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] <= balanceVoltage)
+                    // get the minutes since the start of this cell
+                    cellMinutes = planMinutes - gBalancePlan[i].startMin;
+
+                    // check if the battery is not at rest
+                    if(!atRest)
+                    {
+                        // the reference can't be used anymore
+                        gBalancePlan[i].refValid = false;
+                    }
+                    // check if the reference needs to be taken
+                    else if(!gBalancePlan[i].refValid)
+                    {
+                        // save the voltages at rest to refine the balance time of this cell with
+                        gBalancePlan[i].refMin     = cellMinutes;
+                        gBalancePlan[i].refineMin  = cellMinutes;
+                        gBalancePlan[i].refV       = pCommonBatteryVariables->V_cellVoltages.V_cellArr[i];
+                        gBalancePlan[i].refExcessV = gBalancePlan[i].refV - balanceVoltage;
+                        gBalancePlan[i].refValid   = true;
+                    }
+                    // check if the balance time of this cell should be refined 
+                    else if(cellMinutes >= (gBalancePlan[i].refineMin + BALANCE_REFINE_MIN))
                     {
-                        // output to the user
-                        cli_printf("Balancing done for cell%d due to voltage reached\n", i+1);
+                        gBalancePlan[i].refineMin = cellMinutes;
 
-                        // clear the bit in the variable
-                        gBalanceCellEnabled = gBalanceCellEnabled & ~(1<<i);
+                        // calculate the voltage drop of this cell since the reference
+                        dropV = gBalancePlan[i].refV - pCommonBatteryVariables->V_cellVoltages.V_cellArr[i];
 
-                        // turn off cell balancing for that cell
-                        bccStatus = bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, 
-                            BCC_CID_DEV1, bccCellIndex, false, 0xFF);
-                        if(bccStatus != BCC_STATUS_SUCCESS)
+                        // check if the drop can be used to predict the total balance time
+                        if(dropV >= BALANCE_REFINE_MIN_DROP)
                         {
-                            cli_printfError("Balancing ERROR: could not set cell CB %d\n", bccStatus);
-                            // return error
-                            returnValue |= -1;
+                            // predict the total balance time with the measured voltage drop rate
+                            predictedMin = gBalancePlan[i].refMin + 
+                                (float)(cellMinutes - gBalancePlan[i].refMin) * 
+                                gBalancePlan[i].refExcessV / dropV;
+
+                            // limit it
+                            if(predictedMin > BALANCE_MAX_PLAN_MIN)
+                            {
+                                predictedMin = BALANCE_MAX_PLAN_MIN;
+                            }
+
+                            // extend the timer if it would stop more than 10% too early
+                            // a timer that is too long is stopped with the voltage
+                            if(predictedMin > (gBalancePlan[i].armedMin * 1.1))
+                            {
+                                // output to the user
+                                cli_printf("Refining cell%d balance time from %dmin to %dmin\n", i+1, 
+                                    gBalancePlan[i].armedMin, (uint16_t)predictedMin);
+
+                                gBalancePlan[i].armedMin = (uint16_t)predictedMin;
+
+                                // re-arm it with the rest of the time after the evaluation
+                                armMask |= (1 << i);
+                                armMin[i] = gBalancePlan[i].armedMin - cellMinutes;
+                            }
                         }
                     }
                 }
             }
         }
+
+        // write the cell balance registers of the cells that changed
+        for(i = 0; i < 6; i++)
+        {
+            if(armMask & (1 << i))
+            {
+                // turn on cell balancing for the (rest of the) planned time for that cell
+                bccStatus = armCellBalancing(i, bccCellIndex[i], armMin[i]);
+
+                if(bccStatus != BCC_STATUS_SUCCESS)
+                {
+                    cli_printfError("Balancing ERROR: couldnt turn on cell%d balance: %d\n", 
+                        i+1, bccStatus);
+                    // return error
+                    returnValue |= -1;
+                }
+            }
+            else if(rearmMask & (1 << i))
+            {
+                // turn on cell balancing for MAX_BALANCING_MINUTES for that cell
+                bccStatus = bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, 
+                    BCC_CID_DEV1, bccCellIndex[i], true, MAX_BALANCING_MINUTES);
+
+                if(bccStatus != BCC_STATUS_SUCCESS)
+                {
+                    cli_printfError("Balancing ERROR: couldnt turn on cell%d balance: %d\n", 
+                        i+1, bccStatus);
+                    // return error
+                    returnValue |= -1;
+                }
+            }
+            else if(turnOffMask & (1 << i))
+            {
+                // turn off cell balancing for that cell
+                bccStatus = bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, 
+                    BCC_CID_DEV1, bccCellIndex[i], false, 0xFF);
+                if(bccStatus != BCC_STATUS_SUCCESS)
+                {
+                    cli_printfError("Balancing ERROR: could not set cell CB %d\n", bccStatus);
+                    // return error
+                    returnValue |= -1;
+                }
+            }
+        }
     }
 
-    // check if nothing is being balanced
-    if(!gBalanceCellEnabled)
+    // check if nothing is being balanced or waiting to be balanced
+    if(!(gBalanceCellEnabled | gBalanceCellPending))
     {
         // turn off the cell balance driver
         bccStatus = bcc_spiwrapper_BCC_CB_Enable(gPBccDrvConfig, BCC_CID_DEV1, false);
@@ -734,50 +1032,151 @@ static int checkBalancing(commonBatteryVariables_t *pCommonBatteryVariables,
     return returnValue;
 }
 
+/*!
+ * @brief   this function will turn on balancing of a cell for the balance minutes
+ *          it sets the first part in the balance timer and the rest in gCellBalanceTimes
+ *
+ * @param   cell the cell index (0 is cell1)
+ * @param   bccCellIndex the BCC index of the cell
+ * @param   balanceMin the minutes to balance
+ * 
+ * @return  the status of the balance timer write
+ */
+static bcc_status_t armCellBalancing(int cell, uint8_t bccCellIndex, uint16_t balanceMin)
+{
+    uint16_t timerMin = balanceMin;
+
+    // make sure it is at least 1 minute
+    if(!timerMin)
+    {
+        timerMin = 1;
+    }
+
+    // reset the amount of extra balance times
+    gCellBalanceTimes[cell] = 0;
+
+    // check if it fits in the balance timer
+    if(timerMin > MAX_BALANCING_MINUTES)
+    {
+        // the rest is set in the timer with the amount of times it is done
+        gCellBalanceTimes[cell] = (timerMin - 1) / MAX_BALANCING_MINUTES;
+        timerMin = timerMin - (gCellBalanceTimes[cell] * MAX_BALANCING_MINUTES);
+    }
+
+    // write the balance cell register to turn balancing on for this cell
+    return bcc_spiwrapper_BCC_CB_SetIndividual(gPBccDrvConfig, BCC_CID_DEV1, bccCellIndex, true, timerMin);
+}
+
+/*!
+ * @brief   this function will get the minutes since the balance plan was made
+ * 
+ * @return  the minutes since the balance plan
+ */
+static uint16_t getBalancePlanMinutes(void)
+{
+    uint64_t planSeconds;
+
+    // calculate the seconds since the plan
+    planSeconds = timeBase_getElapsedUs(gBalancePlanUs) / TIME_BASE_US_PER_S;
+
+    // limit it
+    if(planSeconds > (BALANCE_MAX_PLAN_MIN * 60))
+    {
+        planSeconds = BALANCE_MAX_PLAN_MIN * 60;
+    }
+
+    return (uint16_t)(planSeconds / 60);
+}
+
 /*
- * @brief   This function is used to check if balancing is done for the specific BCC index
+ * @brief   This function is used to check if balancing is done for the BCC indexes of a device
+ * @note    The CBx_CFG registers of all indexes are read in one burst if that needs less SPI frames
+ *          than reading them one by one (each read is 1 frame more than the amount of registers)
  *
  * @param   drvConfig the address the BCC driver configuration
- * @param   bccIndex index of the BCC cell (not 2 or 3 with a 3 cell battery): cells: 1, 2, 3, ... -> 0, 1, .. 5 
- * @param   done address of the variable to become true if balancing is done.
+ * @param   cid the cluster ID of the device
+ * @param   bccIndexMask the bits of the BCC indexes to check (not 2 or 3 with a 3 cell battery): 
+ *          cells: 1, 2, 3, ... -> bit 0, 1, .. 5 
+ * @param   doneMask address of the variable to become the bits of the indexes of which balancing is done.
  *
  * @return  0 if succesfull, otherwise it will indicate the error
  */
-static int checkBalancingCellDone(bcc_drv_config_t* const drvConfig, 
-    uint8_t bccIndex, bool *done)
+static int checkBalancingCellsDone(bcc_drv_config_t* const drvConfig, bcc_cid_t cid,
+    uint8_t bccIndexMask, uint8_t *doneMask)
 {
     int retValue = -1;
-    bcc_status_t error;
-    uint16_t retReg = 0;
+    bcc_status_t error = BCC_STATUS_SUCCESS;
+    uint16_t retReg[6];
+    uint8_t bccIndex, firstIndex = 6, lastIndex = 0, amount = 0;
 
     // check for null pointer
-    DEBUGASSERT(done != NULL);
+    DEBUGASSERT(doneMask != NULL);
 
-    // check if bccIndex is not too high
-    if(bccIndex > 5)
+    // check if the bccIndexMask is not too high
+    if(bccIndexMask >= (1 << 6))
     {
-        cli_printfError("checkBalancingCellDone ERROR: bccIndex > 5!\n");
+        cli_printfError("checkBalancingCellsDone ERROR: bccIndex > 5!\n");
 
         return retValue;
     }
 
-    // read the register
-    error = bcc_spiwrapper_BCC_Reg_Read(drvConfig, BCC_CID_DEV1, (BCC_REG_CB1_CFG_ADDR + bccIndex),
-        1, &retReg);
+    *doneMask = 0;
 
-    // make the return value
-    retValue = error;
+    // get the range and the amount of indexes to read
+    for(bccIndex = 0; bccIndex < 6; bccIndex++)
+    {
+        if(bccIndexMask & (1 << bccIndex))
+        {
+            if(bccIndex < firstIndex)
+            {
+                firstIndex = bccIndex;
+            }
 
-    // check if balancing is done
-    if(!(retReg & BCC_R_CB_STS_MASK))
+            lastIndex = bccIndex;
+            amount++;
+        }
+    }
+
+    // check if there is nothing to read
+    if(!amount)
     {
-        // write the variable
-        *done = true;
+        return 0;
+    }
+
+    // check if a burst read of the range needs less frames than the single reads
+    if((lastIndex - firstIndex + 2) <= (amount * 2))
+    {
+        // read the registers in one burst
+        error = bcc_spiwrapper_BCC_Reg_Read(drvConfig, cid, (BCC_REG_CB1_CFG_ADDR + firstIndex),
+            (lastIndex - firstIndex + 1), &retReg[firstIndex]);
     }
     else
     {
-        // write the variable
-        *done = false;
+        // read the registers one by one
+        for(bccIndex = firstIndex; (bccIndex <= lastIndex) && (error == BCC_STATUS_SUCCESS); bccIndex++)
+        {
+            if(bccIndexMask & (1 << bccIndex))
+            {
+                error = bcc_spiwrapper_BCC_Reg_Read(drvConfig, cid, (BCC_REG_CB1_CFG_ADDR + bccIndex),
+                    1, &retReg[bccIndex]);
+            }
+        }
+    }
+
+    // make the return value
+    retValue = error;
+
+    // check if balancing is done
+    if(error == BCC_STATUS_SUCCESS)
+    {
+        for(bccIndex = firstIndex; bccIndex <= lastIndex; bccIndex++)
+        {
+            if((bccIndexMask & (1 << bccIndex)) && !(retReg[bccIndex] & BCC_R_CB_STS_MASK))
+            {
+                // set the bit
+                *doneMask |= (1 << bccIndex);
+            }
+        }
     }
 
     // return
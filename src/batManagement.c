@@ -54,6 +54,11 @@
 
 #include "gpio.h"
 #include "balancing.h"
+#include "measStats.h"
+#include "wakeSched.h"
+#include "supervisor.h"
+#include "memMon.h"
+#include "timeBase.h"
 
 #include "bcc.h"
 #include "bcc_spiwrapper.h"
@@ -76,8 +81,12 @@
 
 #define RBAL                 82   //!< [Ohm] balancing resistor (84 Ohm for the Drone BMS)
 #define BAT_MANAG_PRIORITY   120  //!< the priority for the bat management task
-#define BAT_MANAG_STACK_SIZE 2048 //!< the needed stack size for the bat management task
+#define BAT_MANAG_STACK_SIZE 2048 + 256 //!< the needed stack size for the bat management task, with a stream frame
 #define MEASURE_CURRENT_US   3000
+#define CURRENT_MON_PRIORITY   125  //!< the priority for the current monitor task, above the bat management task
+#define CURRENT_MON_STACK_SIZE 1536 //!< the needed stack size for the current monitor task
+#define CURRENT_RING_SIZE      32   //!< the amount of current samples in the ring, power of 2
+#define BATMANAG_SUPERVISOR_MARGIN_MS 2000 //!< [ms] the time a cycle may take more than the measurement cycle
 #define MAX_SEC              0xFFFFFFFF
 
 /****************************************************************************
@@ -100,6 +109,14 @@ typedef enum
     BMS_SW_PEAK_OVER_CURRENT =
         (1 << BMS_FAULT_PEAK_OVER_CURRENT_BIT_SHIFT), /*!< there is a SW peak overcurrent */
 } BMSSWFault_t;
+
+/*! @brief  a current sample of the current monitor task */
+typedef struct
+{
+    uint32_t timeUs;   //!< the time the conversion was started in us (wraps)
+    float    currentA; //!< the battery current in A
+    uint16_t spiUs;    //!< the time the conversion and read took in us
+} currentSample_t;
 /****************************************************************************
  * private data
  ****************************************************************************/
@@ -122,6 +139,8 @@ static sem_t gBatManagementSem;
 static sem_t gSkipBatManagementWaitSem;
 /*! @brief  semaphore for the continues charging task*/
 static sem_t gChargeSem;
+/*! @brief  semaphore to start and stop the current monitor task*/
+static sem_t gCurrentMonitorSem;
 
 /*! @brief  mutex for controlling the gate */
 static pthread_mutex_t gGateLock;
@@ -133,12 +152,16 @@ static pthread_mutex_t gEndOfChargeValueMutex;
 static pthread_mutex_t gChargeToStorageVarMutex;
 /*! @brief  mutex for the chargingstate variable */
 static pthread_mutex_t chargingStateMutex;
+/*! @brief  mutex for the timing statistics */
+static pthread_mutex_t gTimingMutex;
+/*! @brief  mutex for starting and stopping the current monitor task */
+static pthread_mutex_t gCurrentMonitorMutex;
 
 /*! @brief  Variable to set the measurement cycle time */
 static uint32_t gMeasCycleTime = 1000;
 
-/*! @brief  Variable to set the target time for the bat manag task to sleep */
-static struct timespec gTargetTime;
+/*! @brief  Variable to set the target time (timeBase) in us for the bat manag task to sleep */
+static uint64_t gTargetUs = 0;
 
 /*! @brief  variable to slow down the current measurement to t-meas
             can be used to reduce MCU load */
@@ -157,21 +180,36 @@ ct_filter_t g_ctFilterComp;
 /*! @brief  [-]         BCC I-sense filter configuration data */
 isense_filter_t g_isenseFilterComp;
 
-/*! @brief  [-]         BCC NTC configuration data */
-ntc_config_t g_ntcConfig;
-
 /*! @brief  variable to keep track of the lowest cell voltage */
 float gLowestCellVoltage = V_CELL_OV_DEFAULT;
 
 /*! @brief  Variable to keep track of a sw defined fault using the BMSSWFault_t enum */
 uint32_t gSWFaultVariable = 0;
 
+/*! @brief  the current sample ring, written by the current monitor task and read by the bat management task
+            the head is only written by the current monitor task and the tail only by the bat management task */
+static volatile currentSample_t gCurrentRing[CURRENT_RING_SIZE];
+static volatile uint32_t        gCurrentRingHead     = 0;
+static volatile uint32_t        gCurrentRingTail     = 0;
+static volatile uint32_t        gCurrentRingOverruns = 0;
+
+/*! @brief  true if the bat management task is woken to measure everything and not for a new current sample */
+static volatile bool gMeasureEverythingNow = false;
+
+/*! @brief  true if the bat management task is on, the current monitor task runs if this is on and the
+            current measurements are not slowed down, protected by gCurrentMonitorMutex */
+static bool gCurrentMonitorRequested = false;
+static bool gCurrentMonitorOn        = false;
+
+/*! @brief  the timing statistics of the measurement loop, protected by gTimingMutex */
+static batManagTiming_t gTiming = { .periodMinUs = UINT32_MAX, .jitterAlarmUs = BAT_MANAG_JITTER_ALARM_US_DEFAULT };
+
 /****************************************************************************
  * private Functions
  ****************************************************************************/
 /*!
- * @brief   function to do the meanual measurements, calculate current
- *          and if needed it will read the rest and do the calculations
+ * @brief   function to do the meanual measurements every t-meas, it will read everything and do the
+ *          calculations. In between it will handle the current samples of the current monitor task.
  *          Then it will check the new values if there is anything wrong it
  *          will trigger the main to react on it.
  *          Afterwards it will check balancing and trigger to update measurements.
@@ -181,6 +219,40 @@ uint32_t gSWFaultVariable = 0;
  */
 static int batManagement_batManagTaskFunc(int argc, char *argv[]);
 
+/*!
+ * @brief   function of the current monitor task, it will only measure the current on a fixed period
+ *          of MEASURE_CURRENT_US, put it in the current sample ring and wake the bat management task
+ *
+ * @param   argc the amount of arguments there are in argv (if the last argument is NULL!)
+ * @param   argv a character pointer array with the arguments, first is the taskname than the arguments
+ */
+static int batManagement_currentMonTaskFunc(int argc, char *argv[]);
+
+/*!
+ * @brief   function to handle the new samples of the current sample ring
+ *          it will check each sample for a peak overcurrent, set the last current
+ *          and check for current transitions
+ *
+ * @param   pCalcUs address of the variable to become the time the checks took in us
+ * @param   pCallbackUs address of the variable to become the time the callback took in us
+ */
+static void processCurrentSamples(int *pCalcUs, int *pCallbackUs);
+
+/*!
+ * @brief   function to start or stop the current monitor task
+ *          it runs if the bat management task is on and the current measurements are not slowed down
+ */
+static void updateCurrentMonitor(void);
+
+/*!
+ * @brief   function to add a sample to a timing histogram and its maximum
+ *
+ * @param   pHist the histogram with BAT_MANAG_TIMING_BINS bins
+ * @param   pMax address of the maximum of the histogram
+ * @param   timeUs the sample in us, negative values are handled as 0
+ */
+static void addTimingSample(uint32_t *pHist, uint32_t *pMax, int timeUs);
+
 /*
  * @brief   This function checks the current for peak over current.
  *          If there is an overcurrent it will set the BMS_SW_PEAK_OVER_CURRENT
@@ -288,6 +360,8 @@ int batManagement_initialize(swMeasuredFaultCallbackFunction p_swMeasuredFaultCa
     pthread_mutex_init(&gEndOfChargeValueMutex, NULL);
     pthread_mutex_init(&gChargeToStorageVarMutex, NULL);
     pthread_mutex_init(&chargingStateMutex, NULL);
+    pthread_mutex_init(&gTimingMutex, NULL);
+    pthread_mutex_init(&gCurrentMonitorMutex, NULL);
 
     // initialize the monitoring part
     error = bcc_monitoring_initialize();
@@ -341,6 +415,18 @@ int batManagement_initialize(swMeasuredFaultCallbackFunction p_swMeasuredFaultCa
         sem_setprotocol(&gChargeSem, SEM_PRIO_NONE);
     }
 
+    // initialize the semaphore
+    error = sem_init(&gCurrentMonitorSem, 0, 0);
+    if(error)
+    {
+        // output to user
+        cli_printfError("batManagement ERROR: failed to initialze current monitor sem! error: %d\n", error);
+    }
+    else
+    {
+        sem_setprotocol(&gCurrentMonitorSem, SEM_PRIO_NONE);
+    }
+
     // create the task
     lvRetValue = task_create(
         "batManag", BAT_MANAG_PRIORITY, BAT_MANAG_STACK_SIZE, batManagement_batManagTaskFunc, NULL);
@@ -353,6 +439,24 @@ int batManagement_initialize(swMeasuredFaultCallbackFunction p_swMeasuredFaultCa
         return lvRetValue;
     }
 
+    // monitor its stack
+    memMon_registerTask("batManag", "BAT_MANAG_STACK_SIZE", lvRetValue, BAT_MANAG_STACK_SIZE);
+
+    // create the current monitor task
+    lvRetValue = task_create("currentMon", CURRENT_MON_PRIORITY, CURRENT_MON_STACK_SIZE,
+        batManagement_currentMonTaskFunc, NULL);
+    // check for errors
+    if(lvRetValue < 0)
+    {
+        // inform user
+        errcode = errno;
+        cli_printfError("batManagement ERROR: Failed to start current monitor task: %d\n", errcode);
+        return lvRetValue;
+    }
+
+    // monitor its stack
+    memMon_registerTask("currentMon", "CURRENT_MON_STACK_SIZE", lvRetValue, CURRENT_MON_STACK_SIZE);
+
     // initialize SPI mutex
     lvRetValue = BCC_initialze_spi_mutex();
     if(lvRetValue)
@@ -1393,6 +1497,7 @@ int batManagement_setAFEMode(AFEmode_t mode)
 
             // turn off slow current measurements (@ t-meas)
             gSlowCurrentMeasurements = false;
+            updateCurrentMonitor();
 
             // check if the measurements were on
             if(measurementState == 0)
@@ -1476,6 +1581,7 @@ int batManagement_setAFEMode(AFEmode_t mode)
             // since the AFE is not measuring constantly, you don't need to get the current constantly
             // turn on slow current measurements (@ t-meas)
             gSlowCurrentMeasurements = true;
+            updateCurrentMonitor();
 
             // check if the measurements were not on
             if(measurementState == 0)
@@ -2051,6 +2157,12 @@ int batManagement_enableBatManagementTask(bool enable)
         // battery management on
         batteryManagementOn = true;
 
+        // start the current monitor as well
+        pthread_mutex_lock(&gCurrentMonitorMutex);
+        gCurrentMonitorRequested = true;
+        pthread_mutex_unlock(&gCurrentMonitorMutex);
+        updateCurrentMonitor();
+
         // do this and loop until the semaphore value is max 1
         do
         {
@@ -2085,6 +2197,12 @@ int batManagement_enableBatManagementTask(bool enable)
         // battery management off
         batteryManagementOn = false;
 
+        // stop the current monitor as well
+        pthread_mutex_lock(&gCurrentMonitorMutex);
+        gCurrentMonitorRequested = false;
+        pthread_mutex_unlock(&gCurrentMonitorMutex);
+        updateCurrentMonitor();
+
         // make sure the semaphore is at least 0 (not less then 0)
         do
         {
@@ -2124,6 +2242,7 @@ int batManagement_enableBatManagementTask(bool enable)
         if(semValue < 1)
         {
             // post the semaphore so the task will wait on the next sem_wait()
+            gMeasureEverythingNow = true;
             sem_post(&gSkipBatManagementWaitSem);
         }
     }
@@ -2832,12 +2951,134 @@ int batManagement_checkSleepCurrentTh(bool *enabled)
     return lvRetValue;
 }
 
+/*!
+ * @brief   This function is used to get a copy of the timing statistics of the measurement loop
+ *
+ * @param   pTiming address of the struct to copy the statistics to.
+ *
+ * @return  If successful, the function will return zero (OK). Otherwise, an error number will be returned to
+ *          indicate the error.
+ */
+int batManagement_getTiming(batManagTiming_t *pTiming)
+{
+    // check the input
+    if(pTiming == NULL)
+    {
+        cli_printfError("batManagement_getTiming ERROR: input is NULL!\n");
+        return -1;
+    }
+
+    // copy the statistics
+    pthread_mutex_lock(&gTimingMutex);
+    *pTiming = gTiming;
+    pthread_mutex_unlock(&gTimingMutex);
+
+    return 0;
+}
+
+/*!
+ * @brief   This function is used to reset the timing statistics of the measurement loop
+ *          the jitter alarm threshold is kept.
+ */
+void batManagement_resetTiming(void)
+{
+    uint32_t alarmUs;
+
+    pthread_mutex_lock(&gTimingMutex);
+
+    // clear everything but the threshold
+    alarmUs = gTiming.jitterAlarmUs;
+    memset(&gTiming, 0, sizeof(gTiming));
+    gTiming.jitterAlarmUs = alarmUs;
+    gTiming.periodMinUs   = UINT32_MAX;
+
+    pthread_mutex_unlock(&gTimingMutex);
+}
+
+/*!
+ * @brief   This function is used to set the wake-up jitter that will trigger the jitter alarm
+ *
+ * @param   alarmUs the jitter in us, 0 to turn the alarm off.
+ */
+void batManagement_setJitterAlarm(uint32_t alarmUs)
+{
+    pthread_mutex_lock(&gTimingMutex);
+
+    gTiming.jitterAlarmUs = alarmUs;
+    gTiming.jitterAlarm   = false;
+
+    pthread_mutex_unlock(&gTimingMutex);
+}
+
+/*!
+ * @brief   This function is used to output the timing statistics of the measurement loop
+ *
+ * @return  If successful, the function will return zero (OK). Otherwise, an error number will be returned to
+ *          indicate the error.
+ */
+int batManagement_outputTiming(void)
+{
+    batManagTiming_t timing;
+    const uint32_t * pHist[4];
+    const char *     histNames[4] = { "jitter", "spi", "calc", "callback" };
+    uint8_t          i, j;
+
+    // get a copy to not hold the mutex while printing
+    if(batManagement_getTiming(&timing))
+    {
+        return -1;
+    }
+
+    pHist[0] = timing.jitterHist;
+    pHist[1] = timing.spiHist;
+    pHist[2] = timing.calcHist;
+    pHist[3] = timing.callbackHist;
+
+    // lock the printfmutex
+    cli_printLock(true);
+
+    cli_printfTryLock("cycles: %u full, %u current, %u deadline misses\n", timing.fullCycles,
+        timing.currentCycles, timing.deadlineMisses);
+    cli_printfTryLock("full period: last %uus min %uus max %uus (t-meas %ums)\n", timing.periodLastUs,
+        (timing.periodMinUs == UINT32_MAX) ? 0 : timing.periodMinUs, timing.periodMaxUs, gMeasCycleTime);
+    cli_printfTryLock("max: jitter %uus spi %uus calc %uus callback %uus\n", timing.jitterMaxUs, timing.spiMaxUs,
+        timing.calcMaxUs, timing.callbackMaxUs);
+    cli_printfTryLock("jitter alarm: %uus, raised %u times%s\n", timing.jitterAlarmUs, timing.jitterAlarms,
+        timing.jitterAlarm ? ", active" : "");
+    cli_printfTryLock("current monitor: %u samples, %u dropped, max interval %uus spi %uus latency %uus\n",
+        timing.currentSamples, timing.currentOverruns, timing.currentIntervalMaxUs, timing.currentSpiMaxUs,
+        timing.currentLatencyMaxUs);
+
+    // output the histograms, bin n counts the times below (256 << n) us
+    cli_printfTryLock("%-8s", "<us");
+    for(j = 0; j < BAT_MANAG_TIMING_BINS - 1; j++)
+    {
+        cli_printfTryLock(" %8u", 256 << j);
+    }
+    cli_printfTryLock(" %8s\n", "more");
+
+    for(i = 0; i < 4; i++)
+    {
+        cli_printfTryLock("%-8s", histNames[i]);
+        for(j = 0; j < BAT_MANAG_TIMING_BINS; j++)
+        {
+            cli_printfTryLock(" %8u", pHist[i][j]);
+        }
+        cli_printfTryLock("\n");
+    }
+
+    // unlock the printfmutex
+    cli_printLock(false);
+
+    return 0;
+}
+
 /****************************************************************************
  * private Functions
  ****************************************************************************/
 /*!
- * @brief   function to do the meanual measurements, calculate current
- *          and if needed it will read the rest and do the calculations
+ * @brief   function to do the meanual measurements every t-meas, it will read everything and do the
+ *          calculations. In between it will handle the current samples of the current monitor task.
  *          Then it will check the new values if there is anything wrong it
  *          will trigger the main to react on it.
  *          Afterwards it will check balancing and trigger to update measurements.
@@ -2848,12 +3089,15 @@ int batManagement_checkSleepCurrentTh(bool *enabled)
 static int batManagement_batManagTaskFunc(int argc, char *argv[])
 {
     int          intValue;
-    bool         measureEverything = true, increaseTargetTime = false;
+    bool         measureEverything = true, deadlineMissed = false, waitedForTarget = false;
     bcc_status_t bcc_status;
     // make the wait time
-    struct timespec          waitTime, measureTime;
-    struct timespec          oldMeasureAllTime = { 0, 0 };
+    struct timespec          waitTime;
+    uint64_t                 measureUs, stepUs, nowUs;
+    uint64_t                 oldMeasureAllUs = 0, wakeUs = 0;
     commonBatteryVariables_t commonBatteryVariables;
+    // the timing of this cycle in us
+    int jitterUs, periodUs, spiUs, calcUs, callbackUs;
 
     // get the T_meas value
     if(data_getParameter(T_MEAS, &intValue, NULL) == NULL)
@@ -2865,186 +3109,513 @@ static int batManagement_batManagTaskFunc(int argc, char *argv[])
     // limit the value
     intValue &= 0xFFFF;
 
-    // calculate gMeasCycleTime and set the gTargetTime
+    // calculate gMeasCycleTime and set the gTargetUs
     batManagement_calcSendInterval((uint16_t)intValue);
 
     // endless loop
     while(1)
     {
+        // don't supervise the task while it may be stopped
+        supervisor_checkIn(SUPERVISOR_BATMANAG, SUPERVISOR_OFF);
+
         // wait for the semaphore, this is how the battery management could be stopped
         sem_wait(&gBatManagementSem);
 
         // post a new semaphore to keep measuring, calculating, checking ...
         sem_post(&gBatManagementSem);
 
-        // get the current time and save it as measuretime
-        if(clock_gettime(CLOCK_REALTIME, &measureTime) == -1)
-        {
-            cli_printfError("batManagement_batManagTaskFunc ERROR: failed to get measureTime!\n");
-        }
+        // supervise this cycle, the next one should start within a measurement cycle
+        supervisor_checkIn(SUPERVISOR_BATMANAG, gMeasCycleTime + BATMANAG_SUPERVISOR_MARGIN_MS);
+
+        // get the current time and save it as measure time
+        measureUs = timeBase_getUs();
+
+        // the jitter is how late it woke up, only if it waited until the wake time
+        jitterUs        = waitedForTarget ? (int)timeBase_getElapsedUs(wakeUs) : -1;
+        waitedForTarget = false;
+        periodUs        = -1;
+        spiUs           = -1;
+        calcUs          = 0;
+        callbackUs      = 0;
 
         // check if it should measure everything in the next measurement
         // This could be when it hasn't measured for too long
-        if((!measureEverything) &&
-            ((data_getUsTimeDiff(measureTime, oldMeasureAllTime) / 1000) > (gMeasCycleTime)))
+        if((!measureEverything) && ((measureUs - oldMeasureAllUs) > (gMeasCycleTime * TIME_BASE_US_PER_MS)))
         {
             // make sure it will measure everything
             measureEverything = true;
         }
 
+        // if it is woken by the current monitor task, only handle the new current samples
+        if(!measureEverything)
+        {
+            // the current is measured by the current monitor task
+            processCurrentSamples(&calcUs, &callbackUs);
+
+            // indicate only the current is handled
+            bcc_status = ONLY_CURRENT_RETURN;
+        }
         // if everything will be measured
-        if(measureEverything)
+        else
         {
+            // get the period between the full measurements
+            if(oldMeasureAllUs)
+            {
+                periodUs = (int)(measureUs - oldMeasureAllUs);
+            }
+
             // sav the current time
-            oldMeasureAllTime.tv_sec  = measureTime.tv_sec;
-            oldMeasureAllTime.tv_nsec = measureTime.tv_nsec;
+            oldMeasureAllUs = measureUs;
+
+            // update the measurements in the local commonBatteryVariables struct
+            bcc_status = bcc_monitoring_updateMeasurements(
+                &gBccDrvConfig, SHUNT_RESISTOR_UOHM, &gLowestCellVoltage, true, &commonBatteryVariables);
+
+            // get the time the AFE (SPI) measurement took
+            stepUs = timeBase_getUs();
+            spiUs  = (int)(stepUs - measureUs);
+
+            // set measureEverything to false to not keep measuring and processing everything.
+            measureEverything = false;
+
+            // check for errors
+            if(bcc_status != BCC_STATUS_SUCCESS)
+            {
+                cli_printfError("batManagement ERROR: failed to update measurements! error: %d\n", bcc_status);
+            }
+            // if it did all the measurements
+            else
+            {
+                // calculate the rest of the variables and set this in commonBatteryVariables and data
+                bcc_monitoring_calculateVariables(
+                    &gBccDrvConfig, &gGateLock, gLowestCellVoltage, &commonBatteryVariables);
+
+                // add the lowest cell voltage to the statistics
+                measStats_addSample(MEAS_STATS_LOWEST_CELL, gLowestCellVoltage, (uint32_t)measureUs);
+
+                // add the current as well if there is no current monitor sampling it
+                if(!gCurrentMonitorOn)
+                {
+                    measStats_addSample(MEAS_STATS_CURRENT, commonBatteryVariables.I_batt, (uint32_t)measureUs);
+                }
+
+                // set the common battery variables in the data struct
+                // do this before the check as the main loop will get the variables from the data struct
+                if(data_setCommonBatteryVariables(&commonBatteryVariables))
+                {
+                    cli_printfError("batManagement ERROR: failed to set new measurements!\n");
+                }
+
+                // set the time of these measurements, right after the AFE measurement
+                if(data_setMeasurementTimeUs(stepUs))
+                {
+                    cli_printfError("batManagement ERROR: failed to set the measurement time!\n");
+                }
+
+                // check all the measurements for faults
+                if(checkAllMeasurements(&commonBatteryVariables))
+                {
+                    cli_printfError("batManagement ERROR: failed to check measurements!\n");
+                }
+
+                // handle the cell balancing
+                if(balancing_handleCellBalancing(&commonBatteryVariables, gLowestCellVoltage))
+                {
+                    cli_printfError("batManagement ERROR: failed to handle cell balancing!\n");
+                }
+
+                // get the time the calculations took
+                nowUs  = timeBase_getUs();
+                calcUs = (int)(nowUs - stepUs);
+
+                // make sure the main state checks transitions based on the new current
+                if(g_checkForTransitionCurrentCallbackFunctionfp(&(commonBatteryVariables.I_batt)))
+                {
+                    cli_printfError("batManagement ERROR: failed to check for current transitions!\n");
+                }
+
+                // callback that data needs to be send
+                g_newMeasurementsCallbackFunctionfp();
+
+                // get the time the callbacks took
+                callbackUs = (int)timeBase_getElapsedUs(nowUs);
+            }
         }
 
-        // update the measurements in the local commonBatteryVariables struct
-        // if measureEverything is true process everything, otherwise only the current
-        bcc_status = bcc_monitoring_updateMeasurements(&gBccDrvConfig, SHUNT_RESISTOR_UOHM,
-            &gLowestCellVoltage, measureEverything, &commonBatteryVariables);
+        // lock mutex
+        pthread_mutex_lock(&gMeasureTimeMutex);
+
+        // check if the target time needs to be increased after measuring everything
+        if(bcc_status != ONLY_CURRENT_RETURN)
+        {
+            // keep in mind that if the measurements are enabled, that gTargetUs is reset to the current
+            // time.
+
+            // make the new target time based on the gMeasCycleTime (in ms) and check if the current time
+            // is more than the (old) target time, if it is still behind it continues from the current time
+            deadlineMissed = timeBase_advanceDeadline(&gTargetUs, gMeasCycleTime * 1000, timeBase_getUs());
+        }
 
-        // set measureEverything to false to not keep measuring and processing everything.
-        measureEverything = false;
+        // wait until the target time to measure everything
+        wakeUs = gTargetUs;
 
-        // check for errors and not returning because of only measuring the current
-        if(bcc_status != BCC_STATUS_SUCCESS && bcc_status != ONLY_CURRENT_RETURN)
+        // unlock mutex
+        pthread_mutex_unlock(&gMeasureTimeMutex);
+
+        // lock the timing mutex and add the timing of this cycle
+        pthread_mutex_lock(&gTimingMutex);
+
+        // count the cycle
+        if(bcc_status == ONLY_CURRENT_RETURN)
+        {
+            gTiming.currentCycles++;
+        }
+        else
         {
-            cli_printfError("batManagement ERROR: failed to update measurements! error: %d\n", bcc_status);
+            gTiming.fullCycles++;
+
+            // add the AFE (SPI) measurement time of the full measurement
+            addTimingSample(gTiming.spiHist, &gTiming.spiMaxUs, spiUs);
         }
-        // if it did all the measurements
-        else if(bcc_status == BCC_STATUS_SUCCESS)
+
+        // check if the deadline was missed
+        if(deadlineMissed)
         {
-            // calculate the rest of the variables and set this in commonBatteryVariables and data
-            bcc_monitoring_calculateVariables(
-                &gBccDrvConfig, &gGateLock, gLowestCellVoltage, &commonBatteryVariables);
+            gTiming.deadlineMisses++;
+            deadlineMissed = false;
+        }
 
-            // set the common battery variables in the data struct
-            // do this before the check as the main loop will get the variables from the data struct
-            if(data_setCommonBatteryVariables(&commonBatteryVariables))
+        // update the period between full measurements
+        if(periodUs >= 0)
+        {
+            gTiming.periodLastUs = (uint32_t)periodUs;
+
+            if((uint32_t)periodUs < gTiming.periodMinUs)
             {
-                cli_printfError("batManagement ERROR: failed to set new measurements!\n");
+                gTiming.periodMinUs = (uint32_t)periodUs;
             }
 
-            // check all the measurements for faults
-            if(checkAllMeasurements(&commonBatteryVariables))
+            if((uint32_t)periodUs > gTiming.periodMaxUs)
             {
-                cli_printfError("batManagement ERROR: failed to check measurements!\n");
+                gTiming.periodMaxUs = (uint32_t)periodUs;
             }
+        }
 
-            // make sure the main state checks transitions based on the new current
-            if(g_checkForTransitionCurrentCallbackFunctionfp(&(commonBatteryVariables.I_batt)))
+        // add the durations
+        addTimingSample(gTiming.calcHist, &gTiming.calcMaxUs, calcUs);
+        addTimingSample(gTiming.callbackHist, &gTiming.callbackMaxUs, callbackUs);
+
+        // add the jitter if it waited on the wake time and check it
+        if(jitterUs >= 0)
+        {
+            addTimingSample(gTiming.jitterHist, &gTiming.jitterMaxUs, jitterUs);
+
+            // check for the alarm, only warn once when it is raised
+            if(gTiming.jitterAlarmUs && ((uint32_t)jitterUs > gTiming.jitterAlarmUs))
             {
-                cli_printfError("batManagement ERROR: failed to check for current transitions!\n");
-            }
+                if(!gTiming.jitterAlarm)
+                {
+                    gTiming.jitterAlarms++;
+                    cli_printfWarning("batManagement WARNING: measurement jitter %dus > %uus!\n", jitterUs,
+                        gTiming.jitterAlarmUs);
+                }
 
-            // handle the cell balancing
-            if(balancing_handleCellBalancing(&commonBatteryVariables, gLowestCellVoltage))
+                gTiming.jitterAlarm = true;
+            }
+            else
             {
-                cli_printfError("batManagement ERROR: failed to handle cell balancing!\n");
+                gTiming.jitterAlarm = false;
             }
+        }
+
+        // unlock the timing mutex
+        pthread_mutex_unlock(&gTimingMutex);
+
+        // register the target time, the measurement has no slack so the other tasks align to it
+        wakeSched_alignDeadline(WAKE_SCHED_MEAS, &wakeUs, 0);
 
-            // callback that data needs to be send
-            g_newMeasurementsCallbackFunctionfp();
+        // wait until the target time, a new current sample or until it is triggered
+        // sem_timedwait() needs the realtime clock, this is converted just before the wait
+        timeBase_toRealtime(wakeUs, &waitTime);
+        intValue = sem_timedwait(&gSkipBatManagementWaitSem, &waitTime);
+
+        // count the wake-up
+        wakeSched_wokeUp(WAKE_SCHED_MEAS);
+
+        // check if there is no error, meaning the semaphore got increased
+        if(!intValue)
+        {
+            // check if it is triggered to measure right away, otherwise it is a new current sample
+            if(gMeasureEverythingNow)
+            {
+                // make sure it will measure everything
+                gMeasureEverythingNow = false;
+                measureEverything     = true;
+            }
         }
-        // if it only measured the current
         else
         {
-            // Since only the current has changed, set only the current
-            if(data_setParameter(I_BATT, &(commonBatteryVariables.I_batt)))
+            // it waited until the wake time, make sure it will measure everything
+            waitedForTarget   = true;
+            measureEverything = true;
+        }
+    }
+
+    // for compiler, shouldn't come here
+    return -1;
+}
+
+/*!
+ * @brief   function of the current monitor task, it will only measure the current on a fixed period
+ *          of MEASURE_CURRENT_US, put it in the current sample ring and wake the bat management task
+ *
+ * @param   argc the amount of arguments there are in argv (if the last argument is NULL!)
+ * @param   argv a character pointer array with the arguments, first is the taskname than the arguments
+ */
+static int batManagement_currentMonTaskFunc(int argc, char *argv[])
+{
+    struct timespec nextTime;
+    uint64_t        nextUs, sampleUs;
+    float           current;
+    int             semValue, spiUs;
+    uint32_t        head;
+
+    // get the first wake-up time
+    nextUs = timeBase_getUs();
+
+    // endless loop
+    while(1)
+    {
+        // wait for the semaphore, this is how the current monitor is stopped
+        sem_wait(&gCurrentMonitorSem);
+
+        // post a new semaphore to keep measuring
+        sem_post(&gCurrentMonitorSem);
+
+        // get the time of the sample
+        sampleUs = timeBase_getUs();
+
+        // measure only the current
+        if(bcc_monitoring_measureCurrent(&gBccDrvConfig, SHUNT_RESISTOR_UOHM, &current) == BCC_STATUS_SUCCESS)
+        {
+            // get the time the conversion took
+            spiUs = (int)timeBase_getElapsedUs(sampleUs);
+
+            // check if there is room in the ring, otherwise the sample is dropped
+            head = gCurrentRingHead;
+            if((head - gCurrentRingTail) < CURRENT_RING_SIZE)
             {
-                cli_printfError(
-                    "batManagement ERROR: Couldn't set i-batt! %.3f \n", commonBatteryVariables.I_batt);
-            }
+                // fill the sample before it is published with the head
+                gCurrentRing[head % CURRENT_RING_SIZE].timeUs   = (uint32_t)sampleUs;
+                gCurrentRing[head % CURRENT_RING_SIZE].currentA = current;
+                gCurrentRing[head % CURRENT_RING_SIZE].spiUs =
+                    (spiUs < 0) ? 0 : ((spiUs > UINT16_MAX) ? UINT16_MAX : (uint16_t)spiUs);
 
-            // check the current for a peak over current fault
-            if(checkCurrentMeasurement(commonBatteryVariables.I_batt))
+                gCurrentRingHead = head + 1;
+            }
+            else
             {
-                cli_printfError("batManagement ERROR: failed to check current!\n");
+                gCurrentRingOverruns++;
             }
 
-            // make sure the main state checks transitions based on the new current
-            if(g_checkForTransitionCurrentCallbackFunctionfp(&(commonBatteryVariables.I_batt)))
+            // wake the bat management task if it isn't already
+            sem_getvalue(&gSkipBatManagementWaitSem, &semValue);
+            if(semValue < 1)
             {
-                cli_printfError(
-                    "batManagement ERROR: failed to check for current transitions with current meas!\n");
+                sem_post(&gSkipBatManagementWaitSem);
             }
         }
 
-        // lock mutex
-        pthread_mutex_lock(&gMeasureTimeMutex);
+        // make the next wake-up time
+        // if it is behind (or it was stopped), continue from the current time and skip the missed samples
+        timeBase_advanceDeadline(&nextUs, MEASURE_CURRENT_US, timeBase_getUs());
 
-        // get the current time
-        if(clock_gettime(CLOCK_REALTIME, &waitTime) == -1)
+        // sleep until the next sample, on the monotonic clock
+        timeBase_toTimespec(nextUs, &nextTime);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextTime, NULL);
+    }
+
+    // for compiler, shouldn't come here
+    return -1;
+}
+
+/*!
+ * @brief   function to handle the new samples of the current sample ring
+ *          it will check each sample for a peak overcurrent, set the last current
+ *          and check for current transitions
+ *
+ * @param   pCalcUs address of the variable to become the time the checks took in us
+ * @param   pCallbackUs address of the variable to become the time the callback took in us
+ */
+static void processCurrentSamples(int *pCalcUs, int *pCallbackUs)
+{
+    static uint32_t lastSampleUs = 0;
+    uint64_t        startUs, stepUs;
+    uint32_t        head, nowUs, sampleUs, samples = 0;
+    uint32_t        latencyMaxUs = 0, intervalMaxUs = 0, spiMaxUs = 0;
+    float           current = 0;
+    static float    streamCurrent[CURRENT_RING_SIZE];
+    static uint32_t streamUs[CURRENT_RING_SIZE];
+
+    // get the time to calculate the latency of the samples
+    startUs = timeBase_getUs();
+    nowUs   = (uint32_t)startUs;
+
+    // get the samples that are published now
+    head = gCurrentRingHead;
+
+    // handle each sample
+    while(gCurrentRingTail != head)
+    {
+        // copy the sample before it is released with the tail
+        sampleUs = gCurrentRing[gCurrentRingTail % CURRENT_RING_SIZE].timeUs;
+        current  = gCurrentRing[gCurrentRingTail % CURRENT_RING_SIZE].currentA;
+
+        if(gCurrentRing[gCurrentRingTail % CURRENT_RING_SIZE].spiUs > spiMaxUs)
         {
-            cli_printfError("batManagement_batManagTaskFunc ERROR: failed to get waitTime!\n");
+            spiMaxUs = gCurrentRing[gCurrentRingTail % CURRENT_RING_SIZE].spiUs;
         }
 
-        // check if the current time is more than the (old) target time
-        if((waitTime.tv_sec > gTargetTime.tv_sec) ||
-            ((waitTime.tv_sec == gTargetTime.tv_sec) && (waitTime.tv_nsec > gTargetTime.tv_nsec)))
+        gCurrentRingTail = gCurrentRingTail + 1;
+
+        // the latency from the start of the conversion until the fault check
+        if((nowUs - sampleUs) > latencyMaxUs)
         {
-            // increase target time after the calculation
-            increaseTargetTime = true;
+            latencyMaxUs = nowUs - sampleUs;
         }
 
-        // check if the slow measurement should be done
-        // or the targetTime is too close to the current time (within 2*MEASURE_CURRENT_US)
-        if(gSlowCurrentMeasurements ||
-            (data_getUsTimeDiff(gTargetTime, waitTime) < (MEASURE_CURRENT_US << 1)))
+        // the interval with the previous sample
+        if(lastSampleUs && ((sampleUs - lastSampleUs) > intervalMaxUs))
         {
-            // save the targetTime in waitTime to wait until the target time
-            waitTime.tv_sec  = gTargetTime.tv_sec;
-            waitTime.tv_nsec = gTargetTime.tv_nsec;
-
-            // make sure it will measure everything
-            measureEverything = true;
+            intervalMaxUs = sampleUs - lastSampleUs;
         }
-        // otherwise prepare for the next current measurement
-        else
-        {
-            // get the difference with the last measure time
-            intValue = data_getUsTimeDiff(waitTime, measureTime);
 
-            // make the remaining wait time in ns
-            intValue = (MEASURE_CURRENT_US - intValue) * 1000;
+        lastSampleUs = sampleUs;
 
-            // make the wait time in the wait time variable
-            waitTime.tv_sec += (waitTime.tv_nsec + intValue) / (MAX_NSEC + 1);
-            waitTime.tv_nsec = (waitTime.tv_nsec + intValue) % (MAX_NSEC + 1);
-        }
+        // keep it for the stream, there are at most CURRENT_RING_SIZE new samples
+        streamCurrent[samples] = current;
+        streamUs[samples]      = sampleUs;
+        samples++;
 
-        // check if the target time needs to be increased
-        if(increaseTargetTime || measureEverything)
+        // add it to the current statistics
+        measStats_addSample(MEAS_STATS_CURRENT, current, sampleUs);
+
+        // check the current for a peak over current fault
+        if(checkCurrentMeasurement(current))
         {
-            // set the variable to false to not keep doing this
-            increaseTargetTime = false;
+            cli_printfError("batManagement ERROR: failed to check current!\n");
+        }
+    }
 
-            // keep in mind that if the measurements are enabled, that gTargetTime is reset to the current
-            // time.
+    // check if there was a new sample
+    if(!samples)
+    {
+        return;
+    }
 
-            // make the new target time based on the gMeasCycleTime (in ms)
-            gTargetTime.tv_sec += (waitTime.tv_nsec + (gMeasCycleTime * 1000000)) / (MAX_NSEC + 1);
-            gTargetTime.tv_nsec = (waitTime.tv_nsec + (gMeasCycleTime * 1000000)) % (MAX_NSEC + 1);
-        }
+    // Since only the current has changed, set only the current
+    if(data_setParameter(I_BATT, &current))
+    {
+        cli_printfError("batManagement ERROR: Couldn't set i-batt! %.3f \n", current);
+    }
 
-        // unlock mutex
-        pthread_mutex_unlock(&gMeasureTimeMutex);
+    // get the time the checks took
+    stepUs   = timeBase_getUs();
+    *pCalcUs = (int)(stepUs - startUs);
 
-        // wait the specified time until next measurement or until it is triggered
-        intValue = sem_timedwait(&gSkipBatManagementWaitSem, &waitTime);
+    // make sure the main state checks transitions based on the new current
+    if(g_checkForTransitionCurrentCallbackFunctionfp(&current))
+    {
+        cli_printfError("batManagement ERROR: failed to check for current transitions with current meas!\n");
+    }
 
-        // check if there is no error, meaning the semaphore got increased to measure right away
-        if(!intValue)
-        {
-            // make sure it will measure everything
-            measureEverything = true;
-        }
+    // get the time the callback took
+    *pCallbackUs = (int)timeBase_getElapsedUs(stepUs);
+
+    // stream the samples after the checks, if that is on
+    if(cli_streamCurrentSamples(streamCurrent, streamUs, (uint8_t)samples))
+    {
+        cli_printfError("batManagement ERROR: failed to stream the current samples!\n");
     }
 
-    // for compiler, shouldn't come here
-    return -1;
+    // add the current monitor timing
+    pthread_mutex_lock(&gTimingMutex);
+
+    gTiming.currentSamples += samples;
+    gTiming.currentOverruns = gCurrentRingOverruns;
+
+    if(latencyMaxUs > gTiming.currentLatencyMaxUs)
+    {
+        gTiming.currentLatencyMaxUs = latencyMaxUs;
+    }
+
+    if(intervalMaxUs > gTiming.currentIntervalMaxUs)
+    {
+        gTiming.currentIntervalMaxUs = intervalMaxUs;
+    }
+
+    if(spiMaxUs > gTiming.currentSpiMaxUs)
+    {
+        gTiming.currentSpiMaxUs = spiMaxUs;
+    }
+
+    pthread_mutex_unlock(&gTimingMutex);
+}
+
+/*!
+ * @brief   function to start or stop the current monitor task
+ *          it runs if the bat management task is on and the current measurements are not slowed down
+ */
+static void updateCurrentMonitor(void)
+{
+    bool on;
+
+    pthread_mutex_lock(&gCurrentMonitorMutex);
+
+    // check if it should run
+    on = gCurrentMonitorRequested && !gSlowCurrentMeasurements;
+
+    // start it
+    if(on && !gCurrentMonitorOn)
+    {
+        sem_post(&gCurrentMonitorSem);
+    }
+    // stop it, it will wait on the next sem_wait()
+    else if(!on && gCurrentMonitorOn)
+    {
+        sem_wait(&gCurrentMonitorSem);
+    }
+
+    gCurrentMonitorOn = on;
+
+    pthread_mutex_unlock(&gCurrentMonitorMutex);
+}
+
+/*!
+ * @brief   function to add a sample to a timing histogram and its maximum
+ *
+ * @param   pHist the histogram with BAT_MANAG_TIMING_BINS bins
+ * @param   pMax address of the maximum of the histogram
+ * @param   timeUs the sample in us, negative values are handled as 0
+ */
+static void addTimingSample(uint32_t *pHist, uint32_t *pMax, int timeUs)
+{
+    uint32_t sample = (timeUs > 0) ? (uint32_t)timeUs : 0;
+    uint8_t  bin    = 0;
+
+    // find the bin, bin n counts the times below (256 << n) us and the last bin the rest
+    while((bin < (BAT_MANAG_TIMING_BINS - 1)) && (sample >= ((uint32_t)256 << bin)))
+    {
+        bin++;
+    }
+
+    pHist[bin]++;
+
+    // update the maximum
+    if(sample > *pMax)
+    {
+        *pMax = sample;
+    }
 }
 
 /*
@@ -3106,9 +3677,10 @@ static int checkCurrentMeasurement(float current)
  */
 static int checkAllMeasurements(commonBatteryVariables_t *pCommonBatteryVariables)
 {
-    variableTypes_u variable1;
-    variableTypes_u variable2;
-    int             lvRetValue = 0, i;
+    variableTypes_u   variable1;
+    variableTypes_u   variable2;
+    measStatsResult_t currentStats;
+    int               lvRetValue = 0, i;
 
     // check the current
     if(checkCurrentMeasurement(pCommonBatteryVariables->I_batt))
@@ -3240,10 +3812,18 @@ static int checkAllMeasurements(commonBatteryVariables_t *pCommonBatteryVariable
                 lvRetValue = -1;
             }
 
+            // get the peak discharge current of the last 10s, without samples it is not used
+            if(measStats_getWindow(MEAS_STATS_CURRENT, MEAS_STATS_10S, &currentStats) || !currentStats.count)
+            {
+                currentStats.min = 0;
+            }
+
             // check if the 10s avg current is less than the flight mode current
             // And the (1s) avg current is lower than the flight mode current
+            // And the 10s peak discharge current is lower than the flight mode current
             if((((pCommonBatteryVariables->I_batt_10s_avg * -1)) < ((float)variable1.uint8Var)) &&
-                (((pCommonBatteryVariables->I_batt_avg * -1)) < ((float)variable1.uint8Var)))
+                (((pCommonBatteryVariables->I_batt_avg * -1)) < ((float)variable1.uint8Var)) &&
+                ((currentStats.min * -1) < ((float)variable1.uint8Var)))
             {
                 // make the in flight status variable false again
                 variable1.uint8Var = 0;
@@ -3470,19 +4050,13 @@ static void batManagement_calcSendInterval(uint16_t measMs)
     // get the time before the start of the measurements
     // to make sure the duration of the time cycle of the measurements starts from this
     // so the duration of the measurements is not neglected
-    if(clock_gettime(CLOCK_REALTIME, &gTargetTime) == -1)
-    {
-        cli_printfError("batManagement ERROR: failed to get gTargetTime time!\n");
-    }
+    gTargetUs = timeBase_getUs();
 
     // make the cycletime for ms
     gMeasCycleTime = measMs;
 
-    // set the next measurement target
-    gTargetTime.tv_sec--;
-
-    // set the nsec to max to make sure there is no negative number
-    gTargetTime.tv_nsec = MAX_NSEC;
+    // set the next measurement target to the start of this second
+    gTargetUs -= gTargetUs % TIME_BASE_US_PER_S;
 
     // unlock mutex
     pthread_mutex_unlock(&gMeasureTimeMutex);
@@ -3528,13 +4102,6 @@ static bcc_status_t BatManagement_initializeBCC(void)
     gBccDrvConfig.cellCnt[BCC_FIRST_INDEX] = BCC_DEFAULT_CELLCNT;
     gBccDrvConfig.commMode                 = BCC_MODE_SPI;
 
-    /* Precalculate NTC look up table for fast temperature measurement. */
-    g_ntcConfig.rntc    = NTC_PULL_UP;  /* NTC pull-up 10kOhm */
-    g_ntcConfig.refTemp = NTC_REF_TEMP; /* NTC resistance 10kOhm at 25 degC */
-    g_ntcConfig.refRes  = NTC_REF_RES;  /* NTC resistance 10kOhm at 25 degC */
-    g_ntcConfig.beta    = NTC_BETA;
-    bcc_monitoring_fillNtcTable(&g_ntcConfig);
-
     i = 0;
 
     // do the verification
@@ -50,10 +50,14 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <assert.h>
+#include <semaphore.h>
 
 #include "data.h"
 #include "power.h"
 #include "cli.h"
+#include "measStats.h"
+#include "memMon.h"
+#include "timeBase.h"
 
 #include <nuttx/vt100.h>
 
@@ -73,7 +77,17 @@
 #define LOAD_COMMAND        "load"
 #define DEFAULT_COMMAND     "default"
 #define TIME_COMMAND        "time"
-#define AMOUNT_COMMANDS     12
+#define STREAM_COMMAND      "stream"
+#define EXPORT_COMMAND      "export"
+#define IMPORT_COMMAND      "import"
+#define TRACE_COMMAND       "trace"
+#define TIMING_COMMAND      "timing"
+#define POWER_COMMAND       "power"
+#define WATCHDOG_COMMAND    "watchdog"
+#define MEM_COMMAND         "mem"
+#define AMOUNT_COMMANDS     20
+#define IMPORT_APPLY        "apply"
+#define IMPORT_CLEAR        "clear"
 #define PARAMS_COMMAND      "parameters"
 #define SHOW_MEAS_COMMAND   "show-meas"
 #define SHOW_CURRENT        "i-batt"
@@ -94,9 +108,29 @@
 // because a measured update sequence (bms show top 1 and bms show all 1) takes 42ms, max wait time will be
 // 100ms
 #define CLI_TIMED_LOCK_WAIT_TIME_MS 500
-#define MS_TO_NS_MULT               1000000
-#ifndef NSEC_MAX
-#    define NSEC_MAX 999999999
+
+// the deferred log ring, tasks with a higher priority than the drain task will not wait for the console
+#define CLI_LOG_RECORDS         16 // needs to be a power of 2
+#define CLI_LOG_RECORD_LENGTH   96 // including the NULL character, longer messages are truncated
+#define CLI_LOG_DRAIN_PRIORITY  105 // lower than the BMS tasks, higher than the shell and the updater task
+#define CLI_LOG_DRAIN_STACK_SIZE 1024 + 256
+
+// the maximum size of a stream frame body with all the fields, with the current samples and the CRC
+#define CLI_STREAM_FIELDS_BODY  (8 + 4 + (1 + 6 * 2) + (4 * 2) + 1 + 2 + 1 + (MEAS_STATS_WINDOWS * 4 * 4) + 2)
+#define CLI_STREAM_SAMPLES_BODY (8 + 1 + (CLI_STREAM_MAX_SAMPLES * (2 + 4)) + 2)
+#define CLI_STREAM_MAX_BODY \
+    ((CLI_STREAM_FIELDS_BODY > CLI_STREAM_SAMPLES_BODY) ? CLI_STREAM_FIELDS_BODY : CLI_STREAM_SAMPLES_BODY)
+
+// the amount of blob bytes per exported "bms import <hex>" line, to fit in the nsh line length
+#define CLI_EXPORT_BYTES_PER_LINE 24
+
+#if(CLI_LOG_RECORDS & (CLI_LOG_RECORDS - 1))
+#    error CLI_LOG_RECORDS needs to be a power of 2!
+#endif
+
+// the commands of the shell run with the bms task priority, they need to print directly
+#if(CLI_LOG_DRAIN_PRIORITY <= CONFIG_NXP_BMS_PRIORITY)
+#    error CLI_LOG_DRAIN_PRIORITY needs to be higher than CONFIG_NXP_BMS_PRIORITY!
 #endif
 
 /****************************************************************************
@@ -107,9 +141,18 @@ typedef enum
 {
     RED,
     GREEN,
-    YELLOW
+    YELLOW,
+    NO_COLOR
 } printColor_t;
 
+/*! @brief a record of the deferred log ring */
+typedef struct
+{
+    uint32_t sequence;                   //!< the ring position this record can be written (or read + 1) at
+    uint8_t  color;                      //!< the printColor_t of the message
+    char     text[CLI_LOG_RECORD_LENGTH]; //!< the formatted message
+} cliLogRecord_t;
+
 /*! @brief these are the possible show commands */
 typedef enum
 {
@@ -293,11 +336,47 @@ const parameterKind_t BCCParameters[] =
 bool                   gCliPrintLockInitialized = false;
 static pthread_mutex_t gCliPrintLock;
 
+//! the deferred log ring, written by multiple producers and read by the drain task
+static cliLogRecord_t gCliLogRing[CLI_LOG_RECORDS];
+
+//! the ring position of the next record to write, only changed with atomic operations
+static uint32_t gCliLogHead = 0;
+
+//! the ring position of the next record to print, only used by the drain task
+static uint32_t gCliLogTail = 0;
+
+//! the amount of messages that didn't fit in the ring and are dropped
+static uint32_t gCliLogDropped = 0;
+
+//! the amount of messages that were too long and are truncated
+static uint32_t gCliLogTruncated = 0;
+
+//! the semaphore to wake up the drain task
+static sem_t gCliLogSem;
+
+//! true if the drain task is running and messages can be deferred
+static bool gCliLogDrainStarted = false;
+
 static char gGetSetParamsLowerString[32];
 
 static uint16_t gShowMeasurements = 0;
 static bool     gDoTop            = false;
 
+//! the CLI_STREAM_* fields that are streamed, 0 if the stream is off
+static uint16_t gStreamFields   = 0;
+static uint8_t  gStreamSequence = 0;
+
+//! the frame with the current samples that are not sent yet, only used by the caller of cli_streamCurrentSamples()
+static uint8_t  gStreamSampleBody[CLI_STREAM_MAX_BODY];
+static uint8_t  gStreamSampleLength     = 0;
+static uint8_t  gStreamSampleCountIndex = 0;
+static uint8_t  gStreamSampleCount      = 0;
+static uint64_t gStreamSampleFrameUs    = 0;
+
+//! the parameter blob that is received with "bms import <hex>" and its length
+static uint8_t  gImportBlob[PARAMETER_BLOB_MAX_SIZE];
+static uint16_t gImportBlobLength = 0;
+
 //! @brief Callback function to handle a command in the main.c
 userCommandCallbackBatFuntion gUserCommandCallbackFuntionfp;
 /****************************************************************************
@@ -314,6 +393,36 @@ void printAllParameterValues(void);
 
 int cli_printfColor(printColor_t color, const char *fmt, va_list argp);
 
+/*!
+ * @brief   this function checks if a message of the calling task should be deferred to the drain task.
+ *          Only tasks with a higher priority than the drain task will defer, the others print directly.
+ *
+ * @return  true if the message should be put in the log ring
+ */
+static bool cliLogShouldDefer(void);
+
+/*!
+ * @brief   this function formats a message in a free record of the log ring without waiting.
+ *          If the ring is full, the message is dropped and counted.
+ *
+ * @param   color the printColor_t of the message
+ * @param   fmt the format string
+ * @param   argp the arguments of the format string
+ *
+ * @return  the amount of formatted characters, or -1 if the message is dropped
+ */
+static int cliLogEnqueue(printColor_t color, const char *fmt, va_list argp);
+
+/*!
+ * @brief   this is the task that prints the messages of the log ring on the console
+ *
+ * @param   argc the amount of arguments
+ * @param   argv the arguments
+ *
+ * @return  should not return
+ */
+static int cliLogDrainTaskFunc(int argc, char *argv[]);
+
 /*!
  * @brief   this function can be used to change what is viewed
  *          on the CLI (the new measurements)
@@ -325,6 +434,66 @@ int cli_printfColor(printColor_t color, const char *fmt, va_list argp);
  */
 void setShowMeas(showCommands_t showCommand, bool value);
 
+/*!
+ * @brief   this function sends the selected fields of the measurements as one binary stream frame
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ *
+ * @return  0 If successful, otherwise an error will indicate the error
+ */
+static int streamData(
+    commonBatteryVariables_t *pCommonBatteryVariables, calcBatteryVariables_t *pCalcBatteryVariables);
+
+/*!
+ * @brief   this function places a little endian value in a buffer
+ *
+ * @param   pBuffer the address of the buffer
+ * @param   pIndex the address of the index in the buffer, it will be increased with the size
+ * @param   value the value to place
+ * @param   size the amount of bytes to place
+ */
+static void streamPut(uint8_t *pBuffer, uint8_t *pIndex, uint32_t value, uint8_t size);
+
+/*!
+ * @brief   this function places the header of a stream frame in the body
+ *
+ * @param   pBody the address of the body
+ * @param   pBodyLength the address of the length of the body, it will be increased with the header
+ * @param   fields the CLI_STREAM_* fields of the frame
+ * @param   timeMs the time of the frame in ms
+ */
+static void streamPutHeader(uint8_t *pBody, uint8_t *pBodyLength, uint16_t fields, uint32_t timeMs);
+
+/*!
+ * @brief   this function sets the sequence number and adds the CRC to the body of a stream frame
+ *          and sends it escaped between two CLI_STREAM_FLAG bytes
+ *
+ * @param   pBody the address of the body, with room for the CRC
+ * @param   bodyLength the length of the body without the CRC
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int streamSendFrame(uint8_t *pBody, uint8_t bodyLength);
+
+/*!
+ * @brief   this function prints the parameter blob of all the parameters as "bms import <hex>" lines
+ *          followed by "bms import apply", so the output can be entered again to import it
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int exportParameters(void);
+
+/*!
+ * @brief   this function handles "bms import <x>", it adds the hex bytes to the import blob,
+ *          imports the blob with "apply" or clears it with "clear"
+ *
+ * @param   pString the hex string, IMPORT_APPLY or IMPORT_CLEAR
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int importParameters(const char *pString);
+
 /****************************************************************************
  * public Functions
  ****************************************************************************/
@@ -339,10 +508,39 @@ void setShowMeas(showCommands_t showCommand, bool value);
  */
 int cli_initialize(userCommandCallbackBatFuntion p_userCommandCallbackBatFuntion)
 {
+    int      lvRetValue;
+    uint32_t i;
+
     // initialize the mutex
     pthread_mutex_init(&gCliPrintLock, NULL);
     gCliPrintLockInitialized = true;
 
+    // initialize the log ring, each record can be written at its own position first
+    for(i = 0; i < CLI_LOG_RECORDS; i++)
+    {
+        gCliLogRing[i].sequence = i;
+    }
+
+    // initialize the drain semaphore
+    sem_init(&gCliLogSem, 0, 0);
+    sem_setprotocol(&gCliLogSem, SEM_PRIO_NONE);
+
+    // create the drain task
+    lvRetValue =
+        task_create("cliLog", CLI_LOG_DRAIN_PRIORITY, CLI_LOG_DRAIN_STACK_SIZE, cliLogDrainTaskFunc, NULL);
+    if(lvRetValue < 0)
+    {
+        // messages will be printed directly
+        cli_printfError("CLI ERROR: Failed to start log task: %d\n", errno);
+    }
+    else
+    {
+        gCliLogDrainStarted = true;
+
+        // monitor its stack
+        memMon_registerTask("cliLog", "CLI_LOG_DRAIN_STACK_SIZE", lvRetValue, CLI_LOG_DRAIN_STACK_SIZE);
+    }
+
     DEBUGASSERT((sizeof(gStatesArray) / sizeof(char *)) == NUMBER_OF_MAIN_STATES);
     DEBUGASSERT((sizeof(gChargeStatesArray) / sizeof(char *)) == NUMBER_OF_CHARGE_STATES);
     DEBUGASSERT(((sizeof(gGetSetParameters) / sizeof(char *)) - (EXTRA_GET_AND_SET_PARS)) == NONE);
@@ -382,7 +580,8 @@ int cli_processCommands(int argc, char **argv)
     int         i, j;
     const char *lvCommandArray[AMOUNT_COMMANDS] = { HELP_COMMAND, GET_COMMAND, SET_COMMAND, SHOW_COMMAND,
         RESET_COMMAND, SLEEP_COMMAND, WAKE_COMMAND, DEEP_SLEEP_COMMAND, SAVE_COMMAND, LOAD_COMMAND,
-        DEFAULT_COMMAND, TIME_COMMAND };
+        DEFAULT_COMMAND, TIME_COMMAND, STREAM_COMMAND, EXPORT_COMMAND, IMPORT_COMMAND,
+        TRACE_COMMAND, TIMING_COMMAND, POWER_COMMAND, WATCHDOG_COMMAND, MEM_COMMAND };
 
     const char *lvShowCommandArgArr[] = { SHOW_CURRENT, SHOW_AVG_CURRENT, SHOW_CELL_VOLTAGE,
         SHOW_STACK_VOLTAGE, SHOW_BAT_VOLTAGE, SHOW_OUTPUT_STATUS, SHOW_TEMPERATURE, SHOW_ENGERGY_COMS,
@@ -393,8 +592,8 @@ int cli_processCommands(int argc, char **argv)
     char *          lvPStringVal;
     int32_t         lvIntVal    = 0;
     uint64_t        lvUint64Val = 0;
-    struct timespec currentTime;
-    struct timespec sampleTime;
+    uint64_t        currentUs;
+    uint64_t        sampleUs;
 
     // variable to check the MCU power state
     mcuPowerModes_t mcuPowerMode;
@@ -465,6 +664,42 @@ int cli_processCommands(int argc, char **argv)
                 // set the command
                 lvCommands = CLI_TIME;
             }
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[EXPORT_INDEX], strlen(lvCommandArray[EXPORT_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_EXPORT;
+            }
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[TRACE_INDEX], strlen(lvCommandArray[TRACE_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_TRACE;
+            }
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[TIMING_INDEX], strlen(lvCommandArray[TIMING_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_TIMING;
+            }
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[POWER_INDEX], strlen(lvCommandArray[POWER_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_POWER;
+            }
+            else if((!strncmp(lvCommandString, lvCommandArray[WATCHDOG_INDEX],
+                        strlen(lvCommandArray[WATCHDOG_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_WATCHDOG;
+            }
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[MEM_INDEX], strlen(lvCommandArray[MEM_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_MEM;
+            }
 
             break;
 
@@ -477,6 +712,46 @@ int cli_processCommands(int argc, char **argv)
                 lvCommands = CLI_GET;
             }
 
+            // check for a stream command
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[STREAM_INDEX], strlen(lvCommandArray[STREAM_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_STREAM;
+            }
+
+            // check for an import command
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[IMPORT_INDEX], strlen(lvCommandArray[IMPORT_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_IMPORT;
+            }
+
+            // check for a timing command
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[TIMING_INDEX], strlen(lvCommandArray[TIMING_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_TIMING;
+            }
+
+            // check for a power command
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[POWER_INDEX], strlen(lvCommandArray[POWER_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_POWER;
+            }
+
+            // check for a mem command
+            else if((!strncmp(
+                        lvCommandString, lvCommandArray[MEM_INDEX], strlen(lvCommandArray[MEM_INDEX]))))
+            {
+                // set the command
+                lvCommands = CLI_MEM;
+            }
+
             // check for help parameters command
             else if((!strncmp(
                         lvCommandString, lvCommandArray[HELP_INDEX], strlen(lvCommandArray[HELP_INDEX]))))
@@ -764,16 +1039,13 @@ int cli_processCommands(int argc, char **argv)
                             cli_printf("Waking up the BMS... \n");
 
                             // sample the time
-                            if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                            {
-                                cli_printfError("CLI ERROR: failed to get sampleTime!\n");
-                            }
+                            sampleUs = timeBase_getUs();
 
                             // set the current time to the sample time
-                            currentTime.tv_sec = sampleTime.tv_sec;
+                            currentUs = sampleUs;
 
                             // wake up the BMS
-                            gUserCommandCallbackFuntionfp(CLI_WAKE);
+                            gUserCommandCallbackFuntionfp(CLI_WAKE, NULL);
 
                             // get the MCU power state and check for an error
                             mcuPowerMode = power_setNGetMcuPowerMode(false, ERROR_VALUE);
@@ -790,16 +1062,13 @@ int cli_processCommands(int argc, char **argv)
                             // wait until the MCU is not in a mode where the BCC spi is off
                             // or a timeout happens (2-3 seconds)
                             while(((mcuPowerMode == VLPR_MODE) || (mcuPowerMode == ERROR_VALUE)) &&
-                                ((sampleTime.tv_sec + 3) > currentTime.tv_sec))
+                                ((sampleUs + (3 * TIME_BASE_US_PER_S)) > currentUs))
                             {
                                 // sleep for 1ms
                                 usleep(1000);
 
                                 // get the current time
-                                if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                                {
-                                    cli_printfError("CLI ERROR: failed to get currentTime!\n");
-                                }
+                                currentUs = timeBase_getUs();
 
                                 // get the MCU power state and check for an error
                                 mcuPowerMode = power_setNGetMcuPowerMode(false, ERROR_VALUE);
@@ -1102,21 +1371,57 @@ int cli_processCommands(int argc, char **argv)
             // get the current time and output it to the user
 
             // get the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("CLI ERROR: failed to get currentTime!\n");
-
-                lvRetValue = -1;
-                return lvRetValue;
-            }
+            currentUs = timeBase_getUs();
 
             // output the time to the user
-            cli_printf("Time since boot: %ds %dms\n", currentTime.tv_sec, currentTime.tv_nsec / 1000000);
+            cli_printf("Time since boot: %ds %dms\n", (int)(currentUs / TIME_BASE_US_PER_S),
+                (int)((currentUs / TIME_BASE_US_PER_MS) % 1000));
 
             // it went ok
             lvRetValue = 0;
             break;
 
+        // in case of stream
+        case CLI_STREAM:
+
+            // get the fields, it may be hexadecimal
+            lvIntVal = strtol(lvParameterString, NULL, 0);
+
+            // check if the input is OK
+            if(lvIntVal >= 0 && lvIntVal <= CLI_STREAM_ALL)
+            {
+                // check if it needs to stop
+                if(!lvIntVal)
+                {
+                    gStreamFields = 0;
+                    cli_printf("stopped the stream\n");
+                }
+                else
+                {
+                    cli_printf("streaming fields 0x%02x\n", lvIntVal);
+                    gStreamSequence = 0;
+                    gStreamFields   = (uint16_t)lvIntVal;
+                }
+
+                lvRetValue = 0;
+            }
+            else
+            {
+                cli_printf("wrong value! try \"bms help\"\n");
+            }
+
+            break;
+
+        // in case of export
+        case CLI_EXPORT:
+            lvRetValue = exportParameters();
+            break;
+
+        // in case of import
+        case CLI_IMPORT:
+            lvRetValue = importParameters(lvParameterString);
+            break;
+
         // in case of show
         case CLI_SHOW:
 
@@ -1169,7 +1474,7 @@ int cli_processCommands(int argc, char **argv)
         // it is an other command
         default:
             // call the callback
-            lvRetValue = gUserCommandCallbackFuntionfp(lvCommands);
+            lvRetValue = gUserCommandCallbackFuntionfp(lvCommands, (argc > 2) ? lvParameterString : NULL);
             break;
     }
 
@@ -1197,20 +1502,23 @@ int cli_printf(FAR const IPTR char *fmt, ...)
     int             lvRetValue;
     struct timespec waitTime;
 
-    // check if mutex is initialzed
-    if(gCliPrintLockInitialized)
+    // check if the message should be printed by the drain task
+    if(cliLogShouldDefer())
     {
-        // get the time
-        if(clock_gettime(CLOCK_REALTIME, &waitTime) == -1)
-        {
-            cli_printfError("CLI ERROR: failed to get time!\n");
-        }
+        // initialze variable list ap
+        va_start(ap, fmt);
 
-        // add the time
-        waitTime.tv_sec += (int)(CLI_TIMED_LOCK_WAIT_TIME_MS / 1000) +
-            ((waitTime.tv_nsec + (CLI_TIMED_LOCK_WAIT_TIME_MS % 1000) * MS_TO_NS_MULT) / (NSEC_MAX + 1));
-        waitTime.tv_nsec =
-            (waitTime.tv_nsec + (CLI_TIMED_LOCK_WAIT_TIME_MS % 1000) * MS_TO_NS_MULT) % (NSEC_MAX + 1);
+        // put it in the log ring
+        lvRetValue = cliLogEnqueue(NO_COLOR, fmt, ap);
+
+        // end the variable list
+        va_end(ap);
+    }
+    // check if mutex is initialzed
+    else if(gCliPrintLockInitialized)
+    {
+        // make the wait time, pthread_mutex_timedlock() needs the realtime clock
+        timeBase_toRealtime(timeBase_getUs() + (CLI_TIMED_LOCK_WAIT_TIME_MS * TIME_BASE_US_PER_MS), &waitTime);
 
         // lock the mutex
         lvRetValue = pthread_mutex_timedlock(&gCliPrintLock, &waitTime);
@@ -1480,6 +1788,74 @@ int cli_printLock(bool lock)
     return lvRetValue;
 }
 
+/*!
+ * @brief   this function sends the current samples as CLI_STREAM_CURRENT_SAMPLES stream frames,
+ *          if that field is streamed. A frame is sent with each CLI_STREAM_MAX_SAMPLES samples.
+ *
+ * @param   pCurrent the currents of the samples in A
+ * @param   pTimeUs the times of the samples in us, the lower 32 bits of timeBase_getUs()
+ * @param   samples the amount of samples
+ *
+ * @return  0 If successful (or not streamed), otherwise -1
+ */
+int cli_streamCurrentSamples(const float *pCurrent, const uint32_t *pTimeUs, uint8_t samples)
+{
+    uint64_t currentUs, sampleUs;
+    int      lvRetValue = 0;
+    uint8_t  i;
+
+    // check if the current samples are streamed, the samples that are not sent yet are dropped if not
+    if(!(gStreamFields & CLI_STREAM_CURRENT_SAMPLES))
+    {
+        gStreamSampleCount = 0;
+        return 0;
+    }
+
+    // get the time to make the whole time of the samples
+    currentUs = timeBase_getUs();
+
+    for(i = 0; i < samples; i++)
+    {
+        // the sample is taken before now, so the difference of the lower 32 bits is the age
+        sampleUs = currentUs - (uint32_t)((uint32_t)currentUs - pTimeUs[i]);
+
+        // send the frame if the time after the frame time doesn't fit
+        if(gStreamSampleCount && (((sampleUs - gStreamSampleFrameUs) / 10) > UINT16_MAX))
+        {
+            gStreamSampleBody[gStreamSampleCountIndex] = gStreamSampleCount;
+            lvRetValue |= streamSendFrame(gStreamSampleBody, gStreamSampleLength);
+            gStreamSampleCount = 0;
+        }
+
+        // start a new frame with the time of this sample
+        if(!gStreamSampleCount)
+        {
+            gStreamSampleLength  = 0;
+            gStreamSampleFrameUs = sampleUs - (sampleUs % TIME_BASE_US_PER_MS);
+            streamPutHeader(gStreamSampleBody, &gStreamSampleLength, CLI_STREAM_CURRENT_SAMPLES,
+                (uint32_t)(gStreamSampleFrameUs / TIME_BASE_US_PER_MS));
+            gStreamSampleCountIndex = gStreamSampleLength;
+            streamPut(gStreamSampleBody, &gStreamSampleLength, 0, 1);
+        }
+
+        // add the sample
+        streamPut(
+            gStreamSampleBody, &gStreamSampleLength, (uint32_t)((sampleUs - gStreamSampleFrameUs) / 10), 2);
+        streamPut(gStreamSampleBody, &gStreamSampleLength, (uint32_t)(int32_t)(pCurrent[i] * 1000), 4);
+        gStreamSampleCount++;
+
+        // send the frame when it is full
+        if(gStreamSampleCount == CLI_STREAM_MAX_SAMPLES)
+        {
+            gStreamSampleBody[gStreamSampleCountIndex] = gStreamSampleCount;
+            lvRetValue |= streamSendFrame(gStreamSampleBody, gStreamSampleLength);
+            gStreamSampleCount = 0;
+        }
+    }
+
+    return lvRetValue ? -1 : 0;
+}
+
 /*!
  * @brief   this function is used to update the data on the CLI when needed.
  *
@@ -1501,6 +1877,12 @@ int cli_updateData(
     DEBUGASSERT(pCommonBatteryVariables != NULL);
     DEBUGASSERT(pCalcBatteryVariables != NULL);
 
+    // check if the binary stream is on, the text output is off while streaming
+    if(gStreamFields)
+    {
+        return streamData(pCommonBatteryVariables, pCalcBatteryVariables);
+    }
+
     // check if anything needs to be send over the CLI
     if(gShowMeasurements)
     {
@@ -1962,6 +2344,35 @@ void printHelp(void)
         "bms load                  --this command will load the saved settings (parameters) from flash\n");
     cli_printf("bms default               --this command will load the default settings\n");
     cli_printf("bms time                  --this command will output the time since boot\n");
+    cli_printf("bms stream <x>            --this command streams the measurements in binary frames\n");
+    cli_printf("                            x is the sum of the fields to stream, 0 stops the stream\n");
+    cli_printf("                            1: i-batt, 2: cells, 4: temperatures, 8: soc, 16: state\n");
+    cli_printf("                            32: faults, 64: current statistics, 128: each current\n");
+    cli_printf("                            sample (every 3ms) in frames of its own, 255 (0xff): all.\n");
+    cli_printf("                            The text measurements are not shown while streaming,\n");
+    cli_printf("                            see cli.h for the format\n");
+    cli_printf("bms export                --this command exports the changeable saved parameters\n");
+    cli_printf("                            as \"bms import <x>\" lines, enter these to import them\n");
+    cli_printf("bms import <x>            --this command imports exported parameters\n");
+    cli_printf("                            x is the next hex part of the export, apply imports it\n");
+    cli_printf("                            all at once if all values are OK and clear discards it\n");
+    cli_printf("                            use bms save afterwards to save them to flash\n");
+    cli_printf("bms trace                 --this command outputs the last state transitions with the\n");
+    cli_printf("                            time since boot and the cause\n");
+    cli_printf("bms timing [reset|x]      --this command outputs the timing of the measurement loop:\n");
+    cli_printf("                            period, jitter, SPI, calculation and callback times and\n");
+    cli_printf("                            deadline misses. reset clears them and x sets the jitter\n");
+    cli_printf("                            alarm in us (0 is off)\n");
+    cli_printf("bms power [reset]         --this command outputs the time, the time in RUN mode and the\n");
+    cli_printf("                            wake-ups (batches) of each main state and which task woke\n");
+    cli_printf("                            the MCU. reset clears them\n");
+    cli_printf("bms watchdog              --this command outputs the tasks the watchdog supervisor checks:\n");
+    cli_printf("                            their deadline, the time left (slack), the lowest slack\n");
+    cli_printf("                            and the misses, and the watchdog kicks and SPI transfers\n");
+    cli_printf("bms mem [report]          --this command outputs the stack size, use and high-water mark\n");
+    cli_printf("                            of each task and the heap and CAN memory pool use and peak.\n");
+    cli_printf("                            report also outputs the suggested size defines, use it\n");
+    cli_printf("                            after a soak run in all states\n");
     cli_printf("reboot                    --this command will reboot the microcontroller\n");
     cli_printf(
         "                            this command should be used without the word bms in front of it\n\n");
@@ -2224,20 +2635,17 @@ int cli_printfColor(printColor_t color, const char *fmt, va_list argp)
             break;
     }
 
+    // check if the message should be printed by the drain task
+    if(cliLogShouldDefer())
+    {
+        // put it in the log ring
+        lvRetValue = cliLogEnqueue(color, fmt, argp);
+    }
     // check if mutex is initialzed
-    if(gCliPrintLockInitialized)
+    else if(gCliPrintLockInitialized)
     {
-        // get the time
-        if(clock_gettime(CLOCK_REALTIME, &waitTime) == -1)
-        {
-            cli_printf("%sCLI ERROR: failed to get time!\e[39m\n", "\e[31m");
-        }
-
-        // add the time
-        waitTime.tv_sec += (int)(CLI_TIMED_LOCK_WAIT_TIME_MS / 1000) +
-            ((waitTime.tv_nsec + (CLI_TIMED_LOCK_WAIT_TIME_MS % 1000) * MS_TO_NS_MULT) / (NSEC_MAX + 1));
-        waitTime.tv_nsec =
-            (waitTime.tv_nsec + (CLI_TIMED_LOCK_WAIT_TIME_MS % 1000) * MS_TO_NS_MULT) % (NSEC_MAX + 1);
+        // make the wait time, pthread_mutex_timedlock() needs the realtime clock
+        timeBase_toRealtime(timeBase_getUs() + (CLI_TIMED_LOCK_WAIT_TIME_MS * TIME_BASE_US_PER_MS), &waitTime);
 
         // lock the mutex
         lvRetValue = pthread_mutex_timedlock(&gCliPrintLock, &waitTime);
@@ -2286,6 +2694,194 @@ int cli_printfColor(printColor_t color, const char *fmt, va_list argp)
     return lvRetValue;
 }
 
+/*!
+ * @brief   this function checks if a message of the calling task should be deferred to the drain task.
+ *          Only tasks with a higher priority than the drain task will defer, the others print directly.
+ *
+ * @return  true if the message should be put in the log ring
+ */
+static bool cliLogShouldDefer(void)
+{
+    struct sched_param param;
+
+    // check if the drain task is running
+    if(!gCliLogDrainStarted)
+    {
+        return false;
+    }
+
+    // get the priority of the calling task
+    if(sched_getparam(0, &param))
+    {
+        return false;
+    }
+
+    // tasks with a lower priority (like the shell) can wait for the console themselves
+    return param.sched_priority > CLI_LOG_DRAIN_PRIORITY;
+}
+
+/*!
+ * @brief   this function formats a message in a free record of the log ring without waiting.
+ *          If the ring is full, the message is dropped and counted.
+ *
+ * @param   color the printColor_t of the message
+ * @param   fmt the format string
+ * @param   argp the arguments of the format string
+ *
+ * @return  the amount of formatted characters, or -1 if the message is dropped
+ */
+static int cliLogEnqueue(printColor_t color, const char *fmt, va_list argp)
+{
+    cliLogRecord_t *record;
+    uint32_t        position;
+    int32_t         difference;
+    int             lvRetValue;
+
+    // get the position to write
+    position = __atomic_load_n(&gCliLogHead, __ATOMIC_RELAXED);
+
+    // claim a record
+    while(1)
+    {
+        record     = &gCliLogRing[position & (CLI_LOG_RECORDS - 1)];
+        difference = (int32_t)(__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) - position);
+
+        // check if the record is free at this position
+        if(difference == 0)
+        {
+            // try to claim it, on failure position is updated with the new head
+            if(__atomic_compare_exchange_n(
+                   &gCliLogHead, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        // check if the record isn't printed yet, the ring is full
+        else if(difference < 0)
+        {
+            // drop the message
+            __atomic_fetch_add(&gCliLogDropped, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+        // another task claimed it, try again
+        else
+        {
+            position = __atomic_load_n(&gCliLogHead, __ATOMIC_RELAXED);
+        }
+    }
+
+    // format the message in the record
+    record->color = (uint8_t)color;
+    lvRetValue    = vsnprintf(record->text, CLI_LOG_RECORD_LENGTH, fmt, argp);
+
+    // check if it is truncated
+    if(lvRetValue >= CLI_LOG_RECORD_LENGTH)
+    {
+        // end it with a new line
+        record->text[CLI_LOG_RECORD_LENGTH - 2] = '\n';
+        __atomic_fetch_add(&gCliLogTruncated, 1, __ATOMIC_RELAXED);
+    }
+    else if(lvRetValue < 0)
+    {
+        record->text[0] = '\0';
+    }
+
+    // publish it to the drain task
+    __atomic_store_n(&record->sequence, position + 1, __ATOMIC_RELEASE);
+
+    // wake up the drain task
+    sem_post(&gCliLogSem);
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   this is the task that prints the messages of the log ring on the console
+ *
+ * @param   argc the amount of arguments
+ * @param   argv the arguments
+ *
+ * @return  should not return
+ */
+static int cliLogDrainTaskFunc(int argc, char *argv[])
+{
+    cliLogRecord_t *record;
+    uint32_t        dropped, truncated;
+    uint32_t        reportedDropped = 0, reportedTruncated = 0;
+    const char *    colorSequence;
+
+    while(1)
+    {
+        // wait for a message
+        sem_wait(&gCliLogSem);
+
+        // print all the published records
+        while(1)
+        {
+            record = &gCliLogRing[gCliLogTail & (CLI_LOG_RECORDS - 1)];
+
+            // check if the record is published
+            if(__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != (gCliLogTail + 1))
+            {
+                break;
+            }
+
+            // get the color sequence
+            switch(record->color)
+            {
+                case RED:
+                    colorSequence = "\e[31m";
+                    break;
+                case GREEN:
+                    colorSequence = "\e[32m";
+                    break;
+                case YELLOW:
+                    colorSequence = "\e[33m";
+                    break;
+                default:
+                    colorSequence = NULL;
+                    break;
+            }
+
+            // print it, without mixing with the cli_printLock() users
+            pthread_mutex_lock(&gCliPrintLock);
+
+            if(colorSequence != NULL)
+            {
+                printf("%s%s\e[39m", colorSequence, record->text);
+            }
+            else
+            {
+                printf("%s", record->text);
+            }
+
+            pthread_mutex_unlock(&gCliPrintLock);
+
+            // free the record for the position one ring further
+            __atomic_store_n(&record->sequence, gCliLogTail + CLI_LOG_RECORDS, __ATOMIC_RELEASE);
+            gCliLogTail++;
+        }
+
+        // report the dropped and truncated messages
+        dropped   = __atomic_load_n(&gCliLogDropped, __ATOMIC_RELAXED);
+        truncated = __atomic_load_n(&gCliLogTruncated, __ATOMIC_RELAXED);
+
+        if((dropped != reportedDropped) || (truncated != reportedTruncated))
+        {
+            pthread_mutex_lock(&gCliPrintLock);
+            printf("\e[33mCLI WARNING: log messages dropped: %" PRIu32 " (+%" PRIu32 "), truncated: %" PRIu32
+                   " (+%" PRIu32 ")\e[39m\n",
+                dropped, dropped - reportedDropped, truncated, truncated - reportedTruncated);
+            pthread_mutex_unlock(&gCliPrintLock);
+
+            reportedDropped   = dropped;
+            reportedTruncated = truncated;
+        }
+    }
+
+    return 0;
+}
+
 /*!
  * @brief   this function can be used to change what is viewed
  *          on the CLI (the new measurements)
@@ -2448,3 +3044,301 @@ void setShowMeas(showCommands_t showCommand, bool value)
         }
     }
 }
+
+/*!
+ * @brief   this function places a little endian value in a buffer
+ *
+ * @param   pBuffer the address of the buffer
+ * @param   pIndex the address of the index in the buffer, it will be increased with the size
+ * @param   value the value to place
+ * @param   size the amount of bytes to place
+ */
+static void streamPut(uint8_t *pBuffer, uint8_t *pIndex, uint32_t value, uint8_t size)
+{
+    uint8_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        pBuffer[(*pIndex)++] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+/*!
+ * @brief   this function sends the selected fields of the measurements as one binary stream frame
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ *
+ * @return  0 If successful, otherwise an error will indicate the error
+ */
+static int streamData(
+    commonBatteryVariables_t *pCommonBatteryVariables, calcBatteryVariables_t *pCalcBatteryVariables)
+{
+    uint8_t           body[CLI_STREAM_MAX_BODY];
+    uint8_t           bodyLength = 0;
+    uint16_t          fields     = gStreamFields & ~CLI_STREAM_CURRENT_SAMPLES;
+    measStatsResult_t currentStats;
+    int               bmsFault;
+    uint8_t           i;
+
+    // check if there are fields for this frame, the current samples have frames of their own
+    if(!fields)
+    {
+        return 0;
+    }
+
+    // make the header
+    streamPutHeader(body, &bodyLength, fields, (uint32_t)(timeBase_getUs() / TIME_BASE_US_PER_MS));
+
+    // add the selected fields
+    if(fields & CLI_STREAM_I_BATT)
+    {
+        streamPut(body, &bodyLength, (uint32_t)(int32_t)(pCommonBatteryVariables->I_batt * 1000), 4);
+    }
+    if(fields & CLI_STREAM_CELLS)
+    {
+        streamPut(body, &bodyLength, pCommonBatteryVariables->N_cells, 1);
+
+        for(i = 0; (i < pCommonBatteryVariables->N_cells) && (i < 6); i++)
+        {
+            streamPut(body, &bodyLength,
+                (uint16_t)(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i] * 1000), 2);
+        }
+    }
+    if(fields & CLI_STREAM_TEMPERATURE)
+    {
+        streamPut(body, &bodyLength, (uint16_t)(int16_t)(pCommonBatteryVariables->C_batt * 10), 2);
+        streamPut(body, &bodyLength, (uint16_t)(int16_t)(pCommonBatteryVariables->C_AFE * 10), 2);
+        streamPut(body, &bodyLength, (uint16_t)(int16_t)(pCommonBatteryVariables->C_T * 10), 2);
+        streamPut(body, &bodyLength, (uint16_t)(int16_t)(pCommonBatteryVariables->C_R * 10), 2);
+    }
+    if(fields & CLI_STREAM_SOC)
+    {
+        streamPut(body, &bodyLength, pCalcBatteryVariables->s_charge, 1);
+    }
+    if(fields & CLI_STREAM_STATE)
+    {
+        streamPut(body, &bodyLength, (uint8_t)data_getMainState(), 1);
+        streamPut(body, &bodyLength, (uint8_t)data_getChargeState(), 1);
+    }
+    if(fields & CLI_STREAM_FAULTS)
+    {
+        bmsFault = data_getBmsFault();
+        streamPut(body, &bodyLength, (bmsFault < 0) ? 0 : (uint8_t)bmsFault, 1);
+    }
+    if(fields & CLI_STREAM_CURRENT_STATS)
+    {
+        for(i = 0; i < MEAS_STATS_WINDOWS; i++)
+        {
+            // send zeros if there are no statistics (yet)
+            if(measStats_getWindow(MEAS_STATS_CURRENT, (measStatsWindow_t)i, &currentStats) ||
+                !currentStats.count)
+            {
+                memset(&currentStats, 0, sizeof(currentStats));
+            }
+
+            streamPut(body, &bodyLength, (uint32_t)(int32_t)(currentStats.mean * 1000), 4);
+            streamPut(body, &bodyLength, (uint32_t)(int32_t)(currentStats.min * 1000), 4);
+            streamPut(body, &bodyLength, (uint32_t)(int32_t)(currentStats.max * 1000), 4);
+            streamPut(body, &bodyLength, (uint32_t)(currentStats.rms * 1000), 4);
+        }
+    }
+
+    // send it
+    return streamSendFrame(body, bodyLength);
+}
+
+/*!
+ * @brief   this function places the header of a stream frame in the body
+ *
+ * @param   pBody the address of the body
+ * @param   pBodyLength the address of the length of the body, it will be increased with the header
+ * @param   fields the CLI_STREAM_* fields of the frame
+ * @param   timeMs the time of the frame in ms
+ */
+static void streamPutHeader(uint8_t *pBody, uint8_t *pBodyLength, uint16_t fields, uint32_t timeMs)
+{
+    // the sequence number is set when it is sent
+    streamPut(pBody, pBodyLength, CLI_STREAM_VERSION, 1);
+    streamPut(pBody, pBodyLength, 0, 1);
+    streamPut(pBody, pBodyLength, fields, 2);
+    streamPut(pBody, pBodyLength, timeMs, 4);
+}
+
+/*!
+ * @brief   this function sets the sequence number and adds the CRC to the body of a stream frame
+ *          and sends it escaped between two CLI_STREAM_FLAG bytes
+ *
+ * @param   pBody the address of the body, with room for the CRC
+ * @param   bodyLength the length of the body without the CRC
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int streamSendFrame(uint8_t *pBody, uint8_t bodyLength)
+{
+    uint8_t  frame[(CLI_STREAM_MAX_BODY * 2) + 2];
+    uint8_t  frameLength = 0;
+    uint16_t crc         = 0xFFFF;
+    int      lvRetValue;
+    uint8_t  i, j;
+
+    // the frames of the tasks are sent in the order of their sequence numbers
+    pthread_mutex_lock(&gCliPrintLock);
+
+    pBody[1] = gStreamSequence++;
+
+    // calculate the CRC-16/CCITT-FALSE of the body
+    for(i = 0; i < bodyLength; i++)
+    {
+        crc ^= (uint16_t)pBody[i] << 8;
+
+        for(j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    // add the CRC
+    streamPut(pBody, &bodyLength, crc, 2);
+
+    // make the frame with the escaped body
+    frame[frameLength++] = CLI_STREAM_FLAG;
+
+    for(i = 0; i < bodyLength; i++)
+    {
+        // check if it needs to be escaped
+        if((pBody[i] == CLI_STREAM_FLAG) || (pBody[i] == CLI_STREAM_ESCAPE) || (pBody[i] == '\n') ||
+            (pBody[i] == '\r'))
+        {
+            frame[frameLength++] = CLI_STREAM_ESCAPE;
+            frame[frameLength++] = pBody[i] ^ CLI_STREAM_ESCAPE_XOR;
+        }
+        else
+        {
+            frame[frameLength++] = pBody[i];
+        }
+    }
+
+    frame[frameLength++] = CLI_STREAM_FLAG;
+
+    // write the frame in one piece
+    lvRetValue = (fwrite(frame, 1, frameLength, stdout) == frameLength) ? 0 : -1;
+    fflush(stdout);
+
+    pthread_mutex_unlock(&gCliPrintLock);
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   this function prints the parameter blob of all the parameters as "bms import <hex>" lines
+ *          followed by "bms import apply", so the output can be entered again to import it
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int exportParameters(void)
+{
+    uint8_t         blob[PARAMETER_BLOB_MAX_SIZE];
+    char            line[CLI_EXPORT_BYTES_PER_LINE * 2 + 1];
+    parameterKind_t nextParameter = (parameterKind_t)0;
+    int             length, i;
+
+    // make the blob with all the parameters
+    length = data_exportParameters(blob, sizeof(blob), &nextParameter);
+    if(length < 0 || nextParameter != NONE)
+    {
+        cli_printfError("CLI ERROR: couldn't export the parameters!\n");
+        return -1;
+    }
+
+    // output it as hex lines
+    for(i = 0; i < length; i++)
+    {
+        snprintf(&line[(i % CLI_EXPORT_BYTES_PER_LINE) * 2], 3, "%02x", blob[i]);
+
+        // check if the line is full or it is the last byte
+        if(((i % CLI_EXPORT_BYTES_PER_LINE) == (CLI_EXPORT_BYTES_PER_LINE - 1)) || (i == (length - 1)))
+        {
+            cli_printf("bms %s %s\n", IMPORT_COMMAND, line);
+        }
+    }
+
+    cli_printf("bms %s %s\n", IMPORT_COMMAND, IMPORT_APPLY);
+
+    return 0;
+}
+
+/*!
+ * @brief   this function handles "bms import <x>", it adds the hex bytes to the import blob,
+ *          imports the blob with "apply" or clears it with "clear"
+ *
+ * @param   pString the hex string, IMPORT_APPLY or IMPORT_CLEAR
+ *
+ * @return  0 If successful, otherwise -1
+ */
+static int importParameters(const char *pString)
+{
+    size_t  length = strlen(pString);
+    size_t  i;
+    int     amount;
+    uint8_t nibble;
+
+    // check if it needs to be cleared
+    if(!strcmp(pString, IMPORT_CLEAR))
+    {
+        gImportBlobLength = 0;
+        cli_printf("cleared the import\n");
+        return 0;
+    }
+
+    // check if it needs to be imported
+    if(!strcmp(pString, IMPORT_APPLY))
+    {
+        // import it all at once and start over
+        amount            = data_importParameters(gImportBlob, gImportBlobLength);
+        gImportBlobLength = 0;
+
+        if(amount < 0)
+        {
+            cli_printfError("CLI ERROR: import failed! %d\n", amount);
+            return -1;
+        }
+
+        cli_printf("imported %d parameters, use \"bms save\" to save them\n", amount);
+        return 0;
+    }
+
+    // check the length of the hex string
+    if((length % 2) || ((gImportBlobLength + length / 2) > PARAMETER_BLOB_MAX_SIZE))
+    {
+        cli_printfError("CLI ERROR: wrong import length!\n");
+        return -1;
+    }
+
+    // convert the hex characters after the received bytes
+    for(i = 0; i < length; i++)
+    {
+        if(!isxdigit((unsigned char)pString[i]))
+        {
+            cli_printfError("CLI ERROR: \"%s\" is not hex!\n", pString);
+            return -1;
+        }
+
+        nibble = isdigit((unsigned char)pString[i]) ? (pString[i] - '0') :
+                                                      (tolower((unsigned char)pString[i]) - 'a' + 10);
+
+        if(!(i % 2))
+        {
+            gImportBlob[gImportBlobLength + i / 2] = nibble << 4;
+        }
+        else
+        {
+            gImportBlob[gImportBlobLength + i / 2] |= nibble;
+        }
+    }
+
+    // the bytes are received
+    gImportBlobLength += length / 2;
+
+    return 0;
+}
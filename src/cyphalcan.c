@@ -75,6 +75,10 @@
 #include "o1heap.h"
 
 #include "data.h"
+#include "batManagement.h"
+#include "measStats.h"
+#include "supervisor.h"
+#include "memMon.h"
 
 #include "pnp.h"
 #include "portid.h"
@@ -88,6 +92,7 @@
 #include "uavcan/node/Heartbeat_1_0.h"
 #include "uavcan/node/GetInfo_1_0.h"
 #include "legacy/equipment/power/BatteryInfo_1_0.h"
+#include "uavcan/diagnostic/Record_1_1.h"
 
 /****************************************************************************
  * Defines
@@ -119,6 +124,7 @@
 #define CYPHALCAN_DAEMON_PRIORITY   110
 #define CYPHALCAN_DAEMON_STACK_SIZE 3100 // 4000
 #define CAN_DEVICE                  "can0"
+#define CAN_SUPERVISOR_DEADLINE_MS  2000 //!< the time the handling of the received or published data may take
 
 #define CELSIUS_TO_KELVIN       272.15
 #define AMPERE_HOURS_TO_COULOMB 3600
@@ -154,6 +160,8 @@ static bool g_canard_daemon_started;
 
 static uint8_t my_message_transfer_id; // Must be static or heap-allocated to retain state between calls.
 
+static uint8_t gTimingTransferId; // The transfer-ID of the diagnostic records (timing and current statistics).
+
 /****************************************************************************
  * private Functions declerations
  ****************************************************************************/
@@ -192,6 +200,10 @@ static void BatteryParametersToTransmitBuffer(CanardInstance *ins);
 
 static void BatteryInfoToTransmitBuffer(CanardInstance *ins);
 
+static void TimingDiagnosticToTransmitBuffer(CanardInstance *ins);
+
+static void CurrentStatsDiagnosticToTransmitBuffer(CanardInstance *ins);
+
 // static void processReceivedTransfer(CanardTransfer *receive);
 
 static bool processTxRxOnce(CanardInstance *ins, CanardSocketInstance *sock_ins, int timeout_msec);
@@ -234,6 +246,9 @@ int cyphalcan_initialize(void)
         }
         else
         {
+            // monitor its stack
+            memMon_registerTask("CYHALCAN", "CYPHALCAN_DAEMON_STACK_SIZE", ret, CYPHALCAN_DAEMON_STACK_SIZE);
+
             ret = 0;
         }
 
@@ -287,9 +302,7 @@ int32_t set_energy_source_port_id(uavcan_register_Value_1_0 *value)
     if(uavcan_register_Value_1_0_is_natural16_(value) && value->natural16.value.count == 1)
     { // Natural 16
         // TODO check validity
-        void *dataReturn;
-        dataReturn = (int32_t *)data_setParameter(CYPHAL_ES_SUB_ID, &value->natural16.value.elements[0]);
-        if(dataReturn == NULL)
+        if(data_setParameter(CYPHAL_ES_SUB_ID, &value->natural16.value.elements[0]) != 0)
         {
             return -CYPHAL_REGISTER_ERROR_SERIALIZATION;
         }
@@ -318,9 +331,7 @@ int32_t set_battery_status_port_id(uavcan_register_Value_1_0 *value)
     if(uavcan_register_Value_1_0_is_natural16_(value) && value->natural16.value.count == 1)
     { // Natural 16
         // TODO check validity
-        void *dataReturn;
-        dataReturn = (int32_t *)data_setParameter(CYPHAL_BS_SUB_ID, &value->natural16.value.elements[0]);
-        if(dataReturn == NULL)
+        if(data_setParameter(CYPHAL_BS_SUB_ID, &value->natural16.value.elements[0]) != 0)
         {
             return -CYPHAL_REGISTER_ERROR_SERIALIZATION;
         }
@@ -349,9 +360,7 @@ int32_t set_battery_parameter_port_id(uavcan_register_Value_1_0 *value)
     if(uavcan_register_Value_1_0_is_natural16_(value) && value->natural16.value.count == 1)
     { // Natural 16
         // TODO check validity
-        void *dataReturn;
-        dataReturn = (int32_t *)data_setParameter(CYPHAL_BP_SUB_ID, &value->natural16.value.elements[0]);
-        if(dataReturn == NULL)
+        if(data_setParameter(CYPHAL_BP_SUB_ID, &value->natural16.value.elements[0]) != 0)
         {
             return -CYPHAL_REGISTER_ERROR_SERIALIZATION;
         }
@@ -380,10 +389,7 @@ int32_t set_battery_info_port_id(uavcan_register_Value_1_0 *value)
     if(uavcan_register_Value_1_0_is_natural16_(value) && value->natural16.value.count == 1)
     { // Natural 16
         // TODO check validity
-        void *dataReturn;
-        dataReturn =
-            (int32_t *)data_setParameter(CYPHAL_LEGACY_BI_SUB_ID, &value->natural16.value.elements[0]);
-        if(dataReturn == NULL)
+        if(data_setParameter(CYPHAL_LEGACY_BI_SUB_ID, &value->natural16.value.elements[0]) != 0)
         {
             return -CYPHAL_REGISTER_ERROR_SERIALIZATION;
         }
@@ -572,6 +578,12 @@ static int32_t cyphalcan_task_initialize(CanardInstance *ins, CanardSocketInstan
         "battery_parameters", set_battery_parameter_port_id, get_battery_parameter_port_id);
     cyphal_register_interface_add_entry("battery_info", set_battery_info_port_id, get_battery_info_port_id);
 
+    // add all the BMS parameters as registers as well
+    if(cyphal_register_interface_add_parameters() != 0)
+    {
+        cli_printfError("CYPHALCANTask ERROR: couldn't add the parameter registers!\n");
+    }
+
     (void)canardRxSubscribe(ins, // Subscribe to messages uavcan.node.Heartbeat.
         CanardTransferKindMessage,
         32085, // The fixed Subject-ID of the Heartbeat message type (see DSDL definition).
@@ -601,6 +613,7 @@ static int CYPHALCANTask(int argc, char *argv[])
     void *               dataReturn;
     uint16_t             t_meas;
     bool                 publish = false;
+    O1HeapDiagnostics    heapDiagnostics;
 
     // initialize eventfd to signal select while reading
     if((efd = eventfd(0, 0)) < 0)
@@ -681,6 +694,18 @@ static int CYPHALCANTask(int argc, char *argv[])
                     // make the battery parameter message
                     BatteryParametersToTransmitBuffer(&ins);
 
+                    // make the measurement loop timing diagnostic record
+                    TimingDiagnosticToTransmitBuffer(&ins);
+
+                    // make the current statistics diagnostic record
+                    CurrentStatsDiagnosticToTransmitBuffer(&ins);
+
+                    // update the use of the o1heap, the peak is kept by o1heap
+                    heapDiagnostics = o1heapGetDiagnostics(my_allocator);
+                    memMon_setPool(MEM_MON_POOL_CYPHAL, O1_HEAP_SIZE, heapDiagnostics.capacity,
+                        heapDiagnostics.allocated, heapDiagnostics.peak_allocated,
+                        (uint32_t)heapDiagnostics.oom_count);
+
                     // reset count
                     countBP = 0;
                 }
@@ -784,9 +809,9 @@ void EnergySourceToTransmitBuffer(CanardInstance *ins)
     // make the battery status struct
     reg_drone_physics_electricity_SourceTs_0_1 energySource;
 
-    // make the timestamp
-    // leave it empty for now
-    energySource.timestamp.microsecond = 0;
+    // make the timestamp, the time of the measurement
+    // there is no time synchronization, so it is the monotonic time of the BMS (0 if unknown)
+    energySource.timestamp.microsecond = data_getMeasurementTimeUs();
 
     // make the value
 
@@ -2134,6 +2159,7 @@ bool processTxRxOnce(CanardInstance *ins, CanardSocketInstance *sock_ins, int ti
 {
     int32_t result;
     bool publish = false;
+    int pollResult;
 
     /* Transmitting */
     for(const CanardFrame *txf = NULL; (txf = canardTxPeek(ins)) != NULL;)
@@ -2150,8 +2176,16 @@ bool processTxRxOnce(CanardInstance *ins, CanardSocketInstance *sock_ins, int ti
         ins->memory_free(ins, (CanardFrame *)txf); // Deallocate the dynamic memory afterwards.
     }
 
+    // don't supervise the task while it waits
+    supervisor_checkIn(SUPERVISOR_CAN, SUPERVISOR_OFF);
+
     // wait for either can messages or the BMS application
-    if(poll(pfds, 2, -1) > 0)
+    pollResult = poll(pfds, 2, -1);
+
+    // supervise the handling of it
+    supervisor_checkIn(SUPERVISOR_CAN, CAN_SUPERVISOR_DEADLINE_MS);
+
+    if(pollResult > 0)
     {
         // if it is CAN communication
         if(pfds[0].revents & POLLIN)
@@ -2227,3 +2261,170 @@ bool processTxRxOnce(CanardInstance *ins, CanardSocketInstance *sock_ins, int ti
     // return if to publish the BMS data on CyphalCAN
     return publish;
 }
+
+/****************************************************************************
+ * Name: TimingDiagnosticToTransmitBuffer
+ *
+ * Description:
+ *   This function is called at 0.2 Hz rate from the main loop to send the
+ *   timing of the measurement loop as uavcan.diagnostic.Record, with
+ *   severity warning if the jitter alarm is active.
+ *
+ ****************************************************************************/
+
+void TimingDiagnosticToTransmitBuffer(CanardInstance *ins)
+{
+    batManagTiming_t timing;
+    int              length;
+
+    CanardMicrosecond transmission_deadline = getMonotonicTimestampUSec() + 1000 * 10;
+
+    // get the timing statistics
+    if(batManagement_getTiming(&timing))
+    {
+        return;
+    }
+
+    // make the payload buffer
+    uint8_t record_payload_buffer[uavcan_diagnostic_Record_1_1_SERIALIZATION_BUFFER_SIZE_BYTES_];
+
+    // make the canard transfer struct
+    CanardTransfer transfer = {
+        .timestamp_usec = transmission_deadline, // Zero if transmission deadline is not limited.
+        .priority       = CanardPriorityOptional,
+        .transfer_kind  = CanardTransferKindMessage,
+        .port_id        = uavcan_diagnostic_Record_1_1_FIXED_PORT_ID_, // This is the subject-ID.
+        .remote_node_id = CANARD_NODE_ID_UNSET, // Messages cannot be unicast, so use UNSET.
+        .transfer_id    = gTimingTransferId,
+        .payload_size   = uavcan_diagnostic_Record_1_1_SERIALIZATION_BUFFER_SIZE_BYTES_,
+        .payload        = &record_payload_buffer,
+    };
+
+    // make the diagnostic record with the monotonic time of the BMS
+    uavcan_diagnostic_Record_1_1 record;
+
+    record.timestamp.microsecond = getMonotonicTimestampUSec();
+    record.severity.value =
+        timing.jitterAlarm ? uavcan_diagnostic_Severity_1_0_WARNING : uavcan_diagnostic_Severity_1_0_DEBUG;
+
+    // make the text
+    length = snprintf((char *)record.text.elements, uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_,
+        "bms timing: period %u/%u/%uus jitter %uus spi %uus calc %uus cb %uus miss %u alarms %u "
+        "current %u samples %u dropped interval %uus latency %uus",
+        (timing.periodMinUs == UINT32_MAX) ? 0 : timing.periodMinUs, timing.periodLastUs, timing.periodMaxUs,
+        timing.jitterMaxUs, timing.spiMaxUs, timing.calcMaxUs, timing.callbackMaxUs, timing.deadlineMisses,
+        timing.jitterAlarms, timing.currentSamples, timing.currentOverruns, timing.currentIntervalMaxUs,
+        timing.currentLatencyMaxUs);
+
+    // limit the length
+    if(length < 0)
+    {
+        length = 0;
+    }
+    else if(length >= uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_)
+    {
+        length = uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_ - 1;
+    }
+
+    record.text.count = (size_t)length;
+
+    // serialize the record
+    if(uavcan_diagnostic_Record_1_1_serialize_(&record, record_payload_buffer, &transfer.payload_size))
+    {
+        cli_printfError("CYPHALCAN ERROR: timing record serialization went wrong!\n");
+    }
+
+    // set the data ready in the buffer and chop if needed
+    ++gTimingTransferId; // The transfer-ID shall be incremented after every transmission on this subject.
+    int32_t result = canardTxPush(ins, &transfer);
+
+    if(result < 0)
+    {
+        cli_printfError("CYPHALCAN ERROR: timing record Transmit error %d\n", result);
+    }
+}
+
+/****************************************************************************
+ * Name: CurrentStatsDiagnosticToTransmitBuffer
+ *
+ * Description:
+ *   This function is called at 0.2 Hz rate from the main loop to send the
+ *   1s, 10s and 60s current statistics (mean, min, max and RMS in mA) as
+ *   uavcan.diagnostic.Record on the same subject as the timing record.
+ *
+ ****************************************************************************/
+
+void CurrentStatsDiagnosticToTransmitBuffer(CanardInstance *ins)
+{
+    measStatsResult_t stats[MEAS_STATS_WINDOWS];
+    int               length, i;
+
+    CanardMicrosecond transmission_deadline = getMonotonicTimestampUSec() + 1000 * 10;
+
+    // get the statistics of each window, send zeros if there are none (yet)
+    for(i = 0; i < MEAS_STATS_WINDOWS; i++)
+    {
+        if(measStats_getWindow(MEAS_STATS_CURRENT, (measStatsWindow_t)i, &stats[i]) || !stats[i].count)
+        {
+            memset(&stats[i], 0, sizeof(stats[i]));
+        }
+    }
+
+    // make the payload buffer
+    uint8_t record_payload_buffer[uavcan_diagnostic_Record_1_1_SERIALIZATION_BUFFER_SIZE_BYTES_];
+
+    // make the canard transfer struct
+    CanardTransfer transfer = {
+        .timestamp_usec = transmission_deadline, // Zero if transmission deadline is not limited.
+        .priority       = CanardPriorityOptional,
+        .transfer_kind  = CanardTransferKindMessage,
+        .port_id        = uavcan_diagnostic_Record_1_1_FIXED_PORT_ID_, // This is the subject-ID.
+        .remote_node_id = CANARD_NODE_ID_UNSET, // Messages cannot be unicast, so use UNSET.
+        .transfer_id    = gTimingTransferId,
+        .payload_size   = uavcan_diagnostic_Record_1_1_SERIALIZATION_BUFFER_SIZE_BYTES_,
+        .payload        = &record_payload_buffer,
+    };
+
+    // make the diagnostic record with the monotonic time of the BMS
+    uavcan_diagnostic_Record_1_1 record;
+
+    record.timestamp.microsecond = getMonotonicTimestampUSec();
+    record.severity.value        = uavcan_diagnostic_Severity_1_0_DEBUG;
+
+    // make the text
+    length = snprintf((char *)record.text.elements, uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_,
+        "bms current mean/min/max/rms: 1s %d/%d/%d/%dmA 10s %d/%d/%d/%dmA 60s %d/%d/%d/%dmA",
+        (int)(stats[MEAS_STATS_1S].mean * 1000), (int)(stats[MEAS_STATS_1S].min * 1000),
+        (int)(stats[MEAS_STATS_1S].max * 1000), (int)(stats[MEAS_STATS_1S].rms * 1000),
+        (int)(stats[MEAS_STATS_10S].mean * 1000), (int)(stats[MEAS_STATS_10S].min * 1000),
+        (int)(stats[MEAS_STATS_10S].max * 1000), (int)(stats[MEAS_STATS_10S].rms * 1000),
+        (int)(stats[MEAS_STATS_60S].mean * 1000), (int)(stats[MEAS_STATS_60S].min * 1000),
+        (int)(stats[MEAS_STATS_60S].max * 1000), (int)(stats[MEAS_STATS_60S].rms * 1000));
+
+    // limit the length
+    if(length < 0)
+    {
+        length = 0;
+    }
+    else if(length >= uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_)
+    {
+        length = uavcan_diagnostic_Record_1_1_text_ARRAY_CAPACITY_ - 1;
+    }
+
+    record.text.count = (size_t)length;
+
+    // serialize the record
+    if(uavcan_diagnostic_Record_1_1_serialize_(&record, record_payload_buffer, &transfer.payload_size))
+    {
+        cli_printfError("CYPHALCAN ERROR: current statistics record serialization went wrong!\n");
+    }
+
+    // set the data ready in the buffer and chop if needed
+    ++gTimingTransferId; // The transfer-ID shall be incremented after every transmission on this subject.
+    int32_t result = canardTxPush(ins, &transfer);
+
+    if(result < 0)
+    {
+        cli_printfError("CYPHALCAN ERROR: current statistics record Transmit error %d\n", result);
+    }
+}
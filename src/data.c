@@ -72,6 +72,19 @@
                                                                                                                             .defaultVal.I32         = (int32_t)par##_DEFAULT, \
                                                                                                                             .parameterAdr           = &s_parameters.parVal_t, 
 
+//! @brief macro to initialze the BMSparametersInfo_t value for strings, the default string is in data_getParameterDefault
+#define SET_DEFAULT_STR(typeT, maxOn, minOn, userReadOnlyOn, stringUnit, stringType, par, parVal_t) \
+                                                                                                                            .type                   = typeT, \
+                                                                                                                            .checkMax               = maxOn, \
+                                                                                                                            .checkMin               = minOn, \
+                                                                                                                            .userReadOnly           = userReadOnlyOn, \
+                                                                                                                            .parameterUnit          = stringUnit, \
+                                                                                                                            .parameterType          = stringType, \
+                                                                                                                            .max.I32                = (int32_t)par##_MAX, \
+                                                                                                                            .min.I32                = (int32_t)par##_MIN, \
+                                                                                                                            .defaultVal.I32         = 0, \
+                                                                                                                            .parameterAdr           = &s_parameters.parVal_t, 
+
 //! @brief macro to initialze the BMSparametersInfo_t value for floating point values
 #define SET_DEFAULT_FLT(typeT, maxOn, minOn, userReadOnlyOn, stringUnit, stringType, par, parVal_t) \
                                                                                                                             .type                   = typeT, \
@@ -115,6 +128,17 @@ typedef enum
     CHECK_BOTH = 3  //!< both upper and lower limit needs to be checked
 } checkLimit_t;
 
+//! @brief  union to hold any decoded parameter value of a parameter blob
+typedef union
+{
+    float    floatVal;
+    uint8_t  u8Val;
+    uint16_t u16Val;
+    int32_t  i32Val;
+    uint64_t u64Val;
+    char     stringVal[STRING_MAX_CHARS];
+} blobValue_u;
+
 /****************************************************************************
  * private data
  ****************************************************************************/
@@ -146,6 +170,19 @@ static int gLockOwnerPID = NO_PID;
 //! Variable to indicate the active BMS fault.
 uint8_t gBMSFault = 0;
 
+//! the monotonic time of the last measurement in us, not a parameter so it is not saved
+static uint64_t gMeasurementTimeUs = 0;
+
+//! the parameters that (re)calculate other parameters when changed, these are imported first
+//! so the imported values of the other parameters are not overwritten
+static const parameterKind_t gImportFirstParameters[] = { A_FACTORY, BATTERY_TYPE };
+
+//! to indicate the changed parameters are collected (while importing) instead of handled by the callback
+static bool gCollectChanges = false;
+
+//! the bits of the collected changed parameters (parameterKind_t), to handle each of them once
+static uint8_t gCollectedChanges[(NONE + 7) / 8];
+
 /*!
  * @brief the struct containing all the data with the default values, the default values are set
  *        this struct
@@ -336,7 +373,7 @@ const BMSparametersInfo_t s_parametersInfo[NONE] =
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "bool",   SMBUS_ENABLE, configurationVariables.smbus_enable) }, 
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "bool",   GATE_CHECK_ENABLE, configurationVariables.gate_check_enable) },
     { SET_DEFAULT_INT(UINT64VAL, false, false, false, "-",  "uint64", MODEL_ID, configurationVariables.model_id) },
-    { SET_DEFAULT_INT(STRINGVAL, false, false, false, "-",  "char[32]", MODEL_NAME, configurationVariables.model_name) },
+    { SET_DEFAULT_STR(STRINGVAL, false, false, false, "-",  "char[32]", MODEL_NAME, configurationVariables.model_name) },
 
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "uint8",  CYPHAL_NODE_STATIC_ID, canVariables.Cyphal_node_static_id) },
     { SET_DEFAULT_INT(UINT16VAL, true,  true, false,  "-",  "uint16", CYPHAL_ES_SUB_ID, canVariables.Cyphal_es_sub_id) },
@@ -349,7 +386,7 @@ const BMSparametersInfo_t s_parametersInfo[NONE] =
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "bool",   DRONECAN_BAT_CELLS, canVariables.DroneCAN_bat_cells) },
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "bool",   DRONECAN_BAT_INFO, canVariables.DroneCAN_bat_info) },
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "bool",   DRONECAN_BAT_INFO_AUX, canVariables.DroneCAN_bat_info_aux) },
-    { SET_DEFAULT_INT(STRINGVAL, false, false, false, "-",  "char[10]",  CAN_MODE, canVariables.can_mode) },
+    { SET_DEFAULT_STR(STRINGVAL, false, false, false, "-",  "char[10]",  CAN_MODE, canVariables.can_mode) },
     { SET_DEFAULT_INT(UINT8VAL,  true,  true, false,  "-",  "uint8",  CAN_FD_MODE, canVariables.can_fd_mode) },
     { SET_DEFAULT_INT(INT32VAL,  true,  true, false,  "bit/s", "int32", CAN_BITRATE, canVariables.can_bitrate) },
     { SET_DEFAULT_INT(INT32VAL,  true,  true, false,  "bit/s", "int32", CAN_FD_BITRATE, canVariables.can_fd_bitrate) },
@@ -413,6 +450,72 @@ static int setParameterNoLock(parameterKind_t parameterKind, void* inNewValue);
  */
 static int handleParamaterChange(parameterKind_t parameter, void* value);
 
+/*!
+ * @brief   function to call the parameter change callback function, or to collect the change
+ *          to handle it once with handleCollectedChangesNoLock() if the changes are collected
+ * @note    the data lock should be taken
+ *
+ * @param   parameter The parameter that changed.
+ * @param   value Address of the variable containing the new value.
+ * @param   extraValue Address of the extra value for the callback function.
+ *
+ * @return  0 if succeeded, the return value of the callback function otherwise
+ */
+static int callChangeCallbackNoLock(parameterKind_t parameter, void* value, void* extraValue);
+
+/*!
+ * @brief   function to call the parameter change callback function once for each collected change,
+ *          with the value the parameter has now
+ * @note    the data lock should be taken
+ *
+ * @return  0 if succeeded, -1 if handling one of the changes went wrong
+ */
+static int handleCollectedChangesNoLock(void);
+
+/*!
+ * @brief   function to check if a parameter is part of a parameter blob,
+ *          these are the persistent parameters that a user may change
+ *
+ * @param   parameterKind the parameter to check
+ *
+ * @return  true if it is exported and may be imported
+ */
+static bool isBlobParameter(parameterKind_t parameterKind);
+
+/*!
+ * @brief   function to get the size of the parameter value in a parameter blob
+ * @note    the data lock should be taken
+ *
+ * @param   parameterKind the parameter
+ *
+ * @return  the size of the value in bytes
+ */
+static uint16_t getBlobValueSizeNoLock(parameterKind_t parameterKind);
+
+/*!
+ * @brief   function to read and check the next entry of a parameter blob
+ *
+ * @param   pEntries the entries of the blob
+ * @param   length the length of the entries
+ * @param   pOffset the offset of the entry in pEntries, will be set to the next entry
+ * @param   pParameterKind address to place the parameter of the entry
+ * @param   pValue address to place the value of the entry, a string will be null terminated
+ *
+ * @return  0 if succeeded, -1 if the entry is invalid or exceeds its limits
+ */
+static int readBlobEntry(const uint8_t* pEntries, uint16_t length, uint16_t* pOffset,
+    parameterKind_t* pParameterKind, blobValue_u* pValue);
+
+/*!
+ * @brief   function to calculate the CRC-16/CCITT-FALSE of a parameter blob
+ *
+ * @param   pBuffer the data
+ * @param   length the length of the data
+ *
+ * @return  the CRC
+ */
+static uint16_t calcBlobCrc(const uint8_t* pBuffer, uint16_t length);
+
 /****************************************************************************
  * public Functions
  ****************************************************************************/
@@ -927,6 +1030,28 @@ int data_getParameterIfUserReadOnly(parameterKind_t parameterKind)
     return (int)s_parametersInfo[parameterKind].userReadOnly;
 }
 
+/*!
+ * @brief       function to get if a certain parameter is saved in flash with data_saveParameters().
+ *              Measured and calculated parameters are not saved.
+ *
+ * @param       parameterKind the parameter value it wants the persistent state of,
+ *              from the parameterKind enum in BMS_data_types.h
+ *
+ * @retval      is -1 when something went wrong, 0 if the parameter is not saved, 1 if it is saved.
+ */
+int data_getParameterIfPersistent(parameterKind_t parameterKind)
+{
+    /* Check for wrong user input */
+    if(parameterKind >= NONE)
+    {
+        return -1;
+    }
+
+    // return if it is saved in flash
+    return (int)((parameterKind == N_CELLS) || (parameterKind == SENSOR_ENABLE) || (parameterKind == A_FULL) ||
+        (parameterKind == A_FACTORY) || (parameterKind == S_HEALTH) || (BATT_ID <= parameterKind));
+}
+
 /*
  * @brief   Function to be called when the parameter change needs to be handled.
  *          Should be used with data_setCalcBatteryVariables()
@@ -950,6 +1075,230 @@ int data_handleParameterChange(parameterKind_t parameter, void* inNewValue)
     return ret;
 }
 
+/*!
+ * @brief       function to export the user writable persistent parameters as a parameter blob
+ *              (see PARAMETER_BLOB_MAGIC), to be imported with data_importParameters().
+ *              The parameters are exported in parameterKind order, starting with *pNextParameter,
+ *              until the blob doesn't fit in bufferSize anymore.
+ * @note        Multi-thread protected
+ *
+ * @param       pBuffer the buffer to write the blob in
+ * @param       bufferSize the size of pBuffer, PARAMETER_BLOB_MAX_SIZE will always fit all parameters
+ * @param       pNextParameter address of the first parameter to export, will become the first parameter
+ *              that is not exported, NONE if all parameters are exported
+ *
+ * @retval      the length of the blob, -1 if something went wrong
+ */
+int data_exportParameters(uint8_t* pBuffer, uint16_t bufferSize, parameterKind_t* pNextParameter)
+{
+    parameterKind_t parameterKind;
+    uint16_t        offset = PARAMETER_BLOB_HEADER_SIZE;
+    uint16_t        valueSize, i;
+    uint16_t        CRC;
+    uint64_t        value;
+
+    // check the input
+    if(pBuffer == NULL || pNextParameter == NULL || *pNextParameter > NONE ||
+        bufferSize < (PARAMETER_BLOB_HEADER_SIZE + PARAMETER_BLOB_CRC_SIZE))
+    {
+        cli_printfError("data ERROR: wrong input!\n");
+        return -1;
+    }
+
+    // lock the mutex(with error check)
+    if((pthread_mutex_lock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_lock failed\n");
+        return -1;
+    }
+
+    // add each parameter that fits
+    for(parameterKind = *pNextParameter; parameterKind < NONE; parameterKind++)
+    {
+        // check if it needs to be exported
+        if(!isBlobParameter(parameterKind))
+        {
+            continue;
+        }
+
+        valueSize = getBlobValueSizeNoLock(parameterKind);
+
+        // check if it fits with the CRC
+        if((offset + 1 + valueSize + PARAMETER_BLOB_CRC_SIZE) > bufferSize)
+        {
+            break;
+        }
+
+        // add the parameter
+        pBuffer[offset++] = (uint8_t)parameterKind;
+
+        // add the value
+        if(s_parametersInfo[parameterKind].type == STRINGVAL)
+        {
+            // add the length and the characters
+            pBuffer[offset] = (uint8_t)(valueSize - 1);
+            memcpy(&pBuffer[offset + 1], s_parametersInfo[parameterKind].parameterAdr, valueSize - 1);
+        }
+        else
+        {
+            // get the value, the little endian platform places it in the lower bytes
+            value = 0;
+            memcpy(&value, s_parametersInfo[parameterKind].parameterAdr, valueSize);
+
+            // add it in little endian
+            for(i = 0; i < valueSize; i++)
+            {
+                pBuffer[offset + i] = (uint8_t)(value >> (8 * i));
+            }
+        }
+
+        offset += valueSize;
+    }
+
+    // unlock the mutex
+    if((pthread_mutex_unlock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_unlock failed\n");
+        return -1;
+    }
+
+    // set the next parameter to export
+    *pNextParameter = parameterKind;
+
+    // add the header
+    pBuffer[0] = PARAMETER_BLOB_MAGIC;
+    pBuffer[1] = PARAMETER_BLOB_VERSION;
+    pBuffer[2] = (uint8_t)(offset - PARAMETER_BLOB_HEADER_SIZE);
+    pBuffer[3] = (uint8_t)((offset - PARAMETER_BLOB_HEADER_SIZE) >> 8);
+
+    // add the CRC
+    CRC                 = calcBlobCrc(pBuffer, offset);
+    pBuffer[offset]     = (uint8_t)CRC;
+    pBuffer[offset + 1] = (uint8_t)(CRC >> 8);
+
+    return offset + PARAMETER_BLOB_CRC_SIZE;
+}
+
+/*!
+ * @brief       function to import a parameter blob from data_exportParameters().
+ *              Every value is checked against its limits before anything is set, after which all
+ *              values are set while holding the data lock. Only the parameters that changed are handled
+ *              (like with data_setParameter()), each of them once after all values are set, so a subsystem
+ *              (like the BCC thresholds) is configured once with the final values.
+ *              It needs to be saved once with data_saveParameters().
+ * @note        Multi-thread protected
+ *
+ * @param       pBuffer the blob to import
+ * @param       length the length of the blob
+ *
+ * @retval      the amount of imported parameters, -1 if the blob is invalid and nothing is set,
+ *              -2 if setting (handling) one of the parameters went wrong.
+ */
+int data_importParameters(const uint8_t* pBuffer, uint16_t length)
+{
+    const uint8_t*  pEntries;
+    uint16_t        entriesLength, offset;
+    parameterKind_t parameterKind;
+    blobValue_u     value;
+    int             amount = 0;
+    int             ret    = 0;
+    int             pass;
+    size_t          i;
+    bool            importFirst;
+
+    // check the input and the header
+    if(pBuffer == NULL || length < (PARAMETER_BLOB_HEADER_SIZE + PARAMETER_BLOB_CRC_SIZE) ||
+        pBuffer[0] != PARAMETER_BLOB_MAGIC || pBuffer[1] != PARAMETER_BLOB_VERSION)
+    {
+        cli_printfError("data ERROR: not a (version %d) parameter blob!\n", PARAMETER_BLOB_VERSION);
+        return -1;
+    }
+
+    // check the length
+    pEntries      = &pBuffer[PARAMETER_BLOB_HEADER_SIZE];
+    entriesLength = (uint16_t)(pBuffer[2] | (pBuffer[3] << 8));
+    if((PARAMETER_BLOB_HEADER_SIZE + entriesLength + PARAMETER_BLOB_CRC_SIZE) != length)
+    {
+        cli_printfError("data ERROR: parameter blob length %d != %d!\n",
+            PARAMETER_BLOB_HEADER_SIZE + entriesLength + PARAMETER_BLOB_CRC_SIZE, length);
+        return -1;
+    }
+
+    // check the CRC
+    if(calcBlobCrc(pBuffer, length - PARAMETER_BLOB_CRC_SIZE) !=
+        (uint16_t)(pBuffer[length - 2] | (pBuffer[length - 1] << 8)))
+    {
+        cli_printfError("data ERROR: parameter blob CRC error!\n");
+        return -1;
+    }
+
+    // check all the entries before setting anything
+    for(offset = 0; offset < entriesLength; amount++)
+    {
+        if(readBlobEntry(pEntries, entriesLength, &offset, &parameterKind, &value))
+        {
+            cli_printfError("data ERROR: parameter blob entry %d is invalid, nothing is imported!\n", amount);
+            return -1;
+        }
+    }
+
+    // lock the mutex(with error check)
+    if((pthread_mutex_lock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_lock failed\n");
+        return -1;
+    }
+
+    // collect the changes, to handle each changed parameter once after all of them are set
+    gCollectChanges = true;
+
+    // set the parameters that calculate other parameters first and the rest in the second pass
+    for(pass = 0; pass < 2; pass++)
+    {
+        for(offset = 0; offset < entriesLength;)
+        {
+            // the entries are already checked
+            (void)readBlobEntry(pEntries, entriesLength, &offset, &parameterKind, &value);
+
+            // check if it is imported in this pass
+            importFirst = false;
+            for(i = 0; i < (sizeof(gImportFirstParameters) / sizeof(gImportFirstParameters[0])); i++)
+            {
+                importFirst |= (gImportFirstParameters[i] == parameterKind);
+            }
+
+            if(importFirst != (pass == 0))
+            {
+                continue;
+            }
+
+            // set it, this only handles the change if the value is different
+            if(setParameterNoLock(parameterKind, &value))
+            {
+                cli_printfError("data ERROR: couldn't import %d!\n", parameterKind);
+                ret = -2;
+            }
+        }
+    }
+
+    // handle the changes
+    gCollectChanges = false;
+    if(handleCollectedChangesNoLock())
+    {
+        ret = -2;
+    }
+
+    // unlock the mutex
+    if((pthread_mutex_unlock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_unlock failed\n");
+        ret = -2;
+    }
+
+    // return the amount or the error
+    return ret ? ret : amount;
+}
+
 /*!
  * @brief     function to lock the mutex (make sure that no other tasks/threads can acces/change the data)
  *            make sure the mutex is unlocked again with data_unlockMutex
@@ -1210,6 +1559,69 @@ int data_setCommonBatteryVariables(commonBatteryVariables_t* source)
     return 0;
 }
 
+/*!
+ * @brief   function to set the monotonic time of the last measurement
+ *          It will use the mutex for data protection
+ * @note    This is not a parameter, it is not saved in the EEPROM
+ *
+ * @param   timeUs the time of the measurement in us from timeBase_getUs()
+ *
+ * @return  0 if succeeded, -1 otherwise
+ */
+int data_setMeasurementTimeUs(uint64_t timeUs)
+{
+    // lock the mutex(with error check)
+    if((pthread_mutex_lock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_lock failed\n");
+        return -1;
+    }
+
+    // set the time
+    gMeasurementTimeUs = timeUs;
+
+    // unlock the mutex after it is done
+    if((pthread_mutex_unlock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_unlock failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief   function to get the monotonic time of the last measurement
+ *          It will use the mutex for data protection
+ *
+ * @param   none
+ *
+ * @return  the time of the last measurement in us from timeBase_getUs(), 0 if unknown or if error
+ */
+uint64_t data_getMeasurementTimeUs(void)
+{
+    uint64_t timeUs;
+
+    // lock the mutex(with error check)
+    if((pthread_mutex_lock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_lock failed\n");
+        return 0;
+    }
+
+    // get the time
+    timeUs = gMeasurementTimeUs;
+
+    // unlock the mutex after it is done
+    if((pthread_mutex_unlock(&dataLock)) != 0)
+    {
+        cli_printfError("data ERROR: pthread_mutex_unlock failed\n");
+        return 0;
+    }
+
+    return timeUs;
+}
+
 /*!
  * @brief   function that will copy the calcBatteryVariables_t struct
  *          From the struct saved in data to the destination struct
@@ -2264,9 +2676,7 @@ static int setParameterNoLock(parameterKind_t parameterKind, void* inNewValue)
 
         // check which parameter has been changed if it needs to be saved
         // Things that are measured should not be saved
-        if((!gSavableParameterChanged) &&
-            ((parameterKind == N_CELLS) || (parameterKind == SENSOR_ENABLE) || (parameterKind == A_FULL) ||
-                (parameterKind == A_FACTORY) || (parameterKind == S_HEALTH) || (BATT_ID <= parameterKind)))
+        if((!gSavableParameterChanged) && (data_getParameterIfPersistent(parameterKind) == 1))
         {
             // cli_printf("this parameter changed: %d", parameterKind);
             // set the savable parameter true
@@ -2623,7 +3033,7 @@ static int handleParamaterChange(parameterKind_t parameter, void* value)
             variable1.uint8Var = 1;
 
             // call the callback function to handle the pin change
-            ret = gParameterChangeCallbackFunctionfp(parameter, value, (void*)&variable1);
+            ret = callChangeCallbackNoLock(parameter, value, (void*)&variable1);
 
             // check for errors
             if(ret)
@@ -2714,7 +3124,7 @@ static int handleParamaterChange(parameterKind_t parameter, void* value)
             else
             {
                 // handle the changed parameter in the battery management part
-                ret = gParameterChangeCallbackFunctionfp(V_CELL_OV, (void*)&variable1.floatVar, NULL);
+                ret = callChangeCallbackNoLock(V_CELL_OV, (void*)&variable1.floatVar, NULL);
                 if(ret)
                 {
                     cli_printfError(
@@ -2738,7 +3148,7 @@ static int handleParamaterChange(parameterKind_t parameter, void* value)
             else
             {
                 // handle the changed parameter in the battery management part
-                ret = gParameterChangeCallbackFunctionfp(V_CELL_UV, (void*)&variable2.floatVar, NULL);
+                ret = callChangeCallbackNoLock(V_CELL_UV, (void*)&variable2.floatVar, NULL);
                 if(ret)
                 {
                     cli_printfError(
@@ -2890,12 +3300,264 @@ static int handleParamaterChange(parameterKind_t parameter, void* value)
 
     // callback to main to handle parameter change, without using data_get, data_set functions
     // needed to set for example the new BCC parameter in the BCC, or calc new intervals
-    ret |= gParameterChangeCallbackFunctionfp(parameter, value, (void*)&variable1);
+    ret |= callChangeCallbackNoLock(parameter, value, (void*)&variable1);
 
     // return
     return ret;
 }
 
+/*!
+ * @brief   function to call the parameter change callback function, or to collect the change
+ *          to handle it once with handleCollectedChangesNoLock() if the changes are collected
+ * @note    the data lock should be taken
+ *
+ * @param   parameter The parameter that changed.
+ * @param   value Address of the variable containing the new value.
+ * @param   extraValue Address of the extra value for the callback function.
+ *
+ * @return  0 if succeeded, the return value of the callback function otherwise
+ */
+static int callChangeCallbackNoLock(parameterKind_t parameter, void* value, void* extraValue)
+{
+    // check if the change is collected
+    if(gCollectChanges)
+    {
+        // set the bit of the parameter, it is handled once with the value it has at the end
+        gCollectedChanges[parameter / 8] |= (1 << (parameter % 8));
+
+        return 0;
+    }
+
+    // call the callback function to handle it now
+    return gParameterChangeCallbackFunctionfp(parameter, value, extraValue);
+}
+
+/*!
+ * @brief   function to call the parameter change callback function once for each collected change,
+ *          with the value the parameter has now
+ * @note    the data lock should be taken
+ *
+ * @return  0 if succeeded, -1 if handling one of the changes went wrong
+ */
+static int handleCollectedChangesNoLock(void)
+{
+    parameterKind_t parameterKind;
+    variableTypes_u extraValue;
+    int             ret = 0;
+
+    for(parameterKind = 0; parameterKind < NONE; parameterKind++)
+    {
+        // check if it changed
+        if(!(gCollectedChanges[parameterKind / 8] & (1 << (parameterKind % 8))))
+        {
+            continue;
+        }
+
+        // clear the bit
+        gCollectedChanges[parameterKind / 8] &= ~(1 << (parameterKind % 8));
+
+        // make the extra value like handleParamaterChange() does for the value it has now
+        memset(&extraValue, 0, sizeof(extraValue));
+        switch(parameterKind)
+        {
+            case FLIGHT_MODE_ENABLE:
+                // s-in-flight is cleared when flight mode is disabled
+                extraValue.boolVar = !(*(uint8_t*)s_parametersInfo[parameterKind].parameterAdr);
+                break;
+            case A_FULL:
+            case A_REM:
+                // the state of charge for the LED
+                extraValue.uint8Var = s_parameters.calcBatteryVariables.s_charge;
+                break;
+            case EMERGENCY_BUTTON_ENABLE:
+                // handle the pin change
+                extraValue.uint8Var = 1;
+                break;
+            case T_MEAS:
+                // the corrected measurement period
+                extraValue.uint16Var = *(uint16_t*)s_parametersInfo[parameterKind].parameterAdr;
+                break;
+            default:
+                break;
+        }
+
+        // handle it
+        if(gParameterChangeCallbackFunctionfp(parameterKind, s_parametersInfo[parameterKind].parameterAdr,
+            (void*)&extraValue))
+        {
+            cli_printfError("data ERROR: couldn't handle the change of %d!\n", parameterKind);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+/*!
+ * @brief   function to check if a parameter is part of a parameter blob,
+ *          these are the persistent parameters that a user may change
+ *
+ * @param   parameterKind the parameter to check
+ *
+ * @return  true if it is exported and may be imported
+ */
+static bool isBlobParameter(parameterKind_t parameterKind)
+{
+    return (data_getParameterIfPersistent(parameterKind) == 1) &&
+        !s_parametersInfo[parameterKind].userReadOnly;
+}
+
+/*!
+ * @brief   function to get the size of the parameter value in a parameter blob
+ * @note    the data lock should be taken
+ *
+ * @param   parameterKind the parameter
+ *
+ * @return  the size of the value in bytes
+ */
+static uint16_t getBlobValueSizeNoLock(parameterKind_t parameterKind)
+{
+    switch(s_parametersInfo[parameterKind].type)
+    {
+        case UINT8VAL:
+            return sizeof(uint8_t);
+        case UINT16VAL:
+            return sizeof(uint16_t);
+        case INT32VAL:
+            return sizeof(int32_t);
+        case UINT64VAL:
+            return sizeof(uint64_t);
+        case FLOATVAL:
+            return sizeof(float);
+        case STRINGVAL:
+            // the length and the characters, keep room for the null character
+            return 1 + strnlen(s_parametersInfo[parameterKind].parameterAdr, STRING_MAX_CHARS - 1);
+        default:
+            return 0;
+    }
+}
+
+/*!
+ * @brief   function to read and check the next entry of a parameter blob
+ *
+ * @param   pEntries the entries of the blob
+ * @param   length the length of the entries
+ * @param   pOffset the offset of the entry in pEntries, will be set to the next entry
+ * @param   pParameterKind address to place the parameter of the entry
+ * @param   pValue address to place the value of the entry, a string will be null terminated
+ *
+ * @return  0 if succeeded, -1 if the entry is invalid or exceeds its limits
+ */
+static int readBlobEntry(const uint8_t* pEntries, uint16_t length, uint16_t* pOffset,
+    parameterKind_t* pParameterKind, blobValue_u* pValue)
+{
+    const BMSparametersInfo_t* pInfo;
+    uint16_t                   offset = *pOffset;
+    uint16_t                   valueSize, i;
+    uint64_t                   value = 0;
+    bool                       lowOk, highOk;
+
+    // check the parameter
+    *pParameterKind = (parameterKind_t)pEntries[offset++];
+    if(*pParameterKind >= NONE || !isBlobParameter(*pParameterKind) || offset >= length)
+    {
+        return -1;
+    }
+
+    pInfo = &s_parametersInfo[*pParameterKind];
+    memset(pValue, 0, sizeof(blobValue_u));
+
+    // get the string
+    if(pInfo->type == STRINGVAL)
+    {
+        valueSize = pEntries[offset++];
+        if(valueSize >= STRING_MAX_CHARS || (offset + valueSize) > length)
+        {
+            return -1;
+        }
+
+        memcpy(pValue->stringVal, &pEntries[offset], valueSize);
+        *pOffset = offset + valueSize;
+
+        // a string has no limits
+        return 0;
+    }
+
+    // get the value in little endian
+    valueSize = getBlobValueSizeNoLock(*pParameterKind);
+    if((offset + valueSize) > length)
+    {
+        return -1;
+    }
+
+    for(i = 0; i < valueSize; i++)
+    {
+        value |= (uint64_t)pEntries[offset + i] << (8 * i);
+    }
+
+    // the little endian platform uses the lower bytes for the smaller types
+    memcpy(pValue, &value, valueSize);
+    *pOffset = offset + valueSize;
+
+    // check the limits the same way as setParameterNoLock()
+    switch(pInfo->type)
+    {
+        case FLOATVAL:
+            lowOk  = !pInfo->checkMin || (pInfo->min.FLTVAL <= pValue->floatVal);
+            highOk = !pInfo->checkMax || (pValue->floatVal <= pInfo->max.FLTVAL);
+            break;
+        case UINT8VAL:
+            lowOk  = !pInfo->checkMin || (pInfo->min.U8 <= pValue->u8Val);
+            highOk = !pInfo->checkMax || (pValue->u8Val <= pInfo->max.U8);
+            break;
+        case UINT16VAL:
+            lowOk  = !pInfo->checkMin || (pInfo->min.U16 <= pValue->u16Val);
+            highOk = !pInfo->checkMax || (pValue->u16Val <= pInfo->max.U16);
+            break;
+        case INT32VAL:
+            lowOk  = !pInfo->checkMin || (pInfo->min.I32 <= pValue->i32Val);
+            highOk = !pInfo->checkMax || (pValue->i32Val <= pInfo->max.I32);
+            break;
+        case UINT64VAL:
+            lowOk  = !pInfo->checkMin || ((uint64_t)pInfo->min.I32 <= pValue->u64Val);
+            highOk = !pInfo->checkMax || (pValue->u64Val <= (uint64_t)pInfo->max.I32);
+            break;
+        default:
+            lowOk  = false;
+            highOk = false;
+            break;
+    }
+
+    return (lowOk && highOk) ? 0 : -1;
+}
+
+/*!
+ * @brief   function to calculate the CRC-16/CCITT-FALSE of a parameter blob
+ *
+ * @param   pBuffer the data
+ * @param   length the length of the data
+ *
+ * @return  the CRC
+ */
+static uint16_t calcBlobCrc(const uint8_t* pBuffer, uint16_t length)
+{
+    uint16_t CRC = 0xFFFF;
+    uint16_t i;
+    uint8_t  bit;
+
+    for(i = 0; i < length; i++)
+    {
+        CRC ^= (uint16_t)pBuffer[i] << 8;
+
+        for(bit = 0; bit < 8; bit++)
+        {
+            CRC = (CRC & 0x8000) ? (uint16_t)((CRC << 1) ^ 0x1021) : (uint16_t)(CRC << 1);
+        }
+    }
+
+    return CRC;
+}
+
 /*!
  * @brief   function to get the MCU unique id
  *
@@ -41,6 +41,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <fcntl.h>
@@ -93,6 +94,13 @@
 #define STATE_DATA_INDEX_Y         3 // CHARGE_COMPLETE
 #define STATE_DATA_LENGHT          16
 
+#define DISPLAY_CHARS_X            16 // the amount of characters on a line
+#define DISPLAY_CHARS_Y            4  // the amount of lines
+#define GLYPH_ROWS                 8  // the amount of pixel rows of a character
+#define GLYPH_CACHE_CHARACTERS     " -.0123456789?" // the characters of the values
+#define GLYPH_CACHE_SIZE           (sizeof(GLYPH_CACHE_CHARACTERS) - 1)
+#define UPDATE_OVERHEAD_BYTES      8 // estimated I2C bytes of an extra FBIO_UPDATE (command and address bytes)
+
 /****************************************************************************
  * Types
  ****************************************************************************/
@@ -121,6 +129,20 @@ typedef struct
     uint8_t chargeStateValue;
 } displayValues_t;
 
+//! struct that holds the changed part of each line of the display, in characters
+typedef struct
+{
+    uint8_t startX[DISPLAY_CHARS_Y]; //!< the first changed character of the line
+    uint8_t endX[DISPLAY_CHARS_Y];   //!< the character after the last changed one, 0 if nothing changed
+} dirtyLines_t;
+
+//! struct that holds the display update statistics of one refresh
+typedef struct
+{
+    uint16_t ioctls; //!< the amount of FBIO_UPDATE ioctl calls
+    uint16_t bytes;  //!< the amount of framebuffer bytes sent to the display
+} updateStatistics_t;
+
 //! struct that holds the old display value to compare if something changed.
 displayValues_t g_oldDisplayValue = 
 {
@@ -154,7 +176,19 @@ const static char gFbDev[] = "/dev/fb0";
 NXHANDLE g_hfont;
 // struct nx_font_s *fontset;
 FAR const struct nx_font_s *g_fontset;
-struct fb_state_s           g_state;
+struct fb_state_s           g_state = { .fd = -1, .fbmem = NULL };
+
+//! The pre-rendered rows of the characters in GLYPH_CACHE_CHARACTERS
+static uint8_t gGlyphCache[GLYPH_CACHE_SIZE][GLYPH_ROWS];
+
+//! The amount of rows to write of each cached character, 0 if not cached
+static uint8_t gGlyphCacheHeight[GLYPH_CACHE_SIZE];
+
+//! The parts of the framebuffer that are changed but not yet sent to the display
+static dirtyLines_t gDirtyLines = {};
+
+//! The statistics of the last display refresh
+static updateStatistics_t gUpdateStatistics = {};
 
 //! This is the area of the whole display to update
 static const struct fb_area_s g_areaAll = {
@@ -193,6 +227,56 @@ int display_writeLine(uint8_t startPosX, uint8_t startPosY, char *line, uint8_t
  */
 int display_updateDisplayArea(struct fb_area_s *area_p, bool times8, struct fb_state_s *state_p);
 
+/*!
+ * @brief   Function to unmap and close the framebuffer, if it is opened
+ */
+static void closeFramebuffer(void);
+
+/*!
+ * @brief   Function to pre-render the characters of GLYPH_CACHE_CHARACTERS in the glyph cache
+ */
+static void fillGlyphCache(void);
+
+/*!
+ * @brief   Function to mark a part of a line as changed, it will be sent with flushDirtyAreas()
+ *
+ * @param x The first changed character on the 16 character wide x position (0 - 15)
+ * @param y The line on the 4 character high y position (0 - 3)
+ * @param w The amount of changed characters
+ */
+static void markDirtyArea(uint8_t x, uint8_t y, uint8_t w);
+
+/*!
+ * @brief   Function to send all the changed parts of the framebuffer to the display.
+ *          Changed lines are merged into one area if that costs less bytes than separate updates.
+ *
+ * @param state_p the address to the fb_state_s with framebuffer, display info and mmap
+ *
+ * @return 0 if succeeded, failure otherwise
+ */
+static int flushDirtyAreas(struct fb_state_s *state_p);
+
+/*!
+ * @brief   Function to handle a display_writeLine error of the display update
+ *
+ * @param retValue the return value of display_writeLine
+ *
+ * @return EXIT_SUCCESS if it was the charge relaxation state, EXIT_FAILURE otherwise
+ */
+static int writeLineError(int retValue);
+
+/*!
+ * @brief   This function is used to update the values of the display with the actual information
+ *          The gDisplayLock needs to be locked when calling this function.
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t to update the information
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t to update the information
+ *
+ * @return  0 If successful, otherwise an error will indicate the error
+ */
+static int updateValuesNoLock(
+    commonBatteryVariables_t *pCommonBatteryVariables, calcBatteryVariables_t *pCalcBatteryVariables);
+
 /****************************************************************************
  * main
  ****************************************************************************/
@@ -217,7 +301,7 @@ int display_initialize(bool skipSelfTest)
     // initialze the mutex
     pthread_mutex_init(&gDisplayLock, NULL);
 
-    /* Open the framebuffer driver */
+    /* Open the framebuffer driver, it will be kept open until display_uninitialize() */
 
     g_state.fd = open(gFbDev, O_RDWR);
     if(g_state.fd < 0)
@@ -235,8 +319,7 @@ int display_initialize(bool skipSelfTest)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOSET_POWER, 0) failed: %d\n", errcode);
-        close(g_state.fd);
-        pthread_mutex_unlock(&gDisplayLock);
+        closeFramebuffer();
         return EXIT_FAILURE;
     }
 
@@ -248,8 +331,7 @@ int display_initialize(bool skipSelfTest)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOSET_POWER, 1) failed: %d\n", errcode);
-        close(g_state.fd);
-        pthread_mutex_unlock(&gDisplayLock);
+        closeFramebuffer();
         return EXIT_FAILURE;
     }
 
@@ -263,7 +345,7 @@ int display_initialize(bool skipSelfTest)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOGET_VIDEOINFO) failed: %d\n", errcode);
-        close(g_state.fd);
+        closeFramebuffer();
         return EXIT_FAILURE;
     }
 
@@ -285,7 +367,7 @@ int display_initialize(bool skipSelfTest)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOGET_PLANEINFO) failed: %d\n", errcode);
-        close(g_state.fd);
+        closeFramebuffer();
         return EXIT_FAILURE;
     }
 
@@ -313,7 +395,7 @@ int display_initialize(bool skipSelfTest)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOGET_PLANEINFO) failed: %d\n", errcode);
-        close(g_state.fd);
+        closeFramebuffer();
         return EXIT_FAILURE;
     }
 
@@ -326,6 +408,9 @@ int display_initialize(bool skipSelfTest)
 
     g_fontset = nxf_getfontset(g_hfont);
 
+    // pre-render the characters of the values
+    fillGlyphCache();
+
 #ifdef DEBUG_DISPLAY
     cli_printf("mxheight: %d\n", g_fontset->mxheight);
     cli_printf("mxwidth: %d\n", g_fontset->mxwidth);
@@ -339,8 +424,8 @@ int display_initialize(bool skipSelfTest)
     {
         cli_printfError("ERROR: Couldn't write to display!\n");
 
-        // close the file descriptor
-        close(g_state.fd);
+        // unmap and close the framebuffer
+        closeFramebuffer();
 
         // check if it was in the wrong state
         if(retValue == -2)
@@ -359,8 +444,8 @@ int display_initialize(bool skipSelfTest)
     {
         cli_printfError("ERROR: Couldn't write to display!\n");
 
-        // close the file descriptor
-        close(g_state.fd);
+        // unmap and close the framebuffer
+        closeFramebuffer();
 
         // check if it was in the wrong state
         if(retValue == -2)
@@ -380,8 +465,8 @@ int display_initialize(bool skipSelfTest)
     {
         cli_printfError("ERROR: Couldn't write to display!\n");
 
-        // close the file descriptor
-        close(g_state.fd);
+        // unmap and close the framebuffer
+        closeFramebuffer();
 
         // check if it was in the wrong state
         if(retValue == -2)
@@ -400,8 +485,8 @@ int display_initialize(bool skipSelfTest)
     {
         cli_printfError("ERROR: Couldn't write to display!\n");
 
-        // close the file descriptor
-        close(g_state.fd);
+        // unmap and close the framebuffer
+        closeFramebuffer();
 
         // check if it was in the wrong state
         if(retValue == -2)
@@ -422,15 +507,12 @@ int display_initialize(bool skipSelfTest)
     {
         cli_printfError("ERROR: Couldn't update the framebuffer display!\n");
 
-        // close the file descriptor
-        close(g_state.fd);
+        // unmap and close the framebuffer
+        closeFramebuffer();
 
         return EXIT_FAILURE;
     }
 
-    // close the file descriptor
-    close(g_state.fd);
-
     // Check if the self-test shouldn't be skipped
     if(!skipSelfTest)
     {
@@ -465,15 +547,18 @@ int display_uninitialize(void)
     gDoNotUpdateDisplay = true;
 
     /* Uninitialze the display */
-    /* Open the framebuffer driver */
+    /* Open the framebuffer driver if it isn't open anymore */
 
-    g_state.fd = open(gFbDev, O_RDWR);
     if(g_state.fd < 0)
     {
-        errcode = errno;
-        cli_printfError("ERROR: Failed to open %s: %d\n", gFbDev, errcode);
-        pthread_mutex_unlock(&gDisplayLock);
-        return EXIT_FAILURE;
+        g_state.fd = open(gFbDev, O_RDWR);
+        if(g_state.fd < 0)
+        {
+            errcode = errno;
+            cli_printfError("ERROR: Failed to open %s: %d\n", gFbDev, errcode);
+            pthread_mutex_unlock(&gDisplayLock);
+            return EXIT_FAILURE;
+        }
     }
 
     /* Set the power to off */
@@ -484,13 +569,13 @@ int display_uninitialize(void)
     {
         errcode = errno;
         cli_printfError("ERROR: ioctl(FBIOSET_POWER) failed: %d\n", errcode);
-        close(g_state.fd);
+        closeFramebuffer();
         pthread_mutex_unlock(&gDisplayLock);
         return EXIT_FAILURE;
     }
 
-    // close the file descriptor
-    close(g_state.fd);
+    // unmap and close the framebuffer
+    closeFramebuffer();
 
     /* Save the variable */
     gDisplayOn = false;
@@ -515,21 +600,10 @@ int display_setPower(bool on)
 
     pthread_mutex_lock(&gDisplayLock);
 
-    // If the display should be updated
+    // If the display should be updated (the framebuffer is open)
     if(!gDoNotUpdateDisplay)
     {
-        /* Open the framebuffer driver */
-
-        g_state.fd = open(gFbDev, O_RDWR);
-        if(g_state.fd < 0)
-        {
-            errcode = errno;
-            cli_printfError("ERROR: Failed to open %s: %d\n", gFbDev, errcode);
-            pthread_mutex_unlock(&gDisplayLock);
-            return EXIT_FAILURE;
-        }
-
-        /* Set the power to off */
+        /* Set the power to on or off */
         retValue = ioctl(g_state.fd, FBIOSET_POWER, (int)on);
 
         // check for errors
@@ -537,14 +611,10 @@ int display_setPower(bool on)
         {
             errcode = errno;
             cli_printfError("ERROR: ioctl(FBIOSET_POWER) failed: %d\n", errcode);
-            close(g_state.fd);
             pthread_mutex_unlock(&gDisplayLock);
             return EXIT_FAILURE;
         }
 
-        // close the file descriptor
-        close(g_state.fd);
-
         /* Save the state */
         gDisplayOn = on;
 
@@ -587,25 +657,212 @@ bool display_getPower(void)
 int display_updateValues(
     commonBatteryVariables_t *pCommonBatteryVariables, calcBatteryVariables_t *pCalcBatteryVariables)
 {
-    // define local variables here
-    int              retValue = -1;
-    int              errcode, bmsFault;
-    char             valueString[17];
-    bool             outputStatusChanged    = false;
-    struct fb_area_s areaValue              = { .x = 0, .y = 0, .w = 0, .h = 1 };
-    uint8_t          segmentsToUpdateInLine = 0;
+    int retValue;
 
-    // check if initialized
-    if(!gDoNotUpdateDisplay)
+    pthread_mutex_lock(&gDisplayLock);
+
+    // update the values
+    retValue = updateValuesNoLock(pCommonBatteryVariables, pCalcBatteryVariables);
+
+    pthread_mutex_unlock(&gDisplayLock);
+
+    return retValue;
+}
+
+/****************************************************************************
+ * private Functions
+ ****************************************************************************/
+/*!
+ * @brief   Function to write values to the display (SSD1306 display)
+ *
+ * @param startPosX The place on the 16 character wide x position (0 - 15)
+ * @param startPosY The place on the 4 character high y position (0 - 3)
+ * @param line This is the string (max 16 characters) that will written to the display
+ * @param size The length of the string
+ * @param state_p the address to the fb_state_s with framebuffer, display info and mmap
+ * @param updateDisplay If this is true, it will update the line in the display right away
+
+ * @return 0 if succeeded, failure otherwise
+ */
+int display_writeLine(uint8_t startPosX, uint8_t startPosY, char *line, uint8_t size,
+    struct fb_state_s *state_p, bool updateDisplay)
+{
+    FAR const struct nx_fontbitmap_s *fbm;
+    const uint8_t                    *rows_p;
+    const char                       *cached_p;
+    uint8_t                           i, y;
+    struct nxgl_size_s                fsize;
+    struct fb_area_s                  area;
+    int                               retValue = -1;
+    int                               errcode;
+
+    // check for error value
+    if(startPosX > 15)
     {
-        // Open the framebuffer driver
-        g_state.fd = open(gFbDev, O_RDWR);
-        if(g_state.fd < 0)
+        cli_printfError("ERROR: startPosX > 15\n");
+        return retValue;
+    }
+    if(startPosY > 3)
+    {
+        cli_printfError("ERROR: startPosY > 3\n");
+        return retValue;
+    }
+
+    // check if in the charge relaxation state
+    if(data_getChargeState() == RELAXATION && data_getMainState() == CHARGE)
+    {
+        // return -2 to indicate the state
+        return -2;
+    }
+
+    // loop through the size of the array
+    for(i = 0; i < (size); i++)
+    {
+        // check if the character is in the glyph cache
+        cached_p = (line[i] != '\0') ? strchr(GLYPH_CACHE_CHARACTERS, line[i]) : NULL;
+
+        if((cached_p != NULL) && gGlyphCacheHeight[cached_p - GLYPH_CACHE_CHARACTERS])
+        {
+            // use the pre-rendered rows
+            rows_p  = gGlyphCache[cached_p - GLYPH_CACHE_CHARACTERS];
+            fsize.h = gGlyphCacheHeight[cached_p - GLYPH_CACHE_CHARACTERS];
+        }
+        else
+        {
+            // get the bitmap of the character ()
+            fbm = nxf_getbitmap(g_hfont, line[i]);
+            if(fbm != NULL)
+            {
+                // calculate the hight of the character
+                rows_p  = fbm->bitmap;
+                fsize.h = fbm->metric.height + fbm->metric.yoffset;
+            }
+            // it could be a ' '
+            // threat it like a ' ' with the max height
+            else
+            {
+                rows_p  = NULL;
+                fsize.h = g_fontset->mxheight;
+            }
+        }
+
+        // loop through the letter from top to bottom to fill the rows
+        for(y = 0; y < fsize.h; y++)
+        {
+            // add each line of the charactor to the framebuffer to send it to the display
+            // each byte is a row (of 8) of a character, there are 16 character per line
+            ((uint8_t *)state_p->fbmem)[((startPosY * 8 + y) * state_p->pinfo.stride) + i + startPosX] =
+                (rows_p != NULL) ? rows_p[y] : 0;
+        }
+    }
+// if the area needs to be updated
+#ifdef CONFIG_FB_UPDATE
+    // If you need to update the framebuffer right away
+    if(updateDisplay)
+    {
+        // create the area to update
+        area.x = startPosX * 8; /* x-offset of the area */
+        area.y = startPosY * 8; /* y-offset of the area */
+        area.w = 8 * size;      /* Width of the area */
+        area.h = 8;             /* Height of the area */
+
+        // update the area with the framebuffer
+        retValue = ioctl(state_p->fd, FBIO_UPDATE, (unsigned long)((uintptr_t)&area));
+
+        // count the update
+        gUpdateStatistics.ioctls++;
+        gUpdateStatistics.bytes += (area.w * area.h) / 8;
+
+        // check for errors
+        if(retValue < 0)
         {
             errcode = errno;
-            cli_printfError("ERROR: Failed to open %s: %d\n", gFbDev, errcode);
-            return EXIT_FAILURE;
+            cli_printfError("ERROR: ioctl(FBIO_UPDATE) failed: %d\n", errcode);
         }
+    }
+    else
+#endif
+    {
+        // Make sure to return OK
+        retValue = 0;
+    }
+
+    return retValue;
+}
+
+/*!
+ * @brief   Function to write the framebuffer values to the whole display (update it) (SSD1306 display)
+ *
+ * @param area_p address of the fb_area_s containing the area to update.
+ * @param times8 If true, all variables of area_p will be multiplied by 8.
+ * @param state_p the address to the fb_state_s with framebuffer, display info and mmap
+ *
+ * @return 0 if succeeded, failure otherwise
+ */
+int display_updateDisplayArea(struct fb_area_s *area_p, bool times8, struct fb_state_s *state_p)
+{
+    int retValue = 0, errcode;
+
+    DEBUGASSERT(area_p != NULL);
+    DEBUGASSERT(state_p != NULL);
+
+// if the area needs to be updated
+#ifdef CONFIG_FB_UPDATE
+
+    // check if it needs to be multiplied by 8
+    if(times8)
+    {
+        DEBUGASSERT(area_p->x <= 15);
+        DEBUGASSERT(area_p->y <= 3);
+        DEBUGASSERT((area_p->x + area_p->w) <= 16);
+        DEBUGASSERT((area_p->y + area_p->h) <= 4);
+        area_p->x *= 8;
+        area_p->y *= 8;
+        area_p->w *= 8;
+        area_p->h *= 8;
+    }
+
+    // update the whole area with the framebuffer
+    retValue = ioctl(state_p->fd, FBIO_UPDATE, (unsigned long)((uintptr_t)area_p));
+
+    // count the update
+    gUpdateStatistics.ioctls++;
+    gUpdateStatistics.bytes += (area_p->w * area_p->h) / 8;
+
+    // check for errors
+    if(retValue < 0 || retValue > 0)
+    {
+        errcode = errno;
+        cli_printfError("ERROR: ioctl(FBIO_UPDATE) failed: %d %d\n", errcode, retValue);
+    }
+#endif
+
+    return retValue;
+}
+
+/*!
+ * @brief   This function is used to update the values of the display with the actual information
+ *          The gDisplayLock needs to be locked when calling this function.
+ *
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t to update the information
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t to update the information
+ *
+ * @return  0 If successful, otherwise an error will indicate the error
+ */
+static int updateValuesNoLock(
+    commonBatteryVariables_t *pCommonBatteryVariables, calcBatteryVariables_t *pCalcBatteryVariables)
+{
+    // define local variables here
+    int  retValue = 0;
+    int  bmsFault;
+    char valueString[17];
+
+    // check if initialized
+    if(!gDoNotUpdateDisplay)
+    {
+        // reset the statistics of this refresh
+        gUpdateStatistics.ioctls = 0;
+        gUpdateStatistics.bytes  = 0;
 
         // check if the value changed or if it is the first time
         if((pCalcBatteryVariables->s_charge != g_oldDisplayValue.socValue))
@@ -621,26 +878,11 @@ int display_updateValues(
             // Check for an error
             if(retValue)
             {
-                cli_printfError("ERROR: Couldn't write to display!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                if(retValue == -2)
-                {
-                    return EXIT_SUCCESS;
-                }
-                else
-                {
-                    return EXIT_FAILURE;
-                }
+                return writeLineError(retValue);
             }
 
-            // save the segements for the display update
-            areaValue.x = SOC_DATA_INDEX_X;
-            areaValue.y = SOC_DATA_INDEX_Y;
-            areaValue.w = SOC_DATA_LENGHT;
-            segmentsToUpdateInLine |= 1 << 0;
+            // save the segment for the display update
+            markDirtyArea(SOC_DATA_INDEX_X, SOC_DATA_INDEX_Y, SOC_DATA_LENGHT);
 
             // save the new value in old value
             g_oldDisplayValue.socValue = pCalcBatteryVariables->s_charge;
@@ -662,37 +904,11 @@ int display_updateValues(
 
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // check if this is the first segment
-                if(segmentsToUpdateInLine == 0)
-                {
-                    // save the segements startpos for the display update
-                    areaValue.x = VOLTAGE_DATA_INDEX_X;
-                    areaValue.y = VOLTAGE_DATA_INDEX_Y;
-                    areaValue.w = VOLTAGE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
-                else
-                {
-                    // add the voltage segment to the area to update
-                    areaValue.w +=
-                        (VOLTAGE_DATA_INDEX_X - (SOC_DATA_INDEX_X + SOC_DATA_LENGHT)) + VOLTAGE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
+                // save the segment for the display update
+                markDirtyArea(VOLTAGE_DATA_INDEX_X, VOLTAGE_DATA_INDEX_Y, VOLTAGE_DATA_LENGHT);
 
                 g_oldDisplayValue.voltageValue = (int)(pCommonBatteryVariables->V_out * 100);
             }
@@ -706,23 +922,12 @@ int display_updateValues(
 
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // make sure to add the output status to the area to update
-                outputStatusChanged = true;
+                // save the segment for the display update
+                markDirtyArea(
+                    OUTPUT_STATUS_DATA_INDEX_X, OUTPUT_STATUS_DATA_INDEX_Y, OUTPUT_STATUS_DATA_LENGHT);
 
                 g_oldDisplayValue.outputStatusValue = pCalcBatteryVariables->s_out & 1;
             }
@@ -742,37 +947,11 @@ int display_updateValues(
 
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // check if this is the first segment
-                if(segmentsToUpdateInLine == 0)
-                {
-                    // save the segements startpos for the display update
-                    areaValue.x = VOLTAGE_DATA_INDEX_X;
-                    areaValue.y = VOLTAGE_DATA_INDEX_Y;
-                    areaValue.w = VOLTAGE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
-                else
-                {
-                    // add the voltage segment to the area to update
-                    areaValue.w +=
-                        (VOLTAGE_DATA_INDEX_X - (SOC_DATA_INDEX_X + SOC_DATA_LENGHT)) + VOLTAGE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
+                // save the segment for the display update
+                markDirtyArea(VOLTAGE_DATA_INDEX_X, VOLTAGE_DATA_INDEX_Y, VOLTAGE_DATA_LENGHT);
 
                 g_oldDisplayValue.voltageValue = (int)(pCommonBatteryVariables->V_batt * 100);
             }
@@ -786,48 +965,17 @@ int display_updateValues(
 
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // make sure to add the output status to the area to update
-                outputStatusChanged = true;
+                // save the segment for the display update
+                markDirtyArea(
+                    OUTPUT_STATUS_DATA_INDEX_X, OUTPUT_STATUS_DATA_INDEX_Y, OUTPUT_STATUS_DATA_LENGHT);
 
                 g_oldDisplayValue.outputStatusValue = pCalcBatteryVariables->s_out & 1;
             }
         }
 
-        // check if the first row needs to be updated
-        if(segmentsToUpdateInLine)
-        {
-            // update the first row
-            if(display_updateDisplayArea(&(areaValue), true, &g_state))
-            {
-                cli_printfError("Display ERROR: Could not update row 1!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                return EXIT_FAILURE;
-            }
-
-            areaValue.h = 1;
-        }
-
-        // reset the segmentsToUpdateInLine for the next row
-        segmentsToUpdateInLine = 0;
-
         // check if the value changed or if it is the first time
         if(pCalcBatteryVariables->s_health != g_oldDisplayValue.sohValue)
         {
@@ -851,26 +999,11 @@ int display_updateValues(
             // Check for an error
             if(retValue)
             {
-                cli_printfError("ERROR: Couldn't write to display!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                if(retValue == -2)
-                {
-                    return EXIT_SUCCESS;
-                }
-                else
-                {
-                    return EXIT_FAILURE;
-                }
+                return writeLineError(retValue);
             }
 
-            // save the segements for the display update
-            areaValue.x = SOH_DATA_INDEX_X;
-            areaValue.y = SOH_DATA_INDEX_Y;
-            areaValue.w = SOH_DATA_LENGHT;
-            segmentsToUpdateInLine |= 1 << 0;
+            // save the segment for the display update
+            markDirtyArea(SOH_DATA_INDEX_X, SOH_DATA_INDEX_Y, SOH_DATA_LENGHT);
 
             g_oldDisplayValue.sohValue = pCalcBatteryVariables->s_health;
         }
@@ -888,37 +1021,11 @@ int display_updateValues(
             // Check for an error
             if(retValue)
             {
-                cli_printfError("ERROR: Couldn't write to display!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                if(retValue == -2)
-                {
-                    return EXIT_SUCCESS;
-                }
-                else
-                {
-                    return EXIT_FAILURE;
-                }
+                return writeLineError(retValue);
             }
 
-            // check if this is the first segment
-            if(segmentsToUpdateInLine == 0)
-            {
-                // save the segements startpos for the display update
-                areaValue.x = CURRENT_DATA_INDEX_X;
-                areaValue.y = CURRENT_DATA_INDEX_Y;
-                areaValue.w = CURRENT_DATA_LENGHT;
-                segmentsToUpdateInLine |= 1 << 1;
-            }
-            else
-            {
-                // add the voltage segment to the area to update
-                areaValue.w +=
-                    (CURRENT_DATA_INDEX_X - (SOH_DATA_INDEX_X + SOH_DATA_LENGHT)) + CURRENT_DATA_LENGHT;
-                segmentsToUpdateInLine |= 1 << 1;
-            }
+            // save the segment for the display update
+            markDirtyArea(CURRENT_DATA_INDEX_X, CURRENT_DATA_INDEX_Y, CURRENT_DATA_LENGHT);
 
             g_oldDisplayValue.currentValue = (int)(pCommonBatteryVariables->I_batt_avg * 100);
         }
@@ -936,79 +1043,15 @@ int display_updateValues(
             // Check for an error
             if(retValue)
             {
-                cli_printfError("ERROR: Couldn't write to display!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                if(retValue == -2)
-                {
-                    return EXIT_SUCCESS;
-                }
-                else
-                {
-                    return EXIT_FAILURE;
-                }
+                return writeLineError(retValue);
             }
 
-            // check if this is the first segment
-            if(segmentsToUpdateInLine == 0)
-            {
-                // save the segements startpos for the display update
-                areaValue.x = BATT_ID_DATA_INDEX_X;
-                areaValue.y = BATT_ID_DATA_INDEX_Y;
-                areaValue.w = BATT_ID_DATA_LENGHT;
-            }
-            // if the previous is added
-            else if(segmentsToUpdateInLine == 1 << 0)
-            {
-                // add this segment to the area to update
-                areaValue.w +=
-                    (BATT_ID_DATA_INDEX_X - (SOH_DATA_INDEX_X + SOH_DATA_LENGHT)) + BATT_ID_DATA_LENGHT;
-            }
-            // if the previous segment is added
-            else
-            {
-                // add this segment to the area to update
-                areaValue.w += (BATT_ID_DATA_INDEX_X - (CURRENT_DATA_INDEX_X + CURRENT_DATA_LENGHT)) +
-                    BATT_ID_DATA_LENGHT;
-            }
-
-            segmentsToUpdateInLine |= 1 << 2;
+            // save the segment for the display update
+            markDirtyArea(BATT_ID_DATA_INDEX_X, BATT_ID_DATA_INDEX_Y, BATT_ID_DATA_LENGHT);
 
             g_oldDisplayValue.battIdValue = pCalcBatteryVariables->batt_id;
         }
 
-        // check if the second row needs to be updated
-        if(segmentsToUpdateInLine)
-        {
-            // update the first row
-            if(display_updateDisplayArea(&(areaValue), true, &g_state))
-            {
-                cli_printfError("Display ERROR: Could not update row 2!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                return EXIT_FAILURE;
-            }
-
-            areaValue.h = 1;
-        }
-
-        // reset the segmentsToUpdateInLine for the next row
-        segmentsToUpdateInLine = 0;
-
-        // check if the output status changed
-        if(outputStatusChanged)
-        {
-            // save the segements for the display update
-            areaValue.x = OUTPUT_STATUS_DATA_INDEX_X;
-            areaValue.y = OUTPUT_STATUS_DATA_INDEX_Y;
-            areaValue.w = OUTPUT_STATUS_DATA_LENGHT;
-            segmentsToUpdateInLine |= 1 << 0;
-        }
-
         // check if the battery temperature sensor is used
         if(pCommonBatteryVariables->sensor_enable & 1)
         {
@@ -1026,38 +1069,11 @@ int display_updateValues(
                 // Check for an error
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // check if this is the first segment
-                if(segmentsToUpdateInLine == 0)
-                {
-                    // save the segements startpos for the display update
-                    areaValue.x = TEMPERATURE_DATA_INDEX_X;
-                    areaValue.y = TEMPERATURE_DATA_INDEX_Y;
-                    areaValue.w = TEMPERATURE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
-                else
-                {
-                    // add the voltage segment to the area to update
-                    areaValue.w += (TEMPERATURE_DATA_INDEX_X -
-                                       (OUTPUT_STATUS_DATA_INDEX_X + OUTPUT_STATUS_DATA_LENGHT)) +
-                        TEMPERATURE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
+                // save the segment for the display update
+                markDirtyArea(TEMPERATURE_DATA_INDEX_X, TEMPERATURE_DATA_INDEX_Y, TEMPERATURE_DATA_LENGHT);
 
                 g_oldDisplayValue.temperatureValue = (int)(pCommonBatteryVariables->C_batt * 10);
             }
@@ -1075,60 +1091,16 @@ int display_updateValues(
 
                 if(retValue)
                 {
-                    cli_printfError("ERROR: Couldn't write to display!\n");
-
-                    // close the file descriptor
-                    close(g_state.fd);
-
-                    if(retValue == -2)
-                    {
-                        return EXIT_SUCCESS;
-                    }
-                    else
-                    {
-                        return EXIT_FAILURE;
-                    }
+                    return writeLineError(retValue);
                 }
 
-                // check if this is the first segment
-                if(segmentsToUpdateInLine == 0)
-                {
-                    // save the segements startpos for the display update
-                    areaValue.x = TEMPERATURE_DATA_INDEX_X;
-                    areaValue.y = TEMPERATURE_DATA_INDEX_Y;
-                    areaValue.w = TEMPERATURE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
-                else
-                {
-                    // add the voltage segment to the area to update
-                    areaValue.w += (TEMPERATURE_DATA_INDEX_X -
-                                       (OUTPUT_STATUS_DATA_INDEX_X + OUTPUT_STATUS_DATA_LENGHT)) +
-                                       TEMPERATURE_DATA_LENGHT;
-                    segmentsToUpdateInLine |= 1 << 1;
-                }
+                // save the segment for the display update
+                markDirtyArea(TEMPERATURE_DATA_INDEX_X, TEMPERATURE_DATA_INDEX_Y, TEMPERATURE_DATA_LENGHT);
 
                 g_oldDisplayValue.temperatureValue = UNKNOWN_TEMP_VALUE;
             }
         }
 
-        // check if the third row needs to be updated
-        if(segmentsToUpdateInLine)
-        {
-            // update the first row
-            if(display_updateDisplayArea(&(areaValue), true, &g_state))
-            {
-                cli_printfError("Display ERROR: Could not update row 3!\n");
-
-                // close the file descriptor
-                close(g_state.fd);
-
-                return EXIT_FAILURE;
-            }
-
-            areaValue.h = 1;
-        }
-
         // reset the value string to spaces
         sprintf(valueString, ALL_SPACES_16);
 
@@ -1190,182 +1162,220 @@ int display_updateValues(
 
             g_oldDisplayValue.mainStateValue = (uint8_t)retValue;
 
-            // write the value to the display and update
+            // write the value to the display
             retValue = display_writeLine(
-                STATE_DATA_INDEX_X, STATE_DATA_INDEX_Y, valueString, STATE_DATA_LENGHT, &g_state, true);
+                STATE_DATA_INDEX_X, STATE_DATA_INDEX_Y, valueString, STATE_DATA_LENGHT, &g_state, false);
 
             // Check for an error
             if(retValue)
             {
-                cli_printfError("ERROR: Couldn't write to display!\n");
-
-                if(retValue == -2)
-                {
-                    retValue = EXIT_SUCCESS;
-                }
+                return writeLineError(retValue);
             }
+
+            // save the segment for the display update
+            markDirtyArea(STATE_DATA_INDEX_X, STATE_DATA_INDEX_Y, STATE_DATA_LENGHT);
         }
 
-        // close the file descriptor
-        close(g_state.fd);
+        // update all the changed segments with as few updates as possible
+        retValue = flushDirtyAreas(&g_state);
+
+        // Check for an error
+        if(retValue)
+        {
+            cli_printfError("Display ERROR: Could not update the display!\n");
+
+            retValue = EXIT_FAILURE;
+        }
+
+#ifdef DEBUG_DISPLAY
+        cli_printf(
+            "display refresh: %u ioctl(s), %u bytes\n", gUpdateStatistics.ioctls, gUpdateStatistics.bytes);
+#endif
     }
 
-    return 0;
+    return retValue;
 }
 
-/****************************************************************************
- * private Functions
- ****************************************************************************/
 /*!
- * @brief   Function to write values to the display (SSD1306 display)
- *
- * @param startPosX The place on the 16 character wide x position (0 - 15)
- * @param startPosY The place on the 4 character high y position (0 - 3)
- * @param line This is the string (max 16 characters) that will written to the display
- * @param size The length of the string
- * @param state_p the address to the fb_state_s with framebuffer, display info and mmap
- * @param updateDisplay If this is true, it will update the line in the display right away
-
- * @return 0 if succeeded, failure otherwise
+ * @brief   Function to unmap and close the framebuffer, if it is opened
  */
-int display_writeLine(uint8_t startPosX, uint8_t startPosY, char *line, uint8_t size,
-    struct fb_state_s *state_p, bool updateDisplay)
+static void closeFramebuffer(void)
 {
-    FAR const struct nx_fontbitmap_s *fbm;
-    uint8_t                           i, y;
-    struct nxgl_size_s                fsize;
-    struct fb_area_s                  area;
-    int                               retValue = -1;
-    int                               errcode;
-
-    // check for error value
-    if(startPosX > 15)
-    {
-        cli_printfError("ERROR: startPosX > 15\n");
-        return retValue;
-    }
-    if(startPosY > 3)
+    // check if the framebuffer is mapped
+    if((g_state.fbmem != NULL) && (g_state.fbmem != MAP_FAILED))
     {
-        cli_printfError("ERROR: startPosY > 3\n");
-        return retValue;
+        munmap(g_state.fbmem, g_state.pinfo.fblen);
     }
 
-    // check if in the charge relaxation state
-    if(data_getChargeState() == RELAXATION && data_getMainState() == CHARGE)
+    g_state.fbmem = NULL;
+
+    // check if the framebuffer is opened
+    if(g_state.fd >= 0)
     {
-        // return -2 to indicate the state
-        return -2;
+        close(g_state.fd);
     }
 
-    // loop through the size of the array
-    for(i = 0; i < (size); i++)
+    g_state.fd = -1;
+}
+
+/*!
+ * @brief   Function to pre-render the characters of GLYPH_CACHE_CHARACTERS in the glyph cache
+ */
+static void fillGlyphCache(void)
+{
+    FAR const struct nx_fontbitmap_s *fbm;
+    uint8_t                           i, y, height;
+
+    // loop through the characters
+    for(i = 0; i < GLYPH_CACHE_SIZE; i++)
     {
-        // get the bitmap of the character ()
-        fbm = nxf_getbitmap(g_hfont, line[i]);
-        if(fbm != NULL)
-        {
-            // calculate the hight of the character
-            fsize.h = fbm->metric.height + fbm->metric.yoffset;
+        // get the bitmap of the character
+        fbm = nxf_getbitmap(g_hfont, GLYPH_CACHE_CHARACTERS[i]);
 
-            // loop through the letter from top to bottom to fill the rows
-            for(y = 0; y < fsize.h; y++)
-            {
-                // add each line of the charactor to the framebuffer to send it to the display
-                // each byte is a row (of 8) of a character, there are 16 character per line
-                ((uint8_t *)state_p->fbmem)[((startPosY * 8 + y) * state_p->pinfo.stride) + i + startPosX] =
-                    fbm->bitmap[y];
-            }
-        }
-        // it could be a ' '
-        // threat it like a ' '
-        else
+        // calculate the hight of the character, or use the max height for a ' '
+        height = (fbm != NULL) ? (fbm->metric.height + fbm->metric.yoffset) : g_fontset->mxheight;
+
+        // don't cache characters that don't fit in the cache, those will use the font itself
+        if(height > GLYPH_ROWS)
         {
-            // use the max height
-            fsize.h = g_fontset->mxheight;
+            gGlyphCacheHeight[i] = 0;
+            continue;
+        }
 
-            // loop through the space from top to bottom to fill the rows
-            for(y = 0; y < fsize.h; y++)
-            {
-                // set the frame buffer to 0 (nothing)
-                ((uint8_t *)state_p->fbmem)[((startPosY * 8 + y) * state_p->pinfo.stride) + i + startPosX] =
-                    0;
-            }
+        // fill the rows of the character
+        for(y = 0; y < height; y++)
+        {
+            gGlyphCache[i][y] = (fbm != NULL) ? fbm->bitmap[y] : 0;
         }
+
+        gGlyphCacheHeight[i] = height;
     }
-// if the area needs to be updated
-#ifdef CONFIG_FB_UPDATE
-    // If you need to update the framebuffer right away
-    if(updateDisplay)
-    {
-        // create the area to update
-        area.x = startPosX * 8; /* x-offset of the area */
-        area.y = startPosY * 8; /* y-offset of the area */
-        area.w = 8 * size;      /* Width of the area */
-        area.h = 8;             /* Height of the area */
+}
 
-        // update the area with the framebuffer
-        retValue = ioctl(state_p->fd, FBIO_UPDATE, (unsigned long)((uintptr_t)&area));
+/*!
+ * @brief   Function to mark a part of a line as changed, it will be sent with flushDirtyAreas()
+ *
+ * @param x The first changed character on the 16 character wide x position (0 - 15)
+ * @param y The line on the 4 character high y position (0 - 3)
+ * @param w The amount of changed characters
+ */
+static void markDirtyArea(uint8_t x, uint8_t y, uint8_t w)
+{
+    DEBUGASSERT(y < DISPLAY_CHARS_Y);
+    DEBUGASSERT((x + w) <= DISPLAY_CHARS_X);
 
-        // check for errors
-        if(retValue < 0)
-        {
-            errcode = errno;
-            cli_printfError("ERROR: ioctl(FBIO_UPDATE) failed: %d\n", errcode);
-        }
+    // check if nothing changed on this line yet
+    if(gDirtyLines.endX[y] == 0)
+    {
+        gDirtyLines.startX[y] = x;
+        gDirtyLines.endX[y]   = x + w;
     }
+    // add it to the changed part of the line
     else
-#endif
     {
-        // Make sure to return OK
-        retValue = 0;
+        gDirtyLines.startX[y] = (x < gDirtyLines.startX[y]) ? x : gDirtyLines.startX[y];
+        gDirtyLines.endX[y]   = ((x + w) > gDirtyLines.endX[y]) ? (x + w) : gDirtyLines.endX[y];
     }
+}
 
-    return retValue;
+/*!
+ * @brief   Function to calculate the estimated I2C bytes of updating an area
+ *
+ * @param w the width of the area in characters
+ * @param h the height of the area in characters
+ *
+ * @return the estimated amount of bytes
+ */
+static uint16_t areaCost(uint8_t w, uint8_t h)
+{
+    // each character is 8 columns of 1 byte (8 rows) in the SSD1306 memory
+    return (uint16_t)(w * h * GLYPH_ROWS) + UPDATE_OVERHEAD_BYTES;
 }
 
 /*!
- * @brief   Function to write the framebuffer values to the whole display (update it) (SSD1306 display)
+ * @brief   Function to send all the changed parts of the framebuffer to the display.
+ *          Changed lines are merged into one area if that costs less bytes than separate updates.
  *
- * @param area_p address of the fb_area_s containing the area to update.
- * @param times8 If true, all variables of area_p will be multiplied by 8.
  * @param state_p the address to the fb_state_s with framebuffer, display info and mmap
  *
  * @return 0 if succeeded, failure otherwise
  */
-int display_updateDisplayArea(struct fb_area_s *area_p, bool times8, struct fb_state_s *state_p)
+static int flushDirtyAreas(struct fb_state_s *state_p)
 {
-    int retValue = 0, errcode;
+    struct fb_area_s area     = { .x = 0, .y = 0, .w = 0, .h = 0 };
+    struct fb_area_s merged;
+    int              retValue = 0;
+    uint8_t          line;
 
-    DEBUGASSERT(area_p != NULL);
-    DEBUGASSERT(state_p != NULL);
+    // loop through the lines
+    for(line = 0; (line < DISPLAY_CHARS_Y) && !retValue; line++)
+    {
+        // check if this line changed
+        if(gDirtyLines.endX[line] == 0)
+        {
+            continue;
+        }
 
-// if the area needs to be updated
-#ifdef CONFIG_FB_UPDATE
+        // check if there is an area to merge it with
+        if(area.w)
+        {
+            // make the area that includes both
+            merged.x = (gDirtyLines.startX[line] < area.x) ? gDirtyLines.startX[line] : area.x;
+            merged.w = area.x + area.w;
+            merged.w = (gDirtyLines.endX[line] > merged.w) ? gDirtyLines.endX[line] : merged.w;
+            merged.w -= merged.x;
+            merged.y = area.y;
+            merged.h = line + 1 - area.y;
+
+            // check if one update of the merged area is cheaper
+            if(areaCost(merged.w, merged.h) <=
+                (areaCost(area.w, area.h) + areaCost(gDirtyLines.endX[line] - gDirtyLines.startX[line], 1)))
+            {
+                area = merged;
+                continue;
+            }
 
-    // check if it needs to be multiplied by 8
-    if(times8)
-    {
-        DEBUGASSERT(area_p->x <= 15);
-        DEBUGASSERT(area_p->y <= 3);
-        DEBUGASSERT((area_p->x + area_p->w) <= 16);
-        DEBUGASSERT((area_p->y + area_p->h) <= 4);
-        area_p->x *= 8;
-        area_p->y *= 8;
-        area_p->w *= 8;
-        area_p->h *= 8;
-    }
+            // update the previous area
+            retValue = display_updateDisplayArea(&area, true, state_p);
+        }
 
-    // update the whole area with the framebuffer
-    retValue = ioctl(state_p->fd, FBIO_UPDATE, (unsigned long)((uintptr_t)area_p));
+        // start a new area with this line
+        area.x = gDirtyLines.startX[line];
+        area.y = line;
+        area.w = gDirtyLines.endX[line] - gDirtyLines.startX[line];
+        area.h = 1;
+    }
 
-    // check for errors
-    if(retValue < 0 || retValue > 0)
+    // update the last area
+    if(area.w && !retValue)
     {
-        errcode = errno;
-        cli_printfError("ERROR: ioctl(FBIO_UPDATE) failed: %d %d\n", errcode, retValue);
+        retValue = display_updateDisplayArea(&area, true, state_p);
     }
-#endif
+
+    // everything is sent, or it failed and the display will be uninitialized
+    memset(&gDirtyLines, 0, sizeof(gDirtyLines));
 
     return retValue;
 }
 
+/*!
+ * @brief   Function to handle a display_writeLine error of the display update
+ *
+ * @param retValue the return value of display_writeLine
+ *
+ * @return EXIT_SUCCESS if it was the charge relaxation state, EXIT_FAILURE otherwise
+ */
+static int writeLineError(int retValue)
+{
+    cli_printfError("ERROR: Couldn't write to display!\n");
+
+    // check if it was in the wrong state
+    if(retValue == -2)
+    {
+        return EXIT_SUCCESS;
+    }
+    else
+    {
+        return EXIT_FAILURE;
+    }
+}
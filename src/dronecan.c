@@ -68,6 +68,9 @@
 
 #include "data.h"
 #include "timestamp.h"
+#include "wakeSched.h"
+#include "supervisor.h"
+#include "memMon.h"
 
 #ifdef CANARD_VERSION_MAJOR
 #    undef CANARD_VERSION_MAJOR
@@ -120,6 +123,10 @@
 #define DRONECAN_TAO               1
 #define CAN_DEVICE                 "can0"
 
+#define DRONECAN_RX_TIMEOUT_MS       4000 //!< the timeout to wait for a CAN frame or the BMS application
+#define DRONECAN_RX_TIMEOUT_SLACK_MS 1000 //!< the time the timeout may be later to wake with other tasks
+#define CAN_SUPERVISOR_DEADLINE_MS   2000 //!< the time the handling of the received or published data may take
+
 #define BOOL_VAL   UAVCAN_PROTOCOL_PARAM_VALUE_BOOLEAN_VALUE
 #define INT_VAL    UAVCAN_PROTOCOL_PARAM_VALUE_INTEGER_VALUE
 #define STRING_VAL UAVCAN_PROTOCOL_PARAM_VALUE_STRING_VALUE
@@ -237,6 +244,9 @@ int dronecan_initialize(void)
         }
         else
         {
+            // monitor its stack
+            memMon_registerTask("DRONECAN", "DRONECAN_DAEMON_STACK_SIZE", ret, DRONECAN_DAEMON_STACK_SIZE);
+
             ret = 0;
         }
 
@@ -2388,7 +2398,10 @@ static void pubPowerBatteryInfoAux(DroneCanardInstance *ins, uint8_t *transfer_i
     struct ardupilot_equipment_power_BatteryInfoAux batInfoAux;
     memset(&batInfoAux, 0, sizeof(struct ardupilot_equipment_power_BatteryInfoAux));
 
-    // not implemented: over_discharge_count, max_current, timestamp
+    // not implemented: over_discharge_count, max_current
+
+    // get the timestamp, the monotonic time of the measurement (0 if unknown)
+    batInfoAux.timestamp.usec = data_getMeasurementTimeUs();
 
     // get the number of cells
     dataReturn = (int32_t *)data_getParameter(N_CELLS, &batInfoAux.voltage_cell.len, NULL);
@@ -2501,6 +2514,8 @@ static int DRONECANTask(int argc, char *argv[])
     uint8_t              BatteryInfoAuxTransferId;
     bool                 needPublish = false;
 
+    CanardPoolAllocatorStatistics poolStats;
+
 
     // initialize eventfd to signal select while reading
     if((efd = eventfd(0, 0)) < 0)
@@ -2574,6 +2589,13 @@ static int DRONECANTask(int argc, char *argv[])
                     // make the battery info auxilary message and add it to the buffer
                     pubPowerBatteryInfoAux(&ins, &BatteryInfoAuxTransferId);
 
+                    // update the use of the memory pool, the peak is kept by libcanard
+                    poolStats = canardGetPoolAllocatorStatistics(&ins);
+                    memMon_setPool(MEM_MON_POOL_DRONECAN, MEMORY_POOL_SIZE,
+                        poolStats.capacity_blocks * CANARD_MEM_BLOCK_SIZE,
+                        poolStats.current_usage_blocks * CANARD_MEM_BLOCK_SIZE,
+                        poolStats.peak_usage_blocks * CANARD_MEM_BLOCK_SIZE, 0);
+
                     // reset count
                     countBP = 0;
                 }
@@ -2581,7 +2603,12 @@ static int DRONECANTask(int argc, char *argv[])
 
             // process the TX and RX buffer
             // And check if the BMS wants to publisch the BMS data
-            needPublish = processTxRxOnce(&ins, &sock_ins, 4000);
+            // the timeout is aligned with the other wake-ups
+            needPublish = processTxRxOnce(&ins, &sock_ins, 
+                (int)wakeSched_alignTimeout(WAKE_SCHED_CAN, DRONECAN_RX_TIMEOUT_MS, DRONECAN_RX_TIMEOUT_SLACK_MS));
+
+            // count the wake-up
+            wakeSched_wokeUp(WAKE_SCHED_CAN);
         }
     }
 
@@ -2619,6 +2646,7 @@ int dronecan_flushtx(void)
 bool processTxRxOnce(DroneCanardInstance *ins, CanardSocketInstance *sock_ins, int timeout_msec)
 {
     bool publish = false; 
+    int  pollResult;
 
     // Transmitting
     for(const CanardCANFrame *txf = NULL; (txf = canardPeekTxQueue(ins)) != NULL;)
@@ -2641,7 +2669,16 @@ bool processTxRxOnce(DroneCanardInstance *ins, CanardSocketInstance *sock_ins, i
         }
     }
 
-    if(poll(pDfds, 2, timeout_msec) > 0)
+    // don't supervise the task while it waits
+    supervisor_checkIn(SUPERVISOR_CAN, SUPERVISOR_OFF);
+
+    // wait for either can messages or the BMS application
+    pollResult = poll(pDfds, 2, timeout_msec);
+
+    // supervise the handling of it
+    supervisor_checkIn(SUPERVISOR_CAN, CAN_SUPERVISOR_DEADLINE_MS);
+
+    if(pollResult > 0)
     {
         // received messages
         if(pDfds[0].revents & POLLIN)
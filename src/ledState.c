@@ -54,6 +54,9 @@
 
 #include "ledState.h"
 #include "cli.h"
+#include "wakeSched.h"
+#include "memMon.h"
+#include "timeBase.h"
 
 #ifndef CONFIG_ARCH_LEDS
 
@@ -64,9 +67,8 @@
 #define DEFAULT_LED_PRIORITY   50
 #define DEFAULT_LED_STACK_SIZE 1024 + 256
 
-#ifndef MAX_NSEC
-#   define MAX_NSEC            999999999
-#endif
+//! @brief the time in ms a blink may be later to wake up together with other tasks
+#define LED_WAKE_SLACK_MS      50
 
 /****************************************************************************
  * Types
@@ -261,6 +263,9 @@ int ledState_initialize(LEDColor_t startColor, bool skipSelfTest)
         return lvRetValue;
     }
 
+    // monitor its stack
+    memMon_registerTask("blinker", "DEFAULT_LED_STACK_SIZE", lvRetValue, DEFAULT_LED_STACK_SIZE);
+
     // change the return value
     lvRetValue = OK;
 
@@ -367,6 +372,7 @@ int ledState_setLedColor(LEDColor_t newColor, LEDColor_t newAltColor, uint16_t b
 static int ledBlinkTaskFunc(int argc, char *argv[])
 {
     struct timespec waitTime;
+    uint64_t        waitUs;
     bool            lvBlinkingOff    = false;
     int             semState         = 0;
     uint8_t         greenBlinkCounts = 0;
@@ -397,75 +403,62 @@ static int ledBlinkTaskFunc(int argc, char *argv[])
         lvBlinkingOff = !lvBlinkingOff;
 
         // get the time
-        if(clock_gettime(CLOCK_REALTIME, &waitTime))
-        {
-            cli_printfError("ledState ERROR: failed to get time! errno: %d\n", errno);
+        waitUs = timeBase_getUs();
 
-            // than just sleep
-            usleep(gOnOffTimems * 1000);
-        }
-        // if you got the current time
-        else
+        // check when in normal mode, to indicate the state of charge
+        if(gLEDColor == GREEN)
         {
-            // check when in normal mode, to indicate the state of charge
-            if(gLEDColor == GREEN)
+            // check if the LED is off
+            if(lvBlinkingOff)
             {
-                // check if the LED is off
-                if(lvBlinkingOff)
+                // increase the blink counter and check if equal to the amount of blinks
+                if(++greenBlinkCounts >= ledState_getStateIndication())
                 {
-                    // increase the blink counter and check if equal to the amount of blinks
-                    if(++greenBlinkCounts >= ledState_getStateIndication())
-                    {
-                        // reset the counter
-                        greenBlinkCounts = 0;
+                    // reset the counter
+                    greenBlinkCounts = 0;
 
 #ifdef LED_INDICATION_DEFINED_WAIT
-                        // make a wait time to make sure it waits LED_DEFINED_WAIT
-                        waitTime.tv_sec += LED_DEFINED_WAIT;
+                    // make a wait time to make sure it waits LED_DEFINED_WAIT
+                    waitUs += LED_DEFINED_WAIT * TIME_BASE_US_PER_S;
 #else
-                        // make a wait time to make sure it is off until LED_PERIOD_INDICATION_S total period
-                        // has passed
-                        waitTime.tv_sec += (LED_PERIOD_INDICATION_S - ledState_getStateIndication());
+                    // make a wait time to make sure it is off until LED_PERIOD_INDICATION_S total period
+                    // has passed
+                    waitUs += (LED_PERIOD_INDICATION_S - ledState_getStateIndication()) * TIME_BASE_US_PER_S;
 #endif
-                    }
-                    else
-                    {
-                        // make the wait time
-                        waitTime.tv_sec += ((int)LED_BLINK_TIME_MS / 1000) +
-                            (waitTime.tv_nsec + ((LED_BLINK_TIME_MS % 1000) * 1000 * 1000)) /
-                                (int)(MAX_NSEC + 1);
-                        waitTime.tv_nsec =
-                            (waitTime.tv_nsec + ((LED_BLINK_TIME_MS % 1000) * 1000 * 1000)) % (MAX_NSEC + 1);
-                    }
                 }
                 else
                 {
-                    waitTime.tv_sec += ((int)LED_BLINK_TIME_MS / 1000) +
-                        (waitTime.tv_nsec + ((LED_BLINK_TIME_MS % 1000) * 1000 * 1000)) / (int)(MAX_NSEC + 1);
-                    waitTime.tv_nsec =
-                        (waitTime.tv_nsec + ((LED_BLINK_TIME_MS % 1000) * 1000 * 1000)) % (MAX_NSEC + 1);
+                    // make the wait time
+                    waitUs += LED_BLINK_TIME_MS * TIME_BASE_US_PER_MS;
                 }
             }
-            // if it is any other color blink
             else
             {
-                // add the blinktime
-                // waitTime.tv_sec   += LED_BLINK_TIME_S;
-                waitTime.tv_sec += ((int)gOnOffTimems / 1000) +
-                    (waitTime.tv_nsec + ((gOnOffTimems % 1000) * 1000 * 1000)) / (int)(MAX_NSEC + 1);
-                waitTime.tv_nsec =
-                    (waitTime.tv_nsec + ((gOnOffTimems % 1000) * 1000 * 1000)) % (MAX_NSEC + 1);
+                waitUs += LED_BLINK_TIME_MS * TIME_BASE_US_PER_MS;
             }
+        }
+        // if it is any other color blink
+        else
+        {
+            // add the blinktime
+            waitUs += gOnOffTimems * TIME_BASE_US_PER_MS;
+        }
 
-            // wait for the time to expire or continue when semaphore is available
-            semState = sem_timedwait(&gBlinkerWaitSem, &waitTime);
+        // align it with the other wake-ups
+        wakeSched_alignDeadline(WAKE_SCHED_LED, &waitUs, LED_WAKE_SLACK_MS);
 
-            // check if the sem was available
-            if(!semState)
-            {
-                // set the blinking variable on
-                lvBlinkingOff = true;
-            }
+        // wait for the time to expire or continue when semaphore is available
+        timeBase_toRealtime(waitUs, &waitTime);
+        semState = sem_timedwait(&gBlinkerWaitSem, &waitTime);
+
+        // count the wake-up
+        wakeSched_wokeUp(WAKE_SCHED_LED);
+
+        // check if the sem was available
+        if(!semState)
+        {
+            // set the blinking variable on
+            lvBlinkingOff = true;
         }
     }
 
@@ -37,6 +37,8 @@
  ****************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include <arch/board/board.h>
 #include <sched.h>
 #include <semaphore.h>
@@ -58,6 +60,10 @@
 #include "i2c.h"
 #include "power.h"
 #include "display.h"
+#include "wakeSched.h"
+#include "supervisor.h"
+#include "memMon.h"
+#include "timeBase.h"
 
 #warning setting default string in dronecan will not work yet.
 
@@ -98,6 +104,28 @@
 #define MAIN_LOOP_WAIT_TIME_MS 100 // [ms]
 //! @brief Same as above, but in sleep mode.
 #define MAIN_LOOP_LONG_WAIT_TIME_S 2 // [s]
+//! @brief Same as above, but in the SLEEP state where the AFE measures cyclic and wakes the MCU with its fault pin.
+//! @note  This plus MAIN_LOOP_LONG_WAIT_SLACK_MS needs to be lower than MAIN_LOOP_SUPERVISOR_DEADLINE_MS,
+//!        the supervisor only kicks the SBC watchdog while the main loop checks in on time.
+#define MAIN_LOOP_SLEEP_WAIT_TIME_S 3 // [s]
+//! @brief The slack the main loop allows on the 100ms wait to wake together with other tasks.
+#define MAIN_LOOP_WAIT_SLACK_MS 50 // [ms]
+//! @brief The slack the main loop allows on the long (2s or 3s) waits to wake together with other tasks.
+//! @note  The long wait plus this needs to be lower than MAIN_LOOP_SUPERVISOR_DEADLINE_MS.
+#define MAIN_LOOP_LONG_WAIT_SLACK_MS 500 // [ms]
+//! @brief The maximum time between two check-ins of the main loop with the supervisor.
+#define MAIN_LOOP_SUPERVISOR_DEADLINE_MS 6000 // [ms]
+//! @brief The maximum time the updater task may take for an update.
+#define UPDATER_SUPERVISOR_DEADLINE_MS 3000 // [ms]
+
+//! @brief The from state of a transition table entry that is valid from any state.
+#define TRANSITION_FROM_ANY 0xFF
+
+//! @brief The amount of records in the transition trace ring.
+#define TRANSITION_TRACE_RECORDS 32
+
+//! @brief Bit in the cause of a trace record to indicate that the transition is not in the transition table.
+#define TRANSITION_TRACE_UNLISTED 0x80
 
 // check if PM module is configured correctly to go to VLPR mode
 #if(!defined(CONFIG_VLPR_STANDBY)) || (!defined(CONFIG_VLPR_SLEEP))
@@ -119,6 +147,69 @@ typedef enum
     DISCHAR_VAR
 } transitionVars_t;
 
+//! @brief The cause of a state transition.
+typedef enum
+{
+    TRANSITION_CAUSE_STARTUP,           //!< the self-test is done
+    TRANSITION_CAUSE_DISCHARGE,         //!< a discharge current is detected
+    TRANSITION_CAUSE_CHARGE,            //!< a charge current is detected
+    TRANSITION_CAUSE_CURRENT,           //!< the current is higher than the sleep current
+    TRANSITION_CAUSE_SLEEP_CURRENT,     //!< the current is lower than the sleep current or the charger is removed
+    TRANSITION_CAUSE_COMMAND,           //!< a CLI command (sleep, wake, deepsleep or reset)
+    TRANSITION_CAUSE_BUTTON,            //!< the button is released
+    TRANSITION_CAUSE_BUTTON_HOLD,       //!< the button is pressed for BUTTON_TIME_FOR_DEEP_SLEEP
+    TRANSITION_CAUSE_NFC,               //!< the NFC field is detected
+    TRANSITION_CAUSE_TIMEOUT,           //!< a timer of the state elapsed
+    TRANSITION_CAUSE_DONE,              //!< the state is done
+    TRANSITION_CAUSE_END_OF_CHARGE,     //!< the end of charge current or voltage is reached
+    TRANSITION_CAUSE_RECHARGE,          //!< the cells need to be charged (again)
+    TRANSITION_CAUSE_STORAGE,           //!< the storage voltage is reached
+    TRANSITION_CAUSE_FAULT,             //!< a fault is detected
+    TRANSITION_CAUSE_SLEEP_OVERCURRENT, //!< the sleep overcurrent is detected
+    TRANSITION_CAUSE_HW_OVERCURRENT,    //!< the hardware overcurrent is detected
+    TRANSITION_CAUSE_EMERGENCY_BUTTON,  //!< the emergency button is pressed
+    TRANSITION_CAUSE_NOT_IN_FLIGHT,     //!< the output is disconnected because it is not in flight
+    TRANSITION_CAUSE_UNDERVOLTAGE,      //!< the cell undervoltage lasted too long
+    TRANSITION_CAUSE_ERROR,             //!< recovering from an error
+    TRANSITION_CAUSES
+} transitionCause_t;
+
+//! @brief The variables of the main state machine the guards and actions of its transitions use.
+typedef struct
+{
+    uint64_t *pButtonPressedUs;   //!< the time in us (timeBase) of the button press
+    bool     *pDeepsleepTimingOn; //!< true if the button is pressed and its time is counted
+    bool     *pChargeToStorage;   //!< true if it charges to the storage voltage
+    uint64_t *pSleepPeriodUs;     //!< the time in us (timeBase) the sleep (OCV) period started
+    uint64_t *pSleepStartUs;      //!< the time in us (timeBase) it entered the sleep state (not from OCV)
+} transitionContext_t;
+
+//! @brief The guard of a transition, it returns true if the transition should be taken.
+typedef bool (*transitionGuard_t)(const transitionContext_t *pContext);
+
+//! @brief The action of a transition, it is done before the new state is set.
+typedef void (*transitionAction_t)(const transitionContext_t *pContext);
+
+//! @brief An entry of the transition table of the main or the charge state machine.
+typedef struct
+{
+    uint8_t            from;   //!< the old state, TRANSITION_FROM_ANY for any state
+    uint8_t            to;     //!< the new state
+    transitionCause_t  cause;  //!< the cause of the transition
+    transitionGuard_t  guard;  //!< the guard, NULL if it is set by an input, the fault handling or the state
+    transitionAction_t action; //!< the action, NULL if there is none
+} stateTransition_t;
+
+//! @brief A record of the transition trace ring (8 bytes).
+typedef struct
+{
+    uint32_t timeMs;        //!< the time since boot in ms
+    uint8_t  chargeMachine; //!< 1 if it is a transition of the charge state machine
+    uint8_t  from;          //!< the old state
+    uint8_t  to;            //!< the new state
+    uint8_t  cause;         //!< the transitionCause_t, with TRANSITION_TRACE_UNLISTED if not in the table
+} transitionRecord_t;
+
 /****************************************************************************
  * private data
  ****************************************************************************/
@@ -172,6 +263,101 @@ static bool gSInFlightChangedFalse = false;
 //! bool to indicate updater can mode
 static int gCanModeOFFDroneCANCyphalCAN = CAN_OFF_NUM; // 0 = off, 1 = DroneCAN, 2 = CyphalCAN
 
+/*! @brief  The guards and actions of the transitions of the main state machine, see gMainTransitions */
+static bool guardCharge(const transitionContext_t *pContext);
+static bool guardNoCharge(const transitionContext_t *pContext);
+static bool guardDischarge(const transitionContext_t *pContext);
+static bool guardSleepCurrent(const transitionContext_t *pContext);
+static bool guardNoSleepCurrent(const transitionContext_t *pContext);
+static bool guardSleepCommand(const transitionContext_t *pContext);
+static bool guardDeepsleepCommand(const transitionContext_t *pContext);
+static bool guardWakeCommand(const transitionContext_t *pContext);
+static bool guardButtonHold(const transitionContext_t *pContext);
+static bool guardStorageCommand(const transitionContext_t *pContext);
+static bool guardStorageButtonHold(const transitionContext_t *pContext);
+static bool guardNfc(const transitionContext_t *pContext);
+static bool guardSleepTimeout(const transitionContext_t *pContext);
+static bool guardOcvPeriod(const transitionContext_t *pContext);
+static bool guardDone(const transitionContext_t *pContext);
+static void actionNfc(const transitionContext_t *pContext);
+static void actionSleepTimeout(const transitionContext_t *pContext);
+
+/*! @brief  The transitions of the main state machine.
+ *          After the state is handled, doMainTransitions() takes the first transition of the state of which
+ *          the guard is true, so the transitions of a state are in the order of their priority.
+ *          The ones without a guard are set by the inputs (checkInputsAndStateTransitions()), the fault
+ *          handling (bmsHandleFault()), the charge state machine or the state itself.
+ */
+static const stateTransition_t gMainTransitions[] = {
+    { SELF_TEST, INIT, TRANSITION_CAUSE_STARTUP, NULL, NULL },
+    { TRANSITION_FROM_ANY, INIT, TRANSITION_CAUSE_ERROR, NULL, NULL },
+    { TRANSITION_FROM_ANY, FAULT_ON, TRANSITION_CAUSE_FAULT, NULL, NULL },
+    { TRANSITION_FROM_ANY, FAULT_OFF, TRANSITION_CAUSE_HW_OVERCURRENT, NULL, NULL },
+    { TRANSITION_FROM_ANY, FAULT_OFF, TRANSITION_CAUSE_EMERGENCY_BUTTON, NULL, NULL },
+    { INIT, CHARGE, TRANSITION_CAUSE_CHARGE, guardCharge, NULL },
+    { INIT, NORMAL, TRANSITION_CAUSE_DISCHARGE, guardNoCharge, NULL },
+    { NORMAL, SLEEP, TRANSITION_CAUSE_COMMAND, guardSleepCommand, NULL },
+    { NORMAL, SLEEP, TRANSITION_CAUSE_SLEEP_CURRENT, guardSleepCurrent, NULL },
+    { NORMAL, CHARGE, TRANSITION_CAUSE_CHARGE, guardCharge, NULL },
+    { NORMAL, SELF_DISCHARGE, TRANSITION_CAUSE_BUTTON_HOLD, guardButtonHold, NULL },
+    { CHARGE, SELF_DISCHARGE, TRANSITION_CAUSE_COMMAND, guardStorageCommand, NULL },
+    { CHARGE, SELF_DISCHARGE, TRANSITION_CAUSE_BUTTON_HOLD, guardStorageButtonHold, NULL },
+    { CHARGE, NORMAL, TRANSITION_CAUSE_DISCHARGE, guardDischarge, NULL },
+    { CHARGE, SLEEP, TRANSITION_CAUSE_SLEEP_CURRENT, guardSleepCurrent, NULL },
+    { CHARGE, SELF_DISCHARGE, TRANSITION_CAUSE_STORAGE, NULL, NULL },
+    { SLEEP, SELF_DISCHARGE, TRANSITION_CAUSE_BUTTON_HOLD, guardButtonHold, NULL },
+    { SLEEP, SELF_DISCHARGE, TRANSITION_CAUSE_COMMAND, guardDeepsleepCommand, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_COMMAND, guardWakeCommand, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_CURRENT, guardNoSleepCurrent, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_NFC, guardNfc, actionNfc },
+    { SLEEP, SELF_DISCHARGE, TRANSITION_CAUSE_TIMEOUT, guardSleepTimeout, actionSleepTimeout },
+    { SLEEP, OCV, TRANSITION_CAUSE_TIMEOUT, guardOcvPeriod, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_BUTTON, NULL, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_FAULT, NULL, NULL },
+    { SLEEP, INIT, TRANSITION_CAUSE_SLEEP_OVERCURRENT, NULL, NULL },
+    { OCV, SLEEP, TRANSITION_CAUSE_DONE, guardDone, NULL },
+    { FAULT_ON, INIT, TRANSITION_CAUSE_BUTTON, NULL, NULL },
+    { FAULT_ON, INIT, TRANSITION_CAUSE_COMMAND, NULL, NULL },
+    { FAULT_ON, FAULT_OFF, TRANSITION_CAUSE_FAULT, NULL, NULL },
+    { FAULT_ON, FAULT_OFF, TRANSITION_CAUSE_NOT_IN_FLIGHT, NULL, NULL },
+    { FAULT_ON, DEEP_SLEEP, TRANSITION_CAUSE_UNDERVOLTAGE, NULL, NULL },
+    { FAULT_OFF, INIT, TRANSITION_CAUSE_BUTTON, NULL, NULL },
+    { FAULT_OFF, INIT, TRANSITION_CAUSE_COMMAND, NULL, NULL },
+    { FAULT_OFF, FAULT_ON, TRANSITION_CAUSE_ERROR, NULL, NULL },
+    { FAULT_OFF, DEEP_SLEEP, TRANSITION_CAUSE_UNDERVOLTAGE, NULL, NULL },
+    { SELF_DISCHARGE, INIT, TRANSITION_CAUSE_BUTTON, NULL, NULL },
+    { SELF_DISCHARGE, INIT, TRANSITION_CAUSE_COMMAND, NULL, NULL },
+    { SELF_DISCHARGE, SLEEP, TRANSITION_CAUSE_COMMAND, NULL, NULL },
+    { SELF_DISCHARGE, DEEP_SLEEP, TRANSITION_CAUSE_DONE, NULL, NULL },
+};
+
+/*! @brief  The transitions of the charge state machine, these are set by chargeStateMachine(),
+ *          the CHARGE state and bmsHandleFault().
+ */
+static const stateTransition_t gChargeTransitions[] = {
+    { TRANSITION_FROM_ANY, CHARGE_START, TRANSITION_CAUSE_CHARGE, NULL, NULL },
+    { CHARGE_START, CHARGE_CB, TRANSITION_CAUSE_END_OF_CHARGE, NULL, NULL },
+    { CHARGE_START, CHARGE_CB, TRANSITION_CAUSE_TIMEOUT, NULL, NULL },
+    { CHARGE_CB, RELAXATION, TRANSITION_CAUSE_END_OF_CHARGE, NULL, NULL },
+    { CHARGE_CB, RELAXATION, TRANSITION_CAUSE_FAULT, NULL, NULL },
+    { RELAXATION, CHARGE_CB, TRANSITION_CAUSE_RECHARGE, NULL, NULL },
+    { RELAXATION, CHARGE_COMPLETE, TRANSITION_CAUSE_DONE, NULL, NULL },
+    { CHARGE_COMPLETE, CHARGE_CB, TRANSITION_CAUSE_RECHARGE, NULL, NULL },
+};
+
+//! the names of the transition causes
+static const char *const gTransitionCauseStrings[TRANSITION_CAUSES] = { "startup", "discharge", "charge",
+    "current", "sleep-current", "command", "button", "button-hold", "nfc", "timeout", "done", "end-of-charge",
+    "recharge", "storage", "fault", "sleep-overcurrent", "hw-overcurrent", "emergency-button", "not-in-flight",
+    "undervoltage", "error" };
+
+//! the transition trace ring and the total amount of traced transitions
+static transitionRecord_t gTransitionTrace[TRANSITION_TRACE_RECORDS];
+static uint32_t           gTransitionTraceCount = 0;
+
+//! mutex for the transition trace
+pthread_mutex_t gTransitionTraceLock;
+
 /****************************************************************************
  * private Functions
  ****************************************************************************/
@@ -196,16 +382,16 @@ static int updaterTaskFunc(int argc, char *argv[]);
  *          It will take care of the button, bcc pin and emergency button (if enabled) and act accordingly.
  *          It will check for faults if there are faults (from BCC or batManag task)
  *
- * @param   pSelfDischargeTime address of the timespec struct what is the selfDischargeTimestruct
- * @param   pButtonPressedTime address of the timespec struct to become the time of the button press
+ * @param   pSelfDischargeUs address of the time in us (timeBase) the self-discharge started
+ * @param   pButtonPressedUs address of the variable to become the time in us (timeBase) of the button press
  * @param   pDeepsleepTimingOn address of the variable to become the value if the deepsleep timing is on
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  None
  */
-static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
-    struct timespec *pButtonPressedTime, bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected,
+static void checkInputsAndStateTransitions(uint64_t *pSelfDischargeUs,
+    uint64_t *pButtonPressedUs, bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected,
     states_t *pOldState);
 
 /*!
@@ -216,39 +402,39 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
  * @param   risingEdgeMessage if true, it will output Rising edge BCC pin if needed.
  *          if false, it will check if clearing CC overflow needs to be send.
  * @param   BMSFault The value of the BMSFault, which can be retreived with batManagement_checkFault()
- * @param   pCurrentTime The address of the struct timespec of the current time.
+ * @param   currentUs The current time in us (timeBase).
  *
  * @return  none
  */
 static void bmsOutputRisingEdgeOrCCOverflow(
-    bool risingEdgeMessage, uint32_t BMSFault, struct timespec *pCurrentTime);
+    bool risingEdgeMessage, uint32_t BMSFault, uint64_t currentUs);
 
 /*!
  * @brief   Function that is used handle the noticed fault, it could change the state to FAULT_ON, INIT or
  * RELAXATION It could output the needed messages on the CLI and it could clear the fault.
  *
  * @param   BMSFault The BMSFault that is retreived from batManagement_checkFault()
- * @param   pCurrentTime address of the currentTime variable (after getting the current time)
+ * @param   currentUs the current time in us (timeBase)
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  none
  */
 static void bmsHandleFault(
-    uint32_t BMSFault, struct timespec *pCurrentTime, bool *pCellUnderVoltageDetected, states_t *pOldState);
+    uint32_t BMSFault, uint64_t currentUs, bool *pCellUnderVoltageDetected, states_t *pOldState);
 
 /*!
  * @brief   Function that is used take care of the main state machine.
  *
- * @param   pSelfDischargeTime address of the timespec struct what is the selfDischargeTimestruct
- * @param   pButtonPressedTime address of the timespec struct to become the time of the button press
+ * @param   pSelfDischargeUs address of the time in us (timeBase) the self-discharge started
+ * @param   pButtonPressedUs address of the variable to become the time in us (timeBase) of the button press
  * @param   pDeepsleepTimingOn address of the variable to become the value if the deepsleep timing is on
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  None
  */
-static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespec *pButtonPressedTime,
+static void mainStateMachine(uint64_t *pSelfDischargeUs, uint64_t *pButtonPressedUs,
     bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected, states_t *pOldState);
 
 /*!
@@ -321,8 +507,9 @@ void gpioIsrFunction(int signo, siginfo_t *siginfo, void *context);
  * @brief function that will be called when it needs to process a cli command when the CLI can't do this
  *
  * @param command the command that needs to be processed
+ * @param argument the argument of the command, NULL if there is none
  */
-int processCLICommand(commands_t command);
+int processCLICommand(commands_t command, const char *argument);
 
 /*!
  * @brief function that will return the main state, but it will use the mutex
@@ -333,10 +520,12 @@ states_t getMainState(void);
 
 /*!
  * @brief function that will set the main state, but it will use the mutex
+ *        a transition is saved in the transition trace
  *
  * @param newState the new state
+ * @param cause the cause of the transition
  */
-static int setMainState(states_t newState);
+static int setMainState(states_t newState, transitionCause_t cause);
 
 /*!
  * @brief   function that will return the charge state, but it will use the mutex
@@ -347,10 +536,59 @@ charge_states_t getChargeState(void);
 
 /*!
  * @brief   function that will set the charge state, but it will use the mutex
+ *          a transition is saved in the transition trace
  *
  * @param   newState the new state
+ * @param   cause the cause of the transition
+ */
+static int setChargeState(charge_states_t newState, transitionCause_t cause);
+
+/*!
+ * @brief   function that will save a transition in the transition trace ring
+ *          if the transition is not in the transition table, the cause will have TRANSITION_TRACE_UNLISTED
+ *
+ * @param   chargeMachine true if it is a transition of the charge state machine
+ * @param   from the old state
+ * @param   to the new state
+ * @param   cause the cause of the transition
+ */
+static void traceTransition(bool chargeMachine, uint8_t from, uint8_t to, transitionCause_t cause);
+
+/*!
+ * @brief   function that will take the first transition of the main state of which the guard is true,
+ *          it does the action of the transition and sets the new state
+ *
+ * @param   pContext the variables of the main state machine for the guards and actions
+ *
+ * @return  true if a transition is taken
+ */
+static bool doMainTransitions(const transitionContext_t *pContext);
+
+/*!
+ * @brief   function to check if the button is held for BUTTON_TIME_FOR_DEEP_SLEEP
+ *
+ * @param   pContext the variables of the main state machine
+ *
+ * @return  true if it is held long enough
+ */
+static bool isButtonHoldReached(const transitionContext_t *pContext);
+
+/*!
+ * @brief   function to check if the lowest cell voltage is at or above the storage voltage
+ *
+ * @return  true if it is
+ */
+static bool isStorageVoltageReached(void);
+
+/*!
+ * @brief   function that will output the transition trace ring, oldest first
  */
-static int setChargeState(charge_states_t newState);
+static void printTransitionTrace(void);
+
+/*!
+ * @brief   function to output the wake-ups and the time in RUN mode of each main state
+ */
+static void printWakeUpStats(void);
 
 /*!
  * @brief   function that will return one of the transition variables
@@ -438,7 +676,7 @@ static int setNGetEnableDisplayUpdates(bool setNGet, bool enable);
 
 /*!
  * @brief   Function that is used to call a usleep (task switch as well)
- *          but it will kick the watchdog first.
+ *          but it will check in with the supervisor first, which kicks the watchdog.
  *
  * @param   usec the number of microseconds to wait.
  *
@@ -580,6 +818,19 @@ int bms_main(int argc, char *argv[])
         pthread_mutex_init(&gSetCanMessagesLock, NULL);
         pthread_mutex_init(&gSetNfcUpdateLock, NULL);
         pthread_mutex_init(&gSetDisplayUpdateLock, NULL);
+        pthread_mutex_init(&gTransitionTraceLock, NULL);
+
+        // initialize the memory monitor before the tasks are started
+        if(memMon_initialize())
+        {
+            cli_printfError("main ERROR: failed to initialize memMon!\n");
+        }
+
+        // initialize the wake-up alignment before the tasks that use it are started
+        if(wakeSched_initialize())
+        {
+            cli_printfError("main ERROR: failed to initialize wakeSched!\n");
+        }
 
         // initialize the LED and make it RED
         retValue = ledState_initialize(RED, resetCauseExWatchdog);
@@ -617,6 +868,12 @@ int bms_main(int argc, char *argv[])
                 return 0;
             }
         }
+        else
+        {
+            // monitor its stack
+            memMon_registerTask(
+                "updater", "DEFAULT_UPDATER_STACK_SIZE", retValue, DEFAULT_UPDATER_STACK_SIZE);
+        }
 
         // initialzie the data part
         retValue = data_initialize(&handleParamaterChange, &getMainState, &getChargeState);
@@ -689,6 +946,15 @@ int bms_main(int argc, char *argv[])
             }
         }
 
+        // start the supervisor that kicks the watchdog
+        retValue = supervisor_initialize();
+        if(retValue)
+        {
+            // output to the user
+            cli_printfError("main ERROR: failed to initialize the supervisor! code %d\n", retValue);
+            return retValue;
+        }
+
 #ifndef DONT_DO_CAN
         {
             char     can_mode[STRING_MAX_CHARS];
@@ -867,7 +1133,7 @@ int bms_main(int argc, char *argv[])
         }
 
         // go to the INIT state
-        setMainState(INIT);
+        setMainState(INIT, TRANSITION_CAUSE_STARTUP);
 
         // create the main loop task
         retValue = task_create("mainLoop", MAIN_LOOP_PRIORITY, MAIN_LOOP_STACK_SIZE, mainTaskFunc, NULL);
@@ -882,6 +1148,9 @@ int bms_main(int argc, char *argv[])
         }
         else
         {
+            // monitor its stack
+            memMon_registerTask("mainLoop", "MAIN_LOOP_STACK_SIZE", retValue, MAIN_LOOP_STACK_SIZE);
+
             gBmsInitialized = true;
         }
     }
@@ -915,10 +1184,13 @@ static int mainTaskFunc(int argc, char *argv[])
 {
     int             retValue;
     struct timespec bmsWaitTime;
-    struct timespec buttonPressedTime;
-    struct timespec selfDischargeTime;
+    uint64_t        bmsWaitUs;
+    uint64_t        buttonPressedUs          = 0;
+    uint64_t        selfDischargeUs          = 0;
+    uint64_t        sleepStartUs             = 0;
     bool            deepsleepTimingOn        = false;
     bool            cellUnderVoltageDetected = false;
+    uint32_t        sleepWakeUps             = 0;
 
     // get the variables if the fault happend
     gBCCRisingEdge = gpio_readPin(BCC_FAULT);
@@ -968,17 +1240,40 @@ static int mainTaskFunc(int argc, char *argv[])
         // It will output message on the CLI and change the main or charge state.
         // it will check the inputs and faults and change the main or charge state if needed.
         checkInputsAndStateTransitions(
-            &selfDischargeTime, &buttonPressedTime, &deepsleepTimingOn, &cellUnderVoltageDetected, &oldState);
+            &selfDischargeUs, &buttonPressedUs, &deepsleepTimingOn, &cellUnderVoltageDetected, &oldState);
 
         // do the things as described in the main state machine diagram
         // this is where the actual logic of the state diagram is
         mainStateMachine(
-            &selfDischargeTime, &buttonPressedTime, &deepsleepTimingOn, &cellUnderVoltageDetected, &oldState);
+            &selfDischargeUs, &buttonPressedUs, &deepsleepTimingOn, &cellUnderVoltageDetected, &oldState);
 
         // get the current time
-        if(clock_gettime(CLOCK_REALTIME, &bmsWaitTime) == -1)
+        bmsWaitUs = timeBase_getUs();
+
+        // count the wake-up statistics for this state and MCU power mode
+        wakeSched_setState(getMainState(), (power_setNGetMcuPowerMode(false, ERROR_VALUE) == RUN_MODE));
+
+        // check if the SLEEP state is entered and count the MCU wake-ups in it
+        if(getMainState() == SLEEP && oldState == SLEEP)
         {
-            cli_printfError("main ERROR: failed to get bmsWaitTime!\n");
+            // check if this is the first one
+            if(!sleepWakeUps)
+            {
+                // save the start time
+                sleepStartUs = bmsWaitUs;
+            }
+
+            sleepWakeUps++;
+        }
+        // check if the SLEEP state is left
+        else if(sleepWakeUps)
+        {
+            // output the wake-ups to the user
+            cli_printf("SLEEP: %d MCU wake-ups in %ds\n", sleepWakeUps,
+                (int)((bmsWaitUs - sleepStartUs) / TIME_BASE_US_PER_S));
+
+            // reset the counter
+            sleepWakeUps = 0;
         }
 
         // check if in charge relaxation where the BMS is doing a lot in very low power run mode
@@ -986,30 +1281,41 @@ static int mainTaskFunc(int argc, char *argv[])
         if(getMainState() == CHARGE && getChargeState() == RELAXATION)
         {
             // add the 2s, for 2s wait
-            bmsWaitTime.tv_sec += MAIN_LOOP_LONG_WAIT_TIME_S;
+            bmsWaitUs += MAIN_LOOP_LONG_WAIT_TIME_S * TIME_BASE_US_PER_S;
+
+            // align it with the other wake-ups
+            wakeSched_alignDeadline(WAKE_SCHED_MAIN, &bmsWaitUs, MAIN_LOOP_LONG_WAIT_SLACK_MS);
+        }
+        // check if in the SLEEP state, where the AFE measures on its own
+        // a threshold, sleep overcurrent or CC overflow fault of the AFE posts the semaphore with the fault pin
+        // the button as well, after a press the 100ms wait is used to time the hold for deepsleep
+        else if(getMainState() == SLEEP && oldState == SLEEP && !deepsleepTimingOn)
+        {
+            // add the 3s, for 3s wait
+            bmsWaitUs += MAIN_LOOP_SLEEP_WAIT_TIME_S * TIME_BASE_US_PER_S;
+
+            // align it with the other wake-ups
+            wakeSched_alignDeadline(WAKE_SCHED_MAIN, &bmsWaitUs, MAIN_LOOP_LONG_WAIT_SLACK_MS);
         }
         else
         {
             // make the 100ms wait time in the current time for the normal mode
-            bmsWaitTime.tv_sec += (bmsWaitTime.tv_nsec + MAIN_LOOP_WAIT_TIME_MS * 1000000) / (MAX_NSEC + 1);
-            bmsWaitTime.tv_nsec = (bmsWaitTime.tv_nsec + MAIN_LOOP_WAIT_TIME_MS * 1000000) % (MAX_NSEC + 1);
-        }
+            bmsWaitUs += MAIN_LOOP_WAIT_TIME_MS * TIME_BASE_US_PER_MS;
 
-        // kick the watchdog before the timed wait
-        if(sbc_kickTheWatchdog())
-        {
-            cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
+            // align it with the other wake-ups
+            wakeSched_alignDeadline(WAKE_SCHED_MAIN, &bmsWaitUs, MAIN_LOOP_WAIT_SLACK_MS);
         }
 
+        // check in with the supervisor before the timed wait, the supervisor kicks the watchdog
+        supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
+
         // wait for 100ms or the semaphore is posted (with a fault)
         // the semaphore is posted to trigger this task when it needs to react on things
+        timeBase_toRealtime(bmsWaitUs, &bmsWaitTime);
         sem_timedwait(&gMainLoopSem, &bmsWaitTime);
 
-        // kick the watchdog after the timed wait
-        if(sbc_kickTheWatchdog())
-        {
-            cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-        }
+        // count the wake-up
+        wakeSched_wokeUp(WAKE_SCHED_MAIN);
     }
 
     return 0;
@@ -1031,9 +1337,15 @@ static int updaterTaskFunc(int argc, char *argv[])
     // loop endlessly
     while(1)
     {
+        // don't supervise the updater while it waits for an update
+        supervisor_checkIn(SUPERVISOR_UPDATER, SUPERVISOR_OFF);
+
         // wait until the semaphore is available
         sem_wait(&gUpdaterSem);
 
+        // supervise the update
+        supervisor_checkIn(SUPERVISOR_UPDATER, UPDATER_SUPERVISOR_DEADLINE_MS);
+
         // get the variables in the local copy of the struct to make sure
         // Every update uses the same data
         if(data_getCommonBatteryVariables(&updaterCommonBatteryVars) ||
@@ -1167,28 +1479,29 @@ static int updaterTaskFunc(int argc, char *argv[])
  *          It will take care of the button, bcc pin and emergency button (if enabled) and act accordingly.
  *          It will check for faults if there are faults (from BCC or batManag task)
  *
- * @param   pSelfDischargeTime address of the timespec struct what is the selfDischargeTimestruct
- * @param   pButtonPressedTime address of the timespec struct to become the time of the button press
+ * @param   pSelfDischargeUs address of the time in us (timeBase) the self-discharge started
+ * @param   pButtonPressedUs address of the variable to become the time in us (timeBase) of the button press
  * @param   pDeepsleepTimingOn address of the variable to become the value if the deepsleep timing is on
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  None
  */
-static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
-    struct timespec *pButtonPressedTime, bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected,
+static void checkInputsAndStateTransitions(uint64_t *pSelfDischargeUs,
+    uint64_t *pButtonPressedUs, bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected,
     states_t *pOldState)
 {
-    static bool     firstTime      = true;
-    static int      oldButtonState = 0;
-    int             buttonState;
-    uint32_t        BMSFault;
-    uint8_t         emergencyButtonEnable;
-    struct timespec currentTime;
-    states_t        mainState = getMainState();
+    static bool       firstTime      = true;
+    static int        oldButtonState = 0;
+    int               buttonState;
+    uint32_t          BMSFault;
+    uint8_t           emergencyButtonEnable;
+    uint64_t          currentUs;
+    transitionCause_t cause;
+    states_t          mainState = getMainState();
 
     // check for NULL pointers in debug mode
-    DEBUGASSERT(pButtonPressedTime != NULL);
+    DEBUGASSERT(pButtonPressedUs != NULL);
     DEBUGASSERT(pDeepsleepTimingOn != NULL);
 
     // get the buttonstate
@@ -1263,7 +1576,7 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
             batManagement_setCCOvrFltEnable(true);
 
             // go to the INIT state
-            setMainState(INIT);
+            setMainState(INIT, TRANSITION_CAUSE_FAULT);
             mainState = INIT;
         }
 
@@ -1272,17 +1585,14 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
         batManagement_checkFault(&BMSFault, 0);
 
         // get the current time
-        if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-        {
-            cli_printfError("main ERROR: failed to get currentTime in gBCCRisingEdge!\n");
-        }
+        currentUs = timeBase_getUs();
 
         // don't output Rising edge BCC pin! when first start-up
         if(!firstTime)
         {
             // output the rising edge BCC pin! message
             // if it is because of BMS_CC_OVERFLOW, check if it needs to be send again.
-            bmsOutputRisingEdgeOrCCOverflow(true, BMSFault, &currentTime);
+            bmsOutputRisingEdgeOrCCOverflow(true, BMSFault, currentUs);
 
             // check if a fault occured
             if(BMSFault)
@@ -1290,7 +1600,7 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
                 // handle the fault
                 // this function could set the state to FAULT_ON, INIT or RELAXATION
                 // It will output the error to the user and is able to clear the fault
-                bmsHandleFault(BMSFault, &currentTime, pCellUnderVoltageDetected, pOldState);
+                bmsHandleFault(BMSFault, currentUs, pCellUnderVoltageDetected, pOldState);
             }
         }
 
@@ -1307,10 +1617,7 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
         if(mainState == SLEEP || mainState == NORMAL || mainState == CHARGE)
         {
             // get the time
-            if(clock_gettime(CLOCK_REALTIME, pButtonPressedTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get buttonPressedTime!\n");
-            }
+            *pButtonPressedUs = timeBase_getUs();
 
             // set the variable true
             *pDeepsleepTimingOn = true;
@@ -1323,30 +1630,25 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
     // check the button ISR value or the fault should be reset
     if(gButtonRisingEdge || setNGetStateCommandVariable(false, CMD_ERROR) == CMD_RESET)
     {
+        // check if it is the button or the reset command
+        cause = gButtonRisingEdge ? TRANSITION_CAUSE_BUTTON : TRANSITION_CAUSE_COMMAND;
+
         // check if it is in the FAULT_ON, FAULT_OFF or SLEEP state
         // because then the button will reset to init.
         if(mainState == FAULT_ON || mainState == FAULT_OFF || mainState == SLEEP)
         {
             // go the the init state with a button press
-            setMainState(INIT);
+            setMainState(INIT, cause);
             mainState = INIT;
         }
         // in in self discharge, the button press could make it go to init as well after the elapsed time
         else if(mainState == SELF_DISCHARGE)
         {
-            // get the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get currentTime in gButtonRisingEdge!\n");
-            }
-
             // check if the right amount of time has passed
-            if(((pSelfDischargeTime->tv_sec + SELF_DISCHARGE_WAIT_TIME) < currentTime.tv_sec) ||
-                (((pSelfDischargeTime->tv_sec + SELF_DISCHARGE_WAIT_TIME) == currentTime.tv_sec) &&
-                    pSelfDischargeTime->tv_nsec <= currentTime.tv_nsec))
+            if(timeBase_isReached(*pSelfDischargeUs + (SELF_DISCHARGE_WAIT_TIME * TIME_BASE_US_PER_S)))
             {
                 // go to the INIT state
-                setMainState(INIT);
+                setMainState(INIT, cause);
                 mainState = INIT;
             }
         }
@@ -1368,7 +1670,7 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
         cli_printfError("main ERROR: hardware overcurrent detected!\n");
 
         // go to the FAULT_OFF state since the hardware overcurrent has turned off the system
-        setMainState(FAULT_OFF);
+        setMainState(FAULT_OFF, TRANSITION_CAUSE_HW_OVERCURRENT);
         mainState = FAULT_OFF;
     }
 
@@ -1389,7 +1691,7 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
         cli_printfError("main ERROR: emergency button pressed!\n");
 
         // go to the FAULT_OFF state
-        setMainState(FAULT_OFF);
+        setMainState(FAULT_OFF, TRANSITION_CAUSE_EMERGENCY_BUTTON);
     }
 
     // it is not the first time anymore
@@ -1406,17 +1708,17 @@ static void checkInputsAndStateTransitions(struct timespec *pSelfDischargeTime,
  * @param   risingEdgeMessage if true, it will output Rising edge BCC pin if needed.
  *          if false, it will check if clearing CC overflow needs to be send.
  * @param   BMSFault The value of the BMSFault, which can be retreived with batManagement_checkFault()
- * @param   pCurrentTime The address of the struct timespec of the current time.
+ * @param   currentUs The current time in us (timeBase).
  *
  * @return  none
  */
 static void bmsOutputRisingEdgeOrCCOverflow(
-    bool risingEdgeMessage, uint32_t BMSFault, struct timespec *pCurrentTime)
+    bool risingEdgeMessage, uint32_t BMSFault, uint64_t currentUs)
 {
     static bool            outputCCOverflowMessage = false;
     static bool            outputtedFirstMessage   = false;
     static uint16_t        amountOfMissedMessages  = 0;
-    static struct timespec lastMessageTime         = { 0, 0 };
+    static uint64_t        lastMessageUs           = 0;
 
     // what should be send
     if(risingEdgeMessage)
@@ -1432,7 +1734,7 @@ static void bmsOutputRisingEdgeOrCCOverflow(
         }
         // if it is the CC overflow and the time between the messages is long enough or the max is reached
         else if((BMSFault & BMS_CC_OVERFLOW) &&
-            (((lastMessageTime.tv_sec + CC_OVERFLOW_MESS_TIMEOUT_TIME) < pCurrentTime->tv_sec) ||
+            (((lastMessageUs + (CC_OVERFLOW_MESS_TIMEOUT_TIME * TIME_BASE_US_PER_S)) < currentUs) ||
                 (amountOfMissedMessages == UINT16_MAX) || (!outputtedFirstMessage)))
         {
             // check if there are missed messages
@@ -1481,10 +1783,7 @@ static void bmsOutputRisingEdgeOrCCOverflow(
             amountOfMissedMessages = 0;
 
             // save the time
-            if(clock_gettime(CLOCK_REALTIME, &lastMessageTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get lastMessageTime in gBCCRisingEdge!\n");
-            }
+            lastMessageUs = timeBase_getUs();
         }
     }
 
@@ -1496,14 +1795,14 @@ static void bmsOutputRisingEdgeOrCCOverflow(
  * RELAXATION It could output the needed messages on the CLI and it could clear the fault.
  *
  * @param   BMSFault The BMSFault that is retreived from batManagement_checkFault()
- * @param   pCurrentTime address of the currentTime variable (after getting the current time)
+ * @param   currentUs the current time in us (timeBase)
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  none
  */
 static void bmsHandleFault(
-    uint32_t BMSFault, struct timespec *pCurrentTime, bool *pCellUnderVoltageDetected, states_t *pOldState)
+    uint32_t BMSFault, uint64_t currentUs, bool *pCellUnderVoltageDetected, states_t *pOldState)
 {
     bool            isCCRegisterCleared;
     int             ret;
@@ -1538,7 +1837,7 @@ static void bmsHandleFault(
         if(mainState == SLEEP)
         {
             // go to the init state
-            setMainState(INIT);
+            setMainState(INIT, TRANSITION_CAUSE_SLEEP_OVERCURRENT);
         }
     }
 
@@ -1582,7 +1881,7 @@ static void bmsHandleFault(
             (!(BMSFault & (BMS_AVG_OVER_CURRENT + BMS_PEAK_OVER_CURRENT + BMS_UT + BMS_OT))))
         {
             // set the relaxation state
-            setChargeState(RELAXATION);
+            setChargeState(RELAXATION, TRANSITION_CAUSE_FAULT);
 
             // clear the fault (not an overvoltage, but end of charge voltage)
             batManagement_checkFault(&BMSFault, true);
@@ -1605,7 +1904,7 @@ static void bmsHandleFault(
             }
 
             // go to the FAULT_ON state
-            setMainState(FAULT_ON);
+            setMainState(FAULT_ON, TRANSITION_CAUSE_FAULT);
 
             // check if the old state is the FAULT_ON state
             if(*pOldState == FAULT_ON)
@@ -1632,7 +1931,7 @@ static void bmsHandleFault(
         if(isCCRegisterCleared)
         {
             // output CC overflow message if needed
-            bmsOutputRisingEdgeOrCCOverflow(false, BMSFault, pCurrentTime);
+            bmsOutputRisingEdgeOrCCOverflow(false, BMSFault, currentUs);
         }
 
         // check for errors
@@ -1658,29 +1957,30 @@ static void bmsHandleFault(
 /*!
  * @brief   Function that is used take care of the main state machine.
  *
- * @param   pSelfDischargeTime address of the timespec struct what is the selfDischargeTimestruct
- * @param   pButtonPressedTime address of the timespec struct to become the time of the button press
+ * @param   pSelfDischargeUs address of the time in us (timeBase) the self-discharge started
+ * @param   pButtonPressedUs address of the variable to become the time in us (timeBase) of the button press
  * @param   pDeepsleepTimingOn address of the variable to become the value if the deepsleep timing is on
  * @param   pCellUnderVoltageDetected address of the variable that is used to keep track of an undervoltage
  * @param   pOldState address of the oldState variable
  *
  * @return  None
  */
-static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespec *pButtonPressedTime,
+static void mainStateMachine(uint64_t *pSelfDischargeUs, uint64_t *pButtonPressedUs,
     bool *pDeepsleepTimingOn, bool *pCellUnderVoltageDetected, states_t *pOldState)
 {
-    static struct timespec sampleTime, sampleTime2;
-    static struct timespec cellUnderVoltageTime;
+    static uint64_t        sampleUs = 0, sampleUs2 = 0;
+    static uint64_t        cellUnderVoltageUs    = 0;
     static bool            chargeToStorage       = false;
     static bool            outputMessageOnlyOnce = false;
     static charge_states_t oldChargeState        = CHARGE_COMPLETE;
     static uint16_t        bmsTimeoutTime        = 0;
     int                    retValue;
     uint32_t               BMSFault;
-    struct timespec        currentTime;
     variableTypes_u        tempVariable1, tempVariable2;
     mcuPowerModes_t        mcuPowerMode;
     states_t               mainState = getMainState();
+    transitionContext_t    context   = { pButtonPressedUs, pDeepsleepTimingOn, &chargeToStorage, &sampleUs,
+        &sampleUs2 };
 
     // check the state variable which state it is
     switch(mainState)
@@ -1716,26 +2016,15 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 if(BMSFault)
                 {
                     // get the time
-                    if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get sampleTime!\n");
-                    }
+                    sampleUs = timeBase_getUs();
 
                     // wait until the pin is low again or 1sec timeout
                     do
                     {
-                        // get the time to check for an overflow
-                        if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                        {
-                            cli_printfError("main ERROR: failed to get currentTime!\n");
-                        }
-
                         // sleep for 10ms with a watchdog reset
                         usleepMainLoopWatchdog(10 * 1000UL);
 
-                    } while(gpio_readPin(BCC_FAULT) &&
-                        (((currentTime.tv_sec - sampleTime.tv_sec) >= 1) &&
-                            (currentTime.tv_nsec >= sampleTime.tv_nsec)));
+                    } while(gpio_readPin(BCC_FAULT) && !timeBase_isReached(sampleUs + TIME_BASE_US_PER_S));
 
                     // check if timeout happend
                     if(gpio_readPin(BCC_FAULT))
@@ -1807,7 +2096,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 if(tempVariable1.boolVar != 1)
                 {
                     // go to the FAULT_ON state
-                    setMainState(FAULT_ON);
+                    setMainState(FAULT_ON, TRANSITION_CAUSE_FAULT);
 
                     // make sure to do the whole init state next time
                     *pOldState = SELF_TEST;
@@ -1849,17 +2138,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 cli_printf("INIT mode\n");
             }
 
-            // check for discharge
-            if(!getTransitionVariable(CHAR_VAR))
-            {
-                // go to the normal state
-                setMainState(NORMAL);
-            }
-            else
-            {
-                // go to the charge state
-                setMainState(CHARGE);
-            }
+            // go to the normal or the charge state
+            doMainTransitions(&context);
         }
 
         break;
@@ -1920,47 +2200,15 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // TODO enable diagnostics
             }
 
-            // check if the button is pressed
-            if(*pDeepsleepTimingOn)
-            {
-                // check if the current stays low
-                if(!getTransitionVariable(DISCHAR_VAR))
-                {
-                    // get the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get currentTime in sleep!\n");
-                    }
-
-                    // check if the right amount of time has passed
-                    if(((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) < currentTime.tv_sec) ||
-                        (((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) == currentTime.tv_sec) &&
-                            pButtonPressedTime->tv_nsec <= currentTime.tv_nsec))
-                    {
-                        // go to the deep sleep state
-                        setMainState(SELF_DISCHARGE);
-                    }
-                }
-                else
-                {
-                    // set the variable false
-                    *pDeepsleepTimingOn = 0;
-                }
-            }
-
-            // check for charge
-            if(getTransitionVariable(CHAR_VAR))
+            // check if the button is pressed while the current doesn't stay low
+            if(*pDeepsleepTimingOn && getTransitionVariable(DISCHAR_VAR))
             {
-                // go to the charge state
-                setMainState(CHARGE);
+                // set the variable false
+                *pDeepsleepTimingOn = 0;
             }
 
-            // check for sleep
-            if(getTransitionVariable(SLEEP_VAR) ||
-                setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_SLEEP)
-            {
-                setMainState(SLEEP);
-            }
+            // check for sleep, charge or self-discharge
+            doMainTransitions(&context);
         }
 
         break;
@@ -1987,7 +2235,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 cli_printf("CHARGE mode\n");
 
                 // set the charge state to the first state
-                setChargeState(CHARGE_START);
+                setChargeState(CHARGE_START, TRANSITION_CAUSE_CHARGE);
 
                 // set the old charge state to the last state
                 oldChargeState = CHARGE_COMPLETE;
@@ -2012,84 +2260,21 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
             // do the charge state machine
             chargeStateMachine(&oldChargeState, chargeToStorage);
 
-            // check for discharge
-            if(getTransitionVariable(DISCHAR_VAR))
-            {
-                // go to the normal state
-                setMainState(NORMAL);
-            }
-            else if(getTransitionVariable(SLEEP_VAR))
-            {
-                // go to the sleep state
-                setMainState(SLEEP);
-            }
-
-            // check for deep_sleep
-            if((!chargeToStorage) && (setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_DEEPSLEEP))
+            // check if deep sleep is asked while the cells are below the storage voltage
+            if((!chargeToStorage) && (guardDeepsleepCommand(&context) || isButtonHoldReached(&context)) &&
+                !isStorageVoltageReached())
             {
-                // get the storage voltage
-                if(data_getParameter(V_STORAGE, &tempVariable1.floatVar, NULL) == NULL)
-                {
-                    cli_printfError("main ERROR: getting storage voltage went wrong! \n");
-                    tempVariable1.floatVar = V_STORAGE_DEFAULT;
-                }
-
-                // check if the lowest cell voltage is higher or equal than the storage voltage
-                if(batManagement_getLowestCellV() >= tempVariable1.floatVar)
-                {
-                    // go to the self_discharge state
-                    setMainState(SELF_DISCHARGE);
-                }
-                else
-                {
-                    // set the charge to storage variable
-                    batManagement_SetNReadChargeToStorage(true, 1);
+                // set the charge to storage variable
+                batManagement_SetNReadChargeToStorage(true, 1);
 
-                    // set the variable to charge to the storage voltage
-                    chargeToStorage = true;
+                // set the variable to charge to the storage voltage
+                chargeToStorage = true;
 
-                    cli_printf("Charging until storage voltage\n");
-                }
+                cli_printf("Charging until storage voltage\n");
             }
-            // check if not already on and and if the button is pressed by the user
-            else if((!chargeToStorage) && (*pDeepsleepTimingOn))
-            {
-                // get the current time
-                if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get currentTime in sleep! \n");
-                }
 
-                // check if the right amount of time has passed
-                if(((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) < currentTime.tv_sec) ||
-                    (((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) == currentTime.tv_sec) &&
-                        pButtonPressedTime->tv_nsec <= currentTime.tv_nsec))
-                {
-                    // get the storage voltage
-                    if(data_getParameter(V_STORAGE, &tempVariable1.floatVar, NULL) == NULL)
-                    {
-                        cli_printfError("main ERROR: getting storage voltage went wrong! \n");
-                        tempVariable1.floatVar = V_STORAGE_DEFAULT;
-                    }
-
-                    // check if the lowest cell voltage is higher or equal than the storage voltage
-                    if(batManagement_getLowestCellV() >= tempVariable1.floatVar)
-                    {
-                        // go to the self_discharge state
-                        setMainState(SELF_DISCHARGE);
-                    }
-                    else
-                    {
-                        // set the charge to storage variable
-                        batManagement_SetNReadChargeToStorage(true, 1);
-
-                        // set the variable to charge to the storage voltage
-                        chargeToStorage = true;
-
-                        cli_printf("Charging until storage voltage\n");
-                    }
-                }
-            }
+            // check for self-discharge, discharge or sleep
+            doMainTransitions(&context);
 
             // save the new main state
             mainState = getMainState();
@@ -2124,11 +2309,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 if((mcuPowerMode == STANDBY_MODE) || (mcuPowerMode == VLPR_MODE) ||
                     (mcuPowerMode == ERROR_VALUE))
                 {
-                    // kick the watchdog before the task yield
-                    if(sbc_kickTheWatchdog())
-                    {
-                        cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-                    }
+                    // check in with the supervisor before the task yield
+                    supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
 
                     // reset the intvalue
                     tempVariable1.uint16Var = 0;
@@ -2177,10 +2359,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 if(*pOldState != OCV)
                 {
                     // get the time that it first entered the sleep state
-                    if(clock_gettime(CLOCK_REALTIME, &sampleTime2) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get sleep sampleTime! \n");
-                    }
+                    sampleUs2 = timeBase_getUs();
                 }
 
                 // cli_printf("time: %ds\n", tempVariable1.int32Var);
@@ -2189,10 +2368,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 *pOldState = mainState;
 
                 // get the time for the sleep timeout time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get sampleTime! \n");
-                }
+                sampleUs = timeBase_getUs();
 
                 // turn on the gate
                 if(batManagement_setGatePower(GATE_CLOSE) != 0)
@@ -2326,94 +2502,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 }
             }
 
-            // get the OCV cyclic timer time
-            if(getOcvPeriodTime(&tempVariable1.int32Var, *pOldState))
-            {
-                cli_printfError("main ERROR: failed to get OCV time!\n");
-            }
-
-            // get the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get currentTime in sleep! \n");
-            }
-
-            // check for the OCV state transition
-            if((currentTime.tv_sec - sampleTime.tv_sec) > tempVariable1.int32Var)
-            {
-                // go to the OCV state
-                setMainState(OCV);
-            }
-
-            // get the sleep timeout variable
-            if(data_getParameter(T_SLEEP_TIMEOUT, &tempVariable1.uint8Var, NULL) == NULL)
-            {
-                cli_printfError("main ERROR: getting sleep timeout went wrong!\n");
-                tempVariable1.uint8Var = T_SLEEP_TIMEOUT_DEFAULT;
-            }
-
-            // check if the sleep timeout shouldn't be skipped
-            if(tempVariable1.uint8Var != 0)
-            {
-                // check if the timtout time has passed
-                if((sampleTime2.tv_sec + (tempVariable1.uint8Var * 60 * 60)) < currentTime.tv_sec)
-                {
-                    // output to the user
-                    cli_printf("sleep timeout happend after %d hours, going to deepsleep %ds\n",
-                        tempVariable1.uint8Var, currentTime.tv_sec);
-
-                    // go to the self discharge state
-                    setMainState(SELF_DISCHARGE);
-                }
-            }
-
-            // check if the NFC is active
-            if(gpio_readPin(NFC_ED) == NFC_ED_PIN_ACTIVE)
-            {
-                // print to the user
-                cli_printf("NFC activity detected!\n");
-
-                // wake up to update the measurements
-                setMainState(INIT);
-            }
-
-            // check for current
-            if(!getTransitionVariable(SLEEP_VAR))
-            {
-                // go to the init state
-                setMainState(INIT);
-            }
-
-            // check if the go to deep sleep command has been given
-            if(setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_DEEPSLEEP)
-            {
-                // go to the deep sleep state
-                setMainState(SELF_DISCHARGE);
-            }
-            else if(setNGetStateCommandVariable(false, CMD_ERROR) == CMD_WAKE)
-            {
-                // go to the init state
-                setMainState(INIT);
-            }
-
-            // check if the user is pressing the button
-            if(*pDeepsleepTimingOn)
-            {
-                // get the current time
-                if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get currentTime in sleep! \n");
-                }
-
-                // check if the right amount of time has passed
-                if(((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) < currentTime.tv_sec) ||
-                    (((pButtonPressedTime->tv_sec + BUTTON_TIME_FOR_DEEP_SLEEP) == currentTime.tv_sec) &&
-                        pButtonPressedTime->tv_nsec <= currentTime.tv_nsec))
-                {
-                    // go to the deep sleep state
-                    setMainState(SELF_DISCHARGE);
-                }
-            }
+            // check for a wake-up, self-discharge or an OCV measurement
+            doMainTransitions(&context);
         }
 
         break;
@@ -2467,8 +2557,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 break;
             }
 
-            // go to the sleep state
-            setMainState(SLEEP);
+            // go back to the sleep state
+            doMainTransitions(&context);
         }
 
         break;
@@ -2498,7 +2588,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                     if(BMSFault & BMS_PEAK_OVER_CURRENT)
                     {
                         // go to fault state to disconnect switch
-                        setMainState(FAULT_OFF);
+                        setMainState(FAULT_OFF, TRANSITION_CAUSE_FAULT);
 
                         // increase the main loop semaphore to not wait
                         if(escapeMainLoopWait())
@@ -2532,7 +2622,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 {
                     // if not in flight, disconnect switch
                     // go to fault state to disconnect switch
-                    setMainState(FAULT_OFF);
+                    setMainState(FAULT_OFF, TRANSITION_CAUSE_NOT_IN_FLIGHT);
 
                     // increase the main loop semaphore to not wait
                     if(escapeMainLoopWait())
@@ -2564,11 +2654,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // check if there was a cell undervoltage
                 if(*pCellUnderVoltageDetected)
                 {
-                    // get the cellUnderVoltageTime
-                    if(clock_gettime(CLOCK_REALTIME, &cellUnderVoltageTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get cellUnderVoltageTime in FAULT_ON!\n");
-                    }
+                    // get the time of the cell undervoltage
+                    cellUnderVoltageUs = timeBase_getUs();
                 }
 
             } // if mainState != *pOldState
@@ -2580,7 +2667,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 gSInFlightChangedFalse = false;
 
                 // go to fault state to disconnect switch
-                setMainState(FAULT_OFF);
+                setMainState(FAULT_OFF, TRANSITION_CAUSE_NOT_IN_FLIGHT);
 
                 // increase the main loop semaphore to not wait
                 if(escapeMainLoopWait())
@@ -2601,11 +2688,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // check if there is an undervoltage
                 if(BMSFault & BMS_CELL_UV)
                 {
-                    // get the cellUnderVoltageTime
-                    if(clock_gettime(CLOCK_REALTIME, &cellUnderVoltageTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get cellUnderVoltageTime in fault!\n");
-                    }
+                    // get the time of the cell undervoltage
+                    cellUnderVoltageUs = timeBase_getUs();
 
                     // set the undervoltage variable true
                     *pCellUnderVoltageDetected = true;
@@ -2639,19 +2723,11 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                         outputMessageOnlyOnce = false;
                     }
 
-                    // get the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get currentTime in fault!\n");
-                    }
-
                     // check if the right amount of time has passed
-                    if(((cellUnderVoltageTime.tv_sec + tempVariable1.uint16Var) < currentTime.tv_sec) ||
-                        (((cellUnderVoltageTime.tv_sec + tempVariable1.uint16Var) == currentTime.tv_sec) &&
-                            cellUnderVoltageTime.tv_nsec <= currentTime.tv_nsec))
+                    if(timeBase_isReached(cellUnderVoltageUs + (tempVariable1.uint16Var * TIME_BASE_US_PER_S)))
                     {
                         // go to the DEEP_SLEEP state
-                        setMainState(DEEP_SLEEP);
+                        setMainState(DEEP_SLEEP, TRANSITION_CAUSE_UNDERVOLTAGE);
                     }
                 }
                 else
@@ -2684,7 +2760,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                     cli_printfError("main ERROR: Failed to open gate\n");
 
                     // go to the correct state
-                    setMainState(FAULT_ON);
+                    setMainState(FAULT_ON, TRANSITION_CAUSE_ERROR);
 
                     // set the LED to red
                     ledState_setLedColor(RED, OFF, LED_BLINK_OFF);
@@ -2715,11 +2791,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // check if there was a cell undervoltage
                 if(*pCellUnderVoltageDetected)
                 {
-                    // get the cellUnderVoltageTime
-                    if(clock_gettime(CLOCK_REALTIME, &cellUnderVoltageTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get cellUnderVoltageTime in FAULT_OFF!\n");
-                    }
+                    // get the time of the cell undervoltage
+                    cellUnderVoltageUs = timeBase_getUs();
                 }
 
             } // if mainState != *pOldState
@@ -2734,11 +2807,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // check if there is an undervoltage
                 if(BMSFault & BMS_CELL_UV)
                 {
-                    // get the cellUnderVoltageTime
-                    if(clock_gettime(CLOCK_REALTIME, &cellUnderVoltageTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get cellUnderVoltageTime in fault!\n");
-                    }
+                    // get the time of the cell undervoltage
+                    cellUnderVoltageUs = timeBase_getUs();
 
                     // set the undervoltage variable true
                     *pCellUnderVoltageDetected = true;
@@ -2772,19 +2842,11 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                         outputMessageOnlyOnce = false;
                     }
 
-                    // get the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("main ERROR: failed to get currentTime in fault!\n");
-                    }
-
                     // check if the right amount of time has passed
-                    if(((cellUnderVoltageTime.tv_sec + tempVariable1.uint16Var) < currentTime.tv_sec) ||
-                        (((cellUnderVoltageTime.tv_sec + tempVariable1.uint16Var) == currentTime.tv_sec) &&
-                            cellUnderVoltageTime.tv_nsec <= currentTime.tv_nsec))
+                    if(timeBase_isReached(cellUnderVoltageUs + (tempVariable1.uint16Var * TIME_BASE_US_PER_S)))
                     {
                         // go to the DEEP_SLEEP state
-                        setMainState(DEEP_SLEEP);
+                        setMainState(DEEP_SLEEP, TRANSITION_CAUSE_UNDERVOLTAGE);
                     }
                 }
                 else
@@ -2827,16 +2889,13 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 if(!tempVariable1.uint8Var)
                 {
                     // go to the DEEP_SLEEP state
-                    setMainState(DEEP_SLEEP);
+                    setMainState(DEEP_SLEEP, TRANSITION_CAUSE_DONE);
 
                     break;
                 }
 
                 // get the self discharge start time
-                if(clock_gettime(CLOCK_REALTIME, pSelfDischargeTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get selfDischargeTime! \n");
-                }
+                *pSelfDischargeUs = timeBase_getUs();
 
                 // turn off the gate
                 if(batManagement_setGatePower(GATE_OPEN) != 0)
@@ -2856,7 +2915,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 // wait until the balancing is done
                 while(batManagement_getBalanceState() != BALANCE_OFF)
                 {
-                    // kick the watchdog and sleep for 100us
+                    // check in with the supervisor and sleep for 100us
                     usleepMainLoopWatchdog(100);
                 }
 
@@ -2873,14 +2932,8 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
                 }
             }
 
-            // get the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get currentTime!\n");
-            }
-
             // check if the right amount of time has passed (precision is not needed)
-            if((pSelfDischargeTime->tv_sec + bmsTimeoutTime) < currentTime.tv_sec)
+            if(timeBase_isReached(*pSelfDischargeUs + (bmsTimeoutTime * TIME_BASE_US_PER_S)))
             {
                 // calibrate the state of charge
                 if(batManagement_calibrateStateOfCharge(true))
@@ -2904,21 +2957,21 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
             if(!tempVariable1.uint8Var)
             {
                 // go to the deepsleep state
-                setMainState(DEEP_SLEEP);
+                setMainState(DEEP_SLEEP, TRANSITION_CAUSE_DONE);
             }
 
             // check if cell balancing is done
             if(batManagement_getBalanceState() == BALANCE_OFF)
             {
                 // go to the deepsleep state
-                setMainState(DEEP_SLEEP);
+                setMainState(DEEP_SLEEP, TRANSITION_CAUSE_DONE);
             }
 
             // check if the go to sleep command has been given
             if(setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_SLEEP)
             {
                 // go to the sleep state
-                setMainState(SLEEP);
+                setMainState(SLEEP, TRANSITION_CAUSE_COMMAND);
             }
         }
         break;
@@ -2967,17 +3020,14 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
 
             // wait for 1s
 
-            // kick the watchdog and sleep for 500ms (in case 1s watchdog)
+            // check in with the supervisor and sleep for 500ms
             usleepMainLoopWatchdog(500 * 1000);
 
-            // kick the watchdog and sleep for 500ms
+            // check in with the supervisor and sleep for 500ms
             usleepMainLoopWatchdog(500 * 1000);
 
-            // kick the watchdog again
-            if(sbc_kickTheWatchdog())
-            {
-                cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-            }
+            // check in with the supervisor again
+            supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
 
             // BCC sleep
             // set the AFE mode to normal
@@ -3000,7 +3050,7 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
             retValue = sbc_setSbcMode(SBC_SLEEP);
 
             // go to the init state if possible (if you come here the sleep didn't work)
-            setMainState(INIT);
+            setMainState(INIT, TRANSITION_CAUSE_ERROR);
         }
         break;
 
@@ -3013,14 +3063,14 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
             cli_printf("setting init mode\n");
 
             // set the init mode
-            setMainState(INIT);
+            setMainState(INIT, TRANSITION_CAUSE_ERROR);
         }
         break;
         case NUMBER_OF_MAIN_STATES: // do nothing, for compiler
         {
             cli_printfError("main ERROR: Main loop is in NUMBER_OF_MAIN_STATES state\n");
             // set the init mode
-            setMainState(INIT);
+            setMainState(INIT, TRANSITION_CAUSE_ERROR);
         }
         break;
     }
@@ -3037,10 +3087,10 @@ static void mainStateMachine(struct timespec *pSelfDischargeTime, struct timespe
  */
 static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToStorage)
 {
-    static struct timespec sampleTime             = { 0 };
+    static uint64_t        sampleUs               = 0;
     static uint8_t         amountOfCBChargeCycles = 0;
     static bool            onlyOnce               = false;
-    struct timespec        currentTime;
+    uint64_t               currentUs;
     bool                   outputCBStatus = false;
     variableTypes_u        tempVariable1, tempVariable2, tempVariable3;
     charge_states_t        chargeState = getChargeState();
@@ -3068,12 +3118,10 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                 // start the charging timer
                 // check the time the charging begins
                 // save the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get sampleTime!\n");
-                }
+                sampleUs = timeBase_getUs();
 
-                cli_printf("Charge start %ds %dms\n", sampleTime.tv_sec, sampleTime.tv_nsec / 1000000);
+                cli_printf("Charge start %ds %dms\n", (int)(sampleUs / TIME_BASE_US_PER_S),
+                    (int)((sampleUs / TIME_BASE_US_PER_MS) % 1000));
             }
             break;
 
@@ -3096,12 +3144,10 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                 batManagement_SetNReadEndOfCBCharge(true, 0);
 
                 // save the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get sampleTime! \n");
-                }
+                sampleUs = timeBase_getUs();
 
-                cli_printf("Charge with CB %ds %dms\n", sampleTime.tv_sec, sampleTime.tv_nsec / 1000000);
+                cli_printf("Charge with CB %ds %dms\n", (int)(sampleUs / TIME_BASE_US_PER_S),
+                    (int)((sampleUs / TIME_BASE_US_PER_MS) % 1000));
 
                 // increase the counter
                 amountOfCBChargeCycles++;
@@ -3141,15 +3187,13 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
 
                 // start the relax time
                 // save the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get sampleTime! \n");
-                }
+                sampleUs = timeBase_getUs();
 
                 // make sure it doens't keep checking
                 batManagement_SetNReadEndOfCBCharge(true, 3);
 
-                cli_printf("Charge RELAXATION %ds %dms\n", sampleTime.tv_sec, sampleTime.tv_nsec / 1000000);
+                cli_printf("Charge RELAXATION %ds %dms\n", (int)(sampleUs / TIME_BASE_US_PER_S),
+                    (int)((sampleUs / TIME_BASE_US_PER_MS) % 1000));
 
                 // make sure it will only output CB done once
                 outputCBStatus = true;
@@ -3230,10 +3274,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
             case CHARGE_COMPLETE:
             {
                 // save the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("main ERROR: failed to get sampleTime! \n");
-                }
+                sampleUs = timeBase_getUs();
 
                 // set the LED to green
                 ledState_setLedColor(GREEN, OFF, LED_BLINK_OFF);
@@ -3244,7 +3285,8 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                 // make sure it doens't keep checking
                 batManagement_SetNReadEndOfCBCharge(true, 3);
 
-                cli_printf("Charge complete %ds %dms\n", sampleTime.tv_sec, sampleTime.tv_nsec / 1000000);
+                cli_printf("Charge complete %ds %dms\n", (int)(sampleUs / TIME_BASE_US_PER_S),
+                    (int)((sampleUs / TIME_BASE_US_PER_MS) % 1000));
 
                 // check if charging to storage is not on
                 // Only save the full-charge capacity and increment
@@ -3307,7 +3349,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                 batManagement_SetNReadEndOfCBCharge(true, 3);
 
                 // set the next charge state
-                setChargeState(CHARGE_CB);
+                setChargeState(CHARGE_CB, TRANSITION_CAUSE_END_OF_CHARGE);
             }
 
             // get the CB begin time
@@ -3318,21 +3360,12 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
             }
 
             // start the charging timer
-            // check the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get currentTime! \n");
-            }
-
             // check if the charge time ended and the charge is begon
-            if((((sampleTime.tv_sec + tempVariable1.uint8Var) == currentTime.tv_sec) &&
-                   (sampleTime.tv_nsec <= currentTime.tv_nsec)) ||
-                ((sampleTime.tv_sec + tempVariable1.uint8Var) < currentTime.tv_sec))
+            if(timeBase_isReached(sampleUs + (tempVariable1.uint8Var * TIME_BASE_US_PER_S)))
             {
-                // cli_printf("ended charge start %ds %dms\n", currentTime.tv_sec,
-                // currentTime.tv_nsec/1000000);
+                // cli_printf("ended charge start %ds\n", (int)(timeBase_getUs() / TIME_BASE_US_PER_S));
                 // set the next charge state
-                setChargeState(CHARGE_CB);
+                setChargeState(CHARGE_CB, TRANSITION_CAUSE_TIMEOUT);
             }
         }
         break;
@@ -3357,7 +3390,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                 batManagement_SetNReadEndOfCBCharge(true, 3);
 
                 // go to the relaxation state
-                setChargeState(RELAXATION);
+                setChargeState(RELAXATION, TRANSITION_CAUSE_END_OF_CHARGE);
             }
 
             // check if cell balancing is done to change the led color
@@ -3418,15 +3451,10 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
             }
 
             // check the current time
-            if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-            {
-                cli_printfError("main ERROR: failed to get currentTime! \n");
-            }
+            currentUs = timeBase_getUs();
 
             // check if the charge time ended and the charge is begon
-            if((((sampleTime.tv_sec + tempVariable1.uint16Var) == currentTime.tv_sec) &&
-                   (sampleTime.tv_nsec <= currentTime.tv_nsec)) ||
-                ((sampleTime.tv_sec + tempVariable1.uint16Var) < currentTime.tv_sec))
+            if((currentUs - sampleUs) >= (tempVariable1.uint16Var * TIME_BASE_US_PER_S))
             {
                 // check if CB is done
                 if(batManagement_getBalanceState() == BALANCE_OFF)
@@ -3435,8 +3463,8 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                     if(onlyOnce)
                     {
                         onlyOnce = false;
-                        cli_printf(
-                            "Ended relaxing! %ds %dms\n", currentTime.tv_sec, currentTime.tv_nsec / 1000000);
+                        cli_printf("Ended relaxing! %ds %dms\n", (int)(currentUs / TIME_BASE_US_PER_S),
+                            (int)((currentUs / TIME_BASE_US_PER_MS) % 1000));
                     }
 
                     // get the cell margin in mv
@@ -3477,11 +3505,8 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                             batManagement_getHighestCellV(),
                             (tempVariable2.floatVar - ((float)(tempVariable1.uint8Var) / 1000)));
 
-                        // kick the watchdog before the task yield
-                        if(sbc_kickTheWatchdog())
-                        {
-                            cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-                        }
+                        // check in with the supervisor before the task yield
+                        supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
 
                         // turn off the measurements to be able to do a switch
                         batManagement_enableBatManagementTask(false);
@@ -3515,7 +3540,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                         enableUpdatesAndBatManagementTask(true, true);
 
                         // go back to charge with CB
-                        setChargeState(CHARGE_CB);
+                        setChargeState(CHARGE_CB, TRANSITION_CAUSE_RECHARGE);
                     }
                     else
                     {
@@ -3528,11 +3553,8 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                                 amountOfCBChargeCycles, batManagement_getHighestCellV());
                         }
 
-                        // kick the watchdog before the task yield
-                        if(sbc_kickTheWatchdog())
-                        {
-                            cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-                        }
+                        // check in with the supervisor before the task yield
+                        supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
 
                         // turn off the measurements to be able to do a switch
                         batManagement_enableBatManagementTask(false);
@@ -3566,7 +3588,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                         enableUpdatesAndBatManagementTask(true, true);
 
                         // go to charging complete
-                        setChargeState(CHARGE_COMPLETE);
+                        setChargeState(CHARGE_COMPLETE, TRANSITION_CAUSE_DONE);
                     }
                 }
                 // if cell balancing is not done
@@ -3632,7 +3654,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
                         batManagement_getLowestCellV(), tempVariable1.uint16Var);
 
                     // set the charge state to the charge with CB state
-                    setChargeState(CHARGE_CB);
+                    setChargeState(CHARGE_CB, TRANSITION_CAUSE_RECHARGE);
 
                     // reset the variable for the CB charge cycles
                     amountOfCBChargeCycles = 0;
@@ -3642,7 +3664,7 @@ static void chargeStateMachine(charge_states_t *pOldChargeState, bool chargeToSt
             else
             {
                 // go to the self discharge state
-                setMainState(SELF_DISCHARGE);
+                setMainState(SELF_DISCHARGE, TRANSITION_CAUSE_STORAGE);
             }
         }
         break;
@@ -3666,9 +3688,8 @@ int checkForTransitionCurrent(float *currentA)
 {
     static bool            timeOutTimeStarted = false;
     static bool            chargeTimeStarted  = false;
-    static struct timespec savedTime          = { .tv_sec = 0, .tv_nsec = 0 };
+    static uint64_t        savedUs            = 0;
     int                    retValue           = 0;
-    struct timespec        currentTime;
     variableTypes_u        variable1;
 
     // lock the mutex
@@ -3740,11 +3761,8 @@ int checkForTransitionCurrent(float *currentA)
                 // check if the charge time has started
                 if(!chargeTimeStarted)
                 {
-                    // save the time in the savedTime variable
-                    if(clock_gettime(CLOCK_REALTIME, &savedTime) == -1)
-                    {
-                        cli_printfError("checkForTransitionCurrent ERROR: failed to get chargeBeginTime! \n");
-                    }
+                    // save the time in the savedUs variable
+                    savedUs = timeBase_getUs();
 
                     // set the variable
                     chargeTimeStarted = true;
@@ -3765,16 +3783,7 @@ int checkForTransitionCurrent(float *currentA)
                     }
 
                     // check if the time passed
-                    // check the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("checkForTransitionCurrent ERROR: failed to get current time! \n");
-                    }
-
-                    // check if the time passed
-                    if(((savedTime.tv_sec + variable1.uint8Var) < currentTime.tv_sec) ||
-                        (((savedTime.tv_sec + variable1.uint8Var) == currentTime.tv_sec) &&
-                            savedTime.tv_nsec <= currentTime.tv_nsec))
+                    if(timeBase_isReached(savedUs + (variable1.uint8Var * TIME_BASE_US_PER_S)))
                     {
                         // set the variable
                         gChargeDetected = true;
@@ -3806,11 +3815,7 @@ int checkForTransitionCurrent(float *currentA)
                 if(!timeOutTimeStarted)
                 {
                     // save the time
-                    if(clock_gettime(CLOCK_REALTIME, &savedTime) == -1)
-                    {
-                        cli_printfError(
-                            "checkForTransitionCurrent ERROR: failed to get timeoutBeginTime! \n");
-                    }
+                    savedUs = timeBase_getUs();
 
                     // set the variable
                     timeOutTimeStarted = true;
@@ -3831,17 +3836,7 @@ int checkForTransitionCurrent(float *currentA)
                     }
 
                     // check if the time passed
-                    // check the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError(
-                            "checkForTransitionCurrent ERROR: failed to get timeoutBeginTime! \n");
-                    }
-
-                    // check if the time passed
-                    if(((savedTime.tv_sec + variable1.uint16Var) < currentTime.tv_sec) ||
-                        (((savedTime.tv_sec + variable1.uint16Var) == currentTime.tv_sec) &&
-                            savedTime.tv_nsec <= currentTime.tv_nsec))
+                    if(timeBase_isReached(savedUs + (variable1.uint16Var * TIME_BASE_US_PER_S)))
                     {
                         // set the variable
                         gSleepDetected = true;
@@ -3922,6 +3917,9 @@ int handleParamaterChange(parameterKind_t parameter, void *value, void *extraVal
 {
     int retValue = 0;
 
+    // let the SMBus know if it needs to update the static information
+    SMBus_changedParameter(parameter);
+
     // check which parameter it is
     switch(parameter)
     {
@@ -4145,13 +4143,14 @@ void gpioIsrFunction(int signo, siginfo_t *siginfo, void *context)
  * @brief function that will be called when it needs to process a cli command when the CLI can't do this
  *
  * @param command the command that needs to be processed
+ * @param argument the argument of the command, NULL if there is none
  */
-int processCLICommand(commands_t command)
+int processCLICommand(commands_t command, const char *argument)
 {
     int             returnValue;
     states_t        currentState = getMainState();
-    struct timespec currentTime;
-    struct timespec sampleTime;
+    uint64_t        currentUs;
+    uint64_t        sampleUs;
     int             ret = 0;
 
     mcuPowerModes_t mcuPowerMode;
@@ -4271,13 +4270,10 @@ int processCLICommand(commands_t command)
                 cli_printf("Waking up the BMS... \n");
 
                 // sample the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("processCLICommand ERROR: failed to get sampleTime!\n");
-                }
+                sampleUs = timeBase_getUs();
 
                 // set the current time to the sample time
-                currentTime.tv_sec = sampleTime.tv_sec;
+                currentUs = sampleUs;
 
                 // wake up the BMS
                 setNGetStateCommandVariable(true, CMD_WAKE);
@@ -4294,16 +4290,13 @@ int processCLICommand(commands_t command)
                 // or have a 2-3 second timeout
                 while(((mcuPowerMode == STANDBY_MODE) || (mcuPowerMode == VLPR_MODE) ||
                           (mcuPowerMode == ERROR_VALUE)) &&
-                    ((sampleTime.tv_sec + 3) > currentTime.tv_sec))
+                    ((sampleUs + (3 * TIME_BASE_US_PER_S)) > currentUs))
                 {
                     // sleep so other processes can continue
                     usleep(1000);
 
                     // get the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("processCLICommand ERROR: failed to get currentTime!\n");
-                    }
+                    currentUs = timeBase_getUs();
 
                     // check the MCU power mode and check for errors
                     mcuPowerMode = power_setNGetMcuPowerMode(false, ERROR_VALUE);
@@ -4315,7 +4308,7 @@ int processCLICommand(commands_t command)
                 }
 
                 // check if the timeout happend
-                if(((sampleTime.tv_sec + 3) < currentTime.tv_sec))
+                if((sampleUs + (3 * TIME_BASE_US_PER_S)) <= currentUs)
                 {
                     cli_printfError("processCLICommand ERROR: timeout happend on saving parameters!\n");
                     cli_printfError("Waking up the BMS failed!\n");
@@ -4364,6 +4357,9 @@ int processCLICommand(commands_t command)
             // save them
             returnValue = data_loadParameters();
 
+            // all the parameters could have changed
+            SMBus_changedParameter(NONE);
+
             // check for error
             if(returnValue)
             {
@@ -4405,13 +4401,10 @@ int processCLICommand(commands_t command)
                 cli_printf("Waking up the BMS... \n");
 
                 // sample the time
-                if(clock_gettime(CLOCK_REALTIME, &sampleTime) == -1)
-                {
-                    cli_printfError("processCLICommand ERROR: failed to get sampleTime!\n");
-                }
+                sampleUs = timeBase_getUs();
 
                 // set the current time to the sample time
-                currentTime.tv_sec = sampleTime.tv_sec;
+                currentUs = sampleUs;
 
                 // wake up the BMS
                 setNGetStateCommandVariable(true, CMD_WAKE);
@@ -4428,16 +4421,13 @@ int processCLICommand(commands_t command)
                 // or have a 2-3 second timeout
                 while(((mcuPowerMode == STANDBY_MODE) || (mcuPowerMode == VLPR_MODE) ||
                           (mcuPowerMode == ERROR_VALUE)) &&
-                    ((sampleTime.tv_sec + 3) > currentTime.tv_sec))
+                    ((sampleUs + (3 * TIME_BASE_US_PER_S)) > currentUs))
                 {
                     // sleep so other processes can continue
                     usleep(1000);
 
                     // get the current time
-                    if(clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        cli_printfError("processCLICommand ERROR: failed to get currentTime!\n");
-                    }
+                    currentUs = timeBase_getUs();
 
                     // check the MCU power mode and check for errors
                     mcuPowerMode = power_setNGetMcuPowerMode(false, ERROR_VALUE);
@@ -4449,7 +4439,7 @@ int processCLICommand(commands_t command)
                 }
 
                 // check if the timeout happend
-                if(((sampleTime.tv_sec + 3) < currentTime.tv_sec))
+                if((sampleUs + (3 * TIME_BASE_US_PER_S)) <= currentUs)
                 {
                     cli_printfError("processCLICommand ERROR: timeout happend on saving parameters!\n");
                     cli_printfError("Waking up the BMS failed!\n");
@@ -4488,6 +4478,77 @@ int processCLICommand(commands_t command)
                 ret = -1;
             }
             break;
+        case CLI_TRACE:
+            // output the state transitions
+            printTransitionTrace();
+            break;
+        case CLI_POWER:
+            // check if only the statistics are requested
+            if(argument == NULL)
+            {
+                printWakeUpStats();
+                ret = 0;
+            }
+            // check if it needs to be reset
+            else if(!strcmp(argument, "reset"))
+            {
+                wakeSched_resetStats();
+                cli_printf("wake-up statistics reset\n");
+                ret = 0;
+            }
+            else
+            {
+                ret = -1;
+                cli_printf("wrong value! try \"bms help\"\n");
+            }
+            break;
+        case CLI_WATCHDOG:
+            // output the supervised tasks and the watchdog kicks
+            ret = supervisor_output();
+            break;
+        case CLI_MEM:
+            // check if only the use is requested
+            if(argument == NULL)
+            {
+                ret = memMon_output(false);
+            }
+            // check if the suggested sizes are requested as well
+            else if(!strcmp(argument, "report"))
+            {
+                ret = memMon_output(true);
+            }
+            else
+            {
+                ret = -1;
+                cli_printf("wrong value! try \"bms help\"\n");
+            }
+            break;
+        case CLI_TIMING:
+            // check if only the statistics are requested
+            if(argument == NULL)
+            {
+                ret = batManagement_outputTiming();
+            }
+            // check if it needs to be reset
+            else if(!strcmp(argument, "reset"))
+            {
+                batManagement_resetTiming();
+                cli_printf("timing statistics reset\n");
+                ret = 0;
+            }
+            // otherwise it is the jitter alarm threshold in us
+            else if(isdigit((unsigned char)argument[0]))
+            {
+                batManagement_setJitterAlarm((uint32_t)strtoul(argument, NULL, 10));
+                cli_printf("jitter alarm set to %uus\n", (uint32_t)strtoul(argument, NULL, 10));
+                ret = 0;
+            }
+            else
+            {
+                ret = -1;
+                cli_printf("wrong value! try \"bms help\"\n");
+            }
+            break;
         default:
             // error
             ret = -1;
@@ -4522,19 +4583,29 @@ states_t getMainState(void)
 
 /*!
  * @brief function that will set the main state, but it will use the mutex
+ *        a transition is saved in the transition trace
  *
  * @param newState the new state
+ * @param cause the cause of the transition
  */
-static int setMainState(states_t newState)
+static int setMainState(states_t newState, transitionCause_t cause)
 {
-    int retValue = 0;
+    int      retValue = 0;
+    states_t oldState;
 
     // lock the mutex
     pthread_mutex_lock(&gStateLock);
 
     // set the state
+    oldState      = gCurrentState;
     gCurrentState = newState;
 
+    // trace it if it is a transition, with the lock so the trace has the order of the transitions
+    if(oldState != newState)
+    {
+        traceTransition(false, (uint8_t)oldState, (uint8_t)newState, cause);
+    }
+
     // unlock the mutex
     pthread_mutex_unlock(&gStateLock);
 
@@ -4565,25 +4636,384 @@ charge_states_t getChargeState(void)
 
 /*!
  * @brief function that will set the charge state, but it will use the mutex
+ *        a transition is saved in the transition trace
  *
  * @param newState the new state
+ * @param cause the cause of the transition
  */
-static int setChargeState(charge_states_t newState)
+static int setChargeState(charge_states_t newState, transitionCause_t cause)
 {
-    int retValue = 0;
+    int             retValue = 0;
+    charge_states_t oldState;
 
     // lock the mutex
     pthread_mutex_lock(&gChargeStateLock);
 
     // set the state
+    oldState            = gCurrentChargeState;
     gCurrentChargeState = newState;
 
+    // trace it if it is a transition, with the lock so the trace has the order of the transitions
+    if(oldState != newState)
+    {
+        traceTransition(true, (uint8_t)oldState, (uint8_t)newState, cause);
+    }
+
     // unlock the mutex
     pthread_mutex_unlock(&gChargeStateLock);
 
     return retValue;
 }
 
+/*!
+ * @brief   function that will save a transition in the transition trace ring
+ *          if the transition is not in the transition table, the cause will have TRANSITION_TRACE_UNLISTED
+ * @note    the lock of the state (gStateLock or gChargeStateLock) should be taken
+ *
+ * @param   chargeMachine true if it is a transition of the charge state machine
+ * @param   from the old state
+ * @param   to the new state
+ * @param   cause the cause of the transition
+ */
+static void traceTransition(bool chargeMachine, uint8_t from, uint8_t to, transitionCause_t cause)
+{
+    const stateTransition_t *pTable = chargeMachine ? gChargeTransitions : gMainTransitions;
+    size_t                   tableSize =
+        chargeMachine ? (sizeof(gChargeTransitions) / sizeof(gChargeTransitions[0])) :
+                                          (sizeof(gMainTransitions) / sizeof(gMainTransitions[0]));
+    transitionRecord_t *pRecord;
+    uint64_t            currentUs;
+    bool                listed = false;
+    size_t              i;
+
+    // check if it is in the transition table
+    for(i = 0; (i < tableSize) && !listed; i++)
+    {
+        listed = ((pTable[i].from == from) || (pTable[i].from == TRANSITION_FROM_ANY)) &&
+            (pTable[i].to == to) && (pTable[i].cause == cause);
+    }
+
+    // get the time
+    currentUs = timeBase_getUs();
+
+    // lock the mutex
+    pthread_mutex_lock(&gTransitionTraceLock);
+
+    // save it in the next record
+    pRecord                = &gTransitionTrace[gTransitionTraceCount % TRANSITION_TRACE_RECORDS];
+    pRecord->timeMs        = (uint32_t)(currentUs / TIME_BASE_US_PER_MS);
+    pRecord->chargeMachine = chargeMachine;
+    pRecord->from          = from;
+    pRecord->to            = to;
+    pRecord->cause         = (uint8_t)cause | (listed ? 0 : TRANSITION_TRACE_UNLISTED);
+
+    gTransitionTraceCount++;
+
+    // unlock the mutex
+    pthread_mutex_unlock(&gTransitionTraceLock);
+}
+
+/*!
+ * @brief   function that will take the first transition of the main state of which the guard is true,
+ *          it does the action of the transition and sets the new state
+ *
+ * @param   pContext the variables of the main state machine for the guards and actions
+ *
+ * @return  true if a transition is taken
+ */
+static bool doMainTransitions(const transitionContext_t *pContext)
+{
+    // a transition the state did itself is kept
+    states_t mainState = getMainState();
+    size_t   i;
+
+    // check each transition of the state
+    for(i = 0; i < (sizeof(gMainTransitions) / sizeof(gMainTransitions[0])); i++)
+    {
+        // check if it is a transition of this state with a guard that is true
+        if((gMainTransitions[i].from != mainState) || (gMainTransitions[i].guard == NULL) ||
+            !gMainTransitions[i].guard(pContext))
+        {
+            continue;
+        }
+
+        // do the action
+        if(gMainTransitions[i].action != NULL)
+        {
+            gMainTransitions[i].action(pContext);
+        }
+
+        // set the new state
+        setMainState((states_t)gMainTransitions[i].to, gMainTransitions[i].cause);
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * @brief   function to check if the button is held for BUTTON_TIME_FOR_DEEP_SLEEP
+ *
+ * @param   pContext the variables of the main state machine
+ *
+ * @return  true if it is held long enough
+ */
+static bool isButtonHoldReached(const transitionContext_t *pContext)
+{
+    return *pContext->pDeepsleepTimingOn &&
+        timeBase_isReached(*pContext->pButtonPressedUs + (BUTTON_TIME_FOR_DEEP_SLEEP * TIME_BASE_US_PER_S));
+}
+
+/*!
+ * @brief   function to check if the lowest cell voltage is at or above the storage voltage
+ *
+ * @return  true if it is
+ */
+static bool isStorageVoltageReached(void)
+{
+    float storageVoltage;
+
+    // get the storage voltage
+    if(data_getParameter(V_STORAGE, &storageVoltage, NULL) == NULL)
+    {
+        cli_printfError("main ERROR: getting storage voltage went wrong! \n");
+        storageVoltage = V_STORAGE_DEFAULT;
+    }
+
+    return batManagement_getLowestCellV() >= storageVoltage;
+}
+
+/*!
+ * @brief   guard for a charge current
+ */
+static bool guardCharge(const transitionContext_t *pContext)
+{
+    return getTransitionVariable(CHAR_VAR);
+}
+
+/*!
+ * @brief   guard for no charge current
+ */
+static bool guardNoCharge(const transitionContext_t *pContext)
+{
+    return !getTransitionVariable(CHAR_VAR);
+}
+
+/*!
+ * @brief   guard for a discharge current
+ */
+static bool guardDischarge(const transitionContext_t *pContext)
+{
+    return getTransitionVariable(DISCHAR_VAR);
+}
+
+/*!
+ * @brief   guard for a current below the sleep current
+ */
+static bool guardSleepCurrent(const transitionContext_t *pContext)
+{
+    return getTransitionVariable(SLEEP_VAR);
+}
+
+/*!
+ * @brief   guard for a current above the sleep current
+ */
+static bool guardNoSleepCurrent(const transitionContext_t *pContext)
+{
+    return !getTransitionVariable(SLEEP_VAR);
+}
+
+/*!
+ * @brief   guard for the sleep command
+ */
+static bool guardSleepCommand(const transitionContext_t *pContext)
+{
+    return setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_SLEEP;
+}
+
+/*!
+ * @brief   guard for the deepsleep command
+ */
+static bool guardDeepsleepCommand(const transitionContext_t *pContext)
+{
+    return setNGetStateCommandVariable(false, CMD_ERROR) == CMD_GO_2_DEEPSLEEP;
+}
+
+/*!
+ * @brief   guard for the wake command
+ */
+static bool guardWakeCommand(const transitionContext_t *pContext)
+{
+    return setNGetStateCommandVariable(false, CMD_ERROR) == CMD_WAKE;
+}
+
+/*!
+ * @brief   guard for the button that is held for BUTTON_TIME_FOR_DEEP_SLEEP
+ */
+static bool guardButtonHold(const transitionContext_t *pContext)
+{
+    return isButtonHoldReached(pContext);
+}
+
+/*!
+ * @brief   guard for the deepsleep command while charging, when the cells are at the storage voltage
+ *          if they are not, the CHARGE state charges them to it first
+ */
+static bool guardStorageCommand(const transitionContext_t *pContext)
+{
+    return !(*pContext->pChargeToStorage) && guardDeepsleepCommand(pContext) && isStorageVoltageReached();
+}
+
+/*!
+ * @brief   guard for the button hold while charging, when the cells are at the storage voltage
+ *          if they are not, the CHARGE state charges them to it first
+ */
+static bool guardStorageButtonHold(const transitionContext_t *pContext)
+{
+    return !(*pContext->pChargeToStorage) && isButtonHoldReached(pContext) && isStorageVoltageReached();
+}
+
+/*!
+ * @brief   guard for NFC activity
+ */
+static bool guardNfc(const transitionContext_t *pContext)
+{
+    return gpio_readPin(NFC_ED) == NFC_ED_PIN_ACTIVE;
+}
+
+/*!
+ * @brief   guard for the sleep timeout (t-sleep-timeout hours since it entered the sleep state), 0 is off
+ */
+static bool guardSleepTimeout(const transitionContext_t *pContext)
+{
+    uint8_t sleepTimeoutHours;
+
+    // get the sleep timeout variable
+    if(data_getParameter(T_SLEEP_TIMEOUT, &sleepTimeoutHours, NULL) == NULL)
+    {
+        cli_printfError("main ERROR: getting sleep timeout went wrong!\n");
+        sleepTimeoutHours = T_SLEEP_TIMEOUT_DEFAULT;
+    }
+
+    // check if the timeout time has passed
+    return (sleepTimeoutHours != 0) &&
+        ((*pContext->pSleepStartUs + ((uint64_t)sleepTimeoutHours * 60 * 60 * TIME_BASE_US_PER_S)) <
+            timeBase_getUs());
+}
+
+/*!
+ * @brief   guard for the end of the OCV period in the sleep state
+ */
+static bool guardOcvPeriod(const transitionContext_t *pContext)
+{
+    int32_t ocvPeriodS;
+
+    // get the OCV cyclic timer time, it is calculated when the sleep state is entered
+    if(getOcvPeriodTime(&ocvPeriodS, SLEEP))
+    {
+        cli_printfError("main ERROR: failed to get OCV time!\n");
+    }
+
+    return (timeBase_getUs() - *pContext->pSleepPeriodUs) > ((uint64_t)ocvPeriodS * TIME_BASE_US_PER_S);
+}
+
+/*!
+ * @brief   guard for a state that is done after it is handled once
+ */
+static bool guardDone(const transitionContext_t *pContext)
+{
+    return true;
+}
+
+/*!
+ * @brief   action of the NFC wake-up
+ */
+static void actionNfc(const transitionContext_t *pContext)
+{
+    // print to the user
+    cli_printf("NFC activity detected!\n");
+}
+
+/*!
+ * @brief   action of the sleep timeout
+ */
+static void actionSleepTimeout(const transitionContext_t *pContext)
+{
+    uint8_t sleepTimeoutHours;
+
+    // get the sleep timeout variable
+    if(data_getParameter(T_SLEEP_TIMEOUT, &sleepTimeoutHours, NULL) == NULL)
+    {
+        sleepTimeoutHours = T_SLEEP_TIMEOUT_DEFAULT;
+    }
+
+    // output to the user
+    cli_printf("sleep timeout happend after %d hours, going to deepsleep %ds\n", sleepTimeoutHours,
+        (int)(timeBase_getUs() / TIME_BASE_US_PER_S));
+}
+
+/*!
+ * @brief   function that will output the transition trace ring, oldest first
+ */
+static void printTransitionTrace(void)
+{
+    transitionRecord_t trace[TRANSITION_TRACE_RECORDS];
+    uint32_t           count, first, i;
+    uint8_t            cause;
+
+    // copy the trace to not hold the lock while printing
+    pthread_mutex_lock(&gTransitionTraceLock);
+    memcpy(trace, gTransitionTrace, sizeof(trace));
+    count = gTransitionTraceCount;
+    pthread_mutex_unlock(&gTransitionTraceLock);
+
+    first = (count > TRANSITION_TRACE_RECORDS) ? (count - TRANSITION_TRACE_RECORDS) : 0;
+
+    cli_printf("%u transitions, last %u:\n", count, count - first);
+
+    // output each record
+    for(i = first; i < count; i++)
+    {
+        cause = trace[i % TRANSITION_TRACE_RECORDS].cause & ~TRANSITION_TRACE_UNLISTED;
+
+        cli_printf("%10ums %-6s %s -> %s (%s)%s\n", trace[i % TRANSITION_TRACE_RECORDS].timeMs,
+            trace[i % TRANSITION_TRACE_RECORDS].chargeMachine ? "charge" : "main",
+            cli_getStateString(!trace[i % TRANSITION_TRACE_RECORDS].chargeMachine,
+                trace[i % TRANSITION_TRACE_RECORDS].from, NULL),
+            cli_getStateString(!trace[i % TRANSITION_TRACE_RECORDS].chargeMachine,
+                trace[i % TRANSITION_TRACE_RECORDS].to, NULL),
+            (cause < TRANSITION_CAUSES) ? gTransitionCauseStrings[cause] : "?",
+            (trace[i % TRANSITION_TRACE_RECORDS].cause & TRANSITION_TRACE_UNLISTED) ? " unlisted" : "");
+    }
+}
+
+/*!
+ * @brief   function to output the wake-ups and the time in RUN mode of each main state
+ */
+static void printWakeUpStats(void)
+{
+    wakeSchedStats_t stats;
+    states_t         state;
+
+    cli_printf("state           time[s]   run[s]  wake-ups  wake-ups/s  meas  main   led   can   sup\n");
+
+    // output each state that was active
+    for(state = SELF_TEST; state < NUMBER_OF_MAIN_STATES; state++)
+    {
+        if(wakeSched_getStats(state, &stats) || !stats.timeMs)
+        {
+            continue;
+        }
+
+        cli_printf("%-14s %8u %8u %9u %11.2f %5u %5u %5u %5u %5u\n", cli_getStateString(true, state, NULL),
+            stats.timeMs / 1000, stats.runTimeMs / 1000, stats.wakeUps,
+            (double)stats.wakeUps * 1000 / stats.timeMs, stats.clientWakeUps[WAKE_SCHED_MEAS],
+            stats.clientWakeUps[WAKE_SCHED_MAIN], stats.clientWakeUps[WAKE_SCHED_LED],
+            stats.clientWakeUps[WAKE_SCHED_CAN], stats.clientWakeUps[WAKE_SCHED_SUPERVISOR]);
+    }
+}
+
 /*!
  * @brief function that will return one of the transition variables
  *
@@ -4905,7 +5335,7 @@ static int setNGetEnableDisplayUpdates(bool setNGet, bool enable)
 
 /*!
  * @brief   Function that is used to call a usleep (task switch as well)
- *          but it will kick the watchdog first.
+ *          but it will check in with the supervisor first, which kicks the watchdog.
  *
  * @param   usec the number of microseconds to wait.
  *
@@ -4916,12 +5346,8 @@ static int usleepMainLoopWatchdog(useconds_t usec)
 {
     int retValue = 0;
 
-    // kick the watchdog
-    if(sbc_kickTheWatchdog())
-    {
-        cli_printfError("main ERROR: Couldn't kick the watchdog!\n");
-        retValue = -1;
-    }
+    // check in with the supervisor, which kicks the watchdog
+    supervisor_checkIn(SUPERVISOR_MAIN, MAIN_LOOP_SUPERVISOR_DEADLINE_MS);
 
     // sleep for a little time
     usleep(usec);
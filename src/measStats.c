@@ -0,0 +1,380 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/src/measStats.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "measStats.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief  the amount of times a reader tries to get a consistent result
+#define MEAS_STATS_READ_RETRIES 4
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the accumulator of a bucket, the variance is kept as the sum of squared differences (M2) */
+typedef struct
+{
+    uint32_t count; //!< the amount of samples
+    float    mean;  //!< the running mean
+    float    m2;    //!< the sum of the squared differences with the mean
+    float    min;   //!< the minimum
+    float    max;   //!< the maximum
+} measStatsAcc_t;
+
+/*! @brief the state of a window, this is only used by the task that adds the samples */
+typedef struct
+{
+    measStatsAcc_t buckets[MEAS_STATS_BUCKETS]; //!< the closed buckets
+    measStatsAcc_t open;                        //!< the bucket that gets the new samples
+    uint32_t       bucketStartUs;               //!< the start time of the open bucket
+    uint8_t        newest;                      //!< the index of the newest closed bucket
+    bool           started;                     //!< true if the open bucket has a start time
+} measStatsWindowState_t;
+
+/*! @brief the published results of a window */
+typedef struct
+{
+    measStatsResult_t buffer[2]; //!< the double buffer, buffer[seq & 1] is the valid one
+    volatile uint32_t seq;       //!< incremented each time a new result is published
+} measStatsPublished_t;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+/*! @brief  the bucket length of each window in us */
+static const uint32_t gBucketLengthUs[MEAS_STATS_WINDOWS] = {
+    1000000 / MEAS_STATS_BUCKETS,  //!< MEAS_STATS_1S
+    10000000 / MEAS_STATS_BUCKETS, //!< MEAS_STATS_10S
+    60000000 / MEAS_STATS_BUCKETS  //!< MEAS_STATS_60S
+};
+
+/*! @brief  the state of the windows, only used by the task that adds the samples */
+static measStatsWindowState_t gWindowState[MEAS_STATS_CHANNELS][MEAS_STATS_WINDOWS];
+
+/*! @brief  the published results of the windows */
+static measStatsPublished_t gPublished[MEAS_STATS_CHANNELS][MEAS_STATS_WINDOWS];
+
+/*! @brief  set to clear the statistics of a channel with its next sample */
+static volatile bool gResetRequested[MEAS_STATS_CHANNELS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to add a sample to an accumulator (Welford)
+ *
+ * @param   pAcc the accumulator
+ * @param   value the sample
+ */
+static void addToAcc(measStatsAcc_t *pAcc, float value);
+
+/*!
+ * @brief   function to combine an accumulator into another (Chan et al.)
+ *
+ * @param   pDest the accumulator to combine into
+ * @param   pSrc the accumulator to add
+ */
+static void combineAcc(measStatsAcc_t *pDest, const measStatsAcc_t *pSrc);
+
+/*!
+ * @brief   function to combine the closed buckets of a window and publish the result
+ *
+ * @param   pState the state of the window
+ * @param   pPublished the published result of the window
+ */
+static void publishWindow(const measStatsWindowState_t *pState, measStatsPublished_t *pPublished);
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/*!
+ * @brief   This function will add a sample to all windows of a channel
+ *          the open bucket of a window is closed when the sample is past its end
+ * @note    This may only be called from one task.
+ *
+ * @param   channel the channel of the sample
+ * @param   value the value of the sample
+ * @param   timeUs the time of the sample in us, this may wrap
+ */
+void measStats_addSample(measStatsChannel_t channel, float value, uint32_t timeUs)
+{
+    measStatsWindowState_t *pState;
+    uint32_t periods, i;
+    int window;
+
+    if(channel >= MEAS_STATS_CHANNELS)
+    {
+        return;
+    }
+
+    // check if the statistics should be cleared
+    if(gResetRequested[channel])
+    {
+        gResetRequested[channel] = false;
+
+        memset(gWindowState[channel], 0, sizeof(gWindowState[channel]));
+
+        // publish the empty windows
+        for(window = 0; window < MEAS_STATS_WINDOWS; window++)
+        {
+            publishWindow(&gWindowState[channel][window], &gPublished[channel][window]);
+        }
+    }
+
+    // add it to each window
+    for(window = 0; window < MEAS_STATS_WINDOWS; window++)
+    {
+        pState = &gWindowState[channel][window];
+
+        // start the open bucket with the first sample
+        if(!pState->started)
+        {
+            pState->bucketStartUs = timeUs;
+            pState->started       = true;
+        }
+
+        // the amount of bucket lengths since the start of the open bucket
+        periods = (timeUs - pState->bucketStartUs) / gBucketLengthUs[window];
+
+        // check if the open bucket is done
+        if(periods)
+        {
+            // close the open bucket
+            pState->newest                  = (pState->newest + 1) % MEAS_STATS_BUCKETS;
+            pState->buckets[pState->newest] = pState->open;
+            memset(&pState->open, 0, sizeof(pState->open));
+
+            // add an empty bucket for each bucket without samples, the window is empty after that
+            for(i = 1; (i < periods) && (i <= MEAS_STATS_BUCKETS); i++)
+            {
+                pState->newest = (pState->newest + 1) % MEAS_STATS_BUCKETS;
+                memset(&pState->buckets[pState->newest], 0, sizeof(measStatsAcc_t));
+            }
+
+            // the new open bucket starts at the bucket length this sample is in
+            pState->bucketStartUs += periods * gBucketLengthUs[window];
+
+            // publish the new window result
+            publishWindow(pState, &gPublished[channel][window]);
+        }
+
+        addToAcc(&pState->open, value);
+    }
+}
+
+/*!
+ * @brief   This function will get the statistics of a window of a channel
+ *          this is combined from the closed buckets
+ * @note    This may be called from any task.
+ *
+ * @param   channel the channel
+ * @param   window the window
+ * @param   pResult address of the struct to become the statistics
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int measStats_getWindow(measStatsChannel_t channel, measStatsWindow_t window, measStatsResult_t *pResult)
+{
+    measStatsPublished_t *pPublished;
+    uint32_t seq;
+    int i;
+
+    if((channel >= MEAS_STATS_CHANNELS) || (window >= MEAS_STATS_WINDOWS) || (pResult == NULL))
+    {
+        return -1;
+    }
+
+    pPublished = &gPublished[channel][window];
+
+    // copy the valid buffer, it is only overwritten if 2 results are published during the copy
+    for(i = 0; i < MEAS_STATS_READ_RETRIES; i++)
+    {
+        seq = pPublished->seq;
+        __sync_synchronize();
+
+        *pResult = pPublished->buffer[seq & 1];
+
+        __sync_synchronize();
+
+        // check if it was not published during the copy
+        if(seq == pPublished->seq)
+        {
+            return 0;
+        }
+    }
+
+    // the reader is continuously preempted by the publisher
+    return -1;
+}
+
+/*!
+ * @brief   This function will clear all the statistics
+ *          the statistics are cleared with the next sample of each channel
+ */
+void measStats_reset(void)
+{
+    int channel;
+
+    for(channel = 0; channel < MEAS_STATS_CHANNELS; channel++)
+    {
+        gResetRequested[channel] = true;
+    }
+}
+
+/*!
+ * @brief   function to add a sample to an accumulator (Welford)
+ *
+ * @param   pAcc the accumulator
+ * @param   value the sample
+ */
+static void addToAcc(measStatsAcc_t *pAcc, float value)
+{
+    float delta;
+
+    if(!pAcc->count)
+    {
+        pAcc->min = value;
+        pAcc->max = value;
+    }
+    else if(value < pAcc->min)
+    {
+        pAcc->min = value;
+    }
+    else if(value > pAcc->max)
+    {
+        pAcc->max = value;
+    }
+
+    pAcc->count++;
+    delta = value - pAcc->mean;
+    pAcc->mean += delta / (float)pAcc->count;
+    pAcc->m2 += delta * (value - pAcc->mean);
+}
+
+/*!
+ * @brief   function to combine an accumulator into another (Chan et al.)
+ *
+ * @param   pDest the accumulator to combine into
+ * @param   pSrc the accumulator to add
+ */
+static void combineAcc(measStatsAcc_t *pDest, const measStatsAcc_t *pSrc)
+{
+    uint32_t count;
+    float delta;
+
+    if(!pSrc->count)
+    {
+        return;
+    }
+
+    if(!pDest->count)
+    {
+        *pDest = *pSrc;
+        return;
+    }
+
+    count = pDest->count + pSrc->count;
+    delta = pSrc->mean - pDest->mean;
+
+    pDest->mean += delta * ((float)pSrc->count / (float)count);
+    pDest->m2 += pSrc->m2 + (delta * delta * ((float)pDest->count * (float)pSrc->count / (float)count));
+    pDest->count = count;
+
+    if(pSrc->min < pDest->min)
+    {
+        pDest->min = pSrc->min;
+    }
+
+    if(pSrc->max > pDest->max)
+    {
+        pDest->max = pSrc->max;
+    }
+}
+
+/*!
+ * @brief   function to combine the closed buckets of a window and publish the result
+ *
+ * @param   pState the state of the window
+ * @param   pPublished the published result of the window
+ */
+static void publishWindow(const measStatsWindowState_t *pState, measStatsPublished_t *pPublished)
+{
+    measStatsAcc_t     acc;
+    measStatsResult_t *pResult;
+    float variance;
+    int i;
+
+    memset(&acc, 0, sizeof(acc));
+
+    // combine the closed buckets
+    for(i = 0; i < MEAS_STATS_BUCKETS; i++)
+    {
+        combineAcc(&acc, &pState->buckets[i]);
+    }
+
+    // write the buffer that is not valid now
+    pResult = &pPublished->buffer[(pPublished->seq + 1) & 1];
+
+    pResult->count = acc.count;
+    pResult->mean  = acc.mean;
+    pResult->min   = acc.min;
+    pResult->max   = acc.max;
+
+    variance = acc.count ? (acc.m2 / (float)acc.count) : 0;
+
+    // limit rounding errors
+    if(variance < 0)
+    {
+        variance = 0;
+    }
+
+    pResult->stdDev = sqrtf(variance);
+    pResult->rms    = sqrtf((acc.mean * acc.mean) + variance);
+
+    // make it the valid buffer
+    __sync_synchronize();
+    pPublished->seq = pPublished->seq + 1;
+}
+
@@ -0,0 +1,544 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/src/memMon.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <pthread.h>
+
+#include "memMon.h"
+#include "cli.h"
+#include "timeBase.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+#if !defined(CONFIG_STACK_COLORATION) || !defined(CONFIG_FS_PROCFS)
+#    warning memMon needs CONFIG_STACK_COLORATION and CONFIG_FS_PROCFS to measure the stack use!
+#endif
+
+//! @brief  the margin above the used stack for the suggested size in percent
+#define MEM_MON_STACK_MARGIN_PERCENT 25
+//! @brief  the minimum margin above the used stack for the suggested size in bytes
+#define MEM_MON_STACK_MIN_MARGIN 128
+//! @brief  the margin above the peak of a pool for the suggested size in percent
+#define MEM_MON_POOL_MARGIN_PERCENT 25
+//! @brief  the suggested sizes are rounded up to this amount of bytes
+#define MEM_MON_SIZE_ALIGN 64
+
+//! @brief  the size of the buffer to read /proc/<pid>/stack
+#define MEM_MON_PROC_BUFFER_SIZE 128
+
+//! @brief  macro to round up a size to MEM_MON_SIZE_ALIGN
+#define MEM_MON_ROUND_UP(x) ((((x) + MEM_MON_SIZE_ALIGN - 1) / MEM_MON_SIZE_ALIGN) * MEM_MON_SIZE_ALIGN)
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the stack of a task */
+typedef struct
+{
+    const char *pName;        //!< the name of the task
+    const char *pStackDefine; //!< the name of the stack size define
+    pid_t       pid;          //!< the pid of the task
+    uint32_t    stackSize;    //!< the stack size given to task_create
+    uint32_t    usableSize;   //!< the stack size NuttX reports, without the task overhead, 0 if unknown
+    uint32_t    used;         //!< the high-water mark of the stack
+    bool        running;      //!< true if the task could be read at the last sample
+} memMonTask_t;
+
+/*! @brief the use of a memory pool */
+typedef struct
+{
+    uint32_t size;     //!< the size of the pool in bytes
+    uint32_t capacity; //!< the amount of bytes that can be allocated
+    uint32_t used;     //!< the amount of bytes that are used
+    uint32_t peak;     //!< the highest amount of bytes that were used
+    uint32_t failures; //!< the amount of allocations that failed
+    bool     valid;    //!< true if the pool is set
+} memMonPoolUse_t;
+
+/*! @brief the use of the heap */
+typedef struct
+{
+    uint32_t size;           //!< the size of the heap
+    uint32_t used;           //!< the amount of bytes used at the last sample
+    uint32_t peak;           //!< the highest sampled amount of bytes used
+    uint32_t largestFree;    //!< the largest free block at the last sample
+    uint32_t minLargestFree; //!< the lowest sampled largest free block
+} memMonHeap_t;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+/*! @brief  mutex for the monitored memory */
+static pthread_mutex_t gMemMonLock;
+
+/*! @brief  the registered tasks */
+static memMonTask_t gTasks[MEM_MON_MAX_TASKS];
+
+/*! @brief  the amount of registered tasks */
+static int gAmountTasks = 0;
+
+/*! @brief  the use of the memory pools */
+static memMonPoolUse_t gPools[MEM_MON_POOLS];
+
+/*! @brief  the use of the heap */
+static memMonHeap_t gHeap;
+
+/*! @brief  the time (timeBase) in us the monitoring started, to output the soak time */
+static uint64_t gStartUs = 0;
+
+/*! @brief  the names of the memory pools */
+static const char *gPoolNames[MEM_MON_POOLS] = { "Cyphal", "DroneCAN" };
+
+/*! @brief  the names of the defines of the pool sizes for the report */
+static const char *gPoolDefines[MEM_MON_POOLS] = { "O1_HEAP_SIZE", "MEMORY_POOL_SIZE" };
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to read the stack size and high-water mark of a task from /proc/<pid>/stack
+ *
+ * @param   pid the pid of the task
+ * @param   pUsableSize address of the variable to become the stack size NuttX reports
+ * @param   pUsed address of the variable to become the high-water mark
+ *
+ * @return  0 if ok, -1 if the task could not be read
+ */
+static int readTaskStack(pid_t pid, uint32_t *pUsableSize, uint32_t *pUsed);
+
+/*!
+ * @brief   function to get a value after a label from the procfs output
+ *
+ * @param   pBuffer the zero terminated procfs output
+ * @param   pLabel the label to search
+ * @param   pValue address of the variable to become the value
+ *
+ * @return  0 if ok, -1 if the label is not found
+ */
+static int getProcValue(const char *pBuffer, const char *pLabel, uint32_t *pValue);
+
+/*!
+ * @brief   function to sample the stacks and the heap
+ * @note    gMemMonLock needs to be locked.
+ */
+static void sampleLocked(void);
+
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/*!
+ * @brief   This function will initialize the memMon part
+ * @note    This needs to be called before a task is registered.
+ *
+ * @return  0 if ok, otherwise it will indicate the error
+ */
+int memMon_initialize(void)
+{
+    int lvRetValue;
+
+    // initialize the mutex
+    lvRetValue = pthread_mutex_init(&gMemMonLock, NULL);
+    if(lvRetValue)
+    {
+        cli_printfError("memMon ERROR: couldn't init the mutex! %d\n", lvRetValue);
+        return lvRetValue;
+    }
+
+    // reset the values
+    memset(gTasks, 0, sizeof(gTasks));
+    memset(gPools, 0, sizeof(gPools));
+    memset(&gHeap, 0, sizeof(gHeap));
+    gAmountTasks = 0;
+    gStartUs     = timeBase_getUs();
+
+    return 0;
+}
+
+/*!
+ * @brief   This function will register a task to monitor its stack
+ * @note    This may be called from any task.
+ *
+ * @param   pName the name of the task, this needs to be a constant string
+ * @param   pStackDefine the name of the define of the stack size for the report,
+ *          this needs to be a constant string
+ * @param   pid the pid of the task (the return value of task_create)
+ * @param   stackSize the stack size given to task_create
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int memMon_registerTask(const char *pName, const char *pStackDefine, pid_t pid, uint32_t stackSize)
+{
+    int lvRetValue = -1;
+
+    // check the input
+    if(pName == NULL || pStackDefine == NULL || pid < 0)
+    {
+        cli_printfError("memMon ERROR: wrong task input!\n");
+        return lvRetValue;
+    }
+
+    pthread_mutex_lock(&gMemMonLock);
+
+    // check if there is room
+    if(gAmountTasks < MEM_MON_MAX_TASKS)
+    {
+        // add the task
+        gTasks[gAmountTasks].pName        = pName;
+        gTasks[gAmountTasks].pStackDefine = pStackDefine;
+        gTasks[gAmountTasks].pid          = pid;
+        gTasks[gAmountTasks].stackSize    = stackSize;
+        gTasks[gAmountTasks].usableSize   = 0;
+        gTasks[gAmountTasks].used         = 0;
+        gTasks[gAmountTasks].running      = true;
+        gAmountTasks++;
+
+        lvRetValue = 0;
+    }
+
+    pthread_mutex_unlock(&gMemMonLock);
+
+    // check for an error
+    if(lvRetValue)
+    {
+        cli_printfError("memMon ERROR: can't register %s, increase MEM_MON_MAX_TASKS!\n", pName);
+    }
+
+    return lvRetValue;
+}
+
+/*!
+ * @brief   This function will set the use of a memory pool
+ * @note    This should be called by the task that uses the pool, after it used the pool.
+ *
+ * @param   pool the memory pool
+ * @param   size the size of the pool in bytes
+ * @param   capacity the amount of bytes that can be allocated, the rest is used by the allocator
+ * @param   used the amount of bytes that are used
+ * @param   peak the highest amount of bytes that were used
+ * @param   failures the amount of allocations that failed
+ */
+void memMon_setPool(
+    memMonPool_t pool, uint32_t size, uint32_t capacity, uint32_t used, uint32_t peak, uint32_t failures)
+{
+    // check the input
+    if(pool >= MEM_MON_POOLS)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&gMemMonLock);
+
+    // save the use
+    gPools[pool].size     = size;
+    gPools[pool].capacity = capacity;
+    gPools[pool].used     = used;
+    gPools[pool].peak     = peak;
+    gPools[pool].failures = failures;
+    gPools[pool].valid    = true;
+
+    pthread_mutex_unlock(&gMemMonLock);
+}
+
+/*!
+ * @brief   This function will sample the stack high-water marks and the heap
+ * @note    This is called periodically by the supervisor task.
+ */
+void memMon_sample(void)
+{
+    pthread_mutex_lock(&gMemMonLock);
+    sampleLocked();
+    pthread_mutex_unlock(&gMemMonLock);
+}
+
+/*!
+ * @brief   This function will output the stack, heap and pool use and high-water marks
+ *
+ * @param   report true to output the suggested stack size defines as well
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int memMon_output(bool report)
+{
+    memMonTask_t    tasks[MEM_MON_MAX_TASKS];
+    memMonPoolUse_t pools[MEM_MON_POOLS];
+    memMonHeap_t    heap;
+    uint32_t        suggested[MEM_MON_MAX_TASKS];
+    uint32_t        overhead, margin;
+    int             amountTasks, i;
+
+    // sample now and copy it to not hold the lock while printing
+    pthread_mutex_lock(&gMemMonLock);
+    sampleLocked();
+    memcpy(tasks, gTasks, sizeof(tasks));
+    memcpy(pools, gPools, sizeof(pools));
+    heap        = gHeap;
+    amountTasks = gAmountTasks;
+    pthread_mutex_unlock(&gMemMonLock);
+
+    cli_printf("task        stack usable  used  free suggested\n");
+
+    // output each task
+    for(i = 0; i < amountTasks; i++)
+    {
+        // the task overhead (like the TLS) is in the stack size, but not in the usable size
+        overhead = 0;
+        if(tasks[i].usableSize && tasks[i].usableSize < tasks[i].stackSize)
+        {
+            overhead = tasks[i].stackSize - tasks[i].usableSize;
+        }
+
+        // calculate the margin above the high-water mark
+        margin = (tasks[i].used * MEM_MON_STACK_MARGIN_PERCENT) / 100;
+        if(margin < MEM_MON_STACK_MIN_MARGIN)
+        {
+            margin = MEM_MON_STACK_MIN_MARGIN;
+        }
+
+        // calculate the suggested stack size
+        suggested[i] = MEM_MON_ROUND_UP(tasks[i].used + margin + overhead);
+
+        cli_printf("%-10s %6u %6u %5u %5d %9u%s\n", tasks[i].pName, tasks[i].stackSize, tasks[i].usableSize,
+            tasks[i].used, (int32_t)tasks[i].usableSize - (int32_t)tasks[i].used, suggested[i],
+            tasks[i].running ? "" : " (ended)");
+    }
+
+    cli_printf("heap: size %u used %u high-water %u (sampled), largest free %u, lowest largest free %u\n",
+        heap.size, heap.used, heap.peak, heap.largestFree, heap.minLargestFree);
+
+    cli_printf("pool       size capacity  used  peak failures\n");
+
+    // output each pool
+    for(i = 0; i < MEM_MON_POOLS; i++)
+    {
+        // check if it is used
+        if(pools[i].valid)
+        {
+            cli_printf("%-8s %6u %8u %5u %5u %8u\n", gPoolNames[i], pools[i].size, pools[i].capacity,
+                pools[i].used, pools[i].peak, pools[i].failures);
+        }
+        else
+        {
+            cli_printf("%-8s %6s\n", gPoolNames[i], "off");
+        }
+    }
+
+    // check if the report needs to be outputted
+    if(report)
+    {
+        cli_printf("\n// suggested sizes after a run of %ds, the high-water mark plus a margin\n",
+            (int)(timeBase_getElapsedUs(gStartUs) / TIME_BASE_US_PER_S));
+
+        // output the stack size defines
+        for(i = 0; i < amountTasks; i++)
+        {
+            // check if the stack use is known
+            if(tasks[i].used)
+            {
+                cli_printf("#define %s %u // %s used %u of %u\n", tasks[i].pStackDefine, suggested[i],
+                    tasks[i].pName, tasks[i].used, tasks[i].stackSize);
+            }
+            else
+            {
+                cli_printf("// %s: %s unknown, is CONFIG_STACK_COLORATION set?\n", tasks[i].pName,
+                    tasks[i].pStackDefine);
+            }
+        }
+
+        // output the pool size defines
+        for(i = 0; i < MEM_MON_POOLS; i++)
+        {
+            // check if it is used
+            if(pools[i].valid)
+            {
+                // the allocator overhead is added to the peak with the margin
+                cli_printf("#define %s %u // peak %u of %u\n", gPoolDefines[i],
+                    MEM_MON_ROUND_UP(pools[i].peak + (pools[i].peak * MEM_MON_POOL_MARGIN_PERCENT) / 100 +
+                        (pools[i].size - pools[i].capacity)),
+                    pools[i].peak, pools[i].size);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to read the stack size and high-water mark of a task from /proc/<pid>/stack
+ *
+ * @param   pid the pid of the task
+ * @param   pUsableSize address of the variable to become the stack size NuttX reports
+ * @param   pUsed address of the variable to become the high-water mark
+ *
+ * @return  0 if ok, -1 if the task could not be read
+ */
+static int readTaskStack(pid_t pid, uint32_t *pUsableSize, uint32_t *pUsed)
+{
+    char    buffer[MEM_MON_PROC_BUFFER_SIZE];
+    int     fd;
+    ssize_t length;
+
+    // make the path of the stack of the task
+    snprintf(buffer, MEM_MON_PROC_BUFFER_SIZE, "/proc/%d/stack", (int)pid);
+
+    // open it, this fails if the task ended
+    fd = open(buffer, O_RDONLY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+
+    // read it
+    length = read(fd, buffer, MEM_MON_PROC_BUFFER_SIZE - 1);
+    close(fd);
+
+    // check for an error
+    if(length <= 0)
+    {
+        return -1;
+    }
+
+    // terminate it
+    buffer[length] = '\0';
+
+    // get the size, the used stack is only there with CONFIG_STACK_COLORATION
+    if(getProcValue(buffer, "StackSize:", pUsableSize))
+    {
+        return -1;
+    }
+
+    getProcValue(buffer, "StackUsed:", pUsed);
+
+    return 0;
+}
+
+/*!
+ * @brief   function to get a value after a label from the procfs output
+ *
+ * @param   pBuffer the zero terminated procfs output
+ * @param   pLabel the label to search
+ * @param   pValue address of the variable to become the value
+ *
+ * @return  0 if ok, -1 if the label is not found
+ */
+static int getProcValue(const char *pBuffer, const char *pLabel, uint32_t *pValue)
+{
+    const char *pLine;
+
+    // find the label
+    pLine = strstr(pBuffer, pLabel);
+    if(pLine == NULL)
+    {
+        return -1;
+    }
+
+    // convert the value after it
+    *pValue = (uint32_t)strtoul(pLine + strlen(pLabel), NULL, 10);
+
+    return 0;
+}
+
+/*!
+ * @brief   function to sample the stacks and the heap
+ * @note    gMemMonLock needs to be locked.
+ */
+static void sampleLocked(void)
+{
+    struct mallinfo heapInfo;
+    uint32_t        usableSize, used;
+    int             i;
+
+    // sample each task
+    for(i = 0; i < gAmountTasks; i++)
+    {
+        // skip the tasks that ended, the pid could be reused
+        if(!gTasks[i].running)
+        {
+            continue;
+        }
+
+        used = 0;
+
+        // read the stack
+        if(readTaskStack(gTasks[i].pid, &usableSize, &used))
+        {
+            gTasks[i].running = false;
+            continue;
+        }
+
+        gTasks[i].usableSize = usableSize;
+
+        // the painted stack gives the high-water mark, this is just in case
+        if(used > gTasks[i].used)
+        {
+            gTasks[i].used = used;
+        }
+    }
+
+    // sample the heap
+    heapInfo = mallinfo();
+
+    gHeap.size        = (uint32_t)heapInfo.arena;
+    gHeap.used        = (uint32_t)heapInfo.uordblks;
+    gHeap.largestFree = (uint32_t)heapInfo.mxordblk;
+
+    // save the high-water mark
+    if(gHeap.used > gHeap.peak)
+    {
+        gHeap.peak = gHeap.used;
+    }
+
+    // save the lowest largest free block
+    if(!gHeap.minLargestFree || gHeap.largestFree < gHeap.minLargestFree)
+    {
+        gHeap.minLargestFree = gHeap.largestFree;
+    }
+}
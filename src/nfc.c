@@ -465,10 +465,35 @@
 #define BMS_STATUS_LANG_EN_2_3          0x65
 #define BMS_STATUS_LANG_EN_3_3          0x6E
 
-#if((NDEF_TEXT_RECORD_LENGHT + 1) / 4) > NTAG_MEM_BLOCK_END_SRAM
-#    error NDEF_TEXT_RECORD_LENGHT is too large!
+// the binary BMS record header defines
+#define BMS_RECORD_HEADER_VALUE         ((TNF_MIME_MEDIA << TNF_BIT) | BMS_STATUS_IL_VAL | BMS_STATUS_SR_VAL | \
+                                        BMS_STATUS_CF_VAL | BMS_STATUS_ME_VAL | (MB_NOT_FIRST_RECORD << MB_BIT))
+#define BMS_RECORD_HEADER_LENGHT        3
+#define BMS_RECORD_BEGIN_INDEX          (NDEF_TEXT_RECORD_LENGHT)
+#define BMS_RECORD_TYPE_INDEX           (BMS_RECORD_BEGIN_INDEX + BMS_RECORD_HEADER_LENGHT)
+#define BMS_RECORD_PAYLOAD_INDEX        (BMS_RECORD_TYPE_INDEX + NFC_BMS_RECORD_MIME_TYPE_LENGHT)
+
+// the text record header if the binary BMS record follows it
+#define BMS_STATUS_MULTI_HEADER_VALUE   (BMS_STATUS_TNF_VAL | BMS_STATUS_IL_VAL | BMS_STATUS_SR_VAL | \
+                                        BMS_STATUS_CF_VAL | (ME_LAST_NOT_RECORD << ME_BIT) | BMS_STATUS_MB_VAL)
+#define BMS_STATUS_MULTI_MESSAGE_SIZE_VAL ((BMS_STATUS_MESSAGE_SIZE_VAL) + BMS_RECORD_HEADER_LENGHT + \
+                                        NFC_BMS_RECORD_MIME_TYPE_LENGHT + NFC_BMS_RECORD_SIZE)
+
+// the length of the whole NDEF message with the text and binary BMS record and the terminator TLV
+#define NDEF_MESSAGE_LENGHT             (BMS_RECORD_PAYLOAD_INDEX + NFC_BMS_RECORD_SIZE + NDEF_TEXT_END_STRING_LENGHT)
+#define NDEF_MESSAGE_BUFFER_LENGHT      (((NDEF_MESSAGE_LENGHT + 3) >> 2) << 2)
+
+#if(NDEF_MESSAGE_BUFFER_LENGHT / 4) > (NTAG_MEM_BLOCK_END_SRAM - NTAG_MEM_BLOCK_START_SRAM + 1)
+#    error NDEF_MESSAGE_LENGHT is too large!
 #endif
 
+#if(BMS_STATUS_MULTI_MESSAGE_SIZE_VAL) >= 0xFF
+#    error BMS_STATUS_MULTI_MESSAGE_SIZE_VAL does not fit the 1 byte TLV length!
+#endif
+
+// the maximum amount of blocks in one I2C write (max 255 bytes)
+#define NTAG_MAX_WRITE_BLOCKS           (UINT8_MAX / NTAG_I2C_BLOCK_SIZE)
+
 #define AMOUNT_RETRIES                  10
 #define ERROR_COULD_NOT_WRITE           (-222)
 #define ERROR_COULD_NOT_READ            (-333)
@@ -492,6 +517,42 @@ const char gChargeRelaxString[] = "Charge-relaxation state\n";
 /*! @brief Variable to disable the NFC if it failed */
 static bool gDisableNFC = false;
 
+/*! @brief  The constant NDEF header of the bms status text message */
+static const uint8_t gNDEFTxtHeaderTemplate[NDEF_HEADER_STRING_LEGHT] = {
+    BMS_STATUS_AM_VAL,
+    BMS_STATUS_VA_VAL,
+    BMS_STATUS_MEMLEN_VAL,
+    BMS_STATUS_AFI_VAL,
+    BMS_STATUS_T_FIELD_VAL,
+    BMS_STATUS_MESSAGE_SIZE_VAL,
+    BMS_STATUS_HEADER_VALUE,
+    BMS_STATUS_TYPE_LENGHT,
+    BMS_STATUS_PAYLOAD_LENGHT,
+    BMS_STATUS_RECORD_TYPE,
+    BMS_STATUS_LANG_EN_1_3,
+    BMS_STATUS_LANG_EN_2_3,
+    BMS_STATUS_LANG_EN_3_3,
+};
+
+/*! @brief  The constant labels of the bms status text message payload, the values are filled in */
+static const char gNDEFTxtPayloadTemplate[] = V_OUT_STRING C_BATT_STRING S_CHARGE_STRING S_HEALTH_STRING 
+    I_OUT_STRING N_CHARGES_STRING BATT_ID_STRING MODEL_ID_STRING STATE_STRING;
+
+/*! @brief  This array contains the characters to be send to the NTAG as NDEF record
+ *   @note   The first couple of bytes are needed for the type of NDEF record a
+ *   @note   NDEFTxtRecord[3] = 0x09 instead of 0x00 means multipage read can be used
+ */
+static uint8_t gNDEFTxtRecord[NDEF_MESSAGE_BUFFER_LENGHT] = {};
+
+/*! @brief  The last NDEF record that is written to the NTAG SRAM, to only write the changed blocks */
+static uint8_t gNDEFTxtRecordWritten[NDEF_MESSAGE_BUFFER_LENGHT] = {};
+
+/*! @brief  The amount of blocks in gNDEFTxtRecordWritten that are equal to the NTAG SRAM, 0 if unknown */
+static uint16_t gNDEFBlocksWritten = 0;
+
+/*! @brief  True if the header and the labels of the bms status are in gNDEFTxtRecord */
+static bool gNDEFTxtLabelsPlaced = false;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -525,6 +586,27 @@ int nfc_writeI2cData(uint8_t slaveAdr, uint16_t regAdr, uint8_t *writeReg, uint8
  */
 int nfc_readI2cData(uint8_t slaveAdr, uint16_t regAdr, uint8_t *readReg, uint8_t readBytes, bool reTry);
 
+/*!
+ * @brief   This function will write the 4-byte blocks of gNDEFTxtRecord to the NTAG SRAM that differ from 
+ *          the last written record. Consecutive changed blocks are written in one I2C transfer.
+ * @note    If writing fails, the whole record will be written the next time.
+ *
+ * @param   length the amount of bytes of gNDEFTxtRecord that should be in the NTAG, multiple of 4
+ *
+ * @return  0 if ok, -1 if there is an error, ERROR_COULD_NOT_WRITE if it could not write
+ */
+static int writeChangedNDEFBlocks(uint16_t length);
+
+/*!
+ * @brief   This function will fill the binary BMS record payload, see NFC_BMS_RECORD_*_OFFSET in nfc.h
+ *
+ * @param   pPayload address of the payload with NFC_BMS_RECORD_SIZE bytes
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ */
+static void encodeBMSRecord(uint8_t *pPayload, commonBatteryVariables_t *pCommonBatteryVariables,
+    calcBatteryVariables_t *pCalcBatteryVariables);
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -556,6 +638,9 @@ int nfc_initialize(bool skipSelfTest)
         return 0;
     }
 
+    // the NTAG SRAM content is unknown
+    gNDEFBlocksWritten = 0;
+
     // reset the register values
     for(i = 0; i < 4; i++)
     {
@@ -1053,6 +1138,9 @@ int nfc_setHPD(bool HPD)
 {
     int lvRetValue;
 
+    // the NTAG SRAM content is lost in hard power-down
+    gNDEFBlocksWritten = 0;
+
     // set the HPD (hard power-down) pin of the NFC high to consume power
     lvRetValue = gpio_writePin(NFC_HPD, HPD);
 
@@ -1088,13 +1176,7 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
     variableTypes_u variable1, variable2;
     uint64_t        uint64Val;
     int             lvRetValue = -1;
-    // uint8_t uint8Val[4] = {0, 0, 0, 0};
-
-    /*! @brief  This string contains the characters to be send to the NTAG as NDEF record
-     *   @note   The first couple of bytes are needed for the type of NDEF record a
-     *   @note   NDEFTxtRecord[3] = 0x09 instead of 0x00 means multipage read can be used
-     */
-    uint8_t NDEFTxtRecord[NDEF_TEXT_RECORD_LENGHT + 4] = {};
+    uint16_t        writeLength;
 
     // check if the NFC is disabled
     if(gDisableNFC)
@@ -1105,99 +1187,69 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
 
     // last byte needs to be 0xFE otherwise it will be discarded afterwards
 
-    // construct the NDEF header for the bms status text message
-    NDEFTxtRecord[0]  = BMS_STATUS_AM_VAL;
-    NDEFTxtRecord[1]  = BMS_STATUS_VA_VAL;
-    NDEFTxtRecord[2]  = BMS_STATUS_MEMLEN_VAL;
-    NDEFTxtRecord[3]  = BMS_STATUS_AFI_VAL;
-    NDEFTxtRecord[4]  = BMS_STATUS_T_FIELD_VAL;
-    NDEFTxtRecord[5]  = BMS_STATUS_MESSAGE_SIZE_VAL;
-    NDEFTxtRecord[6]  = BMS_STATUS_HEADER_VALUE;
-    NDEFTxtRecord[7]  = BMS_STATUS_TYPE_LENGHT;
-    NDEFTxtRecord[8]  = BMS_STATUS_PAYLOAD_LENGHT;
-    NDEFTxtRecord[9]  = BMS_STATUS_RECORD_TYPE;
-    NDEFTxtRecord[10] = BMS_STATUS_LANG_EN_1_3;
-    NDEFTxtRecord[11] = BMS_STATUS_LANG_EN_2_3;
-    NDEFTxtRecord[12] = BMS_STATUS_LANG_EN_3_3;
-
     // check if the outdated text needs to be entered
     if(setOutdatedText)
     {
+        // place the header again
+        memcpy(gNDEFTxtRecord, gNDEFTxtHeaderTemplate, NDEF_HEADER_STRING_LEGHT);
+
+        // the payload labels need to be placed again with the next BMS data
+        gNDEFTxtLabelsPlaced = false;
+
         // check which text needs to be set in the NTAG
         // if it is the waking up text
         if(wakingUpMessage)
         {
             // Set the lenght values different
-            NDEFTxtRecord[8] = (sizeof(gWakingUpString) + 0) + 3;
+            gNDEFTxtRecord[8] = (sizeof(gWakingUpString) + 0) + 3;
 
-            NDEFTxtRecord[5] = NDEFTxtRecord[8] + 4;
+            gNDEFTxtRecord[5] = gNDEFTxtRecord[8] + 4;
 
             // set the "outdated, please tap again!" data
-            strcpy((char *)&NDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], gWakingUpString);
-
-            // write to NTAG's SRAM
-            lvRetValue = nfc_writeI2cData(NTAG5_SLAVE_ADR, NTAG_MEM_BLOCK_START_SRAM, NDEFTxtRecord,
-                ((((NDEF_HEADER_STRING_LEGHT + sizeof(gWakingUpString) + 0) + 4) >> 2) << 2), true);
-
-            // check for errors
-            if(lvRetValue)
-            {
-#ifdef DEBUG_NFC
-                cli_printfError(
-                    "nfc ERROR: Can't write data to register: 0x%x NFC read?\n", NTAG_MEM_EEPROM_START);
-#endif
+            strcpy((char *)&gNDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], gWakingUpString);
 
-                // check if the error is because the NFC is occupied
-                if(lvRetValue == ERROR_COULD_NOT_WRITE)
-                {
-                    cli_printfWarning("NOTICE: NFC is read out, tap again for updated values\n");
-                    // set the returnvalue to 0, because this is no error
-                    lvRetValue = 0;
-                }
-            }
-            else
-            {
-                // it went OK
-                lvRetValue = 0;
-            }
+            // the amount of bytes to write
+            writeLength = ((((NDEF_HEADER_STRING_LEGHT + sizeof(gWakingUpString) + 0) + 4) >> 2) << 2);
         }
         // if it needs to be the charge-relaxation text
         else
         {
             // Set the lenght values different
-            NDEFTxtRecord[8] = (sizeof(gChargeRelaxString) + 0) + 3;
+            gNDEFTxtRecord[8] = (sizeof(gChargeRelaxString) + 0) + 3;
 
-            NDEFTxtRecord[5] = NDEFTxtRecord[8] + 4;
+            gNDEFTxtRecord[5] = gNDEFTxtRecord[8] + 4;
 
             // set the "outdated, please tap again!" data
-            strcpy((char *)&NDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], gChargeRelaxString);
+            strcpy((char *)&gNDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], gChargeRelaxString);
 
-            // write to NTAG's SRAM
-            lvRetValue = nfc_writeI2cData(NTAG5_SLAVE_ADR, NTAG_MEM_BLOCK_START_SRAM, NDEFTxtRecord,
-                ((((NDEF_HEADER_STRING_LEGHT + sizeof(gChargeRelaxString) + 0) + 4) >> 2) << 2), true);
+            // the amount of bytes to write
+            writeLength = ((((NDEF_HEADER_STRING_LEGHT + sizeof(gChargeRelaxString) + 0) + 4) >> 2) << 2);
+        }
 
-            // check for errors
-            if(lvRetValue)
-            {
+        // write the changed blocks to NTAG's SRAM
+        lvRetValue = writeChangedNDEFBlocks(writeLength);
+
+        // check for errors
+        if(lvRetValue)
+        {
 #ifdef DEBUG_NFC
-                cli_printfError(
-                    "nfc ERROR: Can't write data to register: 0x%x NFC read?\n", NTAG_MEM_EEPROM_START);
+            cli_printfError(
+                "nfc ERROR: Can't write data to register: 0x%x NFC read?\n", NTAG_MEM_EEPROM_START);
 #endif
 
-                // check if the error is because the NFC is occupied
-                if(lvRetValue == ERROR_COULD_NOT_WRITE)
-                {
-                    cli_printfWarning("NOTICE: NFC is read out, tap again for updated values\n");
-                    // set the returnvalue to 0, because this is no error
-                    lvRetValue = 0;
-                }
-            }
-            else
+            // check if the error is because the NFC is occupied
+            if(lvRetValue == ERROR_COULD_NOT_WRITE)
             {
-                // it went OK
+                cli_printfWarning("NOTICE: NFC is read out, tap again for updated values\n");
+                // set the returnvalue to 0, because this is no error
                 lvRetValue = 0;
             }
         }
+        else
+        {
+            // it went OK
+            lvRetValue = 0;
+        }
     }
     // if the BMS data need to be written
     else
@@ -1206,6 +1258,32 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
         DEBUGASSERT(pCommonBatteryVariables != NULL);
         DEBUGASSERT(pCalcBatteryVariables != NULL);
 
+        // check if the header and the labels need to be placed (after an outdated text)
+        if(!gNDEFTxtLabelsPlaced)
+        {
+            // copy the header and the default payload data in the NDEFTxtRecord
+            memcpy(gNDEFTxtRecord, gNDEFTxtHeaderTemplate, NDEF_HEADER_STRING_LEGHT);
+            memcpy(&gNDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], gNDEFTxtPayloadTemplate,
+                NDEF_TEXT_RECORD_LENGHT - NDEF_HEADER_STRING_LEGHT - NDEF_TEXT_END_STRING_LENGHT);
+
+            // the binary BMS record follows the text record
+            gNDEFTxtRecord[5] = BMS_STATUS_MULTI_MESSAGE_SIZE_VAL;
+            gNDEFTxtRecord[6] = BMS_STATUS_MULTI_HEADER_VALUE;
+
+            // add the binary BMS record header
+            gNDEFTxtRecord[BMS_RECORD_BEGIN_INDEX]     = BMS_RECORD_HEADER_VALUE;
+            gNDEFTxtRecord[BMS_RECORD_BEGIN_INDEX + 1] = NFC_BMS_RECORD_MIME_TYPE_LENGHT;
+            gNDEFTxtRecord[BMS_RECORD_BEGIN_INDEX + 2] = NFC_BMS_RECORD_SIZE;
+            memcpy(&gNDEFTxtRecord[BMS_RECORD_TYPE_INDEX], NFC_BMS_RECORD_MIME_TYPE,
+                NFC_BMS_RECORD_MIME_TYPE_LENGHT);
+
+            // add the last character
+            gNDEFTxtRecord[NDEF_MESSAGE_BUFFER_LENGHT - 1] = NDEF_TEXT_END_BYTE;
+
+            // remember it
+            gNDEFTxtLabelsPlaced = true;
+        }
+
 #ifdef DEBUG_NFC
 
         // output the header
@@ -1213,28 +1291,14 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
 
         for(i = 0; i < (NDEF_HEADER_STRING_LEGHT >> 2) + 1; i++)
         {
-            cli_printf("%d: 0x%x, ", i, NDEFTxtRecord[(i * 4)]);
-            cli_printf("%x, ", NDEFTxtRecord[(i * 4) + 1]);
-            cli_printf("%x, ", NDEFTxtRecord[(i * 4) + 2]);
-            cli_printf("%x \n", NDEFTxtRecord[(i * 4) + 3]);
+            cli_printf("%d: 0x%x, ", i, gNDEFTxtRecord[(i * 4)]);
+            cli_printf("%x, ", gNDEFTxtRecord[(i * 4) + 1]);
+            cli_printf("%x, ", gNDEFTxtRecord[(i * 4) + 2]);
+            cli_printf("%x \n", gNDEFTxtRecord[(i * 4) + 3]);
         }
 
 #endif
 
-        // copy the default payload data in the NDEFTxtRecord
-        strcpy((char *)&NDEFTxtRecord[V_OUT_STRING_BEGIN_INDEX], V_OUT_STRING);
-        strcpy((char *)&NDEFTxtRecord[C_BATT_STRING_BEGIN_INDEX], C_BATT_STRING);
-        strcpy((char *)&NDEFTxtRecord[S_CHARGE_STRING_BEGIN_INDEX], S_CHARGE_STRING);
-        strcpy((char *)&NDEFTxtRecord[S_HEALTH_STRING_BEGIN_INDEX], S_HEALTH_STRING);
-        strcpy((char *)&NDEFTxtRecord[I_OUT_STRING_BEGIN_INDEX], I_OUT_STRING);
-        strcpy((char *)&NDEFTxtRecord[N_CHARGES_STRING_BEGIN_INDEX], N_CHARGES_STRING);
-        strcpy((char *)&NDEFTxtRecord[BATT_ID_STRING_BEGIN_INDEX], BATT_ID_STRING);
-        strcpy((char *)&NDEFTxtRecord[MODEL_ID_STRING_BEGIN_INDEX], MODEL_ID_STRING);
-        strcpy((char *)&NDEFTxtRecord[STATE_STRING_BEGIN_INDEX], STATE_STRING);
-
-        // add the last character
-        NDEFTxtRecord[(((sizeof(NDEFTxtRecord) / 4) * 4) - 1)] = NDEF_TEXT_END_BYTE;
-
         // get the output voltage
         // convert the floating point value to an integer and multiply by 1000
         variable1.int32Var = (int)(pCommonBatteryVariables->V_out * NORMAL_TO_MILI);
@@ -1252,11 +1316,11 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
         }
 
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[V_OUT_STRING_DATA_INDEX], V_OUT_STRING_DATA_LENGHT, "%02d.%03u",
+        snprintf((char *)&gNDEFTxtRecord[V_OUT_STRING_DATA_INDEX], V_OUT_STRING_DATA_LENGHT, "%02d.%03u",
             (int)variable1.int32Var / 1000, (unsigned int)variable2.int32Var);
 
         // overwrite the NULL character
-        NDEFTxtRecord[V_OUT_STRING_DATA_INDEX + 6] = 'v';
+        gNDEFTxtRecord[V_OUT_STRING_DATA_INDEX + 6] = 'v';
 
         // check if the battery temp sensor is enabled
         if(pCommonBatteryVariables->sensor_enable)
@@ -1277,28 +1341,35 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
             }
 
             // convert the float value to a 6/7 digit string value
-            snprintf((char *)&NDEFTxtRecord[C_BATT_STRING_DATA_INDEX], C_BATT_STRING_DATA_LENGHT, "%03d.%01u",
+            snprintf((char *)&gNDEFTxtRecord[C_BATT_STRING_DATA_INDEX], C_BATT_STRING_DATA_LENGHT, "%03d.%01u",
                 (int)variable1.int32Var / 10, (unsigned int)variable2.int32Var);
 
             // overwrite the NULL character
-            NDEFTxtRecord[C_BATT_STRING_DATA_INDEX + 5] = 'C';
+            gNDEFTxtRecord[C_BATT_STRING_DATA_INDEX + 5] = 'C';
+        }
+        else
+        {
+            // place the template value back
+            memcpy(&gNDEFTxtRecord[C_BATT_STRING_BEGIN_INDEX],
+                &gNDEFTxtPayloadTemplate[C_BATT_STRING_BEGIN_INDEX - V_OUT_STRING_BEGIN_INDEX],
+                C_BATT_STRING_LENGHT);
         }
 
         // set the s-charge
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[S_CHARGE_STRING_DATA_INDEX], S_CHARGE_STRING_DATA_LENGHT, "%03u",
+        snprintf((char *)&gNDEFTxtRecord[S_CHARGE_STRING_DATA_INDEX], S_CHARGE_STRING_DATA_LENGHT, "%03u",
             pCalcBatteryVariables->s_charge);
 
         // overwrite the NULL character
-        NDEFTxtRecord[S_CHARGE_STRING_DATA_INDEX + 3] = '%';
+        gNDEFTxtRecord[S_CHARGE_STRING_DATA_INDEX + 3] = '%';
 
         // set the s-health
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[S_HEALTH_STRING_DATA_INDEX], S_HEALTH_STRING_DATA_LENGHT, "%03u",
+        snprintf((char *)&gNDEFTxtRecord[S_HEALTH_STRING_DATA_INDEX], S_HEALTH_STRING_DATA_LENGHT, "%03u",
             pCalcBatteryVariables->s_health);
 
         // overwrite the NULL character
-        NDEFTxtRecord[S_HEALTH_STRING_DATA_INDEX + 3] = '%';
+        gNDEFTxtRecord[S_HEALTH_STRING_DATA_INDEX + 3] = '%';
 
         // set the i-out-avg
         // convert the floating point value to an integer and multiply by 1000
@@ -1317,11 +1388,11 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
         }
 
         // convert the float value to a 6/7 digit string value
-        snprintf((char *)&NDEFTxtRecord[I_OUT_STRING_DATA_INDEX], I_OUT_STRING_DATA_LENGHT, "%03d.%03u",
+        snprintf((char *)&gNDEFTxtRecord[I_OUT_STRING_DATA_INDEX], I_OUT_STRING_DATA_LENGHT, "%03d.%03u",
             (int)variable1.int32Var / 1000, (unsigned int)variable2.int32Var);
 
         // overwrite the NULL character
-        NDEFTxtRecord[I_OUT_STRING_DATA_INDEX + 7] = 'A';
+        gNDEFTxtRecord[I_OUT_STRING_DATA_INDEX + 7] = 'A';
 
         // get the number of charges
         if(data_getParameter(N_CHARGES, &variable1.uint16Var, NULL) == NULL)
@@ -1334,19 +1405,19 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
         }
 
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[N_CHARGES_STRING_DATA_INDEX], N_CHARGES_STRING_DATA_LENGHT, "%05u",
+        snprintf((char *)&gNDEFTxtRecord[N_CHARGES_STRING_DATA_INDEX], N_CHARGES_STRING_DATA_LENGHT, "%05u",
             variable1.uint16Var);
 
         // overwrite the NULL character
-        NDEFTxtRecord[N_CHARGES_STRING_DATA_INDEX + 5] = '\n';
+        gNDEFTxtRecord[N_CHARGES_STRING_DATA_INDEX + 5] = '\n';
 
         // get the battery id
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[BATT_ID_STRING_DATA_INDEX], BATT_ID_STRING_DATA_LENGHT, "%03u",
+        snprintf((char *)&gNDEFTxtRecord[BATT_ID_STRING_DATA_INDEX], BATT_ID_STRING_DATA_LENGHT, "%03u",
             pCalcBatteryVariables->batt_id);
 
         // overwrite the NULL character
-        NDEFTxtRecord[BATT_ID_STRING_DATA_INDEX + 3] = '\n';
+        gNDEFTxtRecord[BATT_ID_STRING_DATA_INDEX + 3] = '\n';
 
         // get the model-id
         if(data_getParameter(MODEL_ID, &uint64Val, NULL) == NULL)
@@ -1362,11 +1433,16 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
         }
 
         // convert the float value to a 6 digit string value
-        snprintf((char *)&NDEFTxtRecord[MODEL_ID_STRING_DATA_INDEX], MODEL_ID_STRING_DATA_LENGHT, "%020llu",
+        snprintf((char *)&gNDEFTxtRecord[MODEL_ID_STRING_DATA_INDEX], MODEL_ID_STRING_DATA_LENGHT, "%020llu",
             uint64Val);
 
         // overwrite the NULL character
-        NDEFTxtRecord[MODEL_ID_STRING_DATA_INDEX + 20] = '\n';
+        gNDEFTxtRecord[MODEL_ID_STRING_DATA_INDEX + 20] = '\n';
+
+        // clear the old state string with the template
+        memcpy(&gNDEFTxtRecord[STATE_STRING_BEGIN_INDEX],
+            &gNDEFTxtPayloadTemplate[STATE_STRING_BEGIN_INDEX - V_OUT_STRING_BEGIN_INDEX],
+            STATE_STRING_LENGHT);
 
         // get the state
         variable1.int32Var = (int)data_getMainState();
@@ -1379,29 +1455,22 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
 
             // put the charge state string at the correct location
             cli_getStateString(
-                false, (uint8_t)variable1.int32Var, (char *)&NDEFTxtRecord[STATE_STRING_DATA_INDEX]);
+                false, (uint8_t)variable1.int32Var, (char *)&gNDEFTxtRecord[STATE_STRING_DATA_INDEX]);
         }
         // if not in the charge state
         else
         {
             // put the main state string at the correct location
             cli_getStateString(
-                true, (uint8_t)variable1.int32Var, (char *)&NDEFTxtRecord[STATE_STRING_DATA_INDEX]);
+                true, (uint8_t)variable1.int32Var, (char *)&gNDEFTxtRecord[STATE_STRING_DATA_INDEX]);
         }
 
-        // check if the size is not too much
-        if((sizeof(NDEFTxtRecord) / 4) > NTAG_MEM_BLOCK_END_SRAM)
-        {
-            // error
-            cli_printfError("nfc ERROR: NDEFTxtRecord too large for SRAM!\n");
+        // fill the binary BMS record payload
+        encodeBMSRecord(&gNDEFTxtRecord[BMS_RECORD_PAYLOAD_INDEX], pCommonBatteryVariables, pCalcBatteryVariables);
 
-            // return with an error
-            return lvRetValue;
-        }
+        // write the changed blocks to NTAG's SRAM
+        lvRetValue = writeChangedNDEFBlocks(NDEF_MESSAGE_BUFFER_LENGHT);
 
-        // write to NTAG's SRAM
-        lvRetValue = nfc_writeI2cData(NTAG5_SLAVE_ADR, NTAG_MEM_BLOCK_START_SRAM, NDEFTxtRecord,
-            (((NDEF_TEXT_RECORD_LENGHT + 4) >> 2) << 2), true);
         // check for errors
         if(lvRetValue)
         {
@@ -1427,43 +1496,15 @@ int nfc_updateBMSStatus(bool setOutdatedText, bool wakingUpMessage,
             lvRetValue = 0;
         }
 
-        //  this commented code shows how to update the NTAG 4 bytes at a time for RAM and EEPROM.
-        //  this is needed if the user want to update it to the EEPROM of the NTAG (slower update rate is
-        //  needed as well)
-        //     for(i = 0; i < (sizeof(NDEFTxtRecord)/4); i++)
-        //     {
-        //       // make the data to write to the EEPROM
-        //       uint8Val[0] = NDEFTxtRecord[(i*4)];
-        //       uint8Val[1] = NDEFTxtRecord[(i*4)+1];
-        //       uint8Val[2] = NDEFTxtRecord[(i*4)+2];
-        //       uint8Val[3] = NDEFTxtRecord[(i*4)+3];
-
-        // #ifdef DEBUG_NFC
-        //       cli_printf("writing %2d: %c %c %c %c\n", i, uint8Val[0], uint8Val[1], uint8Val[2],
-        //         uint8Val[3]);
-        // #endif
-
-        //       // write the data to the NTAG if allowed (don't wait if the NTAG is locked/used by NFC)
-        //       // Other option: 255 bytes may be written to SRAM in one I2C transfer
-        //       if(nfc_writeI2cData(NTAG5_SLAVE_ADR, NTAG_MEM_BLOCK_START_SRAM + i, uint8Val, 4, true))
-        //       {
-        // #ifdef DEBUG_NFC
-        //         cli_printfError("nfc ERROR: Can't write data to register: 0x%x NFC read?\n",
-        //           NTAG_MEM_EEPROM_START + i);
-        // #endif
-        //       }
-
-        //       // Wait for 4ms before writing to EEPROM (or 0.4ms for SRAM) again
-        //       // Other option: 255 bytes may be written to SRAM in one I2C transfer
-        //       usleep(NTAG_SRAM_WRITE_DELAY_US);
-        //     }
+        //  To update the EEPROM of the NTAG instead of the SRAM, the blocks need to be written 4 bytes at a
+        //  time with a delay of NTAG_EEPROM_WRITE_DELAY_US in between (slower update rate is needed as well).
+        //  writeChangedNDEFBlocks() already only writes the changed blocks.
     }
 
     // return the value
     return lvRetValue;
 }
 
-
 /*!
  * @brief   This function can be used to disable the NFC.
  *          Calling nfc_updateBMSStatus() will just return 0.
@@ -1692,3 +1733,234 @@ int nfc_readI2cData(uint8_t slaveAdr, uint16_t regAdr, uint8_t *readReg, uint8_t
     // return
     return ret;
 }
+
+/*!
+ * @brief   This function will write the 4-byte blocks of gNDEFTxtRecord to the NTAG SRAM that differ from 
+ *          the last written record. Consecutive changed blocks are written in one I2C transfer.
+ * @note    If writing fails, the whole record will be written the next time.
+ *
+ * @param   length the amount of bytes of gNDEFTxtRecord that should be in the NTAG, multiple of 4
+ *
+ * @return  0 if ok, -1 if there is an error, ERROR_COULD_NOT_WRITE if it could not write
+ */
+static int writeChangedNDEFBlocks(uint16_t length)
+{
+    int      ret = 0;
+    uint16_t blocks = length / NTAG_I2C_BLOCK_SIZE;
+    uint16_t block, firstChanged;
+    bool     changed;
+#ifdef DEBUG_NFC_WRITE
+    uint16_t bytesWritten = 0;
+#endif
+
+    // check if it fits
+    if((blocks > (NTAG_MEM_BLOCK_END_SRAM - NTAG_MEM_BLOCK_START_SRAM + 1)) ||
+        (length > sizeof(gNDEFTxtRecord)))
+    {
+        // error
+        cli_printfError("nfc ERROR: NDEFTxtRecord too large for SRAM!\n");
+
+        // return with an error
+        return -1;
+    }
+
+    // loop through the blocks, one further to write the last run
+    firstChanged = blocks;
+    for(block = 0; block <= blocks; block++)
+    {
+        // check if this block changed, or is not known to be written
+        changed = (block < blocks) &&
+            ((block >= gNDEFBlocksWritten) ||
+                (memcmp(&gNDEFTxtRecord[block * NTAG_I2C_BLOCK_SIZE],
+                     &gNDEFTxtRecordWritten[block * NTAG_I2C_BLOCK_SIZE], NTAG_I2C_BLOCK_SIZE) != 0));
+
+        // check if a run of changed blocks ended, or is as large as one I2C write can be
+        if((firstChanged != blocks) && (!changed || ((block - firstChanged) == NTAG_MAX_WRITE_BLOCKS)))
+        {
+            // write the changed blocks to NTAG's SRAM
+            ret = nfc_writeI2cData(NTAG5_SLAVE_ADR, NTAG_MEM_BLOCK_START_SRAM + firstChanged,
+                &gNDEFTxtRecord[firstChanged * NTAG_I2C_BLOCK_SIZE],
+                (block - firstChanged) * NTAG_I2C_BLOCK_SIZE, true);
+
+            // check for errors
+            if(ret)
+            {
+                // the SRAM content is unknown now, write it all the next time
+                gNDEFBlocksWritten = 0;
+
+                return ret;
+            }
+
+            // remember what is written
+            memcpy(&gNDEFTxtRecordWritten[firstChanged * NTAG_I2C_BLOCK_SIZE],
+                &gNDEFTxtRecord[firstChanged * NTAG_I2C_BLOCK_SIZE],
+                (block - firstChanged) * NTAG_I2C_BLOCK_SIZE);
+
+#ifdef DEBUG_NFC_WRITE
+            bytesWritten += (block - firstChanged) * NTAG_I2C_BLOCK_SIZE;
+#endif
+
+            firstChanged = blocks;
+        }
+
+        // check if a run of changed blocks starts
+        if(changed && (firstChanged == blocks))
+        {
+            firstChanged = block;
+        }
+    }
+
+    // check if more is known to be written now
+    if(blocks > gNDEFBlocksWritten)
+    {
+        gNDEFBlocksWritten = blocks;
+    }
+
+#ifdef DEBUG_NFC_WRITE
+    cli_printf("nfc: wrote %d of %d bytes\n", bytesWritten, length);
+#endif
+
+    return ret;
+}
+
+/*!
+ * @brief   This function will place a uint16_t in a buffer as little endian
+ *
+ * @param   pBuffer the address to place it
+ * @param   value the value to place
+ */
+static inline void putUint16(uint8_t *pBuffer, uint16_t value)
+{
+    pBuffer[0] = (uint8_t)(value & UINT8_MAX);
+    pBuffer[1] = (uint8_t)(value >> 8);
+}
+
+/*!
+ * @brief   This function will place a uint32_t in a buffer as little endian
+ *
+ * @param   pBuffer the address to place it
+ * @param   value the value to place
+ */
+static inline void putUint32(uint8_t *pBuffer, uint32_t value)
+{
+    putUint16(&pBuffer[0], (uint16_t)(value & UINT16_MAX));
+    putUint16(&pBuffer[2], (uint16_t)(value >> 16));
+}
+
+/*!
+ * @brief   This function will convert a positive float to a uint16_t with a factor and limit it
+ *
+ * @param   value the value to convert
+ * @param   factor the value to multiply with
+ *
+ * @return  the limited value
+ */
+static uint16_t toUint16(float value, float factor)
+{
+    value *= factor;
+
+    // limit the value
+    if(value < 0)
+    {
+        return 0;
+    }
+    else if(value > UINT16_MAX)
+    {
+        return UINT16_MAX;
+    }
+
+    return (uint16_t)value;
+}
+
+/*!
+ * @brief   This function will fill the binary BMS record payload, see NFC_BMS_RECORD_*_OFFSET in nfc.h
+ *
+ * @param   pPayload address of the payload with NFC_BMS_RECORD_SIZE bytes
+ * @param   pCommonBatteryVariables pointer to the commonBatteryVariables_t with the measurements
+ * @param   pCalcBatteryVariables pointer to the calcBatteryVariables_t with the calculated values
+ */
+static void encodeBMSRecord(uint8_t *pPayload, commonBatteryVariables_t *pCommonBatteryVariables,
+    calcBatteryVariables_t *pCalcBatteryVariables)
+{
+    int     bmsFault;
+    uint8_t flags = 0;
+    int     i;
+
+    // set the version and the number of cells
+    pPayload[NFC_BMS_RECORD_VERSION_OFFSET] = NFC_BMS_RECORD_VERSION;
+    pPayload[NFC_BMS_RECORD_N_CELLS_OFFSET] = pCommonBatteryVariables->N_cells;
+
+    // make the flags
+    if(pCommonBatteryVariables->sensor_enable)
+    {
+        flags |= NFC_BMS_RECORD_FLAG_SENSOR_ENABLE;
+    }
+    if(pCalcBatteryVariables->s_out)
+    {
+        flags |= NFC_BMS_RECORD_FLAG_S_OUT;
+    }
+    if(pCalcBatteryVariables->s_in_flight)
+    {
+        flags |= NFC_BMS_RECORD_FLAG_S_IN_FLIGHT;
+    }
+    pPayload[NFC_BMS_RECORD_FLAGS_OFFSET] = flags;
+
+    // set the fault and the states
+    bmsFault                                     = data_getBmsFault();
+    pPayload[NFC_BMS_RECORD_FAULT_OFFSET]        = (bmsFault < 0) ? 0 : (uint8_t)bmsFault;
+    pPayload[NFC_BMS_RECORD_STATE_OFFSET]        = (uint8_t)data_getMainState();
+    pPayload[NFC_BMS_RECORD_CHARGE_STATE_OFFSET] = (uint8_t)data_getChargeState();
+
+    // set the state of charge and health
+    pPayload[NFC_BMS_RECORD_S_CHARGE_OFFSET] = pCalcBatteryVariables->s_charge;
+    pPayload[NFC_BMS_RECORD_S_HEALTH_OFFSET] = pCalcBatteryVariables->s_health;
+
+    // set the voltages in mV
+    putUint16(&pPayload[NFC_BMS_RECORD_V_OUT_OFFSET], toUint16(pCommonBatteryVariables->V_out, NORMAL_TO_MILI));
+    putUint16(&pPayload[NFC_BMS_RECORD_V_BATT_OFFSET], toUint16(pCommonBatteryVariables->V_batt, NORMAL_TO_MILI));
+
+    for(i = 0; i < 6; i++)
+    {
+        putUint16(&pPayload[NFC_BMS_RECORD_V_CELLS_OFFSET + (i * sizeof(uint16_t))],
+            (i < pCommonBatteryVariables->N_cells) ?
+                toUint16(pCommonBatteryVariables->V_cellVoltages.V_cellArr[i], NORMAL_TO_MILI) :
+                0);
+    }
+
+    // set the currents in mA
+    putUint32(&pPayload[NFC_BMS_RECORD_I_BATT_OFFSET],
+        (uint32_t)(int32_t)(pCommonBatteryVariables->I_batt * NORMAL_TO_MILI));
+    putUint32(&pPayload[NFC_BMS_RECORD_I_BATT_AVG_OFFSET],
+        (uint32_t)(int32_t)(pCommonBatteryVariables->I_batt_avg * NORMAL_TO_MILI));
+    putUint32(&pPayload[NFC_BMS_RECORD_I_BATT_10S_OFFSET],
+        (uint32_t)(int32_t)(pCommonBatteryVariables->I_batt_10s_avg * NORMAL_TO_MILI));
+
+    // set the temperatures in 0.1 C
+    putUint16(&pPayload[NFC_BMS_RECORD_C_BATT_OFFSET],
+        pCommonBatteryVariables->sensor_enable ?
+            (uint16_t)(int16_t)(pCommonBatteryVariables->C_batt * CONVERT_TO_1_10TH) :
+            0);
+    putUint16(&pPayload[NFC_BMS_RECORD_C_AFE_OFFSET],
+        (uint16_t)(int16_t)(pCommonBatteryVariables->C_AFE * CONVERT_TO_1_10TH));
+    putUint16(&pPayload[NFC_BMS_RECORD_C_T_OFFSET],
+        (uint16_t)(int16_t)(pCommonBatteryVariables->C_T * CONVERT_TO_1_10TH));
+    putUint16(&pPayload[NFC_BMS_RECORD_C_R_OFFSET],
+        (uint16_t)(int16_t)(pCommonBatteryVariables->C_R * CONVERT_TO_1_10TH));
+
+    // set the power in mW and the energy in mWh
+    putUint32(&pPayload[NFC_BMS_RECORD_P_AVG_OFFSET],
+        (uint32_t)(int32_t)(pCalcBatteryVariables->P_avg * NORMAL_TO_MILI));
+    putUint32(&pPayload[NFC_BMS_RECORD_E_USED_OFFSET],
+        (pCalcBatteryVariables->E_used > 0) ? (uint32_t)(pCalcBatteryVariables->E_used * NORMAL_TO_MILI) : 0);
+
+    // set the capacities in 10 mAh
+    putUint16(&pPayload[NFC_BMS_RECORD_A_REM_OFFSET], toUint16(pCalcBatteryVariables->A_rem, 100));
+    putUint16(&pPayload[NFC_BMS_RECORD_A_FULL_OFFSET], toUint16(pCalcBatteryVariables->A_full, 100));
+    putUint16(&pPayload[NFC_BMS_RECORD_A_FACTORY_OFFSET], toUint16(pCalcBatteryVariables->A_factory, 100));
+
+    // set the time to full in minutes
+    putUint16(&pPayload[NFC_BMS_RECORD_T_FULL_OFFSET], toUint16(pCalcBatteryVariables->t_full, 60));
+
+    // set the battery id
+    pPayload[NFC_BMS_RECORD_BATT_ID_OFFSET] = pCalcBatteryVariables->batt_id;
+}
@@ -57,6 +57,7 @@
 #include "data.h"
 #include "spi.h"
 #include "gpio.h"
+#include "timeBase.h"
 
 /****************************************************************************
  * Defines
@@ -250,6 +251,15 @@
 /*! @brief  mutex for controlling the watchdog */
 static pthread_mutex_t gWatchdogLock;
 
+/*! @brief  the value of the watchdog control register, written again to kick the watchdog */
+static uint8_t gWatchdogCtrlReg = 0;
+
+/*! @brief  true if gWatchdogCtrlReg is the value in the SBC */
+static bool gWatchdogCtrlRegValid = false;
+
+/*! @brief  the amount of SPI transfers done to kick the watchdog */
+static uint32_t gWatchdogKickTransfers = 0;
+
 /****************************************************************************
  * private Functions
  ****************************************************************************/
@@ -1513,6 +1523,7 @@ int sbc_setCANFDMode(bool on)
 
 /*!
  * @brief   this function is used to kick the watchdog, which will reset it.
+ *          The watchdog control register value is written again, it is only read if it is not known.
  * @note    Multi-thread protected
  *
  * @param   none
@@ -1525,45 +1536,60 @@ int sbc_kickTheWatchdog(void)
     uint8_t txData[2], rxData[2];
 
 #ifdef DEBUG_WATCHDOG_TIME
-    struct timespec currentTime;
+    uint64_t        currentUs;
     uint32_t        timeDifference;
     static uint32_t maxTimeDifference = 0;
-    static bool            firstTime  = true;
-    static struct timespec oldTime    = { .tv_sec = 2, .tv_nsec = 0 };
+    static bool     firstTime         = true;
+    static uint64_t oldUs             = 0;
 #endif
 
     // lock the mutex
     pthread_mutex_lock(&gWatchdogLock);
 
-    // read the watchdog control register to get the mode and the period
-    txData[0] = (WATCHDOG_CTRL_REG_ADR << 1) + READ_BIT;
-    txData[1] = 0;
+    // check if the watchdog control register value is not known
+    if(!gWatchdogCtrlRegValid)
+    {
+        // read the watchdog control register to get the mode and the period
+        txData[0] = (WATCHDOG_CTRL_REG_ADR << 1) + READ_BIT;
+        txData[1] = 0;
 
-    // write the data to the SBC and receive data
-    lvRetValue = spi_BMSTransferData(SBC_SPI_BUS, txData, rxData);
+        // write the data to the SBC and receive data
+        lvRetValue = spi_BMSTransferData(SBC_SPI_BUS, txData, rxData);
+        gWatchdogKickTransfers++;
 
-    // check for errors
-    if(lvRetValue)
-    {
-        // output to the user
-        cli_printfError("SBC ERROR: failed to read WATCHDOG CTRL! %d\n", lvRetValue);
+        // check for errors
+        if(lvRetValue)
+        {
+            // output to the user
+            cli_printfError("SBC ERROR: failed to read WATCHDOG CTRL! %d\n", lvRetValue);
+        }
+        else
+        {
+            // save the value to only write it the next time
+            gWatchdogCtrlReg      = rxData[1];
+            gWatchdogCtrlRegValid = true;
+        }
     }
-    // if it went ok
-    else
+
+    // check if the value is known
+    if(gWatchdogCtrlRegValid)
     {
-        // make the watchdog control register value
-        // and write the register again to reset the watchdog
+        // write the watchdog control register again to reset the watchdog
         txData[0] = (WATCHDOG_CTRL_REG_ADR << 1) + WRITE_BIT;
-        txData[1] = rxData[1];
+        txData[1] = gWatchdogCtrlReg;
 
         // write the data to the SBC and receive data
         lvRetValue = spi_BMSTransferData(SBC_SPI_BUS, txData, rxData);
+        gWatchdogKickTransfers++;
 
         // check for errors
         if(lvRetValue)
         {
             // output to the user
             cli_printfError("SBC ERROR: failed to write WATCHDOG CTRL! %d\n", lvRetValue);
+
+            // read it again the next time
+            gWatchdogCtrlRegValid = false;
         }
     }
 
@@ -1575,21 +1601,15 @@ int sbc_kickTheWatchdog(void)
         // make sure to only do it once
         firstTime = false;
 
-        // get the time of oldTime
-        if(clock_gettime(CLOCK_REALTIME, &oldTime))
-        {
-            cli_printfError("SBC ERROR: failed to get old time! errno: %d\n", errno);
-        }
+        // get the time of oldUs
+        oldUs = timeBase_getUs();
     }
 
     // get the current time
-    if(clock_gettime(CLOCK_REALTIME, &currentTime))
-    {
-        cli_printfError("SBC ERROR: failed to get current time! errno: %d\n", errno);
-    }
+    currentUs = timeBase_getUs();
 
     // get the time difference
-    timeDifference = data_getUsTimeDiff(currentTime, oldTime);
+    timeDifference = (uint32_t)(currentUs - oldUs);
 
     // check if the new difference is more than the max value
     if(timeDifference > maxTimeDifference)
@@ -1602,8 +1622,7 @@ int sbc_kickTheWatchdog(void)
     }
 
     // save the current time in the old time
-    oldTime.tv_sec  = currentTime.tv_sec;
-    oldTime.tv_nsec = currentTime.tv_nsec;
+    oldUs = currentUs;
 
     // check if in the INIT
     if(INIT == data_getMainState())
@@ -1621,6 +1640,26 @@ int sbc_kickTheWatchdog(void)
     return lvRetValue;
 }
 
+/*!
+ * @brief   this function is used to get the amount of SPI transfers done to kick the watchdog
+ *
+ * @return  the amount of SPI transfers
+ */
+uint32_t sbc_getWatchdogKickTransfers(void)
+{
+    uint32_t transfers;
+
+    // lock the mutex
+    pthread_mutex_lock(&gWatchdogLock);
+
+    transfers = gWatchdogKickTransfers;
+
+    // unlock the mutex
+    pthread_mutex_unlock(&gWatchdogLock);
+
+    return transfers;
+}
+
 /*!
  * @brief   this function is used to set a new watchdog mode in the SBC.
  * @warning keep in mind that change the watchdog mode means disabling 5V (CAN tranceiver) briefly
@@ -1663,6 +1702,9 @@ int sbc_setWatchdogMode(watchdogMode_t newMode, bool slow)
         // cli_printf("WatchdogMode fast\n");
     }
 
+    // the watchdog control register will be read and maybe changed
+    gWatchdogCtrlRegValid = false;
+
     // read the watchdog control register to get the mode and the period
     txData[0] = (WATCHDOG_CTRL_REG_ADR << 1) + READ_BIT;
     txData[1] = 0;
@@ -1676,6 +1718,9 @@ int sbc_setWatchdogMode(watchdogMode_t newMode, bool slow)
         // output to the user
         cli_printfError("SBC ERROR: failed to read WATCHDOG CTRL! %d\n", lvRetValue);
 
+        // unlock the mutex
+        pthread_mutex_unlock(&gWatchdogLock);
+
         // return the error
         return lvRetValue;
     }
@@ -1743,8 +1788,15 @@ int sbc_setWatchdogMode(watchdogMode_t newMode, bool slow)
                 break;
         }
 
-        // check if not already in this mode
-        if(!alreadyInThisMode)
+        // check if already in this mode
+        if(alreadyInThisMode)
+        {
+            // save the value to kick the watchdog with
+            gWatchdogCtrlReg      = rxData[1];
+            gWatchdogCtrlRegValid = true;
+        }
+        // if not already in this mode
+        else
         {
             // read the SBC mode
             // set the address and set it in read mode
@@ -1841,6 +1893,12 @@ int sbc_setWatchdogMode(watchdogMode_t newMode, bool slow)
                         // set the error value
                         lvRetValue = -1;
                     }
+                    else
+                    {
+                        // save the value to kick the watchdog with
+                        gWatchdogCtrlReg      = newWDModeReg;
+                        gWatchdogCtrlRegValid = true;
+                    }
                 }
             }
 
@@ -0,0 +1,329 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/src/supervisor.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "supervisor.h"
+#include "wakeSched.h"
+#include "sbc.h"
+#include "memMon.h"
+#include "cli.h"
+#include "timeBase.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+#define SUPERVISOR_PRIORITY   140
+#define SUPERVISOR_STACK_SIZE 1024 + 512
+
+//! @brief  the period the watchdog is kicked with, this plus the slack needs to be lower than
+//!         the SBC watchdog period (4s)
+#define SUPERVISOR_KICK_PERIOD_MS 2500
+//! @brief  the time a kick may be later to wake together with other tasks
+#define SUPERVISOR_KICK_SLACK_MS  1000
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the supervision of a task */
+typedef struct
+{
+    uint64_t checkInUs;  //!< the time of the last check-in
+    uint32_t deadlineMs; //!< the deadline after the last check-in, SUPERVISOR_OFF if not supervised
+    int32_t  minSlackMs; //!< the lowest time that was left until the deadline at a check-in
+    uint32_t misses;     //!< the amount of times the deadline was missed
+    bool     missed;     //!< true if the current deadline is missed
+    bool     checkedIn;  //!< true if it checked in with a deadline at least once
+} supervisorTask_t;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+/*! @brief  mutex for the supervision of the tasks */
+static pthread_mutex_t gSupervisorLock;
+
+/*! @brief  the supervision of each task */
+static supervisorTask_t gTasks[SUPERVISOR_CLIENTS];
+
+/*! @brief  the amount of watchdog kicks and the kicks that were skipped */
+static uint32_t gKicks = 0, gSkippedKicks = 0;
+
+/*! @brief  the names of the supervised tasks */
+static const char *gTaskNames[SUPERVISOR_CLIENTS] = { "main", "batManag", "updater", "CAN" };
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   the supervisor task, it kicks the watchdog if all tasks are alive
+ *
+ * @param   argc the amount of arguments there are in argv (if the last argument is NULL!)
+ * @param   argv a character pointer array with the arguments, first is the taskname than the arguments
+ */
+static int supervisorTaskFunc(int argc, char *argv[]);
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/*!
+ * @brief   This function will initialize the supervisor and start its task
+ *
+ * @return  0 if ok, otherwise it will indicate the error
+ */
+int supervisor_initialize(void)
+{
+    int lvRetValue;
+
+    // initialize the mutex
+    lvRetValue = pthread_mutex_init(&gSupervisorLock, NULL);
+    if(lvRetValue)
+    {
+        cli_printfError("supervisor ERROR: couldn't init the mutex! %d\n", lvRetValue);
+        return lvRetValue;
+    }
+
+    // no task is supervised until it checks in
+    memset(gTasks, 0, sizeof(gTasks));
+
+    // create the supervisor task
+    lvRetValue = task_create("supervisor", SUPERVISOR_PRIORITY, SUPERVISOR_STACK_SIZE, supervisorTaskFunc, NULL);
+    if(lvRetValue < 0)
+    {
+        // inform user
+        lvRetValue = errno;
+        cli_printfError("supervisor ERROR: Failed to start task: %d\n", lvRetValue);
+        return lvRetValue;
+    }
+
+    // monitor its stack
+    memMon_registerTask("supervisor", "SUPERVISOR_STACK_SIZE", lvRetValue, SUPERVISOR_STACK_SIZE);
+
+    return 0;
+}
+
+/*!
+ * @brief   This function is used by a supervised task to check in
+ * @note    This may be called from any task.
+ *
+ * @param   client the task
+ * @param   deadlineMs the maximum time in ms until the next check-in,
+ *          SUPERVISOR_OFF to not supervise it until the next check-in
+ */
+void supervisor_checkIn(supervisorClient_t client, uint32_t deadlineMs)
+{
+    uint64_t nowUs;
+    int32_t  slackMs;
+
+    // check the input
+    if(client >= SUPERVISOR_CLIENTS)
+    {
+        return;
+    }
+
+    nowUs = timeBase_getUs();
+
+    pthread_mutex_lock(&gSupervisorLock);
+
+    // check if it was supervised
+    if(gTasks[client].deadlineMs != SUPERVISOR_OFF)
+    {
+        // calculate the time that was left until the deadline
+        slackMs = (int32_t)gTasks[client].deadlineMs - (int32_t)((nowUs - gTasks[client].checkInUs) / 1000);
+
+        // save the lowest
+        if(!gTasks[client].checkedIn || (slackMs < gTasks[client].minSlackMs))
+        {
+            gTasks[client].minSlackMs = slackMs;
+        }
+
+        gTasks[client].checkedIn = true;
+    }
+
+    // save the new deadline
+    gTasks[client].checkInUs  = nowUs;
+    gTasks[client].deadlineMs = deadlineMs;
+    gTasks[client].missed     = false;
+
+    pthread_mutex_unlock(&gSupervisorLock);
+}
+
+/*!
+ * @brief   This function will output the deadline, slack and misses of each task
+ *          and the watchdog kicks and their SPI transfers
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int supervisor_output(void)
+{
+    supervisorTask_t tasks[SUPERVISOR_CLIENTS];
+    uint32_t         kicks, skippedKicks;
+    uint64_t         nowUs;
+    int              i;
+
+    // copy it to not hold the lock while printing
+    pthread_mutex_lock(&gSupervisorLock);
+    memcpy(tasks, gTasks, sizeof(tasks));
+    kicks        = gKicks;
+    skippedKicks = gSkippedKicks;
+    pthread_mutex_unlock(&gSupervisorLock);
+
+    nowUs = timeBase_getUs();
+
+    cli_printf("task      deadline[ms] slack[ms] min-slack[ms] misses\n");
+
+    // output each task
+    for(i = 0; i < SUPERVISOR_CLIENTS; i++)
+    {
+        // check if it is supervised
+        if(tasks[i].deadlineMs != SUPERVISOR_OFF)
+        {
+            cli_printf("%-9s %12u %9d ", gTaskNames[i], tasks[i].deadlineMs,
+                (int32_t)tasks[i].deadlineMs - (int32_t)((nowUs - tasks[i].checkInUs) / 1000));
+        }
+        else
+        {
+            cli_printf("%-9s %12s %9s ", gTaskNames[i], "off", "-");
+        }
+
+        // check if there is a lowest slack
+        if(tasks[i].checkedIn)
+        {
+            cli_printf("%13d %6u\n", tasks[i].minSlackMs, tasks[i].misses);
+        }
+        else
+        {
+            cli_printf("%13s %6u\n", "-", tasks[i].misses);
+        }
+    }
+
+    cli_printf("watchdog kicks: %u, skipped: %u, SPI transfers: %u\n", kicks, skippedKicks,
+        sbc_getWatchdogKickTransfers());
+
+    return 0;
+}
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   the supervisor task, it kicks the watchdog if all tasks are alive
+ *
+ * @param   argc the amount of arguments there are in argv (if the last argument is NULL!)
+ * @param   argv a character pointer array with the arguments, first is the taskname than the arguments
+ */
+static int supervisorTaskFunc(int argc, char *argv[])
+{
+    struct timespec waitTime;
+    uint64_t        nowUs, kickUs;
+    bool            alive;
+    int             i;
+
+    // loop endlessly
+    while(1)
+    {
+        nowUs = timeBase_getUs();
+        alive = true;
+
+        pthread_mutex_lock(&gSupervisorLock);
+
+        // check each supervised task
+        for(i = 0; i < SUPERVISOR_CLIENTS; i++)
+        {
+            // check if the deadline is passed
+            if((gTasks[i].deadlineMs != SUPERVISOR_OFF) &&
+                ((nowUs - gTasks[i].checkInUs) > ((uint64_t)gTasks[i].deadlineMs * 1000)))
+            {
+                alive = false;
+
+                // only count and output it once per deadline
+                if(!gTasks[i].missed)
+                {
+                    gTasks[i].missed = true;
+                    gTasks[i].misses++;
+
+                    cli_printfError("supervisor ERROR: %s task missed its %ums deadline, not kicking watchdog!\n",
+                        gTaskNames[i], gTasks[i].deadlineMs);
+                }
+            }
+        }
+
+        // count the kick
+        if(alive)
+        {
+            gKicks++;
+        }
+        else
+        {
+            gSkippedKicks++;
+        }
+
+        pthread_mutex_unlock(&gSupervisorLock);
+
+        // kick the watchdog if all tasks are alive
+        if(alive && sbc_kickTheWatchdog())
+        {
+            cli_printfError("supervisor ERROR: Couldn't kick the watchdog!\n");
+        }
+
+        // sample the stack and heap high-water marks while it is awake anyway
+        memMon_sample();
+
+        // make the time of the next kick
+        kickUs = timeBase_getUs() + (SUPERVISOR_KICK_PERIOD_MS * TIME_BASE_US_PER_MS);
+
+        // align it with the other wake-ups
+        wakeSched_alignDeadline(WAKE_SCHED_SUPERVISOR, &kickUs, SUPERVISOR_KICK_SLACK_MS);
+
+        // wait until the next kick, on the monotonic clock
+        timeBase_toTimespec(kickUs, &waitTime);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &waitTime, NULL);
+
+        // count the wake-up
+        wakeSched_wokeUp(WAKE_SCHED_SUPERVISOR);
+    }
+
+    // should not come here
+    return -1;
+}
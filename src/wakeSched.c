@@ -0,0 +1,367 @@
+/****************************************************************************
+ * nxp_bms/BMS_v1/src/wakeSched.c
+ *
+ * BSD 3-Clause License
+ * 
+ * Copyright 2022 NXP
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "wakeSched.h"
+#include "cli.h"
+#include "timeBase.h"
+
+/****************************************************************************
+ * Defines
+ ****************************************************************************/
+//! @brief  the value of a deadline that is not registered
+#define WAKE_SCHED_NO_DEADLINE 0
+
+/****************************************************************************
+ * Types
+ ****************************************************************************/
+/*! @brief the wake-up statistics of a main state, with the times in us */
+typedef struct
+{
+    uint32_t wakeUps;                           //!< the amount of wake-ups (batches)
+    uint32_t clientWakeUps[WAKE_SCHED_CLIENTS]; //!< the amount of wake-ups started by each task
+    uint64_t timeUs;                            //!< the time in the state
+    uint64_t runTimeUs;                         //!< the time in the state with the MCU in RUN mode
+} wakeSchedStateStats_t;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+/*! @brief  mutex for the deadlines and the statistics */
+static pthread_mutex_t gWakeSchedLock;
+
+/*! @brief  to indicate the module is initialized */
+static bool gWakeSchedInitialized = false;
+
+/*! @brief  the registered deadline of each task in us, WAKE_SCHED_NO_DEADLINE if none */
+static uint64_t gDeadlineUs[WAKE_SCHED_CLIENTS];
+
+/*! @brief  the time of the last wake-up (batch) in us */
+static uint64_t gLastWakeUpUs = 0;
+
+/*! @brief  the statistics of each main state */
+static wakeSchedStateStats_t gStateStats[NUMBER_OF_MAIN_STATES];
+
+/*! @brief  the main state the time is counted for */
+static states_t gState = SELF_TEST;
+
+/*! @brief  true if the MCU is in RUN mode */
+static bool gRunMode = true;
+
+/*! @brief  the time the state was last set in us */
+static uint64_t gStateTimeUs = 0;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to add the time since the last call to the statistics of the state
+ * @note    gWakeSchedLock should be locked.
+ *
+ * @param   nowUs the current time in us
+ */
+static void addStateTime(uint64_t nowUs);
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+/*!
+ * @brief   This function will initialize the wakeSched module
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int wakeSched_initialize(void)
+{
+    // check if not initialized
+    if(!gWakeSchedInitialized)
+    {
+        // initialize the mutex
+        if(pthread_mutex_init(&gWakeSchedLock, NULL))
+        {
+            cli_printfError("wakeSched ERROR: couldn't init the mutex!\n");
+            return -1;
+        }
+
+        // clear the deadlines and the statistics
+        memset(gDeadlineUs, 0, sizeof(gDeadlineUs));
+        memset(gStateStats, 0, sizeof(gStateStats));
+
+        gStateTimeUs = timeBase_getUs();
+
+        gWakeSchedInitialized = true;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief   This function will register the deadline of the next timed wait of a task
+ *          the deadline is aligned with the earliest deadline of another task in
+ *          [deadline, deadline + slack]
+ * @note    This may be called from any task.
+ *
+ * @param   client the task
+ * @param   pDeadlineUs address of the deadline in us (of timeBase_getUs()), this becomes the aligned deadline
+ * @param   slackMs the time in ms the wake-up may be later than the deadline
+ */
+void wakeSched_alignDeadline(wakeSchedClient_t client, uint64_t *pDeadlineUs, uint32_t slackMs)
+{
+    int i;
+    uint64_t deadlineUs, alignedUs;
+
+    // check the input
+    if(!gWakeSchedInitialized || client >= WAKE_SCHED_CLIENTS || pDeadlineUs == NULL)
+    {
+        return;
+    }
+
+    deadlineUs = *pDeadlineUs;
+    alignedUs  = deadlineUs;
+
+    pthread_mutex_lock(&gWakeSchedLock);
+
+    // check if the slack allows it to be aligned
+    if(slackMs)
+    {
+        // find the earliest deadline of the other tasks in the slack
+        alignedUs = deadlineUs + ((uint64_t)slackMs * 1000) + 1;
+
+        for(i = 0; i < WAKE_SCHED_CLIENTS; i++)
+        {
+            if((i != client) && (gDeadlineUs[i] != WAKE_SCHED_NO_DEADLINE) && 
+                (gDeadlineUs[i] >= deadlineUs) && (gDeadlineUs[i] < alignedUs))
+            {
+                alignedUs = gDeadlineUs[i];
+            }
+        }
+
+        // keep the own deadline if there is none in the slack
+        if(alignedUs > (deadlineUs + ((uint64_t)slackMs * 1000)))
+        {
+            alignedUs = deadlineUs;
+        }
+    }
+
+    // register it
+    gDeadlineUs[client] = alignedUs;
+
+    pthread_mutex_unlock(&gWakeSchedLock);
+
+    // return the aligned deadline
+    *pDeadlineUs = alignedUs;
+}
+
+/*!
+ * @brief   This function will register the timeout of the next timed wait of a task
+ *          the same as wakeSched_alignDeadline() but with a relative timeout
+ *
+ * @param   client the task
+ * @param   timeoutMs the timeout in ms
+ * @param   slackMs the time in ms the wake-up may be later than the timeout
+ *
+ * @return  the aligned timeout in ms
+ */
+uint32_t wakeSched_alignTimeout(wakeSchedClient_t client, uint32_t timeoutMs, uint32_t slackMs)
+{
+    uint64_t nowUs, deadlineUs;
+
+    // check if initialized
+    if(!gWakeSchedInitialized)
+    {
+        return timeoutMs;
+    }
+
+    // make the deadline
+    nowUs      = timeBase_getUs();
+    deadlineUs = nowUs + ((uint64_t)timeoutMs * 1000);
+
+    // align it
+    wakeSched_alignDeadline(client, &deadlineUs, slackMs);
+
+    // make it relative again, rounded up to not wake just before it
+    return (uint32_t)((deadlineUs - nowUs + 999) / 1000);
+}
+
+/*!
+ * @brief   This function should be called when a task returns from its timed wait
+ *          it is counted as a new wake-up if it is not in the batch of the last wake-up
+ *          the deadline of the task is removed until it registers a new one
+ *
+ * @param   client the task
+ */
+void wakeSched_wokeUp(wakeSchedClient_t client)
+{
+    uint64_t nowUs;
+
+    // check the input
+    if(!gWakeSchedInitialized || client >= WAKE_SCHED_CLIENTS)
+    {
+        return;
+    }
+
+    nowUs = timeBase_getUs();
+
+    pthread_mutex_lock(&gWakeSchedLock);
+
+    // remove the deadline, the task is not waiting on it anymore
+    gDeadlineUs[client] = WAKE_SCHED_NO_DEADLINE;
+
+    // check if this is a new batch
+    if((nowUs - gLastWakeUpUs) > WAKE_SCHED_BATCH_US)
+    {
+        gStateStats[gState].wakeUps++;
+        gStateStats[gState].clientWakeUps[client]++;
+    }
+
+    gLastWakeUpUs = nowUs;
+
+    pthread_mutex_unlock(&gWakeSchedLock);
+}
+
+/*!
+ * @brief   This function will set the main state and MCU power mode to count the statistics for
+ *          the time since the last call is added to the previous state
+ * @note    Should be called from the main loop each loop.
+ *
+ * @param   state the main state
+ * @param   runMode true if the MCU is in RUN mode
+ */
+void wakeSched_setState(states_t state, bool runMode)
+{
+    uint64_t nowUs;
+
+    // check the input
+    if(!gWakeSchedInitialized || state >= NUMBER_OF_MAIN_STATES)
+    {
+        return;
+    }
+
+    nowUs = timeBase_getUs();
+
+    pthread_mutex_lock(&gWakeSchedLock);
+
+    // add the time to the previous state
+    addStateTime(nowUs);
+
+    gState   = state;
+    gRunMode = runMode;
+
+    pthread_mutex_unlock(&gWakeSchedLock);
+}
+
+/*!
+ * @brief   This function will get the wake-up statistics of a main state
+ *
+ * @param   state the main state
+ * @param   pStats address of the struct to become the statistics
+ *
+ * @return  0 if ok, -1 if there is an error
+ */
+int wakeSched_getStats(states_t state, wakeSchedStats_t *pStats)
+{
+    // check the input
+    if(!gWakeSchedInitialized || state >= NUMBER_OF_MAIN_STATES || pStats == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&gWakeSchedLock);
+
+    // add the time until now to the current state
+    addStateTime(timeBase_getUs());
+
+    pStats->wakeUps   = gStateStats[state].wakeUps;
+    pStats->timeMs    = (uint32_t)(gStateStats[state].timeUs / 1000);
+    pStats->runTimeMs = (uint32_t)(gStateStats[state].runTimeUs / 1000);
+    memcpy(pStats->clientWakeUps, gStateStats[state].clientWakeUps, sizeof(pStats->clientWakeUps));
+
+    pthread_mutex_unlock(&gWakeSchedLock);
+
+    return 0;
+}
+
+/*!
+ * @brief   This function will clear the wake-up statistics
+ */
+void wakeSched_resetStats(void)
+{
+    // check if initialized
+    if(!gWakeSchedInitialized)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&gWakeSchedLock);
+
+    memset(gStateStats, 0, sizeof(gStateStats));
+    gStateTimeUs = timeBase_getUs();
+
+    pthread_mutex_unlock(&gWakeSchedLock);
+}
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+/*!
+ * @brief   function to add the time since the last call to the statistics of the state
+ * @note    gWakeSchedLock should be locked.
+ *
+ * @param   nowUs the current time in us
+ */
+static void addStateTime(uint64_t nowUs)
+{
+    // check if the time went forward
+    if(nowUs > gStateTimeUs)
+    {
+        gStateStats[gState].timeUs += nowUs - gStateTimeUs;
+
+        // check if in RUN mode
+        if(gRunMode)
+        {
+            gStateStats[gState].runTimeUs += nowUs - gStateTimeUs;
+        }
+    }
+
+    gStateTimeUs = nowUs;
+}